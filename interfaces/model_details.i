@@ -42,6 +42,8 @@ typedef struct {
   double  sfact;
   int     rtype[8];
   short   alias[MAXALPHA+1];
+  int     num_threads;
+  int     pf_adaptive;
 } vrna_md_t;
 
 
@@ -78,7 +80,9 @@ typedef struct {
     const int     ribo            = vrna_md_defaults_ribo_get(),
     const double  cv_fact         = vrna_md_defaults_cv_fact_get(),
     const double  nc_fact         = vrna_md_defaults_nc_fact_get(),
-    const double  sfact           = vrna_md_defaults_sfact_get())
+    const double  sfact           = vrna_md_defaults_sfact_get(),
+    const int     num_threads     = vrna_md_defaults_num_threads_get(),
+    const int     pf_adaptive     = vrna_md_defaults_pf_adaptive_get())
   {
     vrna_md_t *md       = (vrna_md_t *)vrna_alloc(sizeof(vrna_md_t));
     md->temperature     = temperature;
@@ -105,6 +109,8 @@ typedef struct {
     md->cv_fact         = cv_fact;
     md->nc_fact         = nc_fact;
     md->sfact           = sfact;
+    md->num_threads     = num_threads;
+    md->pf_adaptive     = pf_adaptive;
 
     vrna_md_update(md);
 
@@ -163,6 +169,8 @@ typedef struct {
     out << ", cv_fact: " << $self->cv_fact ;
     out << ", nc_fact: " << $self->nc_fact ;
     out << ", sfact: " << $self->sfact ;
+    out << ", num_threads: " << $self->num_threads ;
+    out << ", pf_adaptive: " << $self->pf_adaptive ;
     out << " }";
 
     return std::string(out.str());
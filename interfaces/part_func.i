@@ -147,6 +147,25 @@ char *my_pf_circ_fold(char *string, float *OUTPUT);
   {
     return vrna_pr_energy($self, e);
   }
+
+  std::vector<vrna_ep_t>
+  pairing_probs_sparse(double cutoff,
+                       double prune_ratio = VRNA_PROBS_SPARSE_PRUNE_DEFAULT)
+  {
+    std::vector<vrna_ep_t>  ep_v;
+    vrna_ep_t               *ptr, *plist;
+
+    plist = vrna_pairing_probs_sparse($self, cutoff, prune_ratio);
+
+    if (plist) {
+      for (ptr = plist; ptr->i && ptr->j; ptr++)
+        ep_v.push_back(*ptr);
+
+      free(plist);
+    }
+
+    return ep_v;
+  }
 }
 
 %include  <ViennaRNA/part_func.h>
@@ -18,6 +18,7 @@
 #include <string.h>
 #include <math.h>
 #include <float.h>    /* #defines FLT_MAX ... */
+#include <limits.h>
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
@@ -30,6 +31,17 @@
 #include "ViennaRNA/Lfold.h"
 #include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/part_func_window.h"
+#include "ViennaRNA/datastructures/stream_output.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ *  In parallel mode, the sequence is split into chunks of
+ *  WINDOW_CHUNK_FACTOR * window_size nucleotides
+ */
+#define WINDOW_CHUNK_FACTOR   16
 
 /*
  #################################
@@ -78,6 +90,33 @@ typedef void (add_QI5)(FLT_OR_DBL **,
                        FLT_OR_DBL,
                        FLT_OR_DBL);
 
+/* a single callback execution held back until its chunk is released */
+typedef struct {
+  FLT_OR_DBL    *pr;
+  int           offset;   /* index of the first entry of pr */
+  int           pr_size;
+  int           i;
+  int           max;
+  unsigned int  type;
+} window_event;
+
+/* results of a chunk of the sequence that is processed by a single thread */
+typedef struct {
+  int           first;      /* first position of the chunk */
+  int           last;       /* last position of the chunk */
+  int           shift;      /* offset of the local positions in the processed segment */
+  int           length;     /* length of the processed segment */
+  int           pair_size;
+  size_t        num;
+  size_t        size;
+  window_event  *events;
+} window_chunk;
+
+typedef struct {
+  vrna_probs_window_callback  *cb;
+  void                        *data;
+} window_output;
+
 /*
  #################################
  # PRIVATE VARIABLES             #
@@ -86,10 +125,6 @@ typedef void (add_QI5)(FLT_OR_DBL **,
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 /* some backward compatibility stuff */
 PRIVATE vrna_fold_compound_t  *backward_compat_compound = NULL;
 PRIVATE int                   backward_compat           = 0;
@@ -227,6 +262,51 @@ backward_compat_callback(FLT_OR_DBL   *pr,
                          void         *data);
 
 
+PRIVATE int
+window_threads(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+probs_window_chunks(vrna_fold_compound_t        *fc,
+                    int                         ulength,
+                    unsigned int                options,
+                    vrna_probs_window_callback  *cb,
+                    void                        *data,
+                    int                         num_threads);
+
+
+PRIVATE window_chunk *
+chunk_init(int  first,
+           int  last,
+           int  n,
+           int  margin,
+           int  pair_size);
+
+
+PRIVATE int
+chunk_fold(window_chunk     *chunk,
+           const char       *nucleotides,
+           vrna_md_t        *md,
+           vrna_exp_param_t *exp_params,
+           int              ulength,
+           unsigned int     options);
+
+
+PRIVATE void
+chunk_store_callback(FLT_OR_DBL   *pr,
+                     int          pr_size,
+                     int          i,
+                     int          max,
+                     unsigned int type,
+                     void         *data);
+
+
+PRIVATE void
+chunk_output(void         *auxdata,
+             unsigned int i,
+             void         *data);
+
+
 PRIVATE FLT_OR_DBL
 sc_contribution(vrna_fold_compound_t  *vc,
                 int                   i,
@@ -674,7 +754,7 @@ vrna_probs_window(vrna_fold_compound_t        *vc,
                   void                        *data)
 {
   unsigned char       hc_decompose;
-  int                 n, i, j, k, maxl, ov, winSize, pairSize, turn;
+  int                 n, i, j, k, maxl, ov, winSize, pairSize, turn, num_threads;
   FLT_OR_DBL          temp, Qmax, qbt1, **q, **qb, **qm, **qm2, **pR;
   double              max_real, *Fwindow;
   vrna_exp_param_t    *pf_params;
@@ -697,6 +777,14 @@ vrna_probs_window(vrna_fold_compound_t        *vc,
     return 0; /* failure */
   }
 
+  /*
+   *  Long sequences may be split into overlapping segments
+   *  that are processed independently by several threads
+   */
+  num_threads = window_threads(vc);
+  if (num_threads > 1)
+    return probs_window_chunks(vc, ulength, options, cb, data, num_threads);
+
   /* here space for initializing everything */
 
   n         = vc->length;
@@ -947,6 +1035,136 @@ vrna_probs_window(vrna_fold_compound_t        *vc,
 }
 
 
+PUBLIC int
+vrna_probs_window_source(vrna_md_t                      *md_p,
+                         int                            ulength,
+                         unsigned int                   options,
+                         vrna_sequence_source_callback  *source,
+                         void                           *source_data,
+                         vrna_probs_window_callback     *cb,
+                         void                           *data)
+{
+  char            *buffer;
+  int             k, b, num, num_threads, chunk_size, margin, pair_size,
+                  offset, avail, target, drop, n, eof, ret;
+  unsigned int    r;
+  vrna_md_t       md;
+  vrna_ostream_t  queue;
+  window_output   output;
+  window_chunk    **chunks;
+
+  if ((!source) || (!cb))
+    return 0; /* failure */
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  if (md.window_size <= 0) {
+    vrna_message_warning("vrna_probs_window_source: "
+                         "Window size must be positive for streamed sequences");
+    return 0; /* failure */
+  }
+
+  num_threads = 1;
+#ifdef _OPENMP
+  num_threads = (md.num_threads == 0) ? omp_get_max_threads() : MAX2(md.num_threads, 1);
+#endif
+  md.num_threads = 1;
+
+  chunk_size  = WINDOW_CHUNK_FACTOR * md.window_size;
+  margin      = MAX2(md.window_size, ulength);
+  pair_size   = ((md.max_bp_span <= 0) || (md.max_bp_span > md.window_size)) ?
+                md.window_size :
+                md.max_bp_span;
+
+  /*
+   *  The buffer holds the nucleotides offset + 1 to offset + avail,
+   *  i.e. the chunks of the current batch and their margins
+   */
+  buffer  = (char *)vrna_alloc(sizeof(char) * (num_threads * chunk_size + 2 * margin + 1));
+  chunks  = (window_chunk **)vrna_alloc(sizeof(window_chunk *) * num_threads);
+  offset  = 0;
+  avail   = 0;
+  eof     = 0;
+  ret     = 1;
+
+  output.cb   = cb;
+  output.data = data;
+
+  queue = vrna_ostream_init(&chunk_output, (void *)&output);
+
+  for (k = 0; ret;) {
+    if (k + num_threads > (INT_MAX - margin) / chunk_size) {
+      vrna_message_warning("vrna_probs_window_source: "
+                           "Sequence too long");
+      ret = 0;
+      break;
+    }
+
+    /* read up to the right margin of the last chunk in this batch */
+    target = (k + num_threads) * chunk_size + margin;
+    while ((!eof) && (offset + avail < target)) {
+      r = source(buffer + avail, (unsigned int)(target - offset - avail), source_data);
+      if (r == 0)
+        eof = 1;
+      else
+        avail += (int)r;
+    }
+
+    n = offset + avail;
+
+    if ((eof) && (k * chunk_size >= n))
+      break;
+
+    for (num = 0; (num < num_threads) && ((k + num) * chunk_size < n); num++) {
+      chunks[num] = chunk_init((k + num) * chunk_size + 1,
+                               (k + num + 1) * chunk_size,
+                               n,
+                               margin,
+                               pair_size);
+      vrna_ostream_request(queue, (unsigned int)(k + num));
+    }
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) reduction(&&:ret)
+    for (b = 0; b < num; b++) {
+      if (!chunk_fold(chunks[b],
+                      buffer + chunks[b]->shift - offset,
+                      &md,
+                      NULL,
+                      ulength,
+                      options))
+        ret = 0;
+
+      vrna_ostream_provide(queue, (unsigned int)(k + b), (void *)chunks[b]);
+    }
+
+    k += num;
+
+    /* remove the nucleotides left of the next chunk's margin */
+    drop = k * chunk_size - margin - offset;
+    if ((drop > 0) && (drop <= avail)) {
+      memmove(buffer, buffer + drop, sizeof(char) * (avail - drop));
+      offset  += drop;
+      avail   -= drop;
+    }
+  }
+
+  /* wait until all chunks have been passed to the callback */
+  vrna_ostream_free(queue);
+
+  free(chunks);
+  free(buffer);
+
+  /* nothing to do for empty sequences */
+  if (offset + avail == 0)
+    ret = 0;
+
+  return ret;
+}
+
+
 PRIVATE FLT_OR_DBL
 sc_contribution(vrna_fold_compound_t  *vc,
                 int                   i,
@@ -2061,6 +2279,272 @@ backward_compat_callback(FLT_OR_DBL   *pr,
 }
 
 
+/*
+ *  Determine the number of threads for the chunk-parallel sliding window
+ *  computations. Returns 1 whenever the whole sequence must be processed
+ *  by a single thread
+ */
+PRIVATE int
+window_threads(vrna_fold_compound_t *fc)
+{
+  int num_threads = 1;
+
+#ifdef _OPENMP
+  num_threads = fc->exp_params->model_details.num_threads;
+
+  /* constraints and grammar extensions are not transferred to the segments */
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->sc) ||
+      (fc->hc->depot) ||
+      (fc->hc->f) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar))
+    return 1;
+
+  /* we require at least two chunks */
+  if ((int)fc->length <= WINDOW_CHUNK_FACTOR * fc->window_size)
+    return 1;
+
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+#endif
+
+  return (num_threads > 1) ? num_threads : 1;
+}
+
+
+/*
+ *  Chunk-parallel sliding window computations
+ *
+ *  The probabilities of any position only depend on the windows that
+ *  contain it. We therefore split the sequence into chunks and process
+ *  each chunk with an additional margin of window_size nucleotides on
+ *  both sides. The margin also covers the dangling end contributions of
+ *  the outermost windows, such that all windows that contain a position
+ *  of the chunk are evaluated exactly as in a scan over the entire
+ *  sequence. Unpaired stretches longer than the window still require
+ *  ulength nucleotides upstream, so the margin is enlarged accordingly.
+ *  The data for positions within the chunk is held back and passed to
+ *  the callback in order of the chunks.
+ */
+PRIVATE int
+probs_window_chunks(vrna_fold_compound_t        *fc,
+                    int                         ulength,
+                    unsigned int                options,
+                    vrna_probs_window_callback  *cb,
+                    void                        *data,
+                    int                         num_threads)
+{
+  int             n, k, num_chunks, chunk_size, margin, ret;
+  vrna_md_t       md;
+  vrna_ostream_t  queue;
+  window_output   output;
+
+  n           = (int)fc->length;
+  chunk_size  = WINDOW_CHUNK_FACTOR * fc->window_size;
+  margin      = MAX2(fc->window_size, ulength);
+  num_chunks  = (n + chunk_size - 1) / chunk_size;
+  ret         = 1;
+
+  output.cb   = cb;
+  output.data = data;
+
+  md              = fc->exp_params->model_details;
+  md.num_threads  = 1;
+
+  queue = vrna_ostream_init(&chunk_output, (void *)&output);
+
+  for (k = 0; k < num_chunks; k++)
+    vrna_ostream_request(queue, (unsigned int)k);
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) reduction(&&:ret)
+  for (k = 0; k < num_chunks; k++) {
+    window_chunk *chunk;
+
+    chunk = chunk_init(k * chunk_size + 1,
+                       (k + 1) * chunk_size,
+                       n,
+                       margin,
+                       md.max_bp_span);
+
+    /* use the exact same Boltzmann factors and scaling */
+    if (!chunk_fold(chunk,
+                    fc->sequence + chunk->shift,
+                    &md,
+                    fc->exp_params,
+                    ulength,
+                    options))
+      ret = 0;
+
+    vrna_ostream_provide(queue, (unsigned int)k, (void *)chunk);
+  }
+
+  /* wait until all chunks have been passed to the callback */
+  vrna_ostream_free(queue);
+
+  return ret;
+}
+
+
+PRIVATE window_chunk *
+chunk_init(int  first,
+           int  last,
+           int  n,
+           int  margin,
+           int  pair_size)
+{
+  int           start, end;
+  window_chunk  *chunk;
+
+  chunk         = (window_chunk *)vrna_alloc(sizeof(window_chunk));
+  chunk->first  = first;
+  chunk->last   = MIN2(last, n);
+
+  start = MAX2(1, chunk->first - margin);
+  end   = MIN2(n, chunk->last + margin);
+
+  chunk->shift      = start - 1;
+  chunk->length     = end - start + 1;
+  chunk->pair_size  = pair_size;
+  chunk->num        = 0;
+  chunk->size       = 0;
+  chunk->events     = NULL;
+
+  return chunk;
+}
+
+
+/*
+ *  Scan the segment of a chunk that starts with the nucleotide
+ *  pointed to by nucleotides, and store the data for the positions
+ *  within the chunk. If exp_params is NULL, the Boltzmann factors
+ *  are derived from the model details md.
+ */
+PRIVATE int
+chunk_fold(window_chunk     *chunk,
+           const char       *nucleotides,
+           vrna_md_t        *md,
+           vrna_exp_param_t *exp_params,
+           int              ulength,
+           unsigned int     options)
+{
+  char                  *segment;
+  int                   ret;
+  vrna_fold_compound_t  *worker;
+
+  ret     = 0;
+  segment = (char *)vrna_alloc(sizeof(char) * (chunk->length + 1));
+  memcpy(segment, nucleotides, sizeof(char) * chunk->length);
+
+  worker = vrna_fold_compound(segment, md, VRNA_OPTION_PF | VRNA_OPTION_WINDOW);
+
+  if (worker) {
+    if (exp_params)
+      vrna_exp_params_subst(worker, exp_params);
+
+    worker->exp_params->model_details.num_threads = 1;
+
+    ret = vrna_probs_window(worker, ulength, options, &chunk_store_callback, (void *)chunk);
+
+    vrna_fold_compound_free(worker);
+  }
+
+  free(segment);
+
+  return ret;
+}
+
+
+PRIVATE void
+chunk_store_callback(FLT_OR_DBL   *pr,
+                     int          pr_size,
+                     int          i,
+                     int          max,
+                     unsigned int type,
+                     void         *data)
+{
+  int           pos, from, to, shift;
+  window_chunk  *chunk;
+  window_event  *e;
+
+  chunk = (window_chunk *)data;
+  shift = chunk->shift;
+
+  /* position the data belongs to, and range of valid entries in pr */
+  if (type & VRNA_PROBS_WINDOW_BPP) {
+    pos   = i;
+    from  = i;
+    to    = pr_size;
+  } else if (type & VRNA_PROBS_WINDOW_UP) {
+    pos   = i;
+    from  = 0;
+    to    = pr_size;
+  } else if (type & VRNA_PROBS_WINDOW_PF) {
+    pos   = pr_size;
+    from  = i;
+    to    = pr_size;
+  } else if (type & VRNA_PROBS_WINDOW_STACKP) {
+    pos   = i;
+    from  = i + 1;
+    to    = MIN2(i + chunk->pair_size, chunk->length);
+  } else {
+    return;
+  }
+
+  if ((pos + shift < chunk->first) ||
+      (pos + shift > chunk->last))
+    return;
+
+  if (chunk->num == chunk->size) {
+    chunk->size   = (chunk->size) ? 2 * chunk->size : 1024;
+    chunk->events = (window_event *)vrna_realloc(chunk->events,
+                                                 sizeof(window_event) * chunk->size);
+  }
+
+  e       = &(chunk->events[chunk->num++]);
+  e->pr   = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * MAX2(to - from + 1, 1));
+  e->type = type;
+  e->max  = max;
+  e->i    = i + shift;
+
+  if (to >= from)
+    memcpy(e->pr, pr + from, sizeof(FLT_OR_DBL) * (to - from + 1));
+
+  /* unpaired probabilities are indexed by the length of the unpaired stretch */
+  if (type & VRNA_PROBS_WINDOW_UP) {
+    e->offset   = from;
+    e->pr_size  = pr_size;
+  } else {
+    e->offset   = from + shift;
+    e->pr_size  = (type & VRNA_PROBS_WINDOW_STACKP) ? pr_size : pr_size + shift;
+  }
+}
+
+
+PRIVATE void
+chunk_output(void         *auxdata,
+             unsigned int i,
+             void         *data)
+{
+  size_t        k;
+  window_output *output;
+  window_chunk  *chunk;
+  window_event  *e;
+
+  output  = (window_output *)auxdata;
+  chunk   = (window_chunk *)data;
+
+  for (k = 0; k < chunk->num; k++) {
+    e = &(chunk->events[k]);
+    output->cb(e->pr - e->offset, e->pr_size, e->i, e->max, e->type, output->data);
+    free(e->pr);
+  }
+
+  free(chunk->events);
+  free(chunk);
+}
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 /*
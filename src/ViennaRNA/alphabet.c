@@ -62,6 +62,14 @@ PRIVATE char *wrap_get_ptypes(const short *S,
                               vrna_md_t   *md);                 /* provides backward compatibility for old ptypes array in pf computations */
 
 
+PRIVATE void
+fill_ptypes(char        *ptype,
+            const short *S,
+            vrna_md_t   *md,
+            int         *idx,
+            int         max_span);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -220,8 +228,7 @@ vrna_ptypes(const short *S,
             vrna_md_t   *md)
 {
   char  *ptype;
-  int   n, i, j, k, l, *idx;
-  int   min_loop_size = md->min_loop_size;
+  int   n, *idx;
 
   n = S[0];
 
@@ -234,29 +241,34 @@ vrna_ptypes(const short *S,
   ptype = (char *)vrna_alloc(sizeof(char) * ((n * (n + 1)) / 2 + 2));
   idx   = vrna_idx_col_wise(n);
 
-  for (k = 1; k < n - min_loop_size; k++)
-    for (l = 1; l <= 2; l++) {
-      int type, ntype = 0, otype = 0;
-      i = k;
-      j = i + min_loop_size + l;
-      if (j > n)
-        continue;
+  fill_ptypes(ptype, S, md, idx, n);
 
-      type = md->pair[S[i]][S[j]];
-      while ((i >= 1) && (j <= n)) {
-        if ((i > 1) && (j < n))
-          ntype = md->pair[S[i - 1]][S[j + 1]];
+  free(idx);
+  return ptype;
+}
 
-        if (md->noLP && (!otype) && (!ntype))
-          type = 0; /* i.j can only form isolated pairs */
 
-        ptype[idx[j] + i] = (char)type;
-        otype             = type;
-        type              = ntype;
-        i--;
-        j++;
-      }
-    }
+PUBLIC char *
+vrna_ptypes_banded(const short  *S,
+                   vrna_md_t    *md,
+                   unsigned int band)
+{
+  char  *ptype;
+  int   n, *idx;
+
+  n = S[0];
+
+  if ((unsigned int)n > vrna_sequence_length_max(VRNA_OPTION_DEFAULT)) {
+    vrna_message_warning("vrna_ptypes_banded@alphabet.c: sequence length of %d exceeds addressable range",
+                         n);
+    return NULL;
+  }
+
+  ptype = (char *)vrna_alloc(sizeof(char) * ((n + 2) * (band + 1)));
+  idx   = vrna_idx_col_wise_banded(n, band);
+
+  fill_ptypes(ptype, S, md, idx, (int)band);
+
   free(idx);
   return ptype;
 }
@@ -478,6 +490,44 @@ vrna_get_ptype_window(int   i,
 }
 
 
+PRIVATE void
+fill_ptypes(char        *ptype,
+            const short *S,
+            vrna_md_t   *md,
+            int         *idx,
+            int         max_span)
+{
+  int n, i, j, k, l;
+  int min_loop_size = md->min_loop_size;
+
+  n = S[0];
+
+  for (k = 1; k < n - min_loop_size; k++)
+    for (l = 1; l <= 2; l++) {
+      int type, ntype = 0, otype = 0;
+      i = k;
+      j = i + min_loop_size + l;
+      if (j > n)
+        continue;
+
+      type = md->pair[S[i]][S[j]];
+      while ((i >= 1) && (j <= n) && (j - i <= max_span)) {
+        if ((i > 1) && (j < n))
+          ntype = md->pair[S[i - 1]][S[j + 1]];
+
+        if (md->noLP && (!otype) && (!ntype))
+          type = 0; /* i.j can only form isolated pairs */
+
+        ptype[idx[j] + i] = (char)type;
+        otype             = type;
+        type              = ntype;
+        i--;
+        j++;
+      }
+    }
+}
+
+
 PRIVATE char *
 wrap_get_ptypes(const short *S,
                 vrna_md_t   *md)
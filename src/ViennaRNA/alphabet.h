@@ -57,6 +57,20 @@ vrna_ptypes(const short *S,
             vrna_md_t   *md);
 
 
+/**
+ *  @brief Get an array of the numerical encoding for each possible base pair (i,j) in banded layout
+ *
+ *  Same as vrna_ptypes(), but only base pairs with @f$j - i \leq band@f$ are stored.
+ *
+ *  @see  vrna_idx_col_wise_banded(), vrna_ptypes()
+ *
+ */
+char *
+vrna_ptypes_banded(const short  *S,
+                   vrna_md_t    *md,
+                   unsigned int band);
+
+
 /**
  *  @brief Get a numerical representation of the nucleotide sequence
  *
@@ -14,6 +14,7 @@
 #include <string.h>
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/default.h"
@@ -23,8 +24,13 @@
 #include "ViennaRNA/constraints/hard.h"
 #include "ViennaRNA/constraints/soft.h"
 #include "ViennaRNA/alphabet.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "ViennaRNA/boltzmann_sampling.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/loops/external_sc_pf.inc"
 #include "ViennaRNA/loops/internal_sc_pf.inc"
 #include "ViennaRNA/loops/multibranch_sc_pf.inc"
@@ -57,16 +63,55 @@ struct sc_wrappers {
   struct sc_wrapper_exp_ml  sc_wrapper_ml;
 };
 
+/* partition function entries whose decompositions may be cached */
+#define SAMPLE_TABLE_EXT  0   /* exterior loop, i.e. q1k[j] or qln[i] */
+#define SAMPLE_TABLE_QB   1
+#define SAMPLE_TABLE_QM   2
+#define SAMPLE_TABLE_QM1  3
+#define SAMPLE_TABLE_NUM  4
+
+/*
+ * Cumulative Boltzmann weights of all decompositions of a partition
+ * function entry in the order they are enumerated during backtracking.
+ * The meaning of the split points k and l depends on the entry type
+ */
+struct sample_table {
+  unsigned int  num;
+  unsigned int  size;
+  FLT_OR_DBL    *cum;
+  int           *k;
+  int           *l;
+};
+
+/*
+ * Lazily filled cumulative weight tables for each entry [i][j - i] of
+ * each type, and the partition function they have been computed for
+ */
+struct sample_cache {
+  unsigned int        length;
+  FLT_OR_DBL          pf;
+  struct sample_table ***tables[SAMPLE_TABLE_NUM];
+};
+
 /*
  * In the following:
  * - q_remain is a pointer to value of sum of Boltzmann factors of still accessible solutions at that point
  * - current_node is a pointer to current node in datastructure memorizing the solutions and paths taken
+ * - cache holds the cumulative weight tables for regular sampling, where root_node remains unset
  */
 struct vrna_pbacktrack_memory_s {
-  double            q_remain;
-  NR_NODE           *root_node;
-  NR_NODE           *current_node;
-  struct nr_memory  *memory_dat;
+  double              q_remain;
+  NR_NODE             *root_node;
+  NR_NODE             *current_node;
+  struct nr_memory    *memory_dat;
+  struct sample_cache *cache;
+};
+
+/* delivery of samples drawn in parallel */
+struct sample_output {
+  vrna_boltzmann_sampling_callback  *cb;
+  void                              *data;
+  unsigned int                      limit;  /* index of the first failed sample */
 };
 
 /*
@@ -103,6 +148,27 @@ PRIVATE char  *info_no_circ =
   "No implementation for circular RNAs available.";
 
 
+PRIVATE char  *info_mem_mode =
+  "Boltzmann sampling memory was initialized for a different sampling mode!";
+
+
+/*
+ *  State of the random number stream of the current sample in parallel
+ *  sampling mode. If unset, random numbers are drawn from vrna_urn()
+ */
+PRIVATE uint64_t *urn_state = NULL;
+
+#ifdef _OPENMP
+#pragma omp threadprivate(urn_state)
+#endif
+
+/*
+ *  Marks the sample that terminated parallel sampling, whereas samples
+ *  that are skipped due to a backtracking error are passed as NULL
+ */
+PRIVATE char sample_failed;
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -113,6 +179,81 @@ PRIVATE struct vrna_pbacktrack_memory_s *
 nr_init(vrna_fold_compound_t *fc);
 
 
+PRIVATE struct vrna_pbacktrack_memory_s *
+cache_init(vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+cache_update(struct sample_cache  *cache,
+             vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+cache_flush(struct sample_cache *cache);
+
+
+PRIVATE void
+cache_free(struct sample_cache *cache);
+
+
+PRIVATE struct sample_table *
+cache_table(struct sample_cache   *cache,
+            unsigned int          type,
+            int                   i,
+            int                   j,
+            vrna_fold_compound_t  *fc,
+            struct sc_wrappers    *sc_wrap);
+
+
+PRIVATE INLINE unsigned int
+sample_table_search(struct sample_table *table,
+                    FLT_OR_DBL          r,
+                    int                 strict);
+
+
+PRIVATE struct sample_table *
+sample_table_init(unsigned int max_num);
+
+
+PRIVATE INLINE void
+sample_table_add(struct sample_table  *table,
+                 FLT_OR_DBL           cum,
+                 int                  k,
+                 int                  l);
+
+
+PRIVATE void
+sample_table_free(struct sample_table *table);
+
+
+PRIVATE struct sample_table *
+sample_table_ext(vrna_fold_compound_t *fc,
+                 int                  i,
+                 int                  j,
+                 struct sc_wrappers   *sc_wrap);
+
+
+PRIVATE struct sample_table *
+sample_table_qb(vrna_fold_compound_t  *fc,
+                int                   i,
+                int                   j,
+                struct sc_wrappers    *sc_wrap);
+
+
+PRIVATE struct sample_table *
+sample_table_qm(vrna_fold_compound_t  *fc,
+                int                   i,
+                int                   j,
+                struct sc_wrappers    *sc_wrap);
+
+
+PRIVATE struct sample_table *
+sample_table_qm1(vrna_fold_compound_t *fc,
+                 int                  i,
+                 int                  j,
+                 struct sc_wrappers   *sc_wrap);
+
+
 PRIVATE struct sc_wrappers *
 sc_init(vrna_fold_compound_t *fc);
 
@@ -127,7 +268,32 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
                 void                              *data,
-                struct vrna_pbacktrack_memory_s   *nr_mem);
+                struct vrna_pbacktrack_memory_s   *nr_mem,
+                unsigned int                      options);
+
+
+PRIVATE unsigned int
+pbacktrack_parallel(vrna_fold_compound_t              *vc,
+                    unsigned int                      length,
+                    unsigned int                      num_samples,
+                    vrna_boltzmann_sampling_callback  *bs_cb,
+                    void                              *data,
+                    struct vrna_pbacktrack_memory_s   *mem,
+                    unsigned int                      options);
+
+
+PRIVATE void
+output_sample(void          *auxdata,
+              unsigned int  i,
+              void          *data);
+
+
+PRIVATE INLINE double
+sample_urn(void);
+
+
+PRIVATE INLINE uint64_t
+mix_seed(uint64_t x);
 
 
 PRIVATE int
@@ -195,7 +361,8 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
                            vrna_pbacktrack_mem_t            *nr_mem,
                            unsigned int                     options)
 {
-  unsigned int i = 0;
+  unsigned int                    i = 0;
+  struct vrna_pbacktrack_memory_s *mem;
 
   if (fc) {
     vrna_mx_pf_t *matrices = fc->exp_matrices;
@@ -216,11 +383,13 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
         vrna_message_warning("vrna_pbacktrack5*(): %s", info_no_circ);
       } else if (!nr_mem) {
         vrna_message_warning("vrna_pbacktrack5*(): Pointer to nr_mem must not be NULL!");
+      } else if ((*nr_mem) && (!(*nr_mem)->root_node)) {
+        vrna_message_warning("vrna_pbacktrack5*(): %s", info_mem_mode);
       } else {
         if (*nr_mem == NULL)
           *nr_mem = nr_init(fc);
 
-        i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, *nr_mem);
+        i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, *nr_mem, options);
 
         /* print warning if we've aborted backtracking too early */
         if ((i > 0) && (i < num_samples)) {
@@ -231,13 +400,29 @@ vrna_pbacktrack5_resume_cb(vrna_fold_compound_t             *fc,
                                i,
                                100. *
                                return_node_weight((*nr_mem)->root_node) /
-                               fc->exp_matrices->q[fc->iindx[1] - length]);
+                               ((fc->band) ?
+                                fc->exp_matrices->q1k[length] :
+                                fc->exp_matrices->q[fc->iindx[1] - length]));
         }
       }
     } else if (fc->exp_params->model_details.circ) {
       i = pbacktrack_circ(fc, num_samples, bs_cb, data);
     } else {
-      i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, NULL);
+      mem = NULL;
+
+      if ((options & VRNA_PBACKTRACK_CACHE) && (nr_mem)) {
+        if (*nr_mem == NULL)
+          *nr_mem = cache_init(fc);
+
+        if ((*nr_mem)->root_node) {
+          vrna_message_warning("vrna_pbacktrack5*(): %s", info_mem_mode);
+        } else {
+          mem = *nr_mem;
+          cache_update(mem->cache, fc);
+        }
+      }
+
+      i = wrap_pbacktrack(fc, length, num_samples, bs_cb, data, mem, options);
     }
   }
 
@@ -249,11 +434,15 @@ PUBLIC void
 vrna_pbacktrack_mem_free(struct vrna_pbacktrack_memory_s *s)
 {
   if (s) {
+    if (s->root_node) {
 #ifdef VRNA_NR_SAMPLING_HASH
-    free_all_nr(s->current_node);
+      free_all_nr(s->current_node);
 #else
-    free_all_nrll(&(s->memory_dat));
+      free_all_nrll(&(s->memory_dat));
 #endif
+    }
+
+    cache_free(s->cache);
     free(s);
   }
 }
@@ -297,7 +486,9 @@ nr_init(vrna_fold_compound_t *fc)
 
   s = (struct vrna_pbacktrack_memory_s *)vrna_alloc(
     sizeof(struct vrna_pbacktrack_memory_s));
-  pf          = fc->exp_matrices->q[fc->iindx[1] - fc->length];
+  pf          = (fc->band) ?
+                fc->exp_matrices->q1k[fc->length] :
+                fc->exp_matrices->q[fc->iindx[1] - fc->length];
   block_size  = 5000 * sizeof(NR_NODE);
 
   s->memory_dat = NULL;
@@ -316,6 +507,692 @@ nr_init(vrna_fold_compound_t *fc)
 }
 
 
+PRIVATE struct vrna_pbacktrack_memory_s *
+cache_init(vrna_fold_compound_t *fc)
+{
+  struct vrna_pbacktrack_memory_s *s;
+
+  s = (struct vrna_pbacktrack_memory_s *)vrna_alloc(
+    sizeof(struct vrna_pbacktrack_memory_s));
+  s->cache = (struct sample_cache *)vrna_alloc(sizeof(struct sample_cache));
+
+  cache_update(s->cache, fc);
+
+  return s;
+}
+
+
+/* drop all tables if they have been computed for a different partition function */
+PRIVATE void
+cache_update(struct sample_cache  *cache,
+             vrna_fold_compound_t *fc)
+{
+  unsigned int  type;
+  FLT_OR_DBL    pf;
+
+  pf = (fc->band) ?
+       fc->exp_matrices->q1k[fc->length] :
+       fc->exp_matrices->q[fc->iindx[1] - fc->length];
+
+  if ((cache->tables[0]) &&
+      (cache->length == fc->length) &&
+      (cache->pf == pf))
+    return;
+
+  cache_flush(cache);
+
+  cache->length = fc->length;
+  cache->pf     = pf;
+
+  for (type = 0; type < SAMPLE_TABLE_NUM; type++)
+    cache->tables[type] = (struct sample_table ***)vrna_alloc(
+      sizeof(struct sample_table **) * (fc->length + 1));
+}
+
+
+PRIVATE void
+cache_flush(struct sample_cache *cache)
+{
+  unsigned int        type, i, d;
+  struct sample_table **row;
+
+  for (type = 0; type < SAMPLE_TABLE_NUM; type++) {
+    if (cache->tables[type]) {
+      for (i = 1; i <= cache->length; i++) {
+        row = cache->tables[type][i];
+        if (row) {
+          for (d = 0; d <= cache->length - i; d++)
+            sample_table_free(row[d]);
+
+          free(row);
+        }
+      }
+
+      free(cache->tables[type]);
+      cache->tables[type] = NULL;
+    }
+  }
+}
+
+
+PRIVATE void
+cache_free(struct sample_cache *cache)
+{
+  if (cache) {
+    cache_flush(cache);
+    free(cache);
+  }
+}
+
+
+/*
+ *  Retrieve the table for entry (i, j) of a particular type and build it on
+ *  first access. Since the cache may be shared among parallel sampling
+ *  threads, tables are built outside and stored inside a critical section
+ */
+PRIVATE struct sample_table *
+cache_table(struct sample_cache   *cache,
+            unsigned int          type,
+            int                   i,
+            int                   j,
+            vrna_fold_compound_t  *fc,
+            struct sc_wrappers    *sc_wrap)
+{
+  struct sample_table *table, *stored, **row;
+
+#ifdef _OPENMP
+#pragma omp critical (pbacktrack_cache)
+#endif
+  {
+    row   = cache->tables[type][i];
+    table = (row) ? row[j - i] : NULL;
+  }
+
+  if (table)
+    return table;
+
+  switch (type) {
+    case SAMPLE_TABLE_EXT:
+      table = sample_table_ext(fc, i, j, sc_wrap);
+      break;
+
+    case SAMPLE_TABLE_QB:
+      table = sample_table_qb(fc, i, j, sc_wrap);
+      break;
+
+    case SAMPLE_TABLE_QM:
+      table = sample_table_qm(fc, i, j, sc_wrap);
+      break;
+
+    default:
+      table = sample_table_qm1(fc, i, j, sc_wrap);
+      break;
+  }
+
+  /* release unused memory */
+  if ((table->num > 0) && (table->num < table->size)) {
+    table->cum  = (FLT_OR_DBL *)vrna_realloc(table->cum, sizeof(FLT_OR_DBL) * table->num);
+    table->k    = (int *)vrna_realloc(table->k, sizeof(int) * table->num);
+    table->l    = (int *)vrna_realloc(table->l, sizeof(int) * table->num);
+    table->size = table->num;
+  }
+
+#ifdef _OPENMP
+#pragma omp critical (pbacktrack_cache)
+#endif
+  {
+    row = cache->tables[type][i];
+    if (!row) {
+      row = (struct sample_table **)vrna_alloc(sizeof(struct sample_table *) *
+                                               (cache->length - i + 1));
+      cache->tables[type][i] = row;
+    }
+
+    stored = row[j - i];
+    if (!stored)
+      row[j - i] = table;
+  }
+
+  /* another thread has been faster */
+  if (stored) {
+    sample_table_free(table);
+    table = stored;
+  }
+
+  return table;
+}
+
+
+/*
+ *  Find the first decomposition whose cumulative weight reaches r,
+ *  i.e. cum >= r, or exceeds r if strict is set. This is the same
+ *  decomposition a linear scan would have stopped at
+ */
+PRIVATE INLINE unsigned int
+sample_table_search(struct sample_table *table,
+                    FLT_OR_DBL          r,
+                    int                 strict)
+{
+  unsigned int lo, hi, mid;
+
+  lo  = 0;
+  hi  = table->num;
+
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if ((table->cum[mid] > r) || ((!strict) && (table->cum[mid] == r)))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  return lo;
+}
+
+
+PRIVATE struct sample_table *
+sample_table_init(unsigned int max_num)
+{
+  struct sample_table *table;
+
+  table       = (struct sample_table *)vrna_alloc(sizeof(struct sample_table));
+  table->num  = 0;
+  table->size = MAX2(max_num, 1);
+  table->cum  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * table->size);
+  table->k    = (int *)vrna_alloc(sizeof(int) * table->size);
+  table->l    = (int *)vrna_alloc(sizeof(int) * table->size);
+
+  return table;
+}
+
+
+PRIVATE INLINE void
+sample_table_add(struct sample_table  *table,
+                 FLT_OR_DBL           cum,
+                 int                  k,
+                 int                  l)
+{
+  if (table->num == table->size) {
+    table->size *= 2;
+    table->cum  = (FLT_OR_DBL *)vrna_realloc(table->cum, sizeof(FLT_OR_DBL) * table->size);
+    table->k    = (int *)vrna_realloc(table->k, sizeof(int) * table->size);
+    table->l    = (int *)vrna_realloc(table->l, sizeof(int) * table->size);
+  }
+
+  table->cum[table->num]  = cum;
+  table->k[table->num]    = k;
+  table->l[table->num]    = l;
+  table->num++;
+}
+
+
+PRIVATE void
+sample_table_free(struct sample_table *table)
+{
+  if (table) {
+    free(table->cum);
+    free(table->k);
+    free(table->l);
+    free(table);
+  }
+}
+
+
+/*
+ *  The following functions enumerate the decompositions of a partition
+ *  function entry exactly like the corresponding backtracking functions
+ *  do in regular sampling mode, but store the cumulative weights instead
+ *  of comparing them against a random number
+ */
+
+/*
+ *  Pairs (k, j) in the exterior loop of q1k[j] (Boustrophedon scheme), or
+ *  pairs (i, k) in the exterior loop of qln[i] with k <= j otherwise
+ */
+PRIVATE struct sample_table *
+sample_table_ext(vrna_fold_compound_t *fc,
+                 int                  i,
+                 int                  j,
+                 struct sc_wrappers   *sc_wrap)
+{
+  unsigned char             *hard_constraints;
+  short                     *S1, *S2, **S, **S5, **S3;
+  unsigned int              **a2s, s, n_seq;
+  int                       n, ij, type, *my_iindx;
+  FLT_OR_DBL                qt, qkl, *qb;
+  vrna_exp_param_t          *pf_params;
+  vrna_md_t                 *md;
+  struct sample_table       *table;
+
+#ifdef VRNA_WITH_BOUSTROPHEDON
+  int                       k, u;
+  FLT_OR_DBL                *q1k;
+#else
+  int                       length;
+  FLT_OR_DBL                *qln;
+  struct sc_wrapper_exp_ext *sc_wrapper_ext;
+#endif
+
+  n                 = fc->length;
+  pf_params         = fc->exp_params;
+  md                = &(pf_params->model_details);
+  my_iindx          = fc->iindx;
+  hard_constraints  = fc->hc->mx;
+  qb                = fc->exp_matrices->qb;
+
+  if (fc->type == VRNA_FC_TYPE_SINGLE) {
+    n_seq = 1;
+    S1    = fc->sequence_encoding;
+    S2    = fc->sequence_encoding2;
+    S     = NULL;
+    S5    = NULL;
+    S3    = NULL;
+    a2s   = NULL;
+  } else {
+    n_seq = fc->n_seq;
+    S1    = NULL;
+    S2    = NULL;
+    S     = fc->S;
+    S5    = fc->S5;
+    S3    = fc->S3;
+    a2s   = fc->a2s;
+  }
+
+#ifdef VRNA_WITH_BOUSTROPHEDON
+  q1k   = fc->exp_matrices->q1k;
+  table = sample_table_init(j - 1);
+  u     = j - 1;
+
+  for (qt = 0, k = 1; k < j; k++) {
+    /* apply alternating boustrophedon scheme to variable i */
+    i = (int)(1 + (u - 1) * ((k - 1) % 2)) +
+        (int)((1 - (2 * ((k - 1) % 2))) * ((k - 1) / 2));
+    ij = my_iindx[i] - j;
+    if (hard_constraints[n * j + i] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
+      qkl = qb[ij] *
+            q1k[i - 1];
+
+      if (fc->type == VRNA_FC_TYPE_SINGLE) {
+        type  = vrna_get_ptype_md(S2[i], S2[j], md);
+        qkl   *= vrna_exp_E_ext_stem(type,
+                                     (i > 1) ? S1[i - 1] : -1,
+                                     (j < n) ? S1[j + 1] : -1,
+                                     pf_params);
+      } else {
+        for (s = 0; s < n_seq; s++) {
+          type  = vrna_get_ptype_md(S[s][i], S[s][j], md);
+          qkl   *= vrna_exp_E_ext_stem(type,
+                                       (a2s[s][i] > 1) ? S5[s][i] : -1,
+                                       (a2s[s][j] < a2s[s][n]) ? S3[s][j] : -1,
+                                       pf_params);
+        }
+      }
+
+      qt += qkl;
+      sample_table_add(table, qt, i, 0);
+    }
+  }
+
+#else
+  qln             = fc->exp_matrices->qln;
+  sc_wrapper_ext  = &(sc_wrap->sc_wrapper_ext);
+  length          = j;
+  table           = sample_table_init(length - i);
+
+  for (qt = 0, j = i + 1; j <= length; j++) {
+    ij = my_iindx[i] - j;
+    if (hard_constraints[n * i + j] & VRNA_CONSTRAINT_CONTEXT_EXT_LOOP) {
+      qkl = qb[ij];
+      if (fc->type == VRNA_FC_TYPE_SINGLE) {
+        type  = vrna_get_ptype_md(S2[i], S2[j], md);
+        qkl   *= vrna_exp_E_ext_stem(type,
+                                     (i > 1) ? S1[i - 1] : -1,
+                                     (j < n) ? S1[j + 1] : -1,
+                                     pf_params);
+      } else {
+        for (s = 0; s < n_seq; s++) {
+          type  = vrna_get_ptype_md(S[s][i], S[s][j], md);
+          qkl   *= vrna_exp_E_ext_stem(type,
+                                       (a2s[s][i] > 1) ? S5[s][i] : -1,
+                                       (a2s[s][j] < a2s[s][n]) ? S3[s][j] : -1,
+                                       pf_params);
+        }
+      }
+
+      if (j < length) {
+        qkl *= qln[j + 1];
+        if (sc_wrapper_ext->split)
+          qkl *= sc_wrapper_ext->split(i, length, j + 1, sc_wrapper_ext) *
+                 sc_wrapper_ext->red_stem(i, j, i, j, sc_wrapper_ext);
+      } else if (sc_wrapper_ext->red_stem) {
+        qkl *= sc_wrapper_ext->red_stem(i, j, i, j, sc_wrapper_ext);
+      }
+
+      qt += qkl;
+      sample_table_add(table, qt, j, 0);
+    }
+  }
+#endif
+
+  return table;
+}
+
+
+/*
+ *  Hairpin (k = 0), interior loops (k, l), and multibranch loops with the
+ *  last branch starting at k (l = 0) closed by pair (i, j)
+ */
+PRIVATE struct sample_table *
+sample_table_qb(vrna_fold_compound_t  *fc,
+                int                   i,
+                int                   j,
+                struct sc_wrappers    *sc_wrap)
+{
+  unsigned char             *hard_constraints;
+  char                      *ptype;
+  short                     *S1, **S, **S5, **S3;
+  unsigned int              **a2s, s, n_seq, n, type, type_2, *types, u1_local, u2_local;
+  int                       *my_iindx, *jindx, *hc_up_int, turn, *rtype,
+                            k, l, kl, u1, u2, max_k, min_l, ii, jj;
+  FLT_OR_DBL                *qb, *qm, *qm1, *scale, qbt1, qt, q_temp, closingPair, expMLclosing;
+  vrna_exp_param_t          *pf_params;
+  vrna_md_t                 *md;
+  struct sc_wrapper_exp_int *sc_wrapper_int;
+  struct sc_wrapper_exp_ml  *sc_wrapper_ml;
+  struct sample_table       *table;
+
+  n                 = fc->length;
+  pf_params         = fc->exp_params;
+  md                = &(pf_params->model_details);
+  my_iindx          = fc->iindx;
+  jindx             = fc->jindx;
+  turn              = md->min_loop_size;
+  rtype             = &(md->rtype[0]);
+  hc_up_int         = fc->hc->up_int;
+  hard_constraints  = fc->hc->mx;
+  sc_wrapper_int    = &(sc_wrap->sc_wrapper_int);
+  sc_wrapper_ml     = &(sc_wrap->sc_wrapper_ml);
+  qb                = fc->exp_matrices->qb;
+  qm                = fc->exp_matrices->qm;
+  qm1               = fc->exp_matrices->qm1;
+  scale             = fc->exp_matrices->scale;
+  type              = 0;
+
+  if (fc->type == VRNA_FC_TYPE_SINGLE) {
+    n_seq         = 1;
+    ptype         = fc->ptype;
+    types         = NULL;
+    S1            = fc->sequence_encoding;
+    S             = NULL;
+    S5            = NULL;
+    S3            = NULL;
+    a2s           = NULL;
+    expMLclosing  = pf_params->expMLclosing;
+    type          = vrna_get_ptype(jindx[j] + i, ptype);
+  } else {
+    n_seq         = fc->n_seq;
+    ptype         = NULL;
+    types         = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
+    S1            = NULL;
+    S             = fc->S;
+    S5            = fc->S5;
+    S3            = fc->S3;
+    a2s           = fc->a2s;
+    expMLclosing  = pow(pf_params->expMLclosing, (double)n_seq);
+    for (s = 0; s < n_seq; s++)
+      types[s] = vrna_get_ptype_md(S[s][i], S[s][j], md);
+  }
+
+  table = sample_table_init(j - i);
+
+  /* hairpin contribution */
+  qbt1  = 0.;
+  qbt1  += vrna_exp_E_hp_loop(fc, i, j);
+  sample_table_add(table, qbt1, 0, 0);
+
+  if (hard_constraints[n * i + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
+    /* interior loop contributions */
+    max_k = i + MAXLOOP + 1;
+    max_k = MIN2(max_k, j - turn - 2);
+    max_k = MIN2(max_k, i + 1 + hc_up_int[i + 1]);
+    for (k = i + 1; k <= max_k; k++) {
+      u1    = k - i - 1;
+      min_l = MAX2(k + turn + 1, j - 1 - MAXLOOP + u1);
+      kl    = my_iindx[k] - j + 1;
+      for (u2 = 0, l = j - 1; l >= min_l; l--, kl++, u2++) {
+        if (hc_up_int[l + 1] < u2)
+          break;
+
+        if (hard_constraints[n * k + l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+          q_temp = qb[kl]
+                   * scale[u1 + u2 + 2];
+
+          if (fc->type == VRNA_FC_TYPE_SINGLE) {
+            type_2  = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
+            q_temp  *= exp_E_IntLoop(u1,
+                                     u2,
+                                     type,
+                                     type_2,
+                                     S1[i + 1],
+                                     S1[j - 1],
+                                     S1[k - 1],
+                                     S1[l + 1],
+                                     pf_params);
+          } else {
+            for (s = 0; s < n_seq; s++) {
+              u1_local  = a2s[s][k - 1] - a2s[s][i];
+              u2_local  = a2s[s][j - 1] - a2s[s][l];
+              type_2    = vrna_get_ptype_md(S[s][l], S[s][k], md);
+              q_temp    *= exp_E_IntLoop(u1_local,
+                                         u2_local,
+                                         types[s],
+                                         type_2,
+                                         S3[s][i],
+                                         S5[s][j],
+                                         S5[s][k],
+                                         S3[s][l],
+                                         pf_params);
+            }
+          }
+
+          if (sc_wrapper_int->pair)
+            q_temp *= sc_wrapper_int->pair(i, j, k, l, sc_wrapper_int);
+
+          qbt1 += q_temp;
+          sample_table_add(table, qbt1, k, l);
+        }
+      }
+    }
+  }
+
+  if (hard_constraints[n * j + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+    /* multibranch loop contributions */
+    closingPair = expMLclosing *
+                  scale[2];
+
+    if (fc->type == VRNA_FC_TYPE_SINGLE) {
+      type        = rtype[vrna_get_ptype(jindx[j] + i, ptype)];
+      closingPair *= exp_E_MLstem(type, S1[j - 1], S1[i + 1], pf_params);
+    } else {
+      for (s = 0; s < n_seq; s++) {
+        type        = vrna_get_ptype_md(S[s][j], S[s][i], md);
+        closingPair *= exp_E_MLstem(type, S5[s][j], S3[s][i], pf_params);
+      }
+    }
+
+    if (sc_wrapper_ml->pair)
+      closingPair *= sc_wrapper_ml->pair(i, j, sc_wrapper_ml);
+
+    ii  = my_iindx[i + 1];
+    jj  = jindx[j - 1];
+
+    for (qt = qbt1, k = i + 2; k < j - 1; k++) {
+      q_temp = qm[ii - (k - 1)] *
+               qm1[jj + k] *
+               closingPair;
+
+      if (sc_wrapper_ml->decomp_ml)
+        q_temp *= sc_wrapper_ml->decomp_ml(i + 1,
+                                           j - 1,
+                                           k - 1,
+                                           k,
+                                           sc_wrapper_ml);
+
+      qt += q_temp;
+      sample_table_add(table, qt, k, 0);
+    }
+  }
+
+  free(types);
+
+  return table;
+}
+
+
+/* Multibranch loop parts [i..j] with left-most branch starting at k, where [i..k-1] is either unpaired (l = 1) or not (l = 0) */
+PRIVATE struct sample_table *
+sample_table_qm(vrna_fold_compound_t  *fc,
+                int                   i,
+                int                   j,
+                struct sc_wrappers    *sc_wrap)
+{
+  int                       k, u, cnt, *my_iindx, *jindx, *hc_up_ml;
+  FLT_OR_DBL                qmt, q_temp, *qm, *qm1, *expMLbase;
+  struct sc_wrapper_exp_ml  *sc_wrapper_ml;
+  struct sample_table       *table;
+
+#ifdef VRNA_WITH_BOUSTROPHEDON
+  int                       span = j - i;
+#endif
+
+  my_iindx      = fc->iindx;
+  jindx         = fc->jindx;
+  hc_up_ml      = fc->hc->up_ml;
+  sc_wrapper_ml = &(sc_wrap->sc_wrapper_ml);
+  qm            = fc->exp_matrices->qm;
+  qm1           = fc->exp_matrices->qm1;
+  expMLbase     = fc->exp_matrices->expMLbase;
+
+  table = sample_table_init(2 * (j - i) + 1);
+
+  qmt = qm1[jindx[j] + i];
+  sample_table_add(table, qmt, i, 1);
+
+  for (cnt = i + 1; cnt <= j; cnt++) {
+#ifdef VRNA_WITH_BOUSTROPHEDON
+    k = (int)(i + 1 + span * ((cnt - i - 1) % 2)) +
+        (int)((1 - (2 * ((cnt - i - 1) % 2))) * ((cnt - i) / 2));
+#else
+    k = cnt;
+#endif
+    u = k - i;
+    /* [i...k] is unpaired */
+    if (hc_up_ml[i] >= u) {
+      q_temp = expMLbase[u] * qm1[jindx[j] + k];
+
+      if (sc_wrapper_ml->red_ml)
+        q_temp *= sc_wrapper_ml->red_ml(i, j, k, j, sc_wrapper_ml);
+
+      qmt += q_temp;
+      sample_table_add(table, qmt, k, 1);
+    }
+
+    /* split between k-1, k */
+    q_temp = qm[my_iindx[i] - (k - 1)] *
+             qm1[jindx[j] + k];
+
+    if (sc_wrapper_ml->decomp_ml)
+      q_temp *= sc_wrapper_ml->decomp_ml(i, j, k - 1, k, sc_wrapper_ml);
+
+    qmt += q_temp;
+    sample_table_add(table, qmt, k, 0);
+  }
+
+  return table;
+}
+
+
+/* Pairs (i, k) with k <= j that form the left-most branch in qm1[i,j] */
+PRIVATE struct sample_table *
+sample_table_qm1(vrna_fold_compound_t *fc,
+                 int                  i,
+                 int                  j,
+                 struct sc_wrappers   *sc_wrap)
+{
+  unsigned char             *hard_constraints;
+  char                      *ptype;
+  short                     *S1, **S, **S5, **S3;
+  unsigned int              n, s, n_seq;
+  int                       ii, l, il, type, turn, u, *my_iindx, *jindx, *hc_up_ml;
+  FLT_OR_DBL                qt, q_temp, *qb, *expMLbase;
+  vrna_exp_param_t          *pf_params;
+  vrna_md_t                 *md;
+  struct sc_wrapper_exp_ml  *sc_wrapper_ml;
+  struct sample_table       *table;
+
+  n                 = fc->length;
+  pf_params         = fc->exp_params;
+  md                = &(pf_params->model_details);
+  turn              = md->min_loop_size;
+  my_iindx          = fc->iindx;
+  jindx             = fc->jindx;
+  hc_up_ml          = fc->hc->up_ml;
+  hard_constraints  = fc->hc->mx;
+  sc_wrapper_ml     = &(sc_wrap->sc_wrapper_ml);
+  qb                = fc->exp_matrices->qb;
+  expMLbase         = fc->exp_matrices->expMLbase;
+
+  if (fc->type == VRNA_FC_TYPE_SINGLE) {
+    n_seq = 1;
+    ptype = fc->ptype;
+    S1    = fc->sequence_encoding;
+    S     = NULL;
+    S5    = NULL;
+    S3    = NULL;
+  } else {
+    n_seq = fc->n_seq;
+    ptype = NULL;
+    S1    = NULL;
+    S     = fc->S;
+    S5    = fc->S5;
+    S3    = fc->S3;
+  }
+
+  table = sample_table_init(j - i);
+  ii    = my_iindx[i];
+
+  for (qt = 0., l = j; l > i + turn; l--) {
+    il = jindx[l] + i;
+    if (hard_constraints[n * i + l] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+      u = j - l;
+      if (hc_up_ml[l + 1] < u)
+        break;
+
+      q_temp = qb[ii - l] *
+               expMLbase[j - l];
+
+      if (fc->type == VRNA_FC_TYPE_SINGLE) {
+        type    = vrna_get_ptype(il, ptype);
+        q_temp  *= exp_E_MLstem(type, S1[i - 1], S1[l + 1], pf_params);
+      } else {
+        for (s = 0; s < n_seq; s++) {
+          type    = vrna_get_ptype_md(S[s][i], S[s][l], md);
+          q_temp  *= exp_E_MLstem(type, S5[s][i], S3[s][l], pf_params);
+        }
+      }
+
+      if (sc_wrapper_ml->red_stem)
+        q_temp *= sc_wrapper_ml->red_stem(i, j, i, l, sc_wrapper_ml);
+
+      qt += q_temp;
+      sample_table_add(table, qt, l, 0);
+    }
+  }
+
+  return table;
+}
+
+
 /* general expr of vrna5_pbacktrack with possibility of non-redundant sampling */
 PRIVATE unsigned int
 wrap_pbacktrack(vrna_fold_compound_t              *vc,
@@ -323,7 +1200,8 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
                 unsigned int                      num_samples,
                 vrna_boltzmann_sampling_callback  *bs_cb,
                 void                              *data,
-                struct vrna_pbacktrack_memory_s   *nr_mem)
+                struct vrna_pbacktrack_memory_s   *nr_mem,
+                unsigned int                      options)
 {
   char                *pstruc;
   unsigned int        i, n;
@@ -334,7 +1212,6 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
 
   i           = 0;
   pf_overflow = 0;
-  sc_wrap     = sc_init(vc);
 
   n         = vc->length;
   my_iindx  = vc->iindx;
@@ -356,14 +1233,22 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
     qln[n + 1]  = 1.0;
   }
 
+  /* non-redundant sampling depends on all previous samples and is always done serially */
+  if ((!(options & VRNA_PBACKTRACK_NON_REDUNDANT)) && (options & VRNA_PBACKTRACK_PARALLEL))
+    return pbacktrack_parallel(vc, length, num_samples, bs_cb, data, nr_mem, options);
+
+  sc_wrap = sc_init(vc);
+
   for (i = 0; i < num_samples; i++) {
     is_dup  = 1;
     pstruc  = vrna_alloc((length + 1) * sizeof(char));
 
     memset(pstruc, '.', sizeof(char) * length);
 
-    if (nr_mem)
-      nr_mem->q_remain = vc->exp_matrices->q[vc->iindx[1] - length];
+    if (options & VRNA_PBACKTRACK_NON_REDUNDANT)
+      nr_mem->q_remain = (vc->band) ?
+                         q1k[length] :
+                         vc->exp_matrices->q[vc->iindx[1] - length];
 
 #ifdef VRNA_WITH_BOUSTROPHEDON
     ret = backtrack_ext_loop(length, pstruc, vc, length, sc_wrap, nr_mem);
@@ -371,7 +1256,7 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
     ret = backtrack_ext_loop(1, pstruc, vc, length, sc_wrap, nr_mem);
 #endif
 
-    if (nr_mem) {
+    if (options & VRNA_PBACKTRACK_NON_REDUNDANT) {
 #ifdef VRNA_NR_SAMPLING_HASH
       nr_mem->current_node = traceback_to_root(nr_mem->current_node,
                                                nr_mem->q_remain,
@@ -412,6 +1297,126 @@ wrap_pbacktrack(vrna_fold_compound_t              *vc,
 }
 
 
+/*
+ *  Draw samples in parallel, where each sample k uses its own random number
+ *  stream derived from a common seed and k. Thus, the set of samples only
+ *  depends on the state of vrna_urn() upon calling this function, but neither
+ *  on the number of threads nor their scheduling. The memory, if any, only
+ *  provides the cache of cumulative Boltzmann weights shared by all threads
+ */
+PRIVATE unsigned int
+pbacktrack_parallel(vrna_fold_compound_t              *vc,
+                    unsigned int                      length,
+                    unsigned int                      num_samples,
+                    vrna_boltzmann_sampling_callback  *bs_cb,
+                    void                              *data,
+                    struct vrna_pbacktrack_memory_s   *mem,
+                    unsigned int                      options)
+{
+  unsigned int          next;
+  int                   num_threads, failed;
+  uint64_t              seed;
+  vrna_ostream_t        queue;
+  struct sample_output  output;
+
+  seed  = (uint64_t)(vrna_urn() * 4294967296.) << 32;
+  seed  ^= (uint64_t)(vrna_urn() * 4294967296.);
+
+  output.cb   = bs_cb;
+  output.data = data;
+  output.limit = num_samples;
+
+  queue   = (options & VRNA_PBACKTRACK_UNORDERED) ?
+            NULL :
+            vrna_ostream_init(&output_sample, (void *)&output);
+  next    = 0;
+  failed  = 0;
+
+  num_threads = vc->exp_params->model_details.num_threads;
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+
+  if (num_threads > (int)num_samples)
+    num_threads = (int)num_samples;
+
+  if (num_threads < 1)
+    num_threads = 1;
+
+#pragma omp parallel num_threads(num_threads)
+#endif
+  {
+    char                *pstruc;
+    unsigned int        k;
+    int                 ret;
+    uint64_t            state;
+    struct sc_wrappers  *sc_wrap;
+
+    sc_wrap   = sc_init(vc);
+    urn_state = &state;
+
+    while (1) {
+      /* output slots must be requested in ascending order */
+#ifdef _OPENMP
+#pragma omp critical (pbacktrack_next)
+#endif
+      {
+        k = (failed) ? num_samples : next++;
+        if ((k < num_samples) && (queue))
+          vrna_ostream_request(queue, k);
+      }
+
+      if (k >= num_samples)
+        break;
+
+      state   = mix_seed(seed ^ mix_seed((uint64_t)k));
+      pstruc  = vrna_alloc((length + 1) * sizeof(char));
+
+      memset(pstruc, '.', sizeof(char) * length);
+
+#ifdef VRNA_WITH_BOUSTROPHEDON
+      ret = backtrack_ext_loop(length, pstruc, vc, length, sc_wrap, mem);
+#else
+      ret = backtrack_ext_loop(1, pstruc, vc, length, sc_wrap, mem);
+#endif
+
+      if (ret <= 0) {
+        free(pstruc);
+        pstruc = NULL;
+      }
+
+      if (ret == 0) {
+        /* stop claiming new samples, all of them lie beyond the failed one */
+        pstruc = &sample_failed;
+#ifdef _OPENMP
+#pragma omp critical (pbacktrack_next)
+#endif
+        failed = 1;
+      }
+
+      if (queue) {
+        vrna_ostream_provide(queue, k, (void *)pstruc);
+      } else {
+#ifdef _OPENMP
+#pragma omp critical (pbacktrack_output)
+#endif
+        output_sample((void *)&output, k, (void *)pstruc);
+      }
+    }
+
+    urn_state = NULL;
+    sc_free(sc_wrap);
+  }
+
+  /* flush remaining samples */
+  vrna_ostream_free(queue);
+
+  /* as in serial mode, skipped samples are counted, but not the failed one */
+  return output.limit;
+}
+
+
 /* backtrack one external */
 PRIVATE int
 backtrack_ext_loop(int                              init_val,
@@ -423,7 +1428,7 @@ backtrack_ext_loop(int                              init_val,
 {
   unsigned char             *hard_constraints;
   short                     *S1, *S2, **S, **S5, **S3;
-  unsigned int              **a2s, s, n_seq;
+  unsigned int              **a2s, s, n_seq, d;
   int                       ret, i, j, ij, n, k, u, type, *my_iindx, hc_decompose, *hc_up_ext;
   FLT_OR_DBL                r, fbd, fbds, qt, q_temp, qkl, *q, *qb, *q1k, *qln, *scale;
   double                    *q_remain;
@@ -434,17 +1439,21 @@ backtrack_ext_loop(int                              init_val,
 
   struct nr_memory          **memory_dat;
   struct sc_wrapper_exp_ext *sc_wrapper_ext;
+  struct sample_cache       *cache;
+  struct sample_table       *table;
 
   NR_NODE                   **current_node;
 
-  if (nr_mem) {
+  if ((nr_mem) && (nr_mem->root_node)) {
     q_remain      = &(nr_mem->q_remain);
     current_node  = &(nr_mem->current_node);
     memory_dat    = &(nr_mem->memory_dat);
+    cache         = NULL;
   } else {
     q_remain      = NULL;
     current_node  = NULL;
     memory_dat    = NULL;
+    cache         = (nr_mem) ? nr_mem->cache : NULL;
   }
 
 #ifndef VRNA_NR_SAMPLING_HASH
@@ -525,7 +1534,7 @@ backtrack_ext_loop(int                              init_val,
             return 0;
         }
 
-        r       = vrna_urn() * (q1k[j] - fbd);
+        r       = sample_urn() * (q1k[j] - fbd);
         q_temp  = q1k[j - 1] * scale[1];
 
         if (sc_wrapper_ext->red_ext)
@@ -573,7 +1582,23 @@ backtrack_ext_loop(int                              init_val,
             (*q_remain);
     }
 
-    r = vrna_urn() * (q1k[j] - q_temp - fbd);
+    r = sample_urn() * (q1k[j] - q_temp - fbd);
+
+    if (cache) {
+      table = cache_table(cache, SAMPLE_TABLE_EXT, 1, j, vc, sc_wrap);
+      d     = sample_table_search(table, r, 1);
+
+      if (d == table->num) {
+        vrna_message_warning("backtracking failed in ext loop");
+        return -1;
+      }
+
+      i = table->k[d];
+      backtrack(i, j, pstruc, vc, sc_wrap, nr_mem);
+
+      return backtrack_ext_loop(i - 1, pstruc, vc, length, sc_wrap, nr_mem);
+    }
+
     u = j - 1;
     i = 2;
 
@@ -673,7 +1698,7 @@ backtrack_ext_loop(int                              init_val,
                 (*q_remain);
         }
 
-        r       = vrna_urn() * (qln[i] - fbd);
+        r       = sample_urn() * (qln[i] - fbd);
         q_temp  = qln[i + 1] * scale[1];
 
         if (sc_wrapper_ext->red_ext)
@@ -721,7 +1746,25 @@ backtrack_ext_loop(int                              init_val,
             (*q_remain);
     }
 
-    r = vrna_urn() * (qln[i] - q_temp - fbd);
+    r = sample_urn() * (qln[i] - q_temp - fbd);
+
+    if (cache) {
+      table = cache_table(cache, SAMPLE_TABLE_EXT, i, length, vc, sc_wrap);
+      d     = sample_table_search(table, r, 1);
+
+      if (d == table->num) {
+        vrna_message_warning("backtracking failed in ext loop");
+        return -1;
+      }
+
+      j   = table->k[d];
+      ret = backtrack(i, j, pstruc, vc, sc_wrap, nr_mem);
+      if (!ret)
+        return ret;
+
+      return backtrack_ext_loop(j + 1, pstruc, vc, length, sc_wrap, nr_mem);
+    }
+
     for (qt = 0, j = i + 1; j <= length; j++) {
       ij            = my_iindx[i] - j;
       hc_decompose  = hard_constraints[n * i + j];
@@ -823,6 +1866,7 @@ backtrack_qm(int                              i,
              struct vrna_pbacktrack_memory_s  *nr_mem)
 {
   /* divide multiloop into qm and qm1  */
+  unsigned int              d;
   int                       k, u, cnt, span, turn, is_unpaired, *my_iindx, *jindx, *hc_up_ml, ret;
   FLT_OR_DBL                qmt, fbd, fbds, r, q_temp, *qm, *qm1, *expMLbase;
   double                    *q_remain;
@@ -831,17 +1875,21 @@ backtrack_qm(int                              i,
 
   struct sc_wrapper_exp_ml  *sc_wrapper_ml;
   struct nr_memory          **memory_dat;
+  struct sample_cache       *cache;
+  struct sample_table       *table;
 
   NR_NODE                   **current_node;
 
-  if (nr_mem) {
+  if ((nr_mem) && (nr_mem->root_node)) {
     q_remain      = &(nr_mem->q_remain);
     current_node  = &(nr_mem->current_node);
     memory_dat    = &(nr_mem->memory_dat);
+    cache         = NULL;
   } else {
     q_remain      = NULL;
     current_node  = NULL;
     memory_dat    = NULL;
+    cache         = (nr_mem) ? nr_mem->cache : NULL;
   }
 
 #ifndef VRNA_NR_SAMPLING_HASH
@@ -887,7 +1935,7 @@ backtrack_qm(int                              i,
             (*q_remain);
     }
 
-    r = vrna_urn() * (qm[my_iindx[i] - j] - fbd);
+    r = sample_urn() * (qm[my_iindx[i] - j] - fbd);
     if (current_node) {
       fbds = NR_GET_WEIGHT(*current_node, memorized_node_cur, NRT_QM_UNPAIR, i, 0) *
              qm[my_iindx[i] - j] /
@@ -900,7 +1948,17 @@ backtrack_qm(int                              i,
     k       = cnt = i;
     q_temp  = qm1[jindx[j] + i];
 
-    if (qmt < r) {
+    if (cache) {
+      table = cache_table(cache, SAMPLE_TABLE_QM, i, j, vc, sc_wrap);
+      d     = sample_table_search(table, r, 0);
+
+      if (d == table->num) {
+        cnt = j + 1;
+      } else {
+        k           = table->k[d];
+        is_unpaired = table->l[d];
+      }
+    } else if (qmt < r) {
 #ifndef VRNA_NR_SAMPLING_HASH
       if (current_node)
         advance_cursor(&memorized_node_prev, &memorized_node_cur, NRT_QM_UNPAIR, i, 0);
@@ -1041,7 +2099,7 @@ backtrack_qm1(int                             i,
   unsigned char             *hard_constraints;
   char                      *ptype;
   short                     *S1, **S, **S5, **S3;
-  unsigned int              n, s, n_seq;
+  unsigned int              n, s, n_seq, d;
   int                       ii, l, il, type, turn, u, *my_iindx, *jindx, *hc_up_ml;
   FLT_OR_DBL                qt, fbd, fbds, r, q_temp, *qm1, *qb, *expMLbase;
   double                    *q_remain;
@@ -1052,17 +2110,21 @@ backtrack_qm1(int                             i,
 
   struct nr_memory          **memory_dat;
   struct sc_wrapper_exp_ml  *sc_wrapper_ml;
+  struct sample_cache       *cache;
+  struct sample_table       *table;
 
   NR_NODE                   **current_node;
 
-  if (nr_mem) {
+  if ((nr_mem) && (nr_mem->root_node)) {
     q_remain      = &(nr_mem->q_remain);
     current_node  = &(nr_mem->current_node);
     memory_dat    = &(nr_mem->memory_dat);
+    cache         = NULL;
   } else {
     q_remain      = NULL;
     current_node  = NULL;
     memory_dat    = NULL;
+    cache         = (nr_mem) ? nr_mem->cache : NULL;
   }
 
 #ifndef VRNA_NR_SAMPLING_HASH
@@ -1119,8 +2181,21 @@ backtrack_qm1(int                             i,
           (*q_remain);
   }
 
-  r   = vrna_urn() * (qm1[jindx[j] + i] - fbd);
+  r   = sample_urn() * (qm1[jindx[j] + i] - fbd);
   ii  = my_iindx[i];
+
+  if (cache) {
+    table = cache_table(cache, SAMPLE_TABLE_QM1, i, j, vc, sc_wrap);
+    d     = sample_table_search(table, r, 0);
+
+    if (d == table->num) {
+      vrna_message_error("backtrack failed in qm1");
+      return 0;
+    }
+
+    return backtrack(i, table->k[d], pstruc, vc, sc_wrap, nr_mem);
+  }
+
   for (qt = 0., l = j; l > i + turn; l--) {
     il = jindx[l] + i;
     if (hard_constraints[n * i + l] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
@@ -1212,7 +2287,7 @@ backtrack_qm2(int                   k,
   turn          = vc->exp_params->model_details.min_loop_size;
   sc_wrapper_ml = &(sc_wrap->sc_wrapper_ml);
 
-  r = vrna_urn() * qm2[k];
+  r = sample_urn() * qm2[k];
   /* we have to search for our barrier u between qm1 and qm1  */
   if (sc_wrapper_ml->decomp_ml) {
     for (qom2t = 0., u = k + turn + 1; u < n - turn - 1; u++) {
@@ -1250,7 +2325,7 @@ backtrack(int                             i,
   unsigned char             *hard_constraints, hc_decompose;
   char                      *ptype;
   short                     *S1, **S, **S5, **S3;
-  unsigned int              **a2s, s, n_seq, n, type, type_2, *types, u1_local, u2_local;
+  unsigned int              **a2s, s, n_seq, n, type, type_2, *types, u1_local, u2_local, d;
   int                       *my_iindx, *jindx, *hc_up_int, ret, *pscore, turn, *rtype,
                             k, l, kl, u1, u2, max_k, min_l, ii, jj;
   FLT_OR_DBL                *qb, *qm, *qm1, *scale, r, fbd, fbds, qbt1, qbr, qt, q_temp,
@@ -1264,17 +2339,21 @@ backtrack(int                             i,
   struct nr_memory          **memory_dat;
   struct sc_wrapper_exp_int *sc_wrapper_int;
   struct sc_wrapper_exp_ml  *sc_wrapper_ml;
+  struct sample_cache       *cache;
+  struct sample_table       *table;
 
   NR_NODE                   **current_node;
 
-  if (nr_mem) {
+  if ((nr_mem) && (nr_mem->root_node)) {
     q_remain      = &(nr_mem->q_remain);
     current_node  = &(nr_mem->current_node);
     memory_dat    = &(nr_mem->memory_dat);
+    cache         = NULL;
   } else {
     q_remain      = NULL;
     current_node  = NULL;
     memory_dat    = NULL;
+    cache         = (nr_mem) ? nr_mem->cache : NULL;
   }
 
 #ifndef VRNA_NR_SAMPLING_HASH
@@ -1364,9 +2443,38 @@ backtrack(int                             i,
     pstruc[i - 1] = '(';
     pstruc[j - 1] = ')';
 
-    r     = vrna_urn() * (qbr - fbd);
+    r     = sample_urn() * (qbr - fbd);
     qbt1  = 0.;
 
+    if (cache) {
+      free(types);
+
+      table = cache_table(cache, SAMPLE_TABLE_QB, i, j, vc, sc_wrap);
+      d     = sample_table_search(table, r, 0);
+
+      if (d == table->num) {
+        if (hard_constraints[n * j + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP)
+          vrna_message_error("backtrack failed, can't find split index ");
+
+        return ret;
+      }
+
+      k = table->k[d];
+      l = table->l[d];
+
+      if (k == 0)
+        return ret;                                         /* hairpin */
+      else if (l > 0)
+        return backtrack(k, l, pstruc, vc, sc_wrap, nr_mem); /* interior loop */
+
+      /* multibranch loop with last branch starting at k */
+      ret = backtrack_qm1(k, j - 1, pstruc, vc, sc_wrap, nr_mem);
+      if (ret == 0)
+        return ret;
+
+      return backtrack_qm(i + 1, k - 1, pstruc, vc, sc_wrap, nr_mem);
+    }
+
     hc_decompose = hard_constraints[n * i + j];
 
     /* hairpin contribution */
@@ -1719,7 +2827,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
     if (sc_wrapper_ext->red_up)
       qt *= sc_wrapper_ext->red_up(1, n, sc_wrapper_ext);
 
-    r = vrna_urn() * qo;
+    r = sample_urn() * qo;
 
     /* open chain? */
     if (qt > r)
@@ -1834,7 +2942,7 @@ pbacktrack_circ(vrna_fold_compound_t              *vc,
     {
       /* as we reach this part, we have to search for our barrier between qm and qm2  */
       qt  = 0.;
-      r   = vrna_urn() * qmo;
+      r   = sample_urn() * qmo;
       if (sc_wrapper_ml->decomp_ml) {
         for (k = turn + 2; k < n - 2 * turn - 3; k++) {
           qt += qm[my_iindx[1] - k] *
@@ -1886,3 +2994,53 @@ pbacktrack_circ_loop_end:
 
   return count;
 }
+
+
+
+PRIVATE void
+output_sample(void          *auxdata,
+              unsigned int  i,
+              void          *data)
+{
+  char                  *structure;
+  struct sample_output  *output;
+
+  output    = (struct sample_output *)auxdata;
+  structure = (char *)data;
+
+  if (structure == &sample_failed) {
+    /* stop at the first failure, as in serial mode */
+    if (i < output->limit)
+      output->limit = i;
+  } else if (structure) {
+    /* suppress all samples beyond a failure that has already been seen */
+    if ((i < output->limit) && (output->cb))
+      output->cb(structure, output->data);
+
+    free(structure);
+  }
+}
+
+
+/* uniform random number in [0,1) from the stream of the current sample, or vrna_urn() */
+PRIVATE INLINE double
+sample_urn(void)
+{
+  if (urn_state) {
+    *urn_state += 0x9e3779b97f4a7c15ULL;
+    return (double)(mix_seed(*urn_state) >> 11) / 9007199254740992.; /* 2^53 */
+  }
+
+  return vrna_urn();
+}
+
+
+/* finalizer of the splitmix64 generator */
+PRIVATE INLINE uint64_t
+mix_seed(uint64_t x)
+{
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+  return x ^ (x >> 31);
+}
@@ -39,6 +39,60 @@
  */
 #define VRNA_PBACKTRACK_NON_REDUNDANT   1
 
+/**
+ *  @brief  Boltzmann sampling flag indicating parallel backtracing mode
+ *
+ *  This flag distributes the samples over #vrna_md_t.num_threads threads (if RNAlib was
+ *  compiled with OpenMP support) that share the partition function DP matrices. Each sample
+ *  draws its random numbers from a separate stream, seeded by the sample index and a common
+ *  seed that is taken from vrna_urn() once per call. Hence, the samples only depend on the
+ *  state of vrna_urn() but neither on the number of threads nor their scheduling. By default,
+ *  the samples are passed to the callback in the order of their indices, one at a time.
+ *
+ *  @note This flag is ignored in non-redundant mode (#VRNA_PBACKTRACK_NON_REDUNDANT) and for
+ *        circular RNAs. User-defined soft constraint callbacks must be thread-safe.
+ *
+ *  @see    #VRNA_PBACKTRACK_UNORDERED, vrna_pbacktrack_num(), vrna_pbacktrack_cb(),
+ *          vrna_pbacktrack5_num(), vrna_pbacktrack5_cb()
+ */
+#define VRNA_PBACKTRACK_PARALLEL        2
+
+/**
+ *  @brief  Boltzmann sampling flag to pass samples to the callback as soon as they are available
+ *
+ *  In parallel backtracing mode (#VRNA_PBACKTRACK_PARALLEL), this flag skips the re-ordering
+ *  of samples. The callback is still executed for one sample at a time. As in serial mode,
+ *  sampling stops at the first sample whose backtracing fails. Samples with a larger index
+ *  are no longer passed to the callback once the failure has been detected, but those that
+ *  were completed before may already have been passed.
+ *
+ *  @see    #VRNA_PBACKTRACK_PARALLEL
+ */
+#define VRNA_PBACKTRACK_UNORDERED       4
+
+/**
+ *  @brief  Boltzmann sampling flag to cache the cumulative Boltzmann weights of decompositions
+ *
+ *  Each backtracing step linearly scans all decompositions of the current partition function
+ *  entry until the running sum of their Boltzmann weights exceeds a random threshold. With this
+ *  flag, the cumulative sums of all decompositions of an entry are stored upon the first visit
+ *  of the entry, such that subsequent visits require a binary search only. Since the sums are
+ *  computed in the same order as before, the samples are identical to those obtained without
+ *  caching. This pays off when drawing many samples, especially for long sequences.
+ *
+ *  The cache lives in the Boltzmann sampling memory data structure (#vrna_pbacktrack_mem_t),
+ *  hence it can be re-used across successive calls to vrna_pbacktrack_resume_cb() and
+ *  similar. For all other sampling functions, it only exists for the duration of the call.
+ *
+ *  @note This flag is ignored in non-redundant mode (#VRNA_PBACKTRACK_NON_REDUNDANT) and for
+ *        circular RNAs. The memory requirements grow with the number of distinct entries
+ *        visited and, in the worst case, exceed those of the partition function DP matrices.
+ *        The cache is silently rebuilt if the partition function of the fold compound changes.
+ *
+ *  @see    vrna_pbacktrack_resume(), vrna_pbacktrack_resume_cb(), vrna_pbacktrack_mem_free()
+ */
+#define VRNA_PBACKTRACK_CACHE           8
+
 /**
  *  @brief  Callback for Boltzmann sampling
  *
@@ -61,7 +115,9 @@ typedef void (vrna_boltzmann_sampling_callback)(const char  *stucture,
  *  @brief  Boltzmann sampling memory data structure
  *
  *  This structure is required for properly resuming a previous sampling round in
- *  specialized Boltzmann sampling, such as non-redundant backtracking.
+ *  specialized Boltzmann sampling, such as non-redundant backtracking, or for re-using
+ *  the cumulative Boltzmann weights cached with #VRNA_PBACKTRACK_CACHE. A memory
+ *  data structure must only be used with the sampling mode it was initialized for.
  *
  *  Initialize with @p NULL and pass its address to the corresponding
  *  functions vrna_pbacktrack5_resume(), etc.
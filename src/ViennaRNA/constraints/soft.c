@@ -318,8 +318,17 @@ vrna_sc_update(vrna_fold_compound_t *vc,
                 populate_sc_bp_pf(vc, i, maxdist);
             }
           }
-        } else {
-          /* do nothing here, until we know what a reasonable action for global folding would be */
+        } else if (sc) {
+          /*
+           *  global folding, the Boltzmann factors depend on the temperature
+           *  of the energy parameters, so we simply mark them for re-computation
+           *  upon the next call to vrna_sc_prepare()
+           */
+          if (options & VRNA_OPTION_MFE)
+            sc->state |= STATE_DIRTY_UP_MFE | STATE_DIRTY_BP_MFE;
+
+          if (options & VRNA_OPTION_PF)
+            sc->state |= STATE_DIRTY_UP_PF | STATE_DIRTY_BP_PF;
         }
       }
     }
@@ -23,6 +23,7 @@
 struct vrna_cstr_s {
   char          *string;
   size_t        size;
+  size_t        length;
   FILE          *output;
   unsigned char istty;
 };
@@ -51,6 +52,7 @@ vrna_cstr(size_t  size,
   buf         = (struct vrna_cstr_s *)vrna_alloc(sizeof(struct vrna_cstr_s));
   buf->string = (char *)vrna_alloc(sizeof(char) * size);
   buf->size   = size;
+  buf->length = 0;
   buf->output = (output) ? output : stdout;
   buf->istty  = isatty(fileno(buf->output));
 
@@ -107,11 +109,12 @@ vrna_cstr_fflush(struct vrna_cstr_s *buf)
 {
   if (buf) {
     if (buf->output) {
-      fprintf(buf->output, "%s", buf->string);
+      (void)fwrite(buf->string, sizeof(char), buf->length, buf->output);
       (void)fflush(buf->output);
     }
 
     buf->size       = CSTR_OVERHEAD;
+    buf->length     = 0;
     buf->string     = (char *)vrna_realloc(buf->string, sizeof(char) * buf->size);
     buf->string[0]  = '\0';
   }
@@ -155,7 +158,7 @@ vrna_cstr_vprintf(struct vrna_cstr_s  *buf,
   r           = -1;
   ptr         = buf->string;
   size_avail  = buf->size;
-  size_old    = (ptr) ? strlen(ptr) : 0;
+  size_old    = buf->length;
 
   /* retrieve the number of characters that the string requires */
 #ifdef _WIN32
@@ -185,6 +188,10 @@ vrna_cstr_vprintf(struct vrna_cstr_s  *buf,
       if (size_avail < SIZE_MAX - CSTR_OVERHEAD)
         size_avail += CSTR_OVERHEAD;
 
+      /* grow geometrically to keep appending to large buffers cheap */
+      if ((buf->size < SIZE_MAX / 2) && (size_avail < 2 * buf->size))
+        size_avail = 2 * buf->size;
+
       ptr = (char *)vrna_realloc(ptr, sizeof(char) * (size_avail));
     }
 
@@ -195,6 +202,7 @@ vrna_cstr_vprintf(struct vrna_cstr_s  *buf,
     } else {
       buf->string = ptr;
       buf->size   = size_avail;
+      buf->length = size_old + size_new;
       r           = size_old + size_new;
     }
   } else if (size_new == 0) {
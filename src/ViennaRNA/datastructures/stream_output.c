@@ -19,49 +19,213 @@
 # define INLINE
 #endif
 
-#define QUEUE_OVERHEAD  32
+/*
+ *  The stream data is stored in a ring of blocks, each holding a fixed
+ *  number of slots. A slot is addressed by its index number only, so
+ *  concurrent calls to vrna_ostream_provide() do not need any locking.
+ *  Blocks are allocated upon vrna_ostream_request() and released as
+ *  soon as all of their slots have been passed to the output callback.
+ */
+#define SLOTS_PER_BLOCK   1024
+#define MAX_BLOCKS        4096
+#define MAX_WINDOW        ((MAX_BLOCKS - 1) * SLOTS_PER_BLOCK)
+
+#define BLOCK(i)          (((i) / SLOTS_PER_BLOCK) % MAX_BLOCKS)
+#define SLOT(i)           ((i) % SLOTS_PER_BLOCK)
+
+#if VRNA_WITH_PTHREADS
+# define ATOMIC_LOAD(ptr)         __atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+# define ATOMIC_STORE(ptr, val)   __atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST)
+#else
+# define ATOMIC_LOAD(ptr)         (*(ptr))
+# define ATOMIC_STORE(ptr, val)   (*(ptr) = (val))
+#endif
+
+
+struct stream_slot {
+  void  *data;                            /* actual data passed to the callback */
+  int   provided;                         /* whether data has been provided for this slot */
+};
 
 
 struct vrna_ordered_stream_s {
-  unsigned int                start;      /* first element index in queue, i.e. start of queue */
-  unsigned int                end;        /* last element index in queue */
-  unsigned int                size;       /* available memory size for 'data' and 'provided' */
-  unsigned int                shift;      /* pointer offset for 'data' and 'provided' */
+  unsigned int                start;      /* index of the next element passed to the callback */
+  unsigned int                end;        /* one past the last requested index */
+  struct stream_slot          **blocks;   /* ring of slot blocks */
 
   vrna_callback_stream_output *output;    /* callback to execute if consecutive elements from head are available */
-  void                        **data;     /* actual data passed to the callback */
-  unsigned char               *provided;  /* for simplicity we use unsigned char instead of single bits per element */
   void                        *auxdata;   /* auxiliary data passed to the callback */
 #if VRNA_WITH_PTHREADS
-  pthread_mutex_t             mtx;        /* semaphore to provide concurrent access */
+  pthread_t                   owner;        /* thread that created the stream */
+  pthread_t                   writer;       /* thread that processes the output callback */
+  int                         threaded;     /* 1 if the writer runs, -1 if it could not be started */
+  pthread_mutex_t             flush_mtx;    /* serializes the execution of the output callback */
+  pthread_mutex_t             mtx;          /* semaphore for the conditions below */
+  pthread_cond_t              cond;         /* signals new data to the writer */
+  pthread_cond_t              space;        /* signals processed data to a requester waiting for free blocks */
+  unsigned int                waiting_for;  /* the index the writer is currently waiting for */
+  int                         shutdown;     /* flag to terminate the writer */
 #endif
 };
 
 
-PRIVATE INLINE void
+PRIVATE INLINE struct stream_slot *
+get_slot(struct vrna_ordered_stream_s *queue,
+         unsigned int                 i)
+{
+  struct stream_slot *block = ATOMIC_LOAD(&(queue->blocks[BLOCK(i)]));
+
+  return (block) ? block + SLOT(i) : NULL;
+}
+
+
+PRIVATE INLINE int
+is_provided(struct vrna_ordered_stream_s  *queue,
+            unsigned int                  i)
+{
+  struct stream_slot *slot;
+
+  if (i >= ATOMIC_LOAD(&(queue->end)))
+    return 0;
+
+  slot = get_slot(queue, i);
+
+  return (slot) ? ATOMIC_LOAD(&(slot->provided)) : 0;
+}
+
+
+/*
+ *  Pass all consecutive blocks available from the start of queue to
+ *  the output callback. This function must only be executed by a single
+ *  thread at a time, see flush_locked()
+ */
+PRIVATE void
 flush_output(struct vrna_ordered_stream_s *queue)
 {
-  unsigned int j;
+  unsigned int        i;
+  struct stream_slot  *slot, *block;
+
+  for (i = queue->start; is_provided(queue, i); i++) {
+    slot = get_slot(queue, i);
+
+    if (queue->output)
+      queue->output(queue->auxdata, i, slot->data);
+
+    slot->data      = NULL;
+    slot->provided  = 0;
+
+    /* release blocks we are done with */
+    if (SLOT(i + 1) == 0) {
+      block = queue->blocks[BLOCK(i)];
+      ATOMIC_STORE(&(queue->blocks[BLOCK(i)]), NULL);
+      free(block);
+    }
+
+    ATOMIC_STORE(&(queue->start), i + 1);
+  }
+}
+
+
+#if VRNA_WITH_PTHREADS
+
+PRIVATE void
+flush_locked(struct vrna_ordered_stream_s *queue)
+{
+  pthread_mutex_lock(&queue->flush_mtx);
+  flush_output(queue);
+  pthread_mutex_unlock(&queue->flush_mtx);
+}
+
+
+PRIVATE void *
+writer_thread(void *arg)
+{
+  unsigned int                  i;
+  struct vrna_ordered_stream_s  *queue = (struct vrna_ordered_stream_s *)arg;
+
+  pthread_mutex_lock(&queue->mtx);
+
+  while (1) {
+    i = queue->start;
+
+    if (is_provided(queue, i)) {
+      /* process the output callback without holding the lock */
+      pthread_mutex_unlock(&queue->mtx);
+      flush_locked(queue);
+      pthread_mutex_lock(&queue->mtx);
+
+      /* wake up a requester that waits for free blocks */
+      pthread_cond_broadcast(&queue->space);
+      continue;
+    }
+
+    if (queue->shutdown)
+      break;
+
+    /*
+     *  Announce the index we are waiting for and check again. Providers
+     *  only signal us if they observe this index, and since we hold the
+     *  lock until we wait, their signal can not get lost
+     */
+    ATOMIC_STORE(&(queue->waiting_for), i);
+
+    if (!is_provided(queue, i))
+      pthread_cond_wait(&queue->cond, &queue->mtx);
+  }
+
+  pthread_mutex_unlock(&queue->mtx);
+
+  return NULL;
+}
+
+
+/*
+ *  Start the writer thread as soon as a second thread takes part in the
+ *  stream. As long as the thread that created the stream is the only data
+ *  provider, the output callback is executed directly within
+ *  vrna_ostream_provide()
+ */
+PRIVATE void
+start_writer(struct vrna_ordered_stream_s *queue)
+{
+  pthread_mutex_lock(&queue->mtx);
+
+  if (queue->threaded == 0) {
+    if (pthread_create(&queue->writer, NULL, &writer_thread, (void *)queue)) {
+      vrna_message_warning("vrna_ostream: failed to create output thread, "
+                           "output is processed by the data providers");
+      ATOMIC_STORE(&(queue->threaded), -1);
+    } else {
+      ATOMIC_STORE(&(queue->threaded), 1);
+    }
+  }
 
-  /* flush all consecutive blocks available from the start of queue */
+  pthread_mutex_unlock(&queue->mtx);
+}
 
-  /* 1. process output callback */
-  if (queue->output)
-    for (j = queue->start; (j <= queue->end) && (queue->provided[j]); j++)
-      queue->output(queue->auxdata, j, queue->data[j]);
 
-  /* 2. move start of queue */
-  while ((queue->start <= queue->end) && (queue->provided[queue->start]))
-    queue->start++;
+/* process the output callback within the providing thread */
+PRIVATE void
+flush_direct(struct vrna_ordered_stream_s *queue)
+{
+  flush_locked(queue);
 
-  /* 3. set empty queue condition if necessary */
-  if (queue->end < queue->start) {
-    queue->provided[queue->start] = 0;
-    queue->end                    = queue->start;
+  /*
+   *  the writer may have been started in the meantime and must not miss
+   *  the progress we made, neither must a requester waiting for free blocks
+   */
+  if (ATOMIC_LOAD(&(queue->threaded)) == 1) {
+    pthread_mutex_lock(&queue->mtx);
+    pthread_cond_signal(&queue->cond);
+    pthread_cond_broadcast(&queue->space);
+    pthread_mutex_unlock(&queue->mtx);
   }
 }
 
 
+#endif
+
+
 PUBLIC struct vrna_ordered_stream_s *
 vrna_ostream_init(vrna_callback_stream_output *output,
                   void                        *auxdata)
@@ -72,15 +236,20 @@ vrna_ostream_init(vrna_callback_stream_output *output,
 
   queue->start    = 0;
   queue->end      = 0;
-  queue->size     = QUEUE_OVERHEAD;
-  queue->shift    = 0;
   queue->output   = output;
   queue->auxdata  = auxdata;
-  queue->data     = (void **)vrna_alloc(sizeof(void *) * QUEUE_OVERHEAD);
-  queue->provided = (unsigned char *)vrna_alloc(sizeof(unsigned char) * QUEUE_OVERHEAD);
+  queue->blocks   = (struct stream_slot **)vrna_alloc(sizeof(struct stream_slot *) * MAX_BLOCKS);
 
 #if VRNA_WITH_PTHREADS
+  queue->owner        = pthread_self();
+  queue->threaded     = 0;
+  queue->waiting_for  = 0;
+  queue->shutdown     = 0;
+
+  pthread_mutex_init(&queue->flush_mtx, NULL);
   pthread_mutex_init(&queue->mtx, NULL);
+  pthread_cond_init(&queue->cond, NULL);
+  pthread_cond_init(&queue->space, NULL);
 #endif
 
   return queue;
@@ -90,22 +259,35 @@ vrna_ostream_init(vrna_callback_stream_output *output,
 PUBLIC void
 vrna_ostream_free(struct vrna_ordered_stream_s *queue)
 {
+  unsigned int i;
+
   if (queue) {
 #if VRNA_WITH_PTHREADS
-    pthread_mutex_lock(&queue->mtx);
-#endif
+    if (queue->threaded == 1) {
+      /* let the writer process everything that is available and terminate */
+      pthread_mutex_lock(&queue->mtx);
+      queue->shutdown = 1;
+      pthread_cond_broadcast(&queue->cond);
+      pthread_mutex_unlock(&queue->mtx);
+
+      pthread_join(queue->writer, NULL);
+    } else {
+      flush_output(queue);
+    }
 
+    pthread_mutex_destroy(&queue->flush_mtx);
+    pthread_mutex_destroy(&queue->mtx);
+    pthread_cond_destroy(&queue->cond);
+    pthread_cond_destroy(&queue->space);
+#else
     flush_output(queue);
-
-#if VRNA_WITH_PTHREADS
-    pthread_mutex_unlock(&queue->mtx);
 #endif
 
     /* free remaining memory */
-    queue->data     += queue->shift;
-    queue->provided += queue->shift;
-    free(queue->data);
-    free(queue->provided);
+    for (i = 0; i < MAX_BLOCKS; i++)
+      free(queue->blocks[i]);
+
+    free(queue->blocks);
 
     /* free ostream itself */
     free(queue);
@@ -130,69 +312,49 @@ vrna_ostream_request(struct vrna_ordered_stream_s *queue,
 {
   unsigned int i;
 
-  if (queue) {
+  if ((queue) && (num >= queue->end)) {
+    /* the window of requested but unprocessed indices is limited by the ring size */
+    if (num - queue->end >= MAX_WINDOW) {
+      vrna_message_warning(
+        "vrna_ostream_request(): too many indices (%d) requested at once!",
+        num - queue->end + 1);
+      return;
+    }
+
+    if (num - ATOMIC_LOAD(&(queue->start)) >= MAX_WINDOW) {
 #if VRNA_WITH_PTHREADS
-    pthread_mutex_lock(&queue->mtx);
-#endif
-    if (num >= queue->end) {
-      /* check whether we have to increase memory */
-      unsigned int new_size = num - queue->shift + 1;
-
-      if (queue->size < new_size + 1) {
-        /*
-         *  Check whether we can simply move data around to get more space.
-         *  We do this only, if more than half of the first buffer is empty.
-         *  Otherwise, we simply increase the buffer to fit incoming data.
-         */
-        unsigned int mem_unavail = queue->start - queue->shift;
-        if ((mem_unavail > (queue->size / 2)) &&
-            (new_size - mem_unavail < queue->size + 1)) {
-          /* reset pointer shift */
-          queue->data     += queue->shift;
-          queue->provided += queue->shift;
-
-          /* move remaining data to the front */
-          queue->data = memmove(queue->data,
-                                queue->data + mem_unavail,
-                                sizeof(void *) * (queue->end - queue->start + 1));
-
-          /* move provider bitmask to the front */
-          queue->provided = memmove(queue->provided,
-                                    queue->provided + mem_unavail,
-                                    sizeof(unsigned char) * (queue->end - queue->start + 1));
-
-          /* reset start and pointer shifts */
-          queue->shift    = queue->start;
-          queue->data     -= queue->start;
-          queue->provided -= queue->start;
-        } else {
-          /* increase stream buffer size */
-          new_size += QUEUE_OVERHEAD;
-          /* reset pointer shift */
-          queue->data     += queue->shift;
-          queue->provided += queue->shift;
-
-          /* reallocate memory blocks */
-          queue->data     = (void **)vrna_realloc(queue->data, sizeof(void *) * new_size);
-          queue->provided =
-            (unsigned char *)vrna_realloc(queue->provided, sizeof(void *) * new_size);
-          queue->size = new_size;
-
-          /* restore pointer shift */
-          queue->data     -= queue->shift;
-          queue->provided -= queue->shift;
-        }
+      /* only the writer can make progress while we wait */
+      if (ATOMIC_LOAD(&(queue->threaded)) == 0)
+        start_writer(queue);
+
+      if (ATOMIC_LOAD(&(queue->threaded)) != 1) {
+        vrna_message_warning(
+          "vrna_ostream_request(): too many pending indices (%d) in output stream!",
+          num - ATOMIC_LOAD(&(queue->start)));
+        return;
       }
 
-      for (i = queue->end + 1; i <= num; i++)
-        queue->provided[i] = 0;
-
-      queue->end = num;
+      pthread_mutex_lock(&queue->mtx);
+      while (num - ATOMIC_LOAD(&(queue->start)) >= MAX_WINDOW)
+        pthread_cond_wait(&queue->space, &queue->mtx);
+      pthread_mutex_unlock(&queue->mtx);
+#else
+      vrna_message_warning(
+        "vrna_ostream_request(): too many pending indices (%d) in output stream!",
+        num - queue->start);
+      return;
+#endif
     }
 
-#if VRNA_WITH_PTHREADS
-    pthread_mutex_unlock(&queue->mtx);
-#endif
+    /* add the blocks required to store the new indices */
+    for (i = queue->end; i <= num; i++)
+      if ((SLOT(i) == 0) || (i == queue->end))
+        if (!queue->blocks[BLOCK(i)])
+          ATOMIC_STORE(&(queue->blocks[BLOCK(i)]),
+                       (struct stream_slot *)vrna_alloc(sizeof(struct stream_slot) *
+                                                        SLOTS_PER_BLOCK));
+
+    ATOMIC_STORE(&(queue->end), num + 1);
   }
 }
 
@@ -202,29 +364,49 @@ vrna_ostream_provide(struct vrna_ordered_stream_s *queue,
                      unsigned int                 i,
                      void                         *data)
 {
+  unsigned int        start, end;
+  struct stream_slot  *slot;
+
   if (queue) {
-#if VRNA_WITH_PTHREADS
-    pthread_mutex_lock(&queue->mtx);
-#endif
-    if ((queue->end < i) || (i < queue->start)) {
+    start = ATOMIC_LOAD(&(queue->start));
+    end   = ATOMIC_LOAD(&(queue->end));
+
+    if ((end <= i) || (i < start)) {
       vrna_message_warning(
         "vrna_ostream_provide(): data position (%d) out of range [%d:%d]!",
         i,
-        queue->start,
-        queue->end);
+        start,
+        end - 1);
       return;
     }
 
     /* store data */
-    queue->data[i]      = data;
-    queue->provided[i]  = 1;
+    slot        = get_slot(queue, i);
+    slot->data  = data;
+    ATOMIC_STORE(&(slot->provided), 1);
+
+#if VRNA_WITH_PTHREADS
+    if ((ATOMIC_LOAD(&(queue->threaded)) == 0) &&
+        (!pthread_equal(pthread_self(), queue->owner)))
+      start_writer(queue);
+
+    if (ATOMIC_LOAD(&(queue->threaded)) == 1) {
+      /* wake up the writer if it waits for this particular index */
+      if (ATOMIC_LOAD(&(queue->waiting_for)) == i) {
+        pthread_mutex_lock(&queue->mtx);
+        pthread_cond_signal(&queue->cond);
+        pthread_mutex_unlock(&queue->mtx);
+      }
+    } else {
+      /* single data provider, process all consecutive blocks available from the start */
+      flush_direct(queue);
+    }
 
+#else
     /* process all consecutive blocks available from the start */
     if (i == queue->start)
       flush_output(queue);
 
-#if VRNA_WITH_PTHREADS
-    pthread_mutex_unlock(&queue->mtx);
 #endif
   }
 }
@@ -23,6 +23,18 @@ typedef struct vrna_ordered_stream_s *vrna_ostream_t;
  *  This callback will be processed in sequential order as soon as sequential
  *  data in the output stream becomes available.
  *
+ *  @note As long as all data is provided by the thread that created the
+ *        stream, the callback is executed directly within
+ *        vrna_ostream_provide() by that thread. If RNAlib was compiled with
+ *        POSIX threads support and any other thread provides data, the
+ *        callback is executed by a dedicated writer thread from then on,
+ *        which is terminated by vrna_ostream_free(). Threads that provide
+ *        data to the stream therefore never have to wait for the callback
+ *        to finish. As a consequence, there is no guarantee that any output
+ *        has been produced before vrna_ostream_free() returns, and the
+ *        callback must not use data that is modified by other threads
+ *        without proper synchronization.
+ *
  *  @note The callback must also release the memory occupied by the
  *        data passed since the stream will lose any reference to it
  *        after the callback has been executed.
@@ -52,6 +64,12 @@ vrna_ostream_init(vrna_callback_stream_output *output,
 /**
  *  @brief  Free an initialized ordered output stream
  *
+ *  All data that is consecutively available from the head of the stream
+ *  is passed to the callback before the stream is destroyed. Data provided
+ *  after a gap of missing indices is discarded without invoking the callback.
+ *  Only after this function returned, all output is guaranteed to be
+ *  processed.
+ *
  *  @see vrna_ostream_init()
  *
  *  @param  dat   The output stream for which occupied memory should be free'd
@@ -60,6 +78,11 @@ void
 vrna_ostream_free(vrna_ostream_t dat);
 
 
+/**
+ *  @brief  Check whether the ordered output stream may be used by multiple threads
+ *
+ *  @return   Non-zero if data may be provided by concurrent threads, 0 otherwise
+ */
 int
 vrna_ostream_threadsafe(void);
 
@@ -69,7 +92,12 @@ vrna_ostream_threadsafe(void);
  *
  *  This function must be called prior to vrna_ostream_provide() to
  *  indicate that data associted with a certain index number is expected
- *  to be inserted into the stream in the future.
+ *  to be inserted into the stream in the future. Indices must be requested
+ *  in ascending order by a single thread.
+ *
+ *  If the stream holds too many indices that have not been passed to the
+ *  output callback yet, this function blocks until the writer thread caught
+ *  up with the data provided by other threads.
  *
  *  @see vrna_ostream_init(), vrna_ostream_provide(), vrna_ostream_free()
  *
@@ -87,6 +115,9 @@ vrna_ostream_request(vrna_ostream_t dat,
  *  @pre  The index data is provided for must have been requested using
  *        vrna_ostream_request() beforehand.
  *
+ *  Data for different indices may be provided by concurrent threads without
+ *  any locking.
+ *
  *  @see  vrna_ostream_request()
  *
  *  @param  dat   The output stream for which data is provided
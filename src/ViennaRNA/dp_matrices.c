@@ -19,11 +19,14 @@
 
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/model.h"
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/gquad.h"
+#include "ViennaRNA/constraints/hard.h"
 #include "ViennaRNA/dp_matrices.h"
 
 /*
@@ -54,6 +57,13 @@
 #define ALLOC_PF_WO_PROBS         (ALLOC_F | ALLOC_C | ALLOC_FML)
 #define ALLOC_PF_DEFAULT          (ALLOC_PF_WO_PROBS | ALLOC_PROBS | ALLOC_AUX)
 
+/*
+ *  banded DP matrices are used if the sequence is at least BAND_MIN_RATIO
+ *  times longer than the band, i.e. if they require at most 2 / BAND_MIN_RATIO
+ *  of the memory of the full triangular matrices
+ */
+#define BAND_MIN_RATIO            4
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -92,6 +102,12 @@ PRIVATE void            mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
 PRIVATE void            mfe_matrices_free_default(vrna_mx_mfe_t *self);
 
 
+PRIVATE void            mfe_matrices_clear_default(vrna_mx_mfe_t  *vars,
+                                                   unsigned int   n,
+                                                   unsigned int   m);
+
+
+
 PRIVATE void            mfe_matrices_alloc_window(vrna_mx_mfe_t *vars,
                                                   unsigned int  m,
                                                   unsigned int  alloc_vector);
@@ -121,6 +137,12 @@ PRIVATE void            pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
 PRIVATE void            pf_matrices_free_default(vrna_mx_pf_t *self);
 
 
+PRIVATE void            pf_matrices_clear_default(vrna_mx_pf_t  *vars,
+                                                  unsigned int  n,
+                                                  unsigned int  m);
+
+
+
 PRIVATE void            pf_matrices_alloc_window(vrna_mx_pf_t *vars,
                                                  unsigned int m,
                                                  unsigned int alloc_vector);
@@ -167,6 +189,21 @@ add_mfe_matrices(vrna_fold_compound_t *vc,
                  unsigned int         alloc_vector);
 
 
+PRIVATE unsigned int
+get_mx_size(unsigned int  n,
+            unsigned int  m);
+
+
+PRIVATE unsigned int
+get_band_width(vrna_fold_compound_t *fc,
+               unsigned int         options);
+
+
+PRIVATE void
+set_band_width(vrna_fold_compound_t *fc,
+               unsigned int         band);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -239,10 +276,18 @@ vrna_mx_add(vrna_fold_compound_t  *vc,
             vrna_mx_type_e        mx_type,
             unsigned int          options)
 {
-  int ret;
+  int           ret;
+  unsigned int  band;
 
   ret = 1;
 
+  /* select the storage layout, this discards all DP matrices if it changes */
+  if (mx_type == VRNA_MX_DEFAULT) {
+    band = get_band_width(vc, options);
+    if (band != vc->band)
+      set_band_width(vc, band);
+  }
+
   if (options & VRNA_OPTION_MFE)
     ret &= vrna_mx_mfe_add(vc, mx_type, options);
 
@@ -287,6 +332,11 @@ vrna_mx_pf_add(vrna_fold_compound_t *vc,
     mx_alloc_vector = get_mx_alloc_vector(&(vc->exp_params->model_details),
                                           mx_type,
                                           options | VRNA_OPTION_PF);
+
+    /* banded matrices lack q(1, k) and q(k, n), so we always need the linear arrays */
+    if ((mx_type == VRNA_MX_DEFAULT) && (vc->band))
+      mx_alloc_vector |= ALLOC_AUX;
+
     vrna_mx_pf_free(vc);
     return add_pf_matrices(vc, mx_type, mx_alloc_vector);
   }
@@ -300,12 +350,19 @@ vrna_mx_prepare(vrna_fold_compound_t  *vc,
                 unsigned int          options)
 {
   int             ret, realloc;
-  unsigned int    mx_alloc_vector, mx_alloc_vector_current;
+  unsigned int    mx_alloc_vector, mx_alloc_vector_current, band;
   vrna_mx_type_e  mx_type;
 
   ret = 1;
 
   if (vc) {
+    /* select the storage layout, this discards all DP matrices if it changes */
+    if (!(options & VRNA_OPTION_WINDOW)) {
+      band = get_band_width(vc, options);
+      if (band != vc->band)
+        set_band_width(vc, band);
+    }
+
     /*  check whether we have the correct DP matrices attached, and if there is
      *  enough memory allocated
      */
@@ -380,6 +437,62 @@ vrna_mx_prepare(vrna_fold_compound_t  *vc,
 }
 
 
+PUBLIC int
+vrna_mx_recycle(vrna_fold_compound_t *vc)
+{
+  int ret = 0;
+
+  if (vc) {
+    if (vc->matrices) {
+      if ((vc->matrices->type == VRNA_MX_DEFAULT) &&
+          (vc->matrices->length >= vc->length)) {
+        mfe_matrices_clear_default(vc->matrices,
+                                   vc->length,
+                                   (vc->band) ? vc->band : vc->length);
+
+        /* G-Quadruplex contributions depend on the sequence and must be re-computed */
+        if (vc->params->model_details.gquad) {
+          switch (vc->type) {
+            case VRNA_FC_TYPE_SINGLE:
+              vc->matrices->ggg = get_gquad_matrix(vc->sequence_encoding2, vc->params);
+              break;
+            case VRNA_FC_TYPE_COMPARATIVE:
+              vc->matrices->ggg = get_gquad_ali_matrix(vc->length,
+                                                       vc->S_cons,
+                                                       vc->S,
+                                                       vc->a2s,
+                                                       vc->n_seq,
+                                                       vc->params);
+              break;
+            default:                      /* do nothing */
+              break;
+          }
+        }
+
+        ret = 1;
+      } else {
+        vrna_mx_mfe_free(vc);
+      }
+    }
+
+    if (vc->exp_matrices) {
+      if ((vc->exp_matrices->type == VRNA_MX_DEFAULT) &&
+          (vc->exp_matrices->length >= vc->length)) {
+        /* G-Quadruplex contributions will be re-computed by vrna_pf() */
+        pf_matrices_clear_default(vc->exp_matrices,
+                                  vc->length,
+                                  (vc->band) ? vc->band : vc->length);
+        ret = 1;
+      } else {
+        vrna_mx_pf_free(vc);
+      }
+    }
+  }
+
+  return ret;
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -482,7 +595,7 @@ add_pf_matrices(vrna_fold_compound_t  *vc,
         break;
       default:
         vc->exp_matrices = get_pf_matrices_alloc(vc->length,
-                                                 vc->length,
+                                                 (vc->band) ? vc->band : vc->length,
                                                  mx_type,
                                                  alloc_vector);
         break;
@@ -522,7 +635,10 @@ add_mfe_matrices(vrna_fold_compound_t *vc,
         vc->matrices = get_mfe_matrices_alloc(vc->length, vc->window_size, mx_type, alloc_vector);
         break;
       default:
-        vc->matrices = get_mfe_matrices_alloc(vc->length, vc->length, mx_type, alloc_vector);
+        vc->matrices = get_mfe_matrices_alloc(vc->length,
+                                              (vc->band) ? vc->band : vc->length,
+                                              mx_type,
+                                              alloc_vector);
         break;
     }
 
@@ -628,7 +744,7 @@ get_pf_matrices_alloc(unsigned int    n,
 
   switch (type) {
     case VRNA_MX_DEFAULT:
-      pf_matrices_alloc_default(vars, n, alloc_vector);
+      pf_matrices_alloc_default(vars, m, alloc_vector);
       break;
 
     case VRNA_MX_WINDOW:
@@ -654,6 +770,110 @@ get_pf_matrices_alloc(unsigned int    n,
 }
 
 
+/*
+ *  Number of entries of a (default) DP matrix for sequence length n that
+ *  stores all (i,j) with j - i <= m, see vrna_idx_col_wise_banded()
+ */
+PRIVATE unsigned int
+get_mx_size(unsigned int  n,
+            unsigned int  m)
+{
+  if (m < n)
+    return (n + 2) * (m + 1);
+
+  return ((n + 1) * (n + 2)) / 2;
+}
+
+
+/*
+ *  Determine the band width of the DP matrices, see vrna_fold_compound_t.band.
+ *  Since the hard constraints forbid all base pairs (i,j) with
+ *  j - i >= max_bp_span, the global MFE and partition function recursions
+ *  never need any entry outside of the band. We restrict banded matrices to
+ *  single sequences without any of the features that may still address
+ *  such entries, or that come with their own (full) matrices.
+ */
+PRIVATE unsigned int
+get_band_width(vrna_fold_compound_t *fc,
+               unsigned int         options)
+{
+  unsigned int  band;
+  vrna_md_t     *md;
+
+  if ((options & VRNA_OPTION_HYBRID) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands != 1) ||
+      (!fc->params) ||
+      (!fc->hc) ||
+      (fc->hc->type != VRNA_HC_DEFAULT) ||
+      (fc->sc) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar))
+    return 0;
+
+  md = &(fc->params->model_details);
+
+  /* backtrack_type 'C' and 'M' read the entries (1, n) of the matrices */
+  if ((md->circ) || (md->gquad) || (md->backtrack_type != 'F'))
+    return 0;
+
+  if (options & VRNA_OPTION_PF) {
+    if (!fc->exp_params)
+      return 0;
+
+    md = &(fc->exp_params->model_details);
+
+    /* base pair probabilities address the entire matrices */
+    if ((md->circ) || (md->gquad) || (md->compute_bpp) || (md->backtrack_type != 'F'))
+      return 0;
+  }
+
+  /* keep matrices in full layout that we are not asked to prepare */
+  if ((fc->band == 0) &&
+      (((fc->matrices) && (!(options & VRNA_OPTION_MFE))) ||
+       ((fc->exp_matrices) && (!(options & VRNA_OPTION_PF)))))
+    return 0;
+
+  md    = &(fc->params->model_details);
+  band  = (unsigned int)md->max_bp_span;
+
+  if ((md->max_bp_span <= md->min_loop_size + 1) ||
+      (BAND_MIN_RATIO * (band + 1) > fc->length))
+    return 0;
+
+  return band;
+}
+
+
+/*
+ *  Switch the index layout of DP matrices and ptype array, and
+ *  remove all DP matrices that use the previous layout
+ */
+PRIVATE void
+set_band_width(vrna_fold_compound_t *fc,
+               unsigned int         band)
+{
+  vrna_mx_mfe_free(fc);
+  vrna_mx_pf_free(fc);
+
+  free(fc->iindx);
+  free(fc->jindx);
+  free(fc->ptype);
+
+  if (band) {
+    fc->iindx = vrna_idx_row_wise_banded(fc->length, band);
+    fc->jindx = vrna_idx_col_wise_banded(fc->length, band);
+    fc->ptype = vrna_ptypes_banded(fc->sequence_encoding2, &(fc->params->model_details), band);
+  } else {
+    fc->iindx = vrna_idx_row_wise(fc->length);
+    fc->jindx = vrna_idx_col_wise(fc->length);
+    fc->ptype = vrna_ptypes(fc->sequence_encoding2, &(fc->params->model_details));
+  }
+
+  fc->band = band;
+}
+
+
 PRIVATE unsigned int
 get_mx_alloc_vector(vrna_md_t       *md_p,
                     vrna_mx_type_e  mx_type,
@@ -696,7 +916,7 @@ mfe_matrices_alloc_default(vrna_mx_mfe_t  *vars,
   unsigned int n, size, lin_size;
 
   n         = vars->length;
-  size      = ((n + 1) * (m + 2)) / 2;
+  size      = get_mx_size(n, m);
   lin_size  = n + 2;
 
   vars->f5  = NULL;
@@ -748,6 +968,45 @@ mfe_matrices_free_default(vrna_mx_mfe_t *self)
 }
 
 
+PRIVATE void
+mfe_matrices_clear_default(vrna_mx_mfe_t  *vars,
+                           unsigned int   n,
+                           unsigned int   m)
+{
+  size_t size, lin_size;
+
+  /* only reset the part of the (possibly larger) arrays that is addressed for length n */
+  size      = sizeof(int) * get_mx_size(n, m);
+  lin_size  = sizeof(int) * (n + 2);
+
+  if (vars->f5)
+    memset(vars->f5, 0, lin_size);
+
+  if (vars->f3)
+    memset(vars->f3, 0, lin_size);
+
+  if (vars->fc)
+    memset(vars->fc, 0, lin_size);
+
+  if (vars->c)
+    memset(vars->c, 0, size);
+
+  if (vars->fML)
+    memset(vars->fML, 0, size);
+
+  if (vars->fM1)
+    memset(vars->fM1, 0, size);
+
+  if (vars->fM2)
+    memset(vars->fM2, 0, lin_size);
+
+  free(vars->ggg);
+  vars->ggg = NULL;
+
+  vars->FcH = vars->FcI = vars->FcM = vars->Fc = INF;
+}
+
+
 PRIVATE void
 mfe_matrices_alloc_window(vrna_mx_mfe_t *vars,
                           unsigned int  m,
@@ -1287,7 +1546,7 @@ pf_matrices_alloc_default(vrna_mx_pf_t  *vars,
   unsigned int n, size, lin_size;
 
   n         = vars->length;
-  size      = ((n + 1) * (n + 2)) / 2;
+  size      = get_mx_size(n, m);
   lin_size  = n + 2;
 
   vars->q     = NULL;
@@ -1339,6 +1598,46 @@ pf_matrices_free_default(vrna_mx_pf_t *self)
 }
 
 
+PRIVATE void
+pf_matrices_clear_default(vrna_mx_pf_t  *vars,
+                          unsigned int  n,
+                          unsigned int  m)
+{
+  size_t size, lin_size;
+
+  /* only reset the part of the (possibly larger) arrays that is addressed for length n */
+  size      = sizeof(FLT_OR_DBL) * get_mx_size(n, m);
+  lin_size  = sizeof(FLT_OR_DBL) * (n + 2);
+
+  if (vars->q)
+    memset(vars->q, 0, size);
+
+  if (vars->qb)
+    memset(vars->qb, 0, size);
+
+  if (vars->qm)
+    memset(vars->qm, 0, size);
+
+  if (vars->qm1)
+    memset(vars->qm1, 0, size);
+
+  if (vars->qm2)
+    memset(vars->qm2, 0, lin_size);
+
+  if (vars->probs)
+    memset(vars->probs, 0, size);
+
+  if (vars->q1k)
+    memset(vars->q1k, 0, lin_size);
+
+  if (vars->qln)
+    memset(vars->qln, 0, lin_size);
+
+  free(vars->G);
+  vars->G = NULL;
+}
+
+
 PRIVATE void
 pf_matrices_alloc_window(vrna_mx_pf_t *vars,
                          unsigned int m,
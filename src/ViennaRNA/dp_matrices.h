@@ -409,6 +409,27 @@ vrna_mx_prepare(vrna_fold_compound_t  *vc,
                 unsigned int          options);
 
 
+/**
+ *  @brief  Prepare the DP matrices of a #vrna_fold_compound_t for re-use with a new sequence
+ *
+ *  This function is intended to be called whenever the sequence (and thus the length)
+ *  of a #vrna_fold_compound_t has been replaced, e.g. by vrna_fold_compound_reset_sequence().
+ *  Default DP matrices that provide enough memory for the current length are kept
+ *  and only the part that is actually addressed for the current length is reset
+ *  to zero. All other matrices are released and will be re-allocated on demand
+ *  by the next call to vrna_mx_prepare(). Matrices that depend on the sequence
+ *  itself, e.g. the G-Quadruplex contributions, are re-computed.
+ *
+ *  @see  vrna_fold_compound_reset_sequence(), vrna_fold_compound_reset_alignment(),
+ *        vrna_mx_prepare(), vrna_mx_mfe_free(), vrna_mx_pf_free()
+ *
+ *  @param  vc  The #vrna_fold_compound_t that holds pointers to the DP matrices
+ *  @returns    1 if (some) DP matrices were kept, 0 otherwise
+ */
+int
+vrna_mx_recycle(vrna_fold_compound_t *vc);
+
+
 /**
  *  @brief  Free memory occupied by the Minimum Free Energy (MFE) Dynamic Programming (DP) matrices
  *
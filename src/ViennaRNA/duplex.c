@@ -51,16 +51,25 @@
  # PRIVATE VARIABLES             #
  #################################
  */
-PRIVATE vrna_param_t  *P = NULL;
-PRIVATE int           **c = NULL;     /* energy array, given that i-j pair */
-PRIVATE short         *S1 = NULL, *SS1 = NULL, *S2 = NULL, *SS2 = NULL;
-PRIVATE int           n1, n2;         /* sequence lengths */
+struct vrna_duplex_s {
+  vrna_param_t  *P;
+  int           (*pair)[MAXALPHA + 1];
+  int           *rtype;
+  short         *alias;
+  int           **c;              /* energy array, given that i-j pair */
+  short         *S1, *SS1, *S2, *SS2;
+  int           n1, n2;           /* sequence lengths */
+};
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
+PRIVATE vrna_duplex_t *backward_compat_duplex = NULL;
 
 #ifdef _OPENMP
 
-/* NOTE: all variables are assumed to be uninitialized if they are declared as threadprivate
- */
-#pragma omp threadprivate(P, c, S1, SS1, S2, SS2, n1, n2)
+#pragma omp threadprivate(backward_compat_duplex)
+
+#endif
 
 #endif
 
@@ -70,27 +79,31 @@ PRIVATE int           n1, n2;         /* sequence lengths */
  #################################
  */
 PRIVATE duplexT
-duplexfold_cu(const char  *s1,
-              const char  *s2,
-              int         clean_up);
+duplexfold_cu(vrna_duplex_t *duplex,
+              const char    *s1,
+              const char    *s2,
+              int           clean_up);
 
 
 PRIVATE duplexT
-aliduplexfold_cu(const char *s1[],
-                 const char *s2[],
-                 int        clean_up);
+aliduplexfold_cu(vrna_duplex_t  *duplex,
+                 const char     *s1[],
+                 const char     *s2[],
+                 int            clean_up);
 
 
 PRIVATE char *
-backtrack(int i,
-          int j);
+backtrack(vrna_duplex_t *duplex,
+          int           i,
+          int           j);
 
 
 PRIVATE char *
-alibacktrack(int          i,
-             int          j,
-             const short  **S1,
-             const short  **S2);
+alibacktrack(vrna_duplex_t  *duplex,
+             int            i,
+             int            j,
+             const short    **S1,
+             const short    **S2);
 
 
 PRIVATE int
@@ -103,75 +116,112 @@ covscore(const int  *types,
          int        n_seq);
 
 
+PRIVATE short *
+encode_mismatches(vrna_duplex_t *duplex,
+                  const short   *S);
+
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
+PRIVATE vrna_duplex_t *
+duplex_backward_compat(void);
+
+
+#endif
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
  #################################
  */
-PUBLIC duplexT
-duplexfold(const char *s1,
-           const char *s2)
+PUBLIC vrna_duplex_t *
+vrna_duplex_init(const vrna_md_t *md_p)
 {
-  return duplexfold_cu(s1, s2, 1);
+  vrna_md_t     md;
+  vrna_duplex_t *duplex;
+
+  if (md_p)
+    vrna_md_copy(&md, md_p);
+  else
+    vrna_md_set_default(&md);
+
+  duplex        = (vrna_duplex_t *)vrna_alloc(sizeof(vrna_duplex_t));
+  duplex->P     = vrna_params(&md);
+  duplex->pair  = duplex->P->model_details.pair;
+  duplex->rtype = &(duplex->P->model_details.rtype[0]);
+  duplex->alias = &(duplex->P->model_details.alias[0]);
+
+  return duplex;
 }
 
 
-PRIVATE duplexT
-duplexfold_cu(const char  *s1,
-              const char  *s2,
-              int         clean_up)
+PUBLIC void
+vrna_duplex_free(vrna_duplex_t *duplex)
 {
-  int       i, j, Emin = INF, i_min = 0, j_min = 0;
-  char      *struc;
-  duplexT   mfe;
-  vrna_md_t md;
+  if (duplex) {
+    free(duplex->P);
+    free(duplex);
+  }
+}
+
+
+PUBLIC duplexT
+vrna_duplexfold(vrna_duplex_t *duplex,
+                const char    *s1,
+                const char    *s2)
+{
+  return duplexfold_cu(duplex, s1, s2, 1);
+}
 
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
 
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    if (P)
-      free(P);
+PRIVATE duplexT
+duplexfold_cu(vrna_duplex_t *duplex,
+              const char    *s1,
+              const char    *s2,
+              int           clean_up)
+{
+  int     i, j, Emin = INF, i_min = 0, j_min = 0;
+  char    *struc;
+  duplexT mfe;
 
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
+  duplex->n1  = (int)strlen(s1);
+  duplex->n2  = (int)strlen(s2);
 
-  c = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  for (i = 1; i <= n1; i++)
-    c[i] = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
+  duplex->c = (int **)vrna_alloc(sizeof(int *) * (duplex->n1 + 1));
+  for (i = 1; i <= duplex->n1; i++)
+    duplex->c[i] = (int *)vrna_alloc(sizeof(int) * (duplex->n2 + 1));
 
-  S1  = encode_sequence(s1, 0);
-  S2  = encode_sequence(s2, 0);
-  SS1 = encode_sequence(s1, 1);
-  SS2 = encode_sequence(s2, 1);
+  duplex->S1  = encode_sequence(s1, 0);
+  duplex->S2  = encode_sequence(s2, 0);
+  duplex->SS1 = encode_mismatches(duplex, duplex->S1);
+  duplex->SS2 = encode_mismatches(duplex, duplex->S2);
 
-  for (i = 1; i <= n1; i++) {
-    for (j = n2; j > 0; j--) {
+  for (i = 1; i <= duplex->n1; i++) {
+    for (j = duplex->n2; j > 0; j--) {
       int type, type2, E, k, l;
-      type    = pair[S1[i]][S2[j]];
-      c[i][j] = type ? P->DuplexInit : INF;
+      type            = duplex->pair[duplex->S1[i]][duplex->S2[j]];
+      duplex->c[i][j] = type ? duplex->P->DuplexInit : INF;
       if (!type)
         continue;
 
-      c[i][j] += vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n2) ? SS2[j + 1] : -1, P);
+      duplex->c[i][j] += vrna_E_ext_stem(type, (i > 1) ? duplex->SS1[i - 1] : -1, (j < duplex->n2) ? duplex->SS2[j + 1] : -1, duplex->P);
       for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= duplex->n2; l++) {
           if (i - k + l - j - 2 > MAXLOOP)
             break;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = duplex->pair[duplex->S1[k]][duplex->S2[l]];
           if (!type2)
             continue;
 
-          E = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                        SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
-          c[i][j] = MIN2(c[i][j], c[k][l] + E);
+          E = E_IntLoop(i - k - 1, l - j - 1, type2, duplex->rtype[type],
+                        duplex->SS1[k + 1], duplex->SS2[l - 1], duplex->SS1[i - 1], duplex->SS2[j + 1], duplex->P);
+          duplex->c[i][j] = MIN2(duplex->c[i][j], duplex->c[k][l] + E);
         }
       }
-      E = c[i][j];
-      E += vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
+      E = duplex->c[i][j];
+      E += vrna_E_ext_stem(duplex->rtype[type], (j > 1) ? duplex->SS2[j - 1] : -1, (i < duplex->n1) ? duplex->SS1[i + 1] : -1, duplex->P);
       if (E < Emin) {
         Emin  = E;
         i_min = i;
@@ -180,8 +230,8 @@ duplexfold_cu(const char  *s1,
     }
   }
 
-  struc = backtrack(i_min, j_min);
-  if (i_min < n1)
+  struc = backtrack(duplex, i_min, j_min);
+  if (i_min < duplex->n1)
     i_min++;
 
   if (j_min > 1)
@@ -192,13 +242,13 @@ duplexfold_cu(const char  *s1,
   mfe.energy    = (float)Emin / 100.;
   mfe.structure = struc;
   if (clean_up) {
-    for (i = 1; i <= n1; i++)
-      free(c[i]);
-    free(c);
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    for (i = 1; i <= duplex->n1; i++)
+      free(duplex->c[i]);
+    free(duplex->c);
+    free(duplex->S1);
+    free(duplex->S2);
+    free(duplex->SS1);
+    free(duplex->SS2);
   }
 
   return mfe;
@@ -206,10 +256,11 @@ duplexfold_cu(const char  *s1,
 
 
 PUBLIC duplexT *
-duplex_subopt(const char  *s1,
-              const char  *s2,
-              int         delta,
-              int         w)
+vrna_duplex_subopt(vrna_duplex_t  *duplex,
+                   const char     *s1,
+                   const char     *s2,
+                   int            delta,
+                   int            w)
 {
   int     i, j, n1, n2, thresh, E, n_subopt = 0, n_max;
   char    *struc;
@@ -218,7 +269,7 @@ duplex_subopt(const char  *s1,
 
   n_max   = 16;
   subopt  = (duplexT *)vrna_alloc(n_max * sizeof(duplexT));
-  mfe     = duplexfold_cu(s1, s2, 0);
+  mfe     = duplexfold_cu(duplex, s1, s2, 0);
   free(mfe.structure);
 
   thresh  = (int)mfe.energy * 100 + 0.1 + delta;
@@ -227,12 +278,12 @@ duplex_subopt(const char  *s1,
   for (i = n1; i > 0; i--) {
     for (j = 1; j <= n2; j++) {
       int type, ii, jj, Ed;
-      type = pair[S2[j]][S1[i]];
+      type = duplex->pair[duplex->S2[j]][duplex->S1[i]];
       if (!type)
         continue;
 
-      E   = Ed = c[i][j];
-      Ed  += vrna_E_ext_stem(type, (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
+      E   = Ed = duplex->c[i][j];
+      Ed  += vrna_E_ext_stem(type, (j > 1) ? duplex->SS2[j - 1] : -1, (i < n1) ? duplex->SS1[i + 1] : -1, duplex->P);
       if (Ed > thresh)
         continue;
 
@@ -242,7 +293,7 @@ duplex_subopt(const char  *s1,
        */
       for (ii = MAX2(i - w, 1); (ii <= MIN2(i + w, n1)) && type; ii++) {
         for (jj = MAX2(j - w, 1); jj <= MIN2(j + w, n2); jj++)
-          if (c[ii][jj] < E) {
+          if (duplex->c[ii][jj] < E) {
             type = 0;
             break;
           }
@@ -250,7 +301,7 @@ duplex_subopt(const char  *s1,
       if (!type)
         continue;
 
-      struc = backtrack(i, j);
+      struc = backtrack(duplex, i, j);
       vrna_message_info(stderr, "%d %d %d", i, j, E);
       if (n_subopt + 1 >= n_max) {
         n_max   *= 2;
@@ -265,12 +316,12 @@ duplex_subopt(const char  *s1,
   }
   /* free all static globals */
   for (i = 1; i <= n1; i++)
-    free(c[i]);
-  free(c);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+    free(duplex->c[i]);
+  free(duplex->c);
+  free(duplex->S1);
+  free(duplex->S2);
+  free(duplex->SS1);
+  free(duplex->SS2);
 
   if (subopt_sorted)
     qsort(subopt, n_subopt, sizeof(duplexT), compare);
@@ -283,42 +334,43 @@ duplex_subopt(const char  *s1,
 
 
 PRIVATE char *
-backtrack(int i,
-          int j)
+backtrack(vrna_duplex_t *duplex,
+          int           i,
+          int           j)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, type, type2, E, traced, i0, j0;
   char  *st1, *st2, *struc;
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n1 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n2 + 1));
+  st1 = (char *)vrna_alloc(sizeof(char) * (duplex->n1 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (duplex->n2 + 1));
 
-  i0  = MIN2(i + 1, n1);
+  i0  = MIN2(i + 1, duplex->n1);
   j0  = MAX2(j - 1, 1);
 
-  while (i > 0 && j <= n2) {
-    E           = c[i][j];
+  while (i > 0 && j <= duplex->n2) {
+    E           = duplex->c[i][j];
     traced      = 0;
     st1[i - 1]  = '(';
     st2[j - 1]  = ')';
-    type        = pair[S1[i]][S2[j]];
+    type        = duplex->pair[duplex->S1[i]][duplex->S2[j]];
     if (!type)
       vrna_message_error("backtrack failed in fold duplex");
 
     for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-      for (l = j + 1; l <= n2; l++) {
+      for (l = j + 1; l <= duplex->n2; l++) {
         int LE;
         if (i - k + l - j - 2 > MAXLOOP)
           break;
 
-        type2 = pair[S1[k]][S2[l]];
+        type2 = duplex->pair[duplex->S1[k]][duplex->S2[l]];
         if (!type2)
           continue;
 
-        LE = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                       SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
-        if (E == c[k][l] + LE) {
+        LE = E_IntLoop(i - k - 1, l - j - 1, type2, duplex->rtype[type],
+                       duplex->SS1[k + 1], duplex->SS2[l - 1], duplex->SS1[i - 1], duplex->SS2[j + 1], duplex->P);
+        if (E == duplex->c[k][l] + LE) {
           traced  = 1;
           i       = k;
           j       = l;
@@ -329,8 +381,8 @@ backtrack(int i,
         break;
     }
     if (!traced) {
-      E -= vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n2) ? SS2[j + 1] : -1, P);
-      if (E != P->DuplexInit)
+      E -= vrna_E_ext_stem(type, (i > 1) ? duplex->SS1[i - 1] : -1, (j < duplex->n2) ? duplex->SS2[j + 1] : -1, duplex->P);
+      if (E != duplex->P->DuplexInit)
         vrna_message_error("backtrack failed in fold duplex");
       else
         break;
@@ -339,7 +391,7 @@ backtrack(int i,
   if (i > 1)
     i--;
 
-  if (j < n2)
+  if (j < duplex->n2)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -388,27 +440,28 @@ compare(const void  *sub1,
 /*---------------------------------------------------------------------------*/
 
 PUBLIC duplexT
-aliduplexfold(const char  *s1[],
-              const char  *s2[])
+vrna_aliduplexfold(vrna_duplex_t  *duplex,
+                   const char     *s1[],
+                   const char     *s2[])
 {
-  return aliduplexfold_cu(s1, s2, 1);
+  return aliduplexfold_cu(duplex, s1, s2, 1);
 }
 
 
 PRIVATE duplexT
-aliduplexfold_cu(const char *s1[],
-                 const char *s2[],
-                 int        clean_up)
+aliduplexfold_cu(vrna_duplex_t  *duplex,
+                 const char     *s1[],
+                 const char     *s2[],
+                 int            clean_up)
 {
-  int       i, j, s, n_seq, Emin = INF, i_min = 0, j_min = 0;
-  char      *struc;
-  duplexT   mfe;
-  short     **S1, **S2;
-  int       *type;
-  vrna_md_t md;
+  int     i, j, s, n_seq, Emin = INF, i_min = 0, j_min = 0;
+  char    *struc;
+  duplexT mfe;
+  short   **S1, **S2;
+  int     *type;
 
-  n1  = (int)strlen(s1[0]);
-  n2  = (int)strlen(s2[0]);
+  duplex->n1  = (int)strlen(s1[0]);
+  duplex->n2  = (int)strlen(s2[0]);
 
   for (s = 0; s1[s] != NULL; s++);
   n_seq = s;
@@ -416,26 +469,17 @@ aliduplexfold_cu(const char *s1[],
   if (n_seq != s)
     vrna_message_error("unequal number of sequences in aliduplexfold()\n");
 
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  c = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  for (i = 1; i <= n1; i++)
-    c[i] = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
+  duplex->c = (int **)vrna_alloc(sizeof(int *) * (duplex->n1 + 1));
+  for (i = 1; i <= duplex->n1; i++)
+    duplex->c[i] = (int *)vrna_alloc(sizeof(int) * (duplex->n2 + 1));
 
   S1  = (short **)vrna_alloc((n_seq + 1) * sizeof(short *));
   S2  = (short **)vrna_alloc((n_seq + 1) * sizeof(short *));
   for (s = 0; s < n_seq; s++) {
-    if (strlen(s1[s]) != n1)
+    if (strlen(s1[s]) != duplex->n1)
       vrna_message_error("uneqal seqence lengths");
 
-    if (strlen(s2[s]) != n2)
+    if (strlen(s2[s]) != duplex->n2)
       vrna_message_error("uneqal seqence lengths");
 
     S1[s] = encode_sequence(s1[s], 0);
@@ -443,54 +487,54 @@ aliduplexfold_cu(const char *s1[],
   }
   type = (int *)vrna_alloc(n_seq * sizeof(int));
 
-  for (i = 1; i <= n1; i++) {
-    for (j = n2; j > 0; j--) {
+  for (i = 1; i <= duplex->n1; i++) {
+    for (j = duplex->n2; j > 0; j--) {
       int k, l, E, psc;
       for (s = 0; s < n_seq; s++)
-        type[s] = pair[S1[s][i]][S2[s][j]];
+        type[s] = duplex->pair[S1[s][i]][S2[s][j]];
       psc = covscore(type, n_seq);
       for (s = 0; s < n_seq; s++)
         if (type[s] == 0)
           type[s] = 7;
 
-      c[i][j] = (psc >= MINPSCORE) ? (n_seq * P->DuplexInit) : INF;
+      duplex->c[i][j] = (psc >= MINPSCORE) ? (n_seq * duplex->P->DuplexInit) : INF;
       if (psc < MINPSCORE)
         continue;
 
       for (s = 0; s < n_seq; s++)
-        c[i][j] += vrna_E_ext_stem(type[s],
-                                   (i > 1) ? S1[s][i - 1] : -1,
-                                   (j < n2) ? S2[s][j + 1] : -1,
-                                   P);
+        duplex->c[i][j] += vrna_E_ext_stem(type[s],
+                                           (i > 1) ? S1[s][i - 1] : -1,
+                                           (j < duplex->n2) ? S2[s][j + 1] : -1,
+                                           duplex->P);
 
       for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= duplex->n2; l++) {
           int type2;
           if (i - k + l - j - 2 > MAXLOOP)
             break;
 
-          if (c[k][l] > INF / 2)
+          if (duplex->c[k][l] > INF / 2)
             continue;
 
           for (E = s = 0; s < n_seq; s++) {
-            type2 = pair[S1[s][k]][S2[s][l]];
+            type2 = duplex->pair[S1[s][k]][S2[s][l]];
             if (type2 == 0)
               type2 = 7;
 
-            E += E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type[s]],
-                           S1[s][k + 1], S2[s][l - 1], S1[s][i - 1], S2[s][j + 1], P);
+            E += E_IntLoop(i - k - 1, l - j - 1, type2, duplex->rtype[type[s]],
+                           S1[s][k + 1], S2[s][l - 1], S1[s][i - 1], S2[s][j + 1], duplex->P);
           }
-          c[i][j] = MIN2(c[i][j], c[k][l] + E);
+          duplex->c[i][j] = MIN2(duplex->c[i][j], duplex->c[k][l] + E);
         }
       }
-      c[i][j] -= psc;
-      E       = c[i][j];
+      duplex->c[i][j] -= psc;
+      E       = duplex->c[i][j];
       for (s = 0; s < n_seq; s++)
         E +=
-          vrna_E_ext_stem(rtype[type[s]],
+          vrna_E_ext_stem(duplex->rtype[type[s]],
                           (j > 1) ? S2[s][j - 1] : -1,
-                          (i < n1) ? S1[s][i + 1] : -1,
-                          P);
+                          (i < duplex->n1) ? S1[s][i + 1] : -1,
+                          duplex->P);
       if (E < Emin) {
         Emin  = E;
         i_min = i;
@@ -499,8 +543,8 @@ aliduplexfold_cu(const char *s1[],
     }
   }
 
-  struc = alibacktrack(i_min, j_min, (const short **)S1, (const short **)S2);
-  if (i_min < n1)
+  struc = alibacktrack(duplex, i_min, j_min, (const short **)S1, (const short **)S2);
+  if (i_min < duplex->n1)
     i_min++;
 
   if (j_min > 1)
@@ -511,9 +555,9 @@ aliduplexfold_cu(const char *s1[],
   mfe.energy    = (float)(Emin / (100. * n_seq));
   mfe.structure = struc;
   if (clean_up) {
-    for (i = 1; i <= n1; i++)
-      free(c[i]);
-    free(c);
+    for (i = 1; i <= duplex->n1; i++)
+      free(duplex->c[i]);
+    free(duplex->c);
   }
 
   for (s = 0; s < n_seq; s++) {
@@ -528,10 +572,11 @@ aliduplexfold_cu(const char *s1[],
 
 
 PUBLIC duplexT *
-aliduplex_subopt(const char *s1[],
-                 const char *s2[],
-                 int        delta,
-                 int        w)
+vrna_aliduplex_subopt(vrna_duplex_t *duplex,
+                      const char    *s1[],
+                      const char    *s2[],
+                      int           delta,
+                      int           w)
 {
   int     i, j, n1, n2, thresh, E, n_subopt = 0, n_max, s, n_seq, *type;
   char    *struc;
@@ -541,7 +586,7 @@ aliduplex_subopt(const char *s1[],
 
   n_max   = 16;
   subopt  = (duplexT *)vrna_alloc(n_max * sizeof(duplexT));
-  mfe     = aliduplexfold_cu(s1, s2, 0);
+  mfe     = aliduplexfold_cu(duplex, s1, s2, 0);
   free(mfe.structure);
 
   for (s = 0; s1[s] != NULL; s++);
@@ -569,7 +614,7 @@ aliduplex_subopt(const char *s1[],
       int ii, jj, skip, Ed, psc;
 
       for (s = 0; s < n_seq; s++)
-        type[s] = pair[S2[s][j]][S1[s][i]];
+        type[s] = duplex->pair[S2[s][j]][S1[s][i]];
       psc = covscore(type, n_seq);
       for (s = 0; s < n_seq; s++)
         if (type[s] == 0)
@@ -578,10 +623,10 @@ aliduplex_subopt(const char *s1[],
       if (psc < MINPSCORE)
         continue;
 
-      E = Ed = c[i][j];
+      E = Ed = duplex->c[i][j];
       for (s = 0; s < n_seq; s++)
         Ed +=
-          vrna_E_ext_stem(type[s], (j > 1) ? S2[s][j - 1] : -1, (i < n1) ? S1[s][i + 1] : -1, P);
+          vrna_E_ext_stem(type[s], (j > 1) ? S2[s][j - 1] : -1, (i < n1) ? S1[s][i + 1] : -1, duplex->P);
       if (Ed > thresh)
         continue;
 
@@ -591,7 +636,7 @@ aliduplex_subopt(const char *s1[],
        */
       for (skip = 0, ii = MAX2(i - w, 1); (ii <= MIN2(i + w, n1)) && type; ii++) {
         for (jj = MAX2(j - w, 1); jj <= MIN2(j + w, n2); jj++)
-          if (c[ii][jj] < E) {
+          if (duplex->c[ii][jj] < E) {
             skip = 1;
             break;
           }
@@ -599,7 +644,7 @@ aliduplex_subopt(const char *s1[],
       if (skip)
         continue;
 
-      struc = alibacktrack(i, j, (const short **)S1, (const short **)S2);
+      struc = alibacktrack(duplex, i, j, (const short **)S1, (const short **)S2);
       vrna_message_info(stderr, "%d %d %d", i, j, E);
       if (n_subopt + 1 >= n_max) {
         n_max   *= 2;
@@ -614,8 +659,8 @@ aliduplex_subopt(const char *s1[],
   }
 
   for (i = 1; i <= n1; i++)
-    free(c[i]);
-  free(c);
+    free(duplex->c[i]);
+  free(duplex->c);
   for (s = 0; s < n_seq; s++) {
     free(S1[s]);
     free(S2[s]);
@@ -635,18 +680,19 @@ aliduplex_subopt(const char *s1[],
 
 
 PRIVATE char *
-alibacktrack(int          i,
-             int          j,
-             const short  **S1,
-             const short  **S2)
+alibacktrack(vrna_duplex_t  *duplex,
+             int            i,
+             int            j,
+             const short    **S1,
+             const short    **S2)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, *type, type2, E, traced, i0, j0, s, n_seq;
   char  *st1, *st2, *struc;
 
-  n1  = (int)S1[0][0];
-  n2  = (int)S2[0][0];
+  duplex->n1  = (int)S1[0][0];
+  duplex->n2  = (int)S2[0][0];
 
   for (s = 0; S1[s] != NULL; s++);
   n_seq = s;
@@ -654,21 +700,21 @@ alibacktrack(int          i,
   if (n_seq != s)
     vrna_message_error("unequal number of sequences in alibacktrack()\n");
 
-  st1   = (char *)vrna_alloc(sizeof(char) * (n1 + 1));
-  st2   = (char *)vrna_alloc(sizeof(char) * (n2 + 1));
+  st1   = (char *)vrna_alloc(sizeof(char) * (duplex->n1 + 1));
+  st2   = (char *)vrna_alloc(sizeof(char) * (duplex->n2 + 1));
   type  = (int *)vrna_alloc(n_seq * sizeof(int));
 
-  i0  = MIN2(i + 1, n1);
+  i0  = MIN2(i + 1, duplex->n1);
   j0  = MAX2(j - 1, 1);
 
-  while (i > 0 && j <= n2) {
+  while (i > 0 && j <= duplex->n2) {
     int psc;
-    E           = c[i][j];
+    E           = duplex->c[i][j];
     traced      = 0;
     st1[i - 1]  = '(';
     st2[j - 1]  = ')';
     for (s = 0; s < n_seq; s++)
-      type[s] = pair[S1[s][i]][S2[s][j]];
+      type[s] = duplex->pair[S1[s][i]][S2[s][j]];
     psc = covscore(type, n_seq);
     for (s = 0; s < n_seq; s++)
       if (type[s] == 0)
@@ -676,23 +722,23 @@ alibacktrack(int          i,
 
     E += psc;
     for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-      for (l = j + 1; l <= n2; l++) {
+      for (l = j + 1; l <= duplex->n2; l++) {
         int LE;
         if (i - k + l - j - 2 > MAXLOOP)
           break;
 
-        if (c[k][l] > INF / 2)
+        if (duplex->c[k][l] > INF / 2)
           continue;
 
         for (s = LE = 0; s < n_seq; s++) {
-          type2 = pair[S1[s][k]][S2[s][l]];
+          type2 = duplex->pair[S1[s][k]][S2[s][l]];
           if (type2 == 0)
             type2 = 7;
 
-          LE += E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type[s]],
-                          S1[s][k + 1], S2[s][l - 1], S1[s][i - 1], S2[s][j + 1], P);
+          LE += E_IntLoop(i - k - 1, l - j - 1, type2, duplex->rtype[type[s]],
+                          S1[s][k + 1], S2[s][l - 1], S1[s][i - 1], S2[s][j + 1], duplex->P);
         }
-        if (E == c[k][l] + LE) {
+        if (E == duplex->c[k][l] + LE) {
           traced  = 1;
           i       = k;
           j       = l;
@@ -704,8 +750,8 @@ alibacktrack(int          i,
     }
     if (!traced) {
       for (s = 0; s < n_seq; s++)
-        E -= vrna_E_ext_stem(type[s], (i > 1) ? S1[s][i - 1] : -1, (j < n2) ? S2[s][j + 1] : -1, P);
-      if (E != n_seq * P->DuplexInit)
+        E -= vrna_E_ext_stem(type[s], (i > 1) ? S1[s][i - 1] : -1, (j < duplex->n2) ? S2[s][j + 1] : -1, duplex->P);
+      if (E != n_seq * duplex->P->DuplexInit)
         vrna_message_error("backtrack failed in aliduplex");
       else
         break;
@@ -714,7 +760,7 @@ alibacktrack(int          i,
   if (i > 1)
     i--;
 
-  if (j < n2)
+  if (j < duplex->n2)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -780,3 +826,89 @@ covscore(const int  *types,
            ((UNIT * score) / n_seq - nc_fact * UNIT * (pfreq[0] + pfreq[7] * 0.25));
   return pscore;
 }
+
+
+/* encoding for mismatches of nostandard bases */
+PRIVATE short *
+encode_mismatches(vrna_duplex_t *duplex,
+                  const short   *S)
+{
+  int   i, l;
+  short *SS;
+
+  l   = S[0];
+  SS  = (short *)vrna_alloc(sizeof(short) * (l + 2));
+
+  for (i = 1; i <= l; i++)
+    SS[i] = duplex->alias[S[i]];
+
+  SS[l + 1] = SS[1];
+  SS[0]     = SS[l];
+
+  return SS;
+}
+
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
+/*
+ *###########################################
+ *# deprecated functions below              #
+ *###########################################
+ */
+PUBLIC duplexT
+duplexfold(const char *s1,
+           const char *s2)
+{
+  return vrna_duplexfold(duplex_backward_compat(), s1, s2);
+}
+
+
+PUBLIC duplexT *
+duplex_subopt(const char  *s1,
+              const char  *s2,
+              int         delta,
+              int         w)
+{
+  return vrna_duplex_subopt(duplex_backward_compat(), s1, s2, delta, w);
+}
+
+
+PUBLIC duplexT
+aliduplexfold(const char  *s1[],
+              const char  *s2[])
+{
+  return vrna_aliduplexfold(duplex_backward_compat(), s1, s2);
+}
+
+
+PUBLIC duplexT *
+aliduplex_subopt(const char *s1[],
+                 const char *s2[],
+                 int        delta,
+                 int        w)
+{
+  return vrna_aliduplex_subopt(duplex_backward_compat(), s1, s2, delta, w);
+}
+
+
+/*
+ *  As before, the energy parameters are only updated when the temperature changes
+ */
+PRIVATE vrna_duplex_t *
+duplex_backward_compat(void)
+{
+  vrna_md_t md;
+
+  if ((!backward_compat_duplex) ||
+      (fabs(backward_compat_duplex->P->temperature - temperature) > 1e-6)) {
+    vrna_duplex_free(backward_compat_duplex);
+    set_model_details(&md);
+    backward_compat_duplex = vrna_duplex_init(&md);
+  }
+
+  return backward_compat_duplex;
+}
+
+
+#endif
@@ -2,8 +2,7 @@
 #define VIENNA_RNA_PACKAGE_DUPLEX_H
 
 #include <ViennaRNA/datastructures/basic.h>
-
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+#include <ViennaRNA/model.h>
 
 /**
  *  @file     duplex.h
@@ -11,6 +10,86 @@
  *  @brief    Functions for simple RNA-RNA duplex interactions
  */
 
+/**
+ *  @brief  An RNAduplex interaction engine
+ *
+ *  The engine holds the energy parameters, dynamic programming matrices and
+ *  sequence encodings of a duplex computation. An engine may be reused for any
+ *  number of sequence pairs, and different engines can be used concurrently,
+ *  e.g. one per thread.
+ *
+ *  @see  vrna_duplex_init(), vrna_duplex_free(), vrna_duplexfold(), vrna_duplex_subopt()
+ */
+typedef struct vrna_duplex_s vrna_duplex_t;
+
+
+/**
+ *  @brief  Create an RNAduplex interaction engine
+ *
+ *  @param  md  The model details to use, or NULL for default settings
+ *  @return     The engine, to be released by vrna_duplex_free()
+ */
+vrna_duplex_t *
+vrna_duplex_init(const vrna_md_t *md);
+
+
+/**
+ *  @brief  Release an RNAduplex interaction engine
+ */
+void
+vrna_duplex_free(vrna_duplex_t *duplex);
+
+
+/**
+ *  @brief  Compute the minimum free energy duplex of two sequences
+ *
+ *  This is the reentrant version of duplexfold().
+ */
+duplexT
+vrna_duplexfold(vrna_duplex_t *duplex,
+                const char    *s1,
+                const char    *s2);
+
+
+/**
+ *  @brief  Compute suboptimal duplexes of two sequences
+ *
+ *  This is the reentrant version of duplex_subopt().
+ */
+duplexT *
+vrna_duplex_subopt(vrna_duplex_t  *duplex,
+                   const char     *s1,
+                   const char     *s2,
+                   int            delta,
+                   int            w);
+
+
+/**
+ *  @brief  Compute the minimum free energy duplex of two alignments
+ *
+ *  This is the reentrant version of aliduplexfold().
+ */
+duplexT
+vrna_aliduplexfold(vrna_duplex_t  *duplex,
+                   const char     *s1[],
+                   const char     *s2[]);
+
+
+/**
+ *  @brief  Compute suboptimal duplexes of two alignments
+ *
+ *  This is the reentrant version of aliduplex_subopt().
+ */
+duplexT *
+vrna_aliduplex_subopt(vrna_duplex_t *duplex,
+                      const char    *s1[],
+                      const char    *s2[],
+                      int           delta,
+                      int           w);
+
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
 
 duplexT duplexfold(const char *s1,
                    const char *s2);
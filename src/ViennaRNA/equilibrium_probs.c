@@ -29,6 +29,10 @@
 #include "ViennaRNA/part_func.h"
 #include "ViennaRNA/equilibrium_probs.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "ViennaRNA/loops/external_hc.inc"
 
 /*
@@ -117,6 +121,7 @@ typedef struct {
   FLT_OR_DBL  *prm_l;
   FLT_OR_DBL  *prm_l1;
   FLT_OR_DBL  *prml;
+  FLT_OR_DBL  *prm_MLb_k;   /* prm_MLb for each k of the current l */
 
   int         ud_max_size;
   FLT_OR_DBL  **pmlu;
@@ -128,6 +133,10 @@ PRIVATE helper_arrays *
 get_ml_helper_arrays(vrna_fold_compound_t *fc);
 
 
+PRIVATE int
+num_outside_threads(vrna_fold_compound_t *fc);
+
+
 PRIVATE void
 free_ml_helper_arrays(helper_arrays *ml_helpers);
 
@@ -140,6 +149,43 @@ PRIVATE void
 rotate_ml_helper_arrays_inner(helper_arrays *ml_helpers);
 
 
+/*
+ *  Outside values of the base pairs (i, j) retained by the sparse
+ *  outside recursion, one row per i with decreasing j
+ */
+typedef struct {
+  int           *j;
+  FLT_OR_DBL    *o;
+  unsigned int  num;
+  unsigned int  size;
+} sparse_row;
+
+
+PRIVATE int
+sparse_bpp_supported(vrna_fold_compound_t *fc);
+
+
+PRIVATE INLINE void
+sparse_row_append(sparse_row  *row,
+                  int         j,
+                  FLT_OR_DBL  o);
+
+
+PRIVATE void
+sparse_bpp_internal(vrna_fold_compound_t  *fc,
+                    int                   l,
+                    FLT_OR_DBL            *col,
+                    sparse_row            *rows);
+
+
+PRIVATE void
+sparse_bpp_multibranch(vrna_fold_compound_t *fc,
+                       int                  l,
+                       FLT_OR_DBL           *col,
+                       sparse_row           *rows,
+                       helper_arrays        *ml_helpers);
+
+
 PRIVATE void
 compute_bpp_external(vrna_fold_compound_t *fc);
 
@@ -228,7 +274,12 @@ vrna_pr_structure(vrna_fold_compound_t  *fc,
     }
 
     kT  = params->kT / 1000.;
-    Q   = params->model_details.circ ? fc->exp_matrices->qo : fc->exp_matrices->q[fc->iindx[1] - n];
+    if (params->model_details.circ)
+      Q = fc->exp_matrices->qo;
+    else if (fc->band)
+      Q = fc->exp_matrices->q1k[n]; /* banded matrices lack q[1, n] */
+    else
+      Q = fc->exp_matrices->q[fc->iindx[1] - n];
 
     dG = (-log(Q) - n * log(params->pf_scale)) * kT;
 
@@ -260,7 +311,12 @@ vrna_pr_energy(vrna_fold_compound_t *fc,
     n = fc->length;
 
     kT  = params->kT / 1000.;
-    Q   = params->model_details.circ ? fc->exp_matrices->qo : fc->exp_matrices->q[fc->iindx[1] - n];
+    if (params->model_details.circ)
+      Q = fc->exp_matrices->qo;
+    else if (fc->band)
+      Q = fc->exp_matrices->q1k[n]; /* banded matrices lack q[1, n] */
+    else
+      Q = fc->exp_matrices->q[fc->iindx[1] - n];
 
     dG = (-log(Q) - n * log(params->pf_scale)) * kT;
 
@@ -283,6 +339,13 @@ vrna_pairing_probs(vrna_fold_compound_t *vc,
   int ret = 0;
 
   if (vc) {
+    if (vc->band) {
+      vrna_message_warning("vrna_pairing_probs: "
+                           "Base pair probabilities require full DP matrices, "
+                           "re-run vrna_pf() with compute_bpp set!");
+      return ret;
+    }
+
     if (vc->strands > 1)
       ret = pf_co_bppm(vc, structure);
     else
@@ -490,6 +553,185 @@ vrna_stack_prob(vrna_fold_compound_t  *vc,
 }
 
 
+PUBLIC vrna_ep_t *
+vrna_pairing_probs_sparse(vrna_fold_compound_t  *fc,
+                          double                cutoff,
+                          double                prune_ratio)
+{
+  int                       i, j, k, l, n, kl, turn, *my_iindx;
+  unsigned int              cnt, num, size;
+  FLT_OR_DBL                *q, *qb, *q1k, *qln, *col, prune, p;
+  vrna_ep_t                 *pl;
+  sparse_row                *rows;
+  helper_arrays             *ml_helpers;
+  struct default_data       hc_dat_local;
+  vrna_callback_hc_evaluate *evaluate;
+
+  if (!sparse_bpp_supported(fc))
+    return NULL;
+
+  if ((prune_ratio <= 0.) || (prune_ratio > 1.)) {
+    vrna_message_warning("vrna_pairing_probs_sparse: "
+                         "pruning ratio %g out of range (0,1]!",
+                         prune_ratio);
+    return NULL;
+  }
+
+  n         = (int)fc->length;
+  my_iindx  = fc->iindx;
+  turn      = fc->exp_params->model_details.min_loop_size;
+  q         = fc->exp_matrices->q;
+  qb        = fc->exp_matrices->qb;
+
+  /*
+   *  outside values of pairs with probability below the pruning
+   *  threshold are dropped and do not contribute to enclosed pairs
+   */
+  prune = (FLT_OR_DBL)(cutoff * prune_ratio);
+
+  /* exterior loop contributions are taken from the full q matrix */
+  q1k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  qln = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+
+  for (k = 1; k <= n; k++) {
+    q1k[k]  = q[my_iindx[1] - k];
+    qln[k]  = q[my_iindx[k] - n];
+  }
+  q1k[0]      = 1.0;
+  qln[n + 1]  = 1.0;
+
+  col         = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+  rows        = (sparse_row *)vrna_alloc(sizeof(sparse_row) * (n + 2));
+  ml_helpers  = get_ml_helper_arrays(fc);
+  evaluate    = prepare_hc_default(fc, &hc_dat_local);
+
+  /*
+   *  process one column l at a time. The outside values of column l are
+   *  complete once all pairs (i, j) with j > l have been processed, so
+   *  only the retained pairs of the previous columns need to be stored
+   */
+  for (l = n; l > turn + 1; l--) {
+    /* 1. pairs (k, l) in the exterior loop */
+    for (k = 1; k < l - turn; k++) {
+      kl      = my_iindx[k] - l;
+      col[k]  = 0.;
+
+      if ((qb[kl] > 0.) &&
+          (evaluate(1, n, k, l, VRNA_DECOMP_EXT_STEM_OUTSIDE, &hc_dat_local)))
+        col[k] = q1k[k - 1] *
+                 qln[l + 1] /
+                 q1k[n] *
+                 contrib_ext_pair(fc, k, l);
+    }
+
+    /* 2. pairs (k, l) enclosed by another pair (i, j) */
+    sparse_bpp_internal(fc, l, col, rows);
+
+    if (l < n)
+      sparse_bpp_multibranch(fc, l, col, rows, ml_helpers);
+
+    for (k = 1; k < l - turn; k++) {
+      p = col[k] * qb[my_iindx[k] - l];
+      if ((p > 0.) &&
+          (p >= prune))
+        sparse_row_append(&(rows[k]), l, col[k]);
+    }
+  }
+
+  /* collect the pairs above the cutoff in order of increasing i and j */
+  num   = 0;
+  size  = 256;
+  pl    = (vrna_ep_t *)vrna_alloc(sizeof(vrna_ep_t) * size);
+
+  for (i = 1; i <= n; i++) {
+    for (cnt = rows[i].num; cnt > 0; cnt--) {
+      j = rows[i].j[cnt - 1];
+      p = rows[i].o[cnt - 1] * qb[my_iindx[i] - j];
+
+      if (p < (FLT_OR_DBL)cutoff)
+        continue;
+
+      pl[num].i       = i;
+      pl[num].j       = j;
+      pl[num].p       = (float)p;
+      pl[num++].type  = VRNA_PLIST_TYPE_BASEPAIR;
+
+      if (num == size) {
+        size  *= 2;
+        pl    = (vrna_ep_t *)vrna_realloc(pl, sizeof(vrna_ep_t) * size);
+      }
+    }
+
+    free(rows[i].j);
+    free(rows[i].o);
+  }
+
+  pl[num].i = pl[num].j = 0;
+  pl        = (vrna_ep_t *)vrna_realloc(pl, sizeof(vrna_ep_t) * (num + 1));
+
+  free_ml_helper_arrays(ml_helpers);
+  free(rows);
+  free(col);
+  free(q1k);
+  free(qln);
+
+  return pl;
+}
+
+
+PUBLIC double
+vrna_ensemble_defect_from_plist(int         length,
+                                vrna_ep_t   *pl,
+                                const char  *structure)
+{
+  int       i;
+  short     *pt;
+  double    ed, *pp, *pt_p;
+  vrna_ep_t *ptr;
+
+  ed = -1.;
+
+  if ((pl) &&
+      (structure) &&
+      (length > 0) &&
+      (strlen(structure) == (size_t)length)) {
+    pt    = vrna_ptable(structure);
+    pp    = (double *)vrna_alloc(sizeof(double) * (length + 1));
+    pt_p  = (double *)vrna_alloc(sizeof(double) * (length + 1));
+
+    for (ptr = pl; ptr->i > 0; ptr++) {
+      if (ptr->type != VRNA_PLIST_TYPE_BASEPAIR)
+        continue;
+
+      pp[ptr->i]  += ptr->p;
+      pp[ptr->j]  += ptr->p;
+
+      if (pt[ptr->i] == ptr->j) {
+        pt_p[ptr->i]  = ptr->p;
+        pt_p[ptr->j]  = ptr->p;
+      }
+    }
+
+    ed = 0.;
+
+    for (i = 1; i <= length; i++) {
+      if (pt[i] == 0)
+        ed += pp[i];
+      else
+        ed += 1 - pt_p[i];
+    }
+
+    ed /= (double)length;
+
+    free(pt_p);
+    free(pp);
+    free(pt);
+  }
+
+  return ed;
+}
+
+
 PUBLIC void
 vrna_pf_dimer_probs(double                  FAB,
                     double                  FA,
@@ -800,6 +1042,8 @@ get_ml_helper_arrays(vrna_fold_compound_t *fc)
   ml_helpers->prm_l1  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
   ml_helpers->prml    = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
 
+  ml_helpers->prm_MLb_k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+
   ml_helpers->ud_max_size = 0;
   ml_helpers->pmlu        = NULL;
   ml_helpers->prm_MLbu    = NULL;
@@ -827,6 +1071,37 @@ get_ml_helper_arrays(vrna_fold_compound_t *fc)
 }
 
 
+/*
+ *  Determine the number of threads for the per-column loops of the outside
+ *  recursions. Returns 1 whenever the loops must run sequentially
+ */
+PRIVATE int
+num_outside_threads(vrna_fold_compound_t *fc)
+{
+  int num_threads = 1;
+
+#ifdef _OPENMP
+  vrna_sc_t *sc;
+
+  num_threads = fc->exp_params->model_details.num_threads;
+  sc          = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sc : NULL;
+
+  /* unstructured domains use sliding helper arrays along k */
+  if ((fc->domains_up) && (fc->domains_up->exp_energy_cb))
+    return 1;
+
+  /* probability corrections of auxiliary base pairs are collected in a single list */
+  if ((sc) && (sc->bt))
+    return 1;
+
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+#endif
+
+  return (num_threads > 1) ? num_threads : 1;
+}
+
+
 PRIVATE void
 free_ml_helper_arrays(helper_arrays *ml_helpers)
 {
@@ -835,6 +1110,7 @@ free_ml_helper_arrays(helper_arrays *ml_helpers)
   free(ml_helpers->prm_l);
   free(ml_helpers->prm_l1);
   free(ml_helpers->prml);
+  free(ml_helpers->prm_MLb_k);
 
   if (ml_helpers->pmlu) {
     for (u = 0; u <= ml_helpers->ud_max_size; u++)
@@ -1034,8 +1310,8 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
   short             *S1;
   unsigned int      *sn;
   int               i, j, k, n, ij, kl, u1, u2, *my_iindx, *jindx, *rtype,
-                    turn, with_ud, *hc_up_int;
-  FLT_OR_DBL        temp, tmp2, *qb, *probs, *scale;
+                    turn, with_ud, *hc_up_int, num_threads, ov_local;
+  FLT_OR_DBL        temp, tmp2, *qb, *probs, *scale, Qmax_local;
   double            max_real;
   vrna_exp_param_t  *pf_params;
   vrna_md_t         *md;
@@ -1063,9 +1339,21 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
   probs = fc->exp_matrices->probs;
   scale = fc->exp_matrices->scale;
 
-  max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  max_real    = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  num_threads = num_outside_threads(fc);
+  Qmax_local  = *Qmax;
+  ov_local    = 0;
 
-  /* 2. bonding k,l as substem of 2:loop enclosed by i,j */
+  /*
+   *  2. bonding k,l as substem of 2:loop enclosed by i,j
+   *  all enclosing pairs (i,j) have j > l, so each k can be processed
+   *  independently
+   */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads) \
+  if (num_threads > 1) private(i, j, ij, kl, u1, u2, type, type_2, temp, tmp2) \
+  reduction(+:ov_local) reduction(max:Qmax_local)
+#endif
   for (k = 1; k < l - turn; k++) {
     kl = my_iindx[k] - l;
 
@@ -1179,19 +1467,24 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
       }
     }
 
-    if (probs[kl] > (*Qmax)) {
-      (*Qmax) = probs[kl];
-      if ((*Qmax) > max_real / 10.)
+    if (probs[kl] > Qmax_local) {
+      Qmax_local = probs[kl];
+      if (Qmax_local > max_real / 10.)
         vrna_message_warning("P close to overflow: %d %d %g %g\n",
                              k, l, probs[kl], qb[kl]);
     }
 
     if (probs[kl] >= max_real) {
-      (*ov)++;
+      ov_local++;
       probs[kl] = FLT_MAX;
     }
   }
 
+  if (Qmax_local > (*Qmax))
+    (*Qmax) = Qmax_local;
+
+  (*ov) += ov_local;
+
   if (md->gquad)
     compute_gquad_prob_internal(fc, l);
 }
@@ -1354,9 +1647,9 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
   short             *S, *S1, s5, s3;
   unsigned int      *sn;
   int               cnt, i, j, k, n, u, ii, ij, kl, lj, turn, *my_iindx, *jindx,
-                    *rtype, with_gquad, with_ud;
+                    *rtype, with_gquad, with_ud, num_threads, ov_local;
   FLT_OR_DBL        temp, ppp, prm_MLb, prmt, prmt1, *qb, *probs, *qm, *G, *scale,
-                    *expMLbase, expMLclosing, expMLstem;
+                    *expMLbase, expMLclosing, expMLstem, Qmax_local;
   double            max_real;
   vrna_exp_param_t  *pf_params;
   vrna_md_t         *md;
@@ -1388,17 +1681,28 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
   with_ud       = (domains_up && domains_up->exp_energy_cb) ? 1 : 0;
   with_gquad    = md->gquad;
   expMLstem     = (with_gquad) ? exp_E_MLstem(0, -1, -1, pf_params) : 0;
+  num_threads   = num_outside_threads(fc);
 
-  prm_MLb   = 0.;
-  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  prm_MLb     = 0.;
+  Qmax_local  = *Qmax;
+  ov_local    = 0;
+  max_real    = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
 
   if (sn[l + 1] != sn[l]) {
     /* set prm_l to 0 to get prm_l1 in the next round to be 0 */
     for (i = 0; i <= n; i++)
       ml_helpers->prm_l[i] = 0;
   } else {
+    /*
+     *  1st pass: contributions of all multibranch loops closed by (i, j)
+     *  with i = k - 1 and j > l, and left-most stem ending at l. These
+     *  are independent for each i
+     */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads) \
+  if (num_threads > 1) private(i, j, u, cnt, ii, ij, lj, kl, tt, s3, temp, ppp, prmt, prmt1)
+#endif
     for (k = 2; k < l - turn; k++) {
-      kl    = my_iindx[k] - l;
       i     = k - 1;
       prmt  = prmt1 = 0.0;
 
@@ -1511,6 +1815,15 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
         if (with_ud)
           ml_helpers->pmlu[0][i] = prmt1;
       }
+    }
+
+    /*
+     *  2nd pass: accumulate the contributions of all enclosing pairs (i, j)
+     *  with i < k in prm_MLb. This is an inherently sequential prefix
+     */
+    for (k = 2; k < l - turn; k++) {
+      kl  = my_iindx[k] - l;
+      i   = k - 1;
 
       /* i is unpaired */
       if (hc->up_ml[i]) {
@@ -1558,7 +1871,8 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
           ml_helpers->prm_MLbu[0] = ml_helpers->prml[i];
       }
 
-      ml_helpers->prml[i] = ml_helpers->prml[i] + ml_helpers->prm_l[i];
+      ml_helpers->prml[i]       = ml_helpers->prml[i] + ml_helpers->prm_l[i];
+      ml_helpers->prm_MLb_k[k]  = prm_MLb;
 
       tt = ptype[jindx[l] + k];
 
@@ -1570,8 +1884,32 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
           continue;
       }
 
+      /* rotate prm_MLbu entries required for unstructured domain feature */
+      rotate_ml_helper_arrays_inner(ml_helpers);
+    }
+
+    /*
+     *  3rd pass: contributions of (k, l) being a stem within the multibranch
+     *  loop. These are independent for each k
+     */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) num_threads(num_threads) \
+  if (num_threads > 1) private(i, kl, tt, s5, s3, temp) reduction(+:ov_local) reduction(max:Qmax_local)
+#endif
+    for (k = 2; k < l - turn; k++) {
+      kl  = my_iindx[k] - l;
+      tt  = ptype[jindx[l] + k];
+
+      if (with_gquad) {
+        if ((!tt) && (G[kl] == 0.))
+          continue;
+      } else {
+        if (qb[kl] == 0.)
+          continue;
+      }
+
       if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
-        temp = prm_MLb;
+        temp = ml_helpers->prm_MLb_k[k];
 
         if (sn[k] == sn[k - 1]) {
           for (i = 1; i <= k - 2; i++)
@@ -1602,23 +1940,25 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
         probs[kl] += temp;
       }
 
-      if (probs[kl] > (*Qmax)) {
-        (*Qmax) = probs[kl];
-        if ((*Qmax) > max_real / 10.)
+      if (probs[kl] > Qmax_local) {
+        Qmax_local = probs[kl];
+        if (Qmax_local > max_real / 10.)
           vrna_message_warning("P close to overflow: %d %d %g %g\n",
                                k, l, probs[kl], qb[kl]);
       }
 
       if (probs[kl] >= max_real) {
-        (*ov)++;
+        ov_local++;
         probs[kl] = FLT_MAX;
       }
-
-      /* rotate prm_MLbu entries required for unstructured domain feature */
-      rotate_ml_helper_arrays_inner(ml_helpers);
     } /* end for (k=..) */
   }
 
+  if (Qmax_local > (*Qmax))
+    (*Qmax) = Qmax_local;
+
+  (*ov) += ov_local;
+
   rotate_ml_helper_arrays_outer(ml_helpers);
 }
 
@@ -1806,6 +2146,308 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
 }
 
 
+PRIVATE int
+sparse_bpp_supported(vrna_fold_compound_t *fc)
+{
+  vrna_md_t *md;
+
+  if ((!fc) ||
+      (!fc->exp_matrices) ||
+      (!fc->exp_matrices->q) ||
+      (!fc->exp_matrices->qb) ||
+      (!fc->exp_matrices->qm)) {
+    vrna_message_warning("vrna_pairing_probs_sparse: "
+                         "run vrna_pf() first!");
+    return 0;
+  }
+
+  md = &(fc->exp_params->model_details);
+
+  if (fc->band) {
+    vrna_message_warning("vrna_pairing_probs_sparse: "
+                         "Base pair probabilities require full DP matrices!");
+    return 0;
+  }
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (md->circ) ||
+      (md->gquad) ||
+      ((fc->domains_up) && (fc->domains_up->exp_energy_cb)) ||
+      ((fc->sc) && (fc->sc->bt))) {
+    vrna_message_warning("vrna_pairing_probs_sparse: "
+                         "Only available for single, linear sequences without "
+                         "G-Quadruplexes, unstructured domains, or auxiliary base pairs!");
+    return 0;
+  }
+
+  return 1;
+}
+
+
+PRIVATE INLINE void
+sparse_row_append(sparse_row  *row,
+                  int         j,
+                  FLT_OR_DBL  o)
+{
+  if (row->num == row->size) {
+    row->size = (row->size) ? 2 * row->size : 8;
+    row->j    = (int *)vrna_realloc(row->j, sizeof(int) * row->size);
+    row->o    = (FLT_OR_DBL *)vrna_realloc(row->o, sizeof(FLT_OR_DBL) * row->size);
+  }
+
+  row->j[row->num]    = j;
+  row->o[row->num++]  = o;
+}
+
+
+/*
+ *  Interior loop contributions to the outside values of column l, see
+ *  compute_bpp_internal(). The enclosing pairs (i, j) with j close to l
+ *  are found at the end of each row.
+ */
+PRIVATE void
+sparse_bpp_internal(vrna_fold_compound_t  *fc,
+                    int                   l,
+                    FLT_OR_DBL            *col,
+                    sparse_row            *rows)
+{
+  unsigned char     type, type_2;
+  char              *ptype;
+  short             *S1;
+  unsigned int      cnt;
+  int               i, j, k, n, kl, jij, u1, u2, last_j, *my_iindx, *jindx, *rtype,
+                    turn, *hc_up_int;
+  FLT_OR_DBL        tmp2, *qb, *scale;
+  vrna_exp_param_t  *pf_params;
+  vrna_hc_t         *hc;
+  vrna_sc_t         *sc;
+
+  n         = (int)fc->length;
+  ptype     = fc->ptype;
+  S1        = fc->sequence_encoding;
+  my_iindx  = fc->iindx;
+  jindx     = fc->jindx;
+  pf_params = fc->exp_params;
+  turn      = pf_params->model_details.min_loop_size;
+  rtype     = &(pf_params->model_details.rtype[0]);
+  hc        = fc->hc;
+  sc        = fc->sc;
+  hc_up_int = hc->up_int;
+  qb        = fc->exp_matrices->qb;
+  scale     = fc->exp_matrices->scale;
+
+  for (k = 1; k < l - turn; k++) {
+    kl = my_iindx[k] - l;
+
+    if (qb[kl] == 0.)
+      continue;
+
+    if (!(hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC))
+      continue;
+
+    type_2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
+
+    for (i = MAX2(1, k - MAXLOOP - 1); i <= k - 1; i++) {
+      u1 = k - i - 1;
+      if (hc_up_int[i + 1] < u1)
+        continue;
+
+      last_j = MIN2(l + MAXLOOP - k + i + 2, n);
+
+      for (cnt = rows[i].num; cnt > 0; cnt--) {
+        j = rows[i].j[cnt - 1];
+
+        if (j > last_j)
+          break;
+
+        u2 = j - l - 1;
+
+        if (hc_up_int[l + 1] < u2)
+          break;
+
+        if (!(hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP))
+          continue;
+
+        jij   = jindx[j] + i;
+        type  = vrna_get_ptype(jij, ptype);
+        tmp2  = rows[i].o[cnt - 1] *
+                scale[u1 + u2 + 2] *
+                exp_E_IntLoop(u1,
+                              u2,
+                              type,
+                              type_2,
+                              S1[i + 1],
+                              S1[j - 1],
+                              S1[k - 1],
+                              S1[l + 1],
+                              pf_params);
+
+        if (sc) {
+          if (sc->exp_energy_up)
+            tmp2 *= sc->exp_energy_up[i + 1][u1] *
+                    sc->exp_energy_up[l + 1][u2];
+
+          if (sc->exp_energy_bp)
+            tmp2 *= sc->exp_energy_bp[jij];
+
+          if (sc->exp_energy_stack) {
+            if ((i + 1 == k) && (j - 1 == l)) {
+              tmp2 *= sc->exp_energy_stack[i] *
+                      sc->exp_energy_stack[k] *
+                      sc->exp_energy_stack[l] *
+                      sc->exp_energy_stack[j];
+            }
+          }
+
+          if (sc->exp_f)
+            tmp2 *= sc->exp_f(i, j, k, l, VRNA_DECOMP_PAIR_IL, sc->data);
+        }
+
+        col[k] += tmp2;
+      }
+    }
+  }
+}
+
+
+/*
+ *  Multibranch loop contributions to the outside values of column l, see
+ *  compute_bpp_multibranch(). Only the 1st pass that collects the enclosing
+ *  pairs (i, j) with j > l differs from the dense recursion.
+ */
+PRIVATE void
+sparse_bpp_multibranch(vrna_fold_compound_t *fc,
+                       int                  l,
+                       FLT_OR_DBL           *col,
+                       sparse_row           *rows,
+                       helper_arrays        *ml_helpers)
+{
+  unsigned char     tt;
+  char              *ptype;
+  short             *S, *S1, s5, s3;
+  unsigned int      cnt;
+  int               i, j, k, n, kl, turn, *my_iindx, *jindx, *rtype;
+  FLT_OR_DBL        temp, ppp, prm_MLb, prmt, prmt1, *qb, *qm, *scale, *expMLbase,
+                    expMLclosing;
+  vrna_exp_param_t  *pf_params;
+  vrna_md_t         *md;
+  vrna_hc_t         *hc;
+  vrna_sc_t         *sc;
+
+  n             = (int)fc->length;
+  S             = fc->sequence_encoding2;
+  S1            = fc->sequence_encoding;
+  my_iindx      = fc->iindx;
+  jindx         = fc->jindx;
+  pf_params     = fc->exp_params;
+  md            = &(pf_params->model_details);
+  turn          = md->min_loop_size;
+  rtype         = &(md->rtype[0]);
+  ptype         = fc->ptype;
+  qb            = fc->exp_matrices->qb;
+  qm            = fc->exp_matrices->qm;
+  scale         = fc->exp_matrices->scale;
+  expMLbase     = fc->exp_matrices->expMLbase;
+  expMLclosing  = pf_params->expMLclosing;
+  hc            = fc->hc;
+  sc            = fc->sc;
+  prm_MLb       = 0.;
+
+  /* 1st pass: multibranch loops closed by (k - 1, j) with left-most stem (k, l) */
+  for (k = 2; k < l - turn; k++) {
+    i     = k - 1;
+    prmt  = prmt1 = 0.;
+
+    for (cnt = 0; cnt < rows[i].num; cnt++) {
+      j = rows[i].j[cnt];
+
+      if (j == l + 1) {
+        if (hc->mx[(l + 1) * n + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+          tt    = rtype[vrna_get_ptype(jindx[l + 1] + i, ptype)];
+          prmt1 = rows[i].o[cnt] *
+                  expMLclosing *
+                  exp_E_MLstem(tt, S1[l], S1[i + 1], pf_params);
+
+          if ((sc) && (sc->exp_energy_bp))
+            prmt1 *= sc->exp_energy_bp[jindx[l + 1] + i];
+        }
+      } else if (hc->mx[i * n + j] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
+        tt  = vrna_get_ptype_md(S[j], S[i], md);
+        ppp = rows[i].o[cnt] *
+              exp_E_MLstem(tt, S1[j - 1], S1[i + 1], pf_params) *
+              qm[my_iindx[l + 1] - (j - 1)];
+
+        if ((sc) && (sc->exp_energy_bp))
+          ppp *= sc->exp_energy_bp[jindx[j] + i];
+
+        prmt += ppp;
+      }
+    }
+
+    ml_helpers->prml[i] = prmt * expMLclosing;
+
+    /* l+1 is unpaired */
+    if (hc->up_ml[l + 1]) {
+      ppp = ml_helpers->prm_l1[i] * expMLbase[1];
+      if ((sc) && (sc->exp_energy_up))
+        ppp *= sc->exp_energy_up[l + 1][1];
+
+      ml_helpers->prm_l[i] = ppp + prmt1;
+    } else {
+      ml_helpers->prm_l[i] = prmt1;
+    }
+  }
+
+  /* 2nd pass: prefix sums over all enclosing pairs (i, j) with i < k */
+  for (k = 2; k < l - turn; k++) {
+    i = k - 1;
+
+    if (hc->up_ml[i]) {
+      ppp = prm_MLb * expMLbase[1];
+      if ((sc) && (sc->exp_energy_up))
+        ppp *= sc->exp_energy_up[i][1];
+
+      prm_MLb = ppp + ml_helpers->prml[i];
+    } else {
+      prm_MLb = ml_helpers->prml[i];
+    }
+
+    ml_helpers->prml[i]       = ml_helpers->prml[i] + ml_helpers->prm_l[i];
+    ml_helpers->prm_MLb_k[k]  = prm_MLb;
+  }
+
+  /* 3rd pass: (k, l) is a stem within the multibranch loop */
+  for (k = 2; k < l - turn; k++) {
+    kl = my_iindx[k] - l;
+
+    if (qb[kl] == 0.)
+      continue;
+
+    if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
+      temp = ml_helpers->prm_MLb_k[k];
+
+      for (i = 1; i <= k - 2; i++)
+        temp += ml_helpers->prml[i] *
+                qm[my_iindx[i + 1] - (k - 1)];
+
+      tt  = ptype[jindx[l] + k];
+      s5  = S1[k - 1];
+      s3  = (l < n) ? S1[l + 1] : -1;
+
+      if (tt == 0)
+        tt = 7;
+
+      col[k] += temp *
+                exp_E_MLstem(tt, s5, s3, pf_params) *
+                scale[2];
+    }
+  }
+
+  rotate_ml_helper_arrays_outer(ml_helpers);
+}
+
+
 PRIVATE void
 compute_gquad_prob_internal(vrna_fold_compound_t  *fc,
                             int                   l)
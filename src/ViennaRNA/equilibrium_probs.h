@@ -105,6 +105,28 @@ vrna_ensemble_defect(vrna_fold_compound_t *fc,
                      const char           *structure);
 
 
+/**
+ *  @brief  Compute the Ensemble Defect for a given target structure from a list of base pair probabilities
+ *
+ *  Same as vrna_ensemble_defect() but uses a list of base pair probabilities, e.g. as obtained from
+ *  vrna_plist_from_probs() or vrna_pairing_probs_sparse(), instead of the full probability matrix.
+ *  Pairs missing in @p pl are treated as having zero probability.
+ *
+ *  @ingroup  part_func_global
+ *
+ *  @see vrna_ensemble_defect(), vrna_pairing_probs_sparse()
+ *
+ *  @param  length      The length of the sequence
+ *  @param  pl          A list of base pair probabilities
+ *  @param  structure   A target structure in dot-bracket notation
+ *  @return             The ensemble defect with respect to the target structure, or -1. upon failure
+ */
+double
+vrna_ensemble_defect_from_plist(int         length,
+                                vrna_ep_t   *pl,
+                                const char  *structure);
+
+
 /**
  *  @brief  Compute a vector of positional entropies
  *
@@ -148,6 +170,68 @@ vrna_stack_prob(vrna_fold_compound_t  *vc,
                 double                cutoff);
 
 
+/**
+ *  @brief  Default pruning ratio for vrna_pairing_probs_sparse()
+ *
+ *  @ingroup  part_func_global
+ *
+ *  @see vrna_pairing_probs_sparse()
+ */
+#define VRNA_PROBS_SPARSE_PRUNE_DEFAULT   1e-4
+
+
+/**
+ *  @brief  Compute a sparse list of base pair probabilities above a threshold
+ *
+ *  This function computes base pair probabilities with the outside recursion
+ *  but, in contrast to vrna_pairing_probs(), never stores the full
+ *  @f$ n(n+1)/2 @f$ probability matrix. Instead, the outside recursion
+ *  proceeds column-wise and only retains the base pairs whose probability
+ *  is at least @p prune_ratio times @p cutoff. Thus, memory and runtime of
+ *  the outside recursion scale with the number of relevant base pairs.
+ *  The contributions of the discarded low-probability pairs to the pairs
+ *  they enclose are neglected, so the resulting probabilities approximate
+ *  the exact ones from below.
+ *
+ *  The approximation error grows with @p prune_ratio and @p cutoff. For
+ *  random sequences of length 1000 and the default ratio
+ *  #VRNA_PROBS_SPARSE_PRUNE_DEFAULT, we observed absolute errors of up to
+ *  @f$ 10^{-3} @f$ for a cutoff of @f$ 10^{-2} @f$, and of up to
+ *  @f$ 2 \cdot 10^{-5} @f$ for a cutoff of @f$ 10^{-4} @f$. Consequently,
+ *  base pairs with a probability just above @p cutoff may be missing from
+ *  the list. Lowering @p prune_ratio by two orders of magnitude reduces the
+ *  error roughly by a factor of 50, at the cost of retaining more base pairs.
+ *  Where pairs close to the threshold matter, use a smaller @p prune_ratio,
+ *  or query a slightly lower @p cutoff and filter the result.
+ *
+ *  The returned list is ordered by increasing @f$ i @f$ and @f$ j @f$ and
+ *  can be used directly with vrna_centroid_from_plist(), vrna_MEA_from_plist(),
+ *  vrna_ensemble_defect_from_plist(), and the dot plot functions.
+ *
+ *  @pre  The partition function must have been computed with full (non-banded)
+ *        DP matrices, i.e. vrna_pf() must be called beforehand. Since the
+ *        dense probability matrix is not required, vrna_md_t.compute_bpp
+ *        may be set to 0, in which case vrna_pf() does not allocate it.
+ *
+ *  @note   This function is only available for single, linear sequences
+ *          without G-Quadruplexes, unstructured domains, or soft constraints
+ *          that introduce auxiliary base pairs.
+ *
+ *  @ingroup  part_func_global
+ *
+ *  @see vrna_pairing_probs(), vrna_plist_from_probs()
+ *
+ *  @param  fc          The fold compound with a pre-computed partition function
+ *  @param  cutoff      Only base pairs with probability @f$ p \geq \textrm{cutoff} @f$ are reported
+ *  @param  prune_ratio Base pairs with probability below @f$ \textrm{prune\_ratio} \cdot \textrm{cutoff} @f$ are discarded from the outside recursion, @f$ 0 < \textrm{prune\_ratio} \leq 1 @f$ (see #VRNA_PROBS_SPARSE_PRUNE_DEFAULT)
+ *  @return             A list of base pair probabilities (terminated by an entry with @f$ i = j = 0 @f$), or @p NULL on failure
+ */
+vrna_ep_t *
+vrna_pairing_probs_sparse(vrna_fold_compound_t  *fc,
+                          double                cutoff,
+                          double                prune_ratio);
+
+
 /* End base pair related functions */
 /**@}*/
 
@@ -0,0 +1,214 @@
+/*
+ *  Fold batches of sequences with identical model settings
+ *
+ *  Each worker thread re-uses a single fold compound (and thus its energy
+ *  parameters and DP matrices) for all sequences it processes. The Boltzmann
+ *  factors are computed only once and copied to every worker.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/dp_matrices.h"
+#include "ViennaRNA/mfe.h"
+#include "ViennaRNA/part_func.h"
+#include "ViennaRNA/fold_batch.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE vrna_fold_compound_t *
+init_worker(const char        *sequence,
+            vrna_md_t         *md,
+            vrna_exp_param_t  *exp_params);
+
+
+PRIVATE void
+fold_sequence(vrna_fold_compound_t  *fc,
+              const char            *sequence,
+              vrna_md_t             *md,
+              unsigned int          options,
+              vrna_batch_result_t   *result);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_batch_result_t *
+vrna_fold_batch(const char    **sequences,
+                unsigned int  num_sequences,
+                vrna_md_t     *md_p,
+                unsigned int  options)
+{
+  int                 i, longest, num_threads;
+  size_t              l, max_length;
+  vrna_md_t           md;
+  vrna_exp_param_t    *exp_params;
+  vrna_batch_result_t *results;
+
+  if ((!sequences) || (num_sequences == 0))
+    return NULL;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* each sequence is processed by a single thread, and we only report the ensemble free energy */
+  num_threads     = md.num_threads;
+  md.num_threads  = 1;
+  md.compute_bpp  = 0;
+
+  /* the partition function requires the MFE for proper scaling */
+  options &= VRNA_OPTION_MFE | VRNA_OPTION_PF;
+  if ((options & VRNA_OPTION_PF) || (!options))
+    options |= VRNA_OPTION_MFE;
+
+  results = (vrna_batch_result_t *)vrna_alloc(sizeof(vrna_batch_result_t) * num_sequences);
+
+  /* the fold compounds of all workers are initialized with the longest sequence */
+  longest     = -1;
+  max_length  = 0;
+
+  for (i = 0; i < (int)num_sequences; i++) {
+    results[i].mfe        = (float)(INF / 100.);
+    results[i].ens_en     = (float)(INF / 100.);
+    results[i].structure  = NULL;
+
+    if (sequences[i]) {
+      l = strlen(sequences[i]);
+      if (l > max_length) {
+        max_length  = l;
+        longest     = i;
+      }
+    }
+  }
+
+  if (longest < 0)
+    return results;
+
+  /*
+   *  Use the same model details as the fold compounds of the workers, which
+   *  are initialized with the longest sequence. This way, the Boltzmann
+   *  factors computed here are accepted by vrna_pf() without re-computation
+   */
+  md.window_size = (int)max_length;
+  if ((md.max_bp_span <= 0) || (md.max_bp_span > md.window_size))
+    md.max_bp_span = md.window_size;
+
+  exp_params = (options & VRNA_OPTION_PF) ? vrna_exp_params(&md) : NULL;
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+
+  if (num_threads > (int)num_sequences)
+    num_threads = (int)num_sequences;
+
+  if (num_threads < 1)
+    num_threads = 1;
+
+#pragma omp parallel num_threads(num_threads) private(i)
+#endif
+  {
+    vrna_fold_compound_t *fc;
+
+    fc = init_worker(sequences[longest], &md, exp_params);
+
+    if (fc) {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+      for (i = 0; i < (int)num_sequences; i++)
+        fold_sequence(fc, sequences[i], &md, options, &(results[i]));
+
+      vrna_fold_compound_free(fc);
+    }
+  }
+
+  free(exp_params);
+
+  return results;
+}
+
+
+PUBLIC void
+vrna_fold_batch_results_free(vrna_batch_result_t  *results,
+                             unsigned int         num_sequences)
+{
+  unsigned int i;
+
+  if (results) {
+    for (i = 0; i < num_sequences; i++)
+      free(results[i].structure);
+
+    free(results);
+  }
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE vrna_fold_compound_t *
+init_worker(const char        *sequence,
+            vrna_md_t         *md,
+            vrna_exp_param_t  *exp_params)
+{
+  vrna_fold_compound_t *fc;
+
+  /* the Boltzmann factors are not computed here but copied from the shared set */
+  fc = vrna_fold_compound(sequence, md, VRNA_OPTION_MFE);
+
+  if ((fc) && (exp_params)) {
+    vrna_exp_params_subst(fc, exp_params);
+    vrna_mx_pf_add(fc, VRNA_MX_DEFAULT, VRNA_OPTION_PF);
+  }
+
+  return fc;
+}
+
+
+PRIVATE void
+fold_sequence(vrna_fold_compound_t  *fc,
+              const char            *sequence,
+              vrna_md_t             *md,
+              unsigned int          options,
+              vrna_batch_result_t   *result)
+{
+  char    *structure;
+  double  mfe;
+
+  if (!vrna_fold_compound_reset_sequence(fc, sequence, md))
+    return;
+
+  structure = (md->backtrack) ? (char *)vrna_alloc(sizeof(char) * (fc->length + 1)) : NULL;
+
+  mfe = (double)vrna_mfe(fc, structure);
+
+  result->mfe       = (float)mfe;
+  result->structure = structure;
+
+  if (options & VRNA_OPTION_PF) {
+    vrna_exp_params_rescale(fc, &mfe);
+    result->ens_en = vrna_pf(fc, NULL);
+  }
+}
@@ -0,0 +1,91 @@
+#ifndef VIENNA_RNA_PACKAGE_FOLD_BATCH_H
+#define VIENNA_RNA_PACKAGE_FOLD_BATCH_H
+
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/fold_compound.h>
+
+/**
+ *  @file     fold_batch.h
+ *  @ingroup  mfe_global, part_func_global
+ *  @brief    Fold large sets of (short) sequences with identical model settings
+ */
+
+/**
+ *  @addtogroup mfe_global
+ *  @{
+ */
+
+/**
+ *  @brief  Typename for the result of a single sequence of a batch, see #vrna_batch_result_s
+ */
+typedef struct vrna_batch_result_s vrna_batch_result_t;
+
+
+/**
+ *  @brief  The results for a single sequence processed by vrna_fold_batch()
+ */
+struct vrna_batch_result_s {
+  float mfe;        /**<  @brief  The minimum free energy in kcal/mol (#INF / 100. on failure) */
+  char  *structure; /**<  @brief  The MFE structure in dot-bracket notation (NULL without backtracking) */
+  float ens_en;     /**<  @brief  The ensemble free energy in kcal/mol (only with #VRNA_OPTION_PF) */
+};
+
+
+/**
+ *  @brief  Compute MFE and/or partition function for a batch of sequences
+ *
+ *  This function processes a (potentially large) set of sequences with the same model
+ *  details @p md_p. Instead of creating a new #vrna_fold_compound_t for each of the
+ *  sequences, each worker thread keeps a single #vrna_fold_compound_t that is re-used with
+ *  vrna_fold_compound_reset_sequence(). The energy parameters are therefore computed only
+ *  once per thread, the Boltzmann factors only once for the entire batch, and the DP matrices
+ *  are allocated only once, according to the length of the longest sequence in the batch.
+ *
+ *  The @p options specify the computations that are performed for each sequence:
+ *  * #VRNA_OPTION_MFE  - compute the MFE (and an MFE structure if backtracking is enabled)
+ *  * #VRNA_OPTION_PF   - compute the ensemble free energy. Here, the MFE is required to
+ *                        determine the scaling factor and is therefore always computed as well.
+ *                        Base pair probabilities are not computed.
+ *
+ *  The sequences are distributed over #vrna_md_t.num_threads threads (if RNAlib was compiled
+ *  with OpenMP support). The results are returned in input order and do not depend on
+ *  the number of threads.
+ *
+ *  @note Here, #vrna_md_t.num_threads of @p md_p is re-interpreted as the number of threads
+ *        that process the batch (0 = OpenMP default). Each sequence itself is processed by a
+ *        single thread, i.e. #vrna_md_t.num_threads is set to 1 for the actual computations.
+ *        Likewise, #vrna_md_t.compute_bpp is always set to 0.
+ *
+ *  @see  vrna_fold_batch_results_free(), vrna_fold_compound_reset_sequence(), vrna_mfe(), vrna_pf()
+ *
+ *  @param  sequences       The sequences to process (single or concatenated sequences seperated by '&')
+ *  @param  num_sequences   The number of sequences
+ *  @param  md_p            An optional set of model details (default model details if @p NULL)
+ *  @param  options         The computations to perform (#VRNA_OPTION_MFE and/or #VRNA_OPTION_PF)
+ *  @return                 An array of @p num_sequences results in input order (or @p NULL on error)
+ */
+vrna_batch_result_t *
+vrna_fold_batch(const char    **sequences,
+                unsigned int  num_sequences,
+                vrna_md_t     *md_p,
+                unsigned int  options);
+
+
+/**
+ *  @brief  Free memory occupied by the results of vrna_fold_batch()
+ *
+ *  @see  vrna_fold_batch()
+ *
+ *  @param  results         The results as returned by vrna_fold_batch()
+ *  @param  num_sequences   The number of sequences (results)
+ */
+void
+vrna_fold_batch_results_free(vrna_batch_result_t  *results,
+                             unsigned int         num_sequences);
+
+
+/**
+ * @}
+ */
+
+#endif
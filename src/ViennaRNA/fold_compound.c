@@ -100,6 +100,25 @@ PRIVATE INLINE void
 nullify(vrna_fold_compound_t *fc);
 
 
+PRIVATE void
+select_kernel(vrna_fold_compound_t  *fc,
+              unsigned int          options);
+
+
+PRIVATE void
+reset_params(vrna_fold_compound_t *fc,
+             vrna_md_t            *md_p);
+
+
+PRIVATE void
+remove_sequence_data(vrna_fold_compound_t *fc);
+
+
+PRIVATE void
+finalize_reset(vrna_fold_compound_t  *fc,
+               unsigned int          with_hc);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -108,60 +127,15 @@ nullify(vrna_fold_compound_t *fc);
 PUBLIC void
 vrna_fold_compound_free(vrna_fold_compound_t *fc)
 {
-  int s;
-
   if (fc) {
     /* first destroy common attributes */
     vrna_mx_mfe_free(fc);
     vrna_mx_pf_free(fc);
-    free(fc->iindx);
-    free(fc->jindx);
     free(fc->params);
     free(fc->exp_params);
 
-    vrna_hc_free(fc->hc);
-    vrna_ud_remove(fc);
-    vrna_sequence_remove_all(fc);
-
-    /* now distinguish the fc type */
-    switch (fc->type) {
-      case VRNA_FC_TYPE_SINGLE:
-        free(fc->sequence);
-        free(fc->sequence_encoding);
-        free(fc->sequence_encoding2);
-        free(fc->ptype);
-        free(fc->ptype_pf_compat);
-        vrna_sc_free(fc->sc);
-        break;
-      case VRNA_FC_TYPE_COMPARATIVE:
-        for (s = 0; s < fc->n_seq; s++) {
-          free(fc->sequences[s]);
-          free(fc->S[s]);
-          free(fc->S5[s]);
-          free(fc->S3[s]);
-          free(fc->Ss[s]);
-          free(fc->a2s[s]);
-        }
-        free(fc->sequences);
-        free(fc->cons_seq);
-        free(fc->S_cons);
-        free(fc->S);
-        free(fc->S5);
-        free(fc->S3);
-        free(fc->Ss);
-        free(fc->a2s);
-        free(fc->pscore);
-        free(fc->pscore_pf_compat);
-        if (fc->scs) {
-          for (s = 0; s < fc->n_seq; s++)
-            vrna_sc_free(fc->scs[s]);
-          free(fc->scs);
-        }
-
-        break;
-      default:                      /* do nothing */
-        break;
-    }
+    /* now remove everything that depends on the sequence(s) */
+    remove_sequence_data(fc);
 
     /* free Distance Class Partitioning stuff (should be NULL if not used) */
     free(fc->reference_pt1);
@@ -262,6 +236,158 @@ vrna_fold_compound(const char   *sequence,
 }
 
 
+PUBLIC int
+vrna_fold_compound_reset_sequence(vrna_fold_compound_t  *fc,
+                                  const char            *sequence,
+                                  vrna_md_t             *md_p)
+{
+  unsigned int  length, options, aux_options, with_hc;
+  vrna_md_t     md;
+
+  if ((!fc) || (!sequence) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->window_size != -1) ||
+      (fc->reference_pt1))
+    return 0;
+
+  /* sanity check */
+  length = strlen(sequence);
+  if (length == 0) {
+    vrna_message_warning("vrna_fold_compound_reset_sequence@fold_compound.c: "
+                         "sequence length must be greater 0");
+    return 0;
+  }
+
+  if (length > vrna_sequence_length_max(VRNA_OPTION_DEFAULT)) {
+    vrna_message_warning("vrna_fold_compound_reset_sequence@fold_compound.c: "
+                         "sequence length of %d exceeds addressable range",
+                         length);
+    return 0;
+  }
+
+  /* keep the same set of sequence dependent data as before */
+  options     = (fc->ptype) ? VRNA_OPTION_DEFAULT : VRNA_OPTION_EVAL_ONLY;
+  aux_options = (fc->ptype) ? WITH_PTYPE : 0L;
+  if (fc->ptype_pf_compat)
+    aux_options |= WITH_PTYPE_COMPAT;
+
+  with_hc = (fc->hc) ? 1 : 0;
+
+  /* remove everything that depends on the previous sequence */
+  remove_sequence_data(fc);
+
+  fc->length    = length;
+  fc->sequence  = strdup(sequence);
+
+  /* get a copy of the model details */
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  reset_params(fc, &md);
+
+  sanitize_bp_span(fc, options);
+
+  set_fold_compound(fc, options, aux_options);
+
+  finalize_reset(fc, with_hc);
+
+  return 1;
+}
+
+
+PUBLIC int
+vrna_fold_compound_reset_alignment(vrna_fold_compound_t *fc,
+                                   const char           **sequences,
+                                   vrna_md_t            *md_p)
+{
+  unsigned int  s, n_seq, length, options, aux_options, with_hc;
+  vrna_md_t     md;
+
+  if ((!fc) || (!sequences) || (!sequences[0]) ||
+      (fc->type != VRNA_FC_TYPE_COMPARATIVE) ||
+      (fc->window_size != -1))
+    return 0;
+
+  for (s = 0; sequences[s]; s++);  /* count the sequences */
+
+  n_seq = s;
+
+  /* sanity check */
+  length = strlen(sequences[0]);
+  if (length == 0) {
+    vrna_message_warning("vrna_fold_compound_reset_alignment@fold_compound.c: "
+                         "sequence length must be greater 0");
+    return 0;
+  }
+
+  if (length > vrna_sequence_length_max(VRNA_OPTION_DEFAULT)) {
+    vrna_message_warning("vrna_fold_compound_reset_alignment@fold_compound.c: "
+                         "sequence length of %d exceeds addressable range",
+                         length);
+    return 0;
+  }
+
+  for (s = 0; s < n_seq; s++)
+    if (strlen(sequences[s]) != length) {
+      vrna_message_warning("vrna_fold_compound_reset_alignment@fold_compound.c: "
+                           "uneqal sequence lengths in alignment");
+      return 0;
+    }
+
+  /* keep the same set of alignment dependent data as before */
+  options     = (fc->hc) ? VRNA_OPTION_DEFAULT : VRNA_OPTION_EVAL_ONLY;
+  aux_options = WITH_PTYPE;
+  if (fc->pscore_pf_compat)
+    aux_options |= WITH_PTYPE_COMPAT;
+
+  with_hc = (fc->hc) ? 1 : 0;
+
+  /* Boltzmann factors for alignments are scaled by the number of sequences */
+  if ((fc->exp_params) && (fc->n_seq != n_seq)) {
+    free(fc->exp_params);
+    fc->exp_params = NULL;
+  }
+
+  /* remove everything that depends on the previous alignment */
+  remove_sequence_data(fc);
+
+  fc->n_seq   = n_seq;
+  fc->length  = length;
+
+  /* get a copy of the model details */
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  reset_params(fc, &md);
+
+  sanitize_bp_span(fc, options);
+
+  vrna_msa_add(fc,
+               sequences,
+               NULL,
+               NULL,
+               NULL,
+               NULL,
+               VRNA_SEQUENCE_RNA);
+
+  fc->sequences = vrna_alloc(sizeof(char *) * (fc->n_seq + 1));
+  for (s = 0; sequences[s]; s++)
+    fc->sequences[s] = strdup(sequences[s]);
+
+  set_fold_compound(fc, options, aux_options);
+
+  make_pscores(fc);
+
+  finalize_reset(fc, with_hc);
+
+  return 1;
+}
+
+
 PUBLIC vrna_fold_compound_t *
 vrna_fold_compound_comparative(const char   **sequences,
                                vrna_md_t    *md_p,
@@ -535,14 +661,20 @@ vrna_fold_compound_prepare(vrna_fold_compound_t *fc,
     }
   }
 
+  /*  Add DP matrices, if not they are not present or do not fit current settings.
+   *  This may change the index layout (banded matrices), so constraints must be
+   *  prepared afterwards
+   */
+  vrna_mx_prepare(fc, options);
+
   /* prepare hard constraints */
   vrna_hc_prepare(fc, options);
 
   /* prepare soft constraints data structure, if required */
   vrna_sc_prepare(fc, options);
 
-  /* Add DP matrices, if not they are not present or do not fit current settings */
-  vrna_mx_prepare(fc, options);
+  /* select the DP kernels for the current settings */
+  select_kernel(fc, options);
 
   return ret;
 }
@@ -579,6 +711,198 @@ sanitize_bp_span(vrna_fold_compound_t *fc,
 }
 
 
+/*
+ *  Use one of the specialized MFE kernels whenever none of the features
+ *  they omit is in use. Everything else, including the partition function
+ *  and sliding window recursions, is handled by the generic kernels.
+ */
+PRIVATE void
+select_kernel(vrna_fold_compound_t *fc,
+              unsigned int         options)
+{
+  vrna_md_t *md;
+
+  fc->kernel = VRNA_KERNEL_GENERIC;
+
+  if ((!(options & VRNA_OPTION_MFE)) ||
+      (options & VRNA_OPTION_WINDOW) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands != 1) ||
+      (!fc->params) ||
+      (!fc->hc) ||
+      (fc->hc->type != VRNA_HC_DEFAULT) ||
+      (fc->hc->f) ||
+      (fc->sc) ||
+      (fc->domains_up) ||
+      (fc->aux_grammar))
+    return;
+
+  md = &(fc->params->model_details);
+
+  if (md->gquad)
+    return;
+
+  switch (md->dangles) {
+    case 0:
+      fc->kernel = VRNA_KERNEL_DEFAULT_D0;
+      break;
+
+    case 2:
+      fc->kernel = VRNA_KERNEL_DEFAULT_D2;
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+/*
+ *  Adopt the model details md_p for a new sequence. Energy parameters and
+ *  Boltzmann factors do not depend on the settings that are adjusted to the
+ *  sequence length and number of strands, i.e. window_size, max_bp_span,
+ *  and min_loop_size, so we keep them unless any other setting differs.
+ */
+PRIVATE void
+reset_params(vrna_fold_compound_t *fc,
+             vrna_md_t            *md_p)
+{
+  vrna_md_t md;
+
+  if (fc->params) {
+    md                = *md_p;
+    md.window_size    = fc->params->model_details.window_size;
+    md.max_bp_span    = fc->params->model_details.max_bp_span;
+    md.min_loop_size  = fc->params->model_details.min_loop_size;
+
+    if (memcmp(&md, &(fc->params->model_details), sizeof(vrna_md_t)) != 0) {
+      free(fc->params);
+      fc->params = NULL;
+    }
+  }
+
+  if (fc->exp_params) {
+    md                = *md_p;
+    md.window_size    = fc->exp_params->model_details.window_size;
+    md.max_bp_span    = fc->exp_params->model_details.max_bp_span;
+    md.min_loop_size  = fc->exp_params->model_details.min_loop_size;
+
+    if (memcmp(&md, &(fc->exp_params->model_details), sizeof(vrna_md_t)) != 0) {
+      free(fc->exp_params);
+      fc->exp_params = NULL;
+    }
+  }
+
+  if (fc->params)
+    (void)vrna_md_copy(&(fc->params->model_details), md_p);
+  else
+    fc->params = vrna_params(md_p);
+}
+
+
+PRIVATE void
+remove_sequence_data(vrna_fold_compound_t *fc)
+{
+  unsigned int s;
+
+  /* banded DP matrices are bound to the index layout we remove here */
+  if (fc->band) {
+    vrna_mx_mfe_free(fc);
+    vrna_mx_pf_free(fc);
+    fc->band = 0;
+  }
+
+  free(fc->iindx);
+  free(fc->jindx);
+  vrna_hc_free(fc->hc);
+  vrna_ud_remove(fc);
+  vrna_sequence_remove_all(fc);
+
+  fc->iindx = NULL;
+  fc->jindx = NULL;
+  fc->hc    = NULL;
+
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:
+      free(fc->sequence);
+      free(fc->sequence_encoding);
+      free(fc->sequence_encoding2);
+      free(fc->ptype);
+      free(fc->ptype_pf_compat);
+      vrna_sc_free(fc->sc);
+
+      fc->sequence            = NULL;
+      fc->sequence_encoding   = NULL;
+      fc->sequence_encoding2  = NULL;
+      fc->ptype               = NULL;
+      fc->ptype_pf_compat     = NULL;
+      fc->sc                  = NULL;
+      fc->cutpoint            = -1;
+      break;
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      for (s = 0; s < fc->n_seq; s++) {
+        free(fc->sequences[s]);
+        free(fc->S[s]);
+        free(fc->S5[s]);
+        free(fc->S3[s]);
+        free(fc->Ss[s]);
+        free(fc->a2s[s]);
+      }
+      free(fc->sequences);
+      free(fc->cons_seq);
+      free(fc->S_cons);
+      free(fc->S);
+      free(fc->S5);
+      free(fc->S3);
+      free(fc->Ss);
+      free(fc->a2s);
+      free(fc->pscore);
+      free(fc->pscore_pf_compat);
+      if (fc->scs) {
+        for (s = 0; s < fc->n_seq; s++)
+          vrna_sc_free(fc->scs[s]);
+        free(fc->scs);
+      }
+
+      fc->sequences         = NULL;
+      fc->cons_seq          = NULL;
+      fc->S_cons            = NULL;
+      fc->S                 = NULL;
+      fc->S5                = NULL;
+      fc->S3                = NULL;
+      fc->Ss                = NULL;
+      fc->a2s               = NULL;
+      fc->pscore            = NULL;
+      fc->pscore_pf_compat  = NULL;
+      fc->scs               = NULL;
+      break;
+
+    default:                      /* do nothing */
+      break;
+  }
+}
+
+
+PRIVATE void
+finalize_reset(vrna_fold_compound_t  *fc,
+               unsigned int          with_hc)
+{
+  if (with_hc)
+    vrna_hc_init(fc);
+
+  /* keep sufficiently large DP matrices and reset the part we actually need */
+  (void)vrna_mx_recycle(fc);
+
+  /* adopt the final model details and guess a new scaling factor for the Boltzmann factors */
+  if (fc->exp_params) {
+    (void)vrna_md_copy(&(fc->exp_params->model_details), &(fc->params->model_details));
+    fc->exp_params->pf_scale = -1.;
+    vrna_exp_params_rescale(fc, NULL);
+  }
+}
+
+
 PRIVATE void
 add_params(vrna_fold_compound_t *fc,
            vrna_md_t            *md_p,
@@ -892,6 +1216,8 @@ nullify(vrna_fold_compound_t *fc)
     fc->exp_params    = NULL;
     fc->iindx         = NULL;
     fc->jindx         = NULL;
+    fc->band          = 0;
+    fc->kernel        = VRNA_KERNEL_GENERIC;
 
     fc->stat_cb       = NULL;
     fc->auxdata       = NULL;
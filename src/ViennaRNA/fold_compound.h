@@ -117,6 +117,21 @@ typedef enum {
 } vrna_fc_type_e;
 
 
+/**
+ *  @brief  An enumerator that is used to specify the set of DP kernels used to fill the matrices of a #vrna_fold_compound_t
+ *
+ *  The kernel is selected by vrna_fold_compound_prepare(). Specialized kernels are compiled for
+ *  particular model settings and omit all runtime checks for features that are not in use.
+ *
+ *  @see  #vrna_fold_compound_t.kernel, vrna_fold_compound_prepare()
+ */
+typedef enum {
+  VRNA_KERNEL_GENERIC,    /**< Generic recursions that handle all model settings and constraints */
+  VRNA_KERNEL_DEFAULT_D0, /**< Single sequence, no soft constraints, constraint callbacks, or G-quadruplexes, dangles = 0 */
+  VRNA_KERNEL_DEFAULT_D2  /**< Single sequence, no soft constraints, constraint callbacks, or G-quadruplexes, dangles = 2 */
+} vrna_kernel_e;
+
+
 /**
  *  @brief  The most basic data structure required by many functions throughout the RNAlib
  *
@@ -165,6 +180,20 @@ struct vrna_fc_s {
 
   int               *iindx;         /**<  @brief  DP matrix accessor  */
   int               *jindx;         /**<  @brief  DP matrix accessor  */
+  unsigned int      band;           /**<  @brief  Band width of the DP matrices (0 for full triangular storage)
+                                     *
+                                     *    If non-zero, the accessors #vrna_fold_compound_t.iindx and
+                                     *    #vrna_fold_compound_t.jindx, as well as the #vrna_fold_compound_t.ptype
+                                     *    array, address only entries @f$(i,j)@f$ with @f$j - i \leq band@f$.
+                                     *    @warning Do not edit this attribute, it will be set by
+                                     *      vrna_mx_prepare()
+                                     *    @see vrna_idx_col_wise_banded(), vrna_idx_row_wise_banded()
+                                     */
+
+  vrna_kernel_e     kernel;         /**<  @brief  The DP kernels selected for the current settings
+                                     * @warning Do not edit this attribute, it will be set by
+                                     *      vrna_fold_compound_prepare()
+                                     */
 
   /**
    *  @}
@@ -425,6 +454,65 @@ vrna_fold_compound(const char   *sequence,
                    unsigned int options);
 
 
+/**
+ *  @brief  Replace the sequence of a #vrna_fold_compound_t for single sequences
+ *
+ *  This function re-uses a #vrna_fold_compound_t obtained from vrna_fold_compound() for
+ *  another (single or hybridizing) sequence. All data that depends on the sequence, i.e. the
+ *  sequence encodings, pair type arrays, DP matrix accessors, and hard constraints, is
+ *  re-computed, while soft constraints and unstructured domains are removed. The energy
+ *  parameters (and Boltzmann factors) are kept unless the model details @p md_p differ from
+ *  the current ones in more than the sequence length dependent settings. DP matrices are
+ *  kept as well, if they are large enough for the new sequence. In that case, only the part
+ *  of the matrices that is required for the new sequence is reset, see vrna_mx_recycle().
+ *  Otherwise, they are released and re-allocated by subsequent predictions.
+ *
+ *  Hence, when a large number of sequences is processed, this function is much cheaper than
+ *  creating a new #vrna_fold_compound_t for each of them. Recursion status callbacks, auxiliary
+ *  data, and auxiliary grammar extensions are retained.
+ *
+ *  @note This function only supports fold compounds of type #VRNA_FC_TYPE_SINGLE that were
+ *        created for global structure prediction, i.e. without #VRNA_OPTION_WINDOW
+ *
+ *  @see  vrna_fold_compound(), vrna_fold_compound_prepare(), vrna_fold_compound_reset_alignment(),
+ *        vrna_mx_recycle()
+ *
+ *  @param    fc          The fold compound to re-use
+ *  @param    sequence    A single sequence, or two concatenated sequences seperated by an '&' character
+ *  @param    md_p        An optional set of model details (default model details if @p NULL)
+ *  @return               1 on success, 0 otherwise
+ */
+int
+vrna_fold_compound_reset_sequence(vrna_fold_compound_t  *fc,
+                                  const char            *sequence,
+                                  vrna_md_t             *md_p);
+
+
+/**
+ *  @brief  Replace the alignment of a #vrna_fold_compound_t for sequence alignments
+ *
+ *  This is the comparative counterpart of vrna_fold_compound_reset_sequence(). It re-uses
+ *  a #vrna_fold_compound_t obtained from vrna_fold_compound_comparative() for another
+ *  alignment with potentially different length and number of sequences. All alignment
+ *  dependent data, including the covariance scores, is re-computed, soft constraints are
+ *  removed, whereas energy parameters and sufficiently large DP matrices are kept.
+ *
+ *  @note This function only supports fold compounds of type #VRNA_FC_TYPE_COMPARATIVE that were
+ *        created for global structure prediction, i.e. without #VRNA_OPTION_WINDOW
+ *
+ *  @see  vrna_fold_compound_comparative(), vrna_fold_compound_reset_sequence(), vrna_mx_recycle()
+ *
+ *  @param    fc          The fold compound to re-use
+ *  @param    sequences   A sequence alignment including 'gap' characters
+ *  @param    md_p        An optional set of model details (default model details if @p NULL)
+ *  @return               1 on success, 0 otherwise
+ */
+int
+vrna_fold_compound_reset_alignment(vrna_fold_compound_t *fc,
+                                   const char           **sequences,
+                                   vrna_md_t            *md_p);
+
+
 /**
  *  @brief  Retrieve a #vrna_fold_compound_t data structure for sequence alignments
  *
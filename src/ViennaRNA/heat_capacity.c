@@ -0,0 +1,456 @@
+/*
+ *  Heat capacity of RNA molecules
+ *
+ *  The specific heat C(T) = -T d^2/dT^2 G(T) is obtained from the ensemble
+ *  free energies of a set of temperatures that are distributed over
+ *  several threads, each of which re-uses a single fold compound.
+ *  Fold compounds with soft constraints, unstructured domains, or grammar
+ *  extensions are processed in place by a single thread instead.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/mfe.h"
+#include "ViennaRNA/part_func.h"
+#include "ViennaRNA/heat_capacity.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MAX_MPOINTS       100
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+struct heat_capacity_list {
+  unsigned int          num;
+  vrna_heat_capacity_t  *hc;
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE int
+ensemble_energies(vrna_fold_compound_t  *fc,
+                  vrna_md_t             *md_p,
+                  double                *temperatures,
+                  double                *G,
+                  unsigned int          num);
+
+
+PRIVATE int
+ensemble_energies_in_place(vrna_fold_compound_t *fc,
+                           double               *temperatures,
+                           double               *G,
+                           unsigned int         num);
+
+
+PRIVATE int
+energies_range(vrna_fold_compound_t *fc,
+               double               *temperatures,
+               double               *G,
+               unsigned int         first,
+               unsigned int         last);
+
+
+PRIVATE void
+copy_hard_constraints(vrna_fold_compound_t  *dest,
+                      vrna_fold_compound_t  *src);
+
+
+PRIVATE double
+ddiff(double        *f,
+      double        h,
+      unsigned int  m);
+
+
+PRIVATE void
+store_heat_capacity(float temperature,
+                    float heat_capacity,
+                    void  *data);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_heat_capacity_t *
+vrna_heat_capacity(vrna_fold_compound_t *fc,
+                   float                T_min,
+                   float                T_max,
+                   float                T_increment,
+                   unsigned int         mpoints,
+                   unsigned int         options)
+{
+  unsigned int              num;
+  struct heat_capacity_list list;
+
+  list.num  = 0;
+  list.hc   = NULL;
+
+  num = vrna_heat_capacity_cb(fc,
+                              T_min,
+                              T_max,
+                              T_increment,
+                              mpoints,
+                              options,
+                              &store_heat_capacity,
+                              (void *)&list);
+
+  if (num == 0) {
+    free(list.hc);
+    return NULL;
+  }
+
+  list.hc = (vrna_heat_capacity_t *)vrna_realloc(list.hc,
+                                                 sizeof(vrna_heat_capacity_t) * (list.num + 1));
+  list.hc[list.num].temperature   = T_min - 1.;
+  list.hc[list.num].heat_capacity = 0.;
+
+  return list.hc;
+}
+
+
+PUBLIC unsigned int
+vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
+                      float                       T_min,
+                      float                       T_max,
+                      float                       T_increment,
+                      unsigned int                mpoints,
+                      unsigned int                options,
+                      vrna_callback_heat_capacity *cb,
+                      void                        *data)
+{
+  unsigned int  i, k, num, num_points, m;
+  int           ret;
+  double        h, *temperatures, *G, T;
+  vrna_md_t     md;
+
+  if ((!fc) || (!cb))
+    return 0;
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) && (fc->type != VRNA_FC_TYPE_COMPARATIVE))
+    return 0;
+
+  if ((T_increment <= 0.) || (T_max < T_min)) {
+    vrna_message_warning("vrna_heat_capacity@heat_capacity.c: "
+                         "Invalid temperature range [%g, %g] with increment %g",
+                         T_min,
+                         T_max,
+                         T_increment);
+    return 0;
+  }
+
+  if (fc->scs)
+    vrna_message_warning("vrna_heat_capacity@heat_capacity.c: "
+                         "Soft constraints of alignments are not applied");
+
+  /* number of output temperatures, tolerating rounding errors of the range */
+  num = (unsigned int)floor((T_max - T_min) / T_increment + 1e-4) + 1;
+
+  /* the workers neither require base pair probabilities nor structures */
+  md              = fc->params->model_details;
+  md.compute_bpp  = 0;
+  md.backtrack    = 0;
+
+  /* the free energies of the (num + 2m) temperatures T_min + (k - m) * h are required */
+  m             = MIN2(MAX2(mpoints, 1), MAX_MPOINTS);
+  h             = (double)T_increment;
+  num_points    = num + 2 * m;
+  temperatures  = (double *)vrna_alloc(sizeof(double) * num_points);
+  G             = (double *)vrna_alloc(sizeof(double) * num_points);
+
+  for (i = 0; i < num; i++)
+    temperatures[i + m] = (double)T_min + i * h;
+
+  for (k = 0; k < m; k++) {
+    temperatures[k]           = (double)T_min - (m - k) * h;
+    temperatures[num + m + k] = temperatures[num + m - 1] + (k + 1) * h;
+  }
+
+  if ((fc->sc) || (fc->domains_up) || (fc->aux_grammar))
+    ret = ensemble_energies_in_place(fc, temperatures, G, num_points);
+  else
+    ret = ensemble_energies(fc, &md, temperatures, G, num_points);
+
+  if (ret) {
+    for (i = 0; i < num; i++) {
+      T = temperatures[i + m];
+      cb((float)T, (float)(-ddiff(G + i, h, m) * (T + K0)), data);
+    }
+  } else {
+    num = 0;
+  }
+
+  free(temperatures);
+  free(G);
+
+  return num;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+
+/*
+ *  Compute the ensemble free energies for a list of ascending temperatures.
+ *  Each thread processes a consecutive range of temperatures, such that the
+ *  scaling factor can be extrapolated from the previous free energy.
+ */
+PRIVATE int
+ensemble_energies(vrna_fold_compound_t  *fc,
+                  vrna_md_t             *md_p,
+                  double                *temperatures,
+                  double                *G,
+                  unsigned int          num)
+{
+  int       num_threads, ret;
+  vrna_md_t md;
+
+  md              = *md_p;
+  num_threads     = md.num_threads;
+  md.num_threads  = 1;
+  ret             = 1;
+
+  /* make sure all hard constraints of fc are applied before they are copied */
+  if (fc->hc)
+    vrna_hc_prepare(fc, VRNA_OPTION_PF);
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+
+  if (num_threads > (int)num)
+    num_threads = (int)num;
+
+  if (num_threads < 1)
+    num_threads = 1;
+
+#pragma omp parallel num_threads(num_threads) firstprivate(md) reduction(&&:ret)
+#endif
+  {
+    unsigned int          first, last;
+    int                   thread_id, threads;
+    vrna_fold_compound_t  *worker;
+
+#ifdef _OPENMP
+    thread_id = omp_get_thread_num();
+    threads   = omp_get_num_threads();
+#else
+    thread_id = 0;
+    threads   = 1;
+#endif
+
+    first = (unsigned int)(((unsigned long)num * thread_id) / threads);
+    last  = (unsigned int)(((unsigned long)num * (thread_id + 1)) / threads);
+
+    if (first < last) {
+      md.temperature = temperatures[first];
+
+      worker = (fc->type == VRNA_FC_TYPE_SINGLE) ?
+               vrna_fold_compound(fc->sequence,
+                                  &md,
+                                  VRNA_OPTION_MFE | VRNA_OPTION_PF) :
+               vrna_fold_compound_comparative((const char **)fc->sequences,
+                                              &md,
+                                              VRNA_OPTION_MFE | VRNA_OPTION_PF);
+
+      if (worker) {
+        copy_hard_constraints(worker, fc);
+
+        ret = energies_range(worker, temperatures, G, first, last);
+
+        vrna_fold_compound_free(worker);
+      } else {
+        ret = 0;
+      }
+    }
+  }
+
+  return ret;
+}
+
+
+/*
+ *  Compute the ensemble free energies with fc itself, since soft constraints,
+ *  unstructured domains, and grammar extensions can not be transferred to
+ *  another fold compound. The energy parameters, the scaling factor, and the
+ *  model details changed here are restored afterwards
+ */
+PRIVATE int
+ensemble_energies_in_place(vrna_fold_compound_t *fc,
+                           double               *temperatures,
+                           double               *G,
+                           unsigned int         num)
+{
+  int     ret, compute_bpp;
+  double  temperature, pf_scale;
+
+  temperature = fc->params->model_details.temperature;
+  compute_bpp = fc->params->model_details.compute_bpp;
+  pf_scale    = (fc->exp_params) ? fc->exp_params->pf_scale : -1.;
+
+  if (!fc->hc)
+    vrna_hc_init(fc);
+
+  /* the partition functions do not require base pair probabilities */
+  fc->params->model_details.compute_bpp = 0;
+
+  if (fc->exp_params)
+    fc->exp_params->model_details.compute_bpp = 0;
+
+  ret = vrna_params_set_temperature(fc, temperatures[0]) &&
+        energies_range(fc, temperatures, G, 0, num);
+
+  fc->params->model_details.compute_bpp = compute_bpp;
+
+  if (fc->exp_params) {
+    fc->exp_params->model_details.compute_bpp = compute_bpp;
+    fc->exp_params->pf_scale                  = pf_scale;
+  }
+
+  (void)vrna_params_set_temperature(fc, temperature);
+
+  /* restore the previous scaling factor or estimate a new one if there was none */
+  if (fc->exp_params)
+    vrna_exp_params_rescale(fc, NULL);
+
+  return ret;
+}
+
+
+/*
+ *  Compute the ensemble free energies of the temperatures first to last - 1,
+ *  where fc already uses the energy parameters of the first temperature
+ */
+PRIVATE int
+energies_range(vrna_fold_compound_t *fc,
+               double               *temperatures,
+               double               *G,
+               unsigned int         first,
+               unsigned int         last)
+{
+  unsigned int  k, n;
+  double        en;
+
+  n = fc->length;
+
+  /* the scaling factor of the first temperature is derived from the MFE */
+  en = (double)vrna_mfe(fc, NULL);
+
+  for (k = first; k < last; k++) {
+    if (k > first) {
+      /* re-compute the energy parameters in place and extrapolate the scaling factor */
+      vrna_params_set_temperature(fc, temperatures[k]);
+      en = G[k - 1] + (temperatures[k] - temperatures[k - 1]) * 0.00727 * n;
+    }
+
+    vrna_exp_params_rescale(fc, &en);
+
+    if (vrna_pf(fc, NULL) >= (float)(INF / 100.))
+      return 0;
+
+    G[k] = vrna_pf_ensemble_energy(fc);
+  }
+
+  return 1;
+}
+
+
+/*
+ *  Transfer the hard constraints of src to dest, both of which must
+ *  be constructed from the same sequence(s). Hard constraint callbacks
+ *  and their data are shared, so they must be thread-safe
+ */
+PRIVATE void
+copy_hard_constraints(vrna_fold_compound_t  *dest,
+                      vrna_fold_compound_t  *src)
+{
+  unsigned int  n;
+  vrna_hc_t     *hc_src, *hc_dest;
+
+  hc_src  = src->hc;
+  hc_dest = dest->hc;
+
+  if ((!hc_src) || (!hc_dest) ||
+      (hc_src->type != VRNA_HC_DEFAULT) ||
+      (hc_dest->type != VRNA_HC_DEFAULT))
+    return;
+
+  n = src->length;
+
+  vrna_hc_prepare(dest, VRNA_OPTION_PF);
+
+  memcpy(hc_dest->matrix, hc_src->matrix, sizeof(unsigned char) * ((n * (n + 1)) / 2 + 2));
+  memcpy(hc_dest->mx, hc_src->mx, sizeof(unsigned char) * ((n + 1) * (n + 1)));
+  memcpy(hc_dest->up_ext, hc_src->up_ext, sizeof(int) * (n + 2));
+  memcpy(hc_dest->up_hp, hc_src->up_hp, sizeof(int) * (n + 2));
+  memcpy(hc_dest->up_int, hc_src->up_int, sizeof(int) * (n + 2));
+  memcpy(hc_dest->up_ml, hc_src->up_ml, sizeof(int) * (n + 2));
+
+  hc_dest->f    = hc_src->f;
+  hc_dest->data = hc_src->data;
+}
+
+
+/*
+ *  Second derivative at the center of 2m + 1 equidistant points obtained
+ *  from a least-squares fit of a parabola
+ */
+PRIVATE double
+ddiff(double        *f,
+      double        h,
+      unsigned int  m)
+{
+  unsigned int  i;
+  double        fp, A, B;
+
+  A = (double)(m * (m + 1) * (2 * m + 1)) / 3.;                                    /* 2*sum(x^2) */
+  B = (double)(m * (m + 1) * (2 * m + 1)) * (double)(3 * m * m + 3 * m - 1) / 15.; /* 2*sum(x^4) */
+
+  fp = 0.;
+  for (i = 0; i < 2 * m + 1; i++)
+    fp += f[i] * (A - (double)(2 * m + 1) * ((double)i - m) * ((double)i - m));
+
+  fp /= ((A * A - B * (double)(2 * m + 1)) * h * h / 2.);
+
+  return fp;
+}
+
+
+PRIVATE void
+store_heat_capacity(float temperature,
+                    float heat_capacity,
+                    void  *data)
+{
+  struct heat_capacity_list *list;
+
+  list = (struct heat_capacity_list *)data;
+
+  list->hc = (vrna_heat_capacity_t *)vrna_realloc(list->hc,
+                                                  sizeof(vrna_heat_capacity_t) * (list->num + 1));
+  list->hc[list->num].temperature   = temperature;
+  list->hc[list->num].heat_capacity = heat_capacity;
+  list->num++;
+}
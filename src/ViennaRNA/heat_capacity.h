@@ -0,0 +1,128 @@
+#ifndef VIENNA_RNA_PACKAGE_HEAT_CAPACITY_H
+#define VIENNA_RNA_PACKAGE_HEAT_CAPACITY_H
+
+#include <ViennaRNA/fold_compound.h>
+
+/**
+ *  @file     heat_capacity.h
+ *  @ingroup  part_func_global
+ *  @brief    Compute heat capacity for an RNA
+ */
+
+/**
+ *  @addtogroup part_func_global
+ *  @{
+ */
+
+/**
+ *  @brief  Option flag for vrna_heat_capacity() to fit parabolas to @f$2m+1@f$ equidistant
+ *          temperature points (default)
+ */
+#define VRNA_HEAT_CAPACITY_FIT          0U
+
+/**
+ *  @brief  Typename for the heat capacity of a single temperature, see #vrna_heat_capacity_s
+ */
+typedef struct vrna_heat_capacity_s vrna_heat_capacity_t;
+
+
+/**
+ *  @brief  The heat capacity at a particular temperature as reported by vrna_heat_capacity()
+ */
+struct vrna_heat_capacity_s {
+  float temperature;    /**<  @brief  The temperature in deg C */
+  float heat_capacity;  /**<  @brief  The specific heat at this temperature in kcal/(mol * K) */
+};
+
+
+/**
+ *  @brief  Callback to receive the heat capacity of a single temperature from vrna_heat_capacity_cb()
+ *
+ *  @param  temperature   The temperature in deg C
+ *  @param  heat_capacity The specific heat at this temperature in kcal/(mol * K)
+ *  @param  data          The auxiliary data passed to vrna_heat_capacity_cb()
+ */
+typedef void (vrna_callback_heat_capacity)(float  temperature,
+                                           float  heat_capacity,
+                                           void   *data);
+
+
+/**
+ *  @brief  Compute the specific heat of an RNA for a range of temperatures
+ *
+ *  The specific heat @f$C(T) = -T \frac{\partial^2 G}{\partial T^2}@f$ is obtained by numerical
+ *  differentiation of the ensemble free energy @f$G(T)@f$ for each temperature
+ *  @f$T = T_{min} + k \cdot T_{increment} \le T_{max}@f$. To this end, a parabola is fitted
+ *  to the free energies of @f$2m+1@f$ temperatures with distance @p T_increment centered at
+ *  @f$T@f$, where @f$m@f$ is given by @p mpoints. Increasing @p mpoints produces a smoother
+ *  curve. This requires the partition function of @f$2m@f$ temperatures beyond the range
+ *  @f$[T_{min}, T_{max}]@f$.
+ *
+ *  The partition functions of all temperatures are distributed over #vrna_md_t.num_threads
+ *  threads (if RNAlib was compiled with OpenMP support), each of which processes a consecutive
+ *  range of temperatures. Each thread uses a single #vrna_fold_compound_t with the model
+ *  details and hard constraints of @p fc, where energy parameters and Boltzmann factors are
+ *  re-computed in place for each temperature using vrna_params_set_temperature().
+ *
+ *  If @p fc carries soft constraints, unstructured domains, or grammar extensions, which
+ *  can not be transferred to other fold compounds, all temperatures are processed by @p fc
+ *  itself in a single thread instead. Its energy parameters are restored afterwards.
+ *
+ *  @note Soft constraints of alignments are not applied.
+ *
+ *  @see vrna_heat_capacity_cb(), vrna_params_set_temperature(), vrna_pf_ensemble_energy()
+ *
+ *  @param  fc            The fold compound data structure
+ *  @param  T_min         The lowest temperature in deg C
+ *  @param  T_max         The highest temperature in deg C
+ *  @param  T_increment   The temperature increment in deg C
+ *  @param  mpoints       The number of interpolation points on each side of a temperature
+ *                        (only for #VRNA_HEAT_CAPACITY_FIT, 1 to 100)
+ *  @param  options       Currently only #VRNA_HEAT_CAPACITY_FIT
+ *  @return               A list of heat capacities ordered by temperature and terminated by
+ *                        an entry with a temperature below @p T_min, or NULL on error
+ */
+vrna_heat_capacity_t *
+vrna_heat_capacity(vrna_fold_compound_t *fc,
+                   float                T_min,
+                   float                T_max,
+                   float                T_increment,
+                   unsigned int         mpoints,
+                   unsigned int         options);
+
+
+/**
+ *  @brief  Compute the specific heat of an RNA for a range of temperatures (callback variant)
+ *
+ *  Similar to vrna_heat_capacity(), but the heat capacity of each temperature is passed to the
+ *  callback @p cb in ascending order of the temperatures instead of being collected in a list.
+ *
+ *  @see vrna_heat_capacity()
+ *
+ *  @param  fc            The fold compound data structure
+ *  @param  T_min         The lowest temperature in deg C
+ *  @param  T_max         The highest temperature in deg C
+ *  @param  T_increment   The temperature increment in deg C
+ *  @param  mpoints       The number of interpolation points on each side of a temperature
+ *                        (only for #VRNA_HEAT_CAPACITY_FIT, 1 to 100)
+ *  @param  options       Currently only #VRNA_HEAT_CAPACITY_FIT
+ *  @param  cb            The callback that receives the heat capacities
+ *  @param  data          Auxiliary data passed through to the callback @p cb
+ *  @return               The number of temperatures processed (0 on error)
+ */
+unsigned int
+vrna_heat_capacity_cb(vrna_fold_compound_t        *fc,
+                      float                       T_min,
+                      float                       T_max,
+                      float                       T_increment,
+                      unsigned int                mpoints,
+                      unsigned int                options,
+                      vrna_callback_heat_capacity *cb,
+                      void                        *data);
+
+
+/**
+ * @}
+ */
+
+#endif
@@ -50,6 +50,12 @@ read_multiple_input_lines(char **string, FILE *file, unsigned int option);
 PRIVATE void
 elim_trailing_ws(char *string);
 
+PRIVATE int
+skip_line(FILE *file);
+
+PRIVATE int
+is_record_end(int c);
+
 /*
 #################################
 # BEGIN OF FUNCTION DEFINITIONS #
@@ -455,6 +461,149 @@ vrna_file_fasta_read_record( char **header,
   return (return_type);
 }
 
+PUBLIC unsigned int
+vrna_file_fasta_read_header(char  **header,
+                            FILE  *file)
+{
+  int           c;
+  unsigned int  l, size;
+  char          *line;
+  FILE          *in = (file) ? file : stdin;
+
+  *header = NULL;
+
+  while ((c = getc(in)) != EOF) {
+    switch (c) {
+      case '>':   /* fasta header */
+        size  = 128;
+        l     = 0;
+        line  = (char *)vrna_alloc(sizeof(char) * size);
+
+        do {
+          if (l + 1 == size) {
+            size  *= 2;
+            line  = (char *)vrna_realloc(line, sizeof(char) * size);
+          }
+
+          line[l++] = (char)c;
+        } while (((c = getc(in)) != EOF) && (c != '\n'));
+
+        line[l] = '\0';
+
+        /* leave the line break to mark the start of the sequence for vrna_file_fasta_read_block() */
+        if (c == '\n')
+          ungetc(c, in);
+
+        elim_trailing_ws(line);
+        *header = line;
+        return VRNA_INPUT_FASTA_HEADER;
+
+      case '@':   /* user abort */
+        (void)skip_line(in);
+        return VRNA_INPUT_QUIT;
+
+      case '\n': case '\r':
+        break;
+
+      case '#': case '%': case ';': case '/': case '*': case ' ': case '\t':
+      case '<': case '.': case '|': case '(': case ')': case '[': case ']':
+      case '{': case '}': case ',': case '+':
+        /* comments, structures, and constraints */
+        if (skip_line(in) == EOF)
+          return VRNA_INPUT_ERROR;
+
+        break;
+
+      default:    /* sequence without header */
+        ungetc(c, in);
+        return VRNA_INPUT_SEQUENCE;
+    }
+  }
+
+  return VRNA_INPUT_ERROR;
+}
+
+
+PUBLIC unsigned int
+vrna_file_fasta_read_block(char         *buffer,
+                           unsigned int size,
+                           void         *file)
+{
+  int           c, line_start, block_start;
+  unsigned int  n;
+  FILE          *in = (file) ? (FILE *)file : stdin;
+
+  n = 0;
+
+  /*
+   *  Blocks start at a line break, in the middle of a sequence line,
+   *  or at the character that terminated the previous block
+   */
+  line_start  = 0;
+  block_start = 1;
+
+  while ((n < size) && ((c = getc(in)) != EOF)) {
+    if ((c == '\n') || (c == '\r')) {
+      line_start = 1;
+      continue;
+    }
+
+    if ((line_start || block_start) && (is_record_end(c))) {
+      /* next record, user abort, or structure/constraint line */
+      ungetc(c, in);
+      break;
+    }
+
+    if (line_start) {
+      switch (c) {
+        case '#': case '%': case ';': case '/': case '*': case ' ':
+          /* comment lines within the sequence */
+          (void)skip_line(in);
+          continue;
+
+        default:
+          break;
+      }
+    }
+
+    line_start  = 0;
+    block_start = 0;
+
+    if (!isspace(c))
+      buffer[n++] = (char)c;
+  }
+
+  return n;
+}
+
+
+/* characters that terminate a sequence when found at the beginning of a line */
+PRIVATE int
+is_record_end(int c)
+{
+  switch (c) {
+    case '>': case '@':
+    case '<': case '.': case '|': case '(': case ')': case '[': case ']':
+    case '{': case '}': case ',': case '+':
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+
+/* consume the remainder of the current line */
+PRIVATE int
+skip_line(FILE *file)
+{
+  int c;
+
+  while (((c = getc(file)) != EOF) && (c != '\n'));
+
+  return c;
+}
+
 PUBLIC char *
 vrna_extract_record_rest_structure( const char **lines,
                                     unsigned int length,
@@ -198,6 +198,51 @@ vrna_file_fasta_read_record(char          **header,
                             unsigned int  options);
 
 
+/**
+ *  @brief  Read the header of the next (fasta) data set from a file or stdin
+ *
+ *  This function is the entry point to read (very long) sequences in blocks rather than
+ *  at once. Empty lines, comments, and structure or constraint lines are skipped until
+ *  either a fasta header or the first line of a sequence is found. The sequence itself
+ *  is then obtained through subsequent calls to vrna_file_fasta_read_block().
+ *
+ *  @note Do not mix calls to this function with vrna_file_fasta_read_record() on the same
+ *        file handle, since the latter buffers lines that belong to the next data set!
+ *
+ *  @see  vrna_file_fasta_read_block(), vrna_mfe_window_source_cb(), vrna_probs_window_source()
+ *
+ *  @param  header    A pointer which will be set such that it points to the header (or NULL if the data set has none)
+ *  @param  file      A file handle to read from (if NULL, this function reads from stdin)
+ *  @return           #VRNA_INPUT_FASTA_HEADER or #VRNA_INPUT_SEQUENCE if a data set follows,
+ *                    #VRNA_INPUT_QUIT or #VRNA_INPUT_ERROR otherwise
+ */
+unsigned int
+vrna_file_fasta_read_header(char  **header,
+                            FILE  *file);
+
+
+/**
+ *  @brief  Read the next block of a sequence from a file or stdin
+ *
+ *  Reads at most @p size nucleotides of the current data set into @p buffer, skipping any
+ *  line breaks and white spaces. The sequence ends with the next fasta header, a line
+ *  starting with a structure or constraint character, a user abort (a line starting with
+ *  '@'), or the end of the file. This function satisfies the #vrna_sequence_source_callback
+ *  interface, where @p file is the file handle to read from (or NULL for stdin).
+ *
+ *  @see  vrna_file_fasta_read_header()
+ *
+ *  @param  buffer    The memory the nucleotides are written to (not '\0' terminated)
+ *  @param  size      The maximum number of nucleotides to read
+ *  @param  file      The file handle (@p FILE *) to read from (if NULL, this function reads from stdin)
+ *  @return           The number of nucleotides written to @p buffer, or 0 if the sequence is complete
+ */
+unsigned int
+vrna_file_fasta_read_block(char         *buffer,
+                           unsigned int size,
+                           void         *file);
+
+
 /** @brief Extract a dot-bracket structure string from (multiline)character array
  *
  * This function extracts a dot-bracket structure string from the 'rest' array as
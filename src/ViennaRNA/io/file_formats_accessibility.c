@@ -0,0 +1,539 @@
+/*
+ *  file_formats_accessibility.c
+ *
+ *  Read and write binary accessibility profiles as produced by the
+ *  sliding window unpaired probability computations
+ *
+ *  ViennaRNA package
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+# include <sys/types.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define WITH_MMAP 1
+#endif
+
+#include "ViennaRNA/params/constants.h"
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/part_func_window.h"
+#include "ViennaRNA/io/file_formats_accessibility.h"
+
+/*
+ #################################
+ # PRIVATE MACROS                #
+ #################################
+ */
+
+/*
+ *  Header layout (all values in native byte order):
+ *
+ *   0  char     magic[8]
+ *   8  uint32   byte order mark
+ *  12  uint32   format version
+ *  16  uint32   value type
+ *  20  uint32   ulength, i.e. number of values per position
+ *  24  uint64   sequence length, i.e. number of positions
+ *  32  uint64   offset of the first record
+ *  40  double   kT in kcal/mol
+ *  48  double   scale of quantized values in kcal/mol
+ *  56  reserved
+ */
+#define HEADER_SIZE     64
+#define BYTE_ORDER_MARK 0x01020304U
+#define UINT16_SCALE    0.01
+#define UINT16_NA       UINT16_MAX
+#define UINT16_MAXVAL   (UINT16_MAX - 1)
+
+/*
+ #################################
+ # GLOBAL VARIABLES              #
+ #################################
+ */
+
+/*
+ #################################
+ # PRIVATE VARIABLES             #
+ #################################
+ */
+
+struct vrna_accessibility_file_s {
+  FILE          *fp;
+  unsigned int  type;
+  unsigned int  ulength;
+  unsigned int  n;          /* number of positions written so far */
+  double        kT;
+  size_t        value_size;
+  void          *record;    /* buffer for a single record */
+  int           failed;
+};
+
+struct vrna_accessibility_s {
+  unsigned int        type;
+  unsigned int        ulength;
+  unsigned int        length;
+  double              kT;
+  double              scale;
+  const unsigned char *data;
+  void                *buffer;
+  size_t              buffer_size;
+  int                 mapped;
+};
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+
+PRIVATE void
+write_header(vrna_accessibility_file_t *file);
+
+
+PRIVATE void
+fill_record(vrna_accessibility_file_t *file,
+            const FLT_OR_DBL          *pr,
+            unsigned int              pr_size);
+
+
+PRIVATE void *
+load_file(const char  *filename,
+          size_t      *size,
+          int         *mapped);
+
+
+PRIVATE void
+unload_file(void    *buffer,
+            size_t  size,
+            int     mapped);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_accessibility_file_t *
+vrna_file_accessibility_open(const char   *filename,
+                             unsigned int ulength,
+                             double       kT,
+                             unsigned int options)
+{
+  FILE                      *fp;
+  vrna_accessibility_file_t *file;
+
+  if ((!filename) || (ulength == 0))
+    return NULL;
+
+  if ((options != VRNA_ACCESSIBILITY_FLOAT32) &&
+      (options != VRNA_ACCESSIBILITY_UINT16)) {
+    vrna_message_warning("vrna_file_accessibility_open: "
+                         "Unknown value type for accessibility profile");
+    return NULL;
+  }
+
+  fp = fopen(filename, "wb");
+  if (!fp) {
+    vrna_message_warning("vrna_file_accessibility_open: "
+                         "Could not open file \"%s\" for writing",
+                         filename);
+    return NULL;
+  }
+
+  file              = (vrna_accessibility_file_t *)vrna_alloc(sizeof(vrna_accessibility_file_t));
+  file->fp          = fp;
+  file->type        = options;
+  file->ulength     = ulength;
+  file->n           = 0;
+  file->kT          = kT;
+  file->value_size  = (options == VRNA_ACCESSIBILITY_FLOAT32) ? sizeof(float) : sizeof(uint16_t);
+  file->record      = vrna_alloc(file->value_size * ulength);
+  file->failed      = 0;
+
+  /* write a preliminary header, the sequence length is updated upon closing */
+  write_header(file);
+
+  return file;
+}
+
+
+PUBLIC int
+vrna_file_accessibility_add(vrna_accessibility_file_t *file,
+                            unsigned int              i,
+                            const FLT_OR_DBL          *pr,
+                            unsigned int              pr_size)
+{
+  if ((!file) || (i <= file->n))
+    return 0;
+
+  /* mark skipped positions as unavailable */
+  while (file->n + 1 < i) {
+    fill_record(file, NULL, 0);
+    if (fwrite(file->record, file->value_size, file->ulength, file->fp) != file->ulength)
+      file->failed = 1;
+
+    file->n++;
+  }
+
+  fill_record(file, pr, MIN2(pr_size, file->ulength));
+  if (fwrite(file->record, file->value_size, file->ulength, file->fp) != file->ulength)
+    file->failed = 1;
+
+  file->n++;
+
+  return !file->failed;
+}
+
+
+PUBLIC void
+vrna_file_accessibility_callback(FLT_OR_DBL   *pr,
+                                 int          pr_size,
+                                 int          i,
+                                 int          max,
+                                 unsigned int type,
+                                 void         *data)
+{
+  if ((type & VRNA_PROBS_WINDOW_UP) &&
+      ((type & VRNA_ANY_LOOP) == VRNA_ANY_LOOP) &&
+      (i > 0))
+    (void)vrna_file_accessibility_add((vrna_accessibility_file_t *)data,
+                                      (unsigned int)i,
+                                      pr,
+                                      (unsigned int)MAX2(pr_size, 0));
+}
+
+
+PUBLIC int
+vrna_file_accessibility_close(vrna_accessibility_file_t *file)
+{
+  int ret;
+
+  if (!file)
+    return 0;
+
+  if (fseek(file->fp, 0, SEEK_SET) == 0)
+    write_header(file);
+  else
+    file->failed = 1;
+
+  if (fclose(file->fp))
+    file->failed = 1;
+
+  ret = !file->failed;
+
+  free(file->record);
+  free(file);
+
+  return ret;
+}
+
+
+PUBLIC vrna_accessibility_t *
+vrna_accessibility_read(const char *filename)
+{
+  unsigned char         *buffer;
+  int                   mapped;
+  size_t                size;
+  uint32_t              bom, version, type, ulength;
+  uint64_t              length, offset;
+  double                kT, scale;
+  vrna_accessibility_t  *acc;
+
+  if (!filename)
+    return NULL;
+
+  buffer = (unsigned char *)load_file(filename, &size, &mapped);
+  if (!buffer)
+    return NULL;
+
+  if ((size < HEADER_SIZE) ||
+      (memcmp(buffer, VRNA_ACCESSIBILITY_MAGIC, sizeof(VRNA_ACCESSIBILITY_MAGIC)))) {
+    unload_file(buffer, size, mapped);
+    return NULL;
+  }
+
+  memcpy(&bom, buffer + 8, sizeof(uint32_t));
+  memcpy(&version, buffer + 12, sizeof(uint32_t));
+  memcpy(&type, buffer + 16, sizeof(uint32_t));
+  memcpy(&ulength, buffer + 20, sizeof(uint32_t));
+  memcpy(&length, buffer + 24, sizeof(uint64_t));
+  memcpy(&offset, buffer + 32, sizeof(uint64_t));
+  memcpy(&kT, buffer + 40, sizeof(double));
+  memcpy(&scale, buffer + 48, sizeof(double));
+
+  if (bom != BYTE_ORDER_MARK) {
+    vrna_message_warning("vrna_accessibility_read: "
+                         "Accessibility profile \"%s\" was written on a machine with different byte order",
+                         filename);
+  } else if (version > VRNA_ACCESSIBILITY_VERSION) {
+    vrna_message_warning("vrna_accessibility_read: "
+                         "Unsupported version %u of accessibility profile \"%s\"",
+                         version,
+                         filename);
+  } else if (((type != VRNA_ACCESSIBILITY_FLOAT32) && (type != VRNA_ACCESSIBILITY_UINT16)) ||
+             (ulength == 0) ||
+             (length > UINT_MAX) ||
+             (offset < HEADER_SIZE) ||
+             (offset > size) ||
+             ((size - offset) / ulength / ((type == VRNA_ACCESSIBILITY_FLOAT32) ? sizeof(float) : sizeof(uint16_t)) < length)) {
+    vrna_message_warning("vrna_accessibility_read: "
+                         "Accessibility profile \"%s\" is corrupt",
+                         filename);
+  } else {
+    acc               = (vrna_accessibility_t *)vrna_alloc(sizeof(vrna_accessibility_t));
+    acc->type         = type;
+    acc->ulength      = ulength;
+    acc->length       = (unsigned int)length;
+    acc->kT           = kT;
+    acc->scale        = scale;
+    acc->data         = buffer + offset;
+    acc->buffer       = buffer;
+    acc->buffer_size  = size;
+    acc->mapped       = mapped;
+
+    return acc;
+  }
+
+  unload_file(buffer, size, mapped);
+
+  return NULL;
+}
+
+
+PUBLIC void
+vrna_accessibility_free(vrna_accessibility_t *acc)
+{
+  if (acc) {
+    unload_file(acc->buffer, acc->buffer_size, acc->mapped);
+    free(acc);
+  }
+}
+
+
+PUBLIC unsigned int
+vrna_accessibility_length(const vrna_accessibility_t *acc)
+{
+  return (acc) ? acc->length : 0;
+}
+
+
+PUBLIC unsigned int
+vrna_accessibility_ulength(const vrna_accessibility_t *acc)
+{
+  return (acc) ? acc->ulength : 0;
+}
+
+
+PUBLIC double
+vrna_accessibility_probability(const vrna_accessibility_t *acc,
+                               unsigned int               i,
+                               unsigned int               u)
+{
+  size_t    idx;
+  float     p;
+  uint16_t  e;
+
+  if ((!acc) || (i == 0) || (i > acc->length) || (u == 0) || (u > acc->ulength))
+    return (double)NAN;
+
+  idx = (size_t)(i - 1) * acc->ulength + (u - 1);
+
+  if (acc->type == VRNA_ACCESSIBILITY_FLOAT32) {
+    memcpy(&p, acc->data + idx * sizeof(float), sizeof(float));
+    return (double)p;
+  }
+
+  memcpy(&e, acc->data + idx * sizeof(uint16_t), sizeof(uint16_t));
+  if (e == UINT16_NA)
+    return (double)NAN;
+
+  return exp(-(e * acc->scale) / acc->kT);
+}
+
+
+PUBLIC int
+vrna_accessibility_energy(const vrna_accessibility_t  *acc,
+                          unsigned int                i,
+                          unsigned int                u)
+{
+  size_t    idx;
+  float     p;
+  uint16_t  e;
+
+  if ((!acc) || (i == 0) || (i > acc->length) || (u == 0) || (u > acc->ulength))
+    return INF;
+
+  idx = (size_t)(i - 1) * acc->ulength + (u - 1);
+
+  if (acc->type == VRNA_ACCESSIBILITY_FLOAT32) {
+    memcpy(&p, acc->data + idx * sizeof(float), sizeof(float));
+    if ((isnan(p)) || (p <= 0.))
+      return INF;
+
+    return (int)rint(100 * (-log((double)p) * acc->kT));
+  }
+
+  memcpy(&e, acc->data + idx * sizeof(uint16_t), sizeof(uint16_t));
+  if (e == UINT16_NA)
+    return INF;
+
+  return (int)rint(100 * e * acc->scale);
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE void
+write_header(vrna_accessibility_file_t *file)
+{
+  unsigned char header[HEADER_SIZE];
+  uint32_t      bom, version, type, ulength;
+  uint64_t      length, offset;
+  double        scale;
+
+  bom     = BYTE_ORDER_MARK;
+  version = VRNA_ACCESSIBILITY_VERSION;
+  type    = file->type;
+  ulength = file->ulength;
+  length  = file->n;
+  offset  = HEADER_SIZE;
+  scale   = (file->type == VRNA_ACCESSIBILITY_UINT16) ? UINT16_SCALE : 1.;
+
+  memset(header, 0, sizeof(header));
+  memcpy(header, VRNA_ACCESSIBILITY_MAGIC, sizeof(VRNA_ACCESSIBILITY_MAGIC));
+  memcpy(header + 8, &bom, sizeof(uint32_t));
+  memcpy(header + 12, &version, sizeof(uint32_t));
+  memcpy(header + 16, &type, sizeof(uint32_t));
+  memcpy(header + 20, &ulength, sizeof(uint32_t));
+  memcpy(header + 24, &length, sizeof(uint64_t));
+  memcpy(header + 32, &offset, sizeof(uint64_t));
+  memcpy(header + 40, &(file->kT), sizeof(double));
+  memcpy(header + 48, &scale, sizeof(double));
+
+  if (fwrite(header, sizeof(unsigned char), HEADER_SIZE, file->fp) != HEADER_SIZE)
+    file->failed = 1;
+}
+
+
+PRIVATE void
+fill_record(vrna_accessibility_file_t *file,
+            const FLT_OR_DBL          *pr,
+            unsigned int              pr_size)
+{
+  unsigned int  u;
+  double        e;
+  float         *fl;
+  uint16_t      *ui;
+
+  if (file->type == VRNA_ACCESSIBILITY_FLOAT32) {
+    fl = (float *)file->record;
+    for (u = 1; u <= pr_size; u++)
+      fl[u - 1] = (float)pr[u];
+    for (; u <= file->ulength; u++)
+      fl[u - 1] = (float)NAN;
+  } else {
+    ui = (uint16_t *)file->record;
+    for (u = 1; u <= pr_size; u++) {
+      if ((isnan(pr[u])) || (pr[u] <= 0.)) {
+        ui[u - 1] = UINT16_NA;
+      } else {
+        e         = rint(-log(pr[u]) * file->kT / UINT16_SCALE);
+        ui[u - 1] = (e < 0.) ? 0 : ((e > UINT16_MAXVAL) ? UINT16_MAXVAL : (uint16_t)e);
+      }
+    }
+    for (; u <= file->ulength; u++)
+      ui[u - 1] = UINT16_NA;
+  }
+}
+
+
+PRIVATE void *
+load_file(const char  *filename,
+          size_t      *size,
+          int         *mapped)
+{
+  FILE        *fp;
+  void        *buffer;
+  long        s;
+#ifdef WITH_MMAP
+  int         fd;
+  struct stat st;
+#endif
+
+  *size   = 0;
+  *mapped = 0;
+
+#ifdef WITH_MMAP
+  fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  if ((fstat(fd, &st) == 0) && (st.st_size > 0)) {
+    buffer = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (buffer != MAP_FAILED) {
+      close(fd);
+      *size   = (size_t)st.st_size;
+      *mapped = 1;
+      return buffer;
+    }
+  }
+
+  close(fd);
+#endif
+
+  /* fall back to reading the entire file into memory */
+  fp = fopen(filename, "rb");
+  if (!fp)
+    return NULL;
+
+  buffer = NULL;
+
+  if ((fseek(fp, 0, SEEK_END) == 0) &&
+      ((s = ftell(fp)) > 0) &&
+      ((unsigned long)s <= UINT_MAX) &&
+      (fseek(fp, 0, SEEK_SET) == 0)) {
+    buffer = vrna_alloc((unsigned int)s);
+    if (fread(buffer, sizeof(unsigned char), (size_t)s, fp) != (size_t)s) {
+      free(buffer);
+      buffer = NULL;
+    } else {
+      *size = (size_t)s;
+    }
+  }
+
+  fclose(fp);
+
+  return buffer;
+}
+
+
+PRIVATE void
+unload_file(void    *buffer,
+            size_t  size,
+            int     mapped)
+{
+#ifdef WITH_MMAP
+  if (mapped) {
+    munmap(buffer, size);
+    return;
+  }
+
+#endif
+  free(buffer);
+}
@@ -0,0 +1,216 @@
+#ifndef VIENNA_RNA_PACKAGE_FILE_FORMATS_ACCESSIBILITY_H
+#define VIENNA_RNA_PACKAGE_FILE_FORMATS_ACCESSIBILITY_H
+
+/**
+ *  @file     ViennaRNA/io/file_formats_accessibility.h
+ *  @ingroup  file_utils, file_formats
+ *  @brief    Read and write binary accessibility profiles
+ */
+
+/**
+ *  @addtogroup  file_formats
+ *  @{
+ */
+
+#include <ViennaRNA/datastructures/basic.h>
+
+/**
+ *  @brief  Magic number at the start of each binary accessibility profile
+ */
+#define VRNA_ACCESSIBILITY_MAGIC      "VRNAACC"
+
+/**
+ *  @brief  The binary accessibility profile format version written by this library
+ */
+#define VRNA_ACCESSIBILITY_VERSION    1U
+
+/**
+ *  @brief  Option flag to store unpaired probabilities as 32-bit floating point numbers
+ *
+ *  @see  vrna_file_accessibility_open()
+ */
+#define VRNA_ACCESSIBILITY_FLOAT32    1U
+
+/**
+ *  @brief  Option flag to store opening energies as quantized 16-bit unsigned integers
+ *
+ *  Values are given in units of 0.01 kcal/mol, i.e. in the same resolution as used by
+ *  RNAplex. Opening energies above 655.34 kcal/mol are stored as 655.34 kcal/mol.
+ *
+ *  @see  vrna_file_accessibility_open()
+ */
+#define VRNA_ACCESSIBILITY_UINT16     2U
+
+/**
+ *  @brief  A binary accessibility profile that is opened for writing
+ *
+ *  @see  vrna_file_accessibility_open(), vrna_file_accessibility_add(),
+ *        vrna_file_accessibility_close()
+ */
+typedef struct vrna_accessibility_file_s vrna_accessibility_file_t;
+
+/**
+ *  @brief  A binary accessibility profile that is opened for (random access) reading
+ *
+ *  @see  vrna_accessibility_read(), vrna_accessibility_energy(),
+ *        vrna_accessibility_probability(), vrna_accessibility_free()
+ */
+typedef struct vrna_accessibility_s vrna_accessibility_t;
+
+
+/**
+ *  @brief  Create a binary accessibility profile
+ *
+ *  The profile stores, for each position @f$ i @f$ of a sequence and each length
+ *  @f$ 1 \leq u \leq @f$ @p ulength, the probability that the stretch
+ *  @f$ [i - u + 1, i] @f$ is unpaired, i.e. the data that vrna_probs_window()
+ *  reports for #VRNA_PROBS_WINDOW_UP. The file starts with a fixed size, versioned
+ *  header of 64 bytes followed by one record of @p ulength values per position.
+ *  Since all records have the same size, the header serves as index, and the data
+ *  for any position can be accessed in constant time.
+ *
+ *  Depending on @p options, values are either stored as unpaired probabilities
+ *  (#VRNA_ACCESSIBILITY_FLOAT32), or as quantized opening energies
+ *  (#VRNA_ACCESSIBILITY_UINT16). The latter halves the file size compared to the
+ *  former.
+ *
+ *  @see  vrna_file_accessibility_add(), vrna_file_accessibility_callback(),
+ *        vrna_file_accessibility_close(), vrna_accessibility_read()
+ *
+ *  @param  filename  The name of the file to create
+ *  @param  ulength   The maximum length of unpaired stretches stored for each position
+ *  @param  kT        The thermodynamic temperature in kcal/mol used to convert probabilities into energies
+ *  @param  options   The data type of the values, either #VRNA_ACCESSIBILITY_FLOAT32 or #VRNA_ACCESSIBILITY_UINT16
+ *  @return           The profile opened for writing, or NULL on any error
+ */
+vrna_accessibility_file_t *
+vrna_file_accessibility_open(const char   *filename,
+                             unsigned int ulength,
+                             double       kT,
+                             unsigned int options);
+
+
+/**
+ *  @brief  Add the unpaired probabilities for a position to a binary accessibility profile
+ *
+ *  Positions must be added in ascending order. Positions that are skipped will be
+ *  marked as unavailable, as will be any length larger than @p pr_size.
+ *
+ *  @see  vrna_file_accessibility_open(), vrna_file_accessibility_callback()
+ *
+ *  @param  file      The profile opened for writing
+ *  @param  i         The (3') position the probabilities belong to (1-based)
+ *  @param  pr        The probabilities that stretches of length @f$ u @f$ ending at @p i are unpaired (1-based)
+ *  @param  pr_size   The number of probabilities in @p pr
+ *  @return           Non-zero on success, 0 otherwise
+ */
+int
+vrna_file_accessibility_add(vrna_accessibility_file_t *file,
+                            unsigned int              i,
+                            const FLT_OR_DBL          *pr,
+                            unsigned int              pr_size);
+
+
+/**
+ *  @brief  Sliding window probability callback that writes a binary accessibility profile
+ *
+ *  This function may be passed to vrna_probs_window() or vrna_probs_window_source()
+ *  together with a profile opened by vrna_file_accessibility_open() as @p data, such
+ *  that the unpaired probabilities are written on-the-fly while they are computed.
+ *  Any data other than unpaired probabilities for all loop contexts is ignored.
+ *
+ *  @see  vrna_file_accessibility_open(), vrna_probs_window(), #vrna_probs_window_callback
+ */
+void
+vrna_file_accessibility_callback(FLT_OR_DBL   *pr,
+                                 int          pr_size,
+                                 int          i,
+                                 int          max,
+                                 unsigned int type,
+                                 void         *data);
+
+
+/**
+ *  @brief  Finish and close a binary accessibility profile
+ *
+ *  This function updates the header of the profile and releases all memory
+ *  occupied by @p file.
+ *
+ *  @param  file      The profile opened for writing
+ *  @return           Non-zero on success, 0 if any write operation failed
+ */
+int
+vrna_file_accessibility_close(vrna_accessibility_file_t *file);
+
+
+/**
+ *  @brief  Open a binary accessibility profile for reading
+ *
+ *  If possible, the file is memory mapped such that only those parts that are
+ *  actually accessed need to be loaded. Otherwise, the entire file is read into
+ *  memory.
+ *
+ *  @see  vrna_file_accessibility_open(), vrna_accessibility_energy(),
+ *        vrna_accessibility_probability(), vrna_accessibility_free()
+ *
+ *  @param  filename  The name of the profile
+ *  @return           The profile, or NULL if the file is not a (supported) binary accessibility profile
+ */
+vrna_accessibility_t *
+vrna_accessibility_read(const char *filename);
+
+
+/**
+ *  @brief  Release a binary accessibility profile that was opened for reading
+ */
+void
+vrna_accessibility_free(vrna_accessibility_t *acc);
+
+
+/**
+ *  @brief  Get the sequence length of a binary accessibility profile
+ */
+unsigned int
+vrna_accessibility_length(const vrna_accessibility_t *acc);
+
+
+/**
+ *  @brief  Get the maximum length of unpaired stretches stored in a binary accessibility profile
+ */
+unsigned int
+vrna_accessibility_ulength(const vrna_accessibility_t *acc);
+
+
+/**
+ *  @brief  Get the probability that a stretch is unpaired from a binary accessibility profile
+ *
+ *  @param  acc   The profile
+ *  @param  i     The 3' position of the stretch (1-based)
+ *  @param  u     The length of the stretch
+ *  @return       The probability that @f$ [i - u + 1, i] @f$ is unpaired, or NaN if not available
+ */
+double
+vrna_accessibility_probability(const vrna_accessibility_t *acc,
+                               unsigned int               i,
+                               unsigned int               u);
+
+
+/**
+ *  @brief  Get the opening energy of a stretch from a binary accessibility profile
+ *
+ *  @param  acc   The profile
+ *  @param  i     The 3' position of the stretch (1-based)
+ *  @param  u     The length of the stretch
+ *  @return       The free energy in dcal/mol required to open @f$ [i - u + 1, i] @f$, or #INF if not available
+ */
+int
+vrna_accessibility_energy(const vrna_accessibility_t  *acc,
+                          unsigned int                i,
+                          unsigned int                u);
+
+
+/**
+ * @}
+ */
+
+#endif
@@ -144,6 +144,24 @@ struct vrna_mx_pf_aux_el_s *
 vrna_exp_E_ext_fast_init(vrna_fold_compound_t *fc);
 
 
+/**
+ *  @brief  Prepare auxiliary helper arrays that keep the exterior loop
+ *          contributions of all columns
+ *
+ *  Same as vrna_exp_E_ext_fast_init() but, instead of the two arrays of the
+ *  current and previous column @f$j@f$ and @f$j - 1@f$, all columns are
+ *  kept in a triangular matrix. Thus, subsegments @f$[i,j]@f$ may be
+ *  decomposed in any order of increasing span, e.g. concurrently along
+ *  anti-diagonals, and vrna_exp_E_ext_fast_rotate() becomes a no-op.
+ *  Unstructured domains and sliding-window compounds are not supported and
+ *  result in a @p NULL return value.
+ *
+ *  @see vrna_exp_E_ext_fast_init(), vrna_exp_E_ext_fast_free()
+ */
+struct vrna_mx_pf_aux_el_s *
+vrna_exp_E_ext_fast_init_columns(vrna_fold_compound_t *fc);
+
+
 void
 vrna_exp_E_ext_fast_rotate(struct vrna_mx_pf_aux_el_s *aux_mx);
 
@@ -152,6 +170,23 @@ void
 vrna_exp_E_ext_fast_free(struct vrna_mx_pf_aux_el_s *aux_mx);
 
 
+/**
+ *  @brief  Re-scale the contents of the auxiliary helper arrays for fast exterior loop computations
+ *
+ *  Multiplies each entry that corresponds to a segment of length @f$l@f$ by
+ *  @p factors[@f$l@f$]. This allows for changing the scaling factor of the
+ *  Boltzmann weights in the middle of the recursions, where @p j denotes the
+ *  last column that has been processed so far.
+ *
+ *  @see vrna_exp_E_ext_fast_init(), vrna_exp_E_ext_fast_init_columns()
+ */
+void
+vrna_exp_E_ext_fast_rescale(vrna_fold_compound_t        *fc,
+                            int                         j,
+                            const FLT_OR_DBL            *factors,
+                            struct vrna_mx_pf_aux_el_s  *aux_mx);
+
+
 FLT_OR_DBL
 vrna_exp_E_ext_fast(vrna_fold_compound_t        *fc,
                     int                         i,
@@ -165,6 +200,40 @@ vrna_exp_E_ext_fast_update(vrna_fold_compound_t       *fc,
                            struct vrna_mx_pf_aux_el_s *aux_mx);
 
 
+/**
+ *  @brief  Compute the partition functions of all 5' prefixes of the sequence
+ *
+ *  Fills the linear array #vrna_mx_pf_t.q1k with the partition functions
+ *  @f$Q_{1,k}@f$ of the exterior loop prefixes @f$[1,k]@f$ from the base
+ *  pair matrix #vrna_mx_pf_t.qb only. Thus, the entries @f$Q_{1,k}@f$ are
+ *  available even if the matrix #vrna_mx_pf_t.q only stores subsegments
+ *  within the band of banded DP matrices (see #vrna_fold_compound_t.band).
+ *  G-quadruplexes and unstructured domains are not taken into account.
+ *
+ *  @see vrna_exp_E_ext_loop_3(), vrna_E_ext_loop_5()
+ *
+ *  @param  fc  The fold compound with filled base pair matrix #vrna_mx_pf_t.qb
+ *  @return     The partition function @f$Q_{1,n}@f$ of the entire sequence
+ */
+FLT_OR_DBL
+vrna_exp_E_ext_loop_5(vrna_fold_compound_t *fc);
+
+
+/**
+ *  @brief  Compute the partition functions of all 3' suffixes of the sequence
+ *
+ *  Fills the linear array #vrna_mx_pf_t.qln with the partition functions
+ *  @f$Q_{k,n}@f$, see vrna_exp_E_ext_loop_5() for details.
+ *
+ *  @see vrna_exp_E_ext_loop_5()
+ *
+ *  @param  fc  The fold compound with filled base pair matrix #vrna_mx_pf_t.qb
+ *  @return     The partition function @f$Q_{1,n}@f$ of the entire sequence
+ */
+FLT_OR_DBL
+vrna_exp_E_ext_loop_3(vrna_fold_compound_t *fc);
+
+
 /* End partition function interface */
 /**@}*/
 
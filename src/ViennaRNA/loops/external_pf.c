@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/external.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -37,6 +38,8 @@ struct vrna_mx_pf_aux_el_s {
 
   int         qqu_size;
   FLT_OR_DBL  **qqu;
+
+  FLT_OR_DBL  *qq_mx;   /* column-wise storage of qq for all j (optional) */
 };
 
 /*
@@ -202,10 +205,34 @@ vrna_exp_E_ext_fast_init(vrna_fold_compound_t *fc)
 }
 
 
+PUBLIC struct vrna_mx_pf_aux_el_s *
+vrna_exp_E_ext_fast_init_columns(vrna_fold_compound_t *fc)
+{
+  struct vrna_mx_pf_aux_el_s *aux_mx = NULL;
+
+  if ((fc) &&
+      (fc->hc->type != VRNA_HC_WINDOW) &&
+      (!((fc->domains_up) && (fc->domains_up->exp_energy_cb)))) {
+    aux_mx = vrna_exp_E_ext_fast_init(fc);
+
+    /* replace the two column arrays by a matrix that holds all columns */
+    free(aux_mx->qq);
+    free(aux_mx->qq1);
+    free(aux_mx->qq_mx);
+    aux_mx->qq    = NULL;
+    aux_mx->qq1   = NULL;
+    aux_mx->qq_mx =
+      (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (((size_t)(fc->length + 1) * (fc->length + 2)) / 2));
+  }
+
+  return aux_mx;
+}
+
+
 PUBLIC void
 vrna_exp_E_ext_fast_rotate(struct vrna_mx_pf_aux_el_s *aux_mx)
 {
-  if (aux_mx) {
+  if ((aux_mx) && (!aux_mx->qq_mx)) {
     int         u;
     FLT_OR_DBL  *tmp;
 
@@ -232,6 +259,7 @@ vrna_exp_E_ext_fast_free(struct vrna_mx_pf_aux_el_s *aux_mx)
 
     free(aux_mx->qq);
     free(aux_mx->qq1);
+    free(aux_mx->qq_mx);
 
     if (aux_mx->qqu) {
       for (u = 0; u <= aux_mx->qqu_size; u++)
@@ -245,6 +273,32 @@ vrna_exp_E_ext_fast_free(struct vrna_mx_pf_aux_el_s *aux_mx)
 }
 
 
+PUBLIC void
+vrna_exp_E_ext_fast_rescale(vrna_fold_compound_t        *fc,
+                            int                         j,
+                            const FLT_OR_DBL            *factors,
+                            struct vrna_mx_pf_aux_el_s  *aux_mx)
+{
+  int i, k, *jindx;
+
+  if ((fc) && (aux_mx) && (factors)) {
+    if (aux_mx->qq_mx) {
+      jindx = fc->jindx;
+
+      for (k = 1; k <= (int)fc->length; k++)
+        for (i = 1; i <= k; i++)
+          aux_mx->qq_mx[jindx[k] + i] *= factors[k - i + 1];
+    } else {
+      for (i = 1; i <= j; i++)
+        aux_mx->qq[i] *= factors[j - i + 1];
+
+      for (i = 1; i < j; i++)
+        aux_mx->qq1[i] *= factors[j - i];
+    }
+  }
+}
+
+
 PUBLIC FLT_OR_DBL
 vrna_exp_E_ext_fast(vrna_fold_compound_t        *fc,
                     int                         i,
@@ -313,6 +367,124 @@ vrna_exp_E_ext_fast_update(vrna_fold_compound_t       *fc,
 }
 
 
+PUBLIC FLT_OR_DBL
+vrna_exp_E_ext_loop_5(vrna_fold_compound_t *fc)
+{
+  int                       j, k, n, turn, max_span;
+  FLT_OR_DBL                q, q_temp, *q1k, *scale;
+  vrna_callback_hc_evaluate *evaluate;
+  struct default_data       hc_dat_local;
+  struct sc_wrapper_exp_ext sc_wrapper;
+
+  if ((!fc) || (!fc->exp_matrices) || (!fc->exp_matrices->q1k))
+    return 0.;
+
+  n         = (int)fc->length;
+  turn      = fc->exp_params->model_details.min_loop_size;
+  q1k       = fc->exp_matrices->q1k;
+  scale     = fc->exp_matrices->scale;
+  max_span  = (fc->band) ? (int)fc->band : n;
+  evaluate  = prepare_hc_default(fc, &hc_dat_local);
+
+  init_sc_wrapper_ext(fc, &sc_wrapper);
+
+  q1k[0] = 1.;
+
+  for (j = 1; j <= n; j++) {
+    q = 0.;
+
+    /* nucleotide j is unpaired */
+    if (evaluate(1, j, 1, j - 1, VRNA_DECOMP_EXT_EXT, &hc_dat_local)) {
+      q_temp = q1k[j - 1] * scale[1];
+
+      if (sc_wrapper.red_ext)
+        q_temp *= sc_wrapper.red_ext(1, j, 1, j - 1, &sc_wrapper);
+
+      q += q_temp;
+    }
+
+    /* nucleotide j pairs with k */
+    for (k = j - turn - 1; k >= MAX2(1, j - max_span); k--) {
+      q_temp = reduce_ext_stem_fast(fc, k, j, NULL, evaluate, &hc_dat_local, &sc_wrapper);
+
+      if (q_temp != 0.) {
+        q_temp *= q1k[k - 1];
+
+        if ((k > 1) && (sc_wrapper.split))
+          q_temp *= sc_wrapper.split(1, j, k, &sc_wrapper);
+
+        q += q_temp;
+      }
+    }
+
+    q1k[j] = q;
+  }
+
+  free_sc_wrapper_ext(&sc_wrapper);
+
+  return q1k[n];
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_exp_E_ext_loop_3(vrna_fold_compound_t *fc)
+{
+  int                       i, l, n, turn, max_span;
+  FLT_OR_DBL                q, q_temp, *qln, *scale;
+  vrna_callback_hc_evaluate *evaluate;
+  struct default_data       hc_dat_local;
+  struct sc_wrapper_exp_ext sc_wrapper;
+
+  if ((!fc) || (!fc->exp_matrices) || (!fc->exp_matrices->qln))
+    return 0.;
+
+  n         = (int)fc->length;
+  turn      = fc->exp_params->model_details.min_loop_size;
+  qln       = fc->exp_matrices->qln;
+  scale     = fc->exp_matrices->scale;
+  max_span  = (fc->band) ? (int)fc->band : n;
+  evaluate  = prepare_hc_default(fc, &hc_dat_local);
+
+  init_sc_wrapper_ext(fc, &sc_wrapper);
+
+  qln[n + 1] = 1.;
+
+  for (i = n; i >= 1; i--) {
+    q = 0.;
+
+    /* nucleotide i is unpaired */
+    if (evaluate(i, n, i + 1, n, VRNA_DECOMP_EXT_EXT, &hc_dat_local)) {
+      q_temp = qln[i + 1] * scale[1];
+
+      if (sc_wrapper.red_ext)
+        q_temp *= sc_wrapper.red_ext(i, n, i + 1, n, &sc_wrapper);
+
+      q += q_temp;
+    }
+
+    /* nucleotide i pairs with l */
+    for (l = i + turn + 1; l <= MIN2(n, i + max_span); l++) {
+      q_temp = reduce_ext_stem_fast(fc, i, l, NULL, evaluate, &hc_dat_local, &sc_wrapper);
+
+      if (q_temp != 0.) {
+        q_temp *= qln[l + 1];
+
+        if ((l < n) && (sc_wrapper.split))
+          q_temp *= sc_wrapper.split(i, n, l + 1, &sc_wrapper);
+
+        q += q_temp;
+      }
+    }
+
+    qln[i] = q;
+  }
+
+  free_sc_wrapper_ext(&sc_wrapper);
+
+  return qln[1];
+}
+
+
 PRIVATE INLINE FLT_OR_DBL
 reduce_ext_ext_fast(vrna_fold_compound_t        *fc,
                     int                         i,
@@ -546,11 +718,10 @@ split_ext_fast(vrna_fold_compound_t       *fc,
    *  strands in hard constraints, we have to think of something else...
    */
   if ((evaluate == &hc_default) || (evaluate == &hc_default_window)) {
-    for (k = j; k > i; k--) {
-      qbt += q[ij1] *
-             qqq[k];
-      ij1 -= factor;
-    }
+    if (factor == 1)
+      qbt += vrna_fun_zip_mult_sum(q + i, qqq + i + 1, j - i);
+    else
+      qbt += vrna_fun_zip_rev_mult_sum(q + ij1, qqq + j, j - i);
   } else {
     for (k = j; k > i; k--)
       if (evaluate(i, j, k - 1, k, VRNA_DECOMP_EXT_EXT_EXT, hc_dat_local)) {
@@ -585,14 +756,23 @@ exp_E_ext_fast(vrna_fold_compound_t       *fc,
                int                        j,
                struct vrna_mx_pf_aux_el_s *aux_mx)
 {
-  int                       *iidx, ij, with_ud, with_gquad;
-  FLT_OR_DBL                qbt1, *qq, **qqu, *G, **G_local;
-  vrna_md_t                 *md;
-  vrna_exp_param_t          *pf_params;
-  vrna_ud_t                 *domains_up;
-  vrna_callback_hc_evaluate *evaluate;
-  struct default_data       hc_dat_local;
-  struct sc_wrapper_exp_ext sc_wrapper;
+  int                         *iidx, ij, with_ud, with_gquad;
+  FLT_OR_DBL                  qbt1, *qq, **qqu, *G, **G_local;
+  vrna_md_t                   *md;
+  vrna_exp_param_t            *pf_params;
+  vrna_ud_t                   *domains_up;
+  vrna_callback_hc_evaluate   *evaluate;
+  struct default_data         hc_dat_local;
+  struct sc_wrapper_exp_ext   sc_wrapper;
+  struct vrna_mx_pf_aux_el_s  aux_mx_col;
+
+  /* resolve columns j and j - 1 if all columns are stored */
+  if (aux_mx->qq_mx) {
+    aux_mx_col      = *aux_mx;
+    aux_mx_col.qq   = aux_mx->qq_mx + fc->jindx[j];
+    aux_mx_col.qq1  = aux_mx->qq_mx + fc->jindx[j - 1];
+    aux_mx          = &aux_mx_col;
+  }
 
   qq          = aux_mx->qq;
   qqu         = aux_mx->qqu;
@@ -17,6 +17,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/internal.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 
 #ifdef __GNUC__
@@ -70,6 +71,17 @@ eval_ext_int_loop(vrna_fold_compound_t  *fc,
                   int                   l);
 
 
+PRIVATE INLINE int
+E_int_loop_generic_row(vrna_fold_compound_t *fc,
+                       int                  i,
+                       int                  j,
+                       int                  l,
+                       int                  first_k,
+                       int                  last_k,
+                       int                  *en_kl,
+                       int                  *en_loop);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -357,6 +369,72 @@ eval_ext_int_loop(vrna_fold_compound_t  *fc,
 }
 
 
+/*
+ *  Evaluate all generic interior loops (i,j,k,l) with fixed l and
+ *  first_k <= k <= last_k for a single, unconstrained sequence.
+ *
+ *  Since the 3' side of the loop is fixed, the energy contributions of
+ *  the enclosed pairs (k,l) and of the loop sizes can be gathered into
+ *  two contiguous rows that are then reduced with a (vectorized)
+ *  zip_add_min(). The caller must ensure that none of the loops in the
+ *  range is handled by the special cases in E_IntLoop() and that
+ *  neither soft constraints nor hard constraint callbacks apply.
+ */
+PRIVATE INLINE int
+E_int_loop_generic_row(vrna_fold_compound_t *fc,
+                       int                  i,
+                       int                  j,
+                       int                  l,
+                       int                  first_k,
+                       int                  last_k,
+                       int                  *en_kl,
+                       int                  *en_loop)
+{
+  unsigned char *hc_mx;
+  char          *ptype;
+  short         *S;
+  unsigned int  type, type2;
+  int           e, k, kl, t, u1, u2, *c, *idx, *rtype, noGUclosure;
+  vrna_param_t  *P;
+
+  P           = fc->params;
+  S           = fc->sequence_encoding;
+  ptype       = fc->ptype;
+  idx         = fc->jindx;
+  c           = fc->matrices->c;
+  hc_mx       = fc->hc->mx + fc->length * l;
+  rtype       = &(P->model_details.rtype[0]);
+  noGUclosure = P->model_details.noGUclosure;
+  u2          = j - l - 1;
+  kl          = idx[l] + first_k;
+
+  for (t = 0, k = first_k; k <= last_k; k++, kl++, t++) {
+    u1          = k - i - 1;
+    en_loop[t]  = P->internal_loop[u1 + u2] +
+                  MIN2(MAX_NINIO, (MAX2(u1, u2) - MIN2(u1, u2)) * P->ninio[2]);
+    en_kl[t] = INF;
+
+    if ((hc_mx[k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
+        (c[kl] != INF)) {
+      type2 = rtype[vrna_get_ptype(kl, ptype)];
+
+      if ((!noGUclosure) || ((type2 != 3) && (type2 != 4)))
+        en_kl[t] = c[kl] +
+                   P->mismatchI[type2][S[l + 1]][S[k - 1]];
+    }
+  }
+
+  e = vrna_fun_zip_add_min(en_kl, en_loop, t);
+
+  if (e != INF) {
+    type  = vrna_get_ptype(idx[j] + i, ptype);
+    e     += P->mismatchI[type][S[i + 1]][S[j - 1]];
+  }
+
+  return e;
+}
+
+
 PRIVATE int
 E_internal_loop(vrna_fold_compound_t  *fc,
                 int                   i,
@@ -412,8 +490,9 @@ E_internal_loop(vrna_fold_compound_t  *fc,
   hc_decompose = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[n * i + j];
 
   if (hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
-    unsigned int  type, type2, has_nick, *tt;
-    int           k, l, kl, last_k, first_l, u1, u2, turn, noGUclosure;
+    unsigned int  type, type2, has_nick, *tt, fast_generic;
+    int           k, l, kl, last_k, first_l, u1, u2, turn, noGUclosure, last_k_slow,
+                  first_k_fast, en_kl[MAXLOOP + 1], en_loop[MAXLOOP + 1];
 
     has_nick    = sn[i] != sn[j] ? 1 : 0;
     turn        = md->min_loop_size;
@@ -428,6 +507,18 @@ E_internal_loop(vrna_fold_compound_t  *fc,
 
     noclose = ((noGUclosure) && (type == 3 || type == 4)) ? 1 : 0;
 
+    /*
+     *  generic interior loops of single sequences without soft constraints,
+     *  unstructured domains, or hard constraint callbacks can be evaluated
+     *  row-wise with a vectorized kernel
+     */
+    fast_generic = ((fc->type == VRNA_FC_TYPE_SINGLE) &&
+                    (!sliding_window) &&
+                    (!has_nick) &&
+                    (!with_ud) &&
+                    (!sc_wrapper.pair) &&
+                    (evaluate == &hc_default)) ? 1 : 0;
+
     if (fc->type == VRNA_FC_TYPE_COMPARATIVE) {
       tt = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
       for (s = 0; s < n_seq; s++)
@@ -670,13 +761,23 @@ E_internal_loop(vrna_fold_compound_t  *fc,
         if (last_k > i + 1 + hc_up[i + 1])
           last_k = i + 1 + hc_up[i + 1];
 
+        last_k_slow   = last_k;
+        first_k_fast  = last_k + 1;
+
+        if ((fast_generic) && (u2 > 1)) {
+          /* 1xn, 2x2, and 2x3 loops are special cases that we still evaluate below */
+          first_k_fast = i + 1 + ((u2 == 2) ? 4 : ((u2 == 3) ? 3 : 2));
+          if (last_k_slow >= first_k_fast)
+            last_k_slow = first_k_fast - 1;
+        }
+
         u1  = 1;
         k   = i + 2;
         kl  = (sliding_window) ? 0 : idx[l] + k;
 
         hc_mx += n * l;
 
-        for (; k <= last_k; k++, u1++, kl++) {
+        for (; k <= last_k_slow; k++, u1++, kl++) {
           hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[k];
 
           if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
@@ -756,6 +857,11 @@ E_internal_loop(vrna_fold_compound_t  *fc,
         }
 
         hc_mx -= n * l;
+
+        if (first_k_fast <= last_k) {
+          eee = E_int_loop_generic_row(fc, i, j, l, first_k_fast, last_k, en_kl, en_loop);
+          e   = MIN2(e, eee);
+        }
       }
 
       if (with_gquad) {
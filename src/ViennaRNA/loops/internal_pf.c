@@ -17,6 +17,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/internal.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 
 #ifdef __GNUC__
@@ -54,6 +55,17 @@ exp_E_interior_loop(vrna_fold_compound_t  *fc,
                     int                   l);
 
 
+PRIVATE INLINE FLT_OR_DBL
+exp_E_int_loop_generic_row(vrna_fold_compound_t *fc,
+                           int                  i,
+                           int                  j,
+                           int                  k,
+                           int                  first_l,
+                           int                  last_l,
+                           FLT_OR_DBL           *q_kl,
+                           FLT_OR_DBL           *q_loop);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -100,6 +112,73 @@ vrna_exp_E_interior_loop(vrna_fold_compound_t *fc,
 }
 
 
+/*
+ *  Partition function counterpart of E_int_loop_generic_row() in
+ *  internal.c. Here, the 5' side of the loop is fixed and l runs from
+ *  last_l down to first_l (or until the hard constraints on unpaired
+ *  nucleotides forbid any larger 3' side)
+ */
+PRIVATE INLINE FLT_OR_DBL
+exp_E_int_loop_generic_row(vrna_fold_compound_t *fc,
+                           int                  i,
+                           int                  j,
+                           int                  k,
+                           int                  first_l,
+                           int                  last_l,
+                           FLT_OR_DBL           *q_kl,
+                           FLT_OR_DBL           *q_loop)
+{
+  unsigned char     *hc_mx;
+  char              *ptype;
+  short             *S1;
+  unsigned int      type, type2;
+  int               l, kl, t, u1, u2, *jindx, *rtype, *hc_up, noGUclosure;
+  FLT_OR_DBL        q, *qb, *scale;
+  vrna_exp_param_t  *pf_params;
+
+  pf_params   = fc->exp_params;
+  S1          = fc->sequence_encoding;
+  ptype       = fc->ptype;
+  jindx       = fc->jindx;
+  qb          = fc->exp_matrices->qb + fc->iindx[k];
+  scale       = fc->exp_matrices->scale;
+  hc_mx       = fc->hc->mx + fc->length * k;
+  hc_up       = fc->hc->up_int;
+  rtype       = &(pf_params->model_details.rtype[0]);
+  noGUclosure = pf_params->model_details.noGUclosure;
+  u1          = k - i - 1;
+
+  for (t = 0, l = last_l; l >= first_l; l--, t++) {
+    u2 = j - l - 1;
+    if (hc_up[l + 1] < u2)
+      break;
+
+    q_loop[t] = pf_params->expinternal[u1 + u2] *
+                pf_params->expninio[2][MAX2(u1, u2) - MIN2(u1, u2)] *
+                scale[u1 + u2 + 2];
+    q_kl[t] = 0.;
+
+    if (hc_mx[l] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
+      kl    = jindx[l] + k;
+      type2 = rtype[vrna_get_ptype(kl, ptype)];
+
+      if ((!noGUclosure) || ((type2 != 3) && (type2 != 4)))
+        q_kl[t] = qb[-l] *
+                  pf_params->expmismatchI[type2][S1[l + 1]][S1[k - 1]];
+    }
+  }
+
+  q = vrna_fun_zip_mult_sum(q_kl, q_loop, t);
+
+  if (q > 0.) {
+    type  = vrna_get_ptype(jindx[j] + i, ptype);
+    q     *= pf_params->expmismatchI[type][S1[i + 1]][S1[j - 1]];
+  }
+
+  return q;
+}
+
+
 PRIVATE FLT_OR_DBL
 exp_E_int_loop(vrna_fold_compound_t *fc,
                int                  i,
@@ -160,8 +239,10 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
 
   /* CONSTRAINED INTERIOR LOOP start */
   if (hc_decompose_ij & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
-    unsigned int  type, type2, *tt;
-    int           k, l, kl, last_k, first_l, u1, u2, turn, noGUclosure;
+    unsigned int  type, type2, *tt, fast_generic;
+    int           k, l, kl, last_k, first_l, u1, u2, turn, noGUclosure, first_l_slow,
+                  last_l_fast;
+    FLT_OR_DBL    q_kl[MAXLOOP + 1], q_loop[MAXLOOP + 1];
 
     turn        = md->min_loop_size;
     noGUclosure = md->noGUclosure;
@@ -175,6 +256,14 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
 
     noclose = ((noGUclosure) && (type == 3 || type == 4)) ? 1 : 0;
 
+    /* use the row-wise kernel for generic interior loops whenever possible */
+    fast_generic = ((fc->type == VRNA_FC_TYPE_SINGLE) &&
+                    (!sliding_window) &&
+                    (sn[i] == sn[j]) &&
+                    (!with_ud) &&
+                    (!sc_wrapper.pair) &&
+                    (evaluate == &hc_default)) ? 1 : 0;
+
     if (fc->type == VRNA_FC_TYPE_COMPARATIVE) {
       tt = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
       for (s = 0; s < n_seq; s++)
@@ -427,11 +516,21 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
         if (first_l < ss[sn[j]])
           first_l = ss[sn[j]];
 
+        first_l_slow  = first_l;
+        last_l_fast   = first_l - 1;
+
+        if ((fast_generic) && (u1 > 1)) {
+          /* 1xn, 2x2, and 2x3 loops are special cases that we still evaluate below */
+          last_l_fast = j - 1 - ((u1 == 2) ? 4 : ((u1 == 3) ? 3 : 2));
+          if (first_l_slow <= last_l_fast)
+            first_l_slow = last_l_fast + 1;
+        }
+
         u2 = 1;
 
         hc_mx += n * k;
 
-        for (l = j - 2; l >= first_l; l--, u2++) {
+        for (l = j - 2; l >= first_l_slow; l--, u2++) {
           if (hc_up[l + 1] < u2)
             break;
 
@@ -515,6 +614,11 @@ exp_E_int_loop(vrna_fold_compound_t *fc,
         }
 
         hc_mx -= n * k;
+
+        if ((first_l <= last_l_fast) && (l < first_l_slow))
+          qbt1 += exp_E_int_loop_generic_row(fc, i, j, k,
+                                             first_l, last_l_fast,
+                                             q_kl, q_loop);
       }
 
       if ((with_gquad) && (!noclose)) {
@@ -1259,9 +1259,17 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
   }
 
   /* use fmi pointer that we may extend to include hard/soft constraints if necessary */
-  int *fmi_tmp = fmi;
+  int           *fmi_tmp  = fmi;
+  unsigned char *mask     = NULL;
 
-  if (hc->f) {
+  if ((hc->f) && (!sliding_window) && (!sc_wrapper.decomp_ml)) {
+    /* hard constraints only, so we may leave fmi untouched and mask unavailable decompositions */
+    mask  = (unsigned char *)vrna_alloc(sizeof(unsigned char) * (j - i + 2));
+    mask  -= i;
+
+    for (k = i + 1 + turn; k <= j - 2 - turn; k++)
+      mask[k] = (hc->f(i, j, k, k + 1, VRNA_DECOMP_ML_ML_ML, hc->data)) ? 1 : 0;
+  } else if (hc->f) {
     fmi_tmp = (int *)vrna_alloc(sizeof(int) * (j - i + 2));
     fmi_tmp -= i;
 
@@ -1321,7 +1329,11 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
 
       const int count = last_nt - k + 1;
 
-      en      = vrna_fun_zip_add_min(fmi_tmp + k, fm + k1j, count);
+      if (mask)
+        en = vrna_fun_zip_add_min_masked(fmi_tmp + k, fm + k1j, mask + k, count);
+      else
+        en = vrna_fun_zip_add_min(fmi_tmp + k, fm + k1j, count);
+
       decomp  = MIN2(decomp, en);
 
       /* advance counters by processed subsegment and add 1 for the split point between strands */
@@ -1340,6 +1352,11 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
     free(fmi_tmp);
   }
 
+  if (mask) {
+    mask += i;
+    free(mask);
+  }
+
   dmli[j] = decomp;               /* store for use in fast ML decompositon */
 
   e = MIN2(e, decomp);
@@ -109,6 +109,24 @@ vrna_mx_pf_aux_ml_t
 vrna_exp_E_ml_fast_init(vrna_fold_compound_t *fc);
 
 
+/**
+ *  @brief  Prepare auxiliary helper arrays that keep the multibranch loop
+ *          contributions of all columns
+ *
+ *  Same as vrna_exp_E_ml_fast_init() but, instead of the two arrays of the
+ *  current and previous column @f$j@f$ and @f$j - 1@f$, all columns are
+ *  kept in a triangular matrix (the @p qm1 matrix if available). Thus,
+ *  subsegments @f$[i,j]@f$ may be decomposed in any order of increasing span,
+ *  e.g. concurrently along anti-diagonals, and vrna_exp_E_ml_fast_rotate()
+ *  becomes a no-op. Unstructured domains and sliding-window compounds are
+ *  not supported and result in a @p NULL return value.
+ *
+ *  @see vrna_exp_E_ml_fast_init(), vrna_exp_E_ml_fast_free()
+ */
+vrna_mx_pf_aux_ml_t
+vrna_exp_E_ml_fast_init_columns(vrna_fold_compound_t *fc);
+
+
 void
 vrna_exp_E_ml_fast_rotate(vrna_mx_pf_aux_ml_t aux_mx);
 
@@ -117,6 +135,24 @@ void
 vrna_exp_E_ml_fast_free(vrna_mx_pf_aux_ml_t aux_mx);
 
 
+/**
+ *  @brief  Re-scale the contents of the auxiliary helper arrays for fast multibranch loop computations
+ *
+ *  Multiplies each entry that corresponds to a segment of length @f$l@f$ by
+ *  @p factors[@f$l@f$], where @p j denotes the last column that has been
+ *  processed so far. If the @p qm1 matrix serves as storage for all columns
+ *  (see vrna_exp_E_ml_fast_init_columns()), it is left untouched and must be
+ *  re-scaled by the caller.
+ *
+ *  @see vrna_exp_E_ml_fast_init(), vrna_exp_E_ext_fast_rescale()
+ */
+void
+vrna_exp_E_ml_fast_rescale(vrna_fold_compound_t *fc,
+                           int                  j,
+                           const FLT_OR_DBL     *factors,
+                           vrna_mx_pf_aux_ml_t  aux_mx);
+
+
 const FLT_OR_DBL *
 vrna_exp_E_ml_fast_qqm(struct vrna_mx_pf_aux_ml_s *aux_mx);
 
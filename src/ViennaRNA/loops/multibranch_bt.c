@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -926,24 +927,60 @@ BT_mb_loop_split(vrna_fold_compound_t *fc,
   }
 
   /* 2. Test for possible split point */
-  for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
-    if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
-      if (sliding_window)
+  if ((!sliding_window) && (jj - 2 - turn >= ii + 1 + turn)) {
+    /*
+     *  gather the (strided) 5' parts fML(ii, u) first such that we can
+     *  search for the first optimal split point in a vectorized fashion.
+     *  Since fij is the minimum of all decompositions, the first
+     *  position that attains the minimum is also the first one where
+     *  fij == en
+     */
+    int pos, count, *fmi_tmp;
+
+    count   = jj - 2 - turn - (ii + 1 + turn) + 1;
+    fmi_tmp = (int *)vrna_alloc(sizeof(int) * count);
+
+    for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
+      en = INF;
+
+      if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
+        en = my_fML[idx[u] + ii];
+
+        if ((en != INF) && (sc_wrapper.decomp_ml))
+          en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
+      }
+
+      fmi_tmp[u - (ii + 1 + turn)] = en;
+    }
+
+    pos = vrna_fun_zip_add_argmin(fmi_tmp, my_fML + idx[jj] + ii + 2 + turn, count, &en);
+
+    free(fmi_tmp);
+
+    if ((pos >= 0) && (fij == en)) {
+      u   = ii + 1 + turn + pos;
+      *i  = ii;
+      *j  = u;
+      *k  = u + 1;
+      *l  = jj;
+      return 1;
+    }
+  } else if (sliding_window) {
+    for (u = ii + 1 + turn; u <= jj - 2 - turn; u++) {
+      if (evaluate(ii, jj, u, u + 1, VRNA_DECOMP_ML_ML_ML, &hc_dat_local)) {
         en = fML_local[ii][u - ii] +
              fML_local[u + 1][jj - (u + 1)];
-      else
-        en = my_fML[idx[u] + ii] +
-             my_fML[idx[jj] + u + 1];
-
-      if (sc_wrapper.decomp_ml)
-        en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
-
-      if (fij == en) {
-        *i  = ii;
-        *j  = u;
-        *k  = u + 1;
-        *l  = jj;
-        return 1;
+
+        if (sc_wrapper.decomp_ml)
+          en += sc_wrapper.decomp_ml(ii, jj, u, u + 1, &sc_wrapper);
+
+        if (fij == en) {
+          *i  = ii;
+          *j  = u;
+          *k  = u + 1;
+          *l  = jj;
+          return 1;
+        }
       }
     }
   }
@@ -19,6 +19,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/multibranch.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 #ifdef __GNUC__
 # define INLINE inline
@@ -35,6 +36,9 @@ struct vrna_mx_pf_aux_ml_s {
 
   int         qqmu_size;
   FLT_OR_DBL  **qqmu;
+
+  FLT_OR_DBL  *qqm_mx;    /* column-wise storage of qqm for all j (optional) */
+  FLT_OR_DBL  *qqm_mem;   /* memory of qqm_mx if not provided by qm1 matrix */
 };
 
 
@@ -165,10 +169,39 @@ vrna_exp_E_ml_fast_init(vrna_fold_compound_t *fc)
 }
 
 
+PUBLIC struct vrna_mx_pf_aux_ml_s *
+vrna_exp_E_ml_fast_init_columns(vrna_fold_compound_t *fc)
+{
+  struct vrna_mx_pf_aux_ml_s *aux_mx = NULL;
+
+  if ((fc) &&
+      (fc->hc->type != VRNA_HC_WINDOW) &&
+      (!((fc->domains_up) && (fc->domains_up->exp_energy_cb)))) {
+    aux_mx = vrna_exp_E_ml_fast_init(fc);
+
+    /* replace the two column arrays by a matrix that holds all columns */
+    free(aux_mx->qqm);
+    free(aux_mx->qqm1);
+    aux_mx->qqm   = NULL;
+    aux_mx->qqm1  = NULL;
+
+    if (fc->exp_matrices->qm1) {
+      aux_mx->qqm_mx = fc->exp_matrices->qm1;
+    } else {
+      aux_mx->qqm_mem =
+        (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (((size_t)(fc->length + 1) * (fc->length + 2)) / 2));
+      aux_mx->qqm_mx = aux_mx->qqm_mem;
+    }
+  }
+
+  return aux_mx;
+}
+
+
 PUBLIC void
 vrna_exp_E_ml_fast_rotate(struct vrna_mx_pf_aux_ml_s *aux_mx)
 {
-  if (aux_mx) {
+  if ((aux_mx) && (!aux_mx->qqm_mx)) {
     int         u;
     FLT_OR_DBL  *tmp;
 
@@ -187,6 +220,35 @@ vrna_exp_E_ml_fast_rotate(struct vrna_mx_pf_aux_ml_s *aux_mx)
 }
 
 
+PUBLIC void
+vrna_exp_E_ml_fast_rescale(vrna_fold_compound_t       *fc,
+                           int                        j,
+                           const FLT_OR_DBL           *factors,
+                           struct vrna_mx_pf_aux_ml_s *aux_mx)
+{
+  int i, k, *jindx;
+
+  if ((fc) && (aux_mx) && (factors)) {
+    if (aux_mx->qqm_mx) {
+      /* the qm1 matrix is re-scaled by the caller */
+      if (aux_mx->qqm_mem) {
+        jindx = fc->jindx;
+
+        for (k = 1; k <= (int)fc->length; k++)
+          for (i = 1; i <= k; i++)
+            aux_mx->qqm_mem[jindx[k] + i] *= factors[k - i + 1];
+      }
+    } else {
+      for (i = 1; i <= j; i++)
+        aux_mx->qqm[i] *= factors[j - i + 1];
+
+      for (i = 1; i < j; i++)
+        aux_mx->qqm1[i] *= factors[j - i];
+    }
+  }
+}
+
+
 PUBLIC void
 vrna_exp_E_ml_fast_free(struct vrna_mx_pf_aux_ml_s *aux_mx)
 {
@@ -195,6 +257,7 @@ vrna_exp_E_ml_fast_free(struct vrna_mx_pf_aux_ml_s *aux_mx)
 
     free(aux_mx->qqm);
     free(aux_mx->qqm1);
+    free(aux_mx->qqm_mem);
 
     if (aux_mx->qqmu) {
       for (u = 0; u <= aux_mx->qqmu_size; u++)
@@ -252,7 +315,7 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
   struct default_data       hc_dat_local;
   struct sc_wrapper_exp_ml  sc_wrapper;
 
-  qqm1            = aux_mx->qqm1;
+  qqm1            = (aux_mx->qqm_mx) ? aux_mx->qqm_mx + fc->jindx[j - 1] : aux_mx->qqm1;
   sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   se              = fc->strand_end;
@@ -351,9 +414,12 @@ exp_E_mb_loop_fast(vrna_fold_compound_t       *fc,
         /* limit for-loop to last nucleotide of 5' part strand */
         int stop = MIN2(j - 1, se[sn[k - 1]]);
 
-        for (; k <= stop; k++, kl--)
-          temp += qm[kl] *
-                  qqm1_tmp[k];
+        if (stop >= k) {
+          /* qm is traversed backwards while qqm1 is traversed forward */
+          temp  += vrna_fun_zip_rev_mult_sum(qqm1_tmp + k, qm + kl, stop - k + 1);
+          kl    -= stop - k + 1;
+          k     = stop + 1;
+        }
 
         k++;
         kl--;
@@ -410,8 +476,8 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   S3              = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
   iidx            = (sliding_window) ? NULL : fc->iindx;
   ij              = (sliding_window) ? 0 : iidx[i] - j;
-  qqm             = aux_mx->qqm;
-  qqm1            = aux_mx->qqm1;
+  qqm             = (aux_mx->qqm_mx) ? aux_mx->qqm_mx + fc->jindx[j] : aux_mx->qqm;
+  qqm1            = (aux_mx->qqm_mx) ? aux_mx->qqm_mx + fc->jindx[j - 1] : aux_mx->qqm1;
   qqmu            = aux_mx->qqmu;
   qm              = (sliding_window) ? NULL : fc->exp_matrices->qm;
   qb              = (sliding_window) ? NULL : fc->exp_matrices->qb;
@@ -565,9 +631,13 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
     while (1) {
       /* limit for-loop to first nucleotide of 3' part strand */
       int stop = MAX2(i, ss[sn[k]]);
-      for (; k > stop; k--, kl++)
-        temp += qm[kl] *
-                qqm_tmp[k];
+
+      if (k > stop) {
+        /* qm is traversed forward while qqm is traversed backwards */
+        temp  += vrna_fun_zip_rev_mult_sum(qm + kl, qqm_tmp + k, k - stop);
+        kl    += k - stop;
+        k     = stop;
+      }
 
       k--;
       kl++;
@@ -626,9 +696,8 @@ exp_E_ml_fast(vrna_fold_compound_t        *fc,
   ii = maxk - i; /* length of unpaired stretch */
 
   /* finally, decompose segment */
-  for (k = maxk; k > i; k--, ii--)
-    temp += expMLbase[ii] *
-            qqm_tmp[k];
+  if (ii > 0)
+    temp += vrna_fun_zip_mult_sum(expMLbase + 1, qqm_tmp + i + 1, ii);
 
   if (with_ud) {
     ii = maxk - i; /* length of unpaired stretch */
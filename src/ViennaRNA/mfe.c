@@ -35,8 +35,13 @@
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/alphabet.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 #include "ViennaRNA/mfe.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __GNUC__
 # define INLINE inline
 #else
@@ -52,7 +57,28 @@ struct aux_arrays {
   int *DMLi;  /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j])      */
   int *DMLi1; /*                MIN(fML[i+1,k]+fML[k+1,j])    */
   int *DMLi2; /*                MIN(fML[i+2,k]+fML[k+1,j])    */
+  vrna_mx_mfe_t *ref_mx;    /* DP matrices of a reference sequence, see vrna_mfe_reuse() */
+  int           ref_start;  /* first position that differs from the reference sequence */
+  int           ref_end;    /* last position that differs from the reference sequence  */
+};
+
+
+#ifdef _OPENMP
+/*
+ *  Auxiliary data for the wavefront (anti-diagonal) fill. Since all
+ *  sub-segments [i,j] with equal span j - i are computed concurrently,
+ *  the row-wise helper arrays of 'struct aux_arrays' are replaced by
+ *  small rings of the last few diagonals of cc and DML, indexed by i.
+ *  Row i of fML is gathered from the matrix itself for each (i, j).
+ */
+#define WF_CC_SLOTS   3   /* cc[i+1][j-1] has span d - 2 */
+#define WF_DML_SLOTS  5   /* DML[i+2][j-2] has span d - 4 */
+
+struct aux_wavefront {
+  int *cc[WF_CC_SLOTS];           /* cc[d % WF_CC_SLOTS][i] = cc for (i, i + d) */
+  int *dml[WF_DML_SLOTS];         /* dml[d % WF_DML_SLOTS][i] = DML (i, i + d)  */
 };
+#endif
 
 
 /*
@@ -73,8 +99,24 @@ struct aux_arrays {
  #################################
  */
 
+PRIVATE float
+wrap_mfe(vrna_fold_compound_t *fc,
+         char                 *structure,
+         vrna_fold_compound_t *ref,
+         int                  start,
+         int                  end);
+
+
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc);
+fill_arrays(vrna_fold_compound_t  *fc,
+            vrna_fold_compound_t  *ref,
+            int                   start,
+            int                   end);
+
+
+PRIVATE void
+fill_arrays_generic(vrna_fold_compound_t  *fc,
+                    struct aux_arrays     *helper_arrays);
 
 
 PRIVATE int
@@ -120,88 +162,95 @@ PRIVATE INLINE void
 free_aux_arrays(struct aux_arrays *aux);
 
 
-/*
- #################################
- # BEGIN OF FUNCTION DEFINITIONS #
- #################################
- */
-PUBLIC float
-vrna_mfe(vrna_fold_compound_t *fc,
-         char                 *structure)
-{
-  char            *ss;
-  int             length, energy, s;
-  float           mfe;
-  sect            bt_stack[MAXSECTORS]; /* stack of partial structures for backtracking */
-  vrna_bp_stack_t *bp;
+PRIVATE int
+reuse_compatible(vrna_fold_compound_t *fc,
+                 vrna_fold_compound_t *ref);
 
-  s   = 0;
-  mfe = (float)(INF / 100.);
 
-  if (fc) {
-    length = (int)fc->length;
+PRIVATE INLINE int
+reuse_pair(struct aux_arrays  *aux,
+           int                i,
+           int                j);
 
-    if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE)) {
-      vrna_message_warning("vrna_mfe@mfe.c: Failed to prepare vrna_fold_compound");
-      return mfe;
-    }
 
-    /* call user-defined recursion status callback function */
-    if (fc->stat_cb)
-      fc->stat_cb(VRNA_STATUS_MFE_PRE, fc->auxdata);
+PRIVATE INLINE int
+reuse_row(vrna_fold_compound_t  *fc,
+          struct aux_arrays     *aux,
+          int                   i,
+          int                   max_j);
 
-    /* call user-defined grammar pre-condition callback function */
-    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
-      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_PRE, fc->aux_grammar->data);
 
-    energy = fill_arrays(fc);
+#ifdef _OPENMP
 
-    if (fc->params->model_details.circ)
-      energy = postprocess_circular(fc, bt_stack, &s);
+PRIVATE int
+num_fill_threads(vrna_fold_compound_t *fc);
 
-    if (structure && fc->params->model_details.backtrack) {
-      /* add a guess of how many G's may be involved in a G quadruplex */
-      bp = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (4 * (1 + length / 2)));
 
-      if (backtrack(fc, bp, bt_stack, s) != 0) {
-        ss = vrna_db_from_bp_stack(bp, length);
-        strncpy(structure, ss, length + 1);
-        free(ss);
-      } else {
-        memset(structure, '\0', sizeof(char) * (length + 1));
-      }
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads);
 
-      free(bp);
-    }
 
-    /* call user-defined recursion status callback function */
-    if (fc->stat_cb)
-      fc->stat_cb(VRNA_STATUS_MFE_POST, fc->auxdata);
+PRIVATE INLINE struct aux_wavefront *
+get_aux_wavefront(unsigned int length);
 
-    /* call user-defined grammar post-condition callback function */
-    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
-      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_POST, fc->aux_grammar->data);
 
-    switch (fc->params->model_details.backtrack_type) {
-      case 'C':
-        mfe = (float)fc->matrices->c[fc->jindx[length] + 1] / 100.;
-        break;
+PRIVATE INLINE int
+wavefront_diag_get(int  **diag,
+                   int  slots,
+                   int  span,
+                   int  i);
 
-      case 'M':
-        mfe = (float)fc->matrices->fML[fc->jindx[length] + 1] / 100.;
-        break;
 
-      default:
-        if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
-          mfe = (float)energy / (100. * (float)fc->n_seq);
-        else
-          mfe = (float)energy / 100.;
+PRIVATE INLINE void
+free_aux_wavefront(struct aux_wavefront *aux);
 
-        break;
-    }
+
+#endif
+
+
+/* specialized kernels, see #vrna_kernel_e */
+#define KERNEL_DANGLES  0
+#define KERNEL_FN(f)    f ## _d0
+#include "mfe_kernels.inc"
+#undef KERNEL_DANGLES
+#undef KERNEL_FN
+
+#define KERNEL_DANGLES  2
+#define KERNEL_FN(f)    f ## _d2
+#include "mfe_kernels.inc"
+#undef KERNEL_DANGLES
+#undef KERNEL_FN
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC float
+vrna_mfe(vrna_fold_compound_t *fc,
+         char                 *structure)
+{
+  return wrap_mfe(fc, structure, NULL, 0, 0);
+}
+
+
+PUBLIC float
+vrna_mfe_reuse(vrna_fold_compound_t *fc,
+               vrna_fold_compound_t *ref,
+               unsigned int         start,
+               unsigned int         end,
+               char                 *structure)
+{
+  if ((fc) && (ref) && ((start < 1) || (end < start) || (end > fc->length))) {
+    vrna_message_warning("vrna_mfe_reuse@mfe.c: Invalid range [%u, %u] of modified positions",
+                         start,
+                         end);
+    return (float)(INF / 100.);
   }
 
-  return mfe;
+  return wrap_mfe(fc, structure, ref, (int)start, (int)end);
 }
 
 
@@ -271,11 +320,101 @@ vrna_backtrack5(vrna_fold_compound_t  *fc,
  #####################################
  */
 
+PRIVATE float
+wrap_mfe(vrna_fold_compound_t *fc,
+         char                 *structure,
+         vrna_fold_compound_t *ref,
+         int                  start,
+         int                  end)
+{
+  char            *ss;
+  int             length, energy, s;
+  float           mfe;
+  sect            bt_stack[MAXSECTORS]; /* stack of partial structures for backtracking */
+  vrna_bp_stack_t *bp;
+
+  s   = 0;
+  mfe = (float)(INF / 100.);
+
+  if (fc) {
+    length = (int)fc->length;
+
+    if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE)) {
+      vrna_message_warning("vrna_mfe@mfe.c: Failed to prepare vrna_fold_compound");
+      return mfe;
+    }
+
+    /* fall back to the full recursions if the reference matrices do not fit */
+    if ((ref) && (!reuse_compatible(fc, ref)))
+      ref = NULL;
+
+    /* call user-defined recursion status callback function */
+    if (fc->stat_cb)
+      fc->stat_cb(VRNA_STATUS_MFE_PRE, fc->auxdata);
+
+    /* call user-defined grammar pre-condition callback function */
+    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_PRE, fc->aux_grammar->data);
+
+    energy = fill_arrays(fc, ref, start, end);
+
+    if (fc->params->model_details.circ)
+      energy = postprocess_circular(fc, bt_stack, &s);
+
+    if (structure && fc->params->model_details.backtrack) {
+      /* add a guess of how many G's may be involved in a G quadruplex */
+      bp = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (4 * (1 + length / 2)));
+
+      if (backtrack(fc, bp, bt_stack, s) != 0) {
+        ss = vrna_db_from_bp_stack(bp, length);
+        strncpy(structure, ss, length + 1);
+        free(ss);
+      } else {
+        memset(structure, '\0', sizeof(char) * (length + 1));
+      }
+
+      free(bp);
+    }
+
+    /* call user-defined recursion status callback function */
+    if (fc->stat_cb)
+      fc->stat_cb(VRNA_STATUS_MFE_POST, fc->auxdata);
+
+    /* call user-defined grammar post-condition callback function */
+    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_MFE_POST, fc->aux_grammar->data);
+
+    switch (fc->params->model_details.backtrack_type) {
+      case 'C':
+        mfe = (float)fc->matrices->c[fc->jindx[length] + 1] / 100.;
+        break;
+
+      case 'M':
+        mfe = (float)fc->matrices->fML[fc->jindx[length] + 1] / 100.;
+        break;
+
+      default:
+        if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
+          mfe = (float)energy / (100. * (float)fc->n_seq);
+        else
+          mfe = (float)energy / 100.;
+
+        break;
+    }
+  }
+
+  return mfe;
+}
+
+
 /* fill DP matrices */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc)
+fill_arrays(vrna_fold_compound_t  *fc,
+            vrna_fold_compound_t  *ref,
+            int                   start,
+            int                   end)
 {
-  int               i, j, ij, length, turn, uniq_ML, *indx, *f5, *c, *fML, *fM1;
+  int               i, j, length, turn, uniq_ML, *indx, *f5, *c, *fML, *fM1;
   vrna_param_t      *P;
   vrna_mx_mfe_t     *matrices;
   vrna_ud_t         *domains_up;
@@ -296,6 +435,12 @@ fill_arrays(vrna_fold_compound_t *fc)
   /* allocate memory for all helper arrays */
   helper_arrays = get_aux_arrays(length);
 
+  if (ref) {
+    helper_arrays->ref_mx     = ref->matrices;
+    helper_arrays->ref_start  = start;
+    helper_arrays->ref_end    = end;
+  }
+
   if ((turn < 0) || (turn > length))
     turn = length; /* does this make any sense? */
 
@@ -320,12 +465,74 @@ fill_arrays(vrna_fold_compound_t *fc)
     return 0;
   }
 
+#ifdef _OPENMP
+  int num_threads = num_fill_threads(fc);
+
+  /* re-using the matrices of a reference sequence relies on the row-wise fill */
+  if ((num_threads != 1) && (!ref)) {
+    fill_arrays_wavefront(fc, num_threads);
+    (void)vrna_E_ext_loop_5(fc);
+    free_aux_arrays(helper_arrays);
+
+    return f5[length];
+  }
+
+#endif
+
+  switch (fc->kernel) {
+    case VRNA_KERNEL_DEFAULT_D0:
+      fill_arrays_d0(fc, helper_arrays);
+      break;
+
+    case VRNA_KERNEL_DEFAULT_D2:
+      fill_arrays_d2(fc, helper_arrays);
+      break;
+
+    default:
+      fill_arrays_generic(fc, helper_arrays);
+      break;
+  }
+
+  /* calculate energies of 5' fragments */
+  (void)vrna_E_ext_loop_5(fc);
+
+  /* clean up memory */
+  free_aux_arrays(helper_arrays);
+
+  return f5[length];
+}
+
+
+PRIVATE void
+fill_arrays_generic(vrna_fold_compound_t  *fc,
+                    struct aux_arrays     *helper_arrays)
+{
+  int i, j, ij, length, max_j, turn, uniq_ML, *indx, *c, *fML, *fM1;
+
+  length  = (int)fc->length;
+  indx    = fc->jindx;
+  uniq_ML = fc->params->model_details.uniq_ML;
+  turn    = fc->params->model_details.min_loop_size;
+  c       = fc->matrices->c;
+  fML     = fc->matrices->fML;
+  fM1     = fc->matrices->fM1;
+
   for (i = length - turn - 1; i >= 1; i--) {
-    for (j = i + turn + 1; j <= length; j++) {
+    /* banded DP matrices only store entries (i, j) with j - i <= band */
+    max_j = (fc->band) ? MIN2(length, i + (int)fc->band) : length;
+
+    if (reuse_row(fc, helper_arrays, i, max_j)) {
+      rotate_aux_arrays(helper_arrays, length);
+      continue;
+    }
+
+    for (j = i + turn + 1; j <= max_j; j++) {
       ij = indx[j] + i;
 
       /* decompose subsegment [i, j] with pair (i, j) */
-      c[ij] = decompose_pair(fc, i, j, helper_arrays);
+      c[ij] = (reuse_pair(helper_arrays, i, j)) ?
+              helper_arrays->ref_mx->c[ij] :
+              decompose_pair(fc, i, j, helper_arrays);
 
       /* decompose subsegment [i, j] that is multibranch loop part with at least one branch */
       fML[ij] = vrna_E_ml_stems_fast(fc, i, j, helper_arrays->Fmi, helper_arrays->DMLi);
@@ -339,19 +546,144 @@ fill_arrays(vrna_fold_compound_t *fc)
     } /* end of j-loop */
 
     rotate_aux_arrays(helper_arrays, length);
-  } /*
-     * end of i-loop
-     * calculate energies of 5' fragments
-     */
-  (void)vrna_E_ext_loop_5(fc);
+  } /* end of i-loop */
+}
 
-  /* clean up memory */
-  free_aux_arrays(helper_arrays);
 
-  return f5[length];
+#ifdef _OPENMP
+
+/*
+ *  Determine the number of threads for the wavefront fill. Returns 1 whenever
+ *  the serial implementation must be used
+ */
+PRIVATE int
+num_fill_threads(vrna_fold_compound_t *fc)
+{
+  int num_threads;
+
+  num_threads = fc->params->model_details.num_threads;
+
+  /* auxiliary grammar callbacks expect the serial (row-wise) fill order */
+  if ((fc->aux_grammar) &&
+      ((fc->aux_grammar->cb_aux) ||
+       (fc->aux_grammar->cb_aux_c) ||
+       (fc->aux_grammar->cb_aux_m) ||
+       (fc->aux_grammar->cb_aux_m1)))
+    return 1;
+
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+
+  return (num_threads > 1) ? num_threads : 1;
 }
 
 
+/*
+ *  Fill the DP matrices c, fML, and fM1 along anti-diagonals, i.e. by
+ *  increasing span d = j - i. All entries of one diagonal only depend on
+ *  entries of smaller span and can therefore be computed concurrently.
+ *  Every entry is evaluated by exactly the same sequence of operations as
+ *  in the serial fill, so the resulting matrices are identical.
+ */
+PRIVATE void
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads)
+{
+  int                   d, length, max_span, turn, uniq_ML, *indx, *c, *fML, *fM1;
+  vrna_kernel_e         kernel;
+  struct aux_wavefront  *wf;
+
+  length  = (int)fc->length;
+  indx    = fc->jindx;
+  uniq_ML = fc->params->model_details.uniq_ML;
+  turn    = fc->params->model_details.min_loop_size;
+  c       = fc->matrices->c;
+  fML     = fc->matrices->fML;
+  fM1     = fc->matrices->fM1;
+  kernel  = fc->kernel;
+
+  /* banded DP matrices only store diagonals up to the band width */
+  max_span  = (fc->band) ? MIN2(length - 1, (int)fc->band) : length - 1;
+  wf        = get_aux_wavefront(length);
+
+#pragma omp parallel num_threads(num_threads) private(d)
+  {
+    int               i, j, k, ij, cc_ij, cc1_ij, dml_ij, dml1[2], dml2[2], *fm_i;
+    struct aux_arrays aux;
+
+    /* row i of fML for the current (i, j), indexed by j */
+    fm_i = (int *)vrna_alloc(sizeof(int) * (length + 2));
+
+    for (d = turn + 1; d <= max_span; d++) {
+#pragma omp for schedule(static)
+      for (i = 1; i <= length - d; i++) {
+        j   = i + d;
+        ij  = indx[j] + i;
+
+        /*
+         *  make the helper arrays look like their row-wise counterparts
+         *  for row i, i.e. cc[j], cc1[j - 1], DMLi[j], DMLi1[j - 2..j - 1],
+         *  and DMLi2[j - 2..j - 1] point to the respective entries
+         */
+        cc_ij   = INF;
+        cc1_ij  = wavefront_diag_get(wf->cc, WF_CC_SLOTS, d - 2, i + 1);
+        dml_ij  = INF;
+        dml1[0] = wavefront_diag_get(wf->dml, WF_DML_SLOTS, d - 3, i + 1);
+        dml1[1] = wavefront_diag_get(wf->dml, WF_DML_SLOTS, d - 2, i + 1);
+        dml2[0] = wavefront_diag_get(wf->dml, WF_DML_SLOTS, d - 4, i + 2);
+        dml2[1] = wavefront_diag_get(wf->dml, WF_DML_SLOTS, d - 3, i + 2);
+
+        /* the multibranch decomposition only reads fML[i, k] with i + turn < k < j - turn - 1 */
+        for (k = i + turn + 1; k < j - turn - 1; k++)
+          fm_i[k] = fML[indx[k] + i];
+
+        aux.cc    = &cc_ij - j;
+        aux.cc1   = &cc1_ij - (j - 1);
+        aux.Fmi   = fm_i;
+        aux.DMLi  = &dml_ij - j;
+        aux.DMLi1 = dml1 - (j - 2);
+        aux.DMLi2 = dml2 - (j - 2);
+
+        switch (kernel) {
+          case VRNA_KERNEL_DEFAULT_D0:
+            c[ij]   = decompose_pair_d0(fc, i, j, &aux);
+            fML[ij] = ml_stems_d0(fc, i, j, aux.Fmi, aux.DMLi);
+            break;
+
+          case VRNA_KERNEL_DEFAULT_D2:
+            c[ij]   = decompose_pair_d2(fc, i, j, &aux);
+            fML[ij] = ml_stems_d2(fc, i, j, aux.Fmi, aux.DMLi);
+            break;
+
+          default:
+            /* decompose subsegment [i, j] with pair (i, j) */
+            c[ij] = decompose_pair(fc, i, j, &aux);
+
+            /* decompose subsegment [i, j] that is multibranch loop part with at least one branch */
+            fML[ij] = vrna_E_ml_stems_fast(fc, i, j, aux.Fmi, aux.DMLi);
+            break;
+        }
+
+        /* decompose subsegment [i, j] that is multibranch loop part with exactly one branch */
+        if (uniq_ML)
+          fM1[ij] = E_ml_rightmost_stem(i, j, fc);
+
+        wf->cc[d % WF_CC_SLOTS][i]    = cc_ij;
+        wf->dml[d % WF_DML_SLOTS][i]  = dml_ij;
+      }
+      /* implicit barrier, diagonal d is complete */
+    }
+
+    free(fm_i);
+  }
+
+  free_aux_wavefront(wf);
+}
+
+
+#endif
+
+
 /* post-processing step for circular RNAs */
 PRIVATE int
 postprocess_circular(vrna_fold_compound_t *fc,
@@ -1850,3 +2182,160 @@ free_aux_arrays(struct aux_arrays *aux)
   free(aux->DMLi2);
   free(aux);
 }
+
+
+/*
+ *  Check whether the DP matrices of the reference fold compound ref may be
+ *  re-used for fc, i.e. whether both were obtained for sequences of the same
+ *  length under the same energy model and use the same matrix layout. Since
+ *  the entries of c only depend on the subsequence they span, this requires
+ *  the absence of any feature that may introduce other dependencies.
+ */
+PRIVATE int
+reuse_compatible(vrna_fold_compound_t *fc,
+                 vrna_fold_compound_t *ref)
+{
+  vrna_md_t md1, md2;
+
+  if ((fc == ref) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (ref->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->length != ref->length) ||
+      (fc->band != ref->band) ||
+      (fc->strands != 1) ||
+      (ref->strands != 1) ||
+      (fc->sc) ||
+      (ref->sc) ||
+      (fc->hc->depot) ||
+      (ref->hc->depot) ||
+      (fc->hc->f) ||
+      (ref->hc->f) ||
+      (fc->domains_up) ||
+      (ref->domains_up) ||
+      (fc->aux_grammar) ||
+      (ref->aux_grammar) ||
+      (!ref->params) ||
+      (!ref->matrices) ||
+      (ref->matrices->type != VRNA_MX_DEFAULT) ||
+      (!ref->matrices->c) ||
+      (!ref->matrices->fML))
+    return 0;
+
+  /* the number of threads and bpp computations do not affect the matrix entries */
+  (void)vrna_md_copy(&md1, &(fc->params->model_details));
+  (void)vrna_md_copy(&md2, &(ref->params->model_details));
+  md1.num_threads = md2.num_threads = 0;
+  md1.compute_bpp = md2.compute_bpp = 0;
+
+  if (memcmp(&md1, &md2, sizeof(vrna_md_t)) != 0)
+    return 0;
+
+  /* the --noLP recursions keep track of stacked pairs that are not stored in any matrix */
+  if ((md1.noLP) || (md1.circ))
+    return 0;
+
+  if ((md1.uniq_ML) && (!ref->matrices->fM1))
+    return 0;
+
+  return 1;
+}
+
+
+/*
+ *  Entry c(i, j) of a sequence that differs from the reference only within
+ *  [ref_start, ref_end] equals the reference entry if [i, j] does not overlap
+ *  the modified positions
+ */
+PRIVATE INLINE int
+reuse_pair(struct aux_arrays  *aux,
+           int                i,
+           int                j)
+{
+  return (aux->ref_mx) && ((j < aux->ref_start) || (i > aux->ref_end));
+}
+
+
+/*
+ *  Copy row i of the matrices c, fML, and fM1 from the reference if the entire
+ *  row is identical. The last two of these rows still need to be evaluated to
+ *  obtain the auxiliary arrays DMLi1 and DMLi2 for row ref_end. Since the
+ *  sequence encoding wraps around, stems (i, n) of fML and fM1 may receive
+ *  a dangling end contribution from the first nucleotide.
+ */
+PRIVATE INLINE int
+reuse_row(vrna_fold_compound_t  *fc,
+          struct aux_arrays     *aux,
+          int                   i,
+          int                   max_j)
+{
+  int j, ij, *indx;
+
+  if ((!aux->ref_mx) || (i <= aux->ref_end + 2) || (aux->ref_start == 1))
+    return 0;
+
+  indx = fc->jindx;
+
+  for (j = i + fc->params->model_details.min_loop_size + 1; j <= max_j; j++) {
+    ij                      = indx[j] + i;
+    fc->matrices->c[ij]     = aux->ref_mx->c[ij];
+    fc->matrices->fML[ij]   = aux->ref_mx->fML[ij];
+    if (fc->params->model_details.uniq_ML)
+      fc->matrices->fM1[ij] = aux->ref_mx->fM1[ij];
+  }
+
+  return 1;
+}
+
+
+#ifdef _OPENMP
+
+PRIVATE INLINE struct aux_wavefront *
+get_aux_wavefront(unsigned int length)
+{
+  unsigned int          i, k;
+  struct aux_wavefront  *aux;
+
+  aux = (struct aux_wavefront *)vrna_alloc(sizeof(struct aux_wavefront));
+
+  for (k = 0; k < WF_CC_SLOTS; k++) {
+    aux->cc[k] = (int *)vrna_alloc(sizeof(int) * (length + 3));
+    for (i = 0; i < length + 3; i++)
+      aux->cc[k][i] = INF;
+  }
+
+  for (k = 0; k < WF_DML_SLOTS; k++) {
+    aux->dml[k] = (int *)vrna_alloc(sizeof(int) * (length + 3));
+    for (i = 0; i < length + 3; i++)
+      aux->dml[k][i] = INF;
+  }
+
+  return aux;
+}
+
+
+PRIVATE INLINE int
+wavefront_diag_get(int  **diag,
+                   int  slots,
+                   int  span,
+                   int  i)
+{
+  return (span < 0) ? INF : diag[span % slots][i];
+}
+
+
+PRIVATE INLINE void
+free_aux_wavefront(struct aux_wavefront *aux)
+{
+  unsigned int k;
+
+  for (k = 0; k < WF_CC_SLOTS; k++)
+    free(aux->cc[k]);
+
+  for (k = 0; k < WF_DML_SLOTS; k++)
+    free(aux->dml[k]);
+
+  free(aux);
+}
+
+
+#endif
@@ -71,6 +71,11 @@
  *  @note This function is polymorphic. It accepts #vrna_fold_compound_t of type
  *        #VRNA_FC_TYPE_SINGLE, and #VRNA_FC_TYPE_COMPARATIVE.
  *
+ *  @note If the model details of the fold compound request more than one thread
+ *        (see #vrna_md_t.num_threads), the DP matrices are filled along anti-diagonals
+ *        in parallel. The resulting matrices are identical to those of the serial
+ *        implementation.
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_fold(), vrna_circfold(),
  *        vrna_fold_compound_comparative(), vrna_alifold(), vrna_circalifold()
  *
@@ -99,6 +104,98 @@ vrna_mfe_dimer(vrna_fold_compound_t *vc,
                char                 *structure);
 
 
+/**
+ *  @brief Compute the minimum free energy and an MFE structure of a long RNA sequence
+ *  without storing the full DP matrix @f$C@f$
+ *
+ *  This function yields the same MFE as vrna_mfe() but does not store the full DP
+ *  matrix @f$C@f$ of base pairs enclosing a substructure. Instead, its rows are
+ *  grouped into blocks of @p interval rows, and only the first few rows of each
+ *  block (the checkpoints) are kept in memory during the fill. The remaining rows
+ *  are recomputed block-wise from the checkpoints whenever the backtracking
+ *  requires them. If @p interval is 0, a value of order @f$\sqrt{n}@f$ is used.
+ *  The same applies to the hard constraints and pair types, which are stored
+ *  row-wise along with @f$C@f$. The matrix @f$M^1@f$ is not required at all.
+ *
+ *  Note, that this is @b not a memory-bounded implementation. The matrix @f$M@f$ of
+ *  multibranch loop components is read column-wise by the multibranch loop
+ *  recursions, i.e. each of its rows remains in use until the fill is complete.
+ *  @f$M@f$ therefore stays fully resident and memory consumption is still
+ *  @f$O(n^2)@f$ (or @f$O(n \cdot L)@f$ for a maximum base pair span @f$L@f$).
+ *  More precisely, the DP matrices occupy about @f$n^2 / 2@f$ integers for @f$M@f$,
+ *  plus @f$O(n \cdot \sqrt{n})@f$ integers for the checkpoints of @f$C@f$, the rows
+ *  of a single recomputed block, and a small cache of recently recomputed blocks.
+ *  Compared to vrna_mfe(), the gain is a constant factor of roughly four, i.e.
+ *  a single integer matrix instead of three, plus the byte-sized hard constraint
+ *  and pair type matrices.
+ *
+ *  A fold compound created for global predictions already allocates the quadratic
+ *  hard constraint and pair type matrices. To avoid them, create @p fc with
+ *  #VRNA_OPTION_WINDOW and a @p window_size of 0 (or the sequence length) in the
+ *  model details instead. The window size is then used as maximum base pair span.
+ *
+ *  Since the recursions proceed from the 3' to the 5' end, a different (but
+ *  equally optimal) structure may be returned than by vrna_mfe() in case of
+ *  degeneracy. No DP matrices are retained in @p fc, so vrna_backtrack5() and
+ *  vrna_backtrack_from_intervals() can not be used to obtain further structures
+ *  afterwards.
+ *
+ *  @note This function is implemented for single sequences without soft constraints,
+ *        user-defined hard constraints, G-Quadruplexes, circular RNAs, and coaxial
+ *        stacking (dangles = 3) only. In all other cases, it falls back to vrna_mfe(),
+ *        or fails for fold compounds created with #VRNA_OPTION_WINDOW.
+ *
+ *  @see  vrna_mfe(), vrna_mfe_window()
+ *
+ *  @param fc             fold compound
+ *  @param structure      A pointer to the character array where the
+ *                        secondary structure in dot-bracket notation will be written to (Maybe NULL)
+ *  @param interval       The number of rows of @f$C@f$ between checkpoints (0 for automatic choice)
+ *
+ *  @return the minimum free energy (MFE) in kcal/mol
+ */
+float
+vrna_mfe_checkpoint(vrna_fold_compound_t  *fc,
+                    char                  *structure,
+                    unsigned int          interval);
+
+
+/**
+ *  @brief Compute the minimum free energy of a sequence variant re-using the DP matrices
+ *  of a reference sequence
+ *
+ *  This function yields the same results as vrna_mfe() for a sequence that differs from the
+ *  sequence of the reference fold compound @p ref only within the positions @p start to
+ *  @p end, e.g. a single point mutant. Since the entries of the matrix @f$C@f$ only depend
+ *  on the subsequence they span, all entries @f$(i,j)@f$ with @f$j < start@f$ or
+ *  @f$i > end@f$ are taken from @p ref instead of being decomposed again.
+ *
+ *  The DP matrices of @p ref must have been filled by a previous call to vrna_mfe(), and
+ *  both fold compounds must share the same model details and sequence length. If this is
+ *  not the case, or either of the fold compounds uses hard constraints other than those
+ *  implied by the sequence itself, soft constraints, unstructured domains, auxiliary
+ *  grammar extensions, the @p noLP or circular model, the function silently falls back to
+ *  the regular recursions of vrna_mfe(). The matrices are always filled by a single thread.
+ *
+ *  @see  vrna_mfe(), vrna_pf_reuse(), vrna_mutational_scan()
+ *
+ *  @param fc             fold compound of the sequence variant
+ *  @param ref            fold compound of the reference sequence with filled DP matrices
+ *  @param start          The first position where the sequences differ (1-based)
+ *  @param end            The last position where the sequences differ (1-based)
+ *  @param structure      A pointer to the character array where the
+ *                        secondary structure in dot-bracket notation will be written to (Maybe NULL)
+ *
+ *  @return the minimum free energy (MFE) in kcal/mol
+ */
+float
+vrna_mfe_reuse(vrna_fold_compound_t *fc,
+               vrna_fold_compound_t *ref,
+               unsigned int         start,
+               unsigned int         end,
+               char                 *structure);
+
+
 /**
  * End basic MFE interface
  * @}
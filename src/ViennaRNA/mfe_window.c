@@ -20,6 +20,7 @@
 #include <limits.h>
 
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/params/constants.h" /* defines MINPSCORE */
 #include "ViennaRNA/fold_vars.h"
@@ -30,6 +31,7 @@
 #include "ViennaRNA/utils/alignments.h"
 #include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/constraints/hard.h"
+#include "ViennaRNA/mfe.h"
 #include "ViennaRNA/mfe_window.h"
 
 
@@ -50,6 +52,11 @@
 
 #define NONE -10000 /* score for forbidden pairs */
 
+#define CHECKPOINT_CACHE_SIZE       2     /* number of recomputed blocks kept during backtracking */
+
+#define STREAM_CHUNK_FACTOR         16    /* segments of streamed sequences span 16 windows */
+#define STREAM_BLOCK_SIZE           65536 /* number of nucleotides pulled from a sequence source at once */
+
 
 typedef struct {
   FILE  *output;
@@ -66,6 +73,70 @@ typedef struct {
 } zscoring_dat;
 #endif
 
+/*
+ *  Auxiliary arrays of the row-wise recursions, see fill_arrays()
+ */
+typedef struct {
+  int *cc;
+  int *cc1;
+  int *Fmi;
+  int *DMLi;
+  int *DMLi1;
+  int *DMLi2;
+  int size;
+} row_aux_arrays;
+
+/*
+ *  Book-keeping for the checkpointed global MFE prediction. The rows of
+ *  the DP matrix c (and the corresponding rows of the pair types and hard
+ *  constraints) are grouped into blocks of block_size rows. Only the first
+ *  depth rows of each block are kept after the fill. These checkpoints are
+ *  sufficient to recompute all other rows of the preceding block.
+ */
+typedef struct {
+  int           block_size;
+  int           depth;
+  int           num_blocks;
+  int           **dml1;     /* DMLi of the first row of each block */
+  int           **dml2;     /* DMLi of the second row of each block */
+  int           **cc;       /* cc of the first row of each block (noLP only) */
+  int           *fML;       /* memory block holding all rows of fML */
+  int           cached[CHECKPOINT_CACHE_SIZE];
+  unsigned int  last_use[CHECKPOINT_CACHE_SIZE];
+  unsigned int  clock;
+} checkpoint_dat;
+
+/*
+ *  State handed over between consecutive segments of a streamed sequence.
+ *  Segments are processed from the 3' to the 5' end. Each segment covers
+ *  the rows [first, last] of the DP matrices that are reported, one more
+ *  nucleotide upstream, and two windows downstream. The downstream rows are
+ *  re-computed to provide the context for backtracking, while the exact
+ *  values of f3 downstream of last are taken from the previous segment.
+ *  All positions are local to the current segment, except for those of the
+ *  pending structure prev, which are global.
+ */
+typedef struct {
+  int     first;
+  int     last;
+  int     shift;
+  int     *f3;        /* f3[last + 1 ... last + f3_num] */
+  int     f3_num;
+  char    *prev;      /* last structure found but not yet reported */
+  int     prev_i;
+  int     prev_j;
+  int     prev_end;
+  int     prev_en;
+  double  prevz;
+} window_carry;
+
+/* callback data of the segments of a streamed sequence */
+typedef struct {
+  vrna_mfe_window_callback  *cb;
+  void                      *data;
+  int                       shift;
+} window_shift;
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -102,7 +173,16 @@ fill_arrays(vrna_fold_compound_t            *vc,
             zscoring_dat                    *z_dat,
             vrna_mfe_window_zscore_callback *cb_z,
 #endif
-            void                            *data);
+            void                            *data,
+            window_carry                    *carry);
+
+
+PRIVATE void
+shift_callback(int        start,
+               int        end,
+               const char *structure,
+               float      en,
+               void       *data);
 
 
 PRIVATE void
@@ -165,6 +245,80 @@ rotate_constraints(vrna_fold_compound_t *fc,
                    int                  i);
 
 
+PRIVATE int
+checkpoint_supported(vrna_fold_compound_t *fc);
+
+
+PRIVATE row_aux_arrays *
+row_aux_init(int size);
+
+
+PRIVATE void
+row_aux_reset(row_aux_arrays *aux);
+
+
+PRIVATE void
+row_aux_rotate(row_aux_arrays *aux);
+
+
+PRIVATE void
+row_aux_free(row_aux_arrays *aux);
+
+
+PRIVATE void
+fill_row(vrna_fold_compound_t *fc,
+         int                  i,
+         row_aux_arrays       *aux);
+
+
+PRIVATE void
+checkpoint_row_init(vrna_fold_compound_t  *fc,
+                    int                   i);
+
+
+PRIVATE void
+checkpoint_row_free(vrna_fold_compound_t  *fc,
+                    int                   i);
+
+
+PRIVATE int
+fill_arrays_checkpoint(vrna_fold_compound_t *fc,
+                       checkpoint_dat       *cp,
+                       row_aux_arrays       *aux);
+
+
+PRIVATE void
+checkpoint_recompute(vrna_fold_compound_t *fc,
+                     checkpoint_dat       *cp,
+                     row_aux_arrays       *aux,
+                     int                  k);
+
+
+PRIVATE void
+checkpoint_require(vrna_fold_compound_t *fc,
+                   checkpoint_dat       *cp,
+                   row_aux_arrays       *aux,
+                   int                  i);
+
+
+PRIVATE int
+ml_first_stem(vrna_fold_compound_t  *fc,
+              int                   i,
+              int                   j);
+
+
+PRIVATE int
+backtrack_checkpoint(vrna_fold_compound_t *fc,
+                     checkpoint_dat       *cp,
+                     row_aux_arrays       *aux,
+                     vrna_bp_stack_t      *bp_stack);
+
+
+PRIVATE void
+checkpoint_free(vrna_fold_compound_t  *fc,
+                checkpoint_dat        *cp);
+
+
 #ifdef VRNA_WITH_SVM
 
 PRIVATE int
@@ -238,9 +392,9 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
   } else {
 #ifdef VRNA_WITH_SVM
     z_dat.with_zsc  = 0;
-    energy          = fill_arrays(vc, &underflow, cb, &z_dat, NULL, data);
+    energy          = fill_arrays(vc, &underflow, cb, &z_dat, NULL, data, NULL);
 #else
-    energy = fill_arrays(vc, &underflow, cb, data);
+    energy = fill_arrays(vc, &underflow, cb, data, NULL);
 #endif
     mfe_local = (underflow > 0) ? ((float)underflow * (float)(UNDERFLOW_CORRECTION)) / 100. : 0.;
     mfe_local += (float)energy / 100.;
@@ -250,6 +404,253 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
 }
 
 
+PUBLIC float
+vrna_mfe_window_source_cb(vrna_md_t                     *md_p,
+                          vrna_sequence_source_callback *source,
+                          void                          *source_data,
+                          vrna_mfe_window_callback      *cb,
+                          void                          *data)
+{
+  char                  *segment;
+  int                   n, k, num, chunk_size, first, last, start, end, energy, underflow,
+                        window_size;
+  unsigned int          l;
+  float                 mfe_local;
+  FILE                  *spool;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  window_carry          carry;
+  window_shift          shift_data;
+
+#ifdef VRNA_WITH_SVM
+  zscoring_dat          z_dat;
+#endif
+
+  if ((!source) || (!cb))
+    return (float)(INF / 100.);
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /*
+   *  The recursions proceed from the 3' to the 5' end, so we keep the
+   *  sequence in a temporary file instead of memory
+   */
+  if (!(spool = tmpfile())) {
+    vrna_message_warning("vrna_mfe_window_source_cb@mfe_window.c: "
+                         "Failed to create temporary file");
+    return (float)(INF / 100.);
+  }
+
+  segment = (char *)vrna_alloc(sizeof(char) * STREAM_BLOCK_SIZE);
+  n       = 0;
+
+  while ((l = source(segment, STREAM_BLOCK_SIZE, source_data)) > 0) {
+    if ((fwrite(segment, sizeof(char), l, spool) != l) ||
+        ((unsigned int)(INT_MAX - n) < l)) {
+      vrna_message_warning("vrna_mfe_window_source_cb@mfe_window.c: "
+                           "Failed to store sequence");
+      free(segment);
+      fclose(spool);
+      return (float)(INF / 100.);
+    }
+
+    n += (int)l;
+  }
+
+  free(segment);
+
+  if (n == 0) {
+    fclose(spool);
+    return (float)(INF / 100.);
+  }
+
+  window_size = ((md.window_size > 0) && (md.window_size < n)) ? md.window_size : n;
+  chunk_size  = STREAM_CHUNK_FACTOR * window_size;
+  num         = (n + chunk_size - 1) / chunk_size;
+  energy      = 0;
+  underflow   = 0;
+
+  shift_data.cb   = cb;
+  shift_data.data = data;
+
+  memset(&carry, 0, sizeof(window_carry));
+
+#ifdef VRNA_WITH_SVM
+  z_dat.with_zsc = 0;
+#endif
+
+  segment = (char *)vrna_alloc(sizeof(char) * (chunk_size + 2 * window_size + 4));
+
+  for (k = num - 1; k >= 0; k--) {
+    first = k * chunk_size + 1;
+    last  = MIN2(first + chunk_size - 1, n);
+    start = MAX2(1, first - 1);
+    end   = MIN2(n, last + 2 * window_size + 2);
+
+    if ((fseek(spool, (long)(start - 1), SEEK_SET) != 0) ||
+        (fread(segment, sizeof(char), end - start + 1, spool) != (size_t)(end - start + 1))) {
+      vrna_message_warning("vrna_mfe_window_source_cb@mfe_window.c: "
+                           "Failed to read stored sequence");
+      energy = INF;
+      break;
+    }
+
+    segment[end - start + 1] = '\0';
+
+    fc = vrna_fold_compound(segment, &md, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+
+    if ((!fc) ||
+        (!vrna_fold_compound_prepare(fc, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW))) {
+      vrna_message_warning("vrna_mfe_window_source_cb@mfe_window.c: "
+                           "Failed to prepare vrna_fold_compound");
+      vrna_fold_compound_free(fc);
+      energy = INF;
+      break;
+    }
+
+    carry.first       = first - start + 1;
+    carry.last        = last - start + 1;
+    carry.shift       = start - 1;
+    shift_data.shift  = start - 1;
+
+#ifdef VRNA_WITH_SVM
+    energy = fill_arrays(fc, &underflow, &shift_callback, &z_dat, NULL, (void *)&shift_data,
+                         &carry);
+#else
+    energy = fill_arrays(fc, &underflow, &shift_callback, (void *)&shift_data, &carry);
+#endif
+
+    vrna_fold_compound_free(fc);
+  }
+
+  free(segment);
+  free(carry.f3);
+  free(carry.prev);
+  fclose(spool);
+
+  if (energy == INF)
+    return (float)(INF / 100.);
+
+  mfe_local = (underflow > 0) ? ((float)underflow * (float)(UNDERFLOW_CORRECTION)) / 100. : 0.;
+  mfe_local += (float)energy / 100.;
+
+  return mfe_local;
+}
+
+
+PUBLIC float
+vrna_mfe_checkpoint(vrna_fold_compound_t  *fc,
+                    char                  *structure,
+                    unsigned int          interval)
+{
+  char                  *ss;
+  int                   n, s, energy, depth;
+  float                 mfe;
+  vrna_md_t             md;
+  vrna_bp_stack_t       *bp;
+  vrna_fold_compound_t  *wfc;
+  checkpoint_dat        *cp;
+  row_aux_arrays        *aux;
+
+  mfe = (float)(INF / 100.);
+
+  if (!fc)
+    return mfe;
+
+  if (!checkpoint_supported(fc)) {
+    /* fold compounds for sliding window predictions lack the matrices for vrna_mfe() */
+    if ((fc->hc) && (fc->hc->type == VRNA_HC_WINDOW)) {
+      vrna_message_warning("vrna_mfe_checkpoint@mfe_window.c: "
+                           "Model settings or constraints not supported");
+      return mfe;
+    }
+
+    vrna_message_warning("vrna_mfe_checkpoint@mfe_window.c: "
+                         "Model settings or constraints not supported, falling back to vrna_mfe()");
+    return vrna_mfe(fc, structure);
+  }
+
+  n   = (int)fc->length;
+  md  = fc->params->model_details;
+
+  /*
+   *  The global recursions are evaluated with the row-wise storage of the
+   *  sliding window implementation. A window that spans the entire sequence
+   *  (or the maximum base pair span) yields the global MFE. The worker fold
+   *  compound only holds window-sized rows of C, the pair types and the hard
+   *  constraints, regardless of how fc was created.
+   */
+  md.window_size  = ((md.max_bp_span > 0) && (md.max_bp_span < n)) ? md.max_bp_span : n;
+  md.max_bp_span  = md.window_size;
+
+  wfc = vrna_fold_compound(fc->sequence, &md, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+  if (!wfc)
+    return mfe;
+
+  /* use the same energy parameters as the original fold compound */
+  vrna_params_subst(wfc, fc->params);
+  wfc->params->model_details.window_size  = md.window_size;
+  wfc->params->model_details.max_bp_span  = md.max_bp_span;
+
+  if (!vrna_fold_compound_prepare(wfc, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW)) {
+    vrna_message_warning("vrna_mfe_checkpoint@mfe_window.c: Failed to prepare vrna_fold_compound");
+    vrna_fold_compound_free(wfc);
+    return mfe;
+  }
+
+  /*
+   *  Each row of c depends on the MAXLOOP + 1 rows below. By default, we
+   *  place checkpoints at a distance that minimizes the number of rows of c
+   *  kept in memory, i.e. sqrt(n * depth / 2). This does not affect fML,
+   *  which is kept entirely, see fill_arrays_checkpoint()
+   */
+  depth = MAXLOOP + 2;
+
+  cp              = (checkpoint_dat *)vrna_alloc(sizeof(checkpoint_dat));
+  cp->depth       = depth;
+  cp->block_size  = (interval > 0) ? (int)interval : (int)sqrt((double)n * depth / 2.);
+  cp->block_size  = MAX2(cp->block_size, 1);
+  cp->num_blocks  = (n - 1) / cp->block_size + 1;
+  cp->dml1        = (int **)vrna_alloc(sizeof(int *) * (cp->num_blocks + 1));
+  cp->dml2        = (int **)vrna_alloc(sizeof(int *) * (cp->num_blocks + 1));
+  cp->cc          = (int **)vrna_alloc(sizeof(int *) * (cp->num_blocks + 1));
+  cp->clock       = 0;
+  for (s = 0; s < CHECKPOINT_CACHE_SIZE; s++) {
+    cp->cached[s]   = -1;
+    cp->last_use[s] = 0;
+  }
+
+  aux = row_aux_init(wfc->window_size + 5);
+
+  energy  = fill_arrays_checkpoint(wfc, cp, aux);
+  mfe     = (float)energy / 100.;
+
+  if (structure && md.backtrack) {
+    /* add a guess of how many G's may be involved in a G quadruplex */
+    bp = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (4 * (1 + n / 2)));
+
+    if (backtrack_checkpoint(wfc, cp, aux, bp) != 0) {
+      ss = vrna_db_from_bp_stack(bp, n);
+      strncpy(structure, ss, n + 1);
+      free(ss);
+    } else {
+      memset(structure, '\0', sizeof(char) * (n + 1));
+    }
+
+    free(bp);
+  }
+
+  row_aux_free(aux);
+  checkpoint_free(wfc, cp);
+  vrna_fold_compound_free(wfc);
+
+  return mfe;
+}
+
+
 #ifdef VRNA_WITH_SVM
 
 PUBLIC float
@@ -295,7 +696,7 @@ vrna_mfe_window_zscore_cb(vrna_fold_compound_t            *vc,
   /* keep track of how many times we were close to an integer underflow */
   underflow = 0;
 
-  energy = fill_arrays(vc, &underflow, NULL, &zsc_data, cb_z, data);
+  energy = fill_arrays(vc, &underflow, NULL, &zsc_data, cb_z, data, NULL);
   svm_free_model_content(zsc_data.avg_model);
   svm_free_model_content(zsc_data.sd_model);
 
@@ -309,6 +710,608 @@ vrna_mfe_window_zscore_cb(vrna_fold_compound_t            *vc,
 #endif
 
 
+PRIVATE int
+checkpoint_supported(vrna_fold_compound_t *fc)
+{
+  vrna_md_t *md;
+
+  md = &(fc->params->model_details);
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands > 1) ||
+      (md->circ) ||
+      (md->gquad) ||
+      (md->dangles == 3) ||
+      (md->backtrack_type != 'F') ||
+      (fc->sc) ||
+      (fc->domains_up) ||
+      (fc->domains_struc) ||
+      (fc->aux_grammar))
+    return 0;
+
+  /* coaxial stacking, G-quadruplexes, and constraints may access arbitrary rows of c */
+  if ((fc->hc) && ((fc->hc->depot) || (fc->hc->f)))
+    return 0;
+
+  return 1;
+}
+
+
+PRIVATE row_aux_arrays *
+row_aux_init(int size)
+{
+  row_aux_arrays *aux;
+
+  aux         = (row_aux_arrays *)vrna_alloc(sizeof(row_aux_arrays));
+  aux->size   = size;
+  aux->cc     = (int *)vrna_alloc(sizeof(int) * size);
+  aux->cc1    = (int *)vrna_alloc(sizeof(int) * size);
+  aux->Fmi    = (int *)vrna_alloc(sizeof(int) * size);
+  aux->DMLi   = (int *)vrna_alloc(sizeof(int) * size);
+  aux->DMLi1  = (int *)vrna_alloc(sizeof(int) * size);
+  aux->DMLi2  = (int *)vrna_alloc(sizeof(int) * size);
+
+  row_aux_reset(aux);
+
+  return aux;
+}
+
+
+PRIVATE void
+row_aux_reset(row_aux_arrays *aux)
+{
+  int j;
+
+  for (j = 0; j < aux->size; j++)
+    aux->cc[j] = aux->cc1[j] = aux->Fmi[j] = aux->DMLi[j] = aux->DMLi1[j] = aux->DMLi2[j] = INF;
+}
+
+
+PRIVATE void
+row_aux_rotate(row_aux_arrays *aux)
+{
+  int j, *FF;
+
+  FF          = aux->DMLi2;
+  aux->DMLi2  = aux->DMLi1;
+  aux->DMLi1  = aux->DMLi;
+  aux->DMLi   = FF;
+  FF          = aux->cc1;
+  aux->cc1    = aux->cc;
+  aux->cc     = FF;
+
+  for (j = 0; j < aux->size; j++)
+    aux->cc[j] = aux->Fmi[j] = aux->DMLi[j] = INF;
+}
+
+
+PRIVATE void
+row_aux_free(row_aux_arrays *aux)
+{
+  free(aux->cc);
+  free(aux->cc1);
+  free(aux->Fmi);
+  free(aux->DMLi);
+  free(aux->DMLi1);
+  free(aux->DMLi2);
+  free(aux);
+}
+
+
+/*
+ *  Fill row i of the "c" and "fML" arrays, same as within fill_arrays()
+ */
+PRIVATE void
+fill_row(vrna_fold_compound_t *fc,
+         int                  i,
+         row_aux_arrays       *aux)
+{
+  char          **ptype;
+  unsigned char hc_decompose;
+  int           j, length, energy, maxdist, **c, **fML, no_close, type, noLP,
+                noGUclosure, turn, new_c, stackEnergy;
+  vrna_md_t     *md;
+  vrna_hc_t     *hc;
+
+  length      = fc->length;
+  ptype       = fc->ptype_local;
+  maxdist     = fc->window_size;
+  md          = &(fc->params->model_details);
+  noLP        = md->noLP;
+  noGUclosure = md->noGUclosure;
+  turn        = md->min_loop_size;
+  hc          = fc->hc;
+  c           = fc->matrices->c_local;
+  fML         = fc->matrices->fML_local;
+
+  for (j = i + turn + 1; j <= length && j <= i + maxdist; j++) {
+    hc_decompose  = hc->matrix_local[i][j - i];
+    type          = vrna_get_ptype_window(i, j, ptype);
+
+    no_close = (((type == 3) || (type == 4)) && noGUclosure);
+
+    if (hc_decompose) {
+      /* we have a pair */
+      new_c       = INF;
+      stackEnergy = INF;
+
+      if (!no_close) {
+        /* check for hairpin loop */
+        energy  = vrna_E_hp_loop(fc, i, j);
+        new_c   = MIN2(new_c, energy);
+
+        /* check for multibranch loops */
+        energy  = vrna_E_mb_loop_fast(fc, i, j, aux->DMLi1, aux->DMLi2);
+        new_c   = MIN2(new_c, energy);
+      }
+
+      /* check for interior loops */
+      energy  = vrna_E_int_loop(fc, i, j);
+      new_c   = MIN2(new_c, energy);
+
+      /* remember stack energy for --noLP option */
+      if (noLP) {
+        stackEnergy     = vrna_E_stack(fc, i, j);
+        new_c           = MIN2(new_c, aux->cc1[j - 1 - (i + 1)] + stackEnergy);
+        aux->cc[j - i]  = new_c;
+        c[i][j - i]     = aux->cc1[j - 1 - (i + 1)] + stackEnergy;
+      } else {
+        c[i][j - i] = new_c;
+      }
+    } else {
+      c[i][j - i] = INF;
+    }
+
+    /* done with c[i,j], now compute fML[i,j] */
+    fML[i][j - i] = vrna_E_ml_stems_fast(fc, i, j, aux->Fmi, aux->DMLi);
+  }
+}
+
+
+/*
+ *  Allocate and initialize row i of c, the pair types and the hard constraints
+ */
+PRIVATE void
+checkpoint_row_init(vrna_fold_compound_t  *fc,
+                    int                   i)
+{
+  int j, size;
+
+  size = MIN2(fc->window_size, (int)fc->length - i) + 5;
+
+  fc->matrices->c_local[i]  = (int *)vrna_alloc(sizeof(int) * size);
+  fc->ptype_local[i]        = (char *)vrna_alloc(sizeof(char) * size);
+  fc->hc->matrix_local[i]   = (unsigned char *)vrna_alloc(sizeof(unsigned char) * size);
+
+  for (j = 0; j < size; j++)
+    fc->matrices->c_local[i][j] = INF;
+
+  make_ptypes(fc, i);
+  vrna_hc_update(fc, i, VRNA_CONSTRAINT_WINDOW_UPDATE_3);
+}
+
+
+PRIVATE void
+checkpoint_row_free(vrna_fold_compound_t  *fc,
+                    int                   i)
+{
+  free(fc->matrices->c_local[i]);
+  free(fc->ptype_local[i]);
+  free(fc->hc->matrix_local[i]);
+
+  fc->matrices->c_local[i]  = NULL;
+  fc->ptype_local[i]        = NULL;
+  fc->hc->matrix_local[i]   = NULL;
+}
+
+
+PRIVATE INLINE int
+is_checkpoint(checkpoint_dat  *cp,
+              int             i)
+{
+  return ((i - 1) % cp->block_size) < cp->depth;
+}
+
+
+PRIVATE INLINE int *
+copy_row(int  *row,
+         int  size)
+{
+  int *r = (int *)vrna_alloc(sizeof(int) * size);
+
+  memcpy(r, row, sizeof(int) * size);
+
+  return r;
+}
+
+
+PRIVATE int
+fill_arrays_checkpoint(vrna_fold_compound_t *fc,
+                       checkpoint_dat       *cp,
+                       row_aux_arrays       *aux)
+{
+  /* fill "c", "fML" and "f3" arrays and keep only the checkpoint rows of "c" */
+  size_t  size;
+  int     i, k, length, turn, noLP, *f3, **fML;
+
+  length  = fc->length;
+  turn    = fc->params->model_details.min_loop_size;
+  noLP    = fc->params->model_details.noLP;
+  f3      = fc->matrices->f3_local;
+  fML     = fc->matrices->fML_local;
+
+  /*
+   *  all rows of fML must be kept, since the multibranch loop decomposition
+   *  of c[i,j] reads column j - 1 of fML for all rows below i. We store them
+   *  consecutively in a single block of memory to improve locality
+   */
+  for (size = 0, i = 1; i <= length; i++)
+    size += MIN2(fc->window_size, length - i) + 5;
+
+  cp->fML = (int *)vrna_alloc(sizeof(int) * size);
+
+  for (size = 0, i = 1; i <= length; i++) {
+    fML[i]  = cp->fML + size;
+    size    += MIN2(fc->window_size, length - i) + 5;
+  }
+
+  for (i = 0; i < (int)size; i++)
+    cp->fML[i] = INF;
+
+  for (i = length; i >= 1; i--) {
+    checkpoint_row_init(fc, i);
+
+    if (i < length - turn) {
+      fill_row(fc, i, aux);
+
+      f3[i] = vrna_E_ext_loop_3(fc, i);
+
+      /* store what's required to resume the recursions from the first rows of a block */
+      k = (i - 1) / cp->block_size;
+      if ((i - 1) % cp->block_size == 0) {
+        cp->dml1[k] = copy_row(aux->DMLi, aux->size);
+        if (noLP)
+          cp->cc[k] = copy_row(aux->cc, aux->size);
+      } else if ((i - 1) % cp->block_size == 1) {
+        cp->dml2[k] = copy_row(aux->DMLi, aux->size);
+      }
+
+      row_aux_rotate(aux);
+    }
+
+    /* remove rows that are neither required for the next row nor checkpoints */
+    if ((i + cp->depth <= length) && (!is_checkpoint(cp, i + cp->depth)))
+      checkpoint_row_free(fc, i + cp->depth);
+  }
+
+  for (i = 1; i <= MIN2(length, cp->depth); i++)
+    if ((fc->matrices->c_local[i]) && (!is_checkpoint(cp, i)))
+      checkpoint_row_free(fc, i);
+
+  return f3[1];
+}
+
+
+/*
+ *  Recompute the non-checkpoint rows of block k from the checkpoint of block k + 1
+ */
+PRIVATE void
+checkpoint_recompute(vrna_fold_compound_t *fc,
+                     checkpoint_dat       *cp,
+                     row_aux_arrays       *aux,
+                     int                  k)
+{
+  int i, top, bottom, length, turn;
+
+  length  = fc->length;
+  turn    = fc->params->model_details.min_loop_size;
+  top     = MIN2(length, (k + 1) * cp->block_size);
+  bottom  = k * cp->block_size + 1 + cp->depth;
+
+  row_aux_reset(aux);
+
+  if (cp->dml1[k + 1])
+    memcpy(aux->DMLi1, cp->dml1[k + 1], sizeof(int) * aux->size);
+
+  if (cp->dml2[k + 1])
+    memcpy(aux->DMLi2, cp->dml2[k + 1], sizeof(int) * aux->size);
+
+  if (cp->cc[k + 1])
+    memcpy(aux->cc1, cp->cc[k + 1], sizeof(int) * aux->size);
+
+  for (i = top; i >= bottom; i--) {
+    checkpoint_row_init(fc, i);
+
+    if (i < length - turn)
+      fill_row(fc, i, aux);
+
+    row_aux_rotate(aux);
+  }
+}
+
+
+/*
+ *  Make sure rows i to i + depth - 1 of c are available, i.e. all rows
+ *  that are accessed when backtracking a (sub-)structure that starts at i
+ */
+PRIVATE void
+checkpoint_require(vrna_fold_compound_t *fc,
+                   checkpoint_dat       *cp,
+                   row_aux_arrays       *aux,
+                   int                  i)
+{
+  int r, l, s, k, last, slot, k_first, k_last;
+
+  last    = MIN2((int)fc->length, i + cp->depth - 1);
+  k_first = (i - 1) / cp->block_size;
+  k_last  = (last - 1) / cp->block_size;
+
+  /* protect the blocks we need from being replaced */
+  for (s = 0; s < CHECKPOINT_CACHE_SIZE; s++)
+    if ((cp->cached[s] >= k_first) && (cp->cached[s] <= k_last))
+      cp->last_use[s] = ++cp->clock;
+
+  for (r = i; r <= last; r++) {
+    if (fc->matrices->c_local[r])
+      continue;
+
+    k = (r - 1) / cp->block_size;
+
+    /* replace the least recently used block */
+    slot = 0;
+    for (s = 1; s < CHECKPOINT_CACHE_SIZE; s++)
+      if (cp->last_use[s] < cp->last_use[slot])
+        slot = s;
+
+    if (cp->cached[slot] >= 0) {
+      s = cp->cached[slot];
+      for (l = s * cp->block_size + 1; (l <= (s + 1) * cp->block_size) && (l <= (int)fc->length); l++)
+        if ((fc->matrices->c_local[l]) && (!is_checkpoint(cp, l)))
+          checkpoint_row_free(fc, l);
+    }
+
+    checkpoint_recompute(fc, cp, aux, k);
+
+    cp->cached[slot]    = k;
+    cp->last_use[slot]  = ++cp->clock;
+  }
+}
+
+
+/*
+ *  Mirror the removal of unpaired bases in vrna_BT_mb_loop_split() to
+ *  determine the first base of the 5'-most stem in fML[i,j]
+ */
+PRIVATE int
+ml_first_stem(vrna_fold_compound_t  *fc,
+              int                   i,
+              int                   j)
+{
+  int ii, jj, fij, fi, MLbase, **fML;
+
+  fML     = fc->matrices->fML_local;
+  MLbase  = fc->params->MLbase;
+  ii      = i;
+  jj      = j;
+
+  do {
+    fij = fML[ii][jj - ii];
+    fi  = MLbase + fML[ii][jj - 1 - ii];
+    if (--jj == 0)
+      break;
+  } while (fij == fi);
+  jj++;
+
+  do {
+    fij = fML[ii][jj - ii];
+    fi  = MLbase + fML[ii + 1][jj - (ii + 1)];
+    if (++ii == jj)
+      break;
+  } while (fij == fi);
+  ii--;
+
+  return ii;
+}
+
+
+PRIVATE int
+backtrack_checkpoint(vrna_fold_compound_t *fc,
+                     checkpoint_dat       *cp,
+                     row_aux_arrays       *aux,
+                     vrna_bp_stack_t      *bp_stack)
+{
+  /*------------------------------------------------------------------
+   *  trace back through the "c", "f3" and "fML" arrays as in backtrack()
+   *  but recompute the rows of "c" that are no longer available
+   *  ------------------------------------------------------------------*/
+  sect          sector[MAXSECTORS]; /* backtracking sectors */
+  char          **ptype;
+  int           i, j, k, p, q, s, b, length, no_close, type, turn, noLP, noGUclosure,
+                **c, *f3, cij, canonical, comp1, comp2;
+  vrna_md_t     *md;
+
+  length      = fc->length;
+  ptype       = fc->ptype_local;
+  md          = &(fc->params->model_details);
+  noLP        = md->noLP;
+  noGUclosure = md->noGUclosure;
+  turn        = md->min_loop_size;
+  c           = fc->matrices->c_local;
+  f3          = fc->matrices->f3_local;
+
+  s = 0;  /* depth of backtracking stack */
+  b = 0;  /* number of base pairs */
+
+  sector[++s].i = 1;
+  sector[s].j   = length;
+  sector[s].ml  = 0;
+
+  while (s > 0) {
+    canonical = 1;     /* (i,j) closes a canonical structure */
+
+    /* pop one element from stack */
+    i   = sector[s].i;
+    j   = sector[s].j;
+    k   = sector[s--].ml;
+
+    if (j < i + turn + 1)
+      continue;                     /* no more pairs in this interval */
+
+    switch (k) {
+      /* backtrack in f3 */
+      case 0:
+        /* skip unpaired 5' bases to find out which rows of c are required */
+        while ((i < j) && (f3[i] == f3[i + 1]))
+          i++;
+
+        if (i > j - turn)
+          continue;
+
+        checkpoint_require(fc, cp, aux, i);
+
+        if (vrna_BT_ext_loop_f3(fc, &i, MIN2(j, i + fc->window_size), &p, &q, bp_stack, &b)) {
+          if (i > 0) {
+            sector[++s].i = i;
+            sector[s].j   = j;
+            sector[s].ml  = 0;
+          }
+
+          if (p > 0) {
+            i = p;
+            j = q;
+            goto repeat1;
+          }
+
+          continue;
+        } else {
+          vrna_message_warning("backtracking failed in f3, segment [%d,%d]\n", i, j);
+          return 0;
+        }
+
+        break;
+
+      /* trace back in fML array */
+      case 1:
+        checkpoint_require(fc, cp, aux, ml_first_stem(fc, i, j));
+
+        if (vrna_BT_mb_loop_split(fc, &i, &j, &p, &q, &comp1, &comp2, bp_stack, &b)) {
+          if (i > 0) {
+            sector[++s].i = i;
+            sector[s].j   = j;
+            sector[s].ml  = comp1;
+          }
+
+          if (p > 0) {
+            sector[++s].i = p;
+            sector[s].j   = q;
+            sector[s].ml  = comp2;
+          }
+
+          continue;
+        } else {
+          vrna_message_warning("backtracking failed in fML, segment [%d,%d]\n", i, j);
+          return 0;
+        }
+
+        break;
+
+      /* backtrack in c */
+      case 2:
+        bp_stack[++b].i = i;
+        bp_stack[b].j   = j;
+        goto repeat1;
+        break;
+
+      default:
+        vrna_message_warning("Backtracking failed due to unrecognized DP matrix!");
+        return 0;
+    }
+
+repeat1:
+
+    /*----- begin of "repeat:" -----*/
+    checkpoint_require(fc, cp, aux, i);
+
+    if (canonical)
+      cij = c[i][j - i];
+
+    if (noLP) {
+      if (vrna_BT_stack(fc, &i, &j, &cij, bp_stack, &b)) {
+        canonical = 0;
+        goto repeat1;
+      }
+    }
+
+    canonical = 1;
+
+    type      = vrna_get_ptype_window(i, j, ptype);
+    no_close  = (((type == 3) || (type == 4)) && noGUclosure);
+
+    if (no_close) {
+      if (cij == FORBIDDEN)
+        continue;
+    } else {
+      if (vrna_BT_hp_loop(fc, i, j, cij, bp_stack, &b))
+        continue;
+    }
+
+    if (vrna_BT_int_loop(fc, &i, &j, cij, bp_stack, &b)) {
+      if (i < 0)
+        continue;
+      else
+        goto repeat1;
+    }
+
+    /* (i.j) must close a multi-loop */
+    if (vrna_BT_mb_loop(fc, &i, &j, &k, cij, &comp1, &comp2)) {
+      sector[++s].i = i;
+      sector[s].j   = k;
+      sector[s].ml  = comp1;
+      sector[++s].i = k + 1;
+      sector[s].j   = j;
+      sector[s].ml  = comp2;
+    } else {
+      vrna_message_warning("backtracking failed in repeat, segment [%d,%d]\n", i, j);
+      return 0;
+    }
+
+    /* end of repeat: --------------------------------------------------*/
+  } /* end of infinite while loop */
+
+  bp_stack[0].i = b;
+
+  return 1;
+}
+
+
+PRIVATE void
+checkpoint_free(vrna_fold_compound_t  *fc,
+                checkpoint_dat        *cp)
+{
+  int i;
+
+  for (i = 1; i <= (int)fc->length; i++) {
+    if (fc->matrices->c_local[i])
+      checkpoint_row_free(fc, i);
+
+    fc->matrices->fML_local[i] = NULL;
+  }
+
+  free(cp->fML);
+
+  for (i = 0; i <= cp->num_blocks; i++) {
+    free(cp->dml1[i]);
+    free(cp->dml2[i]);
+    free(cp->cc[i]);
+  }
+
+  free(cp->dml1);
+  free(cp->dml2);
+  free(cp->cc);
+  free(cp);
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -396,8 +1399,11 @@ free_dp_matrices(vrna_fold_compound_t *fc)
   with_gquad  = fc->params->model_details.gquad;
 
 
-  /* free additional memory for j-dimension */
-  for (i = 0; (i < maxdist + 5) && (i <= length); i++) {
+  /*
+   *  free additional memory for j-dimension, the rows may be shifted by one
+   *  if the recursions stopped early (see window_carry)
+   */
+  for (i = 0; (i <= maxdist + 5) && (i <= length); i++) {
     if (fc->type == VRNA_FC_TYPE_SINGLE) {
       free(fc->ptype_local[i]);
       fc->ptype_local[i] = NULL;
@@ -419,14 +1425,14 @@ free_dp_matrices(vrna_fold_compound_t *fc)
       sc = fc->sc;
       if (sc) {
         if (sc->energy_up) {
-          for (i = 0; (i < maxdist + 5) && (i <= length); i++) {
+          for (i = 0; (i <= maxdist + 5) && (i <= length); i++) {
             free(sc->energy_up[i]);
             sc->energy_up[i] = NULL;
           }
         }
 
         if (sc->energy_bp_local) {
-          for (i = 0; (i < maxdist + 5) && (i <= length); i++) {
+          for (i = 0; (i <= maxdist + 5) && (i <= length); i++) {
             free(sc->energy_bp_local[i]);
             sc->energy_bp_local[i] = NULL;
           }
@@ -589,7 +1595,8 @@ fill_arrays(vrna_fold_compound_t            *vc,
             zscoring_dat                    *zsc_data,
             vrna_mfe_window_zscore_callback *cb_z,
 #endif
-            void                            *data)
+            void                            *data,
+            window_carry                    *carry)
 {
   /* fill "c", "fML" and "f3" arrays and return  optimal energy */
 
@@ -598,7 +1605,7 @@ fill_arrays(vrna_fold_compound_t            *vc,
   int           i, j, length, energy, maxdist, **c, **fML, *f3, no_close,
                 type, with_gquad, dangle_model, noLP, noGUclosure, turn,
                 *cc, *cc1, *Fmi, *DMLi, *DMLi1, *DMLi2, prev_i, prev_j,
-                prev_end, prev_en, new_c, stackEnergy;
+                prev_end, prev_en, new_c, stackEnergy, i_min;
 
 #ifdef VRNA_WITH_SVM
   double        prevz;
@@ -627,6 +1634,24 @@ fill_arrays(vrna_fold_compound_t            *vc,
 #ifdef VRNA_WITH_SVM
   prevz = 0.;
 #endif
+  i_min = 1;
+
+  if (carry) {
+    /* continue with the state of the downstream segment */
+    i_min = carry->first;
+
+    if (carry->prev) {
+      prev        = carry->prev;
+      prev_i      = carry->prev_i - carry->shift;
+      prev_j      = carry->prev_j - carry->shift;
+      prev_end    = carry->prev_end - carry->shift;
+      prev_en     = carry->prev_en;
+#ifdef VRNA_WITH_SVM
+      prevz       = carry->prevz;
+#endif
+      carry->prev = NULL;
+    }
+  }
 
   c   = vc->matrices->c_local;
   fML = vc->matrices->fML_local;
@@ -650,7 +1675,7 @@ fill_arrays(vrna_fold_compound_t            *vc,
   if (with_gquad)
     vrna_gquad_mx_local_update(vc, length - maxdist - 4);
 
-  for (i = length - turn - 1; i >= 1; i--) {
+  for (i = length - turn - 1; i >= i_min; i--) {
     /* i,j in [1..length] */
     for (j = i + turn + 1; j <= length && j <= i + maxdist; j++) {
       hc_decompose  = hc->matrix_local[i][j - i];
@@ -704,9 +1729,15 @@ fill_arrays(vrna_fold_compound_t            *vc,
       fML[i][j - i] = vrna_E_ml_stems_fast(vc, i, j, Fmi, DMLi);
     } /* for (j...) */
 
+    /* the downstream segment already provided f3[j] for all j > last */
+    if ((carry) && (carry->f3) && (i == carry->last))
+      memcpy(f3 + i + 1, carry->f3, sizeof(int) * carry->f3_num);
+
     /* calculate energies of 5' and 3' fragments */
     f3[i] = vrna_E_ext_loop_3(vc, i);
-    {
+
+    /* structures starting downstream of last have been reported already */
+    if ((!carry) || (i <= carry->last)) {
       char *ss = NULL;
 
       if (f3[i] < f3[i + 1]) {
@@ -830,6 +1861,21 @@ fill_arrays(vrna_fold_compound_t            *vc,
     }
   }
 
+  if ((carry) && (i_min > 1)) {
+    /* hand over the state to the upstream segment */
+    carry->prev     = prev;
+    carry->prev_i   = prev_i + carry->shift;
+    carry->prev_j   = prev_j + carry->shift;
+    carry->prev_end = prev_end + carry->shift;
+    carry->prev_en  = prev_en;
+#ifdef VRNA_WITH_SVM
+    carry->prevz    = prevz;
+#endif
+    carry->f3_num   = MIN2(maxdist + 2, length + 2 - i_min);
+    carry->f3       = (int *)vrna_realloc(carry->f3, sizeof(int) * carry->f3_num);
+    memcpy(carry->f3, f3 + i_min, sizeof(int) * carry->f3_num);
+  }
+
   free(cc);
   free(cc1);
   free(Fmi);
@@ -839,7 +1885,7 @@ fill_arrays(vrna_fold_compound_t            *vc,
 
   free_dp_matrices(vc);
 
-  return f3[1];
+  return f3[i_min];
 }
 
 
@@ -1493,6 +2539,20 @@ make_pscores(vrna_fold_compound_t *fc,
 }
 
 
+/* report the structures of a segment in global coordinates */
+PRIVATE void
+shift_callback(int        start,
+               int        end,
+               const char *structure,
+               float      en,
+               void       *data)
+{
+  window_shift *d = (window_shift *)data;
+
+  d->cb(start + d->shift, end + d->shift, structure, en, d->data);
+}
+
+
 PRIVATE void
 default_callback(int        start,
                  int        end,
@@ -114,6 +114,38 @@ vrna_mfe_window_cb(vrna_fold_compound_t     *vc,
                    void                     *data);
 
 
+/**
+ *  @brief Local MFE prediction using a sliding window approach for streamed sequences
+ *
+ *  Same as vrna_mfe_window_cb() but the sequence is retrieved block-wise from the
+ *  @p source callback instead of a #vrna_fold_compound_t. The sequence is kept in a
+ *  temporary file and processed in segments of a few windows from the 3' to the 5' end,
+ *  such that memory consumption only depends on the window size but not on the sequence
+ *  length. Since the exterior loop energies are handed over between consecutive segments,
+ *  the structures, their order, and the return value are identical to those of
+ *  vrna_mfe_window_cb() for the entire sequence.
+ *
+ *  @note   Neither constraints nor comparative predictions are supported. The sequence
+ *          is used as provided by @p source, i.e. it must already be converted to upper
+ *          case RNA alphabet if necessary.
+ *
+ *  @see  vrna_mfe_window_cb(), vrna_file_fasta_read_block(), #vrna_sequence_source_callback
+ *
+ *  @param  md_p          The model details to use (maybe NULL for default settings)
+ *  @param  source        The callback that provides the sequence
+ *  @param  source_data   An arbitrary data pointer passed through to @p source
+ *  @param  cb            The callback that receives the locally optimal structures
+ *  @param  data          An arbitrary data pointer passed through to @p cb
+ *  @return               The minimum free energy of the entire sequence
+ */
+float
+vrna_mfe_window_source_cb(vrna_md_t                     *md_p,
+                          vrna_sequence_source_callback *source,
+                          void                          *source_data,
+                          vrna_mfe_window_callback      *cb,
+                          void                          *data);
+
+
 #ifdef VRNA_WITH_SVM
 /**
  *  @brief Local MFE prediction using a sliding window approach (with z-score cut-off)
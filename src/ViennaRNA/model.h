@@ -157,6 +157,20 @@ typedef struct vrna_md_s vrna_md_t;
 #define VRNA_MODEL_DEFAULT_PF_SMOOTH      1
 
 
+/**
+ *  @brief  Default number of threads used to fill the dynamic programming matrices
+ *  @see    #vrna_md_t.num_threads, vrna_md_defaults_reset(), vrna_md_set_default()
+ */
+#define VRNA_MODEL_DEFAULT_NUM_THREADS    1
+
+
+/**
+ *  @brief  Default model behavior for adaptive scaling of Boltzmann factors in partition function computations
+ *  @see    #vrna_md_t.pf_adaptive, vrna_md_defaults_reset(), vrna_md_set_default()
+ */
+#define VRNA_MODEL_DEFAULT_PF_ADAPTIVE    0
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 #ifndef MAXALPHA
@@ -233,6 +247,29 @@ struct vrna_md_s {
   int     rtype[8];                         /**<  @brief  Reverse base pair type array */
   short   alias[MAXALPHA + 1];              /**<  @brief  alias of an integer nucleotide representation */
   int     pair[MAXALPHA + 1][MAXALPHA + 1]; /**<  @brief  Integer representation of a base pair */
+  int     num_threads;                      /**<  @brief  Number of threads used to fill the dynamic programming matrices
+                                             *
+                                             *    A value of 1 (default) selects the serial implementation. Any
+                                             *    other value activates the wavefront parallel fill of the
+                                             *    global recursions, where all sub-segments @f$ [i:j] @f$
+                                             *    with equal span @f$ j - i @f$ are processed concurrently. A
+                                             *    value of 0 lets the OpenMP runtime decide on the number of
+                                             *    threads.
+                                             *    @note This setting has no effect if RNAlib was compiled without
+                                             *          OpenMP support. User-defined hard- and soft-constraint
+                                             *          callbacks must be thread-safe to be used with more than
+                                             *          one thread.
+                                             */
+  int     pf_adaptive;                      /**<  @brief  Adapt the scaling factor of Boltzmann weights during partition function computations
+                                             *
+                                             *    If non-zero, the per-nucleotide scaling factor
+                                             *    #vrna_exp_param_t.pf_scale is adjusted whenever the partition
+                                             *    functions of the sub-segments filled so far approach the limits
+                                             *    of the floating point range. All entries computed before are
+                                             *    re-scaled accordingly, so over- and underflows are avoided
+                                             *    without an accurate initial estimate of @p pf_scale, e.g. from
+                                             *    a preceding MFE prediction.
+                                             */
 };
 
 
@@ -742,6 +779,42 @@ double
 vrna_md_defaults_sfact_get(void);
 
 
+/**
+ *  @brief  Set the default number of threads used to fill the dynamic programming matrices
+ *  @see vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_NUM_THREADS
+ *  @param  num_threads   The number of threads (1 = serial, 0 = OpenMP default)
+ */
+void
+vrna_md_defaults_num_threads(int num_threads);
+
+
+/**
+ *  @brief  Get the default number of threads used to fill the dynamic programming matrices
+ *  @see vrna_md_defaults_num_threads(), vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_NUM_THREADS
+ *  @return The global default number of threads
+ */
+int
+vrna_md_defaults_num_threads_get(void);
+
+
+/**
+ *  @brief  Set default behavior for adaptive scaling of Boltzmann factors in partition function computations
+ *  @see vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_PF_ADAPTIVE
+ *  @param  flag  Adapt the scaling factor during the computations (0 = off, 1 = on)
+ */
+void
+vrna_md_defaults_pf_adaptive(int flag);
+
+
+/**
+ *  @brief  Get default behavior for adaptive scaling of Boltzmann factors in partition function computations
+ *  @see vrna_md_defaults_pf_adaptive(), vrna_md_defaults_reset(), vrna_md_set_default(), #vrna_md_t, #VRNA_MODEL_DEFAULT_PF_ADAPTIVE
+ *  @return The global default settings for adaptive scaling
+ */
+int
+vrna_md_defaults_pf_adaptive_get(void);
+
+
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 #define model_detailsT        vrna_md_t               /* restore compatibility of struct rename */
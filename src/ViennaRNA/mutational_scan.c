@@ -0,0 +1,369 @@
+/*
+ *  Predict all single point mutants of a sequence
+ *
+ *  Each worker thread re-uses a single fold compound for all mutants it
+ *  processes, and the DP matrices of the reference sequence are shared
+ *  among all threads to skip the decomposition of unaffected segments.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/mfe.h"
+#include "ViennaRNA/part_func.h"
+#include "ViennaRNA/equilibrium_probs.h"
+#include "ViennaRNA/datastructures/stream_output.h"
+#include "ViennaRNA/mutational_scan.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ *  Base pair probabilities below threshold * BPP_CUTOFF_RATIO are not
+ *  computed, which bounds the error of the reported differences accordingly
+ */
+#define BPP_CUTOFF_RATIO  0.1
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+struct scan_output {
+  vrna_callback_mutational_scan *cb;
+  void                          *data;
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE vrna_mutant_t *
+predict_mutant(vrna_fold_compound_t *fc,
+               vrna_fold_compound_t *ref,
+               vrna_md_t            *md,
+               unsigned int         position,
+               char                 nucleotide,
+               unsigned int         options,
+               double               threshold,
+               vrna_ep_t            *ref_pairs);
+
+
+PRIVATE vrna_ep_t *
+pairs_changed(vrna_ep_t *ref_pairs,
+              vrna_ep_t *pairs,
+              double    threshold);
+
+
+PRIVATE void
+output_mutant(void          *auxdata,
+              unsigned int  i,
+              void          *data);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC unsigned int
+vrna_mutational_scan(vrna_fold_compound_t           *fc,
+                     unsigned int                   options,
+                     double                         threshold,
+                     vrna_callback_mutational_scan  *cb,
+                     void                           *data)
+{
+  char                *nucleotides, *c;
+  unsigned int        n, p, m, num_mutants, next, *positions;
+  int                 num_threads;
+  double              mfe;
+  vrna_md_t           md;
+  vrna_ep_t           *ref_pairs;
+  vrna_ostream_t      queue;
+  struct scan_output  output;
+
+  if ((!fc) || (!cb))
+    return 0;
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) || (fc->strands != 1)) {
+    vrna_message_warning("vrna_mutational_scan@mutational_scan.c: "
+                         "Only single sequences are supported");
+    return 0;
+  }
+
+  if ((fc->sc) || (fc->hc->depot) || (fc->hc->f) || (fc->domains_up) || (fc->aux_grammar))
+    vrna_message_warning("vrna_mutational_scan@mutational_scan.c: "
+                         "Constraints, unstructured domains, and grammar extensions "
+                         "are not applied to the mutants");
+
+  /* base pair probabilities require the partition function, which requires the MFE for proper scaling */
+  options &= VRNA_MUTSCAN_MFE | VRNA_MUTSCAN_PF | VRNA_MUTSCAN_BPP;
+  if (options & VRNA_MUTSCAN_BPP)
+    options |= VRNA_MUTSCAN_PF;
+
+  if ((options & VRNA_MUTSCAN_PF) || (!options))
+    options |= VRNA_MUTSCAN_MFE;
+
+  n         = fc->length;
+  ref_pairs = NULL;
+
+  /* fill the DP matrices of the reference */
+  mfe = (double)vrna_mfe(fc, NULL);
+
+  if (options & VRNA_MUTSCAN_PF) {
+    vrna_exp_params_rescale(fc, &mfe);
+    (void)vrna_pf(fc, NULL);
+
+    if (options & VRNA_MUTSCAN_BPP) {
+      ref_pairs = vrna_pairing_probs_sparse(fc,
+                                            threshold * BPP_CUTOFF_RATIO,
+                                            VRNA_PROBS_SPARSE_PRUNE_DEFAULT);
+      if (!ref_pairs)
+        options &= ~VRNA_MUTSCAN_BPP;
+    }
+  }
+
+  /* the mutants are predicted by single threads with otherwise identical model details */
+  md              = fc->params->model_details;
+  num_threads     = md.num_threads;
+  md.num_threads  = 1;
+  md.compute_bpp  = 0;
+
+  /* enumerate all single point mutants */
+  positions   = (unsigned int *)vrna_alloc(sizeof(unsigned int) * 4 * n);
+  nucleotides = (char *)vrna_alloc(sizeof(char) * 4 * n);
+  num_mutants = 0;
+
+  for (p = 1; p <= n; p++)
+    for (c = "ACGU"; *c; c++) {
+      if ((*c == toupper(fc->sequence[p - 1])) ||
+          ((*c == 'U') && (toupper(fc->sequence[p - 1]) == 'T')))
+        continue;
+
+      positions[num_mutants]    = p;
+      nucleotides[num_mutants]  = *c;
+      num_mutants++;
+    }
+
+  output.cb   = cb;
+  output.data = data;
+  queue       = vrna_ostream_init(&output_mutant, (void *)&output);
+  next        = 0;
+
+#ifdef _OPENMP
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+
+  if (num_threads > (int)num_mutants)
+    num_threads = (int)num_mutants;
+
+  if (num_threads < 1)
+    num_threads = 1;
+
+#pragma omp parallel num_threads(num_threads) private(m)
+#endif
+  {
+    vrna_fold_compound_t  *worker;
+    vrna_mutant_t         *mutant;
+
+    worker = vrna_fold_compound(fc->sequence,
+                                &md,
+                                (options & VRNA_MUTSCAN_PF) ?
+                                VRNA_OPTION_MFE | VRNA_OPTION_PF :
+                                VRNA_OPTION_MFE);
+
+    while (worker) {
+      /* output slots must be requested in ascending order */
+#ifdef _OPENMP
+#pragma omp critical (mutational_scan_next)
+#endif
+      {
+        m = next++;
+        if (m < num_mutants)
+          vrna_ostream_request(queue, m);
+      }
+
+      if (m >= num_mutants)
+        break;
+
+      mutant = predict_mutant(worker,
+                              fc,
+                              &md,
+                              positions[m],
+                              nucleotides[m],
+                              options,
+                              threshold,
+                              ref_pairs);
+
+      vrna_ostream_provide(queue, m, (void *)mutant);
+    }
+
+    vrna_fold_compound_free(worker);
+  }
+
+  /* flush remaining results */
+  vrna_ostream_free(queue);
+
+  free(ref_pairs);
+  free(positions);
+  free(nucleotides);
+
+  return num_mutants;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE vrna_mutant_t *
+predict_mutant(vrna_fold_compound_t *fc,
+               vrna_fold_compound_t *ref,
+               vrna_md_t            *md,
+               unsigned int         position,
+               char                 nucleotide,
+               unsigned int         options,
+               double               threshold,
+               vrna_ep_t            *ref_pairs)
+{
+  char          *sequence;
+  vrna_ep_t     *pairs;
+  vrna_mutant_t *mutant;
+
+  mutant              = (vrna_mutant_t *)vrna_alloc(sizeof(vrna_mutant_t));
+  mutant->position    = position;
+  mutant->nucleotide  = nucleotide;
+  mutant->mfe         = (float)(INF / 100.);
+  mutant->ens_en      = (float)(INF / 100.);
+
+  sequence                = strdup(ref->sequence);
+  sequence[position - 1]  = nucleotide;
+
+  if (vrna_fold_compound_reset_sequence(fc, sequence, md)) {
+    mutant->structure = (md->backtrack) ?
+                        (char *)vrna_alloc(sizeof(char) * (fc->length + 1)) :
+                        NULL;
+
+    mutant->mfe = vrna_mfe_reuse(fc, ref, position, position, mutant->structure);
+
+    if (options & VRNA_MUTSCAN_PF) {
+      /* the reference matrices may only be re-used with the same scaling factor */
+      fc->exp_params->pf_scale = ref->exp_params->pf_scale;
+      vrna_exp_params_rescale(fc, NULL);
+
+      mutant->ens_en = vrna_pf_reuse(fc, ref, position, position, NULL);
+
+      if (options & VRNA_MUTSCAN_BPP) {
+        pairs = vrna_pairing_probs_sparse(fc,
+                                          threshold * BPP_CUTOFF_RATIO,
+                                          VRNA_PROBS_SPARSE_PRUNE_DEFAULT);
+        if (pairs) {
+          mutant->pairs = pairs_changed(ref_pairs, pairs, threshold);
+          free(pairs);
+        }
+      }
+    }
+  }
+
+  free(sequence);
+
+  return mutant;
+}
+
+
+/*
+ *  Merge two lists of base pair probabilities, both sorted by i and j,
+ *  and keep all pairs whose probability differs by at least threshold
+ */
+PRIVATE vrna_ep_t *
+pairs_changed(vrna_ep_t *ref_pairs,
+              vrna_ep_t *pairs,
+              double    threshold)
+{
+  unsigned int  num, size;
+  int           i, j;
+  double        p;
+  vrna_ep_t     *a, *b, *changed;
+
+  num     = 0;
+  size    = 16;
+  changed = (vrna_ep_t *)vrna_alloc(sizeof(vrna_ep_t) * (size + 1));
+
+  a = ref_pairs;
+  b = pairs;
+
+  while (((a) && (a->i > 0)) || ((b) && (b->i > 0))) {
+    if ((!b) || (b->i == 0) ||
+        ((a) && (a->i > 0) && ((a->i < b->i) || ((a->i == b->i) && (a->j < b->j))))) {
+      i = a->i;
+      j = a->j;
+      p = -a->p;
+      a++;
+    } else if ((!a) || (a->i == 0) || (b->i < a->i) || ((b->i == a->i) && (b->j < a->j))) {
+      i = b->i;
+      j = b->j;
+      p = b->p;
+      b++;
+    } else {
+      i = a->i;
+      j = a->j;
+      p = b->p - a->p;
+      a++;
+      b++;
+    }
+
+    if ((p >= threshold) || (-p >= threshold)) {
+      if (num == size) {
+        size    *= 2;
+        changed = (vrna_ep_t *)vrna_realloc(changed, sizeof(vrna_ep_t) * (size + 1));
+      }
+
+      changed[num].i    = i;
+      changed[num].j    = j;
+      changed[num].p    = (float)p;
+      changed[num].type = VRNA_PLIST_TYPE_BASEPAIR;
+      num++;
+    }
+  }
+
+  changed[num].i    = 0;
+  changed[num].j    = 0;
+  changed[num].p    = 0.;
+  changed[num].type = 0;
+
+  return (vrna_ep_t *)vrna_realloc(changed, sizeof(vrna_ep_t) * (num + 1));
+}
+
+
+PRIVATE void
+output_mutant(void          *auxdata,
+              unsigned int  i,
+              void          *data)
+{
+  struct scan_output  *output;
+  vrna_mutant_t       *mutant;
+
+  output  = (struct scan_output *)auxdata;
+  mutant  = (vrna_mutant_t *)data;
+
+  if (mutant) {
+    output->cb(mutant, output->data);
+
+    free(mutant->structure);
+    free(mutant->pairs);
+    free(mutant);
+  }
+}
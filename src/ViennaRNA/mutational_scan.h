@@ -0,0 +1,120 @@
+#ifndef VIENNA_RNA_PACKAGE_MUTATIONAL_SCAN_H
+#define VIENNA_RNA_PACKAGE_MUTATIONAL_SCAN_H
+
+#include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/fold_compound.h>
+
+/**
+ *  @file     mutational_scan.h
+ *  @ingroup  mfe_global, part_func_global
+ *  @brief    Predict MFE, ensemble free energy, and base pair probability changes for all
+ *            single point mutants of a sequence
+ */
+
+/**
+ *  @addtogroup mfe_global
+ *  @{
+ */
+
+/**
+ *  @brief  Option flag for vrna_mutational_scan() to compute the MFE (and MFE structure) of each mutant
+ */
+#define VRNA_MUTSCAN_MFE    1U
+
+/**
+ *  @brief  Option flag for vrna_mutational_scan() to compute the ensemble free energy of each mutant
+ */
+#define VRNA_MUTSCAN_PF     2U
+
+/**
+ *  @brief  Option flag for vrna_mutational_scan() to report the base pairs whose probability changes
+ */
+#define VRNA_MUTSCAN_BPP    4U
+
+/**
+ *  @brief  Typename for the results of a single point mutant, see #vrna_mutant_s
+ */
+typedef struct vrna_mutant_s vrna_mutant_t;
+
+
+/**
+ *  @brief  The results for a single point mutant as reported by vrna_mutational_scan()
+ */
+struct vrna_mutant_s {
+  unsigned int  position;   /**<  @brief  The mutated position (1-based) */
+  char          nucleotide; /**<  @brief  The nucleotide at the mutated position */
+  float         mfe;        /**<  @brief  The minimum free energy in kcal/mol (#INF / 100. on failure) */
+  char          *structure; /**<  @brief  The MFE structure in dot-bracket notation (NULL without backtracking) */
+  float         ens_en;     /**<  @brief  The ensemble free energy in kcal/mol (only with #VRNA_MUTSCAN_PF) */
+  vrna_ep_t     *pairs;     /**<  @brief  The base pairs with changed probability (only with #VRNA_MUTSCAN_BPP),
+                             *            where the member @p p holds the difference of the mutant's and
+                             *            the reference probability. The list is sorted by @p i and @p j and
+                             *            terminated by an entry with @p i = @p j = 0
+                             */
+};
+
+
+/**
+ *  @brief  Callback to receive the results of a single point mutant from vrna_mutational_scan()
+ *
+ *  The results, including the structure and list of pairs, are owned by vrna_mutational_scan()
+ *  and released once the callback returns.
+ *
+ *  @param  mutant  The results for the mutant
+ *  @param  data    The auxiliary data passed to vrna_mutational_scan()
+ */
+typedef void (vrna_callback_mutational_scan)(const vrna_mutant_t *mutant,
+                                             void                *data);
+
+
+/**
+ *  @brief  Predict all single point mutants of a sequence
+ *
+ *  This function substitutes each position of the sequence in @p fc by each of the three
+ *  other nucleotides of the alphabet @p ACGU and computes the MFE, ensemble free energy, and
+ *  changes in the base pair probabilities of the resulting @f$3n@f$ mutants, as specified by
+ *  the @p options:
+ *  * #VRNA_MUTSCAN_MFE - compute the MFE (and an MFE structure if backtracking is enabled)
+ *  * #VRNA_MUTSCAN_PF  - compute the ensemble free energy, this implies #VRNA_MUTSCAN_MFE
+ *  * #VRNA_MUTSCAN_BPP - report all base pairs whose probability differs by at least
+ *                        @p threshold from the reference, this implies #VRNA_MUTSCAN_PF
+ *
+ *  First, the DP matrices of @p fc are filled for the reference sequence, where the scaling
+ *  factor of the Boltzmann weights is derived from the reference MFE. Since a mutation at
+ *  position @f$p@f$ does not affect any substructure on a segment @f$[i,j]@f$ with
+ *  @f$j < p@f$ or @f$i > p@f$, the mutants are then predicted with vrna_mfe_reuse() and
+ *  vrna_pf_reuse(), which take the corresponding entries from the reference matrices. Base
+ *  pair probabilities of reference and mutants are obtained from vrna_pairing_probs_sparse()
+ *  with a probability cutoff of @f$\mathrm{threshold} / 10@f$.
+ *
+ *  The mutants are distributed over #vrna_md_t.num_threads threads (if RNAlib was compiled
+ *  with OpenMP support), each of which re-uses a single #vrna_fold_compound_t with the model
+ *  details of @p fc. Regardless of the number of threads, the callback @p cb is executed
+ *  for one mutant at a time, ordered by position and nucleotide.
+ *
+ *  @note This function only supports single sequences. Soft constraints, unstructured
+ *        domains, auxiliary grammar extensions, and hard constraints other than those
+ *        implied by the sequence are not transferred to the mutants.
+ *
+ *  @see  vrna_mfe_reuse(), vrna_pf_reuse(), vrna_pairing_probs_sparse(), vrna_fold_batch()
+ *
+ *  @param  fc          The fold compound of the reference sequence
+ *  @param  options     The computations to perform (#VRNA_MUTSCAN_MFE, #VRNA_MUTSCAN_PF, and/or #VRNA_MUTSCAN_BPP)
+ *  @param  threshold   The minimum change of a base pair probability to be reported
+ *  @param  cb          The callback that receives the results of each mutant
+ *  @param  data        Auxiliary data passed through to the callback @p cb
+ *  @return             The number of mutants processed (0 on error)
+ */
+unsigned int
+vrna_mutational_scan(vrna_fold_compound_t           *fc,
+                     unsigned int                   options,
+                     double                         threshold,
+                     vrna_callback_mutational_scan  *cb,
+                     void                           *data);
+
+
+/**
+ * @}
+ */
+
+#endif
@@ -363,6 +363,34 @@ vrna_exp_params_reset(vrna_fold_compound_t  *vc,
                       vrna_md_t             *md_p);
 
 
+/**
+ *  @brief  Re-compute the free energy parameters and Boltzmann factors of a
+ *          #vrna_fold_compound_t for a different temperature in place
+ *
+ *  In contrast to vrna_params_reset(), this function neither frees nor allocates
+ *  any memory. The energy parameters and, if present, the Boltzmann factors attached
+ *  to @p fc are re-computed from the free energies at 37 deg C and the corresponding
+ *  enthalpies, and the temperature of their model details is changed to @p temperature.
+ *  The scaling factor #vrna_exp_param_t.pf_scale is kept, but the scaling helper arrays
+ *  of the partition function DP matrices are updated accordingly. Since the optimal
+ *  scaling factor depends on the temperature, callers usually want to adjust it with
+ *  vrna_exp_params_rescale() before the next partition function computation.
+ *
+ *  @note Boltzmann weights of soft constraints of single sequences are re-computed
+ *        upon the next partition function computation, while those of alignments and
+ *        of user-defined soft constraint callbacks are not affected by this function.
+ *
+ *  @see vrna_params_reset(), vrna_exp_params_rescale(), vrna_heat_capacity()
+ *
+ *  @param  fc          The fold compound data structure
+ *  @param  temperature The new temperature in deg C
+ *  @return             1 on success, 0 otherwise
+ */
+int
+vrna_params_set_temperature(vrna_fold_compound_t  *fc,
+                            double                temperature);
+
+
 void
 vrna_params_prepare(vrna_fold_compound_t  *vc,
                     unsigned int          options);
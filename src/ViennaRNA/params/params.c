@@ -18,6 +18,7 @@
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/constraints/soft.h"
 
 /**
  *** \file ViennaRNA/params/basic.c
@@ -106,17 +107,35 @@ PRIVATE vrna_param_t *
 get_scaled_params(vrna_md_t *md);
 
 
+PRIVATE void
+fill_scaled_params(vrna_param_t *params,
+                   vrna_md_t    *md);
+
+
 PRIVATE vrna_exp_param_t *
 get_scaled_exp_params(vrna_md_t *md,
                       double    pfs);
 
 
+PRIVATE void
+fill_scaled_exp_params(vrna_exp_param_t *pf,
+                       vrna_md_t        *md,
+                       double           pfs);
+
+
 PRIVATE vrna_exp_param_t *
 get_exp_params_ali(vrna_md_t    *md,
                    unsigned int n_seq,
                    double       pfs);
 
 
+PRIVATE void
+fill_exp_params_ali(vrna_exp_param_t  *pf,
+                    vrna_md_t         *md,
+                    unsigned int      n_seq,
+                    double            pfs);
+
+
 PRIVATE void
 rescale_params(vrna_fold_compound_t *vc);
 
@@ -391,6 +410,51 @@ vrna_params_prepare(vrna_fold_compound_t  *fc,
 }
 
 
+PUBLIC int
+vrna_params_set_temperature(vrna_fold_compound_t  *fc,
+                            double                temperature)
+{
+  vrna_md_t md;
+
+  if ((!fc) || (!fc->params))
+    return 0;
+
+  switch (fc->type) {
+    case VRNA_FC_TYPE_SINGLE:     /* fall through */
+
+    case VRNA_FC_TYPE_COMPARATIVE:
+      break;
+
+    default:
+      return 0;
+  }
+
+  /* both parameter sets are updated to keep their model details in sync, see vrna_params_prepare() */
+  md              = fc->params->model_details;
+  md.temperature  = temperature;
+  fill_scaled_params(fc->params, &md);
+
+  if (fc->exp_params) {
+    md              = fc->exp_params->model_details;
+    md.temperature  = temperature;
+
+    if (fc->type == VRNA_FC_TYPE_SINGLE)
+      fill_scaled_exp_params(fc->exp_params, &md, fc->exp_params->pf_scale);
+    else
+      fill_exp_params_ali(fc->exp_params, &md, fc->n_seq, fc->exp_params->pf_scale);
+
+    /* update the helper arrays for scaling, since expMLbase changed */
+    rescale_params(fc);
+
+    /* the Boltzmann weights of soft constraints depend on the temperature as well */
+    if ((fc->type == VRNA_FC_TYPE_SINGLE) && (fc->sc))
+      vrna_sc_update(fc, 0, VRNA_OPTION_PF);
+  }
+
+  return 1;
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
@@ -399,12 +463,23 @@ vrna_params_prepare(vrna_fold_compound_t  *fc,
 PRIVATE vrna_param_t *
 get_scaled_params(vrna_md_t *md)
 {
-  unsigned int  i, j, k, l;
-  double        tempf;
-  vrna_param_t  *params;
+  vrna_param_t *params;
 
   params = (vrna_param_t *)vrna_alloc(sizeof(vrna_param_t));
 
+  fill_scaled_params(params, md);
+
+  return params;
+}
+
+
+PRIVATE void
+fill_scaled_params(vrna_param_t *params,
+                   vrna_md_t    *md)
+{
+  unsigned int  i, j, k, l;
+  double        tempf;
+
   memset(params->param_file, '\0', 256);
   if (last_parameter_file() != NULL)
     strncpy(params->param_file, last_parameter_file(), 255);
@@ -550,7 +625,6 @@ get_scaled_params(vrna_md_t *md)
   strncpy(params->Hexaloops, Hexaloops, 361);
 
   params->id = ++id;
-  return params;
 }
 
 
@@ -558,14 +632,26 @@ PRIVATE vrna_exp_param_t *
 get_scaled_exp_params(vrna_md_t *md,
                       double    pfs)
 {
-  unsigned int      i, j, k, l;
-  int               pf_smooth;
-  double            kT, TT;
-  double            GT;
-  vrna_exp_param_t  *pf;
+  vrna_exp_param_t *pf;
 
   pf = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
 
+  fill_scaled_exp_params(pf, md, pfs);
+
+  return pf;
+}
+
+
+PRIVATE void
+fill_scaled_exp_params(vrna_exp_param_t *pf,
+                       vrna_md_t        *md,
+                       double           pfs)
+{
+  unsigned int  i, j, k, l;
+  int           pf_smooth;
+  double        kT, TT;
+  double        GT;
+
   memset(pf->param_file, '\0', 256);
   if (last_parameter_file() != NULL)
     strncpy(pf->param_file, last_parameter_file(), 255);
@@ -732,8 +818,6 @@ get_scaled_exp_params(vrna_md_t *md,
   strncpy(pf->Tetraloops, Tetraloops, 281);
   strncpy(pf->Triloops, Triloops, 241);
   strncpy(pf->Hexaloops, Hexaloops, 361);
-
-  return pf;
 }
 
 
@@ -741,15 +825,29 @@ PRIVATE vrna_exp_param_t *
 get_exp_params_ali(vrna_md_t    *md,
                    unsigned int n_seq,
                    double       pfs)
+{
+  vrna_exp_param_t *pf;
+
+  pf = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
+
+  fill_exp_params_ali(pf, md, n_seq, pfs);
+
+  return pf;
+}
+
+
+PRIVATE void
+fill_exp_params_ali(vrna_exp_param_t  *pf,
+                    vrna_md_t         *md,
+                    unsigned int      n_seq,
+                    double            pfs)
 {
   /* scale energy parameters and pre-calculate Boltzmann weights */
-  unsigned int      i, j, k, l;
-  int               pf_smooth;
-  double            kTn, TT;
-  double            GT;
-  vrna_exp_param_t  *pf;
+  unsigned int  i, j, k, l;
+  int           pf_smooth;
+  double        kTn, TT;
+  double        GT;
 
-  pf                = (vrna_exp_param_t *)vrna_alloc(sizeof(vrna_exp_param_t));
   pf->model_details = *md;
   pf->alpha         = md->betaScale;
   pf->temperature   = md->temperature;
@@ -924,8 +1022,6 @@ get_exp_params_ali(vrna_md_t    *md,
   strncpy(pf->Tetraloops, Tetraloops, 281);
   strncpy(pf->Triloops, Triloops, 241);
   strncpy(pf->Hexaloops, Hexaloops, 361);
-
-  return pf;
 }
 
 
@@ -47,14 +47,29 @@
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
+PRIVATE float
+wrap_pf(vrna_fold_compound_t  *fc,
+        char                  *structure,
+        vrna_fold_compound_t  *ref,
+        int                   start,
+        int                   end);
+
+
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc);
+fill_arrays(vrna_fold_compound_t  *fc,
+            vrna_fold_compound_t  *ref,
+            int                   start,
+            int                   end);
 
 
 PRIVATE void
 postprocess_circular(vrna_fold_compound_t *fc);
 
 
+PRIVATE void
+prefill_linear_arrays(vrna_fold_compound_t *fc);
+
+
 PRIVATE FLT_OR_DBL
 decompose_pair(vrna_fold_compound_t *fc,
                int                  i,
@@ -62,6 +77,44 @@ decompose_pair(vrna_fold_compound_t *fc,
                vrna_mx_pf_aux_ml_t  aux_mx_ml);
 
 
+PRIVATE int
+adaptive_scaling(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+adapt_scaling(vrna_fold_compound_t  *fc,
+              int                   j,
+              FLT_OR_DBL            q_max,
+              int                   l_max,
+              FLT_OR_DBL            q_ref,
+              int                   l_ref,
+              vrna_mx_pf_aux_el_t   aux_mx_el,
+              vrna_mx_pf_aux_ml_t   aux_mx_ml);
+
+
+PRIVATE void
+adapt_scaling_linear(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+reuse_compatible(vrna_fold_compound_t *fc,
+                 vrna_fold_compound_t *ref);
+
+
+#ifdef _OPENMP
+
+PRIVATE int
+num_fill_threads(vrna_fold_compound_t *fc);
+
+
+PRIVATE int
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads);
+
+
+#endif
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -70,85 +123,46 @@ decompose_pair(vrna_fold_compound_t *fc,
 PUBLIC float
 vrna_pf(vrna_fold_compound_t  *fc,
         char                  *structure)
+{
+  return wrap_pf(fc, structure, NULL, 0, 0);
+}
+
+
+PUBLIC float
+vrna_pf_reuse(vrna_fold_compound_t  *fc,
+              vrna_fold_compound_t  *ref,
+              unsigned int          start,
+              unsigned int          end,
+              char                  *structure)
+{
+  if ((fc) && (ref) && ((start < 1) || (end < start) || (end > fc->length))) {
+    vrna_message_warning("vrna_pf_reuse@part_func.c: Invalid range [%u, %u] of modified positions",
+                         start,
+                         end);
+    return (float)(INF / 100.);
+  }
+
+  return wrap_pf(fc, structure, ref, (int)start, (int)end);
+}
+
+
+PUBLIC double
+vrna_pf_ensemble_energy(vrna_fold_compound_t *fc)
 {
   int               n;
   FLT_OR_DBL        Q;
   double            free_energy;
-  vrna_md_t         *md;
   vrna_exp_param_t  *params;
   vrna_mx_pf_t      *matrices;
 
-  free_energy = (float)(INF / 100.);
-
-  if (fc) {
-    /* make sure, everything is set up properly to start partition function computations */
-    if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF)) {
-      vrna_message_warning("vrna_pf@part_func.c: Failed to prepare vrna_fold_compound");
-      return free_energy;
-    }
+  free_energy = (double)(INF / 100.);
 
+  if ((fc) && (fc->exp_params) && (fc->exp_matrices)) {
     n         = fc->length;
     params    = fc->exp_params;
     matrices  = fc->exp_matrices;
-    md        = &(params->model_details);
-
-#ifdef _OPENMP
-    /* Explicitly turn off dynamic threads */
-    omp_set_dynamic(0);
-#endif
-
-#ifdef SUN4
-    nonstandard_arithmetic();
-#elif defined(HP9)
-    fpsetfastmode(1);
-#endif
-
-    /* call user-defined recursion status callback function */
-    if (fc->stat_cb)
-      fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
-
-    /* call user-defined grammar pre-condition callback function */
-    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
-      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->data);
-
-    if (!fill_arrays(fc)) {
-#ifdef SUN4
-      standard_arithmetic();
-#elif defined(HP9)
-      fpsetfastmode(0);
-#endif
-      return (float)(INF / 100.);
-    }
 
-    if (md->circ)
-      /* do post processing step for circular RNAs */
-      postprocess_circular(fc);
-
-    /* calculate base pairing probability matrix (bppm)  */
-    if (md->compute_bpp) {
-      vrna_pairing_probs(fc, structure);
-
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
-
-      /*
-       *  Backward compatibility:
-       *  This block may be removed if deprecated functions
-       *  relying on the global variable "pr" vanish from within the package!
-       */
-      pr = matrices->probs;
-
-#endif
-    }
-
-    /* call user-defined recursion status callback function */
-    if (fc->stat_cb)
-      fc->stat_cb(VRNA_STATUS_PF_POST, fc->auxdata);
-
-    /* call user-defined grammar post-condition callback function */
-    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
-      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_POST, fc->aux_grammar->data);
-
-    switch (md->backtrack_type) {
+    switch (params->model_details.backtrack_type) {
       case 'C':
         Q = matrices->qb[fc->iindx[1] - n];
         break;
@@ -158,7 +172,13 @@ vrna_pf(vrna_fold_compound_t  *fc,
         break;
 
       default:
-        Q = (md->circ) ? matrices->qo : matrices->q[fc->iindx[1] - n];
+        if (params->model_details.circ)
+          Q = matrices->qo;
+        else if (fc->band)
+          Q = matrices->q1k[n]; /* banded matrices lack q[1, n] */
+        else
+          Q = matrices->q[fc->iindx[1] - n];
+
         break;
     }
 
@@ -172,12 +192,6 @@ vrna_pf(vrna_fold_compound_t  *fc,
 
     if (fc->type == VRNA_FC_TYPE_COMPARATIVE)
       free_energy /= fc->n_seq;
-
-#ifdef SUN4
-    standard_arithmetic();
-#elif defined(HP9)
-    fpsetfastmode(0);
-#endif
   }
 
   return free_energy;
@@ -231,7 +245,7 @@ vrna_pf_dimer(vrna_fold_compound_t  *fc,
   if (fc->stat_cb)
     fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
 
-  if (!fill_arrays(fc)) {
+  if (!fill_arrays(fc, NULL, 0, 0)) {
     X.FA    = X.FB = X.FAB = X.F0AB = (float)(INF / 100.);
     X.FcAB  = 0;
 
@@ -338,12 +352,113 @@ vrna_pf_float_precision(void)
  # STATIC helper functions below #
  #################################
  */
+PRIVATE float
+wrap_pf(vrna_fold_compound_t  *fc,
+        char                  *structure,
+        vrna_fold_compound_t  *ref,
+        int                   start,
+        int                   end)
+{
+  double            free_energy;
+  vrna_md_t         *md;
+  vrna_exp_param_t  *params;
+  vrna_mx_pf_t      *matrices;
+
+  free_energy = (float)(INF / 100.);
+
+  if (fc) {
+    /* make sure, everything is set up properly to start partition function computations */
+    if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF)) {
+      vrna_message_warning("vrna_pf@part_func.c: Failed to prepare vrna_fold_compound");
+      return free_energy;
+    }
+
+    /* fall back to the full recursions if the reference matrices do not fit */
+    if ((ref) && (!reuse_compatible(fc, ref)))
+      ref = NULL;
+
+    params    = fc->exp_params;
+    matrices  = fc->exp_matrices;
+    md        = &(params->model_details);
+
+#ifdef _OPENMP
+    /* Explicitly turn off dynamic threads */
+    omp_set_dynamic(0);
+#endif
+
+#ifdef SUN4
+    nonstandard_arithmetic();
+#elif defined(HP9)
+    fpsetfastmode(1);
+#endif
+
+    /* call user-defined recursion status callback function */
+    if (fc->stat_cb)
+      fc->stat_cb(VRNA_STATUS_PF_PRE, fc->auxdata);
+
+    /* call user-defined grammar pre-condition callback function */
+    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->data);
+
+    if (!fill_arrays(fc, ref, start, end)) {
+#ifdef SUN4
+      standard_arithmetic();
+#elif defined(HP9)
+      fpsetfastmode(0);
+#endif
+      return (float)(INF / 100.);
+    }
+
+    if (md->circ)
+      /* do post processing step for circular RNAs */
+      postprocess_circular(fc);
+
+    /* calculate base pairing probability matrix (bppm)  */
+    if (md->compute_bpp) {
+      vrna_pairing_probs(fc, structure);
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
+      /*
+       *  Backward compatibility:
+       *  This block may be removed if deprecated functions
+       *  relying on the global variable "pr" vanish from within the package!
+       */
+      pr = matrices->probs;
+
+#endif
+    }
+
+    /* call user-defined recursion status callback function */
+    if (fc->stat_cb)
+      fc->stat_cb(VRNA_STATUS_PF_POST, fc->auxdata);
+
+    /* call user-defined grammar post-condition callback function */
+    if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
+      fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_POST, fc->aux_grammar->data);
+
+    free_energy = vrna_pf_ensemble_energy(fc);
+
+#ifdef SUN4
+    standard_arithmetic();
+#elif defined(HP9)
+    fpsetfastmode(0);
+#endif
+  }
+
+  return free_energy;
+}
+
+
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc)
+fill_arrays(vrna_fold_compound_t  *fc,
+            vrna_fold_compound_t  *ref,
+            int                   start,
+            int                   end)
 {
-  int                 n, i, j, k, ij, d, *my_iindx, *jindx, with_gquad, turn,
-                      with_ud;
-  FLT_OR_DBL          temp, Qmax, *q, *qb, *qm, *qm1, *q1k, *qln;
+  int                 n, i, j, ij, d, min_i, *my_iindx, *jindx, with_gquad, turn,
+                      with_ud, adaptive, l_col;
+  FLT_OR_DBL          temp, Qmax, q_col, *q, *qb, *qm, *qm1, *qb_ref;
   double              max_real;
   vrna_ud_t           *domains_up;
   vrna_md_t           *md;
@@ -362,14 +477,14 @@ fill_arrays(vrna_fold_compound_t *fc)
   qb          = matrices->qb;
   qm          = matrices->qm;
   qm1         = matrices->qm1;
-  q1k         = matrices->q1k;
-  qln         = matrices->qln;
+  qb_ref      = (ref) ? ref->exp_matrices->qb : NULL;
   md          = &(pf_params->model_details);
   with_gquad  = md->gquad;
   turn        = md->min_loop_size;
 
-  with_ud = (domains_up && domains_up->exp_energy_cb && (!(fc->type == VRNA_FC_TYPE_COMPARATIVE)));
-  Qmax    = 0;
+  with_ud   = (domains_up && domains_up->exp_energy_cb && (!(fc->type == VRNA_FC_TYPE_COMPARATIVE)));
+  adaptive  = adaptive_scaling(fc);
+  Qmax      = 0;
 
   max_real = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
 
@@ -400,10 +515,6 @@ fill_arrays(vrna_fold_compound_t *fc)
     }
   }
 
-  /* init auxiliary arrays for fast exterior/multibranch loops */
-  aux_mx_el = vrna_exp_E_ext_fast_init(fc);
-  aux_mx_ml = vrna_exp_E_ml_fast_init(fc);
-
   /*array initialization ; qb,qm,q
    * qb,qm,q (i,j) are stored as ((n+1-i)*(n-i) div 2 + n+1-j */
   for (d = 0; d <= turn; d++)
@@ -413,11 +524,39 @@ fill_arrays(vrna_fold_compound_t *fc)
       qb[ij]  = 0.0;
     }
 
+#ifdef _OPENMP
+  int num_threads = num_fill_threads(fc);
+
+  /* re-using the matrices of a reference sequence relies on the column-wise fill */
+  if ((num_threads != 1) && (!qb_ref)) {
+    if (!fill_arrays_wavefront(fc, num_threads))
+      return 0; /* failure */
+
+    prefill_linear_arrays(fc);
+
+    return 1;
+  }
+
+#endif
+
+  /* init auxiliary arrays for fast exterior/multibranch loops */
+  aux_mx_el = vrna_exp_E_ext_fast_init(fc);
+  aux_mx_ml = vrna_exp_E_ml_fast_init(fc);
+
   for (j = turn + 2; j <= n; j++) {
-    for (i = j - turn - 1; i >= 1; i--) {
+    /* banded DP matrices only store entries (i, j) with j - i <= band */
+    min_i = (fc->band) ? MAX2(1, j - (int)fc->band) : 1;
+    q_col = 0.;
+    l_col = 0;
+
+    for (i = j - turn - 1; i >= min_i; i--) {
       ij = my_iindx[i] - j;
 
-      qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
+      /* entries that do not span any of the modified positions are taken from the reference */
+      if ((qb_ref) && ((j < start) || (i > end)))
+        qb[ij] = qb_ref[ij];
+      else
+        qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
 
       /* Multibranch loop */
       qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
@@ -439,6 +578,11 @@ fill_arrays(vrna_fold_compound_t *fc)
       if ((fc->aux_grammar) && (fc->aux_grammar->cb_aux_exp))
         fc->aux_grammar->cb_aux_exp(fc, i, j, fc->aux_grammar->data);
 
+      if (q[ij] > q_col) {
+        q_col = q[ij];
+        l_col = j - i + 1;
+      }
+
       if (q[ij] > Qmax) {
         Qmax = q[ij];
         if (Qmax > max_real / 10.)
@@ -456,13 +600,53 @@ fill_arrays(vrna_fold_compound_t *fc)
       }
     }
 
+    /* keep the entries of the columns processed so far within the floating point range */
+    if ((adaptive) &&
+        (j - turn - 1 >= min_i) &&
+        (adapt_scaling(fc, j, q_col, l_col, q[my_iindx[min_i] - j], j - min_i + 1, aux_mx_el,
+                       aux_mx_ml))) {
+      Qmax = 0.;
+      /* the reference entries still use the previous scaling factor */
+      qb_ref = NULL;
+    }
+
     /* rotate auxiliary arrays */
     vrna_exp_E_ext_fast_rotate(aux_mx_el);
     vrna_exp_E_ml_fast_rotate(aux_mx_ml);
   }
 
-  /* prefill linear qln, q1k arrays */
-  if (q1k && qln) {
+  prefill_linear_arrays(fc);
+
+  /* banded matrices only cover short segments, so we need to check q1k and qln as well */
+  if ((adaptive) && (fc->band))
+    adapt_scaling_linear(fc);
+
+  /* free memory occupied by auxiliary arrays for fast exterior/multibranch loops */
+  vrna_exp_E_ml_fast_free(aux_mx_ml);
+  vrna_exp_E_ext_fast_free(aux_mx_el);
+
+  return 1;
+}
+
+
+/* prefill linear qln, q1k arrays */
+PRIVATE void
+prefill_linear_arrays(vrna_fold_compound_t *fc)
+{
+  int         k, n, *my_iindx;
+  FLT_OR_DBL  *q, *q1k, *qln;
+
+  n         = (int)fc->length;
+  my_iindx  = fc->iindx;
+  q         = fc->exp_matrices->q;
+  q1k       = fc->exp_matrices->q1k;
+  qln       = fc->exp_matrices->qln;
+
+  if (fc->band) {
+    /* banded matrices lack q[1, k] and q[k, n], so we compute them from qb */
+    (void)vrna_exp_E_ext_loop_5(fc);
+    (void)vrna_exp_E_ext_loop_3(fc);
+  } else if (q1k && qln) {
     for (k = 1; k <= n; k++) {
       q1k[k]  = q[my_iindx[1] - k];
       qln[k]  = q[my_iindx[k] - n];
@@ -470,15 +654,150 @@ fill_arrays(vrna_fold_compound_t *fc)
     q1k[0]      = 1.0;
     qln[n + 1]  = 1.0;
   }
+}
+
+
+#ifdef _OPENMP
+
+/*
+ *  Determine the number of threads for the wavefront fill. Returns 1 whenever
+ *  the serial implementation must be used
+ */
+PRIVATE int
+num_fill_threads(vrna_fold_compound_t *fc)
+{
+  int num_threads;
+
+  num_threads = fc->exp_params->model_details.num_threads;
+
+  /* the column-wise helper arrays of the wavefront fill are not banded */
+  if (fc->band)
+    return 1;
+
+  /* unstructured domains require the rotating helper arrays of the serial fill */
+  if ((fc->domains_up) && (fc->domains_up->exp_energy_cb))
+    return 1;
+
+  /* auxiliary grammar callbacks expect the serial (column-wise) fill order */
+  if ((fc->aux_grammar) &&
+      ((fc->aux_grammar->cb_aux_exp) ||
+       (fc->aux_grammar->cb_aux_exp_c) ||
+       (fc->aux_grammar->cb_aux_exp_m) ||
+       (fc->aux_grammar->cb_aux_exp_m1) ||
+       (fc->aux_grammar->cb_aux_exp_f)))
+    return 1;
+
+  if (num_threads == 0)
+    num_threads = omp_get_max_threads();
+
+  return (num_threads > 1) ? num_threads : 1;
+}
+
+
+/*
+ *  Fill the DP matrices qb, qm, qm1, and q along anti-diagonals, i.e. by
+ *  increasing span d = j - i. All entries of one diagonal only depend on
+ *  entries of smaller span and can therefore be computed concurrently.
+ *  Each entry is evaluated by the same sequence of operations (including
+ *  the order of all summations) as in the serial fill, so the resulting
+ *  matrices are identical and independent of the number of threads.
+ */
+PRIVATE int
+fill_arrays_wavefront(vrna_fold_compound_t  *fc,
+                      int                   num_threads)
+{
+  int                 d, n, turn, overflow, adaptive, *my_iindx;
+  FLT_OR_DBL          *q, *qb, *qm;
+  double              max_real;
+  vrna_mx_pf_aux_el_t aux_mx_el;
+  vrna_mx_pf_aux_ml_t aux_mx_ml;
+
+  n         = (int)fc->length;
+  my_iindx  = fc->iindx;
+  turn      = fc->exp_params->model_details.min_loop_size;
+  q         = fc->exp_matrices->q;
+  qb        = fc->exp_matrices->qb;
+  qm        = fc->exp_matrices->qm;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  overflow  = 0;
+  adaptive  = adaptive_scaling(fc);
+
+  /* keep the helper arrays of all columns, qm1 is filled as a side effect */
+  aux_mx_el = vrna_exp_E_ext_fast_init_columns(fc);
+  aux_mx_ml = vrna_exp_E_ml_fast_init_columns(fc);
+
+#pragma omp parallel num_threads(num_threads) private(d)
+  {
+    int         i, j, ij;
+    FLT_OR_DBL  Qmax = 0.;
+
+    for (d = turn + 1; d < n; d++) {
+#pragma omp for schedule(static)
+      for (i = 1; i <= n - d; i++) {
+        j   = i + d;
+        ij  = my_iindx[i] - j;
+
+        qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
+
+        /* Multibranch loop */
+        qm[ij] = vrna_exp_E_ml_fast(fc, i, j, aux_mx_ml);
+
+        /* Exterior loop */
+        q[ij] = vrna_exp_E_ext_fast(fc, i, j, aux_mx_el);
+
+        if (q[ij] > Qmax) {
+          Qmax = q[ij];
+          if (Qmax > max_real / 10.)
+            vrna_message_warning("Q close to overflow: %d %d %g", i, j, q[ij]);
+        }
+
+        if (q[ij] >= max_real) {
+#pragma omp critical (pf_fill_overflow)
+          {
+            if (!overflow)
+              vrna_message_warning("overflow while computing partition function for segment q[%d,%d]\n"
+                                   "use larger pf_scale", i, j);
+
+            overflow = 1;
+          }
+        }
+      }
+      /* implicit barrier, diagonal d is complete and 'overflow' is seen by all threads */
+
+      if (overflow)
+        break;
+
+      /* keep the entries of all diagonals processed so far within the floating point range */
+      if (adaptive) {
+#pragma omp single
+        {
+          FLT_OR_DBL q_diag = 0.;
+
+          for (i = 1; i <= n - d; i++)
+            q_diag = MAX2(q_diag, q[my_iindx[i] - i - d]);
+
+          (void)adapt_scaling(fc, n, q_diag, d + 1, q_diag, d + 1, aux_mx_el, aux_mx_ml);
+        }
+        /* implicit barrier */
+
+        Qmax = 0.;
+      }
+
+      /* nobody may raise 'overflow' for diagonal d + 1 before everyone checked it */
+#pragma omp barrier
+    }
+  }
 
-  /* free memory occupied by auxiliary arrays for fast exterior/multibranch loops */
   vrna_exp_E_ml_fast_free(aux_mx_ml);
   vrna_exp_E_ext_fast_free(aux_mx_el);
 
-  return 1;
+  return (overflow) ? 0 : 1;
 }
 
 
+#endif
+
+
 PRIVATE FLT_OR_DBL
 decompose_pair(vrna_fold_compound_t *fc,
                int                  i,
@@ -829,3 +1148,254 @@ postprocess_circular(vrna_fold_compound_t *fc)
   matrices->qio = qio;
   matrices->qmo = qmo;
 }
+
+
+/*
+ *  Check whether the matrix qb of the reference fold compound ref may be
+ *  re-used for fc, i.e. whether both were obtained for sequences of the same
+ *  length with identical Boltzmann factors and matrix layout, and without
+ *  any feature that makes qb(i, j) depend on more than the subsequence [i, j]
+ */
+PRIVATE int
+reuse_compatible(vrna_fold_compound_t *fc,
+                 vrna_fold_compound_t *ref)
+{
+  vrna_md_t md1, md2;
+
+  if ((fc == ref) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (ref->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->length != ref->length) ||
+      (fc->band != ref->band) ||
+      (fc->strands != 1) ||
+      (ref->strands != 1) ||
+      (fc->sc) ||
+      (ref->sc) ||
+      (fc->hc->depot) ||
+      (ref->hc->depot) ||
+      (fc->hc->f) ||
+      (ref->hc->f) ||
+      (fc->domains_up) ||
+      (ref->domains_up) ||
+      (fc->aux_grammar) ||
+      (ref->aux_grammar) ||
+      (!ref->exp_params) ||
+      (!ref->exp_matrices) ||
+      (ref->exp_matrices->type != VRNA_MX_DEFAULT) ||
+      (!ref->exp_matrices->qb) ||
+      (fc->exp_params->pf_scale != ref->exp_params->pf_scale))
+    return 0;
+
+  /* the number of threads and bpp computations do not affect the matrix entries */
+  (void)vrna_md_copy(&md1, &(fc->exp_params->model_details));
+  (void)vrna_md_copy(&md2, &(ref->exp_params->model_details));
+  md1.num_threads = md2.num_threads = 0;
+  md1.compute_bpp = md2.compute_bpp = 0;
+
+  if (memcmp(&md1, &md2, sizeof(vrna_md_t)) != 0)
+    return 0;
+
+  if ((md1.noLP) || (md1.circ))
+    return 0;
+
+  return 1;
+}
+
+
+/*
+ *  Check whether the scaling factor of the Boltzmann weights may be adapted
+ *  during the fill. Unstructured domains and auxiliary grammars store their
+ *  own (scaled) contributions elsewhere, so we can't re-scale those
+ */
+PRIVATE int
+adaptive_scaling(vrna_fold_compound_t *fc)
+{
+  if (!fc->exp_params->model_details.pf_adaptive)
+    return 0;
+
+  if (((fc->domains_up) && (fc->domains_up->exp_energy_cb)) ||
+      ((fc->aux_grammar) &&
+       ((fc->aux_grammar->cb_aux_exp) ||
+        (fc->aux_grammar->cb_aux_exp_c) ||
+        (fc->aux_grammar->cb_aux_exp_m) ||
+        (fc->aux_grammar->cb_aux_exp_m1) ||
+        (fc->aux_grammar->cb_aux_exp_f)))) {
+    vrna_message_warning("Adaptive scaling of Boltzmann factors is not supported for "
+                         "unstructured domains and auxiliary grammars.\n"
+                         "Using constant scaling factor pf_scale = %g instead",
+                         fc->exp_params->pf_scale);
+    return 0;
+  }
+
+  return 1;
+}
+
+
+/*
+ *  Adjust the per-nucleotide scaling factor pf_scale whenever the partition
+ *  functions obtained so far approach the limits of the floating point range.
+ *  q_max is the largest entry of the most recent column (or diagonal) and
+ *  corresponds to a segment of length l_max, q_ref is the entry of the
+ *  longest segment processed so far (length l_ref) and serves to detect
+ *  underflows. The new scaling factor turns the respective entry into a value
+ *  close to 1, and all entries computed so far, as well as the scale arrays,
+ *  are updated accordingly. Returns non-zero if the scaling factor has been
+ *  changed
+ */
+PRIVATE int
+adapt_scaling(vrna_fold_compound_t  *fc,
+              int                   j,
+              FLT_OR_DBL            q_max,
+              int                   l_max,
+              FLT_OR_DBL            q_ref,
+              int                   l_ref,
+              vrna_mx_pf_aux_el_t   aux_mx_el,
+              vrna_mx_pf_aux_ml_t   aux_mx_ml)
+{
+  int               n, i, k, l, ij, max_span, *my_iindx, *jindx;
+  FLT_OR_DBL        *factors, *q, *qb, *qm, *qm1, *G, *scale, *expMLbase;
+  double            max_real, log_hi, log_lo, log_r, pf_scale;
+  vrna_exp_param_t  *pf_params;
+
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  log_hi    = log(max_real) / 4.;
+  log_lo    = MAX2(-log_hi, log(FLT_MIN) / 2.);
+  log_r     = 0.;
+
+  if ((q_max > 0.) && (q_max < max_real) && (log(q_max) > log_hi)) {
+    /* overflow ahead, scale down */
+    log_r = -log(q_max) / l_max;
+  } else if ((q_ref > 0.) && (log(q_ref) < log_lo)) {
+    /* underflow ahead, scale up but stay clear of overflows for the largest entries */
+    log_r = -log(q_ref) / l_ref;
+    if ((q_max > 0.) && (log(q_max) + log_r * l_max > log_hi / 2.))
+      log_r = (log_hi / 2. - log(q_max)) / l_max;
+
+    if (log_r < 0.)
+      log_r = 0.;
+  }
+
+  if (log_r == 0.)
+    return 0;
+
+  pf_params = fc->exp_params;
+  pf_scale  = pf_params->pf_scale * exp(-log_r);
+
+  /* the partition function of a segment is never smaller than 1 (the open chain) */
+  if (pf_scale < 1.) {
+    pf_scale  = 1.;
+    log_r     = log(pf_params->pf_scale);
+  }
+
+  if (log_r == 0.)
+    return 0;
+
+  n         = (int)fc->length;
+  my_iindx  = fc->iindx;
+  jindx     = fc->jindx;
+  q         = fc->exp_matrices->q;
+  qb        = fc->exp_matrices->qb;
+  qm        = fc->exp_matrices->qm;
+  qm1       = fc->exp_matrices->qm1;
+  G         = fc->exp_matrices->G;
+  scale     = fc->exp_matrices->scale;
+  expMLbase = fc->exp_matrices->expMLbase;
+  max_span  = (fc->band) ? (int)fc->band : n;
+  max_span  = MIN2(max_span, l_ref - 1);
+
+  /*
+   *  Segments longer than l_ref have not been processed yet, so their entries
+   *  (if any) will be overwritten later on and we leave them untouched
+   */
+  factors = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 2));
+
+  for (l = 0; l <= n + 1; l++)
+    factors[l] = (l <= l_ref) ? (FLT_OR_DBL)exp(log_r * l) : 1.;
+
+  for (i = 1; i <= n; i++)
+    for (k = i; k <= MIN2(n, i + max_span); k++) {
+      ij      = my_iindx[i] - k;
+      q[ij]   *= factors[k - i + 1];
+      qb[ij]  *= factors[k - i + 1];
+      qm[ij]  *= factors[k - i + 1];
+
+      if (qm1)
+        qm1[jindx[k] + i] *= factors[k - i + 1];
+    }
+
+  /* G-Quadruplex contributions have been pre-computed for all segments */
+  if (G)
+    for (i = 1; i <= n; i++)
+      for (k = i; k <= n; k++) {
+        ij = my_iindx[i] - k;
+        if (G[ij] != 0.)
+          G[ij] *= (FLT_OR_DBL)exp(log_r * (k - i + 1));
+      }
+
+  vrna_exp_E_ext_fast_rescale(fc, j, factors, aux_mx_el);
+  vrna_exp_E_ml_fast_rescale(fc, j, factors, aux_mx_ml);
+
+  /* finally, update the scale arrays */
+  pf_params->pf_scale = pf_scale;
+  scale[0]            = 1.;
+  scale[1]            = (FLT_OR_DBL)(1. / pf_scale);
+  expMLbase[0]        = 1.;
+  expMLbase[1]        = (FLT_OR_DBL)(pf_params->expMLbase / pf_scale);
+  for (l = 2; l <= n; l++) {
+    scale[l]      = scale[l / 2] * scale[l - (l / 2)];
+    expMLbase[l]  = (FLT_OR_DBL)pow(pf_params->expMLbase, (double)l) * scale[l];
+  }
+
+  free(factors);
+
+  return 1;
+}
+
+
+/*
+ *  Adapt the scaling factor to the linear arrays q1k and qln that span
+ *  segments far longer than those stored in banded DP matrices. Each round
+ *  re-scales with respect to the first entry that leaves the safe floating
+ *  point range and re-computes both arrays
+ */
+PRIVATE void
+adapt_scaling_linear(vrna_fold_compound_t *fc)
+{
+  int         n, k, round, found;
+  FLT_OR_DBL  *q1k, *qln;
+  double      max_real, log_hi, log_lo, log_q;
+
+  n         = (int)fc->length;
+  q1k       = fc->exp_matrices->q1k;
+  qln       = fc->exp_matrices->qln;
+  max_real  = (sizeof(FLT_OR_DBL) == sizeof(float)) ? FLT_MAX : DBL_MAX;
+  log_hi    = log(max_real) / 4.;
+  log_lo    = MAX2(-log_hi, log(FLT_MIN) / 2.);
+
+  if ((!q1k) || (!qln))
+    return;
+
+  for (round = 0; round < n; round++) {
+    found = 0;
+
+    for (k = 1; k <= n; k++) {
+      log_q = log(q1k[k]);
+      if ((log_q > log_hi) || (log_q < log_lo)) {
+        found = adapt_scaling(fc, n, q1k[k], k, q1k[k], k, NULL, NULL);
+        break;
+      }
+
+      log_q = log(qln[n - k + 1]);
+      if ((log_q > log_hi) || (log_q < log_lo)) {
+        found = adapt_scaling(fc, n, qln[n - k + 1], k, qln[n - k + 1], k, NULL, NULL);
+        break;
+      }
+    }
+
+    if (!found)
+      break;
+
+    (void)vrna_exp_E_ext_loop_5(fc);
+    (void)vrna_exp_E_ext_loop_3(fc);
+  }
+}
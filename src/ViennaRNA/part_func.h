@@ -127,6 +127,13 @@ struct vrna_dimer_pf_s {
  *        or numerical over-/underflow. In the latter case, a corresponding warning
  *        will be issued to @p stdout.
  *
+ *  @note If the model details of the fold compound request more than one thread
+ *        (see #vrna_md_t.num_threads), the forward recursions are filled along
+ *        anti-diagonals and the outside recursions of the base pair probabilities
+ *        are distributed over all pairs (k,l) of a column l in parallel. Since the
+ *        summation order of each entry remains unchanged, the results are identical
+ *        to those of the serial implementation.
+ *
  *  @see #vrna_fold_compound_t, vrna_fold_compound(), vrna_pf_fold(), vrna_pf_circfold(),
  *        vrna_fold_compound_comparative(), vrna_pf_alifold(), vrna_pf_circalifold(),
  *        vrna_db_from_probs(), vrna_exp_params(), vrna_aln_pinfo()
@@ -141,6 +148,59 @@ vrna_pf(vrna_fold_compound_t  *vc,
         char                  *structure);
 
 
+/**
+ *  @brief  Compute the partition function of a sequence variant re-using the DP matrices
+ *          of a reference sequence
+ *
+ *  This function yields the same results as vrna_pf() for a sequence that differs from the
+ *  sequence of the reference fold compound @p ref only within the positions @p start to
+ *  @p end, e.g. a single point mutant. All entries @f$Q^{b}_{ij}@f$ of the base pair
+ *  matrix with @f$j < start@f$ or @f$i > end@f$ are taken from @p ref instead of being
+ *  decomposed again.
+ *
+ *  The DP matrices of @p ref must have been filled by a previous call to vrna_pf(), and
+ *  both fold compounds must share the same model details, sequence length and scaling factor
+ *  #vrna_exp_param_t.pf_scale. If this is not the case, or either of the fold compounds uses
+ *  hard constraints other than those implied by the sequence itself, soft constraints,
+ *  unstructured domains, auxiliary grammar extensions, the @p noLP or circular model, the
+ *  function silently falls back to the regular recursions of vrna_pf().
+ *  The same applies to all entries computed after an adaptive change of the scaling factor.
+ *  The matrices are always filled by a single thread.
+ *
+ *  @see vrna_pf(), vrna_mfe_reuse(), vrna_mutational_scan()
+ *
+ *  @param  fc          The fold compound of the sequence variant
+ *  @param  ref         The fold compound of the reference sequence with filled DP matrices
+ *  @param  start       The first position where the sequences differ (1-based)
+ *  @param  end         The last position where the sequences differ (1-based)
+ *  @param  structure   A pointer to the character array where position-wise pairing propensity
+ *                      will be stored. (Maybe NULL)
+ *  @return             The ensemble free energy @f$G = -RT \cdot \log(Q) @f$ in kcal/mol
+ */
+float
+vrna_pf_reuse(vrna_fold_compound_t  *fc,
+              vrna_fold_compound_t  *ref,
+              unsigned int          start,
+              unsigned int          end,
+              char                  *structure);
+
+
+/**
+ *  @brief  Retrieve the ensemble free energy from the filled partition function DP matrices
+ *
+ *  This function yields the same value as the preceding call to vrna_pf(), but in double
+ *  precision. This is required whenever ensemble free energies are subject to numerical
+ *  differentiation, e.g. for heat capacity computations.
+ *
+ *  @see vrna_pf(), vrna_heat_capacity()
+ *
+ *  @param  fc  The fold compound data structure with filled partition function DP matrices
+ *  @return     The ensemble free energy @f$G = -RT \cdot \log(Q) @f$ in kcal/mol
+ */
+double
+vrna_pf_ensemble_energy(vrna_fold_compound_t *fc);
+
+
 /**
  *  @brief  Calculate partition function and base pair probabilities of
  *          nucleic acid/nucleic acid dimers
@@ -90,6 +90,12 @@
  # PRIVATE VARIABLES             #
  #################################
  */
+
+/*
+ *  The state below is shared between pf_unstru() and pf_interact(), which
+ *  additionally modifies the global pf_scale, so none of the functions in
+ *  this file are reentrant
+ */
 PRIVATE short             *S = NULL, *S1 = NULL, *SS = NULL, *SS2 = NULL;
 PRIVATE vrna_exp_param_t  *Pf = NULL;                           /* use this structure for all the exp-arrays*/
 PRIVATE FLT_OR_DBL        *qb = NULL, *qm = NULL, *prpr = NULL; /* add arrays for pf_unpaired()*/
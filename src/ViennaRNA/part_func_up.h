@@ -30,6 +30,11 @@
  *  that a region within the target is unpaired, or equivalently, the
  *  calculation of the free energy needed to expose a region. In the second step
  *  we compute the free energy of an interaction for every possible binding site.
+ *
+ *  @note The functions of this module keep their intermediate results in static
+ *        variables, rely on the global state of pf_fold(), and temporarily change
+ *        the global #pf_scale. Hence, they must not be called concurrently from
+ *        several threads.
  */
 
 /**
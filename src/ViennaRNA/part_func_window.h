@@ -188,6 +188,14 @@ typedef void (vrna_probs_window_callback)(FLT_OR_DBL    *pr,
  *  @note   The parameter @p ulength only affects computation and resulting data if unpaired
  *          probability computations are requested through the @p options flag.
  *
+ *  @note   For single sequences much longer than the window size, the scan is split into
+ *          overlapping chunks that are processed by the number of threads specified in the
+ *          model details (@p num_threads, where 0 uses the OpenMP default). The data reported
+ *          for each position is identical to that of a serial scan, and the callback is still
+ *          executed by a single thread at a time with positions of each kind of data in
+ *          ascending order. Fold compounds with soft constraints, hard constraint callbacks,
+ *          unstructured domains, or grammar extensions are always processed serially.
+ *
  *  #### Options: ####
  *  * #VRNA_PROBS_WINDOW_BPP      - @copybrief #VRNA_PROBS_WINDOW_BPP
  *  * #VRNA_PROBS_WINDOW_UP       - @copybrief #VRNA_PROBS_WINDOW_UP
@@ -211,6 +219,44 @@ vrna_probs_window(vrna_fold_compound_t        *fc,
                   vrna_probs_window_callback  *cb,
                   void                        *data);
 
+
+/**
+ *  @brief  Compute various equilibrium probabilities under a sliding window approach for streamed sequences
+ *
+ *  Same as vrna_probs_window() but the sequence is retrieved block-wise from the @p source
+ *  callback instead of a #vrna_fold_compound_t. The sequence is processed in overlapping
+ *  chunks from the 5' to the 3' end, and only the chunks currently processed are kept in
+ *  memory. Thus, memory consumption depends on the window size and the number of threads
+ *  but not on the sequence length. As for the parallel mode of vrna_probs_window(), the
+ *  data reported for each position is identical to that of a serial scan of the entire
+ *  sequence, and positions of each kind of data are passed to the callback in ascending
+ *  order.
+ *
+ *  @note   Neither constraints nor comparative predictions are supported. The sequence
+ *          is used as provided by @p source, i.e. it must already be converted to upper
+ *          case RNA alphabet if necessary. The window size in the model details must be
+ *          positive.
+ *
+ *  @see  vrna_probs_window(), vrna_file_fasta_read_block(), #vrna_sequence_source_callback
+ *
+ *  @param  md_p          The model details to use (maybe NULL for default settings)
+ *  @param  ulength       The maximal length of an unpaired segment (only for unpaired probability computations)
+ *  @param  options       Option flags to control the behavior of this function
+ *  @param  source        The callback that provides the sequence
+ *  @param  source_data   An arbitrary data pointer passed through to @p source
+ *  @param  cb            The callback function which collects the pair probability data for further processing
+ *  @param  data          Some arbitrary data structure that is passed to the callback @p cb
+ *  @return               0 on failure, non-zero on success
+ */
+int
+vrna_probs_window_source(vrna_md_t                      *md_p,
+                         int                            ulength,
+                         unsigned int                   options,
+                         vrna_sequence_source_callback  *source,
+                         void                           *source_data,
+                         vrna_probs_window_callback     *cb,
+                         void                           *data);
+
 /* End basic interface */
 /**@}*/
 
@@ -37,6 +37,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <math.h>
 #include <ctype.h>
 #include <string.h>
@@ -78,7 +79,8 @@
 #define LINIY(i, j, l)    ((i + 25) * l + j)
 
 PRIVATE void
-encode_seqs(const char  *s1,
+encode_seqs(vrna_plex_t *plex,
+            const char  *s1,
             const char  *s2);
 
 
@@ -86,8 +88,58 @@ PRIVATE short *
 encode_seq(const char *seq);
 
 
+PRIVATE short *
+encode_alias(const short  *alias,
+             const short  *S);
+
+
+/**
+*** scan(_XS) implement vrna_plex_scan(_XS) and vrna_plex_scan_target(). If a target index is
+*** given, its encoding and accessibility terms are used, and only the target regions returned by
+*** seed_regions() are scanned
+**/
+PRIVATE void
+scan(vrna_plex_t              *plex,
+     const vrna_plex_target_t *target,
+     const char               *s1,
+     const char               *s2,
+     const int                threshold,
+     const int                extension_cost,
+     const int                alignment_length,
+     const int                delta,
+     const int                fast,
+     const int                il_a,
+     const int                il_b,
+     const int                b_a,
+     const int                b_b);
+
+
+PRIVATE void
+scan_XS(vrna_plex_t               *plex,
+        const vrna_plex_target_t  *target,
+        const char                *s1,
+        const char                *s2,
+        const int                 **access_s1,
+        const int                 **access_s2,
+        const int                 threshold,
+        const int                 alignment_length,
+        const int                 delta,
+        const int                 fast,
+        const int                 il_a,
+        const int                 il_b,
+        const int                 b_a,
+        const int                 b_b);
+
+
+PRIVATE int *
+seed_regions(vrna_plex_t              *plex,
+             const vrna_plex_target_t *target,
+             const int                alignment_length);
+
+
 PRIVATE void
-update_dfold_params(void);
+reset_columns(int *SA,
+              int n2);
 
 
 /**
@@ -96,51 +148,56 @@ update_dfold_params(void);
 *** fduplexfold(_XS) computes duplex in a plex way
 **/
 PRIVATE duplexT
-duplexfold(const char *s1,
-           const char *s2,
-           const int  extension_cost);
+duplexfold(vrna_plex_t  *plex,
+           const char   *s1,
+           const char   *s2,
+           const int    extension_cost);
 
 
 PRIVATE char *
-backtrack(int       i,
-          int       j,
-          const int extension_cost);
+backtrack(vrna_plex_t *plex,
+          int         i,
+          int         j,
+          const int   extension_cost);
 
 
 PRIVATE void
-find_max(const int  *position,
-         const int  *position_j,
-         const int  delta,
-         const int  threshold,
-         const int  length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b);
+find_max(vrna_plex_t  *plex,
+         const int    *position,
+         const int    *position_j,
+         const int    delta,
+         const int    threshold,
+         const int    length,
+         const char   *s1,
+         const char   *s2,
+         const int    extension_cost,
+         const int    fast,
+         const int    il_a,
+         const int    il_b,
+         const int    b_a,
+         const int    b_b);
 
 
 PRIVATE void
-plot_max(const int  max,
-         const int  max_pos,
-         const int  max_pos_j,
-         const int  alignment_length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b);
+plot_max(vrna_plex_t  *plex,
+         const int    max,
+         const int    max_pos,
+         const int    max_pos_j,
+         const int    alignment_length,
+         const char   *s1,
+         const char   *s2,
+         const int    extension_cost,
+         const int    fast,
+         const int    il_a,
+         const int    il_b,
+         const int    b_a,
+         const int    b_b);
 
 
 /* PRIVATE duplexT duplexfold_XS(const char *s1, const char *s2,const int **access_s1, const int **access_s2, const int i_pos, const int j_pos, const int threshold); */
 PRIVATE duplexT
-duplexfold_XS(const char  *s1,
+duplexfold_XS(vrna_plex_t *plex,
+              const char  *s1,
               const char  *s2,
               const int   **access_s1,
               const int   **access_s2,
@@ -153,16 +210,18 @@ duplexfold_XS(const char  *s1,
 
 /* PRIVATE char *   backtrack_XS(int i, int j, const int** access_s1, const int** access_s2); */
 PRIVATE char *
-backtrack_XS(int        i,
-             int        j,
-             const int  **access_s1,
-             const int  **access_s2,
-             const int  i_flag,
-             const int  j_flag);
+backtrack_XS(vrna_plex_t  *plex,
+             int          i,
+             int          j,
+             const int    **access_s1,
+             const int    **access_s2,
+             const int    i_flag,
+             const int    j_flag);
 
 
 PRIVATE void
-find_max_XS(const int   *position,
+find_max_XS(vrna_plex_t *plex,
+            const int   *position,
             const int   *position_j,
             const int   delta,
             const int   threshold,
@@ -179,7 +238,8 @@ find_max_XS(const int   *position,
 
 
 PRIVATE void
-plot_max_XS(const int   max,
+plot_max_XS(vrna_plex_t *plex,
+            const int   max,
             const int   max_pos,
             const int   max_pos_j,
             const int   alignment_length,
@@ -195,7 +255,8 @@ plot_max_XS(const int   max,
 
 
 PRIVATE duplexT
-fduplexfold(const char  *s1,
+fduplexfold(vrna_plex_t *plex,
+            const char  *s1,
             const char  *s2,
             const int   extension_cost,
             const int   il_a,
@@ -205,45 +266,48 @@ fduplexfold(const char  *s1,
 
 
 PRIVATE char *
-fbacktrack(int        i,
-           int        j,
-           const int  extension_cost,
-           const int  il_a,
-           const int  il_b,
-           const int  b_a,
-           const int  b_b,
-           int        *dG);
+fbacktrack(vrna_plex_t  *plex,
+           int          i,
+           int          j,
+           const int    extension_cost,
+           const int    il_a,
+           const int    il_b,
+           const int    b_a,
+           const int    b_b,
+           int          *dG);
 
 
 PRIVATE duplexT
-fduplexfold_XS(const char *s1,
-               const char *s2,
-               const int  **access_s1,
-               const int  **access_s2,
-               const int  i_pos,
-               const int  j_pos,
-               const int  threshold,
-               const int  il_a,
-               const int  il_b,
-               const int  b_a,
-               const int  b_b);
+fduplexfold_XS(vrna_plex_t  *plex,
+               const char   *s1,
+               const char   *s2,
+               const int    **access_s1,
+               const int    **access_s2,
+               const int    i_pos,
+               const int    j_pos,
+               const int    threshold,
+               const int    il_a,
+               const int    il_b,
+               const int    b_a,
+               const int    b_b);
 
 
 PRIVATE char *
-fbacktrack_XS(int       i,
-              int       j,
-              const int **access_s1,
-              const int **access_s2,
-              const int i_pos,
-              const int j_pos,
-              const int il_a,
-              const int il_b,
-              const int b_a,
-              const int b_b,
-              int       *dGe,
-              int       *dGeplex,
-              int       *dGx,
-              int       *dGy);
+fbacktrack_XS(vrna_plex_t *plex,
+              int         i,
+              int         j,
+              const int   **access_s1,
+              const int   **access_s2,
+              const int   i_pos,
+              const int   j_pos,
+              const int   il_a,
+              const int   il_b,
+              const int   b_a,
+              const int   b_b,
+              int         *dGe,
+              int         *dGeplex,
+              int         *dGx,
+              int         *dGy);
 
 
 /*@unused@*/
@@ -251,25 +315,256 @@ fbacktrack_XS(int       i,
 #define MAXSECTORS      500     /* dimension for a backtrack array */
 #define LOCALITY        0.      /* locality parameter for base-pairs */
 
-PRIVATE vrna_param_t *P = NULL;
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
-/**
-*** energy array used in fduplexfold and fduplexfold_XS
-*** We do not use the 1D array here as it is not time critical
-*** It also makes the code more readable
-*** c -> stack;in -> interior loop;bx/by->bulge;inx/iny->1xn loops
-**/
+PRIVATE vrna_plex_t *backward_compat_plex = NULL;
 
-PRIVATE int **c = NULL, **in = NULL, **bx = NULL, **by = NULL, **inx = NULL, **iny = NULL;
+#ifdef _OPENMP
 
-/**
-*** S1, SS1, ... contains the encoded sequence for target and query
-*** n1, n2, n3, n4 contains target and query length
-**/
+#pragma omp threadprivate(backward_compat_plex)
+
+#endif
+
+#endif
+
+#include "ViennaRNA/plex_context.inc"
+
+struct vrna_plex_target_s {
+  char          *sequence;      /* the padded target sequence */
+  int           length;
+  short         *S1, *SS1;      /* encoded target sequence */
+  const int     **access;       /* opening energy profile, not owned by the index */
+  int           **DI;           /* accessibility terms of the target side as used in scan_XS() */
+
+  /* k-mer table, the positions of k-mer c are seed_pos[seed_first[c] ... seed_first[c + 1] - 1] */
+  unsigned int  seed_length;
+  unsigned int  *seed_first;
+  unsigned int  *seed_pos;
+};
+
+
+PUBLIC vrna_plex_t *
+vrna_plex_init(const vrna_md_t *md_p)
+{
+  vrna_md_t   md;
+  vrna_plex_t *plex;
+
+  if (md_p)
+    vrna_md_copy(&md, md_p);
+  else
+    vrna_md_set_default(&md);
+
+  plex        = (vrna_plex_t *)vrna_alloc(sizeof(vrna_plex_t));
+  plex->P     = vrna_params(&md);
+  plex->pair  = plex->P->model_details.pair;
+  plex->rtype = &(plex->P->model_details.rtype[0]);
+  plex->alias = &(plex->P->model_details.alias[0]);
+
+  return plex;
+}
+
+
+PUBLIC void
+vrna_plex_free(vrna_plex_t *plex)
+{
+  if (plex) {
+    free(plex->P);
+    free(plex);
+  }
+}
+
+
+PUBLIC void
+vrna_plex_set_output(vrna_plex_t  *plex,
+                     vrna_cstr_t  output)
+{
+  if (plex)
+    plex->output = output;
+}
+
+
+PUBLIC vrna_plex_target_t *
+vrna_plex_target_init(const vrna_md_t *md_p,
+                      const char      *s1,
+                      const int       **access_s1,
+                      unsigned int    seed_length)
+{
+  unsigned int        k, num, code, *cursor;
+  int                 i, p, n1;
+  vrna_md_t           md;
+  vrna_plex_target_t  *target;
+
+  if (!s1)
+    return NULL;
+
+  if (seed_length > VRNA_PLEX_SEED_MAX) {
+    vrna_message_warning("vrna_plex_target_init: "
+                         "Seed length %u exceeds maximum of %d",
+                         seed_length,
+                         VRNA_PLEX_SEED_MAX);
+    return NULL;
+  }
+
+  if (md_p)
+    vrna_md_copy(&md, md_p);
+  else
+    vrna_md_set_default(&md);
+
+  vrna_md_update(&md);
+
+  n1                  = (int)strlen(s1);
+  target              = (vrna_plex_target_t *)vrna_alloc(sizeof(vrna_plex_target_t));
+  target->sequence    = strdup(s1);
+  target->length      = n1;
+  target->S1          = encode_seq(s1);
+  target->SS1         = encode_alias(&(md.alias[0]), target->S1);
+  target->access      = access_s1;
+  target->seed_length = seed_length;
+
+  if (access_s1) {
+    /* same as the target side terms di1 ... di4 of the original recursion in scan_XS() */
+    target->DI    = (int **)vrna_alloc(4 * sizeof(int *));
+    target->DI[0] = (int *)vrna_alloc(n1 * sizeof(int));
+    target->DI[1] = (int *)vrna_alloc(n1 * sizeof(int));
+    target->DI[2] = (int *)vrna_alloc(n1 * sizeof(int));
+    target->DI[3] = (int *)vrna_alloc(n1 * sizeof(int));
+    for (i = 10; i < n1 - 9; i++) {
+      int di1, di2, di3, di4;
+      di1 = 0.5 * (access_s1[5][i + 4] - access_s1[4][i + 4] + access_s1[5][i] - access_s1[4][i - 1]);
+      di2 = 0.5 *
+            (access_s1[5][i + 3] - access_s1[4][i + 3] + access_s1[5][i - 1] - access_s1[4][i - 2]) +
+            di1;
+      di3 = 0.5 *
+            (access_s1[5][i + 2] - access_s1[4][i + 2] + access_s1[5][i - 2] - access_s1[4][i - 3]) +
+            di2;
+      di4 = 0.5 *
+            (access_s1[5][i + 1] - access_s1[4][i + 1] + access_s1[5][i - 3] - access_s1[4][i - 4]) +
+            di3;
+      target->DI[0][i]  = di1;
+      target->DI[1][i]  = di2;
+      target->DI[2][i]  = di3;
+      target->DI[3][i]  = di4;
+    }
+  }
+
+  if (seed_length > 0) {
+    /* counting sort of all k-mers of the unpadded target that consist of A, C, G, U only */
+    num                 = 1U << (2 * seed_length);
+    target->seed_first  = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (num + 1));
+    target->seed_pos    = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (n1 + 1));
+
+    for (p = 11; p + (int)seed_length - 1 <= n1 - 10; p++) {
+      for (code = 0, k = 0; k < seed_length; k++) {
+        if ((target->S1[p + k] < 1) || (target->S1[p + k] > 4))
+          break;
+
+        code = (code << 2) | (unsigned int)(target->S1[p + k] - 1);
+      }
+      if (k == seed_length)
+        target->seed_first[code + 1]++;
+    }
 
-PRIVATE short *S1 = NULL, *SS1 = NULL, *S2 = NULL, *SS2 = NULL; /*contains the sequences*/
-PRIVATE int   n1, n2;                                           /* sequence lengths */
-PRIVATE int   n3, n4; /*sequence length for the duplex*/;
+    for (code = 0; code < num; code++)
+      target->seed_first[code + 1] += target->seed_first[code];
+
+    cursor = (unsigned int *)vrna_alloc(sizeof(unsigned int) * num);
+    memcpy(cursor, target->seed_first, sizeof(unsigned int) * num);
+
+    for (p = 11; p + (int)seed_length - 1 <= n1 - 10; p++) {
+      for (code = 0, k = 0; k < seed_length; k++) {
+        if ((target->S1[p + k] < 1) || (target->S1[p + k] > 4))
+          break;
+
+        code = (code << 2) | (unsigned int)(target->S1[p + k] - 1);
+      }
+      if (k == seed_length)
+        target->seed_pos[cursor[code]++] = (unsigned int)p;
+    }
+
+    free(cursor);
+  }
+
+  return target;
+}
+
+
+PUBLIC void
+vrna_plex_target_free(vrna_plex_target_t *target)
+{
+  int i;
+
+  if (target) {
+    if (target->DI) {
+      for (i = 0; i <= 3; i++)
+        free(target->DI[i]);
+      free(target->DI);
+    }
+
+    free(target->sequence);
+    free(target->S1);
+    free(target->SS1);
+    free(target->seed_first);
+    free(target->seed_pos);
+    free(target);
+  }
+}
+
+
+PUBLIC void
+vrna_plex_scan_target(vrna_plex_t               *plex,
+                      const vrna_plex_target_t  *target,
+                      const char                *s2,
+                      const int                 **access_s2,
+                      const int                 threshold,
+                      const int                 extension_cost,
+                      const int                 alignment_length,
+                      const int                 delta,
+                      const int                 fast,
+                      const int                 il_a,
+                      const int                 il_b,
+                      const int                 b_a,
+                      const int                 b_b)
+{
+  if ((!plex) || (!target) || (!s2))
+    return;
+
+  if (target->access) {
+    if (!access_s2) {
+      vrna_message_warning("vrna_plex_scan_target: "
+                           "Target with accessibility profile requires a query profile");
+      return;
+    }
+
+    scan_XS(plex,
+            target,
+            target->sequence,
+            s2,
+            target->access,
+            access_s2,
+            threshold,
+            alignment_length,
+            delta,
+            fast,
+            il_a,
+            il_b,
+            b_a,
+            b_b);
+  } else {
+    scan(plex,
+         target,
+         target->sequence,
+         s2,
+         threshold,
+         extension_cost,
+         alignment_length,
+         delta,
+         fast,
+         il_a,
+         il_b,
+         b_a,
+         b_b);
+  }
+}
 
 
 /*-----------------------------------------------------------------------duplexfold_XS---------------------------------------------------------------------------*/
@@ -282,7 +577,8 @@ PRIVATE int   n3, n4; /*sequence length for the duplex*/;
 *** profiles, i_pos, j_pos are the coordinates of the closing pair.
 **/
 PRIVATE duplexT
-duplexfold_XS(const char  *s1,
+duplexfold_XS(vrna_plex_t *plex,
+              const char  *s1,
               const char  *s2,
               const int   **access_s1,
               const int   **access_s2,
@@ -292,45 +588,33 @@ duplexfold_XS(const char  *s1,
               const int   i_flag,
               const int   j_flag)
 {
-  int       i, j, p, q, Emin = INF, l_min = 0, k_min = 0;
-  char      *struc;
-  vrna_md_t md;
+  int     i, j, p, q, Emin = INF, l_min = 0, k_min = 0;
+  char    *struc;
 
   struc = NULL;
-  duplexT   mfe;
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
-
-  set_model_details(&md);
-
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  c = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  for (i = 0; i <= n3; i++)
-    c[i] = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-  for (i = 0; i <= n3; i++)
-    for (j = 0; j <= n4; j++)
-      c[i][j] = INF;
-  encode_seqs(s1, s2);
+  duplexT mfe;
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
+
+  plex->c = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  for (i = 0; i <= plex->n3; i++)
+    plex->c[i] = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+  for (i = 0; i <= plex->n3; i++)
+    for (j = 0; j <= plex->n4; j++)
+      plex->c[i][j] = INF;
+  encode_seqs(plex, s1, s2);
   int type, type2, type3, E, k, l;
-  i     = n3 - i_flag;
+  i     = plex->n3 - i_flag;
   j     = 1 + j_flag;
-  type  = pair[S1[i]][S2[j]];
+  type  = plex->pair[plex->S1[i]][plex->S2[j]];
   if (!type) {
-    printf("Error during initialization of the duplex in duplexfold_XS\n");
+    plex_printf(plex, "Error during initialization of the duplex in duplexfold_XS\n");
     mfe.structure = NULL;
     mfe.energy    = INF;
     return mfe;
   }
 
-  c[i][j] = P->DuplexInit;
+  plex->c[i][j] = plex->P->DuplexInit;
   /**  if (type>2) c[i][j] += P->TerminalAU;
    ***  c[i][j]+=P->dangle3[rtype[type]][SS1[i+1]];
    ***  c[i][j]+=P->dangle5[rtype[type]][SS2[j-1]];
@@ -338,7 +622,7 @@ duplexfold_XS(const char  *s1,
    **/
 
 
-  c[i][j] += vrna_E_ext_stem(rtype[type], (j_flag ? SS2[j - 1] : -1), (i_flag ? SS1[i + 1] : -1), P);
+  plex->c[i][j] += vrna_E_ext_stem(plex->rtype[type], (j_flag ? plex->SS2[j - 1] : -1), (i_flag ? plex->SS1[i + 1] : -1), plex->P);
 
   /*   if(j_flag ==0 && i_flag==0){ */
   /*     c[i][j] += vrna_E_ext_stem(rtype[type], -1 , -1 , P); */
@@ -353,48 +637,48 @@ duplexfold_XS(const char  *s1,
   /*  k_min, l_min and Emin */
   k_min = i;
   l_min = j;
-  Emin  = c[i][j];
+  Emin  = plex->c[i][j];
   for (k = i; k > 1; k--) {
     if (k < i)
-      c[k + 1][0] = INF;
+      plex->c[k + 1][0] = INF;
 
-    for (l = j; l <= n4 - 1; l++) {
+    for (l = j; l <= plex->n4 - 1; l++) {
       if (!(k == i && l == j))
-        c[k][l] = INF;
+        plex->c[k][l] = INF;
 
-      type2 = pair[S1[k]][S2[l]];
+      type2 = plex->pair[plex->S1[k]][plex->S2[l]];
       if (!type2)
         continue;
 
-      for (p = k + 1; p <= n3 - i_flag && p < k + MAXLOOP - 1; p++) {
+      for (p = k + 1; p <= plex->n3 - i_flag && p < k + MAXLOOP - 1; p++) {
         for (q = l - 1; q >= 1 + j_flag; q--) {
           if (p - k + l - q - 2 > MAXLOOP)
             break;
 
-          type3 = pair[S1[p]][S2[q]];
+          type3 = plex->pair[plex->S1[p]][plex->S2[q]];
           if (!type3)
             continue;
 
           E = E_IntLoop(p - k - 1,
                         l - q - 1,
                         type2,
-                        rtype[type3],
-                        SS1[k + 1],
-                        SS2[l - 1],
-                        SS1[p - 1],
-                        SS2[q + 1],
-                        P);
-          c[k][l] = MIN2(c[k][l], c[p][q] + E);
+                        plex->rtype[type3],
+                        plex->SS1[k + 1],
+                        plex->SS2[l - 1],
+                        plex->SS1[p - 1],
+                        plex->SS2[q + 1],
+                        plex->P);
+          plex->c[k][l] = MIN2(plex->c[k][l], plex->c[p][q] + E);
         }
       }
-      E = c[k][l];
+      E = plex->c[k][l];
       E += access_s1[i - k + 1][i_pos] + access_s2[l - 1][j_pos + (l - 1) - 1];
       /**if (type2>2) E += P->TerminalAU;
        ***if (k>1) E += P->dangle5[type2][SS1[k-1]];
        ***if (l<n4) E += P->dangle3[type2][SS2[l+1]];
        *** Replaced by the line below
        **/
-      E += vrna_E_ext_stem(type2, (k > 1) ? SS1[k - 1] : -1, (l < n4) ? SS2[l + 1] : -1, P);
+      E += vrna_E_ext_stem(type2, (k > 1) ? plex->SS1[k - 1] : -1, (l < plex->n4) ? plex->SS2[l + 1] : -1, plex->P);
 
       if (E < Emin) {
         Emin  = E;
@@ -408,16 +692,16 @@ duplexfold_XS(const char  *s1,
     mfe.energy    = INF;
     mfe.ddG       = INF;
     mfe.structure = NULL;
-    for (i = 0; i <= n3; i++)
-      free(c[i]);
-    free(c);
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    for (i = 0; i <= plex->n3; i++)
+      free(plex->c[i]);
+    free(plex->c);
+    free(plex->S1);
+    free(plex->S2);
+    free(plex->SS1);
+    free(plex->SS2);
     return mfe;
   } else {
-    struc = backtrack_XS(k_min, l_min, access_s1, access_s2, i_flag, j_flag);
+    struc = backtrack_XS(plex, k_min, l_min, access_s1, access_s2, i_flag, j_flag);
   }
 
   /**
@@ -451,62 +735,63 @@ duplexfold_XS(const char  *s1,
   mfe.energy = mfe.ddG - mfe.dG1 - mfe.dG2;
 
   mfe.structure = struc;
-  for (i = 0; i <= n3; i++)
-    free(c[i]);
-  free(c);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  for (i = 0; i <= plex->n3; i++)
+    free(plex->c[i]);
+  free(plex->c);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
   return mfe;
 }
 
 
 PRIVATE char *
-backtrack_XS(int        i,
-             int        j,
-             const int  **access_s1,
-             const int  **access_s2,
-             const int  i_flag,
-             const int  j_flag)
+backtrack_XS(vrna_plex_t  *plex,
+             int          i,
+             int          j,
+             const int    **access_s1,
+             const int    **access_s2,
+             const int    i_flag,
+             const int    j_flag)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, type, type2, E, traced, i0, j0;
   char  *st1, *st2, *struc;
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
   i0  = i; /*MAX2(i-1,1);*/ j0 = j;/*MIN2(j+1,n4);*/
-  while (i <= n3 - i_flag && j >= 1 + j_flag) {
-    E           = c[i][j];
+  while (i <= plex->n3 - i_flag && j >= 1 + j_flag) {
+    E           = plex->c[i][j];
     traced      = 0;
     st1[i - 1]  = '(';
     st2[j - 1]  = ')';
-    type        = pair[S1[i]][S2[j]];
+    type        = plex->pair[plex->S1[i]][plex->S2[j]];
     if (!type)
       vrna_message_error("backtrack failed in fold duplex bli");
 
-    for (k = i + 1; k <= n3 && k > i - MAXLOOP - 2; k++) {
+    for (k = i + 1; k <= plex->n3 && k > i - MAXLOOP - 2; k++) {
       for (l = j - 1; l >= 1; l--) {
         int LE;
         if (i - k + l - j - 2 > MAXLOOP)
           break;
 
-        type2 = pair[S1[k]][S2[l]];
+        type2 = plex->pair[plex->S1[k]][plex->S2[l]];
         if (!type2)
           continue;
 
         LE = E_IntLoop(k - i - 1,
                        j - l - 1,
                        type,
-                       rtype[type2],
-                       SS1[i + 1],
-                       SS2[j - 1],
-                       SS1[k - 1],
-                       SS2[l + 1],
-                       P);
-        if (E == c[k][l] + LE) {
+                       plex->rtype[type2],
+                       plex->SS1[i + 1],
+                       plex->SS2[j - 1],
+                       plex->SS1[k - 1],
+                       plex->SS2[l + 1],
+                       plex->P);
+        if (E == plex->c[k][l] + LE) {
           traced  = 1;
           i       = k;
           j       = l;
@@ -518,19 +803,19 @@ backtrack_XS(int        i,
     }
     if (!traced) {
 #if 0
-      if (i < n3)
-        E -= P->dangle3[rtype[type]][SS1[i + 1]];      /* +access_s1[1][i+1]; */
+      if (i < plex->n3)
+        E -= plex->P->dangle3[plex->rtype[type]][plex->SS1[i + 1]];      /* +access_s1[1][i+1]; */
 
       if (j > 1)
-        E -= P->dangle5[rtype[type]][SS2[j - 1]];      /* +access_s2[1][j+1]; */
+        E -= plex->P->dangle5[plex->rtype[type]][plex->SS2[j - 1]];      /* +access_s2[1][j+1]; */
 
       if (type > 2)
-        E -= P->TerminalAU;
+        E -= plex->P->TerminalAU;
 
 #endif
-      E -= vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P);
+      E -= vrna_E_ext_stem(plex->rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], plex->P);
       break;
-      if (E != P->DuplexInit)
+      if (E != plex->P->DuplexInit)
         vrna_message_error("backtrack failed in fold duplex bal");
       else
         break;
@@ -562,17 +847,18 @@ backtrack_XS(int        i,
 *** We use the standard matrix (c, in, etc..., because we backtrack)
 **/
 PRIVATE duplexT
-fduplexfold_XS(const char *s1,
-               const char *s2,
-               const int  **access_s1,
-               const int  **access_s2,
-               const int  i_pos,
-               const int  j_pos,
-               const int  threshold,
-               const int  il_a,
-               const int  il_b,
-               const int  b_a,
-               const int  b_b)
+fduplexfold_XS(vrna_plex_t  *plex,
+               const char   *s1,
+               const char   *s2,
+               const int    **access_s1,
+               const int    **access_s2,
+               const int    i_pos,
+               const int    j_pos,
+               const int    threshold,
+               const int    il_a,
+               const int    il_b,
+               const int    b_a,
+               const int    b_b)
 {
   /**
   *** i,j recursion index
@@ -598,86 +884,75 @@ fduplexfold_XS(const char *s1,
   *** DJ contains the accessibility penalty for the query sequence
   *** maxPenalty contains the maximum penalty
   **/
-  int       bopen       = b_b;
-  int       bext        = b_a;
-  int       iopen       = il_b;
-  int       iext_s      = 2 * il_a;   /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
-  int       iext_ass    = 50 + il_a;  /* iext_ass assymetric extension of interior loop, either on i or on j side. */
-  int       min_colonne = INF;        /* enthaelt das maximum einer kolonne */
-  int       i_length;
-  int       max_pos;                  /* get position of the best hit */
-  int       max_pos_j;
-  int       temp = INF;
-  int       min_j_colonne;
-  int       max = INF;
-  int       **DJ;
-  int       maxPenalty[4];
-  vrna_md_t md;
+  int bopen       = b_b;
+  int bext        = b_a;
+  int iopen       = il_b;
+  int iext_s      = 2 * il_a;   /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
+  int iext_ass    = 50 + il_a;  /* iext_ass assymetric extension of interior loop, either on i or on j side. */
+  int min_colonne = INF;        /* enthaelt das maximum einer kolonne */
+  int i_length;
+  int max_pos;                  /* get position of the best hit */
+  int max_pos_j;
+  int temp = INF;
+  int min_j_colonne;
+  int max = INF;
+  int **DJ;
+  int maxPenalty[4];
 
   /**
   *** variable initialization
   **/
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
-
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
 
   /**
   *** array initialization
   **/
-  c   = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  in  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  bx  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  by  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  inx = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  iny = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
+  plex->c   = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->in  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->bx  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->by  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->inx = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->iny = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
   /* #pragma omp parallel for */
-  for (i = 0; i <= n3; i++) {
-    c[i]    = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    in[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    bx[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    by[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    inx[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    iny[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
+  for (i = 0; i <= plex->n3; i++) {
+    plex->c[i]    = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->in[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->bx[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->by[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->inx[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->iny[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
   }
-  for (i = 0; i < n3; i++) {
-    for (j = 0; j < n4; j++) {
-      in[i][j]  = INF;  /* no in before  1 */
-      c[i][j]   = INF;  /* no bulge and no in before n2 */
-      bx[i][j]  = INF;  /* no bulge before 1 */
-      by[i][j]  = INF;
-      inx[i][j] = INF;  /* no bulge before 1 */
-      iny[i][j] = INF;
+  for (i = 0; i < plex->n3; i++) {
+    for (j = 0; j < plex->n4; j++) {
+      plex->in[i][j]  = INF;  /* no in before  1 */
+      plex->c[i][j]   = INF;  /* no bulge and no in before n2 */
+      plex->bx[i][j]  = INF;  /* no bulge before 1 */
+      plex->by[i][j]  = INF;
+      plex->inx[i][j] = INF;  /* no bulge before 1 */
+      plex->iny[i][j] = INF;
     }
   }
   /**
   *** sequence encoding
   **/
-  encode_seqs(s1, s2);
+  encode_seqs(plex, s1, s2);
   /**
   *** Compute max accessibility penalty for the query only once
   **/
-  maxPenalty[0] = (int)-1 * P->stack[2][2] / 2;
-  maxPenalty[1] = (int)-1 * P->stack[2][2];
-  maxPenalty[2] = (int)-3 * P->stack[2][2] / 2;
-  maxPenalty[3] = (int)-2 * P->stack[2][2];
+  maxPenalty[0] = (int)-1 * plex->P->stack[2][2] / 2;
+  maxPenalty[1] = (int)-1 * plex->P->stack[2][2];
+  maxPenalty[2] = (int)-3 * plex->P->stack[2][2] / 2;
+  maxPenalty[3] = (int)-2 * plex->P->stack[2][2];
 
 
   DJ    = (int **)vrna_alloc(4 * sizeof(int *));
-  DJ[0] = (int *)vrna_alloc((1 + n4) * sizeof(int));
-  DJ[1] = (int *)vrna_alloc((1 + n4) * sizeof(int));
-  DJ[2] = (int *)vrna_alloc((1 + n4) * sizeof(int));
-  DJ[3] = (int *)vrna_alloc((1 + n4) * sizeof(int));
+  DJ[0] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
+  DJ[1] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
+  DJ[2] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
+  DJ[3] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
 
-  j = n4 - 9;
+  j = plex->n4 - 9;
   while (--j > 9) {
     int jdiff = j_pos + j - 11;
     /**
@@ -716,10 +991,10 @@ fduplexfold_XS(const char *s1,
   *** allow to reduce number of if test
   **/
   i         = 11;
-  i_length  = n3 - 9;
+  i_length  = plex->n3 - 9;
   while (i < i_length) {
     int di1, di2, di3, di4;
-    int idiff = i_pos - (n3 - 10 - i);
+    int idiff = i_pos - (plex->n3 - 10 - i);
     di1 = 0.5 *
           (access_s1[5][idiff + 4] - access_s1[4][idiff + 4] + access_s1[5][idiff] -
            access_s1[4][idiff - 1]);
@@ -742,7 +1017,7 @@ fduplexfold_XS(const char *s1,
      *  di3=MIN2(di3,maxPenalty[2]);
      *  di4=MIN2(di4,maxPenalty[3]);
      */
-    j           = n4 - 9;
+    j           = plex->n4 - 9;
     min_colonne = INF;
     while (10 < --j) {
       int dj1, dj2, dj3, dj4;
@@ -752,58 +1027,58 @@ fduplexfold_XS(const char *s1,
       dj3 = DJ[2][j];
       dj4 = DJ[3][j];
       int type, type2;
-      type = pair[S1[i]][S2[j]];
+      type = plex->pair[plex->S1[i]][plex->S2[j]];
       /**
       *** Start duplex
       **/
       /*
        * c[i][j]=type ? P->DuplexInit + access_s1[1][idiff]+access_s2[1][jdiff] : INF;
        */
-      c[i][j] = type ? P->DuplexInit : INF;
+      plex->c[i][j] = type ? plex->P->DuplexInit : INF;
       /**
       *** update lin bx by linx liny matrix
       **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
+      type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
       /**
       *** start/extend interior loop
       **/
-      in[i][j] = MIN2(
-        c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1,
-        in[i - 1][j] + iext_ass + di1);
+      plex->in[i][j] = MIN2(
+        plex->c[i - 1][j + 1] + plex->P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1,
+        plex->in[i - 1][j] + iext_ass + di1);
 
       /**
       *** start/extend nx1 target
       *** use same type2 as for in
       **/
-      inx[i][j] = MIN2(
-        c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1,
-        inx[i - 1][j] + iext_ass + di1);
+      plex->inx[i][j] = MIN2(
+        plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1,
+        plex->inx[i - 1][j] + iext_ass + di1);
       /**
       *** start/extend 1xn target
       *** use same type2 as for in
       **/
-      iny[i][j] = MIN2(
-        c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1,
-        iny[i][j + 1] + iext_ass + dj1);
+      plex->iny[i][j] = MIN2(
+        plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1,
+        plex->iny[i][j + 1] + iext_ass + dj1);
       /**
       *** extend interior loop
       **/
-      in[i][j]  = MIN2(in[i][j], in[i][j + 1] + iext_ass + dj1);
-      in[i][j]  = MIN2(in[i][j], in[i - 1][j + 1] + iext_s + di1 + dj1);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i][j + 1] + iext_ass + dj1);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i - 1][j + 1] + iext_s + di1 + dj1);
       /**
       *** start/extend bulge target
       **/
-      type2     = pair[S2[j]][S1[i - 1]];
-      bx[i][j]  =
-        MIN2(bx[i - 1][j] + bext + di1,
-             c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + di1);
+      type2     = plex->pair[plex->S2[j]][plex->S1[i - 1]];
+      plex->bx[i][j]  =
+        MIN2(plex->bx[i - 1][j] + bext + di1,
+             plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0) + di1);
       /**
       *** start/extend bulge query
       **/
-      type2     = pair[S2[j + 1]][S1[i]];
-      by[i][j]  =
-        MIN2(by[i][j + 1] + bext + dj1,
-             c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + dj1);
+      type2     = plex->pair[plex->S2[j + 1]][plex->S1[i]];
+      plex->by[i][j]  =
+        MIN2(plex->by[i][j + 1] + bext + dj1,
+             plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0) + dj1);
       /**
        ***end update recursion
        ***######################## Start stack extension##############################
@@ -811,37 +1086,37 @@ fduplexfold_XS(const char *s1,
       if (!type)
         continue;
 
-      c[i][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
+      plex->c[i][j] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], plex->P);
       /**
       *** stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        c[i][j] = MIN2(c[i - 1][j + 1] + P->stack[rtype[type]][type2] + di1 + dj1, c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+        plex->c[i][j] = MIN2(plex->c[i - 1][j + 1] + plex->P->stack[plex->rtype[type]][type2] + di1 + dj1, plex->c[i][j]);
 
       /**
       *** 1x0 / 0x1 stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 2]]))
-        c[i][j] = MIN2(c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2,
-                       c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 2]]))
+        plex->c[i][j] = MIN2(plex->c[i - 1][j + 2] + plex->P->bulge[1] + plex->P->stack[plex->rtype[type]][type2] + di1 + dj2,
+                             plex->c[i][j]);
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 1]]))
-        c[i][j] = MIN2(c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1,
-                       c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 1]]))
+        plex->c[i][j] = MIN2(plex->c[i - 2][j + 1] + plex->P->bulge[1] + plex->P->stack[type2][plex->rtype[type]] + di2 + dj1,
+                             plex->c[i][j]);
 
       /**
       *** 1x1 / 2x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 2]][S2[j + 2]]))
-        c[i][j] = MIN2(
-          c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj2,
-          c[i][j]);
-
-      if ((type2 = pair[S1[i - 3]][S2[j + 3]])) {
-        c[i][j] =
-          MIN2(c[i - 3][j + 3] +
-               P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di3 + dj3,
-               c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 2]]))
+        plex->c[i][j] = MIN2(
+          plex->c[i - 2][j + 2] + plex->P->int11[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj2,
+          plex->c[i][j]);
+
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 3]])) {
+        plex->c[i][j] =
+          MIN2(plex->c[i - 3][j + 3] +
+               plex->P->int22[type2][plex->rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di3 + dj3,
+               plex->c[i][j]);
       }
 
       /**
@@ -849,32 +1124,32 @@ fduplexfold_XS(const char *s1,
       *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
       *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
       **/
-      if ((type2 = pair[S1[i - 3]][S2[j + 2]])) {
-        c[i][j] =
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 2]])) {
+        plex->c[i][j] =
           MIN2(
-            c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + di3 + dj2,
-            c[i][j]);
+            plex->c[i - 3][j + 2] + plex->P->int21[plex->rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + di3 + dj2,
+            plex->c[i][j]);
       }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 3]])) {
-        c[i][j] =
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 3]])) {
+        plex->c[i][j] =
           MIN2(
-            c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di2 + dj3,
-            c[i][j]);
+            plex->c[i - 2][j + 3] + plex->P->int21[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di2 + dj3,
+            plex->c[i][j]);
       }
 
       /**
       *** 2x3 / 3x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]]))
-        c[i][j] = MIN2(c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di4 + dj3, c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 4]][plex->S2[j + 3]]))
+        plex->c[i][j] = MIN2(plex->c[i - 4][j + 3] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                             plex->P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                             plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di4 + dj3, plex->c[i][j]);
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]]))
-        c[i][j] = MIN2(c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di3 + dj4, c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 4]]))
+        plex->c[i][j] = MIN2(plex->c[i - 3][j + 4] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                             plex->P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                             plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di3 + dj4, plex->c[i][j]);
 
       /**
       *** So now we have to handle 1x3, 3x1, 3x3, and mxn m,n > 3
@@ -882,48 +1157,48 @@ fduplexfold_XS(const char *s1,
       /**
       *** 3x3 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + di3 + dj3,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 3][j + 3] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + di3 + dj3,
+        plex->c[i][j]);
       /**
       *** 2xn or more
       **/
-      c[i][j] = MIN2(
-        in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 4][j + 2] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
+        plex->c[i][j]);
       /**
       *** nx2 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 2][j + 4] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
+        plex->c[i][j]);
       /**
       *** nx1 n>2
       **/
-      c[i][j] = MIN2(
-        inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->inx[i - 3][j + 1] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
+        plex->c[i][j]);
       /**
       *** 1xn n>2
       **/
-      c[i][j] = MIN2(
-        iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->iny[i - 1][j + 3] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
+        plex->c[i][j]);
       /**
       *** nx0 n>1
       **/
       int bAU;
-      bAU     = (type > 2 ? P->TerminalAU : 0);
-      c[i][j] = MIN2(bx[i - 2][j + 1] + di2 + dj1 + bext + bAU, c[i][j]);
+      bAU           = (type > 2 ? plex->P->TerminalAU : 0);
+      plex->c[i][j] = MIN2(plex->bx[i - 2][j + 1] + di2 + dj1 + bext + bAU, plex->c[i][j]);
       /**
       *** 0xn n>1
       **/
-      c[i][j] = MIN2(by[i - 1][j + 2] + di1 + dj2 + bext + bAU, c[i][j]);
+      plex->c[i][j] = MIN2(plex->by[i - 1][j + 2] + di1 + dj2 + bext + bAU, plex->c[i][j]);
       /*
        * remove this line printf("%d\t",c[i][j]);
        */
       temp        = min_colonne;
-      min_colonne = MIN2(c[i][j] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P), min_colonne);
+      min_colonne = MIN2(plex->c[i][j] + vrna_E_ext_stem(plex->rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], plex->P), min_colonne);
       if (temp > min_colonne)
         min_j_colonne = j;
 
@@ -942,26 +1217,26 @@ fduplexfold_XS(const char *s1,
   }
   Emin = max;
   if (Emin > threshold) {
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
-    for (i = 0; i <= n3; i++) {
-      free(c[i]);
-      free(in[i]);
-      free(bx[i]);
-      free(by[i]);
-      free(inx[i]);
-      free(iny[i]);
+    free(plex->S1);
+    free(plex->S2);
+    free(plex->SS1);
+    free(plex->SS2);
+    for (i = 0; i <= plex->n3; i++) {
+      free(plex->c[i]);
+      free(plex->in[i]);
+      free(plex->bx[i]);
+      free(plex->by[i]);
+      free(plex->inx[i]);
+      free(plex->iny[i]);
     }
     for (i = 0; i <= 3; i++)
       free(DJ[i]);
-    free(c);
-    free(in);
-    free(bx);
-    free(by);
-    free(inx);
-    free(iny);
+    free(plex->c);
+    free(plex->in);
+    free(plex->bx);
+    free(plex->by);
+    free(plex->inx);
+    free(plex->iny);
     free(DJ);
     mfe.energy    = 0;
     mfe.structure = NULL;
@@ -973,7 +1248,8 @@ fduplexfold_XS(const char *s1,
   int dGe, dGeplex, dGx, dGy;
   dGe = dGeplex = dGx = dGy = 0;
   /* printf("MAX fduplexfold_XS %d\n",Emin); */
-  struc = fbacktrack_XS(i_min,
+  struc = fbacktrack_XS(plex,
+                        i_min,
                         j_min,
                         access_s1,
                         access_s2,
@@ -998,12 +1274,12 @@ fduplexfold_XS(const char *s1,
   lengthx = l1;
   lengthx -= (struc[0] == '.' ? 1 : 0);
   lengthx -= (struc[l1 - 1] == '.' ? 1 : 0);
-  endx    = (i_pos - (n3 - i_min));
+  endx    = (i_pos - (plex->n3 - i_min));
   lengthy = size - l1;
   lengthy -= (struc[size] == '.' ? 1 : 0);
   lengthy -= (struc[l1 + 1] == '.' ? 1 : 0);
   endy    = j_pos + j_min + lengthy - 22;
-  if (i_min < n3 - 10)
+  if (i_min < plex->n3 - 10)
     i_min++;
 
   if (j_min > 11)
@@ -1019,46 +1295,47 @@ fduplexfold_XS(const char *s1,
   mfe.opening_backtrack_y = (double)dGy * 0.01;
   mfe.dG1                 = 0;  /* !remove access to complete access array (double) access_s1[lengthx][endx+10] * 0.01; */
   mfe.dG2                 = 0;  /* !remove access to complete access array (double) access_s2[lengthy][endy+10] * 0.01; */
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
-  for (i = 0; i <= n3; i++) {
-    free(c[i]);
-    free(in[i]);
-    free(bx[i]);
-    free(by[i]);
-    free(inx[i]);
-    free(iny[i]);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
+  for (i = 0; i <= plex->n3; i++) {
+    free(plex->c[i]);
+    free(plex->in[i]);
+    free(plex->bx[i]);
+    free(plex->by[i]);
+    free(plex->inx[i]);
+    free(plex->iny[i]);
   }
   for (i = 0; i <= 3; i++)
     free(DJ[i]);
   free(DJ);
-  free(c);
-  free(in);
-  free(bx);
-  free(by);
-  free(iny);
-  free(inx);
+  free(plex->c);
+  free(plex->in);
+  free(plex->bx);
+  free(plex->by);
+  free(plex->iny);
+  free(plex->inx);
   return mfe;
 }
 
 
 PRIVATE char *
-fbacktrack_XS(int       i,
-              int       j,
-              const int **access_s1,
-              const int **access_s2,
-              const int i_pos,
-              const int j_pos,
-              const int il_a,
-              const int il_b,
-              const int b_a,
-              const int b_b,
-              int       *dG,
-              int       *dGplex,
-              int       *dGx,
-              int       *dGy)
+fbacktrack_XS(vrna_plex_t *plex,
+              int         i,
+              int         j,
+              const int   **access_s1,
+              const int   **access_s2,
+              const int   i_pos,
+              const int   j_pos,
+              const int   il_a,
+              const int   il_b,
+              const int   b_a,
+              const int   b_b,
+              int         *dG,
+              int         *dGplex,
+              int         *dGx,
+              int         *dGy)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
@@ -1070,9 +1347,9 @@ fbacktrack_XS(int       i,
   int   iext_s    = 2 * il_a;   /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
   int   iext_ass  = 50 + il_a;  /* iext_ass assymetric extension of interior loop, either on i or on j side. */
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
-  i0  = MIN2(i + 1, n3 - 10);
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
+  i0  = MIN2(i + 1, plex->n3 - 10);
   j0  = MAX2(j - 1, 11);
   int state;
   state = 1; /* we start backtracking from a a pair , i.e. c-matrix */
@@ -1084,37 +1361,25 @@ fbacktrack_XS(int       i,
   traced  = 1;
   k       = i;
   l       = j; /* stores the i,j information for subsequence usage see * */
-  int       idiff, jdiff;
+  int idiff, jdiff;
   /**
   *** (type>2?P->TerminalAU:0)+P->dangle3[rtype[type]][SS1[i+1]]+P->dangle5[rtype[type]][SS2[j-1]];
   **/
 
-  int       maxPenalty[4];
-  vrna_md_t md;
+  int maxPenalty[4];
 
-  set_model_details(&md);
+  maxPenalty[0] = (int)-1 * plex->P->stack[2][2] / 2;
+  maxPenalty[1] = (int)-1 * plex->P->stack[2][2];
+  maxPenalty[2] = (int)-3 * plex->P->stack[2][2] / 2;
+  maxPenalty[3] = (int)-2 * plex->P->stack[2][2];
 
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_dfold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  maxPenalty[0] = (int)-1 * P->stack[2][2] / 2;
-  maxPenalty[1] = (int)-1 * P->stack[2][2];
-  maxPenalty[2] = (int)-3 * P->stack[2][2] / 2;
-  maxPenalty[3] = (int)-2 * P->stack[2][2];
-
-  type    = pair[S1[i]][S2[j]];
-  *dG     += vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P);
+  type    = plex->pair[plex->S1[i]][plex->S2[j]];
+  *dG     += vrna_E_ext_stem(plex->rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], plex->P);
   *dGplex = *dG;
 
-  while (i > 10 && j <= n4 - 9 && traced) {
+  while (i > 10 && j <= plex->n4 - 9 && traced) {
     int di1, di2, di3, di4;
-    idiff = i_pos - (n3 - 10 - i);
+    idiff = i_pos - (plex->n3 - 10 - i);
     di1   = 0.5 *
             (access_s1[5][idiff + 4] - access_s1[4][idiff + 4] + access_s1[5][idiff] -
              access_s1[4][idiff - 1]);
@@ -1166,34 +1431,34 @@ fbacktrack_XS(int       i,
     traced = 0;
     switch (state) {
       case 1:
-        type = pair[S1[i]][S2[j]];
+        type = plex->pair[plex->S1[i]][plex->S2[j]];
         int bAU;
-        bAU = (type > 2 ? P->TerminalAU : 0);
+        bAU = (type > 2 ? plex->P->TerminalAU : 0);
         if (!type)
           vrna_message_error("backtrack failed in fold duplex");
 
-        type2 = pair[S1[i - 1]][S2[j + 1]];
-        if (type2 && c[i][j] == (c[i - 1][j + 1] + P->stack[rtype[type]][type2] + di1 + dj1)) {
+        type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 1]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 1][j + 1] + plex->P->stack[plex->rtype[type]][type2] + di1 + dj1)) {
           k     = i - 1;
           l     = j + 1;
           (*dG) += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di1;
           *dGy        += dj1;
           st1[i - 1]  = '(';
@@ -1205,29 +1470,29 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 1]][S2[j + 2]];
+        type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] == (c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2)) {
+            plex->c[i][j] == (plex->c[i - 1][j + 2] + plex->P->bulge[1] + plex->P->stack[plex->rtype[type]][type2] + di1 + dj2)) {
           k   = i - 1;
           l   = j + 2;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di1;
           *dGy        += dj2;
           st1[i - 1]  = '(';
@@ -1239,29 +1504,29 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 1]];
+        type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 1]];
         if (type2 &&
-            c[i][j] == (c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1)) {
+            plex->c[i][j] == (plex->c[i - 2][j + 1] + plex->P->bulge[1] + plex->P->stack[type2][plex->rtype[type]] + di2 + dj1)) {
           k   = i - 2;
           l   = j + 1;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di2;
           *dGy        += dj1;
           st1[i - 1]  = '(';
@@ -1273,30 +1538,30 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 2]];
+        type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj2)) {
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 2] + plex->P->int11[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj2)) {
           k   = i - 2;
           l   = j + 2;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di2;
           *dGy        += dj2;
           st1[i - 1]  = '(';
@@ -1308,32 +1573,32 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 3]];
+        type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 3] +
-             P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di3 +
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 3] +
+             plex->P->int22[type2][plex->rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di3 +
              dj3)) {
           k   = i - 3;
           l   = j + 3;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di3;
           *dGy        += dj3;
           st1[i - 1]  = '(';
@@ -1345,10 +1610,10 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 2]];
+        type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] +
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 2] + plex->P->int21[plex->rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] +
              di3 +
              dj2)) {
           k   = i - 3;
@@ -1356,21 +1621,21 @@ fbacktrack_XS(int       i,
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di3;
           *dGy        += dj2;
           st1[i - 1]  = '(';
@@ -1382,10 +1647,10 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 3]];
+        type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] +
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 3] + plex->P->int21[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] +
              di2 +
              dj3)) {
           k   = i - 2;
@@ -1393,21 +1658,21 @@ fbacktrack_XS(int       i,
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di2;
           *dGy        += dj3;
           st1[i - 1]  = '(';
@@ -1419,30 +1684,30 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 4]][S2[j + 3]];
-        if (type2 && c[i][j] == (c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di4 + dj3)) {
+        type2 = plex->pair[plex->S1[i - 4]][plex->S2[j + 3]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 4][j + 3] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                       plex->P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                       plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di4 + dj3)) {
           k   = i - 4;
           l   = j + 3;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di2;
           *dGy        += dj3;
           st1[i - 1]  = '(';
@@ -1454,30 +1719,30 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 4]];
-        if (type2 && c[i][j] == (c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di3 + dj4)) {
+        type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 4]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 3][j + 4] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                       plex->P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                       plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di3 + dj4)) {
           k   = i - 3;
           l   = j + 4;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
-                               rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
-                               P);
+                               plex->rtype[type],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
+                               plex->P);
           *dGx        += di2;
           *dGy        += dj3;
           st1[i - 1]  = '(';
@@ -1489,12 +1754,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + di3 + dj3 + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 3][j + 3] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di3 + dj3 + 2 *
              iext_s)) {
           k           = i;
           l           = j;
-          *dGplex     += P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s;
+          *dGplex     += plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s;
           *dGx        += di3;
           *dGy        += dj3;
           st1[i - 1]  = '(';
@@ -1506,13 +1771,13 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + di4 + dj2 +
+        if (plex->c[i][j] ==
+            (plex->in[i - 4][j + 2] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di4 + dj2 +
              iext_s +
              2 * iext_ass)) {
           k           = i;
           l           = j;
-          *dGplex     += P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass;
+          *dGplex     += plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass;
           *dGx        += di4;
           *dGy        += dj2;
           st1[i - 1]  = '(';
@@ -1524,13 +1789,13 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj4 +
+        if (plex->c[i][j] ==
+            (plex->in[i - 2][j + 4] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj4 +
              iext_s +
              2 * iext_ass)) {
           k           = i;
           l           = j;
-          *dGplex     += P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass;
+          *dGplex     += plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass;
           *dGx        += di2;
           *dGy        += dj4;
           st1[i - 1]  = '(';
@@ -1542,12 +1807,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->inx[i - 3][j + 1] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + di3 + dj1)) {
           k       = i;
           l       = j;
-          *dGplex += P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass +
+          *dGplex += plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass +
                      di3 + dj1;
           *dGx        += di3;
           *dGy        += dj1;
@@ -1560,12 +1825,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->iny[i - 1][j + 3] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + di1 + dj3)) {
           k       = i;
           l       = j;
-          *dGplex += P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass +
+          *dGplex += plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass +
                      di1 + dj3;
           *dGx        += di1;
           *dGy        += dj3;
@@ -1578,7 +1843,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] == (bx[i - 2][j + 1] + di2 + dj1 + bext + bAU)) {
+        if (plex->c[i][j] == (plex->bx[i - 2][j + 1] + di2 + dj1 + bext + bAU)) {
           k           = i;
           l           = j;
           st1[i - 1]  = '(';
@@ -1593,7 +1858,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] == (by[i - 1][j + 2] + di1 + dj2 + bext + bAU)) {
+        if (plex->c[i][j] == (plex->by[i - 1][j + 2] + di1 + dj2 + bext + bAU)) {
           k           = i;
           l           = j;
           *dGplex     += bext + bAU;
@@ -1610,7 +1875,7 @@ fbacktrack_XS(int       i,
 
         break;
       case 2:
-        if (in[i][j] == (in[i - 1][j + 1] + iext_s + di1 + dj1)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j + 1] + iext_s + di1 + dj1)) {
           i--;
           j++;
           *dGplex += iext_s;
@@ -1621,7 +1886,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (in[i][j] == (in[i - 1][j] + iext_ass + di1)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j] + iext_ass + di1)) {
           i       = i - 1;
           *dGplex += iext_ass;
           *dGx    += di1;
@@ -1630,7 +1895,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (in[i][j] == (in[i][j + 1] + iext_ass + dj1)) {
+        if (plex->in[i][j] == (plex->in[i][j + 1] + iext_ass + dj1)) {
           j++;
           state   = 2;
           *dGy    += dj1;
@@ -1639,11 +1904,11 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[SS2[j + 1]][SS1[i - 1]];
+        type2 = plex->pair[plex->SS2[j + 1]][plex->SS1[i - 1]];
         if (type2 &&
-            in[i][j] ==
-            (c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1)) {
-          *dGplex += P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s;
+            plex->in[i][j] ==
+            (plex->c[i - 1][j + 1] + plex->P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1)) {
+          *dGplex += plex->P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s;
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1651,16 +1916,16 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           *dGx    += di1;
           *dGy    += dj1;
           i       = k;
@@ -1671,7 +1936,7 @@ fbacktrack_XS(int       i,
         }
 
       case 3:
-        if (bx[i][j] == (bx[i - 1][j] + bext + di1)) {
+        if (plex->bx[i][j] == (plex->bx[i - 1][j] + bext + di1)) {
           i--;
           *dGplex += bext;
           *dGx    += di1;
@@ -1680,9 +1945,9 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j]][S1[i - 1]];
+        type2 = plex->pair[plex->S2[j]][plex->S1[i - 1]];
         if (type2 &&
-            bx[i][j] == (c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + di1)) {
+            plex->bx[i][j] == (plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0) + di1)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1690,17 +1955,17 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
-          *dGplex += bopen + bext + (type2 > 2 ? P->TerminalAU : 0);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
+          *dGplex += bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0);
           *dGx    += di1;
           i       = k;
           j       = l;
@@ -1710,7 +1975,7 @@ fbacktrack_XS(int       i,
         }
 
       case 4:
-        if (by[i][j] == (by[i][j + 1] + bext + dj1)) {
+        if (plex->by[i][j] == (plex->by[i][j + 1] + bext + dj1)) {
           j++;
           *dGplex += bext;
           state   = 4;
@@ -1718,9 +1983,9 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i]];
+        type2 = plex->pair[plex->S2[j + 1]][plex->S1[i]];
         if (type2 &&
-            by[i][j] == (c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + dj1)) {
+            plex->by[i][j] == (plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0) + dj1)) {
           int temp;
           temp  = k;
           k     = i;
@@ -1728,17 +1993,17 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
-          *dGplex += bopen + bext + (type2 > 2 ? P->TerminalAU : 0);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
+          *dGplex += bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0);
           *dGy    += dj1;
           i       = k;
           j       = l;
@@ -1748,7 +2013,7 @@ fbacktrack_XS(int       i,
         }
 
       case 5:
-        if (inx[i][j] == (inx[i - 1][j] + iext_ass + di1)) {
+        if (plex->inx[i][j] == (plex->inx[i - 1][j] + iext_ass + di1)) {
           i--;
           *dGplex += iext_ass;
           *dGx    += di1;
@@ -1757,12 +2022,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            inx[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 +
+            plex->inx[i][j] ==
+            (plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 +
              dj1)) {
-          *dGplex += P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s;
+          *dGplex += plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s;
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1770,16 +2035,16 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           *dGx    += di1;
           *dGy    += dj1;
           i       = k;
@@ -1790,7 +2055,7 @@ fbacktrack_XS(int       i,
         }
 
       case 6:
-        if (iny[i][j] == (iny[i][j + 1] + iext_ass + dj1)) {
+        if (plex->iny[i][j] == (plex->iny[i][j + 1] + iext_ass + dj1)) {
           j++;
           *dGplex += iext_ass;
           *dGx    += dj1;
@@ -1799,12 +2064,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            iny[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 +
+            plex->iny[i][j] ==
+            (plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 +
              dj1)) {
-          *dGplex += P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s;
+          *dGplex += plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s;
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1812,16 +2077,16 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           *dGx    += di1;
           *dGy    += dj1;
           i       = k;
@@ -1833,16 +2098,16 @@ fbacktrack_XS(int       i,
     }
   }
   if (!traced) {
-    idiff = i_pos - (n3 - 10 - i);
+    idiff = i_pos - (plex->n3 - 10 - i);
     jdiff = j_pos + j - 11;
-    E     = c[i][j];
+    E     = plex->c[i][j];
     /**
     *** if (i>1) {E -= P->dangle5[type][SS1[i-1]]; *dG+=P->dangle5[type][SS1[i-1]];*dGplex+=P->dangle5[type][SS1[i-1]];}
     *** if (j<n4){E -= P->dangle3[type][SS2[j+1]]; *dG+=P->dangle3[type][SS2[j+1]];*dGplex+=P->dangle3[type][SS2[j+1]];}
     *** if (type>2) {E -= P->TerminalAU; *dG+=P->TerminalAU;*dGplex+=P->TerminalAU;}
     **/
     int correction;
-    correction  = vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+    correction  = vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, plex->P);
     *dG         += correction;
     *dGplex     += correction;
     E           -= correction;
@@ -1852,11 +2117,11 @@ fbacktrack_XS(int       i,
      *    vrna_message_error("backtrack failed in second fold duplex");
      *  }
      */
-    if (E != P->DuplexInit) {
+    if (E != plex->P->DuplexInit) {
       vrna_message_error("backtrack failed in second fold duplex");
     } else {
-      *dG         += P->DuplexInit;
-      *dGplex     += P->DuplexInit;
+      *dG         += plex->P->DuplexInit;
+      *dGplex     += plex->P->DuplexInit;
       *dGx        += 0; /* access_s1[1][idiff]; */
       *dGy        += 0; /* access_s2[1][jdiff]; */
       st1[i - 1]  = '(';
@@ -1867,7 +2132,7 @@ fbacktrack_XS(int       i,
   if (i > 11)
     i--;
 
-  if (j < n4 - 10)
+  if (j < plex->n4 - 10)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -1889,86 +2154,126 @@ fbacktrack_XS(int       i,
 }
 
 
-duplexT **
-Lduplexfold_XS(const char *s1,
-               const char *s2,
-               const int  **access_s1,
-               const int  **access_s2,
-               const int  threshold,
-               const int  alignment_length,
-               const int  delta,
-               const int  fast,
-               const int  il_a,
-               const int  il_b,
-               const int  b_a,
-               const int  b_b)
+PUBLIC void
+vrna_plex_scan_XS(vrna_plex_t *plex,
+                  const char  *s1,
+                  const char  *s2,
+                  const int   **access_s1,
+                  const int   **access_s2,
+                  const int   threshold,
+                  const int   alignment_length,
+                  const int   delta,
+                  const int   fast,
+                  const int   il_a,
+                  const int   il_b,
+                  const int   b_a,
+                  const int   b_b)
+{
+  scan_XS(plex,
+          NULL,
+          s1,
+          s2,
+          access_s1,
+          access_s2,
+          threshold,
+          alignment_length,
+          delta,
+          fast,
+          il_a,
+          il_b,
+          b_a,
+          b_b);
+}
+
+
+PRIVATE void
+scan_XS(vrna_plex_t               *plex,
+        const vrna_plex_target_t  *target,
+        const char                *s1,
+        const char                *s2,
+        const int                 **access_s1,
+        const int                 **access_s2,
+        const int                 threshold,
+        const int                 alignment_length,
+        const int                 delta,
+        const int                 fast,
+        const int                 il_a,
+        const int                 il_b,
+        const int                 b_a,
+        const int                 b_b)
 {
   /**
   *** See variable definition in fduplexfold_XS
   **/
-  int       i, j;
-  int       bopen       = b_b;
-  int       bext        = b_a;
-  int       iopen       = il_b;
-  int       iext_s      = 2 * il_a;
-  int       iext_ass    = 50 + il_a;
-  int       min_colonne = INF;
-  int       i_length;
-  int       max_pos;
-  int       max_pos_j;
-  int       min_j_colonne;
-  int       max = INF;
-  int       *position;
-  int       *position_j;
-  int       maxPenalty[4];
-  int       **DJ;
+  int i, j, r;
+  int bopen       = b_b;
+  int bext        = b_a;
+  int iopen       = il_b;
+  int iext_s      = 2 * il_a;
+  int iext_ass    = 50 + il_a;
+  int min_colonne = INF;
+  int i_length;
+  int max_pos;
+  int max_pos_j;
+  int min_j_colonne;
+  int max = INF;
+  int *position;
+  int *position_j;
+  int maxPenalty[4];
+  int **DJ;
   /**
   *** 1D array corresponding to the standard 2d recursion matrix
   *** Makes the computation 20% faster
   **/
-  int       *SA;
-  vrna_md_t md;
+  int *SA;
+  int *regions;
 
   /**
   *** variable initialization
   **/
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
+  plex->n1  = (int)strlen(s1);
+  plex->n2  = (int)strlen(s2);
   /**
   *** Sequence encoding
   **/
-
-  set_model_details(&md);
-
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_dfold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
+  if (target) {
+    plex->S1  = target->S1;
+    plex->SS1 = target->SS1;
+    plex->S2  = encode_seq(s2);
+    plex->SS2 = encode_alias(plex->alias, plex->S2);
+  } else {
+    encode_seqs(plex, s1, s2);
   }
 
-  encode_seqs(s1, s2);
   /**
   *** Position of the high score on the target and query sequence
   **/
-  position    = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
-  position_j  = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
+  position    = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
+  position_j  = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
+  /**
+  *** Restrict the scan to the target regions around seeds, if requested
+  **/
+  regions = NULL;
+  if ((target) && (target->seed_length > 0)) {
+    regions = seed_regions(plex, target, alignment_length);
+    for (i = 0; i < delta + plex->n1 + 3 + delta; i++)
+      position[i] = INF;
+  }
+
   /**
   *** extension penalty, computed only once, further reduce the computation time
   **/
-  maxPenalty[0] = (int)-1 * P->stack[2][2] / 2;
-  maxPenalty[1] = (int)-1 * P->stack[2][2];
-  maxPenalty[2] = (int)-3 * P->stack[2][2] / 2;
-  maxPenalty[3] = (int)-2 * P->stack[2][2];
+  maxPenalty[0] = (int)-1 * plex->P->stack[2][2] / 2;
+  maxPenalty[1] = (int)-1 * plex->P->stack[2][2];
+  maxPenalty[2] = (int)-3 * plex->P->stack[2][2] / 2;
+  maxPenalty[3] = (int)-2 * plex->P->stack[2][2];
 
   DJ    = (int **)vrna_alloc(4 * sizeof(int *));
-  DJ[0] = (int *)vrna_alloc(n2 * sizeof(int));
-  DJ[1] = (int *)vrna_alloc(n2 * sizeof(int));
-  DJ[2] = (int *)vrna_alloc(n2 * sizeof(int));
-  DJ[3] = (int *)vrna_alloc(n2 * sizeof(int));
-  j     = n2 - 9;
+  DJ[0] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  DJ[1] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  DJ[2] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  DJ[3] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  j     = plex->n2 - 9;
   while (--j > 10) {
     DJ[0][j] = 0.5 *
                (access_s2[5][j + 4] - access_s2[4][j + 4] + access_s2[5][j] - access_s2[4][j - 1]);
@@ -2009,8 +2314,8 @@ Lduplexfold_XS(const char *s1,
   ***                  * length of the sequence
   **/
 
-  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (n2 + 5));
-  for (j = n2 + 4; j >= 0; j--) {
+  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (plex->n2 + 5));
+  for (j = plex->n2 + 4; j >= 0; j--) {
     SA[(j *
         30)]            =
       SA[(j * 30) + 1]  = SA[(j * 30) + 2] = SA[(j * 30) + 3] = SA[(j * 30) + 4] = INF;
@@ -2041,25 +2346,42 @@ Lduplexfold_XS(const char *s1,
         SA[(j * 30) + 2 + 25] = SA[(j * 30) + 3 + 25] = SA[(j * 30) + 4 + 25] = INF;
   }
 
-  i         = 10;
-  i_length  = n1 - 9;
+  r         = 0;
+  i         = (regions) ? regions[0] : 10;
+  i_length  = plex->n1 - 9;
   while (i < i_length) {
     int di1, di2, di3, di4;
+    if ((regions) && (i > regions[2 * r + 1])) {
+      /* restart the recursions at the begin of the next region */
+      r++;
+      i = regions[2 * r];
+      reset_columns(SA, plex->n2);
+      continue;
+    }
+
     int idx   = i % 5;
     int idx_1 = (i - 1) % 5;
     int idx_2 = (i - 2) % 5;
     int idx_3 = (i - 3) % 5;
     int idx_4 = (i - 4) % 5;
-    di1 = 0.5 * (access_s1[5][i + 4] - access_s1[4][i + 4] + access_s1[5][i] - access_s1[4][i - 1]);
-    di2 = 0.5 *
-          (access_s1[5][i + 3] - access_s1[4][i + 3] + access_s1[5][i - 1] - access_s1[4][i - 2]) +
-          di1;
-    di3 = 0.5 *
-          (access_s1[5][i + 2] - access_s1[4][i + 2] + access_s1[5][i - 2] - access_s1[4][i - 3]) +
-          di2;
-    di4 = 0.5 *
-          (access_s1[5][i + 1] - access_s1[4][i + 1] + access_s1[5][i - 3] - access_s1[4][i - 4]) +
-          di3;
+    if (target) {
+      di1 = target->DI[0][i];
+      di2 = target->DI[1][i];
+      di3 = target->DI[2][i];
+      di4 = target->DI[3][i];
+    } else {
+      di1 = 0.5 * (access_s1[5][i + 4] - access_s1[4][i + 4] + access_s1[5][i] - access_s1[4][i - 1]);
+      di2 = 0.5 *
+            (access_s1[5][i + 3] - access_s1[4][i + 3] + access_s1[5][i - 1] - access_s1[4][i - 2]) +
+            di1;
+      di3 = 0.5 *
+            (access_s1[5][i + 2] - access_s1[4][i + 2] + access_s1[5][i - 2] - access_s1[4][i - 3]) +
+            di2;
+      di4 = 0.5 *
+            (access_s1[5][i + 1] - access_s1[4][i + 1] + access_s1[5][i - 3] - access_s1[4][i - 4]) +
+            di3;
+    }
+
     /*
      *  di1 = access_s1[5][i]   - access_s1[4][i-1];
      *  di2 = access_s1[5][i-1] - access_s1[4][i-2] + di1;
@@ -2070,7 +2392,7 @@ Lduplexfold_XS(const char *s1,
      *  di3=MIN2(di3,maxPenalty[2]);
      *  di4=MIN2(di4,maxPenalty[3]);
      */
-    j = n2 - 9;
+    j = plex->n2 - 9;
     while (--j > 9) {
       int dj1, dj2, dj3, dj4;
       dj1 = DJ[0][j];
@@ -2078,59 +2400,59 @@ Lduplexfold_XS(const char *s1,
       dj3 = DJ[2][j];
       dj4 = DJ[3][j];
       int type2, type, temp;
-      type = pair[S1[i]][S2[j]];
+      type = plex->pair[plex->S1[i]][plex->S2[j]];
       /**
       *** Start duplex
       **/
       /* SA[LCI(idx,j,n2)] = type ? P->DuplexInit + access_s1[1][i] + access_s2[1][j] : INF; */
-      SA[LCI(idx, j, n2)] = type ? P->DuplexInit : INF;
+      SA[LCI(idx, j, plex->n2)] = type ? plex->P->DuplexInit : INF;
       /**
       *** update lin bx by linx liny matrix
       **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
+      type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
       /**
       *** start/extend interior loop
       **/
-      SA[LINI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                         n2)] + P->mismatchI[type2][SS2[j]][SS1[i]] + di1 + dj1 + iopen + iext_s,
-                                  SA[LINI(idx_1, j, n2)] + iext_ass + di1);
+      SA[LINI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                               plex->n2)] + plex->P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + di1 + dj1 + iopen + iext_s,
+                                        SA[LINI(idx_1, j, plex->n2)] + iext_ass + di1);
 
       /**
       *** start/extend nx1 target
       *** use same type2 as for in
       **/
-      SA[LINIX(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + di1 + dj1 + iopen + iext_s,
-                                   SA[LINIX(idx_1, j, n2)] + iext_ass + di1);
+      SA[LINIX(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                                plex->n2)] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + di1 + dj1 + iopen + iext_s,
+                                         SA[LINIX(idx_1, j, plex->n2)] + iext_ass + di1);
       /**
       *** start/extend 1xn target
       *** use same type2 as for in
       **/
-      SA[LINIY(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + di1 + dj1 + iopen + iext_s,
-                                   SA[LINIY(idx, j + 1, n2)] + iext_ass + dj1);
+      SA[LINIY(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                                plex->n2)] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + di1 + dj1 + iopen + iext_s,
+                                         SA[LINIY(idx, j + 1, plex->n2)] + iext_ass + dj1);
       /**
       *** extend interior loop
       **/
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)], SA[LINI(idx, j + 1, n2)] + iext_ass + dj1);
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)],
-                                   SA[LINI(idx_1, j + 1, n2)] + iext_s + di1 + dj1);
+      SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)], SA[LINI(idx, j + 1, plex->n2)] + iext_ass + dj1);
+      SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)],
+                                         SA[LINI(idx_1, j + 1, plex->n2)] + iext_s + di1 + dj1);
       /**
       *** start/extend bulge target
       **/
-      type2                 = pair[S2[j]][S1[i - 1]];
-      SA[LBXI(idx, j, n2)]  = MIN2(SA[LBXI(idx_1, j, n2)] + bext + di1,
-                                   SA[LCI(idx_1, j,
-                                          n2)] + bopen + bext +
-                                   (type2 > 2 ? P->TerminalAU : 0) + di1);
+      type2                       = plex->pair[plex->S2[j]][plex->S1[i - 1]];
+      SA[LBXI(idx, j, plex->n2)]  = MIN2(SA[LBXI(idx_1, j, plex->n2)] + bext + di1,
+                                         SA[LCI(idx_1, j,
+                                                plex->n2)] + bopen + bext +
+                                         (type2 > 2 ? plex->P->TerminalAU : 0) + di1);
       /**
       *** start/extend bulge query
       **/
-      type2                 = pair[S2[j + 1]][S1[i]];
-      SA[LBYI(idx, j, n2)]  = MIN2(SA[LBYI(idx, j + 1, n2)] + bext + dj1,
-                                   SA[LCI(idx, j + 1,
-                                          n2)] + bopen + bext +
-                                   (type2 > 2 ? P->TerminalAU : 0) + dj1);
+      type2                       = plex->pair[plex->S2[j + 1]][plex->S1[i]];
+      SA[LBYI(idx, j, plex->n2)]  = MIN2(SA[LBYI(idx, j + 1, plex->n2)] + bext + dj1,
+                                         SA[LCI(idx, j + 1,
+                                                plex->n2)] + bopen + bext +
+                                         (type2 > 2 ? plex->P->TerminalAU : 0) + dj1);
       /**
        ***end update recursion
        **/
@@ -2139,49 +2461,49 @@ Lduplexfold_XS(const char *s1,
                   *** stack extension
                   **/
 
-      SA[LCI(idx, j, n2)] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
+      SA[LCI(idx, j, plex->n2)] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], plex->P);
       /**
       *** stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->stack[rtype[type]][type2] + di1 + dj1,
-                                   SA[LCI(idx, j, n2)]);
+      if ((type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+        SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                                plex->n2)] + plex->P->stack[plex->rtype[type]][type2] + di1 + dj1,
+                                         SA[LCI(idx, j, plex->n2)]);
 
       /**
       *** 1x0 / 0x1 stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 2]])) {
+      if ((type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 2]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_1, j + 2,
-                                  n2)] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_1, j + 2,
+                                        plex->n2)] + plex->P->bulge[1] + plex->P->stack[plex->rtype[type]][type2] + di1 + dj2,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 1]])) {
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 1]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 1,
-                                  n2)] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_2, j + 1,
+                                        plex->n2)] + plex->P->bulge[1] + plex->P->stack[type2][plex->rtype[type]] + di2 + dj1,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
       *** 1x1 / 2x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 2]][S2[j + 2]])) {
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 2]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 2,
-                                  n2)] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj2,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_2, j + 2,
+                                        plex->n2)] + plex->P->int11[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj2,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 3]])) {
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 3]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 3,
-                                  n2)] +
-                           P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j +
-                                                                                                2]] + di3 + dj3,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_3, j + 3,
+                                        plex->n2)] +
+                                 plex->P->int22[type2][plex->rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j +
+                                 2]] + di3 + dj3,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
@@ -2189,37 +2511,37 @@ Lduplexfold_XS(const char *s1,
       *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
       *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
       **/
-      if ((type2 = pair[S1[i - 3]][S2[j + 2]])) {
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 2]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 2,
-                                  n2)] +
-                           P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + di3 + dj2,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_3, j + 2,
+                                        plex->n2)] +
+                                 plex->P->int21[plex->rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + di3 + dj2,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 3]])) {
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 3]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 3,
-                                  n2)] +
-                           P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di2 + dj3,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_2, j + 3,
+                                        plex->n2)] +
+                                 plex->P->int21[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di2 + dj3,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
       *** 2x3 / 3x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_4, j + 3, n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di4 + dj3,
-                                   SA[LCI(idx, j, n2)]);
+      if ((type2 = plex->pair[plex->S1[i - 4]][plex->S2[j + 3]])) {
+        SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_4, j + 3, plex->n2)] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                         plex->P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                         plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di4 + dj3,
+                                         SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_3, j + 4, n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di3 + dj4,
-                                   SA[LCI(idx, j, n2)]);
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 4]])) {
+        SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_3, j + 4, plex->n2)] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                         plex->P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                         plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di3 + dj4,
+                                         SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
@@ -2229,49 +2551,49 @@ Lduplexfold_XS(const char *s1,
       *** 3x3 or more
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_3, j + 3,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + di3 + dj3,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINI(idx_3, j + 3,
+                                       plex->n2)] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + di3 + dj3,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** 2xn or more
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_4, j + 2,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINI(idx_4, j + 2,
+                                       plex->n2)] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** nx2 or more
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_2, j + 4,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINI(idx_2, j + 4,
+                                       plex->n2)] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** nx1 n>2
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIX(idx_3, j + 1,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINIX(idx_3, j + 1,
+                                        plex->n2)] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** 1xn n>2
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIY(idx_1, j + 3,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINIY(idx_1, j + 3,
+                                        plex->n2)] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** nx0 n>1
       **/
       int bAU;
-      bAU = (type > 2 ? P->TerminalAU : 0);
+      bAU = (type > 2 ? plex->P->TerminalAU : 0);
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LBXI(idx_2, j + 1, n2)] + di2 + dj1 + bext + bAU, SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LBXI(idx_2, j + 1, plex->n2)] + di2 + dj1 + bext + bAU, SA[LCI(idx, j, plex->n2)]);
       /**
       *** 0xn n>1
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LBYI(idx_1, j + 2, n2)] + di1 + dj2 + bext + bAU, SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LBYI(idx_1, j + 2, plex->n2)] + di1 + dj2 + bext + bAU, SA[LCI(idx, j, plex->n2)]);
       temp        = min_colonne;
       /**
       *** (type>2?P->TerminalAU:0)+
@@ -2280,7 +2602,7 @@ Lduplexfold_XS(const char *s1,
       **/
       /* remove this line printf("LCI %d:%d %d\t",i,j,SA[LCI(idx,j,n2)]); */
       /* remove this line printf("LI %d:%d %d\t",i,j, SA[LINI(idx,j,n2)]); */
-      min_colonne = MIN2(SA[LCI(idx, j, n2)] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P),
+      min_colonne = MIN2(SA[LCI(idx, j, plex->n2)] + vrna_E_ext_stem(plex->rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], plex->P),
                          min_colonne);
 
       if (temp > min_colonne)
@@ -2301,13 +2623,17 @@ Lduplexfold_XS(const char *s1,
     i++;
   }
   /* printf("MAX: %d",max); */
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  if (!target) {
+    free(plex->S1);
+    free(plex->SS1);
+  }
+
+  free(plex->S2);
+  free(plex->SS2);
   free(SA);
   if (max < threshold) {
-    find_max_XS(position,
+    find_max_XS(plex,
+                position,
                 position_j,
                 delta,
                 threshold,
@@ -2324,7 +2650,8 @@ Lduplexfold_XS(const char *s1,
   }
 
   if (max < INF) {
-    plot_max_XS(max,
+    plot_max_XS(plex,
+                max,
                 max_pos,
                 max_pos_j,
                 alignment_length,
@@ -2344,12 +2671,13 @@ Lduplexfold_XS(const char *s1,
   free(DJ);
   free(position);
   free(position_j);
-  return NULL;
+  free(regions);
 }
 
 
 PRIVATE void
-find_max_XS(const int   *position,
+find_max_XS(vrna_plex_t *plex,
+            const int   *position,
             const int   *position_j,
             const int   delta,
             const int   threshold,
@@ -2364,7 +2692,7 @@ find_max_XS(const int   *position,
             const int   b_a,
             const int   b_b)
 {
-  int pos = n1 - 9;
+  int pos = plex->n1 - 9;
 
   if (fast == 1) {
     while (10 < pos--) {
@@ -2381,15 +2709,15 @@ find_max_XS(const int   *position,
         max_pos_j = position_j[pos + delta];
         int max;
         max = position[pos + delta];
-        printf("target upper bound %d: query lower bound %d  (%5.2f) \n",
-               pos - 10,
-               max_pos_j - 10,
-               ((double)max) / 100);
+        plex_printf(plex, "target upper bound %d: query lower bound %d  (%5.2f) \n",
+                    pos - 10,
+                    max_pos_j - 10,
+                    ((double)max) / 100);
         pos = MAX2(10, pos + temp_min - delta);
       }
     }
   } else if (fast == 2) {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -2408,11 +2736,11 @@ find_max_XS(const int   *position,
          * max_pos_j -> position 1 in the sequence ( not 0 like in C)
          */
         int   alignment_length2;
-        alignment_length2 = MIN2(n1, n2);
+        alignment_length2 = MIN2(plex->n1, plex->n2);
         int   begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int   end_t   = MIN2(n1 - 10, pos + 1);
+        int   end_t   = MIN2(plex->n1 - 10, pos + 1);
         int   begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
         char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
         strcpy(s3, "NNNNNNNNNN");
@@ -2424,7 +2752,8 @@ find_max_XS(const int   *position,
         s3[end_t - begin_t + 1 + 20]  = '\0';
         s4[end_q - begin_q + 1 + 20]  = '\0';
         duplexT test;
-        test = fduplexfold_XS(s3,
+        test = fduplexfold_XS(plex,
+                              s3,
                               s4,
                               access_s1,
                               access_s2,
@@ -2437,21 +2766,21 @@ find_max_XS(const int   *position,
                               b_b);
         if (test.energy * 100 < threshold) {
           int l1 = strchr(test.structure, '&') - test.structure;
-          printf(
+          plex_printf(plex,
             " %s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
-            test.structure,
-            begin_t - 10 + test.i - l1 - 10,
-            begin_t - 10 + test.i - 1 - 10,
-            begin_q - 10 + test.j - 1 - 10,
-            (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-            test.ddG,
-            test.energy,
-            test.opening_backtrack_x,
-            test.opening_backtrack_y,
-            test.energy_backtrack,
-            pos - 10,
-            max_pos_j - 10,
-            ((double)position[pos + delta]) / 100);
+                      test.structure,
+                      begin_t - 10 + test.i - l1 - 10,
+                      begin_t - 10 + test.i - 1 - 10,
+                      begin_q - 10 + test.j - 1 - 10,
+                      (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                      test.ddG,
+                      test.energy,
+                      test.opening_backtrack_x,
+                      test.opening_backtrack_y,
+                      test.energy_backtrack,
+                      pos - 10,
+                      max_pos_j - 10,
+                      ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
           free(test.structure);
         }
@@ -2461,7 +2790,7 @@ find_max_XS(const int   *position,
       }
     }
   } else {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (pos-- > 10) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -2475,9 +2804,9 @@ find_max_XS(const int   *position,
         int     max_pos_j;
         max_pos_j = position_j[pos + delta];  /* position on j */
         int     begin_t = MAX2(11, pos - alignment_length);
-        int     end_t   = MIN2(n1 - 10, pos + 1);
+        int     end_t   = MIN2(plex->n1 - 10, pos + 1);
         int     begin_q = MAX2(11, max_pos_j - 1);
-        int     end_q   = MIN2(n2 - 10, max_pos_j + alignment_length - 1);
+        int     end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length - 1);
         int     i_flag;
         int     j_flag;
         i_flag  = (end_t == pos + 1 ? 1 : 0);
@@ -2490,21 +2819,21 @@ find_max_XS(const int   *position,
         s4[end_q - begin_q + 1] = '\0';
         duplexT test;
         test =
-          duplexfold_XS(s3, s4, access_s1, access_s2, pos, max_pos_j, threshold, i_flag, j_flag);
+          duplexfold_XS(plex, s3, s4, access_s1, access_s2, pos, max_pos_j, threshold, i_flag, j_flag);
         if (test.energy * 100 < threshold) {
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
-                 test.structure,
-                 test.tb,
-                 test.te,
-                 test.qb,
-                 test.qe,
-                 test.ddG,
-                 test.energy,
-                 test.dG1,
-                 test.dG2,
-                 pos - 10,
-                 max_pos_j - 10,
-                 ((double)position[pos + delta]) / 100);
+          plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
+                      test.structure,
+                      test.tb,
+                      test.te,
+                      test.qb,
+                      test.qe,
+                      test.ddG,
+                      test.energy,
+                      test.dG1,
+                      test.dG2,
+                      pos - 10,
+                      max_pos_j - 10,
+                      ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -2541,7 +2870,8 @@ compare(const void  *sub1,
 #endif
 
 PRIVATE void
-plot_max_XS(const int   max,
+plot_max_XS(vrna_plex_t *plex,
+            const int   max,
             const int   max_pos,
             const int   max_pos_j,
             const int   alignment_length,
@@ -2556,15 +2886,15 @@ plot_max_XS(const int   max,
             const int   b_b)
 {
   if (fast == 1) {
-    printf("target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 3, max_pos_j,
-           ((double)max) / 100);
+    plex_printf(plex, "target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 3, max_pos_j,
+                ((double)max) / 100);
   } else if (fast == 2) {
     int   alignment_length2;
-    alignment_length2 = MIN2(n1, n2);
+    alignment_length2 = MIN2(plex->n1, plex->n2);
     int   begin_t = MAX2(11, max_pos - alignment_length2 + 1);  /* 10 */
-    int   end_t   = MIN2(n1 - 10, max_pos + 1);
+    int   end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int   begin_q = MAX2(11, max_pos_j - 1);                    /* 10 */
-    int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+    int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
     char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
     char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
     strcpy(s3, "NNNNNNNNNN");
@@ -2576,31 +2906,31 @@ plot_max_XS(const int   max,
     s3[end_t - begin_t + 1 + 20]  = '\0';
     s4[end_q - begin_q + 1 + 20]  = '\0';
     duplexT test;
-    test = fduplexfold_XS(s3, s4, access_s1, access_s2, end_t, begin_q, INF, il_a, il_b, b_a, b_b);
+    test = fduplexfold_XS(plex, s3, s4, access_s1, access_s2, end_t, begin_q, INF, il_a, il_b, b_a, b_b);
     int     l1 = strchr(test.structure, '&') - test.structure;
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
-           test.structure,
-           begin_t - 10 + test.i - l1 - 10,
-           begin_t - 10 + test.i - 1 - 10,
-           begin_q - 10 + test.j - 1 - 10,
-           (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-           test.ddG,
-           test.energy,
-           test.opening_backtrack_x,
-           test.opening_backtrack_y,
-           test.energy_backtrack,
-           max_pos - 10,
-           max_pos_j - 10,
-           (double)max / 100);
+    plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
+                test.structure,
+                begin_t - 10 + test.i - l1 - 10,
+                begin_t - 10 + test.i - 1 - 10,
+                begin_q - 10 + test.j - 1 - 10,
+                (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                test.ddG,
+                test.energy,
+                test.opening_backtrack_x,
+                test.opening_backtrack_y,
+                test.energy_backtrack,
+                max_pos - 10,
+                max_pos_j - 10,
+                (double)max / 100);
 
     free(s3);
     free(s4);
     free(test.structure);
   } else {
     int   begin_t = MAX2(11, max_pos - alignment_length);
-    int   end_t   = MIN2(n1 - 10, max_pos + 1);
+    int   end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int   begin_q = MAX2(11, max_pos_j - 1);
-    int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length - 1);
+    int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length - 1);
     int   i_flag;
     int   j_flag;
     i_flag  = (end_t == max_pos + 1 ? 1 : 0);
@@ -2613,20 +2943,20 @@ plot_max_XS(const int   max,
     s3[end_t - begin_t + 1] = '\0';                       /*  */
     s4[end_q - begin_q + 1] = '\0';
     duplexT test;
-    test = duplexfold_XS(s3, s4, access_s1, access_s2, max_pos, max_pos_j, INF, i_flag, j_flag);
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
-           test.structure,
-           test.tb,
-           test.te,
-           test.qb,
-           test.qe,
-           test.ddG,
-           test.energy,
-           test.dG1,
-           test.dG2,
-           max_pos - 10,
-           max_pos_j - 10,
-           (double)max / 100);
+    test = duplexfold_XS(plex, s3, s4, access_s1, access_s2, max_pos, max_pos_j, INF, i_flag, j_flag);
+    plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
+                test.structure,
+                test.tb,
+                test.te,
+                test.qb,
+                test.qe,
+                test.ddG,
+                test.energy,
+                test.dG1,
+                test.dG2,
+                max_pos - 10,
+                max_pos_j - 10,
+                (double)max / 100);
     free(s3);
     free(s4);
     free(test.structure);
@@ -2638,37 +2968,27 @@ plot_max_XS(const int   max,
 
 
 PRIVATE duplexT
-duplexfold(const char *s1,
-           const char *s2,
-           const int  extension_cost)
+duplexfold(vrna_plex_t  *plex,
+           const char   *s1,
+           const char   *s2,
+           const int    extension_cost)
 {
-  int       i, j, l1, Emin = INF, i_min = 0, j_min = 0;
-  char      *struc;
-  duplexT   mfe;
-  vrna_md_t md;
-
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
-
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
+  int     i, j, l1, Emin = INF, i_min = 0, j_min = 0;
+  char    *struc;
+  duplexT mfe;
+
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
 
-  c = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  for (i = 0; i <= n3; i++)
-    c[i] = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-  encode_seqs(s1, s2);
-  for (i = 1; i <= n3; i++) {
-    for (j = n4; j > 0; j--) {
+  plex->c = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  for (i = 0; i <= plex->n3; i++)
+    plex->c[i] = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+  encode_seqs(plex, s1, s2);
+  for (i = 1; i <= plex->n3; i++) {
+    for (j = plex->n4; j > 0; j--) {
       int type, type2, E, k, l;
-      type    = pair[S1[i]][S2[j]];
-      c[i][j] = type ? P->DuplexInit + 2 * extension_cost : INF;
+      type          = plex->pair[plex->S1[i]][plex->S2[j]];
+      plex->c[i][j] = type ? plex->P->DuplexInit + 2 * extension_cost : INF;
       if (!type)
         continue;
 
@@ -2677,30 +2997,30 @@ duplexfold(const char *s1,
       ***       if (j<n4) c[i][j] += P->dangle3[type][SS2[j+1]]+ extension_cost;
       ***       if (type>2) c[i][j] += P->TerminalAU;
       **/
-      c[i][j] += vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+      plex->c[i][j] += vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, plex->P);
       for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-        for (l = j + 1; l <= n4; l++) {
+        for (l = j + 1; l <= plex->n4; l++) {
           if (i - k + l - j - 2 > MAXLOOP)
             break;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = plex->pair[plex->S1[k]][plex->S2[l]];
           if (!type2)
             continue;
 
-          E = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                        SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1],
-                        P) + (i - k + l - j) * extension_cost;
-          c[i][j] = MIN2(c[i][j], c[k][l] + E);
+          E = E_IntLoop(i - k - 1, l - j - 1, type2, plex->rtype[type],
+                        plex->SS1[k + 1], plex->SS2[l - 1], plex->SS1[i - 1], plex->SS2[j + 1],
+                        plex->P) + (i - k + l - j) * extension_cost;
+          plex->c[i][j] = MIN2(plex->c[i][j], plex->c[k][l] + E);
         }
       }
-      E = c[i][j];
+      E = plex->c[i][j];
       /**
       ***      if (i<n3) E += P->dangle3[rtype[type]][SS1[i+1]]+extension_cost;
       ***      if (j>1)  E += P->dangle5[rtype[type]][SS2[j-1]]+extension_cost;
       ***      if (type>2) E += P->TerminalAU;
       ***
       **/
-      E += vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n3) ? SS1[i + 1] : -1, P);
+      E += vrna_E_ext_stem(plex->rtype[type], (j > 1) ? plex->SS2[j - 1] : -1, (i < plex->n3) ? plex->SS1[i + 1] : -1, plex->P);
       if (E < Emin) {
         Emin  = E;
         i_min = i;
@@ -2708,8 +3028,8 @@ duplexfold(const char *s1,
       }
     }
   }
-  struc = backtrack(i_min, j_min, extension_cost);
-  if (i_min < n3)
+  struc = backtrack(plex, i_min, j_min, extension_cost);
+  if (i_min < plex->n3)
     i_min++;
 
   if (j_min > 1)
@@ -2723,56 +3043,57 @@ duplexfold(const char *s1,
   mfe.j         = j_min;
   mfe.energy    = (double)Emin / 100.;
   mfe.structure = struc;
-  for (i = 0; i <= n3; i++)
-    free(c[i]);
-  free(c);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  for (i = 0; i <= plex->n3; i++)
+    free(plex->c[i]);
+  free(plex->c);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
   return mfe;
 }
 
 
 PRIVATE char *
-backtrack(int       i,
-          int       j,
-          const int extension_cost)
+backtrack(vrna_plex_t *plex,
+          int         i,
+          int         j,
+          const int   extension_cost)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, type, type2, E, traced, i0, j0;
   char  *st1, *st2, *struc;
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
 
-  i0  = MIN2(i + 1, n3);
+  i0  = MIN2(i + 1, plex->n3);
   j0  = MAX2(j - 1, 1);
 
-  while (i > 0 && j <= n4) {
-    E           = c[i][j];
+  while (i > 0 && j <= plex->n4) {
+    E           = plex->c[i][j];
     traced      = 0;
     st1[i - 1]  = '(';
     st2[j - 1]  = ')';
-    type        = pair[S1[i]][S2[j]];
+    type        = plex->pair[plex->S1[i]][plex->S2[j]];
     if (!type)
       vrna_message_error("backtrack failed in fold duplex");
 
     for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-      for (l = j + 1; l <= n4; l++) {
+      for (l = j + 1; l <= plex->n4; l++) {
         int LE;
         if (i - k + l - j - 2 > MAXLOOP)
           break;
 
-        type2 = pair[S1[k]][S2[l]];
+        type2 = plex->pair[plex->S1[k]][plex->S2[l]];
         if (!type2)
           continue;
 
-        LE = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                       SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1],
-                       P) + (i - k + l - j) * extension_cost;
-        if (E == c[k][l] + LE) {
+        LE = E_IntLoop(i - k - 1, l - j - 1, type2, plex->rtype[type],
+                       plex->SS1[k + 1], plex->SS2[l - 1], plex->SS1[i - 1], plex->SS2[j + 1],
+                       plex->P) + (i - k + l - j) * extension_cost;
+        if (E == plex->c[k][l] + LE) {
           traced  = 1;
           i       = k;
           j       = l;
@@ -2783,13 +3104,13 @@ backtrack(int       i,
         break;
     }
     if (!traced) {
-      E -= vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+      E -= vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, plex->P);
       /**
       ***      if (i>1) E -= P->dangle5[type][SS1[i-1]]+extension_cost;
       ***      if (j<n4) E -= P->dangle3[type][SS2[j+1]]+extension_cost;
       ***      if (type>2) E -= P->TerminalAU;
       **/
-      if (E != P->DuplexInit + 2 * extension_cost)
+      if (E != plex->P->DuplexInit + 2 * extension_cost)
         vrna_message_error("backtrack failed in fold duplex");
       else
         break;
@@ -2798,7 +3119,7 @@ backtrack(int       i,
   if (i > 1)
     i--;
 
-  if (j < n4)
+  if (j < plex->n4)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -2821,7 +3142,8 @@ backtrack(int       i,
 
 
 PRIVATE duplexT
-fduplexfold(const char  *s1,
+fduplexfold(vrna_plex_t *plex,
+            const char  *s1,
             const char  *s2,
             const int   extension_cost,
             const int   il_a,
@@ -2829,71 +3151,61 @@ fduplexfold(const char  *s1,
             const int   b_a,
             const int   b_b)
 {
-  int       i, j, Emin, i_min, j_min, l1;
-  duplexT   mfe;
-  char      *struc;
-  int       bopen       = b_b;
-  int       bext        = b_a + extension_cost;
-  int       iopen       = il_b;
-  int       iext_s      = 2 * (il_a + extension_cost);  /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
-  int       iext_ass    = 50 + il_a + extension_cost;   /* iext_ass assymetric extension of interior loop, either on i or on j side. */
-  int       min_colonne = INF;                          /* enthaelt das maximum einer kolonne */
-  int       i_length;
-  int       max_pos;                                    /* get position of the best hit */
-  int       max_pos_j;
-  int       temp = INF;
-  int       min_j_colonne;
-  int       max = INF;
-  vrna_md_t md;
+  int     i, j, Emin, i_min, j_min, l1;
+  duplexT mfe;
+  char    *struc;
+  int     bopen       = b_b;
+  int     bext        = b_a + extension_cost;
+  int     iopen       = il_b;
+  int     iext_s      = 2 * (il_a + extension_cost);  /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
+  int     iext_ass    = 50 + il_a + extension_cost;   /* iext_ass assymetric extension of interior loop, either on i or on j side. */
+  int     min_colonne = INF;                          /* enthaelt das maximum einer kolonne */
+  int     i_length;
+  int     max_pos;                                    /* get position of the best hit */
+  int     max_pos_j;
+  int     temp = INF;
+  int     min_j_colonne;
+  int     max = INF;
 
   /* FOLLOWING NEXT 4 LINE DEFINES AN ARRAY CONTAINING POSITION OF THE SUBOPT IN S1 */
 
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
   /* delta_check is the minimal distance allowed for two hits to be accepted */
   /* if both hits are closer, reject the smaller ( in term of position)  hits  */
   /* i want to implement a function that, given a position in a long sequence and a small sequence, */
   /* duplexfold them at this position and report the result at the command line */
   /* for this i first need to rewrite backtrack in order to remove the printf functio */
   /* END OF DEFINITION FOR NEEDED SUBOPT DATA  */
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
 
   /*local c array initialization---------------------------------------------*/
-  c   = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  in  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  bx  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  by  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  inx = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  iny = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  for (i = 0; i <= n3; i++) {
-    c[i]    = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    in[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    bx[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    by[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    inx[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    iny[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
+  plex->c   = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->in  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->bx  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->by  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->inx = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->iny = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  for (i = 0; i <= plex->n3; i++) {
+    plex->c[i]    = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->in[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->bx[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->by[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->inx[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->iny[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
   }
   /*-------------------------------------------------------------------------*/
   /*end of array initialisation----------------------------------*/
   /*maybe int *** would be better*/
-  encode_seqs(s1, s2);
+  encode_seqs(plex, s1, s2);
   /* ------------------------------------------matrix initialisierung */
-  for (i = 0; i < n3; i++) {
-    for (j = 0; j < n4; j++) {
-      in[i][j]  = INF;  /* no in before  1 */
-      c[i][j]   = INF;  /* no bulge and no in before n2 */
-      bx[i][j]  = INF;  /* no bulge before 1 */
-      by[i][j]  = INF;
-      inx[i][j] = INF;  /* no bulge before 1 */
-      iny[i][j] = INF;
+  for (i = 0; i < plex->n3; i++) {
+    for (j = 0; j < plex->n4; j++) {
+      plex->in[i][j]  = INF;  /* no in before  1 */
+      plex->c[i][j]   = INF;  /* no bulge and no in before n2 */
+      plex->bx[i][j]  = INF;  /* no bulge before 1 */
+      plex->by[i][j]  = INF;
+      plex->inx[i][j] = INF;  /* no bulge before 1 */
+      plex->iny[i][j] = INF;
     }
   }
 
@@ -2902,56 +3214,56 @@ fduplexfold(const char  *s1,
 
   /* -------------------------------------------------------------matrix initialisierung */
   i         = 11;
-  i_length  = n3 - 9;
+  i_length  = plex->n3 - 9;
   while (i < i_length) {
-    j           = n4 - 9;
+    j           = plex->n4 - 9;
     min_colonne = INF;
     while (10 < --j) {
       int type, type2;
-      type = pair[S1[i]][S2[j]];
+      type = plex->pair[plex->S1[i]][plex->S2[j]];
       /**
       *** Start duplex
       **/
-      c[i][j] = type ? P->DuplexInit + 2 * extension_cost : INF;
+      plex->c[i][j] = type ? plex->P->DuplexInit + 2 * extension_cost : INF;
       /**
       *** update lin bx by linx liny matrix
       **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
+      type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
       /**
       *** start/extend interior loop
       **/
-      in[i][j] =
-        MIN2(c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-             in[i - 1][j] + iext_ass);
+      plex->in[i][j] =
+        MIN2(plex->c[i - 1][j + 1] + plex->P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+             plex->in[i - 1][j] + iext_ass);
       /**
       *** start/extend nx1 target
       *** use same type2 as for in
       **/
-      inx[i][j] = MIN2(c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                       inx[i - 1][j] + iext_ass);
+      plex->inx[i][j] = MIN2(plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                             plex->inx[i - 1][j] + iext_ass);
       /**
       *** start/extend 1xn target
       *** use same type2 as for in
       **/
-      iny[i][j] = MIN2(c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                       iny[i][j + 1] + iext_ass);
+      plex->iny[i][j] = MIN2(plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                             plex->iny[i][j + 1] + iext_ass);
       /**
       *** extend interior loop
       **/
-      in[i][j]  = MIN2(in[i][j], in[i][j + 1] + iext_ass);
-      in[i][j]  = MIN2(in[i][j], in[i - 1][j + 1] + iext_s);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i][j + 1] + iext_ass);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i - 1][j + 1] + iext_s);
       /**
       *** start/extend bulge target
       **/
-      type2     = pair[S2[j]][S1[i - 1]];
-      bx[i][j]  =
-        MIN2(bx[i - 1][j] + bext, c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+      type2     = plex->pair[plex->S2[j]][plex->S1[i - 1]];
+      plex->bx[i][j]  =
+        MIN2(plex->bx[i - 1][j] + bext, plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0));
       /**
       *** start/extend bulge query
       **/
-      type2     = pair[S2[j + 1]][S1[i]];
-      by[i][j]  =
-        MIN2(by[i][j + 1] + bext, c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+      type2     = plex->pair[plex->S2[j + 1]][plex->S1[i]];
+      plex->by[i][j]  =
+        MIN2(plex->by[i][j + 1] + bext, plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0));
       /**
        ***end update recursion
        ***######################## Start stack extension##############################
@@ -2959,68 +3271,68 @@ fduplexfold(const char  *s1,
       if (!type)
         continue;
 
-      c[i][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P) + 2 * extension_cost;
+      plex->c[i][j] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], plex->P) + 2 * extension_cost;
       /**
       *** stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        c[i][j] =
-          MIN2(c[i - 1][j + 1] + P->stack[rtype[type]][type2] + 2 * extension_cost, c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+        plex->c[i][j] =
+          MIN2(plex->c[i - 1][j + 1] + plex->P->stack[plex->rtype[type]][type2] + 2 * extension_cost, plex->c[i][j]);
 
       /**
       *** 1x0 / 0x1 stack extension
       **/
-      type2   = pair[S1[i - 1]][S2[j + 2]];
-      c[i][j] = MIN2(
-        c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost,
-        c[i][j]);
-      type2   = pair[S1[i - 2]][S2[j + 1]];
-      c[i][j] = MIN2(
-        c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost,
-        c[i][j]);
+      type2         = plex->pair[plex->S1[i - 1]][plex->S2[j + 2]];
+      plex->c[i][j] = MIN2(
+        plex->c[i - 1][j + 2] + plex->P->bulge[1] + plex->P->stack[plex->rtype[type]][type2] + 3 * extension_cost,
+        plex->c[i][j]);
+      type2         = plex->pair[plex->S1[i - 2]][plex->S2[j + 1]];
+      plex->c[i][j] = MIN2(
+        plex->c[i - 2][j + 1] + plex->P->bulge[1] + plex->P->stack[type2][plex->rtype[type]] + 3 * extension_cost,
+        plex->c[i][j]);
       /**
       *** 1x1 / 2x2 stack extension
       **/
-      type2   = pair[S1[i - 2]][S2[j + 2]];
-      c[i][j] = MIN2(
-        c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + 4 * extension_cost,
-        c[i][j]);
-      type2   = pair[S1[i - 3]][S2[j + 3]];
-      c[i][j] =
-        MIN2(c[i - 3][j + 3] +
-             P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 6 * extension_cost,
-             c[i][j]);
+      type2         = plex->pair[plex->S1[i - 2]][plex->S2[j + 2]];
+      plex->c[i][j] = MIN2(
+        plex->c[i - 2][j + 2] + plex->P->int11[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 4 * extension_cost,
+        plex->c[i][j]);
+      type2   = plex->pair[plex->S1[i - 3]][plex->S2[j + 3]];
+      plex->c[i][j] =
+        MIN2(plex->c[i - 3][j + 3] +
+             plex->P->int22[type2][plex->rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 6 * extension_cost,
+             plex->c[i][j]);
       /**
       *** 1x2 / 2x1 stack extension
       *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
       *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
       **/
-      type2   = pair[S1[i - 3]][S2[j + 2]];
-      c[i][j] =
+      type2   = plex->pair[plex->S1[i - 3]][plex->S2[j + 2]];
+      plex->c[i][j] =
         MIN2(
-          c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + 5 * extension_cost,
-          c[i][j]);
-      type2   = pair[S1[i - 2]][S2[j + 3]];
-      c[i][j] =
+          plex->c[i - 3][j + 2] + plex->P->int21[plex->rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + 5 * extension_cost,
+          plex->c[i][j]);
+      type2   = plex->pair[plex->S1[i - 2]][plex->S2[j + 3]];
+      plex->c[i][j] =
         MIN2(
-          c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 5 * extension_cost,
-          c[i][j]);
+          plex->c[i - 2][j + 3] + plex->P->int21[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 5 * extension_cost,
+          plex->c[i][j]);
 
       /**
       *** 2x3 / 3x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]])) {
-        c[i][j] = MIN2(c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                       c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 4]][plex->S2[j + 3]])) {
+        plex->c[i][j] = MIN2(plex->c[i - 4][j + 3] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                             plex->P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                             plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                             plex->c[i][j]);
       }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]])) {
-        c[i][j] = MIN2(c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                       c[i][j]);
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 4]])) {
+        plex->c[i][j] = MIN2(plex->c[i - 3][j + 4] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                             plex->P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                             plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                             plex->c[i][j]);
       }
 
       /**
@@ -3029,47 +3341,47 @@ fduplexfold(const char  *s1,
       /**
       *** 3x3 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 3][j + 3] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** 2xn or more
       **/
-      c[i][j] = MIN2(
-        in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 4][j + 2] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** nx2 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 2][j + 4] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** nx1 n>2
       **/
-      c[i][j] = MIN2(
-        inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->inx[i - 3][j + 1] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** 1xn n>2
       **/
-      c[i][j] = MIN2(
-        iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->iny[i - 1][j + 3] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** nx0 n>1
       **/
       int bAU;
-      bAU     = (type > 2 ? P->TerminalAU : 0);
-      c[i][j] = MIN2(bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU, c[i][j]);
+      bAU           = (type > 2 ? plex->P->TerminalAU : 0);
+      plex->c[i][j] = MIN2(plex->bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU, plex->c[i][j]);
       /**
       *** 0xn n>1
       **/
-      c[i][j]     = MIN2(by[i - 1][j + 2] + 2 * extension_cost + bext + bAU, c[i][j]);
-      temp        = min_colonne;
-      min_colonne = MIN2(c[i][j] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1],
-                                             P) + 2 * extension_cost,
-                         min_colonne);
+      plex->c[i][j] = MIN2(plex->by[i - 1][j + 2] + 2 * extension_cost + bext + bAU, plex->c[i][j]);
+      temp          = min_colonne;
+      min_colonne   = MIN2(plex->c[i][j] + vrna_E_ext_stem(plex->rtype[type], plex->SS2[j - 1], plex->SS1[i + 1],
+                                                           plex->P) + 2 * extension_cost,
+                           min_colonne);
       if (temp > min_colonne)
         min_j_colonne = j;
 
@@ -3088,8 +3400,8 @@ fduplexfold(const char  *s1,
   j_min = max_pos_j;
   int dGe;
   dGe   = 0;
-  struc = fbacktrack(i_min, j_min, extension_cost, il_a, il_b, b_a, b_b, &dGe);
-  if (i_min < n3 - 10)
+  struc = fbacktrack(plex, i_min, j_min, extension_cost, il_a, il_b, b_a, b_b, &dGe);
+  if (i_min < plex->n3 - 10)
     i_min++;
 
   if (j_min > 11)
@@ -3104,37 +3416,38 @@ fduplexfold(const char  *s1,
   mfe.energy            = (double)Emin / 100.;
   mfe.energy_backtrack  = (double)dGe / 100.;
   mfe.structure         = struc;
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
-  for (i = 0; i <= n3; i++) {
-    free(c[i]);
-    free(in[i]);
-    free(bx[i]);
-    free(by[i]);
-    free(inx[i]);
-    free(iny[i]);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
+  for (i = 0; i <= plex->n3; i++) {
+    free(plex->c[i]);
+    free(plex->in[i]);
+    free(plex->bx[i]);
+    free(plex->by[i]);
+    free(plex->inx[i]);
+    free(plex->iny[i]);
   }
-  free(c);
-  free(in);
-  free(bx);
-  free(by);
-  free(inx);
-  free(iny);
+  free(plex->c);
+  free(plex->in);
+  free(plex->bx);
+  free(plex->by);
+  free(plex->inx);
+  free(plex->iny);
   return mfe;
 }
 
 
 PRIVATE char *
-fbacktrack(int        i,
-           int        j,
-           const int  extension_cost,
-           const int  il_a,
-           const int  il_b,
-           const int  b_a,
-           const int  b_b,
-           int        *dG)
+fbacktrack(vrna_plex_t  *plex,
+           int          i,
+           int          j,
+           const int    extension_cost,
+           const int    il_a,
+           const int    il_b,
+           const int    b_a,
+           const int    b_b,
+           int          *dG)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
@@ -3146,9 +3459,9 @@ fbacktrack(int        i,
   int   iext_s    = 2 * (il_a + extension_cost);  /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
   int   iext_ass  = 50 + il_a + extension_cost;   /* iext_ass assymetric extension of interior loop, either on i or on j side. */
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
-  i0  = MIN2(i + 1, n3 - 10);
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
+  i0  = MIN2(i + 1, plex->n3 - 10);
   j0  = MAX2(j - 1, 11);
   int state;
   state = 1; /* we start backtracking from a a pair , i.e. c-matrix */
@@ -3160,33 +3473,33 @@ fbacktrack(int        i,
   traced  = 1;
   k       = i;
   l       = j;
-  type    = pair[S1[i]][S2[j]];
-  *dG     += vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P);
+  type    = plex->pair[plex->S1[i]][plex->S2[j]];
+  *dG     += vrna_E_ext_stem(plex->rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], plex->P);
   /*     (type>2?P->TerminalAU:0)+P->dangle3[rtype[type]][SS1[i+1]]+P->dangle5[rtype[type]][SS2[j-1]]; */
-  while (i > 10 && j <= n4 - 9 && traced) {
+  while (i > 10 && j <= plex->n4 - 9 && traced) {
     traced = 0;
     switch (state) {
       case 1:
-        type = pair[S1[i]][S2[j]];
+        type = plex->pair[plex->S1[i]][plex->S2[j]];
         int bAU;
-        bAU = (type > 2 ? P->TerminalAU : 0);
+        bAU = (type > 2 ? plex->P->TerminalAU : 0);
         if (!type)
           vrna_message_error("backtrack failed in fold duplex");
 
-        type2 = pair[S1[i - 1]][S2[j + 1]];
+        type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 1]];
         if (type2 &&
-            c[i][j] == (c[i - 1][j + 1] + P->stack[rtype[type]][type2] + 2 * extension_cost)) {
+            plex->c[i][j] == (plex->c[i - 1][j + 1] + plex->P->stack[plex->rtype[type]][type2] + 2 * extension_cost)) {
           k     = i - 1;
           l     = j + 1;
           (*dG) += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3196,21 +3509,21 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 1]][S2[j + 2]];
+        type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost)) {
+            plex->c[i][j] ==
+            (plex->c[i - 1][j + 2] + plex->P->bulge[1] + plex->P->stack[plex->rtype[type]][type2] + 3 * extension_cost)) {
           k   = i - 1;
           l   = j + 2;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3220,21 +3533,21 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 1]];
+        type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 1]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost)) {
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 1] + plex->P->bulge[1] + plex->P->stack[type2][plex->rtype[type]] + 3 * extension_cost)) {
           k   = i - 2;
           l   = j + 1;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3244,22 +3557,22 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 2]];
+        type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + 4 *
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 2] + plex->P->int11[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 4 *
              extension_cost)) {
           k   = i - 2;
           l   = j + 2;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3269,23 +3582,23 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 3]];
+        type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 3] +
-             P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 6 *
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 3] +
+             plex->P->int22[type2][plex->rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 6 *
              extension_cost)) {
           k   = i - 3;
           l   = j + 3;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3295,10 +3608,10 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 2]];
+        type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] +
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 2] + plex->P->int21[plex->rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] +
              5 *
              extension_cost)) {
           k   = i - 3;
@@ -3306,12 +3619,12 @@ fbacktrack(int        i,
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3321,10 +3634,10 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 3]];
+        type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] +
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 3] + plex->P->int21[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] +
              5 *
              extension_cost)) {
           k   = i - 2;
@@ -3332,12 +3645,12 @@ fbacktrack(int        i,
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3347,22 +3660,22 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 4]][S2[j + 3]];
-        if (type2 && c[i][j] == (c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 *
-                                 extension_cost)) {
+        type2 = plex->pair[plex->S1[i - 4]][plex->S2[j + 3]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 4][j + 3] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                       plex->P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                       plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 *
+                                       extension_cost)) {
           k   = i - 4;
           l   = j + 3;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3372,22 +3685,22 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 4]];
-        if (type2 && c[i][j] == (c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 *
-                                 extension_cost)) {
+        type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 4]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 3][j + 4] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                       plex->P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                       plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 *
+                                       extension_cost)) {
           k   = i - 3;
           l   = j + 4;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
-                           rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
-                           P);
+                           plex->rtype[type],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
+                           plex->P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
           i           = k;
@@ -3397,8 +3710,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 3][j + 3] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 *
              extension_cost +
              2 * iext_s)) {
           k           = i;
@@ -3412,8 +3725,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 4][j + 2] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 *
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3426,8 +3739,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 2][j + 4] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 *
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3440,8 +3753,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->inx[i - 3][j + 1] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3454,8 +3767,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->iny[i - 1][j + 3] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3468,7 +3781,7 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] == (bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU)) {
+        if (plex->c[i][j] == (plex->bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU)) {
           k           = i;
           l           = j;
           st1[i - 1]  = '(';
@@ -3480,7 +3793,7 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] == (by[i - 1][j + 2] + 2 * extension_cost + bext + bAU)) {
+        if (plex->c[i][j] == (plex->by[i - 1][j + 2] + 2 * extension_cost + bext + bAU)) {
           k           = i;
           l           = j;
           st1[i - 1]  = '(';
@@ -3494,7 +3807,7 @@ fbacktrack(int        i,
 
         break;
       case 2:
-        if (in[i][j] == (in[i - 1][j + 1] + iext_s)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j + 1] + iext_s)) {
           i--;
           j++;
           state   = 2;
@@ -3502,23 +3815,23 @@ fbacktrack(int        i,
           break;
         }
 
-        if (in[i][j] == (in[i - 1][j] + iext_ass)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j] + iext_ass)) {
           i       = i - 1;
           state   = 2;
           traced  = 1;
           break;
         }
 
-        if (in[i][j] == (in[i][j + 1] + iext_ass)) {
+        if (plex->in[i][j] == (plex->in[i][j + 1] + iext_ass)) {
           j++;
           state   = 2;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            in[i][j] == (c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s)) {
+            plex->in[i][j] == (plex->c[i - 1][j + 1] + plex->P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3526,16 +3839,16 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           i       = k;
           j       = l;
           state   = 1;
@@ -3544,15 +3857,15 @@ fbacktrack(int        i,
         }
 
       case 3:
-        if (bx[i][j] == (bx[i - 1][j] + bext)) {
+        if (plex->bx[i][j] == (plex->bx[i - 1][j] + bext)) {
           i--;
           state   = 3;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j]][S1[i - 1]];
-        if (type2 && bx[i][j] == (c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0))) {
+        type2 = plex->pair[plex->S2[j]][plex->S1[i - 1]];
+        if (type2 && plex->bx[i][j] == (plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0))) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3560,16 +3873,16 @@ fbacktrack(int        i,
           temp  = l;
           l     = j;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           i       = k;
           j       = l;
           state   = 1;
@@ -3578,7 +3891,7 @@ fbacktrack(int        i,
         }
 
       case 4:
-        if (by[i][j] == (by[i][j + 1] + bext)) {
+        if (plex->by[i][j] == (plex->by[i][j + 1] + bext)) {
           j++;
 
           state   = 4;
@@ -3586,8 +3899,8 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i]];
-        if (type2 && by[i][j] == (c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0))) {
+        type2 = plex->pair[plex->S2[j + 1]][plex->S1[i]];
+        if (type2 && plex->by[i][j] == (plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0))) {
           int temp;
           temp  = k;
           k     = i;
@@ -3595,16 +3908,16 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           i       = k;
           j       = l;
           state   = 1;
@@ -3613,17 +3926,17 @@ fbacktrack(int        i,
         }
 
       case 5:
-        if (inx[i][j] == (inx[i - 1][j] + iext_ass)) {
+        if (plex->inx[i][j] == (plex->inx[i - 1][j] + iext_ass)) {
           i--;
           state   = 5;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            inx[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s)) {
+            plex->inx[i][j] ==
+            (plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3631,16 +3944,16 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           i       = k;
           j       = l;
           state   = 1;
@@ -3649,17 +3962,17 @@ fbacktrack(int        i,
         }
 
       case 6:
-        if (iny[i][j] == (iny[i][j + 1] + iext_ass)) {
+        if (plex->iny[i][j] == (plex->iny[i][j + 1] + iext_ass)) {
           j++;
           state   = 6;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            iny[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s)) {
+            plex->iny[i][j] ==
+            (plex->c[i - 1][j + 1] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3667,16 +3980,16 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = plex->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
-                             rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
-                             P);
+                             plex->rtype[type],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
+                             plex->P);
           i       = k;
           j       = l;
           state   = 1;
@@ -3686,20 +3999,20 @@ fbacktrack(int        i,
     }
   }
   if (!traced) {
-    E = c[i][j];
+    E = plex->c[i][j];
     /**
     ***    if (i>1) {E -= P->dangle5[type][SS1[i-1]]+extension_cost; *dG+=P->dangle5[type][SS1[i-1]];}
     ***    if (j<n4){E -= P->dangle3[type][SS2[j+1]]+extension_cost; *dG+=P->dangle3[type][SS2[j+1]];}
     ***    if (type>2) {E -= P->TerminalAU; *dG+=P->TerminalAU;}
     **/
     int correction;
-    correction  = vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+    correction  = vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, plex->P);
     *dG         += correction;
     E           -= correction + 2 * extension_cost;
-    if (E != P->DuplexInit + 2 * extension_cost) {
+    if (E != plex->P->DuplexInit + 2 * extension_cost) {
       vrna_message_error("backtrack failed in second fold duplex");
     } else {
-      *dG         += P->DuplexInit;
+      *dG         += plex->P->DuplexInit;
       st1[i - 1]  = '(';
       st2[j - 1]  = ')';
     }
@@ -3708,7 +4021,7 @@ fbacktrack(int        i,
   if (i > 11)
     i--;
 
-  if (j < n4 - 10)
+  if (j < plex->n4 - 10)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -3730,68 +4043,108 @@ fbacktrack(int        i,
 }
 
 
-duplexT **
-Lduplexfold(const char  *s1,
-            const char  *s2,
-            const int   threshold,
-            const int   extension_cost,
-            const int   alignment_length,
-            const int   delta,
-            const int   fast,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b)
+PUBLIC void
+vrna_plex_scan(vrna_plex_t  *plex,
+               const char   *s1,
+               const char   *s2,
+               const int    threshold,
+               const int    extension_cost,
+               const int    alignment_length,
+               const int    delta,
+               const int    fast,
+               const int    il_a,
+               const int    il_b,
+               const int    b_a,
+               const int    b_b)
+{
+  scan(plex,
+       NULL,
+       s1,
+       s2,
+       threshold,
+       extension_cost,
+       alignment_length,
+       delta,
+       fast,
+       il_a,
+       il_b,
+       b_a,
+       b_b);
+}
+
+
+PRIVATE void
+scan(vrna_plex_t              *plex,
+     const vrna_plex_target_t *target,
+     const char               *s1,
+     const char               *s2,
+     const int                threshold,
+     const int                extension_cost,
+     const int                alignment_length,
+     const int                delta,
+     const int                fast,
+     const int                il_a,
+     const int                il_b,
+     const int                b_a,
+     const int                b_b)
 {
   /**
   *** See variable definition in fduplexfold_XS
   **/
-  int       i, j;
-  int       bopen       = b_b;
-  int       bext        = b_a + extension_cost;
-  int       iopen       = il_b;
-  int       iext_s      = 2 * (il_a + extension_cost);  /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
-  int       iext_ass    = 50 + il_a + extension_cost;   /* iext_ass assymetric extension of interior loop, either on i or on j side. */
-  int       min_colonne = INF;                          /* enthaelt das maximum einer kolonne */
-  int       i_length;
-  int       max_pos;                                    /* get position of the best hit */
-  int       max_pos_j;
-  int       temp = INF;
-  int       min_j_colonne;
-  int       max = INF;
-  int       *position; /* contains the position of the hits with energy > E */
-  int       *position_j;
+  int i, j, r;
+  int bopen       = b_b;
+  int bext        = b_a + extension_cost;
+  int iopen       = il_b;
+  int iext_s      = 2 * (il_a + extension_cost);  /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
+  int iext_ass    = 50 + il_a + extension_cost;   /* iext_ass assymetric extension of interior loop, either on i or on j side. */
+  int min_colonne = INF;                          /* enthaelt das maximum einer kolonne */
+  int i_length;
+  int max_pos;                                    /* get position of the best hit */
+  int max_pos_j;
+  int temp = INF;
+  int min_j_colonne;
+  int max = INF;
+  int *position; /* contains the position of the hits with energy > E */
+  int *position_j;
   /**
   *** 1D array corresponding to the standard 2d recursion matrix
   *** Makes the computation 20% faster
   **/
-  int       *SA;
-  vrna_md_t md;
+  int *SA;
+  int *regions;
 
   /**
   *** variable initialization
   **/
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
+  plex->n1  = (int)strlen(s1);
+  plex->n2  = (int)strlen(s2);
   /**
   *** Sequence encoding
   **/
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
+  if (target) {
+    plex->S1  = target->S1;
+    plex->SS1 = target->SS1;
+    plex->S2  = encode_seq(s2);
+    plex->SS2 = encode_alias(plex->alias, plex->S2);
+  } else {
+    encode_seqs(plex, s1, s2);
   }
 
-  encode_seqs(s1, s2);
   /**
   *** Position of the high score on the target and query sequence
   **/
-  position    = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
-  position_j  = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
+  position    = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
+  position_j  = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
+  /**
+  *** Restrict the scan to the target regions around seeds, if requested
+  **/
+  regions = NULL;
+  if ((target) && (target->seed_length > 0)) {
+    regions = seed_regions(plex, target, alignment_length);
+    for (i = 0; i < delta + plex->n1 + 3 + delta; i++)
+      position[i] = INF;
+  }
+
   /**
   *** instead of having 4 2-dim arrays we use a unique 1-dim array
   *** The mapping 2d -> 1D is done based ont the macro
@@ -3806,8 +4159,8 @@ Lduplexfold(const char  *s1,
   ***                  * 6 (number of structures we look at) *
   ***                  * length of the sequence
   **/
-  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (n2 + 5));
-  for (j = n2 + 4; j >= 0; j--) {
+  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (plex->n2 + 5));
+  for (j = plex->n2 + 4; j >= 0; j--) {
     SA[(j *
         30)]            =
       SA[(j * 30) + 1]  = SA[(j * 30) + 2] = SA[(j * 30) + 3] = SA[(j * 30) + 4] = INF;
@@ -3837,65 +4190,74 @@ Lduplexfold(const char  *s1,
          25]                  =
         SA[(j * 30) + 2 + 25] = SA[(j * 30) + 3 + 25] = SA[(j * 30) + 4 + 25] = INF;
   }
-  i         = 10;
-  i_length  = n1 - 9;
+  r         = 0;
+  i         = (regions) ? regions[0] : 10;
+  i_length  = plex->n1 - 9;
   while (i < i_length) {
+    if ((regions) && (i > regions[2 * r + 1])) {
+      /* restart the recursions at the begin of the next region */
+      r++;
+      i = regions[2 * r];
+      reset_columns(SA, plex->n2);
+      continue;
+    }
+
     int idx   = i % 5;
     int idx_1 = (i - 1) % 5;
     int idx_2 = (i - 2) % 5;
     int idx_3 = (i - 3) % 5;
     int idx_4 = (i - 4) % 5;
-    j = n2 - 9;
+    j = plex->n2 - 9;
     while (9 < --j) {
       int type, type2;
-      type = pair[S1[i]][S2[j]];
+      type = plex->pair[plex->S1[i]][plex->S2[j]];
       /**
       *** Start duplex
       **/
-      SA[LCI(idx, j, n2)] = type ? P->DuplexInit + 2 * extension_cost : INF;
+      SA[LCI(idx, j, plex->n2)] = type ? plex->P->DuplexInit + 2 * extension_cost : INF;
       /**
       *** update lin bx by linx liny matrix
       **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
+      type2 = plex->pair[plex->S2[j + 1]][plex->S1[i - 1]];
       /**
       *** start/extend interior loop
       **/
-      SA[LINI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                         n2)] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                                  SA[LINI(idx_1, j, n2)] + iext_ass);
+      SA[LINI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                               plex->n2)] + plex->P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                                        SA[LINI(idx_1, j, plex->n2)] + iext_ass);
       /**
       *** start/extend nx1 target
       *** use same type2 as for in
       **/
-      SA[LINIX(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                                   SA[LINIX(idx_1, j, n2)] + iext_ass);
+      SA[LINIX(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                                plex->n2)] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                                         SA[LINIX(idx_1, j, plex->n2)] + iext_ass);
       /**
       *** start/extend 1xn target
       *** use same type2 as for in
       **/
-      SA[LINIY(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                                   SA[LINIY(idx, j + 1, n2)] + iext_ass);
+      SA[LINIY(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                                plex->n2)] + plex->P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                                         SA[LINIY(idx, j + 1, plex->n2)] + iext_ass);
       /**
       *** extend interior loop
       **/
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)], SA[LINI(idx, j + 1, n2)] + iext_ass);
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)], SA[LINI(idx_1, j + 1, n2)] + iext_s);
+      SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)], SA[LINI(idx, j + 1, plex->n2)] + iext_ass);
+      SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)], SA[LINI(idx_1, j + 1, plex->n2)] + iext_s);
       /**
       *** start/extend bulge target
       **/
-      type2                 = pair[S2[j]][S1[i - 1]];
-      SA[LBXI(idx, j, n2)]  = MIN2(SA[LBXI(idx_1, j, n2)] + bext,
-                                   SA[LCI(idx_1, j,
-                                          n2)] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+      type2                       = plex->pair[plex->S2[j]][plex->S1[i - 1]];
+      SA[LBXI(idx, j, plex->n2)]  = MIN2(SA[LBXI(idx_1, j, plex->n2)] + bext,
+                                         SA[LCI(idx_1, j,
+                                                plex->n2)] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0));
       /**
       *** start/extend bulge query
       **/
-      type2                 = pair[S2[j + 1]][S1[i]];
-      SA[LBYI(idx, j, n2)]  = MIN2(SA[LBYI(idx, j + 1, n2)] + bext,
-                                   SA[LCI(idx, j + 1,
-                                          n2)] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+      type2                       = plex->pair[plex->S2[j + 1]][plex->S1[i]];
+      SA[LBYI(idx, j, plex->n2)]  = MIN2(SA[LBYI(idx, j + 1, plex->n2)] + bext,
+                                         SA[LCI(idx, j + 1,
+                                                plex->n2)] + bopen + bext + (type2 > 2 ? plex->P->TerminalAU : 0));
       /**
        ***end update recursion
        ***##################### Start stack extension ######################
@@ -3905,49 +4267,49 @@ Lduplexfold(const char  *s1,
                   *** stack extension
                   **/
 
-      SA[LCI(idx, j, n2)] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P) + 2 * extension_cost;
+      SA[LCI(idx, j, plex->n2)] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], plex->P) + 2 * extension_cost;
       /**
       *** stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->stack[rtype[type]][type2] + 2 * extension_cost,
-                                   SA[LCI(idx, j, n2)]);
+      if ((type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+        SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                                plex->n2)] + plex->P->stack[plex->rtype[type]][type2] + 2 * extension_cost,
+                                         SA[LCI(idx, j, plex->n2)]);
 
       /**
       *** 1x0 / 0x1 stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 2]])) {
+      if ((type2 = plex->pair[plex->S1[i - 1]][plex->S2[j + 2]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_1, j + 2,
-                                  n2)] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_1, j + 2,
+                                        plex->n2)] + plex->P->bulge[1] + plex->P->stack[plex->rtype[type]][type2] + 3 * extension_cost,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 1]])) {
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 1]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 1,
-                                  n2)] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_2, j + 1,
+                                        plex->n2)] + plex->P->bulge[1] + plex->P->stack[type2][plex->rtype[type]] + 3 * extension_cost,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
       *** 1x1 / 2x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 2]][S2[j + 2]])) {
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 2]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 2,
-                                  n2)] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + 4 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_2, j + 2,
+                                        plex->n2)] + plex->P->int11[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 4 * extension_cost,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 3]])) {
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 3]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 3,
-                                  n2)] +
-                           P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j +
-                                                                                                2]] + 6 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_3, j + 3,
+                                        plex->n2)] +
+                                 plex->P->int22[type2][plex->rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j +
+                                 2]] + 6 * extension_cost,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
@@ -3955,39 +4317,39 @@ Lduplexfold(const char  *s1,
       *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
       *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
       **/
-      if ((type2 = pair[S1[i - 3]][S2[j + 2]])) {
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 2]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 2,
-                                  n2)] +
-                           P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + 5 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_3, j + 2,
+                                        plex->n2)] +
+                                 plex->P->int21[plex->rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + 5 * extension_cost,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 3]])) {
+      if ((type2 = plex->pair[plex->S1[i - 2]][plex->S2[j + 3]])) {
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 3,
-                                  n2)] +
-                           P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 5 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
+               plex->n2)] = MIN2(SA[LCI(idx_2, j + 3,
+                                        plex->n2)] +
+                                 plex->P->int21[type2][plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 5 * extension_cost,
+                                 SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
       *** 2x3 / 3x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_4, j + 3,
-                                          n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                                   SA[LCI(idx, j, n2)]);
+      if ((type2 = plex->pair[plex->S1[i - 4]][plex->S2[j + 3]])) {
+        SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_4, j + 3,
+                                                plex->n2)] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                         plex->P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                         plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                                         SA[LCI(idx, j, plex->n2)]);
       }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_3, j + 4,
-                                          n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                                   SA[LCI(idx, j, n2)]);
+      if ((type2 = plex->pair[plex->S1[i - 3]][plex->S2[j + 4]])) {
+        SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_3, j + 4,
+                                                plex->n2)] + plex->P->internal_loop[5] + plex->P->ninio[2] +
+                                         plex->P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                         plex->P->mismatch23I[plex->rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                                         SA[LCI(idx, j, plex->n2)]);
       }
 
       /**
@@ -3997,55 +4359,55 @@ Lduplexfold(const char  *s1,
       *** 3x3 or more
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_3, j + 3,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINI(idx_3, j + 3,
+                                       plex->n2)] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** 2xn or more
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_4, j + 2,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINI(idx_4, j + 2,
+                                       plex->n2)] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** nx2 or more
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_2, j + 4,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINI(idx_2, j + 4,
+                                       plex->n2)] + plex->P->mismatchI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** nx1 n>2
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIX(idx_3, j + 1,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINIX(idx_3, j + 1,
+                                        plex->n2)] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** 1xn n>2
       **/
       SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIY(idx_1, j + 3,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
+             plex->n2)] = MIN2(SA[LINIY(idx_1, j + 3,
+                                        plex->n2)] + plex->P->mismatch1nI[plex->rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+                               SA[LCI(idx, j, plex->n2)]);
       /**
       *** nx0 n>1
       **/
       int bAU;
-      bAU = (type > 2 ? P->TerminalAU : 0);
+      bAU = (type > 2 ? plex->P->TerminalAU : 0);
       SA[LCI(idx, j,
-             n2)] =
-        MIN2(SA[LBXI(idx_2, j + 1, n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, n2)]);
+             plex->n2)] =
+        MIN2(SA[LBXI(idx_2, j + 1, plex->n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, plex->n2)]);
       /**
       *** 0xn n>1
       **/
       SA[LCI(idx, j,
-             n2)] =
-        MIN2(SA[LBYI(idx_1, j + 2, n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, n2)]);
+             plex->n2)] =
+        MIN2(SA[LBYI(idx_1, j + 2, plex->n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, plex->n2)]);
       temp = min_colonne;
 
-      min_colonne = MIN2(SA[LCI(idx, j, n2)] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1],
-                                                         P) + 2 * extension_cost,
+      min_colonne = MIN2(SA[LCI(idx, j, plex->n2)] + vrna_E_ext_stem(plex->rtype[type], plex->SS2[j - 1], plex->SS1[i + 1],
+                                                                     plex->P) + 2 * extension_cost,
                          min_colonne);
       if (temp > min_colonne)
         min_j_colonne = j;
@@ -4062,12 +4424,16 @@ Lduplexfold(const char  *s1,
     i++;
   }
   /* printf("MAX: %d",max); */
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  if (!target) {
+    free(plex->S1);
+    free(plex->SS1);
+  }
+
+  free(plex->S2);
+  free(plex->SS2);
   if (max < threshold) {
-    find_max(position,
+    find_max(plex,
+             position,
              position_j,
              delta,
              threshold,
@@ -4083,7 +4449,8 @@ Lduplexfold(const char  *s1,
   }
 
   if (max < INF) {
-    plot_max(max,
+    plot_max(plex,
+             max,
              max_pos,
              max_pos_j,
              alignment_length,
@@ -4100,26 +4467,27 @@ Lduplexfold(const char  *s1,
   free(SA);
   free(position);
   free(position_j);
-  return NULL;
+  free(regions);
 }
 
 
 PRIVATE void
-find_max(const int  *position,
-         const int  *position_j,
-         const int  delta,
-         const int  threshold,
-         const int  alignment_length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b)
+find_max(vrna_plex_t  *plex,
+         const int    *position,
+         const int    *position_j,
+         const int    delta,
+         const int    threshold,
+         const int    alignment_length,
+         const char   *s1,
+         const char   *s2,
+         const int    extension_cost,
+         const int    fast,
+         const int    il_a,
+         const int    il_b,
+         const int    b_a,
+         const int    b_b)
 {
-  int pos = n1 - 9;
+  int pos = plex->n1 - 9;
 
   if (fast == 1) {
     while (10 < pos--) {
@@ -4136,15 +4504,15 @@ find_max(const int  *position,
         max_pos_j = position_j[pos + delta];
         int max;
         max = position[pos + delta];
-        printf("target upper bound %d: query lower bound %d  (%5.2f) \n",
-               pos - 10,
-               max_pos_j - 10,
-               ((double)max) / 100);
+        plex_printf(plex, "target upper bound %d: query lower bound %d  (%5.2f) \n",
+                    pos - 10,
+                    max_pos_j - 10,
+                    ((double)max) / 100);
         pos = MAX2(10, pos + temp_min - delta);
       }
     }
   } else if (fast == 2) {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -4163,11 +4531,11 @@ find_max(const int  *position,
          * max_pos_j -> position 1 in the sequence ( not 0 like in C)
          */
         int   alignment_length2;
-        alignment_length2 = MIN2(n1, n2);
+        alignment_length2 = MIN2(plex->n1, plex->n2);
         int   begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int   end_t   = MIN2(n1 - 10, pos + 1);
+        int   end_t   = MIN2(plex->n1 - 10, pos + 1);
         int   begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
         char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
         strcpy(s3, "NNNNNNNNNN");
@@ -4179,16 +4547,16 @@ find_max(const int  *position,
         s3[end_t - begin_t + 1 + 20]  = '\0';
         s4[end_q - begin_q + 1 + 20]  = '\0';
         duplexT test;
-        test = fduplexfold(s3, s4, extension_cost, il_a, il_b, b_a, b_b);
+        test = fduplexfold(plex, s3, s4, extension_cost, il_a, il_b, b_a, b_b);
         if (test.energy * 100 < threshold) {
           int l1 = strchr(test.structure, '&') - test.structure;
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f]  i:%d,j:%d <%5.2f>\n", test.structure,
-                 begin_t - 10 + test.i - l1 - 10,
-                 begin_t - 10 + test.i - 1 - 10,
-                 begin_q - 10 + test.j - 1 - 10,
-                 (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-                 test.energy, test.energy_backtrack, pos - 10, max_pos_j - 10,
-                 ((double)position[pos + delta]) / 100);
+          plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f]  i:%d,j:%d <%5.2f>\n", test.structure,
+                      begin_t - 10 + test.i - l1 - 10,
+                      begin_t - 10 + test.i - 1 - 10,
+                      begin_q - 10 + test.j - 1 - 10,
+                      (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                      test.energy, test.energy_backtrack, pos - 10, max_pos_j - 10,
+                      ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -4201,7 +4569,7 @@ find_max(const int  *position,
 
 #if 0
   else if (fast == 3) {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -4225,12 +4593,12 @@ find_max(const int  *position,
 
         int   alignment_length2;
         //Select the smallest interaction length in order to define the new interaction length
-        alignment_length2 = MIN2(n1 - pos + 1, max_pos_j - 1 + 1);
+        alignment_length2 = MIN2(plex->n1 - pos + 1, max_pos_j - 1 + 1);
         //
         int   begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int   end_t   = MIN2(n1 - 10, pos + 1);
+        int   end_t   = MIN2(plex->n1 - 10, pos + 1);
         int   begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
         char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
         strcpy(s3, "NNNNNNNNNN");
@@ -4242,7 +4610,7 @@ find_max(const int  *position,
         s3[end_t - begin_t + 1 + 20]  = '\0';
         s4[end_q - begin_q + 1 + 20]  = '\0';
         duplexT test;
-        test = fduplexfold(s4, s3, extension_cost, il_a, il_b, b_a, b_b);
+        test = fduplexfold(plex, s4, s3, extension_cost, il_a, il_b, b_a, b_b);
         if (test.energy * 100 < threshold) {
           int   structureLength = strlen(test.structure);
           int   l1 = strchr(test.structure, '&') - test.structure;
@@ -4269,17 +4637,17 @@ find_max(const int  *position,
           //          l1=strchr(reverse.structure, '&')-test.structure;
 
 
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
-                 reverseStructure,
-                 begin_t - 10 + test.j - 1 - 10,
-                 (begin_t - 11) + test.j + strlen(test.structure) - l1 - 2 - 10,
-                 begin_q - 10 + test.i - l1 - 10,
-                 begin_q - 10 + test.i - 1 - 10,
-                 test.energy,
-                 test.energy_backtrack,
-                 pos,
-                 max_pos_j,
-                 ((double)position[pos + delta]) / 100);
+          plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
+                      reverseStructure,
+                      begin_t - 10 + test.j - 1 - 10,
+                      (begin_t - 11) + test.j + strlen(test.structure) - l1 - 2 - 10,
+                      begin_q - 10 + test.i - l1 - 10,
+                      begin_q - 10 + test.i - 1 - 10,
+                      test.energy,
+                      test.energy_backtrack,
+                      pos,
+                      max_pos_j,
+                      ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -4291,7 +4659,7 @@ find_max(const int  *position,
   }
 #endif
   else {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -4310,11 +4678,11 @@ find_max(const int  *position,
          * max_pos_j -> position 1 in the sequence ( not 0 like in C)
          */
         int     alignment_length2;
-        alignment_length2 = MIN2(n1, n2);
+        alignment_length2 = MIN2(plex->n1, plex->n2);
         int     begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int     end_t   = MIN2(n1 - 10, pos + 1);
+        int     end_t   = MIN2(plex->n1 - 10, pos + 1);
         int     begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int     end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int     end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char    *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2));
         char    *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2));
         strncpy(s3, (s1 + begin_t - 1), end_t - begin_t + 1);
@@ -4322,15 +4690,15 @@ find_max(const int  *position,
         s3[end_t - begin_t + 1] = '\0';
         s4[end_q - begin_q + 1] = '\0';
         duplexT test;
-        test = duplexfold(s3, s4, extension_cost);
+        test = duplexfold(plex, s3, s4, extension_cost);
         if (test.energy * 100 < threshold) {
           int l1 = strchr(test.structure, '&') - test.structure;
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f)  i:%d,j:%d <%5.2f>\n", test.structure,
-                 begin_t - 10 + test.i - l1,
-                 begin_t - 10 + test.i - 1,
-                 begin_q - 10 + test.j - 1,
-                 (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
-                 test.energy, pos - 10, max_pos_j - 10, ((double)position[pos + delta]) / 100);
+          plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f)  i:%d,j:%d <%5.2f>\n", test.structure,
+                      begin_t - 10 + test.i - l1,
+                      begin_t - 10 + test.i - 1,
+                      begin_q - 10 + test.j - 1,
+                      (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
+                      test.energy, pos - 10, max_pos_j - 10, ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -4344,29 +4712,30 @@ find_max(const int  *position,
 
 
 PRIVATE void
-plot_max(const int  max,
-         const int  max_pos,
-         const int  max_pos_j,
-         const int  alignment_length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b)
+plot_max(vrna_plex_t  *plex,
+         const int    max,
+         const int    max_pos,
+         const int    max_pos_j,
+         const int    alignment_length,
+         const char   *s1,
+         const char   *s2,
+         const int    extension_cost,
+         const int    fast,
+         const int    il_a,
+         const int    il_b,
+         const int    b_a,
+         const int    b_b)
 {
   if (fast == 1) {
-    printf("target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 10, max_pos_j - 10,
-           ((double)max) / 100);
+    plex_printf(plex, "target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 10, max_pos_j - 10,
+                ((double)max) / 100);
   } else if (fast == 2) {
     int   alignment_length2;
-    alignment_length2 = MIN2(n1, n2);
+    alignment_length2 = MIN2(plex->n1, plex->n2);
     int   begin_t = MAX2(11, max_pos - alignment_length2 + 1);  /* 10 */
-    int   end_t   = MIN2(n1 - 10, max_pos + 1);
+    int   end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int   begin_q = MAX2(11, max_pos_j - 1);                    /* 10 */
-    int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+    int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
     char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
     char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
     strcpy(s3, "NNNNNNNNNN");
@@ -4378,39 +4747,39 @@ plot_max(const int  max,
     s3[end_t - begin_t + 1 + 20]  = '\0';
     s4[end_q - begin_q + 1 + 20]  = '\0';
     duplexT test;
-    test = fduplexfold(s3, s4, extension_cost, il_a, il_b, b_a, b_b);
+    test = fduplexfold(plex, s3, s4, extension_cost, il_a, il_b, b_a, b_b);
     int     l1 = strchr(test.structure, '&') - test.structure;
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n", test.structure,
-           begin_t - 10 + test.i - l1 - 10,
-           begin_t - 10 + test.i - 1 - 10,
-           begin_q - 10 + test.j - 1 - 10,
-           (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-           test.energy, test.energy_backtrack, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
+    plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n", test.structure,
+                begin_t - 10 + test.i - l1 - 10,
+                begin_t - 10 + test.i - 1 - 10,
+                begin_q - 10 + test.j - 1 - 10,
+                (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                test.energy, test.energy_backtrack, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
     free(s3);
     free(s4);
     free(test.structure);
   } else {
     duplexT test;
     int     alignment_length2;
-    alignment_length2 = MIN2(n1, n2);
+    alignment_length2 = MIN2(plex->n1, plex->n2);
     int     begin_t = MAX2(11, max_pos - alignment_length2 + 1);
-    int     end_t   = MIN2(n1 - 10, max_pos + 1);
+    int     end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int     begin_q = MAX2(11, max_pos_j - 1);
-    int     end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+    int     end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
     char    *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2));
     char    *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2));
     strncpy(s3, (s1 + begin_t - 1), end_t - begin_t + 1);
     strncpy(s4, (s2 + begin_q - 1), end_q - begin_q + 1);
     s3[end_t - begin_t + 1] = '\0';
     s4[end_q - begin_q + 1] = '\0';
-    test                    = duplexfold(s3, s4, extension_cost);
+    test                    = duplexfold(plex, s3, s4, extension_cost);
     int l1 = strchr(test.structure, '&') - test.structure;
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f) i:%d,j:%d <%5.2f>\n", test.structure,
-           begin_t - 10 + test.i - l1,
-           begin_t - 10 + test.i - 1,
-           begin_q - 10 + test.j - 1,
-           (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
-           test.energy, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
+    plex_printf(plex, "%s %3d,%-3d : %3d,%-3d (%5.2f) i:%d,j:%d <%5.2f>\n", test.structure,
+                begin_t - 10 + test.i - l1,
+                begin_t - 10 + test.i - 1,
+                begin_q - 10 + test.j - 1,
+                (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
+                test.energy, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
     free(s3);
     free(s4);
     free(test.structure);
@@ -4418,41 +4787,107 @@ plot_max(const int  max,
 }
 
 
-PRIVATE void
-update_dfold_params(void)
+/*
+ *  Collect the target regions to scan for the current query. A region spans
+ *  alignment_length nucleotides on either side of each target k-mer that forms
+ *  a helix of consecutive Watson-Crick base pairs with a k-mer of the query.
+ *  Overlapping regions are merged. The list holds the first and last column of
+ *  each region and ends with an empty region starting at n1 - 9
+ */
+PRIVATE int *
+seed_regions(vrna_plex_t              *plex,
+             const vrna_plex_target_t *target,
+             const int                alignment_length)
 {
-  vrna_md_t md;
+  unsigned int  k, c, code;
+  int           i, p, q, lo, hi, n, depth, *cover, *regions;
+
+  k       = target->seed_length;
+  cover   = (int *)vrna_alloc(sizeof(int) * (plex->n1 + 2));
+  regions = (int *)vrna_alloc(sizeof(int) * 2);
+  n       = 0;
+
+  for (q = 11; q + (int)k - 1 <= plex->n2 - 10; q++) {
+    /* the complementary target k-mer, 5' to 3', where A=1, C=2, G=3, U=4 pair with 5 - x */
+    for (code = 0, c = 0; c < k; c++) {
+      if ((plex->S2[q + k - 1 - c] < 1) || (plex->S2[q + k - 1 - c] > 4))
+        break;
+
+      code = (code << 2) | (unsigned int)(4 - plex->S2[q + k - 1 - c]);
+    }
+    if (c < k)
+      continue;
+
+    for (i = target->seed_first[code]; i < (int)target->seed_first[code + 1]; i++) {
+      p   = (int)target->seed_pos[i];
+      lo  = MAX2(10, p - alignment_length);
+      hi  = MIN2(plex->n1 - 10, p + (int)k - 1 + alignment_length);
+      cover[lo]++;
+      cover[hi + 1]--;
+    }
+  }
+
+  for (depth = 0, i = 10; i < plex->n1 - 9; i++) {
+    depth += cover[i];
+    if (depth > 0) {
+      if ((n > 0) && (regions[2 * n - 1] == i - 1)) {
+        regions[2 * n - 1] = i;
+      } else {
+        regions             = (int *)vrna_realloc(regions, sizeof(int) * (2 * n + 4));
+        regions[2 * n]      = i;
+        regions[2 * n + 1]  = i;
+        n++;
+      }
+    }
+  }
+
+  regions[2 * n]      = plex->n1 - 9;
+  regions[2 * n + 1]  = plex->n1 - 9;
+
+  free(cover);
+
+  return regions;
+}
+
 
-  if (P)
-    free(P);
+PRIVATE void
+reset_columns(int *SA,
+              int n2)
+{
+  int k;
 
-  set_model_details(&md);
-  P = vrna_params(&md);
-  make_pair_matrix();
+  for (k = 5 * 6 * (n2 + 5) - 1; k >= 0; k--)
+    SA[k] = INF;
 }
 
 
 PRIVATE void
-encode_seqs(const char  *s1,
+encode_seqs(vrna_plex_t *plex,
+            const char  *s1,
             const char  *s2)
 {
-  unsigned int i, l;
+  plex->S1  = encode_seq(s1);
+  plex->SS1 = encode_alias(plex->alias, plex->S1);
+  plex->S2  = encode_seq(s2);
+  plex->SS2 = encode_alias(plex->alias, plex->S2);
+}
 
-  l   = strlen(s1);
-  S1  = encode_seq(s1);
-  SS1 = (short *)vrna_alloc(sizeof(short) * (l + 1));
-  /* SS1 exists only for the special X K and I bases and energy_set!=0 */
 
-  for (i = 1; i <= l; i++)  /* make numerical encoding of sequence */
-    SS1[i] = alias[S1[i]];  /* for mismatches of nostandard bases */
+PRIVATE short *
+encode_alias(const short  *alias,
+             const short  *S)
+{
+  unsigned int  i, l;
+  short         *SS;
 
-  l   = strlen(s2);
-  S2  = encode_seq(s2);
-  SS2 = (short *)vrna_alloc(sizeof(short) * (l + 1));
-  /* SS2 exists only for the special X K and I bases and energy_set!=0 */
+  l   = (unsigned int)S[0];
+  SS  = (short *)vrna_alloc(sizeof(short) * (l + 1));
+  /* SS exists only for the special X K and I bases and energy_set!=0 */
 
   for (i = 1; i <= l; i++)  /* make numerical encoding of sequence */
-    SS2[i] = alias[S2[i]];  /* for mismatches of nostandard bases */
+    SS[i] = alias[S[i]];    /* for mismatches of nostandard bases */
+
+  return SS;
 }
 
 
@@ -4477,6 +4912,78 @@ encode_seq(const char *sequence)
 }
 
 
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
+/*
+ *###########################################
+ *# deprecated functions below              #
+ *###########################################
+ */
+PUBLIC duplexT **
+Lduplexfold(const char  *s1,
+            const char  *s2,
+            const int   threshold,
+            const int   extension_cost,
+            const int   alignment_length,
+            const int   delta,
+            const int   fast,
+            const int   il_a,
+            const int   il_b,
+            const int   b_a,
+            const int   b_b)
+{
+  vrna_plex_scan(plex_backward_compat(&backward_compat_plex),
+                 s1,
+                 s2,
+                 threshold,
+                 extension_cost,
+                 alignment_length,
+                 delta,
+                 fast,
+                 il_a,
+                 il_b,
+                 b_a,
+                 b_b);
+
+  return NULL;
+}
+
+
+PUBLIC duplexT **
+Lduplexfold_XS(const char *s1,
+               const char *s2,
+               const int  **access_s1,
+               const int  **access_s2,
+               const int  threshold,
+               const int  alignment_length,
+               const int  delta,
+               const int  fast,
+               const int  il_a,
+               const int  il_b,
+               const int  b_a,
+               const int  b_b)
+{
+  vrna_plex_scan_XS(plex_backward_compat(&backward_compat_plex),
+                    s1,
+                    s2,
+                    access_s1,
+                    access_s2,
+                    threshold,
+                    alignment_length,
+                    delta,
+                    fast,
+                    il_a,
+                    il_b,
+                    b_a,
+                    b_b);
+
+  return NULL;
+}
+
+
+#endif
+
+
 int
 arraySize(duplexT **array)
 {
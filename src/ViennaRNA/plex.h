@@ -2,6 +2,227 @@
 #define VIENNA_RNA_PACKAGE_PLEX_H
 
 #include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/datastructures/char_stream.h>
+#include <ViennaRNA/model.h>
+
+/**
+ *  @file     plex.h
+ *  @ingroup  cofold
+ *  @brief    Fast local RNA-RNA interaction search (RNAplex)
+ */
+
+/**
+ *  @brief  An RNAplex interaction search engine
+ *
+ *  The engine holds the energy parameters, dynamic programming matrices and
+ *  sequence encodings of an interaction search. An engine may be reused for
+ *  any number of target/query pairs, and different engines can be used
+ *  concurrently, e.g. one per thread.
+ *
+ *  @see  vrna_plex_init(), vrna_plex_free(), vrna_plex_scan(), vrna_plex_scan_XS(),
+ *        vrna_plex_scan_C(), vrna_plex_scan_CXS()
+ */
+typedef struct vrna_plex_s vrna_plex_t;
+
+
+/**
+ *  @brief  Create an RNAplex interaction search engine
+ *
+ *  @param  md  The model details to use, or NULL for default settings
+ *  @return     The engine, to be released by vrna_plex_free()
+ */
+vrna_plex_t *
+vrna_plex_init(const vrna_md_t *md);
+
+
+/**
+ *  @brief  Release an RNAplex interaction search engine
+ */
+void
+vrna_plex_free(vrna_plex_t *plex);
+
+
+/**
+ *  @brief  Set where an RNAplex interaction search engine reports its interactions
+ *
+ *  By default, interactions are written to @p stdout as soon as they are found.
+ *  Setting a character stream instead allows for collecting the output of
+ *  concurrent searches, e.g. to be passed on in order through a #vrna_ostream_t.
+ *
+ *  @param  plex    The engine
+ *  @param  output  The character stream to append the interactions to, or NULL for @p stdout
+ */
+void
+vrna_plex_set_output(vrna_plex_t  *plex,
+                     vrna_cstr_t  output);
+
+
+/**
+ *  @brief  Compute local interactions between a target and a query sequence
+ *
+ *  This is the reentrant version of Lduplexfold().
+ */
+void
+vrna_plex_scan(vrna_plex_t  *plex,
+               const char   *s1,
+               const char   *s2,
+               const int    threshold,
+               const int    extension_cost,
+               const int    alignment_length,
+               const int    delta,
+               const int    fast,
+               const int    il_a,
+               const int    il_b,
+               const int    b_a,
+               const int    b_b);
+
+
+/**
+ *  @brief  Compute local interactions between a target and a query sequence with accessibility
+ *
+ *  This is the reentrant version of Lduplexfold_XS().
+ */
+void
+vrna_plex_scan_XS(vrna_plex_t *plex,
+                  const char  *s1,
+                  const char  *s2,
+                  const int   **access_s1,
+                  const int   **access_s2,
+                  const int   threshold,
+                  const int   alignment_length,
+                  const int   delta,
+                  const int   fast,
+                  const int   il_a,
+                  const int   il_b,
+                  const int   b_a,
+                  const int   b_b);
+
+
+/**
+ *  @brief  Compute local interactions between a target and a query sequence under a structure constraint
+ *
+ *  This is the reentrant version of Lduplexfold_C().
+ */
+void
+vrna_plex_scan_C(vrna_plex_t  *plex,
+                 const char   *s1,
+                 const char   *s2,
+                 const int    threshold,
+                 const int    extension_cost,
+                 const int    alignment_length,
+                 const int    delta,
+                 const int    fast,
+                 const char   *structure,
+                 const int    il_a,
+                 const int    il_b,
+                 const int    b_a,
+                 const int    b_b);
+
+
+/**
+ *  @brief  Compute local interactions between a target and a query sequence under a structure constraint with accessibility
+ *
+ *  This is the reentrant version of Lduplexfold_CXS().
+ */
+void
+vrna_plex_scan_CXS(vrna_plex_t  *plex,
+                   const char   *s1,
+                   const char   *s2,
+                   const int    **access_s1,
+                   const int    **access_s2,
+                   const int    threshold,
+                   const int    alignment_length,
+                   const int    delta,
+                   const int    fast,
+                   const char   *structure,
+                   const int    il_a,
+                   const int    il_b,
+                   const int    b_a,
+                   const int    b_b);
+
+
+/**
+ *  @brief  The maximal seed length of an RNAplex target index
+ */
+#define VRNA_PLEX_SEED_MAX  10
+
+
+/**
+ *  @brief  An index of a target sequence for repeated RNAplex interaction searches
+ *
+ *  The index holds everything of the target side that does not depend on the
+ *  query, i.e. the encoded sequence, the accessibility terms derived from its
+ *  opening energy profile and, optionally, a table of the positions of all
+ *  k-mers of the target. The latter serves as a seed filter: queries are then
+ *  only scanned against those target regions that contain a helix of at least
+ *  k consecutive Watson-Crick base pairs with the query.
+ *
+ *  An index is never modified by a search, so it can be shared by any number
+ *  of engines, e.g. one per thread.
+ *
+ *  @see  vrna_plex_target_init(), vrna_plex_target_free(), vrna_plex_scan_target()
+ */
+typedef struct vrna_plex_target_s vrna_plex_target_t;
+
+
+/**
+ *  @brief  Create an index of a target sequence for repeated RNAplex interaction searches
+ *
+ *  The target sequence must be padded with 10 'N' on both sides, just like for
+ *  vrna_plex_scan(). The accessibility profile is not copied and must remain
+ *  valid for the lifetime of the index. The index must be used with engines that
+ *  have been created with the same model details.
+ *
+ *  @param  md            The model details to use, or NULL for default settings
+ *  @param  s1            The (padded) target sequence
+ *  @param  access_s1     The opening energy profile of the target, or NULL
+ *  @param  seed_length   The minimal number of consecutive base pairs of an interaction (at most #VRNA_PLEX_SEED_MAX), or 0 to scan the entire target
+ *  @return               The index, to be released by vrna_plex_target_free(), or NULL on error
+ */
+vrna_plex_target_t *
+vrna_plex_target_init(const vrna_md_t *md,
+                      const char      *s1,
+                      const int       **access_s1,
+                      unsigned int    seed_length);
+
+
+/**
+ *  @brief  Release an RNAplex target index
+ */
+void
+vrna_plex_target_free(vrna_plex_target_t *target);
+
+
+/**
+ *  @brief  Compute local interactions between an indexed target and a query sequence
+ *
+ *  Depending on whether the index has been created with an accessibility profile,
+ *  this function behaves like vrna_plex_scan_XS() (@p extension_cost is ignored)
+ *  or like vrna_plex_scan() (@p access_s2 is ignored). Without seed filter, the
+ *  interactions are identical to those of the respective function. Otherwise,
+ *  only target regions of at most @p alignment_length nucleotides around a seed
+ *  are taken into account, and nothing is reported if no seed is found.
+ *
+ *  @param  plex        The engine
+ *  @param  target      The index of the target
+ *  @param  s2          The (padded) query sequence
+ *  @param  access_s2   The opening energy profile of the query
+ */
+void
+vrna_plex_scan_target(vrna_plex_t               *plex,
+                      const vrna_plex_target_t  *target,
+                      const char                *s2,
+                      const int                 **access_s2,
+                      const int                 threshold,
+                      const int                 extension_cost,
+                      const int                 alignment_length,
+                      const int                 delta,
+                      const int                 fast,
+                      const int                 il_a,
+                      const int                 il_b,
+                      const int                 b_a,
+                      const int                 b_b);
+
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
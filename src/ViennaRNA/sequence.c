@@ -340,7 +340,11 @@ vrna_sequence_remove_all(vrna_fold_compound_t *fc)
       free(fc->alignment);
       fc->alignment = NULL;
       /* free memory occupied by temporary hack in vrna_sequence_prepare() */
-      free_sequence_data(&(fc->nucleotides[0]));
+      if (fc->nucleotides) {
+        free_sequence_data(&(fc->nucleotides[0]));
+        free(fc->nucleotides);
+        fc->nucleotides = NULL;
+      }
     }
 
     free(fc->strand_number);
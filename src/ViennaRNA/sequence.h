@@ -18,6 +18,24 @@ typedef struct vrna_sequence_s vrna_seq_t;
 
 typedef struct vrna_alignment_s vrna_msa_t;
 
+/**
+ *  @brief  Callback to retrieve a nucleotide sequence in consecutive blocks
+ *
+ *  Functions of this type are used to feed (very long) sequences into the library without
+ *  keeping them in memory at once. Each call writes the next at most @p size nucleotides
+ *  of the sequence to @p buffer. The buffer must not be terminated by a '\0' character.
+ *
+ *  @see  vrna_mfe_window_source_cb(), vrna_probs_window_source(), vrna_file_fasta_read_block()
+ *
+ *  @param  buffer  The memory the next nucleotides are written to
+ *  @param  size    The maximum number of nucleotides to write
+ *  @param  data    An arbitrary data pointer passed through by the caller
+ *  @return         The number of nucleotides written to @p buffer, or 0 at the end of the sequence
+ */
+typedef unsigned int (vrna_sequence_source_callback)(char         *buffer,
+                                                     unsigned int size,
+                                                     void         *data);
+
 #include <ViennaRNA/fold_compound.h>
 
 
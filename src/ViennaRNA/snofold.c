@@ -52,13 +52,16 @@ make_ptypes(const short *S,
             const char  *structure);
 
 
-PRIVATE void
+PRIVATE short *
 encode_seq(const char *sequence);
 
 
 PRIVATE void
-backtrack(const char  *sequence,
-          int         s);
+backtrack(const char      *sequence,
+          int             s,
+          sect            *bt_stack,
+          vrna_bp_stack_t *bp_stack,
+          const short     *S1);
 
 
 PRIVATE int
@@ -381,7 +384,7 @@ snofold(const char  *string,
   BP = (int *)vrna_alloc(sizeof(int) * (length + 2));
   make_ptypes(S, structure);
   energy = fill_arrays(string, max_assym, threshloop, min_s2, max_s2, half_stem, max_half_stem);
-  backtrack(string, s);
+  backtrack(string, s, sector, base_pair, S1);
 
   free(structure);
   free(S);
@@ -1072,8 +1075,11 @@ fill_arrays(const char  *string,
 
 
 PRIVATE void
-backtrack(const char  *string,
-          int         s)
+backtrack(const char      *string,
+          int             s,
+          sect            *bt_stack,
+          vrna_bp_stack_t *bp_stack,
+          const short     *S1)
 {
   /*------------------------------------------------------------------
    *  trace back through the "c", "f5" and "fML" arrays to get the
@@ -1090,21 +1096,21 @@ backtrack(const char  *string,
 
   length = strlen(string);
   if (s == 0) {
-    sector[++s].i = 1;
-    sector[s].j   = length;
-    sector[s].ml  = 2;
+    bt_stack[++s].i = 1;
+    bt_stack[s].j   = length;
+    bt_stack[s].ml  = 2;
   }
 
   while (s > 0) {
     int ml, cij, traced, i1, j1, /*d3, d5, mm,*/ p, q;
     int canonical = 1;     /* (i,j) closes a canonical structure */
-    i   = sector[s].i;
-    j   = sector[s].j;
-    ml  = sector[s--].ml;  /* ml is a flag indicating if backtracking is to
-                           * occur in the fML- (1) or in the f-array (0) */
+    i   = bt_stack[s].i;
+    j   = bt_stack[s].j;
+    ml  = bt_stack[s--].ml;  /* ml is a flag indicating if backtracking is to
+                             * occur in the fML- (1) or in the f-array (0) */
     if (ml == 2) {
-      base_pair[++b].i  = i;
-      base_pair[b].j    = j;
+      bp_stack[++b].i = i;
+      bp_stack[b].j   = j;
       goto repeat1;
     }
 
@@ -1132,10 +1138,10 @@ repeat1:
         /* (i.j) closes canonical structures, thus
          *  (i+1.j-1) must be a pair                */
         type_2            = ptype[indx[j - 1] + i + 1];
-        type_2            = rtype[type_2];
+        type_2            = P->model_details.rtype[type_2];
         cij               -= P->stack[type][type_2] + bonus;
-        base_pair[++b].i  = i + 1;
-        base_pair[b].j    = j - 1;
+        bp_stack[++b].i = i + 1;
+        bp_stack[b].j   = j - 1;
         i++;
         j--;
         canonical = 0;
@@ -1164,7 +1170,7 @@ repeat1:
         if (type_2 == 0)
           continue;
 
-        type_2 = rtype[type_2];
+        type_2 = P->model_details.rtype[type_2];
         if (no_closingGU)
           if (no_close || (type_2 == 3) || (type_2 == 4))
             if ((p > i + 1) || (q < j - 1))
@@ -1177,9 +1183,9 @@ repeat1:
         new     = energy + c[indx[q] + p] + bonus;
         traced  = (cij == new);
         if (traced) {
-          base_pair[++b].i  = p;
-          base_pair[b].j    = q;
-          i                 = p, j = q;
+          bp_stack[++b].i = p;
+          bp_stack[b].j   = q;
+          i               = p, j = q;
           goto repeat1;
         }
       }
@@ -1192,9 +1198,9 @@ repeat1:
     /*     mm = bonus+P->MLclosing+P->MLintern[tt]; */
     /*     d5 = P->dangle5[tt][S1[j-1]]; */
     /*     d3 = P->dangle3[tt][S1[i+1]]; */
-    i1                = i + 1;
-    j1                = j - 1;
-    sector[s + 1].ml  = sector[s + 2].ml = 1;
+    i1                  = i + 1;
+    j1                  = j - 1;
+    bt_stack[s + 1].ml  = bt_stack[s + 2].ml = 1;
 
     /*      if (k<=j-3-TURN) { */ /* found the decomposition */
     /*       sector[++s].i = i1; */
@@ -1207,7 +1213,7 @@ repeat1:
     /*  */
   }
 
-  base_pair[0].i = b;    /* save the total number of base pairs */
+  bp_stack[0].i = b;     /* save the total number of base pairs */
 }
 
 
@@ -1216,17 +1222,27 @@ snobacktrack_fold_from_pair(const char  *sequence,
                             int         i,
                             int         j)
 {
-  char *structure;
-
-  sector[1].i     = i;
-  sector[1].j     = j;
-  sector[1].ml    = 2;
-  base_pair[0].i  = 0;
-  encode_seq(sequence);
-  backtrack(sequence, 1);
-  structure = vrna_db_from_bp_stack(base_pair, strlen(sequence));
-  free(S);
-  free(S1);
+  /*
+   *  Only read from the DP arrays and take the pair type tables from the
+   *  energy parameters instead of the thread-private ones of pair_mat.h,
+   *  such that several interaction searches may backtrack the stem
+   *  structures of the same snoRNA concurrently
+   */
+  char            *structure;
+  short           *S1_local;
+  sect            bt_stack[MAXSECTORS];
+  vrna_bp_stack_t *bp_stack;
+
+  bp_stack        = (vrna_bp_stack_t *)vrna_alloc(sizeof(vrna_bp_stack_t) * (1 + strlen(sequence) / 2));
+  bt_stack[1].i   = i;
+  bt_stack[1].j   = j;
+  bt_stack[1].ml  = 2;
+  bp_stack[0].i   = 0;
+  S1_local        = encode_seq(sequence);
+  backtrack(sequence, 1, bt_stack, bp_stack, S1_local);
+  structure = vrna_db_from_bp_stack(bp_stack, strlen(sequence));
+  free(S1_local);
+  free(bp_stack);
   return structure;
 }
 
@@ -1278,27 +1294,25 @@ alisnobacktrack_fold_from_pair(const char **strings,
 /*---------------------------------------------------------------------------*/
 
 
-PRIVATE void
+PRIVATE short *
 encode_seq(const char *sequence)
 {
-  unsigned int i, l;
+  unsigned int  i, l;
+  short         *S1_enc;
+
+  l       = strlen(sequence);
+  S1_enc  = (short *)vrna_alloc(sizeof(short) * (l + 2));
 
-  l   = strlen(sequence);
-  S   = (short *)vrna_alloc(sizeof(short) * (l + 2));
-  S1  = (short *)vrna_alloc(sizeof(short) * (l + 2));
   /* S1 exists only for the special X K and I bases and energy_set!=0 */
-  S[0] = (short)l;
+  for (i = 1; i <= l; i++)
+    S1_enc[i] = P->model_details.alias[encode_char(toupper(sequence[i - 1]))];
 
-  for (i = 1; i <= l; i++) {
-    /* make numerical encoding of sequence */
-    S[i]  = (short)encode_char(toupper(sequence[i - 1]));
-    S1[i] = alias[S[i]];   /* for mismatches of nostandard bases */
-  }
   /* for circular folding add first base at position n+1 and last base at
    *    position 0 in S1        */
-  S[l + 1]  = S[1];
-  S1[l + 1] = S1[1];
-  S1[0]     = S1[l];
+  S1_enc[l + 1] = S1_enc[1];
+  S1_enc[0]     = S1_enc[l];
+
+  return S1_enc;
 }
 
 
@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <math.h>
 #include <ctype.h>
 #include <string.h>
@@ -37,8 +38,9 @@
 
 
 PRIVATE void
-encode_seqs(const char  *s1,
-            const char  *s2);
+encode_seqs(vrna_snoop_t  *snoop,
+            const char    *s1,
+            const char    *s2);
 
 
 PRIVATE short *
@@ -46,65 +48,68 @@ encode_seq(const char *seq);
 
 
 PRIVATE void
-find_max_snoop(const char *s1,
-               const char *s2,
-               const int  max,
-               const int  alignment_length,
-               const int  *position,
-               const int  delta,
-               const int  distance,
-               const int  penalty,
-               const int  threshloop,
-               const int  threshLE,
-               const int  threshRE,
-               const int  threshDE,
-               const int  threshTE,
-               const int  threshSE,
-               const int  threshD,
-               const int  half_stem,
-               const int  max_half_stem,
-               const int  min_s2,
-               const int  max_s2,
-               const int  min_s1,
-               const int  max_s1,
-               const int  min_d1,
-               const int  min_d2,
-               const char *name,
-               const int  fullStemEnergy);
+find_max_snoop(vrna_snoop_t *snoop,
+               const char   *s1,
+               const char   *s2,
+               const int    max,
+               const int    alignment_length,
+               const int    *position,
+               const int    delta,
+               const int    distance,
+               const int    penalty,
+               const int    threshloop,
+               const int    threshLE,
+               const int    threshRE,
+               const int    threshDE,
+               const int    threshTE,
+               const int    threshSE,
+               const int    threshD,
+               const int    half_stem,
+               const int    max_half_stem,
+               const int    min_s2,
+               const int    max_s2,
+               const int    min_s1,
+               const int    max_s1,
+               const int    min_d1,
+               const int    min_d2,
+               const char   *name,
+               const int    fullStemEnergy);
 
 
 PRIVATE void
-find_max_snoop_XS(const char  *s1,
-                  const char  *s2,
-                  const int   **access_s1,
-                  const int   max,
-                  const int   alignment_length,
-                  const int   *position,
-                  const int   *position_j,
-                  const int   delta,
-                  const int   distance,
-                  const int   penalty,
-                  const int   threshloop,
-                  const int   threshLE,
-                  const int   threshRE,
-                  const int   threshDE,
-                  const int   threshTE,
-                  const int   threshSE,
-                  const int   threshD,
-                  const int   half_stem,
-                  const int   max_half_stem,
-                  const int   min_s2,
-                  const int   max_s2,
-                  const int   min_s1,
-                  const int   max_s1,
-                  const int   min_d1,
-                  const int   min_d2,
-                  const char  *name,
-                  const int   fullStemEnergy);
+find_max_snoop_XS(vrna_snoop_t  *snoop,
+                  const char    *s1,
+                  const char    *s2,
+                  const int     **access_s1,
+                  const int     max,
+                  const int     alignment_length,
+                  const int     *position,
+                  const int     *position_j,
+                  const int     delta,
+                  const int     distance,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshTE,
+                  const int     threshSE,
+                  const int     threshD,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2,
+                  const char    *name,
+                  const int     fullStemEnergy);
 
 
 PRIVATE char *
-alisnoop_backtrack(int          i,
+alisnoop_backtrack(vrna_snoop_t *snoop,
+                   int          i,
                    int          j,
                    const char   **s2,
                    int          *Duplex_El,
@@ -134,53 +139,55 @@ alisnoop_backtrack(int          i,
 
 
 PRIVATE char *
-snoop_backtrack(int         i,
-                int         j,
-                const char  *s2,
-                int         *Duplex_El,
-                int         *Duplex_Er,
-                int         *Loop_E,
-                int         *Loop_D,
-                int         *u,
-                const int   penalty,
-                const int   threshloop,
-                const int   threshLE,
-                const int   threshRE,
-                const int   threshDE,
-                const int   threshD,
-                const int   half_stem,
-                const int   max_half_stem,
-                const int   min_s2,
-                const int   max_s2,
-                const int   min_s1,
-                const int   max_s1,
-                const int   min_d1,
-                const int   min_d2);
+snoop_backtrack(vrna_snoop_t  *snoop,
+                int           i,
+                int           j,
+                const char    *s2,
+                int           *Duplex_El,
+                int           *Duplex_Er,
+                int           *Loop_E,
+                int           *Loop_D,
+                int           *u,
+                const int     penalty,
+                const int     threshloop,
+                const int     threshLE,
+                const int     threshRE,
+                const int     threshDE,
+                const int     threshD,
+                const int     half_stem,
+                const int     max_half_stem,
+                const int     min_s2,
+                const int     max_s2,
+                const int     min_s1,
+                const int     max_s1,
+                const int     min_d1,
+                const int     min_d2);
 
 
 PRIVATE char *
-snoop_backtrack_XS(int        i,
-                   int        j,
-                   const char *s2,
-                   int        *Duplex_El,
-                   int        *Duplex_Er,
-                   int        *Loop_E,
-                   int        *Loop_D,
-                   int        *u,
-                   const int  penalty,
-                   const int  threshloop,
-                   const int  threshLE,
-                   const int  threshRE,
-                   const int  threshDE,
-                   const int  threshD,
-                   const int  half_stem,
-                   const int  max_half_stem,
-                   const int  min_s2,
-                   const int  max_s2,
-                   const int  min_s1,
-                   const int  max_s1,
-                   const int  min_d1,
-                   const int  min_d2);
+snoop_backtrack_XS(vrna_snoop_t *snoop,
+                   int          i,
+                   int          j,
+                   const char   *s2,
+                   int          *Duplex_El,
+                   int          *Duplex_Er,
+                   int          *Loop_E,
+                   int          *Loop_D,
+                   int          *u,
+                   const int    penalty,
+                   const int    threshloop,
+                   const int    threshLE,
+                   const int    threshRE,
+                   const int    threshDE,
+                   const int    threshD,
+                   const int    half_stem,
+                   const int    max_half_stem,
+                   const int    min_s2,
+                   const int    max_s2,
+                   const int    min_s1,
+                   const int    max_s1,
+                   const int    min_d1,
+                   const int    min_d2);
 
 
 PRIVATE int
@@ -207,60 +214,131 @@ PUBLIC int snoop_subopt_sorted = 0; /* from subopt.c, default 0 */
 #define MIN2(A, B)      ((A) < (B) ? (A) : (B))
 #define MAX2(A, B)      ((A) > (B) ? (A) : (B))
 #define ASS                1
-PRIVATE vrna_param_t  *P = NULL;
+struct vrna_snoop_s {
+  vrna_param_t  *P;
+  int           (*pair)[MAXALPHA + 1];
+  int           *rtype;
+  short         *alias;
+
+  int           **c;      /* energy array, given that i-j pair */
+  int           **r;
+  int           **lc;     /* energy array, given that i-j pair */
+  int           **lr;
+  int           **c_fill;
+  int           **r_fill;
+  int           **lpair;
+
+  short         *S1, *SS1, *S2, *SS2;
+  short         *S1_fill, *SS1_fill, *S2_fill, *SS2_fill;
+  int           n1, n2;   /* sequence lengths */
+
+  int           delay_free;
+  vrna_cstr_t   output;   /* where to report interactions, NULL for stdout */
+};
+
+extern int            cut_point;
 
-PRIVATE int           **c       = NULL; /* energy array, given that i-j pair */
-PRIVATE int           **r       = NULL;
-PRIVATE int           **lc      = NULL; /* energy array, given that i-j pair */
-PRIVATE int           **lr      = NULL;
-PRIVATE int           **c_fill  = NULL;
-PRIVATE int           **r_fill  = NULL;
-PRIVATE int           **lpair   = NULL;
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
+PRIVATE vrna_snoop_t  *backward_compat_snoop = NULL;
 
-PRIVATE short         *S1 = NULL, *SS1 = NULL, *S2 = NULL, *SS2 = NULL;
-PRIVATE short         *S1_fill = NULL, *SS1_fill = NULL, *S2_fill = NULL, *SS2_fill = NULL;
-PRIVATE int           n1, n2; /* sequence lengths */
+#ifdef _OPENMP
+
+#pragma omp threadprivate(backward_compat_snoop)
+
+#endif
+
+PRIVATE vrna_snoop_t *
+snoop_backward_compat(void);
+
+
+#endif
+
+
+PRIVATE void
+snoop_printf(vrna_snoop_t *snoop,
+             const char   *format,
+             ...);
 
-extern int            cut_point;
 
-PRIVATE int           delay_free = 0;
 /*--------------------------------------------------------------------------*/
 
-snoopT
-alisnoopfold(const char **s1,
-             const char **s2,
-             const int  penalty,
-             const int  threshloop,
-             const int  threshLE,
-             const int  threshRE,
-             const int  threshDE,
-             const int  threshD,
-             const int  half_stem,
-             const int  max_half_stem,
-             const int  min_s2,
-             const int  max_s2,
-             const int  min_s1,
-             const int  max_s1,
-             const int  min_d1,
-             const int  min_d2)
+PUBLIC vrna_snoop_t *
+vrna_snoop_init(const vrna_md_t *md_p)
 {
-  int       s, n_seq;
-  int       i, j, E, l1, Emin = INF, i_min = 0, j_min = 0;
-  char      *struc;
-  snoopT    mfe;
-  int       *indx;
-  int       *mLoop;
-  int       *cLoop;
-  folden    **foldlist;
-  folden    **foldlist_XS;
-  int       Duplex_El, Duplex_Er, pscd, psct, pscg;
-  int       Loop_D;
-  int       u;
-  int       Loop_E;
-  short     **Sali1, **Sali2;
-  int       *type, *type2, *type3;
-  vrna_md_t md;
+  vrna_md_t     md;
+  vrna_snoop_t  *snoop;
+
+  if (md_p)
+    vrna_md_copy(&md, md_p);
+  else
+    vrna_md_set_default(&md);
+
+  snoop         = (vrna_snoop_t *)vrna_alloc(sizeof(vrna_snoop_t));
+  snoop->P      = vrna_params(&md);
+  snoop->pair   = snoop->P->model_details.pair;
+  snoop->rtype  = &(snoop->P->model_details.rtype[0]);
+  snoop->alias  = &(snoop->P->model_details.alias[0]);
+
+  return snoop;
+}
+
+
+PUBLIC void
+vrna_snoop_free(vrna_snoop_t *snoop)
+{
+  if (snoop) {
+    free(snoop->P);
+    free(snoop);
+  }
+}
+
+
+PUBLIC void
+vrna_snoop_set_output(vrna_snoop_t  *snoop,
+                      vrna_cstr_t   output)
+{
+  if (snoop)
+    snoop->output = output;
+}
+
+
+/*--------------------------------------------------------------------------*/
+
+PUBLIC snoopT
+vrna_alisnoopfold(vrna_snoop_t  *snoop,
+                  const char    **s1,
+                  const char    **s2,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshD,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2)
+{
+  int     s, n_seq;
+  int     i, j, E, l1, Emin = INF, i_min = 0, j_min = 0;
+  char    *struc;
+  snoopT  mfe;
+  int     *indx;
+  int     *mLoop;
+  int     *cLoop;
+  folden  **foldlist;
+  folden  **foldlist_XS;
+  int     Duplex_El, Duplex_Er, pscd, psct, pscg;
+  int     Loop_D;
+  int     u;
+  int     Loop_E;
+  short   **Sali1, **Sali2;
+  int     *type, *type2, *type3;
 
   Duplex_El = 0;
   Duplex_Er = 0;
@@ -270,8 +348,8 @@ alisnoopfold(const char **s1,
   psct      = 0;
   pscg      = 0;
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
-  n1  = (int)strlen(s1[0]);
-  n2  = (int)strlen(s2[0]);
+  snoop->n1 = (int)strlen(s1[0]);
+  snoop->n2 = (int)strlen(s2[0]);
 
   for (s = 0; s1[s] != NULL; s++) ;
   n_seq = s;
@@ -279,33 +357,23 @@ alisnoopfold(const char **s1,
   if (n_seq != s)
     vrna_message_error("unequal number of sequences in aliduplexfold()\n");
 
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    snoupdate_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  c = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  r = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  for (i = 0; i <= n1; i++) {
-    c[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    r[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    for (j = n2; j > -1; j--) {
-      c[i][j] = INF;
-      r[i][j] = INF;
+  snoop->c  = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  snoop->r  = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  for (i = 0; i <= snoop->n1; i++) {
+    snoop->c[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->r[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    for (j = snoop->n2; j > -1; j--) {
+      snoop->c[i][j]  = INF;
+      snoop->r[i][j]  = INF;
     }
   }
   Sali1 = (short **)vrna_alloc((n_seq + 1) * sizeof(short *));
   Sali2 = (short **)vrna_alloc((n_seq + 1) * sizeof(short *));
   for (s = 0; s < n_seq; s++) {
-    if ((int)strlen(s1[s]) != n1)
+    if ((int)strlen(s1[s]) != snoop->n1)
       vrna_message_error("uneqal seqence lengths");
 
-    if ((int)strlen(s2[s]) != n2)
+    if ((int)strlen(s2[s]) != snoop->n2)
       vrna_message_error("uneqal seqence lengths");
 
     Sali1[s]  = aliencode_seq(s1[s]);
@@ -315,45 +383,45 @@ alisnoopfold(const char **s1,
   type2 = (int *)vrna_alloc(n_seq * sizeof(int));
   type3 = (int *)vrna_alloc(n_seq * sizeof(int));
   /*   encode_seqs(s1, s2); */
-  for (i = 6; i <= n1 - 5; i++) {
+  for (i = 6; i <= snoop->n1 - 5; i++) {
     int U;
     U = 0;
     for (s = 0; s < n_seq; s++)
       U += Sali1[s][i - 2];
     U = (U == (n_seq) * 4 ? 1 : 0);
-    for (j = n2 - min_d2; j > min_d1; j--) {
+    for (j = snoop->n2 - min_d2; j > min_d1; j--) {
       int type4, k, l, psc, psc2, psc3;
       for (s = 0; s < n_seq; s++)
-        type[s] = pair[Sali1[s][i]][Sali2[s][j]];
+        type[s] = snoop->pair[Sali1[s][i]][Sali2[s][j]];
       psc = covscore(type, n_seq);
       for (s = 0; s < n_seq; s++)
         if (type[s] == 0)
           type[s] = 7;
 
-      c[i][j] = (psc >= MINPSCORE) ? (n_seq * P->DuplexInit) : INF;
+      snoop->c[i][j] = (psc >= MINPSCORE) ? (n_seq * snoop->P->DuplexInit) : INF;
       if (psc < MINPSCORE)
         continue;
 
       if (/*  pair[Sali1[i+1]][Sali2[j-1]] &&  */
         U && j < max_s1 && j > min_s1 &&
-        j > n2 - max_s2 - max_half_stem &&
-        j < n2 - min_s2 - half_stem) {
+        j > snoop->n2 - max_s2 - max_half_stem &&
+        j < snoop->n2 - min_s2 - half_stem) {
         /*constraint on s2 and i*/
         folden *temp;
         temp = foldlist[j + 1];
         while (temp->next) {
           int k = temp->k;
           for (s = 0; s < n_seq; s++) {
-            type2[s]  = pair[Sali1[s][i - 3]][Sali2[s][k + 1]];
-            type3[s]  = pair[Sali1[s][i - 4]][Sali2[s][k + 1]];
+            type2[s]  = snoop->pair[Sali1[s][i - 3]][Sali2[s][k + 1]];
+            type3[s]  = snoop->pair[Sali1[s][i - 4]][Sali2[s][k + 1]];
           }
           psc2  = covscore(type2, n_seq);
           psc3  = covscore(type3, n_seq);
           if (psc2 > MINPSCORE)
-            r[i][j] = MIN2(r[i][j], c[i - 3][k + 1] + temp->energy);
+            snoop->r[i][j] = MIN2(snoop->r[i][j], snoop->c[i - 3][k + 1] + temp->energy);
 
           if (psc3 > MINPSCORE)
-            r[i][j] = MIN2(r[i][j], c[i - 4][k + 1] + temp->energy);
+            snoop->r[i][j] = MIN2(snoop->r[i][j], snoop->c[i - 4][k + 1] + temp->energy);
 
           temp = temp->next;
         }
@@ -361,9 +429,9 @@ alisnoopfold(const char **s1,
 
       /* dangle 5'SIDE relative to the mRNA  */
       for (s = 0; s < n_seq; s++)
-        c[i][j] += vrna_E_ext_stem(type[s], Sali1[s][i - 1], Sali2[s][j + 1], P);
+        snoop->c[i][j] += vrna_E_ext_stem(type[s], Sali1[s][i - 1], Sali2[s][j + 1], snoop->P);
       for (k = i - 1; k > 0 && (i - k) < MAXLOOP_L; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= snoop->n2; l++) {
           if (i - k + l - j > 2 * MAXLOOP_L - 2)
             break;
 
@@ -371,22 +439,22 @@ alisnoopfold(const char **s1,
             continue;
 
           for (E = s = 0; s < n_seq; s++) {
-            type4 = pair[Sali1[s][k]][Sali2[s][l]];
+            type4 = snoop->pair[Sali1[s][k]][Sali2[s][l]];
             if (type4 == 0)
               type4 = 7;
 
-            E += E_IntLoop(i - k - 1, l - j - 1, type4, rtype[type[s]],
-                           Sali1[s][k + 1], Sali2[s][l - 1], Sali1[s][i - 1], Sali2[s][j + 1], P);
+            E += E_IntLoop(i - k - 1, l - j - 1, type4, snoop->rtype[type[s]],
+                           Sali1[s][k + 1], Sali2[s][l - 1], Sali1[s][i - 1], Sali2[s][j + 1], snoop->P);
           }
-          c[i][j] = MIN2(c[i][j], c[k][l] + E);
-          r[i][j] = MIN2(r[i][j], r[k][l] + E);
+          snoop->c[i][j]  = MIN2(snoop->c[i][j], snoop->c[k][l] + E);
+          snoop->r[i][j]  = MIN2(snoop->r[i][j], snoop->r[k][l] + E);
         }
       }
-      c[i][j] -= psc;
-      r[i][j] -= psc;
-      E       = r[i][j];
+      snoop->c[i][j] -= psc;
+      snoop->r[i][j] -= psc;
+      E       = snoop->r[i][j];
       for (s = 0; s < n_seq; s++)
-        E += vrna_E_ext_stem(rtype[type[s]], Sali2[s][j - 1], Sali1[s][i + 1], P);
+        E += vrna_E_ext_stem(snoop->rtype[type[s]], Sali2[s][j - 1], Sali1[s][i + 1], snoop->P);
       /**
       *** if (i<n1) E += P->dangle3[rtype[type[s]]][Sali1[s][i+1]];
       *** if (j>1)  E += P->dangle5[rtype[type[s]]][Sali2[s][j-1]];
@@ -400,22 +468,22 @@ alisnoopfold(const char **s1,
     }
   }
   if (Emin > 0) {
-    printf("no target found under the constraints chosen\n");
-    for (i = 0; i <= n1; i++) {
-      free(r[i]);
-      free(c[i]);
+    snoop_printf(snoop, "no target found under the constraints chosen\n");
+    for (i = 0; i <= snoop->n1; i++) {
+      free(snoop->r[i]);
+      free(snoop->c[i]);
     }
-    free(c);
-    free(r);
+    free(snoop->c);
+    free(snoop->r);
     for (s = 0; s < n_seq; s++) {
       free(Sali1[s]);
       free(Sali2[s]);
     }
     free(Sali1);
     free(Sali2);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    free(snoop->S2);
+    free(snoop->SS1);
+    free(snoop->SS2);
     free(type);
     free(type2);
     free(type3);
@@ -424,7 +492,7 @@ alisnoopfold(const char **s1,
     return mfe;
   }
 
-  struc = alisnoop_backtrack(i_min, j_min, (const char **)s2,
+  struc = alisnoop_backtrack(snoop, i_min, j_min, (const char **)s2,
                              &Duplex_El, &Duplex_Er, &Loop_E,
                              &Loop_D, &u, &pscd, &psct, &pscg,
                              penalty, threshloop, threshLE,
@@ -457,16 +525,16 @@ alisnoopfold(const char **s1,
   free(type2);
   free(type3);
 
-  if (!delay_free) {
-    for (i = 0; i <= n1; i++) {
-      free(r[i]);
-      free(c[i]);
+  if (!snoop->delay_free) {
+    for (i = 0; i <= snoop->n1; i++) {
+      free(snoop->r[i]);
+      free(snoop->c[i]);
     }
-    free(c);
-    free(r);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    free(snoop->c);
+    free(snoop->r);
+    free(snoop->S2);
+    free(snoop->SS1);
+    free(snoop->SS2);
   }
 
   return mfe;
@@ -474,27 +542,28 @@ alisnoopfold(const char **s1,
 
 
 PUBLIC snoopT *
-alisnoop_subopt(const char  **s1,
-                const char  **s2,
-                int         delta,
-                int         w,
-                const int   penalty,
-                const int   threshloop,
-                const int   threshLE,
-                const int   threshRE,
-                const int   threshDE,
-                const int   threshTE,
-                const int   threshSE,
-                const int   threshD,
-                const int   distance,
-                const int   half_stem,
-                const int   max_half_stem,
-                const int   min_s2,
-                const int   max_s2,
-                const int   min_s1,
-                const int   max_s1,
-                const int   min_d1,
-                const int   min_d2)
+vrna_alisnoop_subopt(vrna_snoop_t *snoop,
+                     const char   **s1,
+                     const char   **s2,
+                     int          delta,
+                     int          w,
+                     const int    penalty,
+                     const int    threshloop,
+                     const int    threshLE,
+                     const int    threshRE,
+                     const int    threshDE,
+                     const int    threshTE,
+                     const int    threshSE,
+                     const int    threshD,
+                     const int    distance,
+                     const int    half_stem,
+                     const int    max_half_stem,
+                     const int    min_s2,
+                     const int    max_s2,
+                     const int    min_s1,
+                     const int    max_s1,
+                     const int    min_d1,
+                     const int    min_d2)
 {
   short   **Sali1, **Sali2;
   /* printf("%d %d\n", min_s2, max_s2); */
@@ -515,16 +584,16 @@ alisnoop_subopt(const char  **s1,
   psct      = 0;
   pscg      = 0;
   int u;
-  u           = 0;
-  n_max       = 16;
-  subopt      = (snoopT *)vrna_alloc(n_max * sizeof(snoopT));
-  delay_free  = 1;
-  mfe         = alisnoopfold(s1, s2, penalty, threshloop, threshLE, threshRE, threshDE, threshD,
-                             half_stem, max_half_stem,
-                             min_s2, max_s2, min_s1, max_s1, min_d1, min_d2);
+  u                 = 0;
+  n_max             = 16;
+  subopt            = (snoopT *)vrna_alloc(n_max * sizeof(snoopT));
+  snoop->delay_free = 1;
+  mfe               = vrna_alisnoopfold(snoop, s1, s2, penalty, threshloop, threshLE, threshRE, threshDE, threshD,
+                                        half_stem, max_half_stem,
+                                        min_s2, max_s2, min_s1, max_s1, min_d1, min_d2);
   if (mfe.energy > 0) {
     free(subopt);
-    delay_free = 0;
+    snoop->delay_free = 0;
     return NULL;
   }
 
@@ -555,7 +624,7 @@ alisnoop_subopt(const char  **s1,
     for (j = 1; j <= n2; j++) {
       int ii, jj, Ed, psc, skip;
       for (s = 0; s < n_seq; s++)
-        type[s] = pair[Sali2[s][j]][Sali1[s][i]];
+        type[s] = snoop->pair[Sali2[s][j]][Sali1[s][i]];
       psc = covscore(type, n_seq);
       for (s = 0; s < n_seq; s++)
         if (type[s] == 0)
@@ -564,12 +633,12 @@ alisnoop_subopt(const char  **s1,
       if (psc < MINPSCORE)
         continue;
 
-      E = Ed = r[i][j];
+      E = Ed = snoop->r[i][j];
       for (s = 0; s < n_seq; s++) {
         /*         if (i<n1-5) Ed += P->dangle3[type[s]][Sali1[s][i+1]]; */
         /*       if (j>6)  Ed += P->dangle5[type[s]][Sali2[s][j-1]]; */
         if (type[s] > 2)
-          Ed += P->TerminalAU;
+          Ed += snoop->P->TerminalAU;
       }
       if (Ed > thresh)
         continue;
@@ -581,7 +650,7 @@ alisnoop_subopt(const char  **s1,
       w = 1;
       for (skip = 0, ii = MAX2(i - w, 1); (ii <= MIN2(i + w, n1)) && type; ii++) {
         for (jj = MAX2(j - w, 1); jj <= MIN2(j + w, n2); jj++)
-          if (r[ii][jj] < E) {
+          if (snoop->r[ii][jj] < E) {
             skip = 1;
             break;
           }
@@ -591,7 +660,8 @@ alisnoop_subopt(const char  **s1,
 
       psct  = 0;
       pscg  = 0;
-      struc = alisnoop_backtrack(i,
+      struc = alisnoop_backtrack(snoop,
+                                 i,
                                  j,
                                  s2,
                                  &Duplex_El,
@@ -669,11 +739,11 @@ alisnoop_subopt(const char  **s1,
   }
 
   for (i = 0; i <= n1; i++) {
-    free(c[i]);
-    free(r[i]);
+    free(snoop->c[i]);
+    free(snoop->r[i]);
   }
-  free(c);
-  free(r);
+  free(snoop->c);
+  free(snoop->r);
   for (s = 0; s < n_seq; s++) {
     free(Sali1[s]);
     free(Sali2[s]);
@@ -693,7 +763,8 @@ alisnoop_subopt(const char  **s1,
 
 
 PRIVATE char *
-alisnoop_backtrack(int          i,
+alisnoop_backtrack(vrna_snoop_t *snoop,
+                   int          i,
                    int          j,
                    const char   **snoseq,
                    int          *Duplex_El,
@@ -728,8 +799,8 @@ alisnoop_backtrack(int          i,
   char  *st1, *st2, *struc;
   char  *struc_loop;
 
-  n1  = (int)Sali1[0][0];
-  n2  = (int)Sali2[0][0];
+  snoop->n1 = (int)Sali1[0][0];
+  snoop->n2 = (int)Sali2[0][0];
 
   for (s = 0; Sali1[s] != NULL; s++) ;
   n_seq = s;
@@ -737,8 +808,8 @@ alisnoop_backtrack(int          i,
   if (n_seq != s)
     vrna_message_error("unequal number of sequences in alibacktrack()\n");
 
-  st1   = (char *)vrna_alloc(sizeof(char) * (n1 + 1));
-  st2   = (char *)vrna_alloc(sizeof(char) * (n2 + 1));
+  st1   = (char *)vrna_alloc(sizeof(char) * (snoop->n1 + 1));
+  st2   = (char *)vrna_alloc(sizeof(char) * (snoop->n2 + 1));
   type  = (int *)vrna_alloc(n_seq * sizeof(int));
   type2 = (int *)vrna_alloc(n_seq * sizeof(int));
   type3 = (int *)vrna_alloc(n_seq * sizeof(int));
@@ -750,26 +821,26 @@ alisnoop_backtrack(int          i,
   i0  = i;
   j0  = j;    /* MIN2(i+1,n1); j0=MAX2(j-1,1);!modified */
   for (s = 0; s < n_seq; s++) {
-    type[s] = pair[Sali1[s][i]][Sali2[s][j]];
+    type[s] = snoop->pair[Sali1[s][i]][Sali2[s][j]];
     if (type[s] == 0)
       type[s] = 7;
 
     *Duplex_Er +=
-      vrna_E_ext_stem(rtype[type[s]], (j > 1) ? Sali2[s][j - 1] : -1, (i < n1) ? Sali1[s][i + 1] : -1, P);
+      vrna_E_ext_stem(snoop->rtype[type[s]], (j > 1) ? Sali2[s][j - 1] : -1, (i < snoop->n1) ? Sali1[s][i + 1] : -1, snoop->P);
     /**
     *** if (i<n1)   *Duplex_Er += P->dangle3[rtype[type[s]]][Sali1[s][i+1]];
     *** if (j>1)    *Duplex_Er += P->dangle5[rtype[type[s]]][Sali2[s][j-1]];
     *** if (type[s]>2) *Duplex_Er += P->TerminalAU;
     **/
   }
-  while (i > 0 && j <= n2 - min_d2) {
+  while (i > 0 && j <= snoop->n2 - min_d2) {
     if (!traced_r) {
-      E           = r[i][j];
+      E           = snoop->r[i][j];
       traced      = 0;
       st1[i - 1]  = '<';
       st2[j - 1]  = '>';
       for (s = 0; s < n_seq; s++)
-        type[s] = pair[Sali1[s][i]][Sali2[s][j]];
+        type[s] = snoop->pair[Sali1[s][i]][Sali2[s][j]];
       psc = covscore(type, n_seq);
       for (s = 0; s < n_seq; s++)
         if (type[s] == 0)
@@ -778,7 +849,7 @@ alisnoop_backtrack(int          i,
       E     += psc;
       *pscd += psc;
       for (k = i - 1; k > 0 && (i - k) < MAXLOOP_L; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= snoop->n2; l++) {
           int LE;
           if (i - k + l - j > 2 * MAXLOOP_L - 2)
             break;
@@ -787,7 +858,7 @@ alisnoop_backtrack(int          i,
             continue;
 
           for (s = LE = 0; s < n_seq; s++) {
-            type4 = pair[Sali1[s][k]][Sali2[s][l]];
+            type4 = snoop->pair[Sali1[s][k]][Sali2[s][l]];
             if (type4 == 0)
               type4 = 7;
 
@@ -795,14 +866,14 @@ alisnoop_backtrack(int          i,
               E_IntLoop(i - k - 1,
                         l - j - 1,
                         type4,
-                        rtype[type[s]],
+                        snoop->rtype[type[s]],
                         Sali1[s][k + 1],
                         Sali2[s][l - 1],
                         Sali1[s][i - 1],
                         Sali2[s][j + 1],
-                        P);
+                        snoop->P);
           }
-          if (E == r[k][l] + LE) {
+          if (E == snoop->r[k][l] + LE) {
             traced      = 1;
             i           = k;
             j           = l;
@@ -820,25 +891,25 @@ alisnoop_backtrack(int          i,
         U = (U == (n_seq) * 4 ? 1 : 0);
         if (/*  pair[Sali1[i+1]][Sali2[j-1]] && */   /* only U's are allowed */
           U && j < max_s1 && j > min_s1 &&
-          j > n2 - max_s2 - max_half_stem &&
-          j < n2 - min_s2 - half_stem) {
+          j > snoop->n2 - max_s2 - max_half_stem &&
+          j < snoop->n2 - min_s2 - half_stem) {
           int     min_k, max_k;
-          max_k = MIN2(n2 - min_s2, j + max_half_stem + 1);
-          min_k = MAX2(j + half_stem + 1, n2 - max_s2);
+          max_k = MIN2(snoop->n2 - min_s2, j + max_half_stem + 1);
+          min_k = MAX2(j + half_stem + 1, snoop->n2 - max_s2);
           folden  *temp;
           temp = foldlist[j + 1];
           while (temp->next) {
             int psc2, psc3;
             int k = temp->k;
             for (s = 0; s < n_seq; s++) {
-              type2[s]  = pair[Sali1[s][i - 3]][Sali2[s][k + 1]];
-              type3[s]  = pair[Sali1[s][i - 4]][Sali2[s][k + 1]];
+              type2[s]  = snoop->pair[Sali1[s][i - 3]][Sali2[s][k + 1]];
+              type3[s]  = snoop->pair[Sali1[s][i - 4]][Sali2[s][k + 1]];
             }
             psc2  = covscore(type2, n_seq);
             psc3  = covscore(type3, n_seq);
             if (psc2 > MINPSCORE /*&& pair[Sali1[i-4]][Sali2[k+2]]*/) {
               /* introduce structure from RNAfold */
-              if (E == c[i - 3][k + 1] + temp->energy) {
+              if (E == snoop->c[i - 3][k + 1] + temp->energy) {
                 *Loop_E     = temp->energy;
                 st1[i - 3]  = '|';
                 *u          = i - 2;
@@ -868,7 +939,7 @@ alisnoop_backtrack(int          i,
 
             if (psc3 > MINPSCORE /*&& pair[Sali1[i-5]][Sali2[k+2]]*/) {
               /* introduce structure from RNAfold */
-              if (E == c[i - 4][k + 1] + temp->energy) {
+              if (E == snoop->c[i - 4][k + 1] + temp->energy) {
                 *Loop_E     = temp->energy;
                 st1[i - 3]  = '|';
                 *u          = i - 2;
@@ -902,12 +973,12 @@ alisnoop_backtrack(int          i,
       }     /* traced? */
     }       /* traced_r? */
     else {
-      E           = c[i][j];
+      E           = snoop->c[i][j];
       traced      = 0;
       st1[i - 1]  = '<';
       st2[j - 1]  = '>';
       for (s = 0; s < n_seq; s++)
-        type[s] = pair[Sali1[s][i]][Sali2[s][j]];
+        type[s] = snoop->pair[Sali1[s][i]][Sali2[s][j]];
       psc = covscore(type, n_seq);
       for (s = 0; s < n_seq; s++)
         if (type[s] == 0)
@@ -919,7 +990,7 @@ alisnoop_backtrack(int          i,
         vrna_message_error("backtrack failed in fold duplex c");
 
       for (k = i - 1; (i - k) < MAXLOOP_L; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= snoop->n2; l++) {
           int LE;
           if (i - k + l - j > 2 * MAXLOOP_L - 2)
             break;
@@ -928,7 +999,7 @@ alisnoop_backtrack(int          i,
             continue;
 
           for (s = LE = 0; s < n_seq; s++) {
-            type4 = pair[Sali1[s][k]][Sali2[s][l]];
+            type4 = snoop->pair[Sali1[s][k]][Sali2[s][l]];
             if (type4 == 0)
               type4 = 7;
 
@@ -936,14 +1007,14 @@ alisnoop_backtrack(int          i,
               E_IntLoop(i - k - 1,
                         l - j - 1,
                         type4,
-                        rtype[type[s]],
+                        snoop->rtype[type[s]],
                         Sali1[s][k + 1],
                         Sali2[s][l - 1],
                         Sali1[s][i - 1],
                         Sali2[s][j + 1],
-                        P);
+                        snoop->P);
           }
-          if (E == c[k][l] + LE) {
+          if (E == snoop->c[k][l] + LE) {
             traced      = 1;
             i           = k;
             j           = l;
@@ -961,8 +1032,8 @@ alisnoop_backtrack(int          i,
         int correction;
         correction = vrna_E_ext_stem(type[s],
                                (i > 1) ? Sali1[s][i - 1] : -1,
-                               (j < n2) ? Sali2[s][j + 1] : -1,
-                               P);
+                               (j < snoop->n2) ? Sali2[s][j + 1] : -1,
+                               snoop->P);
         *Duplex_El  += correction;
         E           -= correction;
         /**
@@ -971,7 +1042,7 @@ alisnoop_backtrack(int          i,
         *** if (type[s]>2) {E -= P->TerminalAU;                      *Duplex_El +=P->TerminalAU;}
         **/
       }
-      if (E != n_seq * P->DuplexInit)
+      if (E != n_seq * snoop->P->DuplexInit)
         vrna_message_error("backtrack failed in fold duplex end");
       else
         break;
@@ -980,9 +1051,9 @@ alisnoop_backtrack(int          i,
   /*   if (i>1)  i--;  */
   /*   if (j<n2) j++;  */
   /* struc = (char *) vrna_alloc(i0-i+1+j-j0+1+2); */ /* declare final duplex structure */
-  struc = (char *)vrna_alloc(i0 - i + 1 + n2 - 1 + 1 + 2); /* declare final duplex structure */
+  struc = (char *)vrna_alloc(i0 - i + 1 + snoop->n2 - 1 + 1 + 2); /* declare final duplex structure */
   char *struc2;
-  struc2 = (char *)vrna_alloc(n2 + 1);
+  struc2 = (char *)vrna_alloc(snoop->n2 + 1);
   /* char * struct_const; */
   for (k = MAX2(i, 1); k <= i0; k++)
     if (!st1[k - 1])
@@ -991,7 +1062,7 @@ alisnoop_backtrack(int          i,
   /* for (k=j0; k<=j; k++) if (!st2[k-1]) st2[k-1] = struc_loop[k-1];*/ /* '.'; normal */
   /*  char * struct_const; */
   /*  struct_const = (char *) vrna_alloc(sizeof(char)*(n2+1));   */
-  for (k = 1; k <= n2; k++) {
+  for (k = 1; k <= snoop->n2; k++) {
     if (!st2[k - 1])
       st2[k - 1] = struc_loop[k - 1];   /* '.'; */
 
@@ -1007,17 +1078,17 @@ alisnoop_backtrack(int          i,
 
   /*   char duplexseq_1[j0+1]; */
   /* char duplexseq_2[n2-j+3]; */
-  if (j < n2) {
+  if (j < snoop->n2) {
     char **duplexseq_1, **duplexseq_2;
     duplexseq_1 = (char **)vrna_alloc((n_seq + 1) * sizeof(char *));
     duplexseq_2 = (char **)vrna_alloc((n_seq + 1) * sizeof(char *));
     for (s = 0; s < n_seq; s++) {
       duplexseq_1[s]  = (char *)vrna_alloc((j0) * sizeof(char));          /* modfied j0+1 */
-      duplexseq_2[s]  = (char *)vrna_alloc((n2 - j + 2) * sizeof(char));  /* modified j+3 */
+      duplexseq_2[s]  = (char *)vrna_alloc((snoop->n2 - j + 2) * sizeof(char));  /* modified j+3 */
       strncpy(duplexseq_1[s], snoseq[s], j0 - 1);                         /* modified j0 */
       strcpy(duplexseq_2[s], snoseq[s] + j);                              /* modified j-1 */
-      duplexseq_1[s][j0 - 1]      = '\0';                                 /* modified j0 */
-      duplexseq_2[s][n2 - j + 1]  = '\0';                                 /* modified j+2 */
+      duplexseq_1[s][j0 - 1]            = '\0';                                 /* modified j0 */
+      duplexseq_2[s][snoop->n2 - j + 1] = '\0';                                 /* modified j+2 */
     }
     duplexseq_1[n_seq]  = NULL;
     duplexseq_2[n_seq]  = NULL;
@@ -1062,31 +1133,32 @@ alisnoop_backtrack(int          i,
 }
 
 
-void
-Lsnoop_subopt(const char  *s1,
-              const char  *s2,
-              int         delta,
-              int         w,
-              const int   penalty,
-              const int   threshloop,
-              const int   threshLE,
-              const int   threshRE,
-              const int   threshDE,
-              const int   threshTE,
-              const int   threshSE,
-              const int   threshD,
-              const int   distance,
-              const int   half_stem,
-              const int   max_half_stem,
-              const int   min_s2,
-              const int   max_s2,
-              const int   min_s1,
-              const int   max_s1,
-              const int   min_d1,
-              const int   min_d2,
-              const int   alignment_length,
-              const char  *name,
-              const int   fullStemEnergy)
+PUBLIC void
+vrna_Lsnoop_subopt(vrna_snoop_t *snoop,
+                   const char   *s1,
+                   const char   *s2,
+                   int          delta,
+                   int          w,
+                   const int    penalty,
+                   const int    threshloop,
+                   const int    threshLE,
+                   const int    threshRE,
+                   const int    threshDE,
+                   const int    threshTE,
+                   const int    threshSE,
+                   const int    threshD,
+                   const int    distance,
+                   const int    half_stem,
+                   const int    max_half_stem,
+                   const int    min_s2,
+                   const int    max_s2,
+                   const int    min_s1,
+                   const int    max_s1,
+                   const int    min_d1,
+                   const int    min_d2,
+                   const int    alignment_length,
+                   const char   *name,
+                   const int    fullStemEnergy)
 {
   int min_colonne = INF;
   int max_pos;
@@ -1096,138 +1168,128 @@ Lsnoop_subopt(const char  *s1,
 
   /* int temp; */
   /* int nsubopt=10; */
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
-  int       *position;
-  position = (int *)vrna_alloc((n1 + 3) * sizeof(int));
+  snoop->n1 = (int)strlen(s1);
+  snoop->n2 = (int)strlen(s2);
+  int     *position;
+  position = (int *)vrna_alloc((snoop->n1 + 3) * sizeof(int));
 
 
   /* int Eminj, Emin_l; */
-  int       i, j; /* l1, Emin=INF, i_min=0, j_min=0; */
+  int     i, j; /* l1, Emin=INF, i_min=0, j_min=0; */
   /* char *struc; */
   /* snoopT mfe; */
-  int       *indx;
-  int       *mLoop;
-  int       *cLoop;
-  folden    **foldlist, **foldlist_XS;
-  int       Duplex_El, Duplex_Er;
-  int       Loop_D;
+  int     *indx;
+  int     *mLoop;
+  int     *cLoop;
+  folden  **foldlist, **foldlist_XS;
+  int     Duplex_El, Duplex_Er;
+  int     Loop_D;
   /* int u; */
-  int       Loop_E;
-  vrna_md_t md;
+  int     Loop_E;
 
   Duplex_El = 0;
   Duplex_Er = 0;
   Loop_E    = 0, Loop_D = 0;
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    snoupdate_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
 
-  lc  = (int **)vrna_alloc(sizeof(int *) * (5));
-  lr  = (int **)vrna_alloc(sizeof(int *) * (5));
+  snoop->lc = (int **)vrna_alloc(sizeof(int *) * (5));
+  snoop->lr = (int **)vrna_alloc(sizeof(int *) * (5));
   for (i = 0; i < 5; i++) {
-    lc[i] = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    lr[i] = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    for (j = n2; j > -1; j--) {
-      lc[i][j]  = INF;
-      lr[i][j]  = INF;
+    snoop->lc[i]  = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->lr[i]  = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    for (j = snoop->n2; j > -1; j--) {
+      snoop->lc[i][j] = INF;
+      snoop->lr[i][j] = INF;
     }
   }
-  encode_seqs(s1, s2);
-  for (i = 1; i <= n1; i++) {
+  encode_seqs(snoop, s1, s2);
+  for (i = 1; i <= snoop->n1; i++) {
     int idx   = i % 5;
     int idx_1 = (i - 1) % 5;
     int idx_2 = (i - 2) % 5;
     int idx_3 = (i - 3) % 5;
     int idx_4 = (i - 4) % 5;
-    for (j = n2 - min_d2; j > min_d1; j--) {
+    for (j = snoop->n2 - min_d2; j > min_d1; j--) {
       int type, type2, k;
-      type        = pair[S1[i]][S2[j]];
-      lc[idx][j]  = (type) ? P->DuplexInit + 2 * penalty : INF;
-      lr[idx][j]  = INF;
+      type              = snoop->pair[snoop->S1[i]][snoop->S2[j]];
+      snoop->lc[idx][j] = (type) ? snoop->P->DuplexInit + 2 * penalty : INF;
+      snoop->lr[idx][j] = INF;
       if (!type)
         continue;
 
       if ( /*pair[S1[i+1]][S2[j-1]]   &&  check that we have a solid base stack after the mLoop */
         j < max_s1 && j > min_s1 &&
-        j > n2 - max_s2 - max_half_stem &&
-        j < n2 - min_s2 - half_stem && S1[i - 2] == 4) {
+        j > snoop->n2 - max_s2 - max_half_stem &&
+        j < snoop->n2 - min_s2 - half_stem && snoop->S1[i - 2] == 4) {
         /*constraint on s2 and i*/
         int min_k, max_k;
-        max_k = MIN2(n2 - min_s2, j + max_half_stem + 1);
-        min_k = MAX2(j + half_stem + 1, n2 - max_s2);
+        max_k = MIN2(snoop->n2 - min_s2, j + max_half_stem + 1);
+        min_k = MAX2(j + half_stem + 1, snoop->n2 - max_s2);
         for (k = min_k; k <= max_k; k++) {
           if (mLoop[indx[k - 1] + j + 1] < 0) {
           }
 
-          if (pair[S1[i - 3]][S2[k]] /*genau zwei ungepaarte nucleotiden --NU--*/
+          if (snoop->pair[snoop->S1[i - 3]][snoop->S2[k]] /*genau zwei ungepaarte nucleotiden --NU--*/
               && mLoop[indx[k - 1] + j + 1] < threshloop)
-            lr[idx][j] = MIN2(lr[idx][j], lc[idx_3][k] + mLoop[indx[k - 1] + j + 1]);
-          else if (pair[S1[i - 4]][S2[k]] && mLoop[indx[k - 1] + j + 1] < threshloop) /*--NUN--*/
-            lr[idx][j] = MIN2(lr[idx][j], lc[idx_4][k] + mLoop[indx[k - 1] + j + 1]);
+            snoop->lr[idx][j] = MIN2(snoop->lr[idx][j], snoop->lc[idx_3][k] + mLoop[indx[k - 1] + j + 1]);
+          else if (snoop->pair[snoop->S1[i - 4]][snoop->S2[k]] && mLoop[indx[k - 1] + j + 1] < threshloop) /*--NUN--*/
+            snoop->lr[idx][j] = MIN2(snoop->lr[idx][j], snoop->lc[idx_4][k] + mLoop[indx[k - 1] + j + 1]);
         }
       }
 
       /* dangle 5'SIDE relative to the mRNA  */
-      lc[idx][j] += vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n2) ? SS2[j + 1] : -1, P);
+      snoop->lc[idx][j] += vrna_E_ext_stem(type, (i > 1) ? snoop->SS1[i - 1] : -1, (j < snoop->n2) ? snoop->SS2[j + 1] : -1, snoop->P);
       /**
       *** if (i>1)    lc[idx][j] += P->dangle5[type][SS1[i-1]];
       *** if (j<n2)   lc[idx][j] += P->dangle3[type][SS2[j+1]];
       *** if (type>2) lc[idx][j] += P->TerminalAU;
       **/
 
-      if (j < n2 && i > 1) {
-        type2 = pair[S1[i - 1]][S2[j + 1]];
+      if (j < snoop->n2 && i > 1) {
+        type2 = snoop->pair[snoop->S1[i - 1]][snoop->S2[j + 1]];
         if (type2 > 0) {
-          lc[idx][j] =
-            MIN2(lc[idx_1][j + 1] +
-                 E_IntLoop(0, 0, type2, rtype[type], SS1[i], SS2[j], SS1[i - 1], SS2[j + 1],
-                           P) + 2 * penalty,
-                 lc[idx][j]);
-          lr[idx][j] =
-            MIN2(lr[idx_1][j + 1] +
-                 E_IntLoop(0, 0, type2, rtype[type], SS1[i], SS2[j], SS1[i - 1], SS2[j + 1],
-                           P) + 2 * penalty,
-                 lr[idx][j]);
+          snoop->lc[idx][j] =
+            MIN2(snoop->lc[idx_1][j + 1] +
+                 E_IntLoop(0, 0, type2, snoop->rtype[type], snoop->SS1[i], snoop->SS2[j], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                           snoop->P) + 2 * penalty,
+                 snoop->lc[idx][j]);
+          snoop->lr[idx][j] =
+            MIN2(snoop->lr[idx_1][j + 1] +
+                 E_IntLoop(0, 0, type2, snoop->rtype[type], snoop->SS1[i], snoop->SS2[j], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                           snoop->P) + 2 * penalty,
+                 snoop->lr[idx][j]);
         }
       }
 
-      if (j < n2 - 1 && i > 2) {
-        type2 = pair[S1[i - 2]][S2[j + 2]];
+      if (j < snoop->n2 - 1 && i > 2) {
+        type2 = snoop->pair[snoop->S1[i - 2]][snoop->S2[j + 2]];
         if (type2 > 0) {
-          lc[idx][j] =
-            MIN2(lc[idx_2][j + 2] +
-                 E_IntLoop(1, 1, type2, rtype[type], SS1[i - 1], SS2[j + 1], SS1[i - 1], SS2[j + 1],
-                           P) + 4 * penalty,
-                 lc[idx][j]);
-          lr[idx][j] =
-            MIN2(lr[idx_2][j + 2] +
-                 E_IntLoop(1, 1, type2, rtype[type], SS1[i - 1], SS2[j + 1], SS1[i - 1], SS2[j + 1],
-                           P) + 4 * penalty,
-                 lr[idx][j]);
+          snoop->lc[idx][j] =
+            MIN2(snoop->lc[idx_2][j + 2] +
+                 E_IntLoop(1, 1, type2, snoop->rtype[type], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                           snoop->P) + 4 * penalty,
+                 snoop->lc[idx][j]);
+          snoop->lr[idx][j] =
+            MIN2(snoop->lr[idx_2][j + 2] +
+                 E_IntLoop(1, 1, type2, snoop->rtype[type], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                           snoop->P) + 4 * penalty,
+                 snoop->lr[idx][j]);
         }
       }
 
-      if (j < n2 - 2 && i > 3) {
-        type2 = pair[S1[i - 3]][S2[j + 3]];
+      if (j < snoop->n2 - 2 && i > 3) {
+        type2 = snoop->pair[snoop->S1[i - 3]][snoop->S2[j + 3]];
         if (type2 > 0) {
-          lc[idx][j] =
-            MIN2(lc[idx_3][j + 3] +
-                 E_IntLoop(2, 2, type2, rtype[type], SS1[i - 2], SS2[j + 2], SS1[i - 1], SS2[j + 1],
-                           P) + 6 * penalty,
-                 lc[idx][j]);
-          lr[idx][j] =
-            MIN2(lr[idx_3][j + 3] +
-                 E_IntLoop(2, 2, type2, rtype[type], SS1[i - 2], SS2[j + 2], SS1[i - 1], SS2[j + 1],
-                           P) + 6 * penalty,
-                 lr[idx][j]);
+          snoop->lc[idx][j] =
+            MIN2(snoop->lc[idx_3][j + 3] +
+                 E_IntLoop(2, 2, type2, snoop->rtype[type], snoop->SS1[i - 2], snoop->SS2[j + 2], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                           snoop->P) + 6 * penalty,
+                 snoop->lc[idx][j]);
+          snoop->lr[idx][j] =
+            MIN2(snoop->lr[idx_3][j + 3] +
+                 E_IntLoop(2, 2, type2, snoop->rtype[type], snoop->SS1[i - 2], snoop->SS2[j + 2], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                           snoop->P) + 6 * penalty,
+                 snoop->lr[idx][j]);
         }
       }
 
@@ -1235,8 +1297,8 @@ Lsnoop_subopt(const char  *s1,
       *** (type>2?P->TerminalAU:0)+(i<(n1)?P->dangle3[rtype[type]][SS1[i+1]]+penalty:0)+(j>1?P->dangle5[rtype[type]][SS2[j-1]]+penalty:0)
       **/
       min_colonne =
-        MIN2(lr[idx][j] +
-             vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P),
+        MIN2(snoop->lr[idx][j] +
+             vrna_E_ext_stem(snoop->rtype[type], (j > 1) ? snoop->SS2[j - 1] : -1, (i < snoop->n1) ? snoop->SS1[i + 1] : -1, snoop->P),
              min_colonne);
     }
     position[i] = min_colonne;
@@ -1248,12 +1310,13 @@ Lsnoop_subopt(const char  *s1,
     min_colonne = INF;
   }
 
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  free(snoop->S1);
+  free(snoop->S2);
+  free(snoop->SS1);
+  free(snoop->SS2);
   if (max < threshTE) {
-    find_max_snoop(s1,
+    find_max_snoop(snoop,
+                   s1,
                    s2,
                    max,
                    alignment_length,
@@ -1281,42 +1344,43 @@ Lsnoop_subopt(const char  *s1,
   }
 
   for (i = 1; i < 5; i++) {
-    free(lc[i]);
-    free(lr[i]);
+    free(snoop->lc[i]);
+    free(snoop->lr[i]);
   }
-  free(lc[0]);
-  free(lr[0]);
-  free(lc);
-  free(lr);
+  free(snoop->lc[0]);
+  free(snoop->lr[0]);
+  free(snoop->lc);
+  free(snoop->lr);
   free(position);
 }
 
 
-void
-Lsnoop_subopt_list(const char *s1,
-                   const char *s2,
-                   int        delta,
-                   int        w,
-                   const int  penalty,
-                   const int  threshloop,
-                   const int  threshLE,
-                   const int  threshRE,
-                   const int  threshDE,
-                   const int  threshTE,
-                   const int  threshSE,
-                   const int  threshD,
-                   const int  distance,
-                   const int  half_stem,
-                   const int  max_half_stem,
-                   const int  min_s2,
-                   const int  max_s2,
-                   const int  min_s1,
-                   const int  max_s1,
-                   const int  min_d1,
-                   const int  min_d2,
-                   const int  alignment_length,
-                   const char *name,
-                   const int  fullStemEnergy)
+PUBLIC void
+vrna_Lsnoop_subopt_list(vrna_snoop_t  *snoop,
+                        const char    *s1,
+                        const char    *s2,
+                        int           delta,
+                        int           w,
+                        const int     penalty,
+                        const int     threshloop,
+                        const int     threshLE,
+                        const int     threshRE,
+                        const int     threshDE,
+                        const int     threshTE,
+                        const int     threshSE,
+                        const int     threshD,
+                        const int     distance,
+                        const int     half_stem,
+                        const int     max_half_stem,
+                        const int     min_s2,
+                        const int     max_s2,
+                        const int     min_s1,
+                        const int     max_s1,
+                        const int     min_d1,
+                        const int     min_d2,
+                        const int     alignment_length,
+                        const char    *name,
+                        const int     fullStemEnergy)
 {
   int min_colonne = INF;
   int max_pos;
@@ -1326,58 +1390,47 @@ Lsnoop_subopt_list(const char *s1,
 
   /* int temp; */
   /* int nsubopt=10; */
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
-  int       *position;
-  position = (int *)vrna_alloc((n1 + 3) * sizeof(int));
+  snoop->n1 = (int)strlen(s1);
+  snoop->n2 = (int)strlen(s2);
+  int     *position;
+  position = (int *)vrna_alloc((snoop->n1 + 3) * sizeof(int));
 
 
   /* int Eminj, Emin_l; */
-  int       i, j;/*  l1, Emin=INF, i_min=0, j_min=0; */
+  int     i, j;/*  l1, Emin=INF, i_min=0, j_min=0; */
   /* char *struc; */
   /* snoopT mfe; */
-  int       *indx;
-  int       *mLoop;
-  int       *cLoop;
-  folden    **foldlist, **foldlist_XS;
-  int       Duplex_El, Duplex_Er;
-  int       Loop_D;
+  int     *indx;
+  int     *mLoop;
+  int     *cLoop;
+  folden  **foldlist, **foldlist_XS;
+  int     Duplex_El, Duplex_Er;
+  int     Loop_D;
   /* int u; */
-  int       Loop_E;
-  vrna_md_t md;
+  int     Loop_E;
 
   Duplex_El = 0;
   Duplex_Er = 0;
   Loop_E    = 0, Loop_D = 0;
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
 
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    snoupdate_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  lpair = (int **)vrna_alloc(sizeof(int *) * (6));
-  lc    = (int **)vrna_alloc(sizeof(int *) * (6));
-  lr    = (int **)vrna_alloc(sizeof(int *) * (6));
+  snoop->lpair  = (int **)vrna_alloc(sizeof(int *) * (6));
+  snoop->lc     = (int **)vrna_alloc(sizeof(int *) * (6));
+  snoop->lr     = (int **)vrna_alloc(sizeof(int *) * (6));
   for (i = 0; i < 6; i++) {
-    lc[i]     = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    lr[i]     = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    lpair[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    for (j = n2; j > -1; j--) {
-      lc[i][j]    = INF;
-      lr[i][j]    = INF;
-      lpair[i][j] = 0;
+    snoop->lc[i]    = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->lr[i]    = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->lpair[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    for (j = snoop->n2; j > -1; j--) {
+      snoop->lc[i][j]     = INF;
+      snoop->lr[i][j]     = INF;
+      snoop->lpair[i][j]  = 0;
     }
   }
-  encode_seqs(s1, s2);
-  int lim_maxj  = n2 - min_d2;
+  encode_seqs(snoop, s1, s2);
+  int lim_maxj  = snoop->n2 - min_d2;
   int lim_minj  = min_d1;
-  int lim_maxi  = n1;
+  int lim_maxi  = snoop->n1;
   for (i = 5; i <= lim_maxi; i++) {
     int idx   = i % 5;
     int idx_1 = (i - 1) % 5;
@@ -1387,31 +1440,31 @@ Lsnoop_subopt_list(const char *s1,
 
     for (j = lim_maxj; j > lim_minj; j--) {
       int type, type2;/*  E, k,l; */
-      type          = pair[S1[i]][S2[j]];
-      lpair[idx][j] = type;
-      lc[idx][j]    = (type) ? P->DuplexInit + 2 * penalty : INF;
-      lr[idx][j]    = INF;
+      type                  = snoop->pair[snoop->S1[i]][snoop->S2[j]];
+      snoop->lpair[idx][j]  = type;
+      snoop->lc[idx][j]     = (type) ? snoop->P->DuplexInit + 2 * penalty : INF;
+      snoop->lr[idx][j]     = INF;
       if (!type)
         continue;
 
       if ( /*pair[S1[i+1]][S2[j-1]] && Be sure it binds*/
         j < max_s1 && j > min_s1 &&
-        j > n2 - max_s2 - max_half_stem &&
-        j < n2 - min_s2 - half_stem && S1[i - 2] == 4) {
+        j > snoop->n2 - max_s2 - max_half_stem &&
+        j < snoop->n2 - min_s2 - half_stem && snoop->S1[i - 2] == 4) {
         /*constraint on s2 and i*/
         int     min_k, max_k;
-        max_k = MIN2(n2 - min_s2, j + max_half_stem + 1);
-        min_k = MAX2(j + half_stem + 1, n2 - max_s2);
+        max_k = MIN2(snoop->n2 - min_s2, j + max_half_stem + 1);
+        min_k = MAX2(j + half_stem + 1, snoop->n2 - max_s2);
         folden  *temp;
         temp = foldlist[j + 1];
         while (temp->next) {
           int k = temp->k;
           /* if(k >= min_k-1 && k < max_k){ comment to recover normal behaviour */
-          if (lpair[idx_3][k + 1] /*&& lpair[idx_4][k+2]*/)
-            lr[idx][j] = MIN2(lr[idx][j], lc[idx_3][k + 1] + temp->energy);   /*--NU--*/
+          if (snoop->lpair[idx_3][k + 1] /*&& lpair[idx_4][k+2]*/)
+            snoop->lr[idx][j] = MIN2(snoop->lr[idx][j], snoop->lc[idx_3][k + 1] + temp->energy);   /*--NU--*/
 
-          /*else*/ if (lpair[idx_4][k + 1])                                   /*--NUN--*/
-            lr[idx][j] = MIN2(lr[idx][j], lc[idx_4][k + 1] + temp->energy);
+          /*else*/ if (snoop->lpair[idx_4][k + 1])                                   /*--NUN--*/
+            snoop->lr[idx][j] = MIN2(snoop->lr[idx][j], snoop->lc[idx_4][k + 1] + temp->energy);
 
           /*  } */
           temp = temp->next;
@@ -1419,7 +1472,7 @@ Lsnoop_subopt_list(const char *s1,
       }
 
       /* dangle 5'SIDE relative to the mRNA  */
-      lc[idx][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
+      snoop->lc[idx][j] += vrna_E_ext_stem(type, snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
       /**
       ***      lc[idx][j] += P->dangle5[type][SS1[i-1]];
       ***      lc[idx][j] += P->dangle3[type][SS2[j+1]];
@@ -1427,58 +1480,58 @@ Lsnoop_subopt_list(const char *s1,
       **/
       /*       if(j<n2 && i>1){ */
       /* type2=pair[S1[i-1]][S2[j+1]]; */
-      type2 = lpair[idx_1][j + 1];
+      type2 = snoop->lpair[idx_1][j + 1];
       if (type2 > 0) {
-        lc[idx][j] =
-          MIN2(lc[idx_1][j + 1] +
-               E_IntLoop(0, 0, type2, rtype[type], SS1[i], SS2[j], SS1[i - 1], SS2[j + 1],
-                         P) + 2 * penalty,
-               lc[idx][j]);
-        lr[idx][j] =
-          MIN2(lr[idx_1][j + 1] +
-               E_IntLoop(0, 0, type2, rtype[type], SS1[i], SS2[j], SS1[i - 1], SS2[j + 1],
-                         P) + 2 * penalty,
-               lr[idx][j]);
+        snoop->lc[idx][j] =
+          MIN2(snoop->lc[idx_1][j + 1] +
+               E_IntLoop(0, 0, type2, snoop->rtype[type], snoop->SS1[i], snoop->SS2[j], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + 2 * penalty,
+               snoop->lc[idx][j]);
+        snoop->lr[idx][j] =
+          MIN2(snoop->lr[idx_1][j + 1] +
+               E_IntLoop(0, 0, type2, snoop->rtype[type], snoop->SS1[i], snoop->SS2[j], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + 2 * penalty,
+               snoop->lr[idx][j]);
       }
 
       /* } */
       /*       if(j<n2-1 && i>2){ */
       /* type2=pair[S1[i-2]][S2[j+2]]; */
-      type2 = lpair[idx_2][j + 2];
+      type2 = snoop->lpair[idx_2][j + 2];
       if (type2 > 0) {
-        lc[idx][j] =
-          MIN2(lc[idx_2][j + 2] +
-               E_IntLoop(1, 1, type2, rtype[type], SS1[i - 1], SS2[j + 1], SS1[i - 1], SS2[j + 1],
-                         P),
-               lc[idx][j]);
-        lr[idx][j] =
-          MIN2(lr[idx_2][j + 2] +
-               E_IntLoop(1, 1, type2, rtype[type], SS1[i - 1], SS2[j + 1], SS1[i - 1], SS2[j + 1],
-                         P),
-               lr[idx][j]);
+        snoop->lc[idx][j] =
+          MIN2(snoop->lc[idx_2][j + 2] +
+               E_IntLoop(1, 1, type2, snoop->rtype[type], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P),
+               snoop->lc[idx][j]);
+        snoop->lr[idx][j] =
+          MIN2(snoop->lr[idx_2][j + 2] +
+               E_IntLoop(1, 1, type2, snoop->rtype[type], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P),
+               snoop->lr[idx][j]);
         /*         } */
       }
 
       /*       if(j<n2-2 && i>3){ */
       /* type2 = pair[S1[i-3]][S2[j+3]]; */
-      type2 = lpair[idx_3][j + 3];
+      type2 = snoop->lpair[idx_3][j + 3];
       if (type2 > 0) {
-        lc[idx][j] =
-          MIN2(lc[idx_3][j + 3] +
-               E_IntLoop(2, 2, type2, rtype[type], SS1[i - 2], SS2[j + 2], SS1[i - 1], SS2[j + 1],
-                         P) + 6 * penalty,
-               lc[idx][j]);
-        lr[idx][j] =
-          MIN2(lr[idx_3][j + 3] +
-               E_IntLoop(2, 2, type2, rtype[type], SS1[i - 2], SS2[j + 2], SS1[i - 1], SS2[j + 1],
-                         P) + 6 * penalty,
-               lr[idx][j]);
+        snoop->lc[idx][j] =
+          MIN2(snoop->lc[idx_3][j + 3] +
+               E_IntLoop(2, 2, type2, snoop->rtype[type], snoop->SS1[i - 2], snoop->SS2[j + 2], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + 6 * penalty,
+               snoop->lc[idx][j]);
+        snoop->lr[idx][j] =
+          MIN2(snoop->lr[idx_3][j + 3] +
+               E_IntLoop(2, 2, type2, snoop->rtype[type], snoop->SS1[i - 2], snoop->SS2[j + 2], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + 6 * penalty,
+               snoop->lr[idx][j]);
         /*         } */
       }
 
       /* min_colonne=MIN2(lr[idx][j]+(type>2?P->TerminalAU:0)+P->dangle3[rtype[type]][SS1[i+1]]+P->dangle5[rtype[type]][SS2[j-1]], min_colonne); */
       int bla;
-      bla         = lr[idx][j] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P) + 2 * penalty;
+      bla         = snoop->lr[idx][j] + vrna_E_ext_stem(snoop->rtype[type], snoop->SS2[j - 1], snoop->SS1[i + 1], snoop->P) + 2 * penalty;
       min_colonne = MIN2(bla, min_colonne);
     }
     position[i] = min_colonne;
@@ -1490,12 +1543,13 @@ Lsnoop_subopt_list(const char *s1,
     min_colonne = INF;
   }
 
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  free(snoop->S1);
+  free(snoop->S2);
+  free(snoop->SS1);
+  free(snoop->SS2);
   if (max < threshTE) {
-    find_max_snoop(s1,
+    find_max_snoop(snoop,
+                   s1,
                    s2,
                    max,
                    alignment_length,
@@ -1523,49 +1577,50 @@ Lsnoop_subopt_list(const char *s1,
   }
 
   for (i = 1; i < 6; i++) {
-    free(lc[i]);
-    free(lr[i]);
-    free(lpair[i]);
+    free(snoop->lc[i]);
+    free(snoop->lr[i]);
+    free(snoop->lpair[i]);
   }
-  free(lc[0]);
-  free(lr[0]);
-  free(lpair[0]);
-  free(lc);
-  free(lr);
-  free(lpair);
+  free(snoop->lc[0]);
+  free(snoop->lr[0]);
+  free(snoop->lpair[0]);
+  free(snoop->lc);
+  free(snoop->lr);
+  free(snoop->lpair);
   free(position);
 }
 
 
 PRIVATE void
-find_max_snoop(const char *s1,
-               const char *s2,
-               const int  max,
-               const int  alignment_length,
-               const int  *position,
-               const int  delta,
-               const int  distance,
-               const int  penalty,
-               const int  threshloop,
-               const int  threshLE,
-               const int  threshRE,
-               const int  threshDE,
-               const int  threshTE,
-               const int  threshSE,
-               const int  threshD,
-               const int  half_stem,
-               const int  max_half_stem,
-               const int  min_s2,
-               const int  max_s2,
-               const int  min_s1,
-               const int  max_s1,
-               const int  min_d1,
-               const int  min_d2,
-               const char *name,
-               const int  fullStemEnergy)
+find_max_snoop(vrna_snoop_t *snoop,
+               const char   *s1,
+               const char   *s2,
+               const int    max,
+               const int    alignment_length,
+               const int    *position,
+               const int    delta,
+               const int    distance,
+               const int    penalty,
+               const int    threshloop,
+               const int    threshLE,
+               const int    threshRE,
+               const int    threshDE,
+               const int    threshTE,
+               const int    threshSE,
+               const int    threshD,
+               const int    half_stem,
+               const int    max_half_stem,
+               const int    min_s2,
+               const int    max_s2,
+               const int    min_s1,
+               const int    max_s1,
+               const int    min_d1,
+               const int    min_d2,
+               const char   *name,
+               const int    fullStemEnergy)
 {
   int count     = 0;
-  int pos       = n1 + 1;
+  int pos       = snoop->n1 + 1;
   int threshold = MIN2(threshTE, max + delta);
 
   /* printf("threshTE %d max %d\n", threshTE, max); */
@@ -1588,23 +1643,24 @@ find_max_snoop(const char *s1,
       strcat(s3, "NNNNN\0");
       /* printf("%s s3\n", s3);  */
       snoopT  test;
-      test = snoopfold(s3,
-                       s2,
-                       penalty,
-                       threshloop,
-                       threshLE,
-                       threshRE,
-                       threshDE,
-                       threshD,
-                       half_stem,
-                       max_half_stem,
-                       min_s2,
-                       max_s2,
-                       min_s1,
-                       max_s1,
-                       min_d1,
-                       min_d2,
-                       fullStemEnergy);
+      test = vrna_snoopfold(snoop,
+                            s3,
+                            s2,
+                            penalty,
+                            threshloop,
+                            threshLE,
+                            threshRE,
+                            threshDE,
+                            threshD,
+                            half_stem,
+                            max_half_stem,
+                            min_s2,
+                            max_s2,
+                            min_s1,
+                            max_s1,
+                            min_d1,
+                            min_d2,
+                            fullStemEnergy);
       if (test.energy == INF) {
         free(s3);
         continue;
@@ -1648,7 +1704,7 @@ find_max_snoop(const char *s1,
       s4 = (char *)vrna_alloc(sizeof(char) * (strlen(s2) - 9));
       strncpy(s4, s2 + 5, (int)strlen(s2) - 10);
       s4[(int)strlen(s2) - 10] = '\0';
-      printf(
+      snoop_printf(snoop,
         "%s %3d,%-3d;%3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f + %5.2f + 4.1 ) (%5.2f) \n%s&%s\n",
         target_struct,
         begin + test.i - 5 - l1,
@@ -1668,19 +1724,19 @@ find_max_snoop(const char *s1,
         char  *temp_seq;
         char  *temp_struc;
         char  *psoutput;
-        temp_seq    = (char *)vrna_alloc(sizeof(char) * (l1 + n2 - 9));
-        temp_struc  = (char *)vrna_alloc(sizeof(char) * (l1 + n2 - 9));
+        temp_seq    = (char *)vrna_alloc(sizeof(char) * (l1 + snoop->n2 - 9));
+        temp_struc  = (char *)vrna_alloc(sizeof(char) * (l1 + snoop->n2 - 9));
         strcpy(temp_seq, target);
         strcat(temp_seq, s4);
         strncpy(temp_struc, target_struct, l1);
         strcat(temp_struc, target_struct + l1 + 1);
-        temp_seq[n2 + l1 - 10]    = '\0';
-        temp_struc[n2 + l1 - 10]  = '\0';
-        cut_point                 = l1 + 1;
-        psoutput                  = vrna_strdup_printf("sno_%d_u_%d_%s.ps",
-                                                       count,
-                                                       begin + test.u - 6,
-                                                       name);
+        temp_seq[snoop->n2 + l1 - 10]   = '\0';
+        temp_struc[snoop->n2 + l1 - 10] = '\0';
+        cut_point                       = l1 + 1;
+        psoutput                        = vrna_strdup_printf("sno_%d_u_%d_%s.ps",
+                                                             count,
+                                                             begin + test.u - 6,
+                                                             name);
 
         PS_rna_plot_snoop_a(temp_seq, temp_struc, psoutput, NULL, NULL);
         cut_point = -1;
@@ -1701,93 +1757,83 @@ find_max_snoop(const char *s1,
 }
 
 
-snoopT
-snoopfold(const char  *s1,
-          const char  *s2,
-          const int   penalty,
-          const int   threshloop,
-          const int   threshLE,
-          const int   threshRE,
-          const int   threshDE,
-          const int   threshD,
-          const int   half_stem,
-          const int   max_half_stem,
-          const int   min_s2,
-          const int   max_s2,
-          const int   min_s1,
-          const int   max_s1,
-          const int   min_d1,
-          const int   min_d2,
-          const int   fullStemEnergy)
+PUBLIC snoopT
+vrna_snoopfold(vrna_snoop_t *snoop,
+               const char   *s1,
+               const char   *s2,
+               const int    penalty,
+               const int    threshloop,
+               const int    threshLE,
+               const int    threshRE,
+               const int    threshDE,
+               const int    threshD,
+               const int    half_stem,
+               const int    max_half_stem,
+               const int    min_s2,
+               const int    max_s2,
+               const int    min_s1,
+               const int    max_s1,
+               const int    min_d1,
+               const int    min_d2,
+               const int    fullStemEnergy)
 {
   /* int Eminj, Emin_l; */
-  int       i, j, l1, Emin = INF, i_min = 0, j_min = 0;
-  char      *struc;
-  snoopT    mfe;
-  int       *indx;
-  int       *mLoop;
-  int       *cLoop;
-  folden    **foldlist, **foldlist_XS;
-  int       Duplex_El, Duplex_Er;
-  int       Loop_D;
-  int       u;
-  int       Loop_E;
-  vrna_md_t md;
-
+  int     i, j, l1, Emin = INF, i_min = 0, j_min = 0;
+  char    *struc;
+  snoopT  mfe;
+  int     *indx;
+  int     *mLoop;
+  int     *cLoop;
+  folden  **foldlist, **foldlist_XS;
+  int     Duplex_El, Duplex_Er;
+  int     Loop_D;
+  int     u;
+  int     Loop_E;
+
   Duplex_El = 0;
   Duplex_Er = 0;
   Loop_E    = 0, Loop_D = 0;
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
-
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    snoupdate_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  c = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  r = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  for (i = 0; i <= n1; i++) {
-    c[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    r[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    for (j = n2; j > -1; j--) {
-      c[i][j] = INF;
-      r[i][j] = INF;
+  snoop->n1 = (int)strlen(s1);
+  snoop->n2 = (int)strlen(s2);
+
+  snoop->c  = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  snoop->r  = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  for (i = 0; i <= snoop->n1; i++) {
+    snoop->c[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->r[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    for (j = snoop->n2; j > -1; j--) {
+      snoop->c[i][j]  = INF;
+      snoop->r[i][j]  = INF;
     }
   }
-  encode_seqs(s1, s2);
-  for (i = 6; i <= n1 - 5; i++) {
-    for (j = n2 - min_d2; j > min_d1; j--) {
+  encode_seqs(snoop, s1, s2);
+  for (i = 6; i <= snoop->n1 - 5; i++) {
+    for (j = snoop->n2 - min_d2; j > min_d1; j--) {
       int type, type2, E, k, l;
-      type    = pair[S1[i]][S2[j]];
-      c[i][j] = (type) ? P->DuplexInit : INF;
+      type            = snoop->pair[snoop->S1[i]][snoop->S2[j]];
+      snoop->c[i][j]  = (type) ? snoop->P->DuplexInit : INF;
       if (!type)
         continue;
 
       if (/*  pair[S1[i+1]][S2[j-1]] &&  */
         j < max_s1 && j > min_s1 &&
-        j > n2 - max_s2 - max_half_stem &&
-        j < n2 - min_s2 - half_stem && S1[i - 2] == 4) {
+        j > snoop->n2 - max_s2 - max_half_stem &&
+        j < snoop->n2 - min_s2 - half_stem && snoop->S1[i - 2] == 4) {
         /*constraint on s2 and i*/
         int     min_k, max_k;
-        max_k = MIN2(n2 - min_s2, j + max_half_stem);
-        min_k = MAX2(j + half_stem, n2 - max_s2);
+        max_k = MIN2(snoop->n2 - min_s2, j + max_half_stem);
+        min_k = MAX2(j + half_stem, snoop->n2 - max_s2);
         folden  *temp;
         temp = foldlist[j + 1];
         while (temp->next) {
           int k = temp->k;
           /* if(k >= min_k-1 && k < max_k){ uncomment to recovernormal behaviour */
-          if (pair[S1[i - 3]][S2[k + 1]] /*&& pair[S1[i-4]][S2[k+2]]*/)
-            r[i][j] = MIN2(r[i][j], c[i - 3][k + 1] + temp->energy);
+          if (snoop->pair[snoop->S1[i - 3]][snoop->S2[k + 1]] /*&& pair[S1[i-4]][S2[k+2]]*/)
+            snoop->r[i][j] = MIN2(snoop->r[i][j], snoop->c[i - 3][k + 1] + temp->energy);
 
-          /*else*/ if (pair[S1[i - 4]][S2[k + 1]] /*&& pair[S1[i-5]][S2[k+2]]*/)
-            r[i][j] = MIN2(r[i][j], c[i - 4][k + 1] + temp->energy);
+          /*else*/ if (snoop->pair[snoop->S1[i - 4]][snoop->S2[k + 1]] /*&& pair[S1[i-5]][S2[k+2]]*/)
+            snoop->r[i][j] = MIN2(snoop->r[i][j], snoop->c[i - 4][k + 1] + temp->energy);
 
           /* } */
           temp = temp->next;
@@ -1800,32 +1846,32 @@ snoopfold(const char  *s1,
       *** c[i][j] += P->dangle3[type][SS2[j+1]];
       *** if (type>2) c[i][j] += P->TerminalAU;
       **/
-      c[i][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
+      snoop->c[i][j] += vrna_E_ext_stem(type, snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
       for (k = i - 1; k > 0 && (i - k) < MAXLOOP_L; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= snoop->n2; l++) {
           if (i - k + l - j > 2 * MAXLOOP_L - 2)
             break;
 
           if (abs(i - k - l + j) >= ASS)
             continue;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = snoop->pair[snoop->S1[k]][snoop->S2[l]];
           if (!type2)
             continue;
 
-          E = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                        SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
-          c[i][j] = MIN2(c[i][j], c[k][l] + E + (i - k + l - j) * penalty);
-          r[i][j] = MIN2(r[i][j], r[k][l] + E + (i - k + l - j) * penalty);
+          E = E_IntLoop(i - k - 1, l - j - 1, type2, snoop->rtype[type],
+                        snoop->SS1[k + 1], snoop->SS2[l - 1], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
+          snoop->c[i][j]  = MIN2(snoop->c[i][j], snoop->c[k][l] + E + (i - k + l - j) * penalty);
+          snoop->r[i][j]  = MIN2(snoop->r[i][j], snoop->r[k][l] + E + (i - k + l - j) * penalty);
         }
       }
-      E = r[i][j];
+      E = snoop->r[i][j];
       /**
       *** if (i<n1) E += P->dangle3[rtype[type]][SS1[i+1]];
       *** if (j>1)  E += P->dangle5[rtype[type]][SS2[j-1]];
       *** f (type>2) E += P->TerminalAU;
       **/
-      E += vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
+      E += vrna_E_ext_stem(snoop->rtype[type], (j > 1) ? snoop->SS2[j - 1] : -1, (i < snoop->n1) ? snoop->SS1[i + 1] : -1, snoop->P);
       if (E < Emin) {
         Emin  = E;
         i_min = i;
@@ -1834,22 +1880,22 @@ snoopfold(const char  *s1,
     }
   }
   if (Emin > 0) {
-    printf("no target found under the constraints chosen\n");
-    for (i = 0; i <= n1; i++) {
-      free(r[i]);
-      free(c[i]);
+    snoop_printf(snoop, "no target found under the constraints chosen\n");
+    for (i = 0; i <= snoop->n1; i++) {
+      free(snoop->r[i]);
+      free(snoop->c[i]);
     }
-    free(c);
-    free(r);
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    free(snoop->c);
+    free(snoop->r);
+    free(snoop->S1);
+    free(snoop->S2);
+    free(snoop->SS1);
+    free(snoop->SS2);
     mfe.energy = INF;
     return mfe;
   }
 
-  struc = snoop_backtrack(i_min, j_min, s2, &Duplex_El, &Duplex_Er, &Loop_E, &Loop_D,
+  struc = snoop_backtrack(snoop, i_min, j_min, s2, &Duplex_El, &Duplex_Er, &Loop_E, &Loop_D,
                           &u, penalty, threshloop, threshLE, threshRE, threshDE, threshD,
                           half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2);
   /*   if (i_min<n1-5) i_min++; */
@@ -1865,17 +1911,17 @@ snoopfold(const char  *s1,
   mfe.energy          = (float)Emin / 100;
   mfe.fullStemEnergy  = (float)fullStemEnergy / 100;
   mfe.structure       = struc;
-  if (!delay_free) {
-    for (i = 0; i <= n1; i++) {
-      free(r[i]);
-      free(c[i]);
+  if (!snoop->delay_free) {
+    for (i = 0; i <= snoop->n1; i++) {
+      free(snoop->r[i]);
+      free(snoop->c[i]);
     }
-    free(c);
-    free(r);
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    free(snoop->c);
+    free(snoop->r);
+    free(snoop->S1);
+    free(snoop->S2);
+    free(snoop->SS1);
+    free(snoop->SS2);
   }
 
   return mfe;
@@ -1883,70 +1929,60 @@ snoopfold(const char  *s1,
 
 
 PRIVATE int
-snoopfold_XS_fill(const char  *s1,
-                  const char  *s2,
-                  const int   **access_s1,
-                  const int   penalty,
-                  const int   threshloop,
-                  const int   threshLE,
-                  const int   threshRE,
-                  const int   threshDE,
-                  const int   threshD,
-                  const int   half_stem,
-                  const int   max_half_stem,
-                  const int   min_s2,
-                  const int   max_s2,
-                  const int   min_s1,
-                  const int   max_s1,
-                  const int   min_d1,
-                  const int   min_d2)
+snoopfold_XS_fill(vrna_snoop_t  *snoop,
+                  const char    *s1,
+                  const char    *s2,
+                  const int     **access_s1,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshD,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2)
 {
   /* int Eminj, Emin_l; */
-  int       i, j, Emin = INF, i_min = 0, j_min = 0;
+  int     i, j, Emin = INF, i_min = 0, j_min = 0;
   /* char *struc; */
   /* snoopT mfe; */
-  int       *indx;
-  int       *mLoop;
-  int       *cLoop;
-  folden    **foldlist, **foldlist_XS;
-  int       Duplex_El, Duplex_Er;
-  int       Loop_D;
+  int     *indx;
+  int     *mLoop;
+  int     *cLoop;
+  folden  **foldlist, **foldlist_XS;
+  int     Duplex_El, Duplex_Er;
+  int     Loop_D;
   /* int u; */
-  int       Loop_E;
-  vrna_md_t md;
+  int     Loop_E;
 
   Duplex_El = 0;
   Duplex_Er = 0;
   Loop_E    = 0, Loop_D = 0;
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
-
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    snoupdate_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  c_fill  = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  r_fill  = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  for (i = 0; i <= n1; i++) {
-    c_fill[i] = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    r_fill[i] = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    for (j = n2; j > -1; j--) {
-      c_fill[i][j]  = INF;
-      r_fill[i][j]  = INF;
+  snoop->n1 = (int)strlen(s1);
+  snoop->n2 = (int)strlen(s2);
+
+  snoop->c_fill = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  snoop->r_fill = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  for (i = 0; i <= snoop->n1; i++) {
+    snoop->c_fill[i]  = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->r_fill[i]  = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    for (j = snoop->n2; j > -1; j--) {
+      snoop->c_fill[i][j] = INF;
+      snoop->r_fill[i][j] = INF;
     }
   }
-  encode_seqs(s1, s2);
+  encode_seqs(snoop, s1, s2);
 
   int di[5];
   di[0] = 0;
-  for (i = 6; i <= n1 - 5; i++) {
+  for (i = 6; i <= snoop->n1 - 5; i++) {
     di[1] = access_s1[5][i] - access_s1[4][i - 1];
     di[2] = access_s1[5][i - 1] - access_s1[4][i - 2] + di[1];
     di[3] = access_s1[5][i - 2] - access_s1[4][i - 3] + di[2];
@@ -1955,31 +1991,31 @@ snoopfold_XS_fill(const char  *s1,
     di[2] = MIN2(di[2], 330);
     di[3] = MIN2(di[3], 495);
     di[4] = MIN2(di[4], 660);
-    for (j = n2 - min_d2; j > min_d1; j--) {
+    for (j = snoop->n2 - min_d2; j > min_d1; j--) {
       int type, type2, E, k, l;
-      type          = pair[S1[i]][S2[j]];
-      c_fill[i][j]  = (type) ? P->DuplexInit : INF;
+      type                = snoop->pair[snoop->S1[i]][snoop->S2[j]];
+      snoop->c_fill[i][j] = (type) ? snoop->P->DuplexInit : INF;
       if (!type)
         continue;
 
       if (/*  pair[S1[i+1]][S2[j-1]] &&  */
         j < max_s1 && j > min_s1 &&
-        j > n2 - max_s2 - max_half_stem &&
-        j < n2 - min_s2 - half_stem && S1[i - 2] == 4) {
+        j > snoop->n2 - max_s2 - max_half_stem &&
+        j < snoop->n2 - min_s2 - half_stem && snoop->S1[i - 2] == 4) {
         /*constraint on s2 and i*/
         int     min_k, max_k;
-        max_k = MIN2(n2 - min_s2, j + max_half_stem);
-        min_k = MAX2(j + half_stem, n2 - max_s2);
+        max_k = MIN2(snoop->n2 - min_s2, j + max_half_stem);
+        min_k = MAX2(j + half_stem, snoop->n2 - max_s2);
         folden  *temp;
         temp = foldlist[j + 1];
         while (temp->next) {
           int k = temp->k;
           /* if(k >= min_k-1 && k < max_k){ uncomment to recovernormal behaviour */
-          if (pair[S1[i - 3]][S2[k + 1]] /*&& pair[S1[i-4]][S2[k+2]]*/)
-            r_fill[i][j] = MIN2(r_fill[i][j], c_fill[i - 3][k + 1] + temp->energy + di[3]);
+          if (snoop->pair[snoop->S1[i - 3]][snoop->S2[k + 1]] /*&& pair[S1[i-4]][S2[k+2]]*/)
+            snoop->r_fill[i][j] = MIN2(snoop->r_fill[i][j], snoop->c_fill[i - 3][k + 1] + temp->energy + di[3]);
 
-          /*else*/ if (pair[S1[i - 4]][S2[k + 1]] /*&& pair[S1[i-5]][S2[k+2]]*/)
-            r_fill[i][j] = MIN2(r_fill[i][j], c_fill[i - 4][k + 1] + temp->energy + di[4]);
+          /*else*/ if (snoop->pair[snoop->S1[i - 4]][snoop->S2[k + 1]] /*&& pair[S1[i-5]][S2[k+2]]*/)
+            snoop->r_fill[i][j] = MIN2(snoop->r_fill[i][j], snoop->c_fill[i - 4][k + 1] + temp->energy + di[4]);
 
           /* } */
           temp = temp->next;
@@ -1992,32 +2028,32 @@ snoopfold_XS_fill(const char  *s1,
       *** c_fill[i][j] += P->dangle3[type][SS2[j+1]];
       *** if (type>2) c_fill[i][j] += P->TerminalAU;
       **/
-      c_fill[i][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
+      snoop->c_fill[i][j] += vrna_E_ext_stem(type, snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
       for (k = i - 1; k > 0 && (i - k) < MAXLOOP_L; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= snoop->n2; l++) {
           if (i - k + l - j > 2 * MAXLOOP_L - 2)
             break;
 
           if (abs(i - k - l + j) >= ASS)
             continue;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = snoop->pair[snoop->S1[k]][snoop->S2[l]];
           if (!type2)
             continue;
 
-          E = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                        SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
-          c_fill[i][j]  = MIN2(c_fill[i][j], c_fill[k][l] + E + di[i - k]);
-          r_fill[i][j]  = MIN2(r_fill[i][j], r_fill[k][l] + E + di[i - k]);
+          E = E_IntLoop(i - k - 1, l - j - 1, type2, snoop->rtype[type],
+                        snoop->SS1[k + 1], snoop->SS2[l - 1], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
+          snoop->c_fill[i][j] = MIN2(snoop->c_fill[i][j], snoop->c_fill[k][l] + E + di[i - k]);
+          snoop->r_fill[i][j] = MIN2(snoop->r_fill[i][j], snoop->r_fill[k][l] + E + di[i - k]);
         }
       }
-      E = r_fill[i][j];
+      E = snoop->r_fill[i][j];
       /**
       ***  if (i<n1) E += P->dangle3[rtype[type]][SS1[i+1]];
       ***  if (j>1)  E += P->dangle5[rtype[type]][SS2[j-1]];
       *** if (type>2) E += P->TerminalAU;
       **/
-      E += vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
+      E += vrna_E_ext_stem(snoop->rtype[type], (j > 1) ? snoop->SS2[j - 1] : -1, (i < snoop->n1) ? snoop->SS1[i + 1] : -1, snoop->P);
       if (E < Emin) {
         Emin  = E;
         i_min = i;
@@ -2030,28 +2066,29 @@ snoopfold_XS_fill(const char  *s1,
 
 
 PUBLIC snoopT *
-snoop_subopt(const char *s1,
-             const char *s2,
-             int        delta,
-             int        w,
-             const int  penalty,
-             const int  threshloop,
-             const int  threshLE,
-             const int  threshRE,
-             const int  threshDE,
-             const int  threshTE,
-             const int  threshSE,
-             const int  threshD,
-             const int  distance,
-             const int  half_stem,
-             const int  max_half_stem,
-             const int  min_s2,
-             const int  max_s2,
-             const int  min_s1,
-             const int  max_s1,
-             const int  min_d1,
-             const int  min_d2,
-             const int  fullStemEnergy)
+vrna_snoop_subopt(vrna_snoop_t  *snoop,
+                  const char    *s1,
+                  const char    *s2,
+                  int           delta,
+                  int           w,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshTE,
+                  const int     threshSE,
+                  const int     threshD,
+                  const int     distance,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2,
+                  const int     fullStemEnergy)
 {
   /* printf("%d %d\n", min_s2, max_s2); */
   int     i, j, n1, n2, E, n_subopt = 0, n_max;
@@ -2068,18 +2105,17 @@ snoop_subopt(const char *s1,
   Loop_E    = 0;
   Loop_D    = 0;
   int u;
-  u           = 0;
-  n_max       = 16;
-  subopt      = (snoopT *)vrna_alloc(n_max * sizeof(snoopT));
-  delay_free  = 1;
-  mfe         = snoopfold(s1, s2, penalty, threshloop, threshLE, threshRE, threshDE, threshD,
-                          half_stem, max_half_stem,
-                          min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, fullStemEnergy);
-
+  u                 = 0;
+  n_max             = 16;
+  subopt            = (snoopT *)vrna_alloc(n_max * sizeof(snoopT));
+  snoop->delay_free = 1;
+  mfe               = vrna_snoopfold(snoop, s1, s2, penalty, threshloop, threshLE, threshRE, threshDE, threshD,
+                                     half_stem, max_half_stem,
+                                     min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, fullStemEnergy);
 
   if (mfe.energy > 0) {
     free(subopt);
-    delay_free = 0;
+    snoop->delay_free = 0;
     return NULL;
   }
 
@@ -2093,17 +2129,17 @@ snoop_subopt(const char *s1,
   for (i = n1; i > 0; i--) {
     for (j = 1; j <= n2; j++) {
       int type, Ed;
-      type = pair[S2[j]][S1[i]];
+      type = snoop->pair[snoop->S2[j]][snoop->S1[i]];
       if (!type)
         continue;
 
-      E = Ed = r[i][j];
+      E = Ed = snoop->r[i][j];
       /**
       *** if (i<n1) Ed += P->dangle3[type][SS1[i+1]];
       *** if (j>1)  Ed += P->dangle5[type][SS2[j-1]];
       *** if (type>2) Ed += P->TerminalAU;
       **/
-      Ed += vrna_E_ext_stem(type, (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
+      Ed += vrna_E_ext_stem(type, (j > 1) ? snoop->SS2[j - 1] : -1, (i < n1) ? snoop->SS1[i + 1] : -1, snoop->P);
       if (Ed > thresh)
         continue;
 
@@ -2119,7 +2155,8 @@ snoop_subopt(const char *s1,
       if (!type)
         continue;
 
-      struc = snoop_backtrack(i,
+      struc = snoop_backtrack(snoop,
+                              i,
                               j,
                               s2,
                               &Duplex_El,
@@ -2187,16 +2224,16 @@ snoop_subopt(const char *s1,
   }
 
   for (i = 0; i <= n1; i++) {
-    free(c[i]);
-    free(r[i]);
+    free(snoop->c[i]);
+    free(snoop->r[i]);
   }
-  free(c);
-  free(r);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
-  delay_free = 0;
+  free(snoop->c);
+  free(snoop->r);
+  free(snoop->S1);
+  free(snoop->S2);
+  free(snoop->SS1);
+  free(snoop->SS2);
+  snoop->delay_free = 0;
 
   if (snoop_subopt_sorted)
     qsort(subopt, n_subopt, sizeof(snoopT), compare);
@@ -2209,31 +2246,32 @@ snoop_subopt(const char *s1,
 
 
 PUBLIC void
-snoop_subopt_XS(const char  *s1,
-                const char  *s2,
-                const int   **access_s1,
-                int         delta,
-                int         w,
-                const int   penalty,
-                const int   threshloop,
-                const int   threshLE,
-                const int   threshRE,
-                const int   threshDE,
-                const int   threshTE,
-                const int   threshSE,
-                const int   threshD,
-                const int   distance,
-                const int   half_stem,
-                const int   max_half_stem,
-                const int   min_s2,
-                const int   max_s2,
-                const int   min_s1,
-                const int   max_s1,
-                const int   min_d1,
-                const int   min_d2,
-                const int   alignment_length,
-                const char  *name,
-                const int   fullStemEnergy)
+vrna_snoop_subopt_XS(vrna_snoop_t *snoop,
+                     const char   *s1,
+                     const char   *s2,
+                     const int    **access_s1,
+                     int          delta,
+                     int          w,
+                     const int    penalty,
+                     const int    threshloop,
+                     const int    threshLE,
+                     const int    threshRE,
+                     const int    threshDE,
+                     const int    threshTE,
+                     const int    threshSE,
+                     const int    threshD,
+                     const int    distance,
+                     const int    half_stem,
+                     const int    max_half_stem,
+                     const int    min_s2,
+                     const int    max_s2,
+                     const int    min_s1,
+                     const int    max_s1,
+                     const int    min_d1,
+                     const int    min_d2,
+                     const int    alignment_length,
+                     const char   *name,
+                     const int    fullStemEnergy)
 {
   /* printf("%d %d\n", min_s2, max_s2); */
   int i, j, E, n_max;
@@ -2250,10 +2288,11 @@ snoop_subopt_XS(const char  *s1,
   Loop_E    = 0;
   Loop_D    = 0;
   int u;
-  u           = 0;
-  n_max       = 16;
-  delay_free  = 1;
-  int Emin = snoopfold_XS_fill(s1,
+  u                 = 0;
+  n_max             = 16;
+  snoop->delay_free = 1;
+  int Emin = snoopfold_XS_fill(snoop,
+                               s1,
                                s2,
                                access_s1,
                                penalty,
@@ -2271,7 +2310,7 @@ snoop_subopt_XS(const char  *s1,
                                min_d1,
                                min_d2);
   if (Emin > 0)
-    delay_free = 0;
+    snoop->delay_free = 0;
 
   thresh = MIN2(-100, threshTE + alignment_length * 30);
   /*   n1=(int)strlen(s1);  */
@@ -2279,33 +2318,33 @@ snoop_subopt_XS(const char  *s1,
 
   int n3  = (int)strlen(s1);
   int n4  = (int)strlen(s2);
-  S1_fill   = (short *)vrna_alloc(sizeof(short) * (n3 + 2));
-  S2_fill   = (short *)vrna_alloc(sizeof(short) * (n4 + 2));
-  SS1_fill  = (short *)vrna_alloc(sizeof(short) * (n3 + 1));
-  SS2_fill  = (short *)vrna_alloc(sizeof(short) * (n4 + 1));
-  memcpy(S1_fill, S1, sizeof(short) * n3 + 2);
-  memcpy(S2_fill, S2, sizeof(short) * n4 + 2);
-  memcpy(SS1_fill, SS1, sizeof(short) * n3 + 1);
-  memcpy(SS2_fill, SS2, sizeof(short) * n4 + 1);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  snoop->S1_fill  = (short *)vrna_alloc(sizeof(short) * (n3 + 2));
+  snoop->S2_fill  = (short *)vrna_alloc(sizeof(short) * (n4 + 2));
+  snoop->SS1_fill = (short *)vrna_alloc(sizeof(short) * (n3 + 1));
+  snoop->SS2_fill = (short *)vrna_alloc(sizeof(short) * (n4 + 1));
+  memcpy(snoop->S1_fill, snoop->S1, sizeof(short) * n3 + 2);
+  memcpy(snoop->S2_fill, snoop->S2, sizeof(short) * n4 + 2);
+  memcpy(snoop->SS1_fill, snoop->SS1, sizeof(short) * n3 + 1);
+  memcpy(snoop->SS2_fill, snoop->SS2, sizeof(short) * n4 + 1);
+  free(snoop->S1);
+  free(snoop->S2);
+  free(snoop->SS1);
+  free(snoop->SS2);
   int count = 0;
   for (i = n3 - 5; i > 0; i--) {
     for (j = 1; j <= n4; j++) {
       int type, Ed;
-      type = pair[S2_fill[j]][S1_fill[i]];
+      type = snoop->pair[snoop->S2_fill[j]][snoop->S1_fill[i]];
       if (!type)
         continue;
 
-      E = Ed = r_fill[i][j];
+      E = Ed = snoop->r_fill[i][j];
       /**
        ***if (i<n3) Ed += P->dangle3[type][SS1_fill[i+1]];
        ***if (j>1)  Ed += P->dangle5[type][SS2_fill[j-1]];
        ***if (type>2) Ed += P->TerminalAU;
        **/
-      Ed += vrna_E_ext_stem(type, (j > 1) ? SS2[j - 1] : -1, (i < n3) ? SS1[i + 1] : -1, P);
+      Ed += vrna_E_ext_stem(type, (j > 1) ? snoop->SS2[j - 1] : -1, (i < n3) ? snoop->SS1[i + 1] : -1, snoop->P);
       if (Ed > thresh)
         continue;
 
@@ -2328,11 +2367,11 @@ snoop_subopt_XS(const char  *s1,
       strncpy(s3, (s1 + begin), end - begin + 1);
       strcat(s3, "NNNNN\0");
       int     n5    = (int)strlen(s3);
-      snoopT  test  = snoopfold_XS(s3, s2, access_s1, i, j, penalty,
-                                   threshloop, threshLE, threshRE,
-                                   threshDE, threshD, half_stem,
-                                   max_half_stem, min_s2, max_s2, min_s1,
-                                   max_s1, min_d1, min_d2, fullStemEnergy);
+      snoopT  test  = vrna_snoopfold_XS(snoop, s3, s2, access_s1, i, j, penalty,
+                                        threshloop, threshLE, threshRE,
+                                        threshDE, threshD, half_stem,
+                                        max_half_stem, min_s2, max_s2, min_s1,
+                                        max_s1, min_d1, min_d2, fullStemEnergy);
       if (test.energy == INF) {
         free(s3);
         continue;
@@ -2356,7 +2395,7 @@ snoop_subopt_XS(const char  *s1,
       strncpy(s5, s3 + test.i - 1, n5 - test.i + 1 - 5);
       s5[n5 - test.i + 1 - 5] = '\0';
       float dE = ((float)(access_s1[n5 - test.i + 1 - 5][i])) * 0.01;
-      printf(
+      snoop_printf(snoop,
         "%s %3d,%-3d;%3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f + %5.2f + %5.2f + 4.10)  (%5.2f)\n%s&%s\n",
         test.structure,
         i - (n5 - test.i),
@@ -2419,42 +2458,43 @@ snoop_subopt_XS(const char  *s1,
     }
   }
   for (i = 0; i <= n3; i++) {
-    free(c_fill[i]);
-    free(r_fill[i]);
+    free(snoop->c_fill[i]);
+    free(snoop->r_fill[i]);
   }
-  free(c_fill);
-  free(r_fill);
-  free(S1_fill);
-  free(S2_fill);
-  free(SS1_fill);
-  free(SS2_fill);
-  delay_free = 0;
+  free(snoop->c_fill);
+  free(snoop->r_fill);
+  free(snoop->S1_fill);
+  free(snoop->S2_fill);
+  free(snoop->SS1_fill);
+  free(snoop->SS2_fill);
+  snoop->delay_free = 0;
 }
 
 
 PRIVATE char *
-snoop_backtrack(int         i,
-                int         j,
-                const char  *snoseq,
-                int         *Duplex_El,
-                int         *Duplex_Er,
-                int         *Loop_E,
-                int         *Loop_D,
-                int         *u,
-                const int   penalty,
-                const int   threshloop,
-                const int   threshLE,
-                const int   threshRE,
-                const int   threshDE,
-                const int   threshD,
-                const int   half_stem,
-                const int   max_half_stem,
-                const int   min_s2,
-                const int   max_s2,
-                const int   min_s1,
-                const int   max_s1,
-                const int   min_d1,
-                const int   min_d2)
+snoop_backtrack(vrna_snoop_t  *snoop,
+                int           i,
+                int           j,
+                const char    *snoseq,
+                int           *Duplex_El,
+                int           *Duplex_Er,
+                int           *Loop_E,
+                int           *Loop_D,
+                int           *u,
+                const int     penalty,
+                const int     threshloop,
+                const int     threshLE,
+                const int     threshRE,
+                const int     threshDE,
+                const int     threshD,
+                const int     half_stem,
+                const int     max_half_stem,
+                const int     min_s2,
+                const int     max_s2,
+                const int     min_s1,
+                const int     max_s1,
+                const int     min_d1,
+                const int     min_d2)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
@@ -2463,13 +2503,13 @@ snoop_backtrack(int         i,
   char    *st1, *st2, *struc;
   char    *struc_loop;
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n1 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n2 + 1));
+  st1 = (char *)vrna_alloc(sizeof(char) * (snoop->n1 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (snoop->n2 + 1));
   int     *indx;
   int     *mLoop;
   int     *cLoop;
   folden  **foldlist, **foldlist_XS;
-  type = pair[S1[i]][S2[j]];
+  type = snoop->pair[snoop->S1[i]][snoop->S2[j]];
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
   i0  = i;
   j0  = j;
@@ -2478,19 +2518,19 @@ snoop_backtrack(int         i,
   *** if (j>1)    *Duplex_Er += P->dangle5[rtype[type]][SS2[j-1]];
   *** if (type>2) *Duplex_Er += P->TerminalAU;
   **/
-  *Duplex_Er += vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
-  while (i > 0 && j <= n2 - min_d2) {
+  *Duplex_Er += vrna_E_ext_stem(snoop->rtype[type], (j > 1) ? snoop->SS2[j - 1] : -1, (i < snoop->n1) ? snoop->SS1[i + 1] : -1, snoop->P);
+  while (i > 0 && j <= snoop->n2 - min_d2) {
     if (!traced_r) {
-      E           = r[i][j];
+      E           = snoop->r[i][j];
       traced      = 0;
       st1[i - 1]  = '<';
       st2[j - 1]  = '>';
-      type        = pair[S1[i]][S2[j]];
+      type        = snoop->pair[snoop->S1[i]][snoop->S2[j]];
       if (!type)
         vrna_message_error("backtrack failed in fold duplex r");
 
       for (k = i - 1; k > 0 && (i - k) < MAXLOOP_L; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= snoop->n2; l++) {
           int LE;
           if (i - k + l - j > 2 * MAXLOOP_L - 2)
             break;
@@ -2498,13 +2538,13 @@ snoop_backtrack(int         i,
           if (abs(i - k - l + j) >= ASS)
             continue;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = snoop->pair[snoop->S1[k]][snoop->S2[l]];
           if (!type2)
             continue;
 
-          LE = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                         SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
-          if (E == r[k][l] + LE + (i - k + l - j) * penalty) {
+          LE = E_IntLoop(i - k - 1, l - j - 1, type2, snoop->rtype[type],
+                         snoop->SS1[k + 1], snoop->SS2[l - 1], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
+          if (E == snoop->r[k][l] + LE + (i - k + l - j) * penalty) {
             traced      = 1;
             i           = k;
             j           = l;
@@ -2518,19 +2558,19 @@ snoop_backtrack(int         i,
       if (!traced) {
         if (/*  pair[S1[i+1]][S2[j-1]] && */
           j < max_s1 && j > min_s1 &&
-          j > n2 - max_s2 - max_half_stem &&
-          j < n2 - min_s2 - half_stem &&
-          S1[i - 2] == 4) {
+          j > snoop->n2 - max_s2 - max_half_stem &&
+          j < snoop->n2 - min_s2 - half_stem &&
+          snoop->S1[i - 2] == 4) {
           int     min_k, max_k;
-          max_k = MIN2(n2 - min_s2, j + max_half_stem + 1);
-          min_k = MAX2(j + half_stem + 1, n2 - max_s2);
+          max_k = MIN2(snoop->n2 - min_s2, j + max_half_stem + 1);
+          min_k = MAX2(j + half_stem + 1, snoop->n2 - max_s2);
           folden  *temp;
           temp = foldlist[j + 1];
           while (temp->next) {
             int k = temp->k;
-            if (pair[S1[i - 3]][S2[k + 1]] /*&& pair[S1[i-4]][S2[k+2]]*/) {
+            if (snoop->pair[snoop->S1[i - 3]][snoop->S2[k + 1]] /*&& pair[S1[i-4]][S2[k+2]]*/) {
               /* introduce structure from RNAfold */
-              if (E == c[i - 3][k + 1] + temp->energy) {
+              if (E == snoop->c[i - 3][k + 1] + temp->energy) {
                 *Loop_E     = temp->energy;
                 st1[i - 3]  = '|';
                 *u          = i - 2;
@@ -2554,9 +2594,9 @@ snoop_backtrack(int         i,
               }
             }
 
-            /*else*/ if (pair[S1[i - 4]][S2[k + 1]] /*&& pair[S1[i-5]][S2[k+2]]*/) {
+            /*else*/ if (snoop->pair[snoop->S1[i - 4]][snoop->S2[k + 1]] /*&& pair[S1[i-5]][S2[k+2]]*/) {
               /* introduce structure from RNAfold */
-              if (E == c[i - 4][k + 1] + temp->energy) {
+              if (E == snoop->c[i - 4][k + 1] + temp->energy) {
                 *Loop_E     = temp->energy;
                 st1[i - 3]  = '|';
                 *u          = i - 2;
@@ -2586,16 +2626,16 @@ snoop_backtrack(int         i,
       }     /* traced? */
     }       /* traced_r? */
     else {
-      E           = c[i][j];
+      E           = snoop->c[i][j];
       traced      = 0;
       st1[i - 1]  = '<';
       st2[j - 1]  = '>';
-      type        = pair[S1[i]][S2[j]];
+      type        = snoop->pair[snoop->S1[i]][snoop->S2[j]];
       if (!type)
         vrna_message_error("backtrack failed in fold duplex c");
 
       for (k = i - 1; (i - k) < MAXLOOP_L; k--) {
-        for (l = j + 1; l <= n2; l++) {
+        for (l = j + 1; l <= snoop->n2; l++) {
           int LE;
           if (i - k + l - j > 2 * MAXLOOP_L - 2)
             break;
@@ -2603,13 +2643,13 @@ snoop_backtrack(int         i,
           if (abs(i - k - l + j) >= ASS)
             continue;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = snoop->pair[snoop->S1[k]][snoop->S2[l]];
           if (!type2)
             continue;
 
-          LE = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                         SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
-          if (E == c[k][l] + LE + (i - k + l - j) * penalty) {
+          LE = E_IntLoop(i - k - 1, l - j - 1, type2, snoop->rtype[type],
+                         snoop->SS1[k + 1], snoop->SS2[l - 1], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
+          if (E == snoop->c[k][l] + LE + (i - k + l - j) * penalty) {
             traced      = 1;
             i           = k;
             j           = l;
@@ -2624,7 +2664,7 @@ snoop_backtrack(int         i,
 
     if (!traced) {
       int correction;
-      correction  = vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n2) ? SS2[j + 1] : -1, P);
+      correction  = vrna_E_ext_stem(type, (i > 1) ? snoop->SS1[i - 1] : -1, (j < snoop->n2) ? snoop->SS2[j + 1] : -1, snoop->P);
       E           -= correction;
       *Duplex_El  += correction;
       /**
@@ -2632,7 +2672,7 @@ snoop_backtrack(int         i,
       *** if (j<n2)   {E -= P->dangle3[type][SS2[j+1]]; *Duplex_El +=P->dangle3[type][SS2[j+1]];}
       *** if (type>2) {E -= P->TerminalAU;                    *Duplex_El +=P->TerminalAU;}
       **/
-      if (E != P->DuplexInit)
+      if (E != snoop->P->DuplexInit)
         vrna_message_error("backtrack failed in fold duplex end");
       else
         break;
@@ -2641,9 +2681,9 @@ snoop_backtrack(int         i,
   /*   if (i>1)  i--; */
   /*   if (j<n2) j++; */
   /* struc = (char *) vrna_alloc(i0-i+1+j-j0+1+2); */ /* declare final duplex structure */
-  struc = (char *)vrna_alloc(i0 - i + 1 + n2 - 1 + 1 + 2); /* declare final duplex structure */
+  struc = (char *)vrna_alloc(i0 - i + 1 + snoop->n2 - 1 + 1 + 2); /* declare final duplex structure */
   char *struc2;
-  struc2 = (char *)vrna_alloc(n2 + 1);
+  struc2 = (char *)vrna_alloc(snoop->n2 + 1);
   /* char * struct_const; */
   for (k = MAX2(i, 1); k <= i0; k++)
     if (!st1[k - 1])
@@ -2652,7 +2692,7 @@ snoop_backtrack(int         i,
   /* for (k=j0; k<=j; k++) if (!st2[k-1]) st2[k-1] = struc_loop[k-1];*/ /* '.'; normal */
   /*  char * struct_const; */
   /*  struct_const = (char *) vrna_alloc(sizeof(char)*(n2+1));   */
-  for (k = 1; k <= n2; k++) {
+  for (k = 1; k <= snoop->n2; k++) {
     if (!st2[k - 1])
       st2[k - 1] = struc_loop[k - 1];   /* '.'; */
 
@@ -2666,12 +2706,12 @@ snoop_backtrack(int         i,
     /*      } */
   }
   char  duplexseq_1[j0];
-  char  duplexseq_2[n2 - j + 2];
-  if (j < n2) {
+  char  duplexseq_2[snoop->n2 - j + 2];
+  if (j < snoop->n2) {
     strncpy(duplexseq_1, snoseq, j0 - 1);
     strcpy(duplexseq_2, snoseq + j);
-    duplexseq_1[j0 - 1]     = '\0';
-    duplexseq_2[n2 - j + 1] = '\0';
+    duplexseq_1[j0 - 1]             = '\0';
+    duplexseq_2[snoop->n2 - j + 1]  = '\0';
     duplexT temp;
     temp    = duplexfold(duplexseq_1, duplexseq_2);
     *Loop_D = MIN2(0, -410 + (int)100 * temp.energy);
@@ -2704,32 +2744,33 @@ snoop_backtrack(int         i,
 }
 
 
-void
-Lsnoop_subopt_list_XS(const char  *s1,
-                      const char  *s2,
-                      const int   **access_s1,
-                      int         delta,
-                      int         w,
-                      const int   penalty,
-                      const int   threshloop,
-                      const int   threshLE,
-                      const int   threshRE,
-                      const int   threshDE,
-                      const int   threshTE,
-                      const int   threshSE,
-                      const int   threshD,
-                      const int   distance,
-                      const int   half_stem,
-                      const int   max_half_stem,
-                      const int   min_s2,
-                      const int   max_s2,
-                      const int   min_s1,
-                      const int   max_s1,
-                      const int   min_d1,
-                      const int   min_d2,
-                      const int   alignment_length,
-                      const char  *name,
-                      const int   fullStemEnergy)
+PUBLIC void
+vrna_Lsnoop_subopt_list_XS(vrna_snoop_t *snoop,
+                           const char   *s1,
+                           const char   *s2,
+                           const int    **access_s1,
+                           int          delta,
+                           int          w,
+                           const int    penalty,
+                           const int    threshloop,
+                           const int    threshLE,
+                           const int    threshRE,
+                           const int    threshDE,
+                           const int    threshTE,
+                           const int    threshSE,
+                           const int    threshD,
+                           const int    distance,
+                           const int    half_stem,
+                           const int    max_half_stem,
+                           const int    min_s2,
+                           const int    max_s2,
+                           const int    min_s1,
+                           const int    max_s1,
+                           const int    min_d1,
+                           const int    min_d2,
+                           const int    alignment_length,
+                           const char   *name,
+                           const int    fullStemEnergy)
 {
   int min_colonne = INF;
   int max_pos;
@@ -2739,61 +2780,50 @@ Lsnoop_subopt_list_XS(const char  *s1,
 
   /* int temp; */
   /* int nsubopt=10; */
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
-  int       *position;
-  int       *position_j;
-  int       min_j_colonne;
-  int       max_pos_j = INF;
-  position    = (int *)vrna_alloc((n1 + 3) * sizeof(int));
-  position_j  = (int *)vrna_alloc((n1 + 3) * sizeof(int));
+  snoop->n1 = (int)strlen(s1);
+  snoop->n2 = (int)strlen(s2);
+  int     *position;
+  int     *position_j;
+  int     min_j_colonne;
+  int     max_pos_j = INF;
+  position    = (int *)vrna_alloc((snoop->n1 + 3) * sizeof(int));
+  position_j  = (int *)vrna_alloc((snoop->n1 + 3) * sizeof(int));
 
   /* int Eminj, Emin_l; */
-  int       i, j;/*  l1, Emin=INF, i_min=0, j_min=0; */
+  int     i, j;/*  l1, Emin=INF, i_min=0, j_min=0; */
   /* char *struc; */
   /* snoopT mfe; */
-  int       *indx;
-  int       *mLoop;
-  int       *cLoop;
-  folden    **foldlist, **foldlist_XS;
-  int       Duplex_El, Duplex_Er;
-  int       Loop_D;
+  int     *indx;
+  int     *mLoop;
+  int     *cLoop;
+  folden  **foldlist, **foldlist_XS;
+  int     Duplex_El, Duplex_Er;
+  int     Loop_D;
   /* int u; */
-  int       Loop_E;
-  vrna_md_t md;
+  int     Loop_E;
 
   Duplex_El = 0;
   Duplex_Er = 0;
   Loop_E    = 0, Loop_D = 0;
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
 
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    snoupdate_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  lpair = (int **)vrna_alloc(sizeof(int *) * (6));
-  lc    = (int **)vrna_alloc(sizeof(int *) * (6));
-  lr    = (int **)vrna_alloc(sizeof(int *) * (6));
+  snoop->lpair  = (int **)vrna_alloc(sizeof(int *) * (6));
+  snoop->lc     = (int **)vrna_alloc(sizeof(int *) * (6));
+  snoop->lr     = (int **)vrna_alloc(sizeof(int *) * (6));
   for (i = 0; i < 6; i++) {
-    lc[i]     = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    lr[i]     = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    lpair[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    for (j = n2; j > -1; j--) {
-      lc[i][j]    = INF;
-      lr[i][j]    = INF;
-      lpair[i][j] = 0;
+    snoop->lc[i]    = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->lr[i]    = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->lpair[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    for (j = snoop->n2; j > -1; j--) {
+      snoop->lc[i][j]     = INF;
+      snoop->lr[i][j]     = INF;
+      snoop->lpair[i][j]  = 0;
     }
   }
-  encode_seqs(s1, s2);
-  int lim_maxj  = n2 - min_d2;
+  encode_seqs(snoop, s1, s2);
+  int lim_maxj  = snoop->n2 - min_d2;
   int lim_minj  = min_d1;
-  int lim_maxi  = n1 - 5;
+  int lim_maxi  = snoop->n1 - 5;
   for (i = 5; i <= lim_maxi; i++) {
     int idx = i % 5;
     int idx_1 = (i - 1) % 5;
@@ -2811,31 +2841,31 @@ Lsnoop_subopt_list_XS(const char  *s1,
     di4 = MIN2(di4, 660);
     for (j = lim_maxj; j > lim_minj; j--) {
       int type, type2;/*  E, k,l; */
-      type          = pair[S1[i]][S2[j]];
-      lpair[idx][j] = type;
-      lc[idx][j]    = (type) ? P->DuplexInit + access_s1[1][i] : INF;
-      lr[idx][j]    = INF;
+      type                  = snoop->pair[snoop->S1[i]][snoop->S2[j]];
+      snoop->lpair[idx][j]  = type;
+      snoop->lc[idx][j]     = (type) ? snoop->P->DuplexInit + access_s1[1][i] : INF;
+      snoop->lr[idx][j]     = INF;
       if (!type)
         continue;
 
       if ( /*pair[S1[i+1]][S2[j-1]] && Be sure it binds*/
         j < max_s1 && j > min_s1 &&
-        j > n2 - max_s2 - max_half_stem &&
-        j < n2 - min_s2 - half_stem && S1[i - 2] == 4) {
+        j > snoop->n2 - max_s2 - max_half_stem &&
+        j < snoop->n2 - min_s2 - half_stem && snoop->S1[i - 2] == 4) {
         /*constraint on s2 and i*/
         int     min_k, max_k;
-        max_k = MIN2(n2 - min_s2, j + max_half_stem + 1);
-        min_k = MAX2(j + half_stem + 1, n2 - max_s2);
+        max_k = MIN2(snoop->n2 - min_s2, j + max_half_stem + 1);
+        min_k = MAX2(j + half_stem + 1, snoop->n2 - max_s2);
         folden  *temp;
         temp = foldlist[j + 1];
         while (temp->next) {
           int k = temp->k;
           /* if(k >= min_k-1 && k < max_k){ comment to recover normal behaviour */
-          if (lpair[idx_3][k + 1] && lc[idx_3][k + 1] /*+di3*/ < 411 /*&& lpair[idx_4][k+2]*/)  /*  remove second condition */
-            lr[idx][j] = MIN2(lr[idx][j], di3 + lc[idx_3][k + 1] + temp->energy);               /*--NU--*/
+          if (snoop->lpair[idx_3][k + 1] && snoop->lc[idx_3][k + 1] /*+di3*/ < 411 /*&& lpair[idx_4][k+2]*/)  /*  remove second condition */
+            snoop->lr[idx][j] = MIN2(snoop->lr[idx][j], di3 + snoop->lc[idx_3][k + 1] + temp->energy);               /*--NU--*/
 
-          /*else*/ if (lpair[idx_4][k + 1] && /*di4 +*/ lc[idx_4][k + 1] < 411)                 /*--NUN--*/ /*  remove second condition  */
-            lr[idx][j] = MIN2(lr[idx][j], di4 + lc[idx_4][k + 1] + temp->energy);
+          /*else*/ if (snoop->lpair[idx_4][k + 1] && /*di4 +*/ snoop->lc[idx_4][k + 1] < 411)                 /*--NUN--*/ /*  remove second condition  */
+            snoop->lr[idx][j] = MIN2(snoop->lr[idx][j], di4 + snoop->lc[idx_4][k + 1] + temp->energy);
 
           /*  } */
           temp = temp->next;
@@ -2848,53 +2878,53 @@ Lsnoop_subopt_list_XS(const char  *s1,
       *** lc[idx][j] += P->dangle3[type][SS2[j+1]];
       *** if (type>2) lc[idx][j] += P->TerminalAU;
       **/
-      lc[idx][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
+      snoop->lc[idx][j] += vrna_E_ext_stem(type, snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P);
       /*       if(j<n2 && i>1){ */
       /* type2=pair[S1[i-1]][S2[j+1]]; */
-      type2 = lpair[idx_1][j + 1];
+      type2 = snoop->lpair[idx_1][j + 1];
       if (type2 > 0) {
-        lc[idx][j] =
-          MIN2(lc[idx_1][j + 1] +
-               E_IntLoop(0, 0, type2, rtype[type], SS1[i], SS2[j], SS1[i - 1], SS2[j + 1], P) + di1,
-               lc[idx][j]);
-        lr[idx][j] =
-          MIN2(lr[idx_1][j + 1] +
-               E_IntLoop(0, 0, type2, rtype[type], SS1[i], SS2[j], SS1[i - 1], SS2[j + 1], P) + di1,
-               lr[idx][j]);
+        snoop->lc[idx][j] =
+          MIN2(snoop->lc[idx_1][j + 1] +
+               E_IntLoop(0, 0, type2, snoop->rtype[type], snoop->SS1[i], snoop->SS2[j], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P) + di1,
+               snoop->lc[idx][j]);
+        snoop->lr[idx][j] =
+          MIN2(snoop->lr[idx_1][j + 1] +
+               E_IntLoop(0, 0, type2, snoop->rtype[type], snoop->SS1[i], snoop->SS2[j], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->P) + di1,
+               snoop->lr[idx][j]);
       }
 
-      type2 = lpair[idx_2][j + 2];
+      type2 = snoop->lpair[idx_2][j + 2];
       if (type2 > 0) {
-        lc[idx][j] =
-          MIN2(lc[idx_2][j + 2] +
-               E_IntLoop(1, 1, type2, rtype[type], SS1[i - 1], SS2[j + 1], SS1[i - 1], SS2[j + 1],
-                         P) + di2,
-               lc[idx][j]);
-        lr[idx][j] =
-          MIN2(lr[idx_2][j + 2] +
-               E_IntLoop(1, 1, type2, rtype[type], SS1[i - 1], SS2[j + 1], SS1[i - 1], SS2[j + 1],
-                         P) + di2,
-               lr[idx][j]);
+        snoop->lc[idx][j] =
+          MIN2(snoop->lc[idx_2][j + 2] +
+               E_IntLoop(1, 1, type2, snoop->rtype[type], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + di2,
+               snoop->lc[idx][j]);
+        snoop->lr[idx][j] =
+          MIN2(snoop->lr[idx_2][j + 2] +
+               E_IntLoop(1, 1, type2, snoop->rtype[type], snoop->SS1[i - 1], snoop->SS2[j + 1], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + di2,
+               snoop->lr[idx][j]);
       }
 
-      type2 = lpair[idx_3][j + 3];
+      type2 = snoop->lpair[idx_3][j + 3];
       if (type2 > 0) {
-        lc[idx][j] =
-          MIN2(lc[idx_3][j + 3] +
-               E_IntLoop(2, 2, type2, rtype[type], SS1[i - 2], SS2[j + 2], SS1[i - 1], SS2[j + 1],
-                         P) + di3,
-               lc[idx][j]);
-        lr[idx][j] =
-          MIN2(lr[idx_3][j + 3] +
-               E_IntLoop(2, 2, type2, rtype[type], SS1[i - 2], SS2[j + 2], SS1[i - 1], SS2[j + 1],
-                         P) + di3,
-               lr[idx][j]);
+        snoop->lc[idx][j] =
+          MIN2(snoop->lc[idx_3][j + 3] +
+               E_IntLoop(2, 2, type2, snoop->rtype[type], snoop->SS1[i - 2], snoop->SS2[j + 2], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + di3,
+               snoop->lc[idx][j]);
+        snoop->lr[idx][j] =
+          MIN2(snoop->lr[idx_3][j + 3] +
+               E_IntLoop(2, 2, type2, snoop->rtype[type], snoop->SS1[i - 2], snoop->SS2[j + 2], snoop->SS1[i - 1], snoop->SS2[j + 1],
+                         snoop->P) + di3,
+               snoop->lr[idx][j]);
       }
 
       int bla;
       int temp2;
       temp2 = min_colonne;
-      bla   = lr[idx][j] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P);
+      bla   = snoop->lr[idx][j] + vrna_E_ext_stem(snoop->rtype[type], snoop->SS2[j - 1], snoop->SS1[i + 1], snoop->P);
       /**
       *** (type>2?P->TerminalAU:0)+P->dangle3[rtype[type]][SS1[i+1]]+P->dangle5[rtype[type]][SS2[j-1]];
       **/
@@ -2912,13 +2942,14 @@ Lsnoop_subopt_list_XS(const char  *s1,
     position_j[i] = min_j_colonne;
     min_colonne   = INF;
   }
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  free(snoop->S1);
+  free(snoop->S2);
+  free(snoop->SS1);
+  free(snoop->SS2);
 
   if (max < threshTE + 30 * alignment_length) {
-    find_max_snoop_XS(s1,
+    find_max_snoop_XS(snoop,
+                      s1,
                       s2,
                       access_s1,
                       max,
@@ -2948,54 +2979,55 @@ Lsnoop_subopt_list_XS(const char  *s1,
   }
 
   for (i = 1; i < 6; i++) {
-    free(lc[i]);
-    free(lr[i]);
-    free(lpair[i]);
+    free(snoop->lc[i]);
+    free(snoop->lr[i]);
+    free(snoop->lpair[i]);
   }
-  free(lc[0]);
-  free(lr[0]);
-  free(lpair[0]);
-  free(lc);
-  free(lr);
-  free(lpair);
+  free(snoop->lc[0]);
+  free(snoop->lr[0]);
+  free(snoop->lpair[0]);
+  free(snoop->lc);
+  free(snoop->lr);
+  free(snoop->lpair);
   free(position);
   free(position_j);
 }
 
 
 PRIVATE void
-find_max_snoop_XS(const char  *s1,
-                  const char  *s2,
-                  const int   **access_s1,
-                  const int   max,
-                  const int   alignment_length,
-                  const int   *position,
-                  const int   *position_j,
-                  const int   delta,
-                  const int   distance,
-                  const int   penalty,
-                  const int   threshloop,
-                  const int   threshLE,
-                  const int   threshRE,
-                  const int   threshDE,
-                  const int   threshTE,
-                  const int   threshSE,
-                  const int   threshD,
-                  const int   half_stem,
-                  const int   max_half_stem,
-                  const int   min_s2,
-                  const int   max_s2,
-                  const int   min_s1,
-                  const int   max_s1,
-                  const int   min_d1,
-                  const int   min_d2,
-                  const char  *name,
-                  const int   fullStemEnergy)
+find_max_snoop_XS(vrna_snoop_t  *snoop,
+                  const char    *s1,
+                  const char    *s2,
+                  const int     **access_s1,
+                  const int     max,
+                  const int     alignment_length,
+                  const int     *position,
+                  const int     *position_j,
+                  const int     delta,
+                  const int     distance,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshTE,
+                  const int     threshSE,
+                  const int     threshD,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2,
+                  const char    *name,
+                  const int     fullStemEnergy)
 {
   int count = 0;
   int n3    = (int)strlen(s1);
   int n4    = (int)strlen(s2);
-  int pos   = n1 - 4;
+  int pos   = snoop->n1 - 4;
   int max_pos_j;
   int threshold = MIN2(threshTE + alignment_length * 30, -100);
 
@@ -3021,11 +3053,11 @@ find_max_snoop_XS(const char  *s1,
 
       int     n5 = (int)strlen(s3);
       snoopT  test;
-      test = snoopfold_XS(s3, s2, access_s1, pos, max_pos_j, penalty,
-                          threshloop, threshLE, threshRE,
-                          threshDE, threshD, half_stem,
-                          max_half_stem, min_s2, max_s2, min_s1,
-                          max_s1, min_d1, min_d2, fullStemEnergy);
+      test = vrna_snoopfold_XS(snoop, s3, s2, access_s1, pos, max_pos_j, penalty,
+                               threshloop, threshLE, threshRE,
+                               threshDE, threshD, half_stem,
+                               max_half_stem, min_s2, max_s2, min_s1,
+                               max_s1, min_d1, min_d2, fullStemEnergy);
       if (test.energy == INF) {
         free(s3);
         continue;
@@ -3049,7 +3081,7 @@ find_max_snoop_XS(const char  *s1,
       strncpy(s5, s3 + test.i - 1, n5 - test.i + 1 - 5);
       s5[n5 - test.i + 1 - 5] = '\0';
       float dE = ((float)(access_s1[n5 - test.i + 1 - 5][pos])) * 0.01;
-      printf(
+      snoop_printf(snoop,
         "%s %3d,%-3d;%3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f + %5.2f + %5.2f + 4.10) (%5.2f)\n%s&%s\n",
         test.structure,
         pos - (n5 - test.i),
@@ -3115,121 +3147,111 @@ find_max_snoop_XS(const char  *s1,
 }
 
 
-snoopT
-snoopfold_XS(const char *s1,
-             const char *s2,
-             const int  **access_s1,
-             const int  pos_i,
-             const int  pos_j,
-             const int  penalty,
-             const int  threshloop,
-             const int  threshLE,
-             const int  threshRE,
-             const int  threshDE,
-             const int  threshD,
-             const int  half_stem,
-             const int  max_half_stem,
-             const int  min_s2,
-             const int  max_s2,
-             const int  min_s1,
-             const int  max_s1,
-             const int  min_d1,
-             const int  min_d2,
-             const int  fullStemEnergy)
+PUBLIC snoopT
+vrna_snoopfold_XS(vrna_snoop_t  *snoop,
+                  const char    *s1,
+                  const char    *s2,
+                  const int     **access_s1,
+                  const int     pos_i,
+                  const int     pos_j,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshD,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2,
+                  const int     fullStemEnergy)
 {
   /*   int Eminj, Emin_l; */
-  int       a, b, i, j, Emin = INF, a_min = 0, b_min = 0;
-  char      *struc;
-  snoopT    mfe;
-  int       *indx;
-  int       *mLoop;
-  int       *cLoop;
-  folden    **foldlist, **foldlist_XS;
-  int       Duplex_El, Duplex_Er;
-  int       Loop_D;
-  int       u;
-  int       Loop_E;
-  vrna_md_t md;
+  int     a, b, i, j, Emin = INF, a_min = 0, b_min = 0;
+  char    *struc;
+  snoopT  mfe;
+  int     *indx;
+  int     *mLoop;
+  int     *cLoop;
+  folden  **foldlist, **foldlist_XS;
+  int     Duplex_El, Duplex_Er;
+  int     Loop_D;
+  int     u;
+  int     Loop_E;
 
   Duplex_El = 0;
   Duplex_Er = 0;
   Loop_E    = 0, Loop_D = 0;
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
-
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    snoupdate_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  c = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  r = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  for (i = 0; i <= n1; i++) {
-    c[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    r[i]  = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
-    for (j = n2; j > -1; j--) {
-      c[i][j] = INF;
-      r[i][j] = INF;
+  snoop->n1 = (int)strlen(s1);
+  snoop->n2 = (int)strlen(s2);
+
+  snoop->c  = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  snoop->r  = (int **)vrna_alloc(sizeof(int *) * (snoop->n1 + 1));
+  for (i = 0; i <= snoop->n1; i++) {
+    snoop->c[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    snoop->r[i] = (int *)vrna_alloc(sizeof(int) * (snoop->n2 + 1));
+    for (j = snoop->n2; j > -1; j--) {
+      snoop->c[i][j]  = INF;
+      snoop->r[i][j]  = INF;
     }
   }
-  encode_seqs(s1, s2);
-  i = n1 - 5;
+  encode_seqs(snoop, s1, s2);
+  i = snoop->n1 - 5;
   j = pos_j;
   /* printf("tar: %s\nsno: %s\n ", s1, s2); */
   /* printf("pos_i %d pos_j %d\n", pos_i, pos_j); */
   /* printf("type %d n1 %d n2 %d S1[n1] %d S2[n2] %d", pair[S1[i]][S2[j]], n1, n2, S1[n1], S2[n2]); */
   int type, type2, E, p, q;
-  r[i][j] = P->DuplexInit;
+  snoop->r[i][j] = snoop->P->DuplexInit;
   /* r[i][j] += P->dangle3[rtype[type]][SS1[i+1]] + P->dangle5[rtype[type]][SS2[j-1]];  */
 
-  if (pair[S1[i]][S2[j]] > 2)
-    r[i][j] += P->TerminalAU;
+  if (snoop->pair[snoop->S1[i]][snoop->S2[j]] > 2)
+    snoop->r[i][j] += snoop->P->TerminalAU;
 
   for (a = i - 1; a > 0; a--) {
     /* i-1 */
-    r[a + 1][0] = INF;
-    for (b = j + 1; b <= n2 - min_d2; b++) {
+    snoop->r[a + 1][0] = INF;
+    for (b = j + 1; b <= snoop->n2 - min_d2; b++) {
       /* j+1 */
-      r[a][b] = INF;
-      type    = pair[S1[a]][S2[b]];
+      snoop->r[a][b]  = INF;
+      type            = snoop->pair[snoop->S1[a]][snoop->S2[b]];
       if (!type)
         continue;
 
-      if (S1[a + 1] == 4) {
+      if (snoop->S1[a + 1] == 4) {
         folden *temp;
         temp = foldlist_XS[b - 1];
         while (temp->next) {
           int k = temp->k;
-          if (pair[S1[a + 3]][S2[k - 1]] && k < max_s1 && k > min_s1 &&
-              k > n2 - max_s2 - max_half_stem &&
-              k < n2 - min_s2 - half_stem /*&& r[a+3][k-1] + access_s1[i-(a+3)+1][pos_i] < 411*/)                                                                                          /* remove last condition last condition is to check if the interaction is stable enough */
-            c[a][b] = MIN2(c[a][b], r[a + 3][k - 1] + temp->energy);
+          if (snoop->pair[snoop->S1[a + 3]][snoop->S2[k - 1]] && k < max_s1 && k > min_s1 &&
+              k > snoop->n2 - max_s2 - max_half_stem &&
+              k < snoop->n2 - min_s2 - half_stem /*&& r[a+3][k-1] + access_s1[i-(a+3)+1][pos_i] < 411*/)                                                                                          /* remove last condition last condition is to check if the interaction is stable enough */
+            snoop->c[a][b] = MIN2(snoop->c[a][b], snoop->r[a + 3][k - 1] + temp->energy);
 
           temp = temp->next;
         }
       }
 
-      if (S1[a + 2] == 4) {
+      if (snoop->S1[a + 2] == 4) {
         folden *temp;
         temp = foldlist_XS[b - 1];
         while (temp->next) {
           int k = temp->k;
-          if (pair[S1[a + 4]][S2[k - 1]] && k < max_s1 && k > min_s1 &&
-              k > n2 - max_s2 - max_half_stem &&
-              k < n2 - min_s2 - half_stem /*&& r[a+4][k-1] + access_s1[i-(a+4)+1][pos_i] < 411 */)                                                                                            /* remove last condition  */
-            c[a][b] = MIN2(c[a][b], r[a + 4][k - 1] + temp->energy);
+          if (snoop->pair[snoop->S1[a + 4]][snoop->S2[k - 1]] && k < max_s1 && k > min_s1 &&
+              k > snoop->n2 - max_s2 - max_half_stem &&
+              k < snoop->n2 - min_s2 - half_stem /*&& r[a+4][k-1] + access_s1[i-(a+4)+1][pos_i] < 411 */)                                                                                            /* remove last condition  */
+            snoop->c[a][b] = MIN2(snoop->c[a][b], snoop->r[a + 4][k - 1] + temp->energy);
 
           temp = temp->next;
         }
       }
 
-      for (p = a + 1; p < n1 && (p - a) < MAXLOOP_L; p++) {
+      for (p = a + 1; p < snoop->n1 && (p - a) < MAXLOOP_L; p++) {
         /* p < n1 */
         for (q = b - 1; q > 1; q--) {
           /* q > 1 */
@@ -3239,7 +3261,7 @@ snoopfold_XS(const char *s1,
           if (abs((p - a) - (b - q)) >= ASS)
             continue;
 
-          type2 = pair[S1[p]][S2[q]];
+          type2 = snoop->pair[snoop->S1[p]][snoop->S2[q]];
           if (!type2)
             continue;
 
@@ -3247,19 +3269,19 @@ snoopfold_XS(const char *s1,
             E_IntLoop(p - a - 1,
                       b - q - 1,
                       type2,
-                      rtype[type],
-                      SS1[a + 1],
-                      SS2[b - 1],
-                      SS1[p - 1],
-                      SS2[q + 1],
-                      P);
-          c[a][b] = MIN2(c[a][b], c[p][q] + E);
-          r[a][b] = MIN2(r[a][b], r[p][q] + E);
+                      snoop->rtype[type],
+                      snoop->SS1[a + 1],
+                      snoop->SS2[b - 1],
+                      snoop->SS1[p - 1],
+                      snoop->SS2[q + 1],
+                      snoop->P);
+          snoop->c[a][b]  = MIN2(snoop->c[a][b], snoop->c[p][q] + E);
+          snoop->r[a][b]  = MIN2(snoop->r[a][b], snoop->r[p][q] + E);
         }
       }
-      E = c[a][b];
+      E = snoop->c[a][b];
       if (type > 2)
-        E += P->TerminalAU;
+        E += snoop->P->TerminalAU;
 
       /*        E +=P->dangle5[rtype[type]][SS1[i+1]]; */
       /* E +=P->dangle5[rtype[type]][SS2[j-1]];  */
@@ -3272,27 +3294,28 @@ snoopfold_XS(const char *s1,
     }
   }
   if (Emin > 0) {
-    printf("no target found under the constraints chosen\n");
-    for (i = 0; i <= n1; i++) {
-      free(r[i]);
-      free(c[i]);
+    snoop_printf(snoop, "no target found under the constraints chosen\n");
+    for (i = 0; i <= snoop->n1; i++) {
+      free(snoop->r[i]);
+      free(snoop->c[i]);
     }
-    free(c);
-    free(r);
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    free(snoop->c);
+    free(snoop->r);
+    free(snoop->S1);
+    free(snoop->S2);
+    free(snoop->SS1);
+    free(snoop->SS2);
     mfe.energy = INF;
     return mfe;
   }
 
-  type2 = pair[S1[a_min]][S2[b_min]];
+  type2 = snoop->pair[snoop->S1[a_min]][snoop->S2[b_min]];
   if (type2 > 2)
-    Emin += P->TerminalAU;
+    Emin += snoop->P->TerminalAU;
 
   mfe.energy  = ((float)(Emin)) / 100;
-  struc       = snoop_backtrack_XS(a_min,
+  struc       = snoop_backtrack_XS(snoop,
+                                   a_min,
                                    b_min,
                                    s2,
                                    &Duplex_El,
@@ -3330,28 +3353,29 @@ snoopfold_XS(const char *s1,
 
 
 PRIVATE char *
-snoop_backtrack_XS(int        i,
-                   int        j,
-                   const char *snoseq,
-                   int        *Duplex_El,
-                   int        *Duplex_Er,
-                   int        *Loop_E,
-                   int        *Loop_D,
-                   int        *u,
-                   const int  penalty,
-                   const int  threshloop,
-                   const int  threshLE,
-                   const int  threshRE,
-                   const int  threshDE,
-                   const int  threshD,
-                   const int  half_stem,
-                   const int  max_half_stem,
-                   const int  min_s2,
-                   const int  max_s2,
-                   const int  min_s1,
-                   const int  max_s1,
-                   const int  min_d1,
-                   const int  min_d2)
+snoop_backtrack_XS(vrna_snoop_t *snoop,
+                   int          i,
+                   int          j,
+                   const char   *snoseq,
+                   int          *Duplex_El,
+                   int          *Duplex_Er,
+                   int          *Loop_E,
+                   int          *Loop_D,
+                   int          *u,
+                   const int    penalty,
+                   const int    threshloop,
+                   const int    threshLE,
+                   const int    threshRE,
+                   const int    threshDE,
+                   const int    threshD,
+                   const int    half_stem,
+                   const int    max_half_stem,
+                   const int    min_s2,
+                   const int    max_s2,
+                   const int    min_s1,
+                   const int    max_s1,
+                   const int    min_d1,
+                   const int    min_d2)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
@@ -3360,24 +3384,24 @@ snoop_backtrack_XS(int        i,
   char    *st1, *st2, *struc;
   char    *struc_loop;
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n1 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n2 + 1));
+  st1 = (char *)vrna_alloc(sizeof(char) * (snoop->n1 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (snoop->n2 + 1));
   int     *indx;
   int     *mLoop;
   int     *cLoop;
   folden  **foldlist, **foldlist_XS;
-  type = pair[S1[i]][S2[j]];
+  type = snoop->pair[snoop->S1[i]][snoop->S2[j]];
   snoexport_fold_arrays(&indx, &mLoop, &cLoop, &foldlist, &foldlist_XS);
   i0  = i;
   j0  = j;
   /*   i0=MAX2(i,1); j0=MIN2(j+1,n2); */
-  while (i <= n1 && j >= 1) {
+  while (i <= snoop->n1 && j >= 1) {
     if (!traced_c) {
-      E           = c[i][j];
+      E           = snoop->c[i][j];
       traced      = 0;
       st1[i]      = '<';
       st2[j - 1]  = '>';
-      type        = pair[S1[i]][S2[j]];
+      type        = snoop->pair[snoop->S1[i]][snoop->S2[j]];
       if (!type)
         vrna_message_error("backtrack failed in fold duplex c");
 
@@ -3390,13 +3414,13 @@ snoop_backtrack_XS(int        i,
           if (abs(k - i - j + l) >= ASS)
             continue;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = snoop->pair[snoop->S1[k]][snoop->S2[l]];
           if (!type2)
             continue;
 
-          LE = E_IntLoop(k - i - 1, j - l - 1, type2, rtype[type],
-                         SS1[i + 1], SS2[j - 1], SS1[k - 1], SS2[l + 1], P);
-          if (E == c[k][l] + LE) {
+          LE = E_IntLoop(k - i - 1, j - l - 1, type2, snoop->rtype[type],
+                         snoop->SS1[i + 1], snoop->SS2[j - 1], snoop->SS1[k - 1], snoop->SS2[l + 1], snoop->P);
+          if (E == snoop->c[k][l] + LE) {
             traced      = 1;
             i           = k;
             j           = l;
@@ -3408,14 +3432,14 @@ snoop_backtrack_XS(int        i,
           break;
       }
       if (!traced) {
-        if (S1[i + 1] == 4) {
+        if (snoop->S1[i + 1] == 4) {
           folden *temp;
           temp = foldlist_XS[j - 1];
           while (temp->next) {
             int k = temp->k;
-            if (pair[S1[i + 3]][S2[k - 1]] && k < max_s1 && k > min_s1 &&
-                k > n2 - max_s2 - max_half_stem && k < n2 - min_s2 - half_stem) {
-              if (E == r[i + 3][k - 1] + temp->energy) {
+            if (snoop->pair[snoop->S1[i + 3]][snoop->S2[k - 1]] && k < max_s1 && k > min_s1 &&
+                k > snoop->n2 - max_s2 - max_half_stem && k < snoop->n2 - min_s2 - half_stem) {
+              if (E == snoop->r[i + 3][k - 1] + temp->energy) {
                 *Loop_E     = temp->energy;
                 st1[i + 1]  = '|';
                 st1[i + 2]  = '.';
@@ -3443,15 +3467,15 @@ snoop_backtrack_XS(int        i,
           }
         }
 
-        if (S1[i + 2] == 4) {
+        if (snoop->S1[i + 2] == 4) {
           /* introduce structure from RNAfold */
           folden *temp;
           temp = foldlist_XS[j - 1];
           while (temp->next) {
             int k = temp->k;
-            if (pair[S1[i + 4]][S2[k - 1]] && k < max_s1 && k > min_s1 &&
-                k > n2 - max_s2 - max_half_stem && k < n2 - min_s2 - half_stem) {
-              if (E == r[i + 4][k - 1] + temp->energy) {
+            if (snoop->pair[snoop->S1[i + 4]][snoop->S2[k - 1]] && k < max_s1 && k > min_s1 &&
+                k > snoop->n2 - max_s2 - max_half_stem && k < snoop->n2 - min_s2 - half_stem) {
+              if (E == snoop->r[i + 4][k - 1] + temp->energy) {
                 *Loop_E     = temp->energy;
                 st1[i + 2]  = '|';
                 st1[i + 1]  = st1[i + 3] = '.';
@@ -3481,11 +3505,11 @@ snoop_backtrack_XS(int        i,
       } /* traced? */
     }   /* traced_r? */
     else {
-      E           = r[i][j];
+      E           = snoop->r[i][j];
       traced      = 0;
       st1[i]      = '<';
       st2[j - 1]  = '>';
-      type        = pair[S1[i]][S2[j]];
+      type        = snoop->pair[snoop->S1[i]][snoop->S2[j]];
       if (!type)
         vrna_message_error("backtrack failed in fold duplex r");
 
@@ -3498,13 +3522,13 @@ snoop_backtrack_XS(int        i,
           if (abs(k - i - j + l) >= ASS)
             continue;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = snoop->pair[snoop->S1[k]][snoop->S2[l]];
           if (!type2)
             continue;
 
-          LE = E_IntLoop(k - i - 1, j - l - 1, type2, rtype[type],
-                         SS1[i + 1], SS2[j - 1], SS1[k - 1], SS2[l + 1], P);
-          if (E == r[k][l] + LE) {
+          LE = E_IntLoop(k - i - 1, j - l - 1, type2, snoop->rtype[type],
+                         snoop->SS1[i + 1], snoop->SS2[j - 1], snoop->SS1[k - 1], snoop->SS2[l + 1], snoop->P);
+          if (E == snoop->r[k][l] + LE) {
             traced      = 1;
             i           = k;
             j           = l;
@@ -3521,11 +3545,11 @@ snoop_backtrack_XS(int        i,
       /*       if (i>1)    {E -= P->dangle5[type][SS1[i-1]]; *Duplex_El +=P->dangle5[type][SS1[i-1]];} */
       /*       if (j<n2)   {E -= P->dangle3[type][SS2[j+1]]; *Duplex_El +=P->dangle3[type][SS2[j+1]];} */
       if (type > 2) {
-        E           -= P->TerminalAU;
-        *Duplex_Er  += P->TerminalAU;
+        E           -= snoop->P->TerminalAU;
+        *Duplex_Er  += snoop->P->TerminalAU;
       }
 
-      if (E != P->DuplexInit)
+      if (E != snoop->P->DuplexInit)
         vrna_message_error("backtrack failed in fold duplex end");
       else
         break;
@@ -3534,9 +3558,9 @@ snoop_backtrack_XS(int        i,
 
 
   /* struc = (char *) vrna_alloc(i0-i+1+j-j0+1+2); */ /* declare final duplex structure */
-  struc = (char *)vrna_alloc(i - i0 + 1 + n2); /* declare final duplex structure */
+  struc = (char *)vrna_alloc(i - i0 + 1 + snoop->n2); /* declare final duplex structure */
   char *struc2;
-  struc2 = (char *)vrna_alloc(n2 + 1);
+  struc2 = (char *)vrna_alloc(snoop->n2 + 1);
   /* char * struct_const; */
 
   for (k = MIN2(i0, 1); k <= i; k++)
@@ -3546,7 +3570,7 @@ snoop_backtrack_XS(int        i,
   /* for (k=j0; k<=j; k++) if (!st2[k-1]) st2[k-1] = struc_loop[k-1];*/ /* '.'; normal */
   /*  char * struct_const; */
   /*  struct_const = (char *) vrna_alloc(sizeof(char)*(n2+1));   */
-  for (k = 1; k <= n2; k++) {
+  for (k = 1; k <= snoop->n2; k++) {
     if (!st2[k - 1])
       st2[k - 1] = struc_loop[k - 1];   /* '.'; */
 
@@ -3560,12 +3584,12 @@ snoop_backtrack_XS(int        i,
     /*      } */
   }
   char  duplexseq_1[j];
-  char  duplexseq_2[n2 - j0 + 2];
-  if (j0 < n2) {
+  char  duplexseq_2[snoop->n2 - j0 + 2];
+  if (j0 < snoop->n2) {
     strncpy(duplexseq_1, snoseq, j - 1);
     strcpy(duplexseq_2, snoseq + j0);
-    duplexseq_1[j - 1]        = '\0';
-    duplexseq_2[n2 - j0 + 1]  = '\0';
+    duplexseq_1[j - 1]              = '\0';
+    duplexseq_2[snoop->n2 - j0 + 1] = '\0';
     duplexT temp;
     temp    = duplexfold(duplexseq_1, duplexseq_2);
     *Loop_D = MIN2(0, -410 + (int)100 * temp.energy);
@@ -3594,16 +3618,16 @@ snoop_backtrack_XS(int        i,
   free(st1);
   free(st2);
 
-  for (i = 0; i <= n1; i++) {
-    free(r[i]);
-    free(c[i]);
+  for (i = 0; i <= snoop->n1; i++) {
+    free(snoop->r[i]);
+    free(snoop->c[i]);
   }
-  free(c);
-  free(r);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  free(snoop->c);
+  free(snoop->r);
+  free(snoop->S1);
+  free(snoop->S2);
+  free(snoop->SS1);
+  free(snoop->SS2);
   /* free_arrays(); */
   return struc;
 }
@@ -3693,26 +3717,27 @@ encode_seq(const char *sequence)
 
 
 PRIVATE void
-encode_seqs(const char  *s1,
-            const char  *s2)
+encode_seqs(vrna_snoop_t  *snoop,
+            const char    *s1,
+            const char    *s2)
 {
   unsigned int i, l;
 
-  l   = strlen(s1);
-  S1  = encode_seq(s1);
-  SS1 = (short *)vrna_alloc(sizeof(short) * (l + 1));
+  l           = strlen(s1);
+  snoop->S1   = encode_seq(s1);
+  snoop->SS1  = (short *)vrna_alloc(sizeof(short) * (l + 1));
   /* SS1 exists only for the special X K and I bases and energy_set!=0 */
 
   for (i = 1; i <= l; i++)  /* make numerical encoding of sequence */
-    SS1[i] = alias[S1[i]];  /* for mismatches of nostandard bases */
+    snoop->SS1[i] = snoop->alias[snoop->S1[i]];  /* for mismatches of nostandard bases */
 
-  l   = strlen(s2);
-  S2  = encode_seq(s2);
-  SS2 = (short *)vrna_alloc(sizeof(short) * (l + 1));
+  l           = strlen(s2);
+  snoop->S2   = encode_seq(s2);
+  snoop->SS2  = (short *)vrna_alloc(sizeof(short) * (l + 1));
   /* SS2 exists only for the special X K and I bases and energy_set!=0 */
 
   for (i = 1; i <= l; i++)  /* make numerical encoding of sequence */
-    SS2[i] = alias[S2[i]];  /* for mismatches of nostandard bases */
+    snoop->SS2[i] = snoop->alias[snoop->S2[i]];  /* for mismatches of nostandard bases */
 }
 
 
@@ -3734,3 +3759,494 @@ compare(const void  *sub1,
 
   return ((snoopT *)sub1)->j - ((snoopT *)sub2)->j;
 }
+
+
+PRIVATE void
+snoop_printf(vrna_snoop_t *snoop,
+             const char   *format,
+             ...)
+{
+  va_list args;
+
+  va_start(args, format);
+
+  if (snoop->output)
+    vrna_cstr_vprintf(snoop->output, format, args);
+  else
+    vprintf(format, args);
+
+  va_end(args);
+}
+
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
+/*
+ *###########################################
+ *# deprecated functions below              #
+ *###########################################
+ */
+PUBLIC snoopT
+alisnoopfold(const char **s1,
+             const char **s2,
+             const int  penalty,
+             const int  threshloop,
+             const int  threshLE,
+             const int  threshRE,
+             const int  threshDE,
+             const int  threshD,
+             const int  half_stem,
+             const int  max_half_stem,
+             const int  min_s2,
+             const int  max_s2,
+             const int  min_s1,
+             const int  max_s1,
+             const int  min_d1,
+             const int  min_d2)
+{
+  return vrna_alisnoopfold(snoop_backward_compat(),
+                           s1,
+                           s2,
+                           penalty,
+                           threshloop,
+                           threshLE,
+                           threshRE,
+                           threshDE,
+                           threshD,
+                           half_stem,
+                           max_half_stem,
+                           min_s2,
+                           max_s2,
+                           min_s1,
+                           max_s1,
+                           min_d1,
+                           min_d2);
+}
+
+
+PUBLIC snoopT *
+alisnoop_subopt(const char  **s1,
+                const char  **s2,
+                int         delta,
+                int         w,
+                const int   penalty,
+                const int   threshloop,
+                const int   threshLE,
+                const int   threshRE,
+                const int   threshDE,
+                const int   threshTE,
+                const int   threshSE,
+                const int   threshD,
+                const int   distance,
+                const int   half_stem,
+                const int   max_half_stem,
+                const int   min_s2,
+                const int   max_s2,
+                const int   min_s1,
+                const int   max_s1,
+                const int   min_d1,
+                const int   min_d2)
+{
+  return vrna_alisnoop_subopt(snoop_backward_compat(),
+                              s1,
+                              s2,
+                              delta,
+                              w,
+                              penalty,
+                              threshloop,
+                              threshLE,
+                              threshRE,
+                              threshDE,
+                              threshTE,
+                              threshSE,
+                              threshD,
+                              distance,
+                              half_stem,
+                              max_half_stem,
+                              min_s2,
+                              max_s2,
+                              min_s1,
+                              max_s1,
+                              min_d1,
+                              min_d2);
+}
+
+
+PUBLIC void
+Lsnoop_subopt(const char  *s1,
+              const char  *s2,
+              int         delta,
+              int         w,
+              const int   penalty,
+              const int   threshloop,
+              const int   threshLE,
+              const int   threshRE,
+              const int   threshDE,
+              const int   threshTE,
+              const int   threshSE,
+              const int   threshD,
+              const int   distance,
+              const int   half_stem,
+              const int   max_half_stem,
+              const int   min_s2,
+              const int   max_s2,
+              const int   min_s1,
+              const int   max_s1,
+              const int   min_d1,
+              const int   min_d2,
+              const int   alignment_length,
+              const char  *name,
+              const int   fullStemEnergy)
+{
+  vrna_Lsnoop_subopt(snoop_backward_compat(),
+                     s1,
+                     s2,
+                     delta,
+                     w,
+                     penalty,
+                     threshloop,
+                     threshLE,
+                     threshRE,
+                     threshDE,
+                     threshTE,
+                     threshSE,
+                     threshD,
+                     distance,
+                     half_stem,
+                     max_half_stem,
+                     min_s2,
+                     max_s2,
+                     min_s1,
+                     max_s1,
+                     min_d1,
+                     min_d2,
+                     alignment_length,
+                     name,
+                     fullStemEnergy);
+}
+
+
+PUBLIC void
+Lsnoop_subopt_list(const char *s1,
+                   const char *s2,
+                   int        delta,
+                   int        w,
+                   const int  penalty,
+                   const int  threshloop,
+                   const int  threshLE,
+                   const int  threshRE,
+                   const int  threshDE,
+                   const int  threshTE,
+                   const int  threshSE,
+                   const int  threshD,
+                   const int  distance,
+                   const int  half_stem,
+                   const int  max_half_stem,
+                   const int  min_s2,
+                   const int  max_s2,
+                   const int  min_s1,
+                   const int  max_s1,
+                   const int  min_d1,
+                   const int  min_d2,
+                   const int  alignment_length,
+                   const char *name,
+                   const int  fullStemEnergy)
+{
+  vrna_Lsnoop_subopt_list(snoop_backward_compat(),
+                          s1,
+                          s2,
+                          delta,
+                          w,
+                          penalty,
+                          threshloop,
+                          threshLE,
+                          threshRE,
+                          threshDE,
+                          threshTE,
+                          threshSE,
+                          threshD,
+                          distance,
+                          half_stem,
+                          max_half_stem,
+                          min_s2,
+                          max_s2,
+                          min_s1,
+                          max_s1,
+                          min_d1,
+                          min_d2,
+                          alignment_length,
+                          name,
+                          fullStemEnergy);
+}
+
+
+PUBLIC snoopT
+snoopfold(const char  *s1,
+          const char  *s2,
+          const int   penalty,
+          const int   threshloop,
+          const int   threshLE,
+          const int   threshRE,
+          const int   threshDE,
+          const int   threshD,
+          const int   half_stem,
+          const int   max_half_stem,
+          const int   min_s2,
+          const int   max_s2,
+          const int   min_s1,
+          const int   max_s1,
+          const int   min_d1,
+          const int   min_d2,
+          const int   fullStemEnergy)
+{
+  return vrna_snoopfold(snoop_backward_compat(),
+                        s1,
+                        s2,
+                        penalty,
+                        threshloop,
+                        threshLE,
+                        threshRE,
+                        threshDE,
+                        threshD,
+                        half_stem,
+                        max_half_stem,
+                        min_s2,
+                        max_s2,
+                        min_s1,
+                        max_s1,
+                        min_d1,
+                        min_d2,
+                        fullStemEnergy);
+}
+
+
+PUBLIC snoopT *
+snoop_subopt(const char *s1,
+             const char *s2,
+             int        delta,
+             int        w,
+             const int  penalty,
+             const int  threshloop,
+             const int  threshLE,
+             const int  threshRE,
+             const int  threshDE,
+             const int  threshTE,
+             const int  threshSE,
+             const int  threshD,
+             const int  distance,
+             const int  half_stem,
+             const int  max_half_stem,
+             const int  min_s2,
+             const int  max_s2,
+             const int  min_s1,
+             const int  max_s1,
+             const int  min_d1,
+             const int  min_d2,
+             const int  fullStemEnergy)
+{
+  return vrna_snoop_subopt(snoop_backward_compat(),
+                           s1,
+                           s2,
+                           delta,
+                           w,
+                           penalty,
+                           threshloop,
+                           threshLE,
+                           threshRE,
+                           threshDE,
+                           threshTE,
+                           threshSE,
+                           threshD,
+                           distance,
+                           half_stem,
+                           max_half_stem,
+                           min_s2,
+                           max_s2,
+                           min_s1,
+                           max_s1,
+                           min_d1,
+                           min_d2,
+                           fullStemEnergy);
+}
+
+
+PUBLIC void
+snoop_subopt_XS(const char  *s1,
+                const char  *s2,
+                const int   **access_s1,
+                int         delta,
+                int         w,
+                const int   penalty,
+                const int   threshloop,
+                const int   threshLE,
+                const int   threshRE,
+                const int   threshDE,
+                const int   threshTE,
+                const int   threshSE,
+                const int   threshD,
+                const int   distance,
+                const int   half_stem,
+                const int   max_half_stem,
+                const int   min_s2,
+                const int   max_s2,
+                const int   min_s1,
+                const int   max_s1,
+                const int   min_d1,
+                const int   min_d2,
+                const int   alignment_length,
+                const char  *name,
+                const int   fullStemEnergy)
+{
+  vrna_snoop_subopt_XS(snoop_backward_compat(),
+                       s1,
+                       s2,
+                       access_s1,
+                       delta,
+                       w,
+                       penalty,
+                       threshloop,
+                       threshLE,
+                       threshRE,
+                       threshDE,
+                       threshTE,
+                       threshSE,
+                       threshD,
+                       distance,
+                       half_stem,
+                       max_half_stem,
+                       min_s2,
+                       max_s2,
+                       min_s1,
+                       max_s1,
+                       min_d1,
+                       min_d2,
+                       alignment_length,
+                       name,
+                       fullStemEnergy);
+}
+
+
+PUBLIC void
+Lsnoop_subopt_list_XS(const char  *s1,
+                      const char  *s2,
+                      const int   **access_s1,
+                      int         delta,
+                      int         w,
+                      const int   penalty,
+                      const int   threshloop,
+                      const int   threshLE,
+                      const int   threshRE,
+                      const int   threshDE,
+                      const int   threshTE,
+                      const int   threshSE,
+                      const int   threshD,
+                      const int   distance,
+                      const int   half_stem,
+                      const int   max_half_stem,
+                      const int   min_s2,
+                      const int   max_s2,
+                      const int   min_s1,
+                      const int   max_s1,
+                      const int   min_d1,
+                      const int   min_d2,
+                      const int   alignment_length,
+                      const char  *name,
+                      const int   fullStemEnergy)
+{
+  vrna_Lsnoop_subopt_list_XS(snoop_backward_compat(),
+                             s1,
+                             s2,
+                             access_s1,
+                             delta,
+                             w,
+                             penalty,
+                             threshloop,
+                             threshLE,
+                             threshRE,
+                             threshDE,
+                             threshTE,
+                             threshSE,
+                             threshD,
+                             distance,
+                             half_stem,
+                             max_half_stem,
+                             min_s2,
+                             max_s2,
+                             min_s1,
+                             max_s1,
+                             min_d1,
+                             min_d2,
+                             alignment_length,
+                             name,
+                             fullStemEnergy);
+}
+
+
+PUBLIC snoopT
+snoopfold_XS(const char *s1,
+             const char *s2,
+             const int  **access_s1,
+             const int  pos_i,
+             const int  pos_j,
+             const int  penalty,
+             const int  threshloop,
+             const int  threshLE,
+             const int  threshRE,
+             const int  threshDE,
+             const int  threshD,
+             const int  half_stem,
+             const int  max_half_stem,
+             const int  min_s2,
+             const int  max_s2,
+             const int  min_s1,
+             const int  max_s1,
+             const int  min_d1,
+             const int  min_d2,
+             const int  fullStemEnergy)
+{
+  return vrna_snoopfold_XS(snoop_backward_compat(),
+                           s1,
+                           s2,
+                           access_s1,
+                           pos_i,
+                           pos_j,
+                           penalty,
+                           threshloop,
+                           threshLE,
+                           threshRE,
+                           threshDE,
+                           threshD,
+                           half_stem,
+                           max_half_stem,
+                           min_s2,
+                           max_s2,
+                           min_s1,
+                           max_s1,
+                           min_d1,
+                           min_d2,
+                           fullStemEnergy);
+}
+
+
+/*
+ *  As before, the energy parameters are only updated when the temperature changes
+ */
+PRIVATE vrna_snoop_t *
+snoop_backward_compat(void)
+{
+  vrna_md_t md;
+
+  if ((!backward_compat_snoop) ||
+      (fabs(backward_compat_snoop->P->temperature - temperature) > 1e-6)) {
+    snoupdate_fold_params();
+    vrna_snoop_free(backward_compat_snoop);
+    set_model_details(&md);
+    backward_compat_snoop = vrna_snoop_init(&md);
+  }
+
+  return backward_compat_snoop;
+}
+
+
+
+#endif
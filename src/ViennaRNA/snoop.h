@@ -2,6 +2,336 @@
 #define VIENNA_RNA_PACKAGE_SNOOP_H
 
 #include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/datastructures/char_stream.h>
+#include <ViennaRNA/model.h>
+
+/**
+ *  @file     snoop.h
+ *  @ingroup  cofold
+ *  @brief    Functions for snoRNA-RNA interactions
+ */
+
+/**
+ *  @brief  An RNAsnoop interaction engine
+ *
+ *  The engine holds the energy parameters, dynamic programming matrices and
+ *  sequence encodings of a snoRNA-RNA interaction search. An engine may be reused
+ *  for any number of targets, and different engines can be used concurrently, e.g.
+ *  one per thread, to scan several targets against the same snoRNA. Note, that the
+ *  snoRNA stem energies must be computed with snofold() or alisnofold() before,
+ *  which still use global memory, and that the structure plots that some of the
+ *  functions below produce rely on the global #cut_point variable.
+ *
+ *  @see  vrna_snoop_init(), vrna_snoop_free(), vrna_snoop_set_output()
+ */
+typedef struct vrna_snoop_s vrna_snoop_t;
+
+
+/**
+ *  @brief  Create an RNAsnoop interaction engine
+ *
+ *  @param  md  The model details to use, or NULL for default settings
+ *  @return     The engine, to be released by vrna_snoop_free()
+ */
+vrna_snoop_t *
+vrna_snoop_init(const vrna_md_t *md);
+
+
+/**
+ *  @brief  Release an RNAsnoop interaction engine
+ */
+void
+vrna_snoop_free(vrna_snoop_t *snoop);
+
+
+/**
+ *  @brief  Redirect the interactions an RNAsnoop engine reports
+ *
+ *  By default, interactions found by the RNAplex-like scanning functions are
+ *  printed to @p stdout.
+ *
+ *  @param  snoop   The engine
+ *  @param  output  The output stream to write to, or NULL for @p stdout
+ */
+void
+vrna_snoop_set_output(vrna_snoop_t  *snoop,
+                      vrna_cstr_t   output);
+
+
+/**
+ *  @brief  Compute the optimal snoRNA-RNA interaction in RNAduplex manner
+ *
+ *  This is the reentrant version of snoopfold().
+ */
+snoopT
+vrna_snoopfold(vrna_snoop_t *snoop,
+               const char   *s1,
+               const char   *s2,
+               const int    penalty,
+               const int    threshloop,
+               const int    threshLE,
+               const int    threshRE,
+               const int    threshDE,
+               const int    threshD,
+               const int    half_stem,
+               const int    max_half_stem,
+               const int    min_s2,
+               const int    max_s2,
+               const int    min_s1,
+               const int    max_s1,
+               const int    min_d1,
+               const int    min_d2,
+               const int    fullStemEnergy);
+
+
+/**
+ *  @brief  Compute suboptimal snoRNA-RNA interactions in RNAduplex manner
+ *
+ *  This is the reentrant version of snoop_subopt().
+ */
+snoopT *
+vrna_snoop_subopt(vrna_snoop_t  *snoop,
+                  const char    *s1,
+                  const char    *s2,
+                  int           delta,
+                  int           w,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshTE,
+                  const int     threshSE,
+                  const int     threshD,
+                  const int     distance,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2,
+                  const int     fullStemEnergy);
+
+
+/**
+ *  @brief  Compute suboptimal snoRNA-RNA interactions in RNAplex manner
+ *
+ *  This is the reentrant version of Lsnoop_subopt().
+ */
+void
+vrna_Lsnoop_subopt(vrna_snoop_t *snoop,
+                   const char   *s1,
+                   const char   *s2,
+                   int          delta,
+                   int          w,
+                   const int    penalty,
+                   const int    threshloop,
+                   const int    threshLE,
+                   const int    threshRE,
+                   const int    threshDE,
+                   const int    threshTE,
+                   const int    threshSE,
+                   const int    threshD,
+                   const int    distance,
+                   const int    half_stem,
+                   const int    max_half_stem,
+                   const int    min_s2,
+                   const int    max_s2,
+                   const int    min_s1,
+                   const int    max_s1,
+                   const int    min_d1,
+                   const int    min_d2,
+                   const int    alignment_length,
+                   const char   *name,
+                   const int    fullStemEnergy);
+
+
+/**
+ *  @brief  Compute suboptimal snoRNA-RNA interactions in RNAplex manner
+ *
+ *  This is the reentrant version of Lsnoop_subopt_list().
+ */
+void
+vrna_Lsnoop_subopt_list(vrna_snoop_t  *snoop,
+                        const char    *s1,
+                        const char    *s2,
+                        int           delta,
+                        int           w,
+                        const int     penalty,
+                        const int     threshloop,
+                        const int     threshLE,
+                        const int     threshRE,
+                        const int     threshDE,
+                        const int     threshTE,
+                        const int     threshSE,
+                        const int     threshD,
+                        const int     distance,
+                        const int     half_stem,
+                        const int     max_half_stem,
+                        const int     min_s2,
+                        const int     max_s2,
+                        const int     min_s1,
+                        const int     max_s1,
+                        const int     min_d1,
+                        const int     min_d2,
+                        const int     alignment_length,
+                        const char    *name,
+                        const int     fullStemEnergy);
+
+
+/**
+ *  @brief  Compute suboptimal snoRNA-RNA interactions in RNAplex manner, and consider accessibility
+ *
+ *  This is the reentrant version of Lsnoop_subopt_list_XS().
+ */
+void
+vrna_Lsnoop_subopt_list_XS(vrna_snoop_t *snoop,
+                           const char   *s1,
+                           const char   *s2,
+                           const int    **access_s1,
+                           int          delta,
+                           int          w,
+                           const int    penalty,
+                           const int    threshloop,
+                           const int    threshLE,
+                           const int    threshRE,
+                           const int    threshDE,
+                           const int    threshTE,
+                           const int    threshSE,
+                           const int    threshD,
+                           const int    distance,
+                           const int    half_stem,
+                           const int    max_half_stem,
+                           const int    min_s2,
+                           const int    max_s2,
+                           const int    min_s1,
+                           const int    max_s1,
+                           const int    min_d1,
+                           const int    min_d2,
+                           const int    alignment_length,
+                           const char   *name,
+                           const int    fullStemEnergy);
+
+
+/**
+ *  @brief  Compute suboptimal snoRNA-RNA interactions in RNAduplex manner, and consider accessibility
+ *
+ *  This is the reentrant version of snoop_subopt_XS().
+ */
+void
+vrna_snoop_subopt_XS(vrna_snoop_t *snoop,
+                     const char   *s1,
+                     const char   *s2,
+                     const int    **access_s1,
+                     int          delta,
+                     int          w,
+                     const int    penalty,
+                     const int    threshloop,
+                     const int    threshLE,
+                     const int    threshRE,
+                     const int    threshDE,
+                     const int    threshTE,
+                     const int    threshSE,
+                     const int    threshD,
+                     const int    distance,
+                     const int    half_stem,
+                     const int    max_half_stem,
+                     const int    min_s2,
+                     const int    max_s2,
+                     const int    min_s1,
+                     const int    max_s1,
+                     const int    min_d1,
+                     const int    min_d2,
+                     const int    alignment_length,
+                     const char   *name,
+                     const int    fullStemEnergy);
+
+
+/**
+ *  @brief  Compute suboptimal snoRNA-RNA interactions of two alignments
+ *
+ *  This is the reentrant version of alisnoop_subopt().
+ */
+snoopT *
+vrna_alisnoop_subopt(vrna_snoop_t *snoop,
+                     const char   **s1,
+                     const char   **s2,
+                     int          delta,
+                     int          w,
+                     const int    penalty,
+                     const int    threshloop,
+                     const int    threshLE,
+                     const int    threshRE,
+                     const int    threshDE,
+                     const int    threshTE,
+                     const int    threshSE,
+                     const int    threshD,
+                     const int    distance,
+                     const int    half_stem,
+                     const int    max_half_stem,
+                     const int    min_s2,
+                     const int    max_s2,
+                     const int    min_s1,
+                     const int    max_s1,
+                     const int    min_d1,
+                     const int    min_d2);
+
+
+/**
+ *  @brief  Compute the optimal snoRNA-RNA interaction of two alignments
+ *
+ *  This is the reentrant version of alisnoopfold().
+ */
+snoopT
+vrna_alisnoopfold(vrna_snoop_t  *snoop,
+                  const char    **s1,
+                  const char    **s2,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshD,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2);
+
+
+/**
+ *  @brief  Compute the optimal snoRNA-RNA interaction with accessibility information
+ *
+ *  This is the reentrant version of snoopfold_XS().
+ */
+snoopT
+vrna_snoopfold_XS(vrna_snoop_t  *snoop,
+                  const char    *s1,
+                  const char    *s2,
+                  const int     **access_s1,
+                  const int     pos_i,
+                  const int     pos_j,
+                  const int     penalty,
+                  const int     threshloop,
+                  const int     threshLE,
+                  const int     threshRE,
+                  const int     threshDE,
+                  const int     threshD,
+                  const int     half_stem,
+                  const int     max_half_stem,
+                  const int     min_s2,
+                  const int     max_s2,
+                  const int     min_s1,
+                  const int     max_s1,
+                  const int     min_d1,
+                  const int     min_d2,
+                  const int     fullStemEnergy);
+
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
@@ -22,6 +22,7 @@
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/datastructures/lists.h"
+#include "ViennaRNA/datastructures/heap.h"
 #include "ViennaRNA/eval.h"
 #include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/loops/all.h"
@@ -58,16 +59,29 @@ typedef struct {
   LIST  *Intervals;
   int   partial_energy;
   int   is_duplex;
-  /* int best_energy;   */ /* best attainable energy */
+  int   best_energy;        /* best attainable energy */
+  unsigned long order;      /* insertion order into the frontier */
 } STATE;
 
 typedef struct {
-  LIST  *Intervals;
-  LIST  *Stack;
-  int   nopush;
+  LIST                  *Intervals;
+  LIST                  *Stack;
+  int                   nopush;
+  vrna_heap_t           Frontier;   /* priority queue of states in best-first mode */
+  unsigned long         pushed;     /* number of states inserted into the frontier */
+  vrna_fold_compound_t  *fc;
 } subopt_env;
 
 
+/* solutions that are held back until they can be released in sorted order */
+struct subopt_buffer {
+  SOLUTION  *list;
+  size_t    num;
+  size_t    size;
+  int       energy;
+};
+
+
 struct old_subopt_dat {
   unsigned long max_sol;
   unsigned long n_sol;
@@ -198,8 +212,42 @@ free_state_node(STATE *node);
 
 
 PRIVATE void
-push_back(LIST  *Stack,
-          STATE *state);
+push_state(subopt_env *env,
+           STATE      *state);
+
+
+PRIVATE void
+push_back(subopt_env  *env,
+          STATE       *state);
+
+
+PRIVATE int
+compare_states(const void *a,
+               const void *b,
+               void       *data);
+
+
+PRIVATE unsigned int
+subopt_backtrack(vrna_fold_compound_t *vc,
+                 int                  delta,
+                 int                  sorted,
+                 unsigned int         max_structures,
+                 vrna_subopt_callback *cb,
+                 void                 *data);
+
+
+PRIVATE void
+buffer_add(struct subopt_buffer *buffer,
+           char                 *structure,
+           float                energy);
+
+
+PRIVATE unsigned int
+buffer_flush(struct subopt_buffer *buffer,
+             int                  sorted,
+             unsigned int         max_structures,
+             vrna_subopt_callback *cb,
+             void                 *data);
 
 
 PRIVATE char *
@@ -215,12 +263,6 @@ compare_en(const void  *solution1,
            const void  *solution2);
 
 
-PRIVATE void
-make_output(SOLUTION  *SL,
-            int       cp,
-            FILE      *fp);
-
-
 PRIVATE void
 repeat(vrna_fold_compound_t *vc,
        int                  i,
@@ -257,12 +299,6 @@ old_subopt_store(const char *structure,
                  void       *data);
 
 
-PRIVATE void
-old_subopt_store_compressed(const char *structure,
-                            float      energy,
-                            void       *data);
-
-
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -463,18 +499,6 @@ push(LIST *list,
 }
 
 
-/* PRIVATE void */
-/* push_stack(STATE *state) { */ /* keep the stack sorted by energy */
-/*   STATE *after, *next; */
-/*   nopush = false; */
-/*   next = after = LST_HEAD(Stack); */
-/*   while ( next = lst_next(next)) { */
-/*     if ( next->best_energy >= state->best_energy ) break; */
-/*     after = next; */
-/*   } */
-/*   lst_insertafter(Stack, state, after); */
-/* } */
-
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void *
@@ -533,14 +557,50 @@ best_attainable_energy(vrna_fold_compound_t *vc,
 /*---------------------------------------------------------------------------*/
 
 PRIVATE void
-push_back(LIST  *Stack,
-          STATE *state)
+push_state(subopt_env *env,
+           STATE      *state)
+{
+  if (env->Frontier) {
+    /* keep the frontier ordered by the best energy attainable from each state */
+    state->best_energy  = best_attainable_energy(env->fc, state);
+    state->order        = env->pushed++;
+    vrna_heap_insert(env->Frontier, state);
+  } else {
+    push(env->Stack, state);
+  }
+}
+
+
+PRIVATE void
+push_back(subopt_env  *env,
+          STATE       *state)
 {
-  push(Stack, copy_state(state));
+  push_state(env, copy_state(state));
   return;
 }
 
 
+PRIVATE int
+compare_states(const void *a,
+               const void *b,
+               void       *data)
+{
+  const STATE *s1, *s2;
+
+  s1  = (const STATE *)a;
+  s2  = (const STATE *)b;
+
+  if (s1->best_energy != s2->best_energy)
+    return (s1->best_energy < s2->best_energy) ? -1 : 1;
+
+  /* among equally good states, expand the most recent one first to keep the frontier small */
+  if (s1->order != s2->order)
+    return (s1->order > s2->order) ? -1 : 1;
+
+  return 0;
+}
+
+
 /*---------------------------------------------------------------------------*/
 
 PRIVATE char *
@@ -583,27 +643,6 @@ compare_en(const void  *solution1,
 }
 
 
-/*---------------------------------------------------------------------------*/
-
-PRIVATE void
-make_output(SOLUTION  *SL,
-            int       cp,
-            FILE      *fp)                                /* prints stuff */
-{
-  SOLUTION *sol;
-
-  for (sol = SL; sol->structure != NULL; sol++) {
-    char *e_string  = vrna_strdup_printf(" %6.2f", sol->energy);
-    char *ss        = vrna_db_unpack(sol->structure);
-    char *s         = vrna_cut_point_insert(ss, cp);
-    print_structure(fp, s, e_string);
-    free(s);
-    free(ss);
-    free(e_string);
-  }
-}
-
-
 PRIVATE STATE *
 derive_new_state(int    i,
                  int    j,
@@ -632,7 +671,7 @@ fork_state(int        i,
 {
   STATE *s_new = derive_new_state(i, j, s, e, flag);
 
-  push(env->Stack, s_new);
+  push_state(env, s_new);
   env->nopush = false;
 }
 
@@ -650,7 +689,7 @@ fork_int_state(int        i,
 
   make_pair(i, j, s_new);
   make_pair(p, q, s_new);
-  push(env->Stack, s_new);
+  push_state(env, s_new);
   env->nopush = false;
 }
 
@@ -667,7 +706,7 @@ fork_state_pair(int         i,
   new_state = copy_state(s);
   make_pair(i, j, new_state);
   new_state->partial_energy += e;
-  push(env->Stack, new_state);
+  push_state(env, new_state);
   env->nopush = false;
 }
 
@@ -700,7 +739,7 @@ fork_two_states_pair(int        i,
   make_pair(i, j, new_state);
   new_state->partial_energy += e;
 
-  push(env->Stack, new_state);
+  push_state(env, new_state);
   env->nopush = false;
 }
 
@@ -733,7 +772,7 @@ fork_two_states(int         i,
 
   new_state->partial_energy += e;
 
-  push(env->Stack, new_state);
+  push_state(env, new_state);
   env->nopush = false;
 }
 
@@ -781,41 +820,19 @@ vrna_subopt(vrna_fold_compound_t  *vc,
       vrna_mx_mfe_free(vc);
     }
 
-    cb = old_subopt_store;
-
-    if (fp)
-      cb = (sorted) ? old_subopt_store_compressed : old_subopt_print;
-
-    /* call subopt() */
-    vrna_subopt_cb(vc, delta, cb, (void *)&data);
+    cb = (fp) ? old_subopt_print : old_subopt_store;
 
-    if (sorted) {
-      /* sort structures by energy */
-      if (data.n_sol > 0) {
-        int (*compare_fun)(const void *a, const void *b);
-
-        switch (sorted) {
-          case VRNA_SORT_BY_ENERGY_ASC:
-            compare_fun = compare_en;
-            break;
-
-          default: /* a.k.a. VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC */
-            compare_fun = compare;
-            break;
-        }
-
-        qsort(data.SolutionList, data.n_sol - 1, sizeof(SOLUTION), compare_fun);
-      }
-
-      if (fp)
-        make_output(data.SolutionList, vc->cutpoint, fp);
-    }
+    /*
+     *  call subopt(), sorted output is already produced in
+     *  order, so structures can be printed right away
+     */
+    if (sorted)
+      vrna_subopt_sorted_cb(vc, delta, sorted, 0, cb, (void *)&data);
+    else
+      vrna_subopt_cb(vc, delta, cb, (void *)&data);
 
     if (fp) {
-      /* we've printed everything -- free solutions */
-      SOLUTION *sol;
-      for (sol = data.SolutionList; sol->structure != NULL; sol++)
-        free(sol->structure);
+      /* we've printed everything -- nothing has been stored */
       free(data.SolutionList);
       data.SolutionList = NULL;
     }
@@ -831,20 +848,48 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
                vrna_subopt_callback *cb,
                void                 *data)
 {
-  subopt_env    *env;
-  STATE         *state;
-  INTERVAL      *interval;
-  unsigned int  *so, *ss, *se;
-  int           maxlevel, count, partial_energy, old_dangles, logML, dangle_model, length, circular,
-                threshold;
-  double        structure_energy, min_en, eprint;
-  char          *struc, *structure;
-  float         correction;
-  vrna_param_t  *P;
-  vrna_md_t     *md;
-  int           minimal_energy;
-  int           Fc;
-  int           *f5;
+  (void)subopt_backtrack(vc, delta, VRNA_UNSORTED, 0, cb, data);
+}
+
+
+PUBLIC unsigned int
+vrna_subopt_sorted_cb(vrna_fold_compound_t  *fc,
+                      int                   delta,
+                      int                   sorted,
+                      unsigned int          max_structures,
+                      vrna_subopt_callback  *cb,
+                      void                  *data)
+{
+  if ((!fc) || (!cb))
+    return 0;
+
+  return subopt_backtrack(fc, delta, sorted, max_structures, cb, data);
+}
+
+
+PRIVATE unsigned int
+subopt_backtrack(vrna_fold_compound_t *vc,
+                 int                  delta,
+                 int                  sorted,
+                 unsigned int         max_structures,
+                 vrna_subopt_callback *cb,
+                 void                 *data)
+{
+  subopt_env            *env;
+  STATE                 *state;
+  INTERVAL              *interval;
+  unsigned int          *so, *ss, *se, num_out;
+  int                   maxlevel, count, partial_energy, old_dangles, logML, dangle_model, length,
+                        circular, threshold, best_first, buffered, stop;
+  double                structure_energy, min_en, eprint;
+  char                  *struc, *structure;
+  float                 correction;
+  vrna_param_t          *P;
+  vrna_md_t             *md;
+  int                   minimal_energy;
+  int                   Fc;
+  int                   *f5;
+  struct subopt_buffer  buffer;
 
   vrna_fold_compound_prepare(vc, VRNA_OPTION_MFE | VRNA_OPTION_HYBRID);
 
@@ -896,11 +941,34 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
 
   correction = (min_en < 0) ? -0.1 : 0.1;
 
+  /*
+   *  Sorted output is obtained from a best-first traversal of the partial
+   *  structures that are ordered by their best attainable energy. This is
+   *  exact unless the energies are re-evaluated after backtracking, or lonely
+   *  pairs are forbidden, since the MFE arrays then do not bound the energy of
+   *  the intervals we push. In these cases we resort to collecting all
+   *  structures and sort them at the end.
+   */
+  best_first  = (sorted != VRNA_UNSORTED) &&
+                (!md->noLP) &&
+                (!logML) &&
+                (dangle_model != 1) &&
+                (dangle_model != 3);
+  buffered = ((sorted != VRNA_UNSORTED) && (!best_first)) ||
+             (sorted == VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC);
+
+  buffer.list   = NULL;
+  buffer.num    = 0;
+  buffer.size   = 0;
+  buffer.energy = INF;
+
   /* Initialize ------------------------------------------------------------ */
 
   maxlevel        = 0;
   count           = 0;
   partial_energy  = 0;
+  num_out         = 0;
+  stop            = 0;
 
   /* Initialize the stack ------------------------------------------------- */
 
@@ -916,13 +984,17 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
   env->Stack      = NULL;
   env->nopush     = true;
   env->Stack      = make_list();                      /* anchor */
+  env->fc         = vc;
+  env->pushed     = 0;
+  env->Frontier   = (best_first) ?
+                    vrna_heap_init(128, &compare_states, NULL, NULL, NULL) :
+                    NULL;
   env->Intervals  = make_list();                      /* initial state: */
   interval        = make_interval(1, length, 0);      /* interval [1,length,0] */
   push(env->Intervals, interval);
   env->nopush = false;
   state       = make_state(env->Intervals, NULL, partial_energy, 0, length);
-  /* state->best_energy = minimal_energy; */
-  push(env->Stack, state);
+  push_state(env, state);
   env->nopush = false;
 
   /* end initialize ------------------------------------------------------- */
@@ -931,22 +1003,36 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
   while (1) {
     /* forever, til nothing remains on stack */
 
-    maxlevel = (env->Stack->count > maxlevel ? env->Stack->count : maxlevel);
-
-    if (LST_EMPTY(env->Stack)) {
-      /* we are done! clean up and quit */
-      /* fprintf(stderr, "maxlevel: %d\n", maxlevel); */
-
-      lst_kill(env->Stack, free_state_node);
-
-      cb(NULL, 0, data);   /* NULL (last time to call callback function */
-
-      break;
+    if (env->Frontier) {
+      maxlevel  = MAX2((int)vrna_heap_size(env->Frontier), maxlevel);
+      state     = vrna_heap_pop(env->Frontier);
+    } else {
+      maxlevel  = (env->Stack->count > maxlevel ? env->Stack->count : maxlevel);
+      state     = (LST_EMPTY(env->Stack)) ? NULL : pop(env->Stack);
     }
 
-    /* pop the last element ---------------------------------------------- */
+    if (!state) /* we are done! */
+      break;
 
-    state = pop(env->Stack);                       /* current state to work with */
+    /*
+     *  In best-first mode, no state remaining in the frontier can lead to a
+     *  structure with lower energy than the current one. Hence, all held back
+     *  structures of lower energy are final and can be released.
+     */
+    if ((best_first) &&
+        (buffer.num > 0) &&
+        (state->best_energy > buffer.energy)) {
+      num_out += buffer_flush(&buffer,
+                              sorted,
+                              (max_structures) ? max_structures - num_out : 0,
+                              cb,
+                              data);
+
+      if ((max_structures) && (num_out >= max_structures)) {
+        free_state_node(state);
+        break;
+      }
+    }
 
     if (LST_EMPTY(state->Intervals)) {
       int e;
@@ -979,8 +1065,17 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
       density_of_states[e]++;
       if (structure_energy <= eprint) {
         char *outstruct = vrna_cut_point_insert(structure, (vc->strands > 1) ? ss[so[1]] : -1);
-        cb((const char *)outstruct, structure_energy, data);
-        free(outstruct);
+        if (buffered) {
+          buffer_add(&buffer, outstruct, (float)structure_energy);
+          buffer.energy = state->partial_energy;
+        } else {
+          cb((const char *)outstruct, structure_energy, data);
+          free(outstruct);
+          num_out++;
+
+          if ((max_structures) && (num_out >= max_structures))
+            stop = 1;
+        }
       }
 
       free(structure);
@@ -994,10 +1089,93 @@ vrna_subopt_cb(vrna_fold_compound_t *vc,
     }
 
     free_state_node(state);                     /* free the current state */
+
+    if (stop)
+      break;
   } /* end of while (1) */
 
-  /* cleanup memory */
+  /* release any held back structures */
+  if ((buffer.num > 0) &&
+      ((!max_structures) || (num_out < max_structures)))
+    num_out += buffer_flush(&buffer,
+                            sorted,
+                            (max_structures) ? max_structures - num_out : 0,
+                            cb,
+                            data);
+
+  /* fprintf(stderr, "maxlevel: %d\n", maxlevel); */
+
+  /* cleanup memory, the frontier might still be populated if we stopped early */
+  buffer_flush(&buffer, sorted, 0, NULL, NULL);
+  free(buffer.list);
+
+  if (env->Frontier) {
+    while ((state = vrna_heap_pop(env->Frontier)))
+      free_state_node(state);
+
+    vrna_heap_free(env->Frontier);
+  }
+
+  lst_kill(env->Stack, free_state_node);
+
+  cb(NULL, 0, data);   /* NULL (last time to call callback function */
+
   free(env);
+
+  return num_out;
+}
+
+
+PRIVATE void
+buffer_add(struct subopt_buffer *buffer,
+           char                 *structure,
+           float                energy)
+{
+  if (buffer->num == buffer->size) {
+    buffer->size  = (buffer->size) ? 2 * buffer->size : 128;
+    buffer->list  = (SOLUTION *)vrna_realloc(buffer->list, sizeof(SOLUTION) * buffer->size);
+  }
+
+  buffer->list[buffer->num].energy    = energy;
+  buffer->list[buffer->num].structure = structure;
+  buffer->num++;
+}
+
+
+/*
+ *  Sort the held back structures and pass (at most max_structures of)
+ *  them to the callback. Passing a NULL callback simply discards them
+ */
+PRIVATE unsigned int
+buffer_flush(struct subopt_buffer *buffer,
+             int                  sorted,
+             unsigned int         max_structures,
+             vrna_subopt_callback *cb,
+             void                 *data)
+{
+  size_t        i;
+  unsigned int  num;
+
+  num = 0;
+
+  if ((cb) && (buffer->num > 1))
+    qsort(buffer->list,
+          buffer->num,
+          sizeof(SOLUTION),
+          (sorted == VRNA_SORT_BY_ENERGY_ASC) ? &compare_en : &compare);
+
+  for (i = 0; i < buffer->num; i++) {
+    if ((cb) && ((!max_structures) || (num < max_structures))) {
+      cb((const char *)buffer->list[i].structure, buffer->list[i].energy, data);
+      num++;
+    }
+
+    free(buffer->list[i].structure);
+  }
+
+  buffer->num = 0;
+
+  return num;
 }
 
 
@@ -1084,7 +1262,7 @@ scan_interval(vrna_fold_compound_t  *vc,
       state->partial_energy += f5[j];
 
     if (env->nopush) {
-      push_back(env->Stack, state);
+      push_back(env, state);
       env->nopush = false;
     }
 
@@ -1474,7 +1652,7 @@ scan_interval(vrna_fold_compound_t  *vc,
       if (tmp_en <= threshold) {
         new_state                 = derive_new_state(1, 2, state, 0, 0);
         new_state->partial_energy = 0;
-        push(env->Stack, new_state);
+        push_state(env, new_state);
         env->nopush = false;
       }
     }
@@ -1629,7 +1807,7 @@ scan_interval(vrna_fold_compound_t  *vc,
                 /* mmh, we add the energy for closing the multiloop now... */
                 new_state->partial_energy += P->MLclosing;
                 /* next we push our state onto the R stack */
-                push(env->Stack, new_state);
+                push_state(env, new_state);
                 env->nopush = false;
               }
 
@@ -1862,7 +2040,7 @@ scan_interval(vrna_fold_compound_t  *vc,
   }
 
   if (env->nopush) {
-    push_back(env->Stack, state);
+    push_back(env, state);
     env->nopush = false;
   }
 
@@ -1923,7 +2101,7 @@ repeat_gquad(vrna_fold_compound_t *vc,
         new_state->partial_energy += element_energy;
         /* new_state->best_energy =
          * hairpin[unpaired] + element_energy + best_energy; */
-        push(env->Stack, new_state);
+        push_state(env, new_state);
         env->nopush = false;
       }
       free(L);
@@ -2034,7 +2212,7 @@ repeat(vrna_fold_compound_t *vc,
             make_pair(i + 1, j - 1, new_state);
 
             /* new_state->best_energy = new + best_energy; */
-            push(env->Stack, new_state);
+            push_state(env, new_state);
             env->nopush = false;
             if (i == 1 || state->structure[i - 2] != '(' || state->structure[j] != ')')
               /* adding a stack is the only possible structure */
@@ -2235,7 +2413,7 @@ repeat(vrna_fold_compound_t *vc,
           make_pair(i, j, new_state);
 
           /* new_state->best_energy = new + best_energy; */
-          push(env->Stack, new_state);
+          push_state(env, new_state);
           env->nopush = false;
         }
       }
@@ -2289,36 +2467,6 @@ old_subopt_store(const char *structure,
 }
 
 
-PRIVATE void
-old_subopt_store_compressed(const char *structure,
-                            float      energy,
-                            void       *data)
-{
-  struct old_subopt_dat *d = (struct old_subopt_dat *)data;
-
-  /* store solution */
-  if (d->n_sol + 1 == d->max_sol) {
-    d->max_sol      *= 2;
-    d->SolutionList = (SOLUTION *)vrna_realloc(d->SolutionList, d->max_sol * sizeof(SOLUTION));
-  }
-
-  if (structure) {
-    d->SolutionList[d->n_sol].energy      = energy;
-    if (d->cp > 0) {
-      int   cp = d->cp;
-      char  *s = vrna_cut_point_remove(structure, &cp);
-      d->SolutionList[d->n_sol++].structure = vrna_db_pack(s);
-      free(s);
-    } else { 
-      d->SolutionList[d->n_sol++].structure = vrna_db_pack(structure);
-    }
-  } else {
-    d->SolutionList[d->n_sol].energy      = 0;
-    d->SolutionList[d->n_sol++].structure = NULL;
-  }
-}
-
-
 /*###########################################*/
 /*# deprecated functions below              #*/
 /*###########################################*/
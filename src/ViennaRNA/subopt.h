@@ -111,7 +111,11 @@ struct vrna_subopt_sol_s {
   vrna_fold_compound_t *vc=vrna_fold_compound("GGGGGGAAAAAACCCCCC", &md, VRNA_OPTION_DEFAULT);
  *        @endcode
  *
- *  @see vrna_subopt_cb(), vrna_subopt_zuker()
+ *  @note  Sorted output is produced on-the-fly, i.e. structures are written to
+ *         @p fp in order as soon as they are found and do not need to be kept
+ *         in memory, see vrna_subopt_sorted_cb().
+ *
+ *  @see vrna_subopt_cb(), vrna_subopt_sorted_cb(), vrna_subopt_zuker()
  *  @param  vc
  *  @param  delta
  *  @param  sorted  Sort results by energy in ascending order
@@ -164,6 +168,53 @@ vrna_subopt_cb( vrna_fold_compound_t *vc,
                 vrna_subopt_callback *cb,
                 void *data);
 
+/**
+ *  @brief  Generate suboptimal structures in order of increasing free energy
+ *
+ *  Similar to vrna_subopt_cb(), this function passes all secondary structures
+ *  within an energy band @p delta arround the MFE to a user-provided callback
+ *  function. However, the structures are enumerated in a best-first fashion,
+ *  where partial structures are expanded in order of the best free energy they
+ *  may still attain. Structures are therefore reported in order of
+ *  non-decreasing free energy as soon as they are found, and memory
+ *  requirements are only bound by the number of pending partial structures
+ *  instead of the total number of suboptimal structures. If @p sorted is
+ *  #VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, structures of equal free energy
+ *  are additionally reported in lexicographical order of their dot-bracket
+ *  string. For #VRNA_UNSORTED, the structures are reported in the same order
+ *  as for vrna_subopt_cb().
+ *
+ *  The enumeration stops as soon as @p max_structures structures have been
+ *  passed to the callback, which then are the @p max_structures structures
+ *  of lowest free energy. A value of 0 disables this limit.
+ *
+ *  @ingroup subopt_wuchty
+ *
+ *  @note If the energies of structures are re-evaluated after backtracking,
+ *        i.e. for #vrna_md_t.logML or #vrna_md_t.dangles = 1 or 3, or if lonely
+ *        pairs are forbidden (#vrna_md_t.noLP), the order of backtracking does
+ *        not reflect the final free energies anymore. In that case, all
+ *        structures are collected and sorted before any of them is passed to
+ *        the callback.
+ *
+ *  @see vrna_subopt_cb(), vrna_subopt()
+ *  @param  fc              fold compount with the sequence data
+ *  @param  delta           Energy band arround the MFE in 10cal/mol, i.e. deka-calories
+ *  @param  sorted          Sort order, either #VRNA_SORT_BY_ENERGY_ASC, #VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, or #VRNA_UNSORTED
+ *  @param  max_structures  Maximum number of structures to report (0 = no limit)
+ *  @param  cb              Pointer to a callback function that handles the backtracked structure and its free energy in kcal/mol
+ *  @param  data            Pointer to some data structure that is passed along to the callback
+ *  @return                 The number of structures passed to the callback
+ */
+unsigned int
+vrna_subopt_sorted_cb(vrna_fold_compound_t  *fc,
+                      int                   delta,
+                      int                   sorted,
+                      unsigned int          max_structures,
+                      vrna_subopt_callback  *cb,
+                      void                  *data);
+
+
 /**
  *  @brief Compute Zuker type suboptimal structures
  *
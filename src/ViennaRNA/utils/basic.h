@@ -270,6 +270,42 @@ int *
 vrna_idx_col_wise(unsigned int length);
 
 
+/**
+ *  @brief Get an index mapper array (iindx) for banded DP matrices
+ *
+ *  Same as vrna_idx_row_wise(), but only entries "(i,j)" with @verbatim j - i <= band @endverbatim
+ *  are addressed, such that a DP matrix requires only @verbatim (length + 2) * (band + 1) @endverbatim
+ *  instead of a quadratic number of entries. Access of any other position yields an
+ *  entry of another row.
+ *
+ *  @see vrna_idx_row_wise(), vrna_idx_col_wise_banded()
+ *  @param length The length of the RNA sequence
+ *  @param band   The maximum distance between i and j
+ *  @return       The mapper array
+ */
+int *
+vrna_idx_row_wise_banded(unsigned int length,
+                         unsigned int band);
+
+
+/**
+ *  @brief Get an index mapper array (indx) for banded DP matrices
+ *
+ *  Same as vrna_idx_col_wise(), but only entries "(i,j)" with @verbatim j - i <= band @endverbatim
+ *  are addressed, such that a DP matrix requires only @verbatim (length + 2) * (band + 1) @endverbatim
+ *  instead of a quadratic number of entries. Access of any other position yields an
+ *  entry of another column.
+ *
+ *  @see vrna_idx_col_wise(), vrna_idx_row_wise_banded()
+ *  @param length The length of the RNA sequence
+ *  @param band   The maximum distance between i and j
+ *  @return       The mapper array
+ */
+int *
+vrna_idx_col_wise_banded(unsigned int length,
+                         unsigned int band);
+
+
 /**
  *  @}
  */
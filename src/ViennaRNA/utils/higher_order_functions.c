@@ -8,6 +8,7 @@
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/cpu.h"
+#include "ViennaRNA/utils/higher_order_functions.h"
 
 
 typedef int (proto_fun_zip_reduce)(const int  *a,
@@ -15,6 +16,23 @@ typedef int (proto_fun_zip_reduce)(const int  *a,
                                    int        size);
 
 
+typedef int (proto_fun_zip_mask_reduce)(const int           *a,
+                                        const int           *b,
+                                        const unsigned char *mask,
+                                        int                 size);
+
+
+typedef int (proto_fun_zip_arg_reduce)(const int  *a,
+                                       const int  *b,
+                                       int        size,
+                                       int        *value);
+
+
+typedef FLT_OR_DBL (proto_fun_zip_reduce_fp)(const FLT_OR_DBL *a,
+                                             const FLT_OR_DBL *b,
+                                             int              size);
+
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -25,12 +43,60 @@ static int zip_add_min_dispatcher(const int *a,
                                   int       size);
 
 
+static int zip_add_min_masked_dispatcher(const int            *a,
+                                         const int            *b,
+                                         const unsigned char  *mask,
+                                         int                  size);
+
+
+static int zip_add_argmin_dispatcher(const int  *a,
+                                     const int  *b,
+                                     int        size,
+                                     int        *value);
+
+
+static FLT_OR_DBL zip_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                                          const FLT_OR_DBL  *b,
+                                          int               size);
+
+
+static FLT_OR_DBL zip_rev_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                                              const FLT_OR_DBL  *b,
+                                              int               size);
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
                         int       count);
 
 
+static int
+fun_zip_add_min_masked_default(const int            *e1,
+                               const int            *e2,
+                               const unsigned char  *mask,
+                               int                  count);
+
+
+static int
+fun_zip_add_argmin_default(const int  *e1,
+                           const int  *e2,
+                           int        count,
+                           int        *min);
+
+
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count);
+
+
+static FLT_OR_DBL
+fun_zip_rev_mult_sum_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count);
+
+
 #if VRNA_WITH_SIMD_AVX512
 int
 vrna_fun_zip_add_min_avx512(const int *e1,
@@ -40,6 +106,43 @@ vrna_fun_zip_add_min_avx512(const int *e1,
 
 #endif
 
+#if VRNA_WITH_SIMD_AVX2
+int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count);
+
+
+int
+vrna_fun_zip_add_min_masked_avx2(const int            *e1,
+                                 const int            *e2,
+                                 const unsigned char  *mask,
+                                 int                  count);
+
+
+int
+vrna_fun_zip_add_argmin_avx2(const int  *e1,
+                             const int  *e2,
+                             int        count,
+                             int        *min);
+
+
+#ifndef USE_FLOAT_PF
+FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count);
+
+
+FLT_OR_DBL
+vrna_fun_zip_rev_mult_sum_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count);
+
+
+#endif
+#endif
+
 #if VRNA_WITH_SIMD_SSE41
 int
 vrna_fun_zip_add_min_sse41(const int  *e1,
@@ -47,10 +150,28 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
                            int        count);
 
 
+int
+vrna_fun_zip_add_min_masked_sse41(const int           *e1,
+                                  const int           *e2,
+                                  const unsigned char *mask,
+                                  int                 count);
+
+
+int
+vrna_fun_zip_add_argmin_sse41(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *min);
+
+
 #endif
 
 
-static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
+static proto_fun_zip_reduce       *fun_zip_add_min        = &zip_add_min_dispatcher;
+static proto_fun_zip_mask_reduce  *fun_zip_add_min_masked = &zip_add_min_masked_dispatcher;
+static proto_fun_zip_arg_reduce   *fun_zip_add_argmin     = &zip_add_argmin_dispatcher;
+static proto_fun_zip_reduce_fp    *fun_zip_mult_sum       = &zip_mult_sum_dispatcher;
+static proto_fun_zip_reduce_fp    *fun_zip_rev_mult_sum   = &zip_rev_mult_sum_dispatcher;
 
 
 /*
@@ -61,14 +182,22 @@ static proto_fun_zip_reduce *fun_zip_add_min = &zip_add_min_dispatcher;
 PUBLIC void
 vrna_fun_dispatch_disable(void)
 {
-  fun_zip_add_min = &fun_zip_add_min_default;
+  fun_zip_add_min         = &fun_zip_add_min_default;
+  fun_zip_add_min_masked  = &fun_zip_add_min_masked_default;
+  fun_zip_add_argmin      = &fun_zip_add_argmin_default;
+  fun_zip_mult_sum        = &fun_zip_mult_sum_default;
+  fun_zip_rev_mult_sum    = &fun_zip_rev_mult_sum_default;
 }
 
 
 PUBLIC void
 vrna_fun_dispatch_enable(void)
 {
-  fun_zip_add_min = &zip_add_min_dispatcher;
+  fun_zip_add_min         = &zip_add_min_dispatcher;
+  fun_zip_add_min_masked  = &zip_add_min_masked_dispatcher;
+  fun_zip_add_argmin      = &zip_add_argmin_dispatcher;
+  fun_zip_mult_sum        = &zip_mult_sum_dispatcher;
+  fun_zip_rev_mult_sum    = &zip_rev_mult_sum_dispatcher;
 }
 
 
@@ -81,6 +210,51 @@ vrna_fun_zip_add_min(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_min_masked(const int           *e1,
+                            const int           *e2,
+                            const unsigned char *mask,
+                            int                 count)
+{
+  return (*fun_zip_add_min_masked)(e1, e2, mask, count);
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_argmin(const int *e1,
+                        const int *e2,
+                        int       count,
+                        int       *min)
+{
+  int e, pos;
+
+  pos = (*fun_zip_add_argmin)(e1, e2, count, &e);
+
+  if (min)
+    *min = e;
+
+  return pos;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum(const FLT_OR_DBL  *e1,
+                      const FLT_OR_DBL  *e2,
+                      int               count)
+{
+  return (*fun_zip_mult_sum)(e1, e2, count);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_rev_mult_sum(const FLT_OR_DBL  *e1,
+                          const FLT_OR_DBL  *e2,
+                          int               count)
+{
+  return (*fun_zip_rev_mult_sum)(e1, e2, count);
+}
+
+
 /*
  #################################
  # STATIC helper functions below #
@@ -103,6 +277,14 @@ zip_add_min_dispatcher(const int  *a,
 
 #endif
 
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min = &vrna_fun_zip_add_min_avx2;
+    goto exec_fun_zip_add_min;
+  }
+
+#endif
+
 #if VRNA_WITH_SIMD_SSE41
   if (features & VRNA_CPU_SIMD_SSE41) {
     fun_zip_add_min = &vrna_fun_zip_add_min_sse41;
@@ -119,6 +301,108 @@ exec_fun_zip_add_min:
 }
 
 
+/* zip_add_min_masked() dispatcher */
+static int
+zip_add_min_masked_dispatcher(const int           *a,
+                              const int           *b,
+                              const unsigned char *mask,
+                              int                 size)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_min_masked = &vrna_fun_zip_add_min_masked_avx2;
+    goto exec_fun_zip_add_min_masked;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_add_min_masked = &vrna_fun_zip_add_min_masked_sse41;
+    goto exec_fun_zip_add_min_masked;
+  }
+
+#endif
+
+  fun_zip_add_min_masked = &fun_zip_add_min_masked_default;
+
+exec_fun_zip_add_min_masked:
+
+  return (*fun_zip_add_min_masked)(a, b, mask, size);
+}
+
+
+/* zip_add_argmin() dispatcher */
+static int
+zip_add_argmin_dispatcher(const int *a,
+                          const int *b,
+                          int       size,
+                          int       *value)
+{
+  unsigned int features = vrna_cpu_simd_capabilities();
+
+#if VRNA_WITH_SIMD_AVX2
+  if (features & VRNA_CPU_SIMD_AVX2) {
+    fun_zip_add_argmin = &vrna_fun_zip_add_argmin_avx2;
+    goto exec_fun_zip_add_argmin;
+  }
+
+#endif
+
+#if VRNA_WITH_SIMD_SSE41
+  if (features & VRNA_CPU_SIMD_SSE41) {
+    fun_zip_add_argmin = &vrna_fun_zip_add_argmin_sse41;
+    goto exec_fun_zip_add_argmin;
+  }
+
+#endif
+
+  fun_zip_add_argmin = &fun_zip_add_argmin_default;
+
+exec_fun_zip_add_argmin:
+
+  return (*fun_zip_add_argmin)(a, b, size, value);
+}
+
+
+/* zip_mult_sum() dispatcher */
+static FLT_OR_DBL
+zip_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                        const FLT_OR_DBL  *b,
+                        int               size)
+{
+  fun_zip_mult_sum = &fun_zip_mult_sum_default;
+
+#if VRNA_WITH_SIMD_AVX2 && !defined(USE_FLOAT_PF)
+  if (vrna_cpu_simd_capabilities() & VRNA_CPU_SIMD_AVX2)
+    fun_zip_mult_sum = &vrna_fun_zip_mult_sum_avx2;
+
+#endif
+
+  return (*fun_zip_mult_sum)(a, b, size);
+}
+
+
+/* zip_rev_mult_sum() dispatcher */
+static FLT_OR_DBL
+zip_rev_mult_sum_dispatcher(const FLT_OR_DBL  *a,
+                            const FLT_OR_DBL  *b,
+                            int               size)
+{
+  fun_zip_rev_mult_sum = &fun_zip_rev_mult_sum_default;
+
+#if VRNA_WITH_SIMD_AVX2 && !defined(USE_FLOAT_PF)
+  if (vrna_cpu_simd_capabilities() & VRNA_CPU_SIMD_AVX2)
+    fun_zip_rev_mult_sum = &vrna_fun_zip_rev_mult_sum_avx2;
+
+#endif
+
+  return (*fun_zip_rev_mult_sum)(a, b, size);
+}
+
+
 static int
 fun_zip_add_min_default(const int *e1,
                         const int *e2,
@@ -136,3 +420,86 @@ fun_zip_add_min_default(const int *e1,
 
   return decomp;
 }
+
+
+static int
+fun_zip_add_min_masked_default(const int            *e1,
+                               const int            *e2,
+                               const unsigned char  *mask,
+                               int                  count)
+{
+  int i;
+  int decomp = INF;
+
+  for (i = 0; i < count; i++) {
+    if ((mask[i]) && (e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+static int
+fun_zip_add_argmin_default(const int  *e1,
+                           const int  *e2,
+                           int        count,
+                           int        *min)
+{
+  int i, pos;
+  int decomp = INF;
+
+  for (pos = -1, i = 0; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      if (en < decomp) {
+        decomp  = en;
+        pos     = i;
+      }
+    }
+  }
+
+  *min = decomp;
+
+  return pos;
+}
+
+
+/*
+ *  The floating point reductions accumulate in 4 lanes to
+ *  reproduce the results of the vectorized implementations
+ */
+static FLT_OR_DBL
+fun_zip_mult_sum_default(const FLT_OR_DBL *e1,
+                         const FLT_OR_DBL *e2,
+                         int              count)
+{
+  int         i;
+  FLT_OR_DBL  lane[4] = {
+    0., 0., 0., 0.
+  };
+
+  for (i = 0; i < count; i++)
+    lane[i & 3] += e1[i] * e2[i];
+
+  return (lane[0] + lane[1]) + (lane[2] + lane[3]);
+}
+
+
+static FLT_OR_DBL
+fun_zip_rev_mult_sum_default(const FLT_OR_DBL *e1,
+                             const FLT_OR_DBL *e2,
+                             int              count)
+{
+  int         i;
+  FLT_OR_DBL  lane[4] = {
+    0., 0., 0., 0.
+  };
+
+  for (i = 0; i < count; i++)
+    lane[i & 3] += e1[i] * e2[-i];
+
+  return (lane[0] + lane[1]) + (lane[2] + lane[3]);
+}
@@ -1,18 +1,105 @@
 #ifndef VIENNA_RNA_PACKAGE_UTILS_FUN_H
 #define VIENNA_RNA_PACKAGE_UTILS_FUN_H
 
+#include <ViennaRNA/datastructures/basic.h>
+
+/**
+ *  @file     ViennaRNA/utils/higher_order_functions.h
+ *  @ingroup  utils
+ *  @brief    Vectorized higher order functions (zip/reduce) with runtime SIMD dispatch
+ *
+ *  All functions below are dispatched at their first call to the fastest
+ *  implementation supported by the CPU (AVX 512, AVX 2, SSE 4.1, or plain C).
+ *  The floating point reductions always accumulate in four independent
+ *  lanes (element @f$t@f$ goes to lane @f$t \bmod 4@f$) that are summed up
+ *  as @f$(l_0 + l_1) + (l_2 + l_3)@f$ at the end. Hence, their results do
+ *  not depend on the actual implementation chosen at runtime.
+ */
+
+/**
+ *  @brief  Use the plain C implementations of all higher order functions
+ */
 void
 vrna_fun_dispatch_disable(void);
 
 
+/**
+ *  @brief  (Re-)enable runtime dispatching of all higher order functions
+ */
 void
 vrna_fun_dispatch_enable(void);
 
 
+/**
+ *  @brief  Minimum of the element-wise sums of two integer arrays
+ *
+ *  Returns @f$\min_{0 \leq t < count} e_1[t] + e_2[t]@f$ where any
+ *  pair with at least one value @ref INF is skipped.
+ *
+ *  @return The minimum, or @ref INF if no valid pair exists
+ */
 int
 vrna_fun_zip_add_min(const int  *e1,
                      const int  *e2,
                      int        count);
 
 
+/**
+ *  @brief  Minimum of the element-wise sums of two integer arrays restricted by a mask
+ *
+ *  Same as vrna_fun_zip_add_min() but additionally skips all positions
+ *  @f$t@f$ with @p mask[t] @f$= 0@f$. This allows one to honor hard
+ *  constraints without copying any of the input arrays.
+ *
+ *  @return The minimum, or @ref INF if no valid pair exists
+ */
+int
+vrna_fun_zip_add_min_masked(const int           *e1,
+                            const int           *e2,
+                            const unsigned char *mask,
+                            int                 count);
+
+
+/**
+ *  @brief  Position of the minimum of the element-wise sums of two integer arrays
+ *
+ *  Same as vrna_fun_zip_add_min() but returns the smallest position @f$t@f$
+ *  that attains the minimum. This is useful to backtrack a decomposition
+ *  that has been obtained by vrna_fun_zip_add_min() before.
+ *
+ *  @param  min   A pointer to store the minimum at (may be @p NULL)
+ *  @return       The position of the first minimum, or -1 if no valid pair exists
+ */
+int
+vrna_fun_zip_add_argmin(const int *e1,
+                        const int *e2,
+                        int       count,
+                        int       *min);
+
+
+/**
+ *  @brief  Sum of the element-wise products of two floating point arrays
+ *
+ *  Returns @f$\sum_{0 \leq t < count} e_1[t] \cdot e_2[t]@f$
+ */
+FLT_OR_DBL
+vrna_fun_zip_mult_sum(const FLT_OR_DBL  *e1,
+                      const FLT_OR_DBL  *e2,
+                      int               count);
+
+
+/**
+ *  @brief  Sum of the element-wise products of two floating point arrays, where the second is traversed backwards
+ *
+ *  Returns @f$\sum_{0 \leq t < count} e_1[t] \cdot e_2[-t]@f$, i.e. @p e2
+ *  points to the @em last element of the second array. This is the typical
+ *  access pattern of split decompositions in the partition function
+ *  recursions where one part is stored row-wise and the other one column-wise.
+ */
+FLT_OR_DBL
+vrna_fun_zip_rev_mult_sum(const FLT_OR_DBL  *e1,
+                          const FLT_OR_DBL  *e2,
+                          int               count);
+
+
 #endif
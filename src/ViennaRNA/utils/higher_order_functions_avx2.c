@@ -0,0 +1,205 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ViennaRNA/utils/basic.h"
+
+#include <immintrin.h>
+
+static int
+horizontal_min_Vec8i(__m256i x);
+
+
+PUBLIC int
+vrna_fun_zip_add_min_avx2(const int *e1,
+                          const int *e2,
+                          int       count)
+{
+  int     i       = 0;
+  int     decomp  = INF;
+
+  __m256i inf = _mm256_set1_epi32(INF);
+  __m256i res = inf;
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i a = _mm256_loadu_si256((__m256i *)&e1[i]);
+    __m256i b = _mm256_loadu_si256((__m256i *)&e2[i]);
+    __m256i c = _mm256_add_epi32(a, b);
+
+    /* create mask for non-INF values */
+    __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                    _mm256_cmpgt_epi32(inf, b));
+
+    /* replace results where a or b has been INF before by INF and keep the minimum per lane */
+    c   = _mm256_blendv_epi8(inf, c, mask);
+    res = _mm256_min_epi32(res, c);
+  }
+
+  decomp = horizontal_min_Vec8i(res);
+
+  for (; i < count; i++) {
+    if ((e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_min_masked_avx2(const int            *e1,
+                                 const int            *e2,
+                                 const unsigned char  *mask,
+                                 int                  count)
+{
+  int     i       = 0;
+  int     decomp  = INF;
+
+  __m256i inf   = _mm256_set1_epi32(INF);
+  __m256i zero  = _mm256_setzero_si256();
+  __m256i res   = inf;
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i a = _mm256_loadu_si256((__m256i *)&e1[i]);
+    __m256i b = _mm256_loadu_si256((__m256i *)&e2[i]);
+    __m256i m = _mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i *)&mask[i]));
+    __m256i c = _mm256_add_epi32(a, b);
+
+    /* create mask for non-INF values at enabled positions */
+    __m256i valid = _mm256_andnot_si256(_mm256_cmpeq_epi32(m, zero),
+                                        _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                                         _mm256_cmpgt_epi32(inf, b)));
+
+    c   = _mm256_blendv_epi8(inf, c, valid);
+    res = _mm256_min_epi32(res, c);
+  }
+
+  decomp = horizontal_min_Vec8i(res);
+
+  for (; i < count; i++) {
+    if ((mask[i]) && (e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_argmin_avx2(const int  *e1,
+                             const int  *e2,
+                             int        count,
+                             int        *min)
+{
+  int     i, bits;
+
+  *min = vrna_fun_zip_add_min_avx2(e1, e2, count);
+
+  if (*min == INF)
+    return -1;
+
+  /* find first position that attains the minimum */
+  __m256i inf = _mm256_set1_epi32(INF);
+  __m256i m   = _mm256_set1_epi32(*min);
+
+  for (i = 0; i < count - 7; i += 8) {
+    __m256i a = _mm256_loadu_si256((__m256i *)&e1[i]);
+    __m256i b = _mm256_loadu_si256((__m256i *)&e2[i]);
+    __m256i c = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_add_epi32(a, b), m),
+                                 _mm256_and_si256(_mm256_cmpgt_epi32(inf, a),
+                                                  _mm256_cmpgt_epi32(inf, b)));
+
+    bits = _mm256_movemask_ps(_mm256_castsi256_ps(c));
+    if (bits)
+      return i + __builtin_ctz(bits);
+  }
+
+  for (; i < count; i++)
+    if ((e1[i] != INF) && (e2[i] != INF) && (e1[i] + e2[i] == *min))
+      return i;
+
+  return -1;
+}
+
+
+#ifndef USE_FLOAT_PF
+
+/*
+ *  Both floating point reductions below use a single vector of 4 doubles
+ *  as accumulator, i.e. element t is added to lane t % 4. The remaining
+ *  elements are added to the same lanes, such that the result equals the
+ *  one of the default implementation
+ */
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_mult_sum_avx2(const FLT_OR_DBL *e1,
+                           const FLT_OR_DBL *e2,
+                           int              count)
+{
+  int     i;
+  double  lane[4];
+  __m256d acc = _mm256_setzero_pd();
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m256d a = _mm256_loadu_pd(&e1[i]);
+    __m256d b = _mm256_loadu_pd(&e2[i]);
+
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(a, b));
+  }
+
+  _mm256_storeu_pd(lane, acc);
+
+  for (; i < count; i++)
+    lane[i & 3] += e1[i] * e2[i];
+
+  return (lane[0] + lane[1]) + (lane[2] + lane[3]);
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_fun_zip_rev_mult_sum_avx2(const FLT_OR_DBL *e1,
+                               const FLT_OR_DBL *e2,
+                               int              count)
+{
+  int     i;
+  double  lane[4];
+  __m256d acc = _mm256_setzero_pd();
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m256d a = _mm256_loadu_pd(&e1[i]);
+    /* load e2[-i - 3], ..., e2[-i] and reverse the order */
+    __m256d b = _mm256_permute4x64_pd(_mm256_loadu_pd(&e2[-i - 3]), _MM_SHUFFLE(0, 1, 2, 3));
+
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(a, b));
+  }
+
+  _mm256_storeu_pd(lane, acc);
+
+  for (; i < count; i++)
+    lane[i & 3] += e1[i] * e2[-i];
+
+  return (lane[0] + lane[1]) + (lane[2] + lane[3]);
+}
+
+
+#endif
+
+
+static int
+horizontal_min_Vec8i(__m256i x)
+{
+  __m128i min1  = _mm_min_epi32(_mm256_castsi256_si128(x),
+                                _mm256_extracti128_si256(x, 1));
+  __m128i min2  = _mm_min_epi32(min1, _mm_shuffle_epi32(min1, _MM_SHUFFLE(0, 0, 3, 2)));
+  __m128i min3  = _mm_min_epi32(min2, _mm_shuffle_epi32(min2, _MM_SHUFFLE(0, 0, 0, 1)));
+
+  return _mm_cvtsi128_si32(min3);
+}
@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "ViennaRNA/utils/basic.h"
@@ -15,6 +16,12 @@ static int
 horizontal_min_Vec4i(__m128i x);
 
 
+PUBLIC int
+vrna_fun_zip_add_min_sse41(const int  *e1,
+                           const int  *e2,
+                           int        count);
+
+
 PUBLIC int
 vrna_fun_zip_add_min_sse41(const int  *e1,
                            const int  *e2,
@@ -55,6 +62,87 @@ vrna_fun_zip_add_min_sse41(const int  *e1,
 }
 
 
+PUBLIC int
+vrna_fun_zip_add_min_masked_sse41(const int           *e1,
+                                  const int           *e2,
+                                  const unsigned char *mask,
+                                  int                 count)
+{
+  int     i       = 0;
+  int     decomp  = INF;
+
+  __m128i inf   = _mm_set1_epi32(INF);
+  __m128i zero  = _mm_setzero_si128();
+  __m128i res   = inf;
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m128i a = _mm_loadu_si128((__m128i *)&e1[i]);
+    __m128i b = _mm_loadu_si128((__m128i *)&e2[i]);
+    int     mask_bytes;
+    memcpy(&mask_bytes, &mask[i], sizeof(int));
+    __m128i m = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(mask_bytes));
+    __m128i c = _mm_add_epi32(a, b);
+
+    /* create mask for non-INF values at enabled positions */
+    __m128i valid = _mm_andnot_si128(_mm_cmpeq_epi32(m, zero),
+                                     _mm_and_si128(_mm_cmplt_epi32(a, inf),
+                                                   _mm_cmplt_epi32(b, inf)));
+
+    /* replace invalid results by INF and keep the minimum per lane */
+    c   = _mm_or_si128(_mm_and_si128(valid, c), _mm_andnot_si128(valid, inf));
+    res = _mm_min_epi32(res, c);
+  }
+
+  decomp = horizontal_min_Vec4i(res);
+
+  for (; i < count; i++) {
+    if ((mask[i]) && (e1[i] != INF) && (e2[i] != INF)) {
+      const int en = e1[i] + e2[i];
+      decomp = MIN2(decomp, en);
+    }
+  }
+
+  return decomp;
+}
+
+
+PUBLIC int
+vrna_fun_zip_add_argmin_sse41(const int *e1,
+                              const int *e2,
+                              int       count,
+                              int       *min)
+{
+  int     i, bits;
+
+  *min = vrna_fun_zip_add_min_sse41(e1, e2, count);
+
+  if (*min == INF)
+    return -1;
+
+  /* find first position that attains the minimum */
+  __m128i inf = _mm_set1_epi32(INF);
+  __m128i m   = _mm_set1_epi32(*min);
+
+  for (i = 0; i < count - 3; i += 4) {
+    __m128i a = _mm_loadu_si128((__m128i *)&e1[i]);
+    __m128i b = _mm_loadu_si128((__m128i *)&e2[i]);
+    __m128i c = _mm_and_si128(_mm_cmpeq_epi32(_mm_add_epi32(a, b), m),
+                              _mm_and_si128(_mm_cmplt_epi32(a, inf),
+                                            _mm_cmplt_epi32(b, inf)));
+
+    bits = _mm_movemask_ps(_mm_castsi128_ps(c));
+    if (bits)
+      return i + __builtin_ctz(bits);
+  }
+
+  for (; i < count; i++)
+    if ((e1[i] != INF) && (e2[i] != INF) && (e1[i] + e2[i] == *min))
+      return i;
+
+  return -1;
+}
+
+
 /*
  *  SSE minimum
  *  see also: http://stackoverflow.com/questions/9877700/getting-max-value-in-a-m128i-vector-with-sse
@@ -439,6 +439,34 @@ vrna_idx_col_wise(unsigned int length)
 }
 
 
+PUBLIC int *
+vrna_idx_row_wise_banded(unsigned int length,
+                         unsigned int band)
+{
+  unsigned int  i;
+  int           *idx = (int *)vrna_alloc(sizeof(int) * (length + 1));
+
+  /* row i occupies the entries [(i - 1) * (band + 1), i * (band + 1)) */
+  for (i = 1; i <= length; i++)
+    idx[i] = i * (band + 2) - 1;
+  return idx;
+}
+
+
+PUBLIC int *
+vrna_idx_col_wise_banded(unsigned int length,
+                         unsigned int band)
+{
+  unsigned int  i;
+  int           *idx = (int *)vrna_alloc(sizeof(int) * (length + 1));
+
+  /* column j occupies the entries [(j - 1) * (band + 1), j * (band + 1)) */
+  for (i = 1; i <= length; i++)
+    idx[i] = i * band - 1;
+  return idx;
+}
+
+
 /*
  #################################
  # STATIC helper functions below #
@@ -97,6 +97,7 @@ struct options {
   int             keep_order;
   unsigned int    next_record_number;
   vrna_ostream_t  output_queue;
+  fc_pool         fold_compounds;
 };
 
 
@@ -272,6 +273,7 @@ init_default_options(struct options *opt)
   opt->keep_order         = 1;
   opt->next_record_number = 0;
   opt->output_queue       = NULL;
+  opt->fold_compounds     = NULL;
 }
 
 
@@ -620,6 +622,9 @@ main(int  argc,
   if (opt.keep_order)
     opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
 
+  /* re-use fold compounds (and their DP matrices) for consecutive alignments */
+  opt.fold_compounds = fc_pool_init(FC_POOL_MAX_LENGTH);
+
   /*
    ################################################
    # read constraint from stdin
@@ -687,6 +692,8 @@ main(int  argc,
    */
   vrna_ostream_free(opt.output_queue);
 
+  fc_pool_free(opt.fold_compounds);
+
 
   /* check whether we've actually processed any alignment so far */
   if (first_alignment_number == get_current_id(opt.id_control)) {
@@ -898,9 +905,10 @@ process_record(struct record_data *record)
     for (i = 0; i < n_seq; i++)
       mark_endgaps(alignment[i], '~');
 
-  vc = vrna_fold_compound_comparative((const char **)alignment,
-                                      &(opt->md),
-                                      VRNA_OPTION_DEFAULT);
+  vc = fc_pool_get_comparative(opt->fold_compounds,
+                               (const char **)alignment,
+                               &(opt->md),
+                               VRNA_OPTION_DEFAULT);
   n = vc->length;
 
   if (fold_constrained)
@@ -1021,8 +1029,9 @@ process_record(struct record_data *record)
                        opt->aln_PS_cols));
   }
 
-  /* free mfe arrays */
-  vrna_mx_mfe_free(vc);
+  /* free mfe arrays of long alignments */
+  if (n > 2000)
+    vrna_mx_mfe_free(vc);
 
   if (opt->pf) {
     double  energy;
@@ -1144,7 +1153,7 @@ process_record(struct record_data *record)
   free(filename_dot);
   free(filename_aln);
   free(filename_out);
-  vrna_fold_compound_free(vc);
+  fc_pool_release(opt->fold_compounds, vc);
 
   vrna_aln_free(alignment);
 
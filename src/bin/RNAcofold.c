@@ -83,6 +83,7 @@ struct options {
   int             keep_order;
   unsigned int    next_record_number;
   vrna_ostream_t  output_queue;
+  fc_pool         fold_compounds;
 };
 
 
@@ -207,6 +208,7 @@ init_default_options(struct options *opt)
   opt->keep_order         = 1;
   opt->next_record_number = 0;
   opt->output_queue       = NULL;
+  opt->fold_compounds     = NULL;
 }
 
 
@@ -463,6 +465,9 @@ main(int  argc,
   if (opt.keep_order)
     opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
 
+  /* re-use fold compounds (and their DP matrices) for consecutive records */
+  opt.fold_compounds = fc_pool_init(FC_POOL_MAX_LENGTH);
+
   /*
    ################################################
    # process input files or handle input from stdin
@@ -507,6 +512,8 @@ main(int  argc,
    */
   vrna_ostream_free(opt.output_queue);
 
+  fc_pool_free(opt.fold_compounds);
+
 
   free(input_files);
   free(opt.constraint_file);
@@ -663,9 +670,10 @@ process_record(struct record_data *record)
   /* convert sequence to uppercase letters only */
   vrna_seq_toupper(sequence);
 
-  vrna_fold_compound_t *vc = vrna_fold_compound(sequence,
-                                                &(opt->md),
-                                                VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
+  vrna_fold_compound_t *vc = fc_pool_get(opt->fold_compounds,
+                                         sequence,
+                                         &(opt->md),
+                                         VRNA_OPTION_DEFAULT | VRNA_OPTION_HYBRID);
   n = vc->length;
 
   if (vc->strands > 2)
@@ -1152,7 +1160,7 @@ cleanup_record:
     free(record->rest);
   }
 
-  vrna_fold_compound_free(vc);
+  fc_pool_release(opt->fold_compounds, vc);
 
   free(record);
 }
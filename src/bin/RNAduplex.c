@@ -21,11 +21,71 @@
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/subopt.h"
 #include "ViennaRNA/duplex.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNAduplex_cmdl.h"
+#include "parallel_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
-PRIVATE void  print_struc(duplexT const *dup);
+struct options {
+  int             noconv;
+  int             delta;
+  vrna_md_t       md;
+
+  int             jobs;
+  int             keep_order;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+struct record_data {
+  unsigned int    number;
+  char            *s1;
+  char            *s2;
+  vrna_cstr_t     output;
+  struct options  *options;
+  int             tty;
+};
+
+
+PRIVATE void
+print_struc(vrna_cstr_t   output,
+            duplexT const *dup);
+
+
+static void
+process_input(struct options *opt);
+
+
+static void
+process_record(struct record_data *record);
+
+
+void
+init_default_options(struct options *opt)
+{
+  opt->noconv = 0;
+  opt->delta  = -1;
+
+  opt->jobs               = 1;
+  opt->keep_order         = 1;
+  opt->next_record_number = 0;
+  opt->output_queue       = NULL;
+}
+
+
+void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  vrna_cstr_t s = (vrna_cstr_t)data;
+
+  /* flush and free data[k] */
+  vrna_cstr_free(s);
+}
 
 
 /*--------------------------------------------------------------------------*/
@@ -35,17 +95,15 @@ main(int  argc,
      char *argv[])
 {
   struct        RNAduplex_args_info args_info;
-  char                              *input_string, *s1, *s2, *orig_s1, *orig_s2,
-                                    *c, *ParamFile, *ns_bases;
-  unsigned int                      input_type;
-  int                               i, sym, istty, delta, noconv;
+  char                              *c, *ParamFile, *ns_bases;
+  int                               i, sym;
+  struct options                    opt;
 
   ParamFile = NULL;
   ns_bases  = NULL;
-  s1        = s2 = orig_s1 = orig_s2 = NULL;
   dangles   = 2;
-  delta     = -1;
-  noconv    = 0;
+
+  init_default_options(&opt);
 
   /*
    #############################################
@@ -85,7 +143,7 @@ main(int  argc,
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* take another energy parameter set */
   if (args_info.paramFile_given)
@@ -97,12 +155,39 @@ main(int  argc,
 
   /*energy range */
   if (args_info.deltaEnergy_given)
-    delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
+    opt.delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
 
   /* sorted output */
   if (args_info.sorted_given)
     subopt_sorted = 1;
 
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAduplex has been built without parallel input processing capabilities");
+#endif
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
+
   /* free allocated memory of command line data structure */
   RNAduplex_cmdline_parser_free(&args_info);
 
@@ -142,15 +227,47 @@ main(int  argc,
     }
   }
 
-  istty = isatty(fileno(stdout)) && isatty(fileno(stdin));
+  /* the model settings are the same for all input records */
+  update_fold_params();
+  set_model_details(&opt.md);
+
+  if ((opt.jobs > 1) && (opt.keep_order))
+    opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
 
   /*
    #############################################
    # main loop: continue until end of file
    #############################################
    */
+  INIT_PARALLELIZATION(opt.jobs);
+
+  process_input(&opt);
+
+  UNINIT_PARALLELIZATION
+
+  vrna_ostream_free(opt.output_queue);
+
+  free(ParamFile);
+  free(ns_bases);
+
+  return 0;
+}
+
+
+/* main loop that reads pairs of sequences from stdin */
+static void
+process_input(struct options *opt)
+{
+  char          *input_string, *s1, *s2;
+  unsigned int  input_type;
+  int           istty;
+  vrna_cstr_t   output;
+
+  istty = isatty(fileno(stdout)) && isatty(fileno(stdin));
+
   do {
-    duplexT mfe, *subopt;
+    s1 = s2 = NULL;
+
     /*
      ########################################################
      # handle user input from 'stdin'
@@ -159,102 +276,133 @@ main(int  argc,
     if (istty)
       vrna_message_input_seq("Input two sequences (one line each)");
 
+    /* the output of each pair, including the FASTA headers */
+    output = vrna_cstr(0, stdout);
+
+    if (opt->output_queue)
+      vrna_ostream_request(opt->output_queue, opt->next_record_number);
+
     /* extract filename from fasta header if available */
     while ((input_type = get_input_line(&input_string, 0)) == VRNA_INPUT_FASTA_HEADER) {
-      print_fasta_header(stdout, input_string);
+      vrna_cstr_print_fasta_header(output, input_string);
       free(input_string);
     }
 
-    /* break on any error, EOF or quit request */
-    if (input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR)) {
-      break;
-    }
-    /* else assume a proper sequence of letters of a certain alphabet (RNA, DNA, etc.) */
-    else {
+    if (!(input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR))) {
       s1 = strdup(input_string);
       free(input_string);
-    }
 
-    /* get second sequence */
-    while ((input_type = get_input_line(&input_string, 0)) == VRNA_INPUT_FASTA_HEADER) {
-      print_fasta_header(stdout, input_string);
-      free(input_string);
+      /* get second sequence */
+      while ((input_type = get_input_line(&input_string, 0)) == VRNA_INPUT_FASTA_HEADER) {
+        vrna_cstr_print_fasta_header(output, input_string);
+        free(input_string);
+      }
     }
+
     /* break on any error, EOF or quit request */
     if (input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR)) {
+      free(s1);
+
+      /* print remaining FASTA headers */
+      if (opt->output_queue)
+        vrna_ostream_provide(opt->output_queue, opt->next_record_number, (void *)output);
+      else
+        ATOMIC_BLOCK(flush_cstr_callback(NULL, opt->next_record_number, (void *)output));
+
       break;
     }
+
     /* else assume a proper sequence of letters of a certain alphabet (RNA, DNA, etc.) */
-    else {
-      s2 = strdup(input_string);
-      free(input_string);
-    }
+    s2 = strdup(input_string);
+    free(input_string);
 
-    /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv) {
-      vrna_seq_toRNA(s1);
-      vrna_seq_toRNA(s2);
-    }
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    /* store case-unmodified sequence */
-    orig_s1 = strdup(s1);
-    orig_s2 = strdup(s2);
-    /* convert sequence to uppercase letters only */
-    vrna_seq_toupper(s1);
-    vrna_seq_toupper(s2);
+    record->number  = opt->next_record_number++;
+    record->s1      = s1;
+    record->s2      = s2;
+    record->output  = output;
+    record->options = opt;
+    record->tty     = istty;
 
-    if (istty)
-      vrna_message_info(stdout, "lengths = %d,%d\n", (int)strlen(s1), (int)strlen(s2));
+    RUN_IN_PARALLEL(process_record, record);
+  } while (1);
+}
 
-    /*
-     ########################################################
-     # done with 'stdin' handling, now init everything properly
-     ########################################################
-     */
-    update_fold_params();
 
-    /*
-     ########################################################
-     # begin actual computations
-     ########################################################
-     */
-    if (delta >= 0) {
-      duplexT *sub;
-      subopt = duplex_subopt(s1, s2, delta, 5);
-      for (sub = subopt; sub->i > 0; sub++) {
-        print_struc(sub);
-        free(sub->structure);
-      }
-      free(subopt);
-    } else {
-      mfe = duplexfold(s1, s2);
-      print_struc(&mfe);
-      free(mfe.structure);
+static void
+process_record(struct record_data *record)
+{
+  char            *s1, *s2;
+  duplexT         mfe, *subopt;
+  vrna_duplex_t   *duplex;
+  struct options  *opt;
+
+  opt = record->options;
+  s1  = record->s1;
+  s2  = record->s2;
+
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!opt->noconv) {
+    vrna_seq_toRNA(s1);
+    vrna_seq_toRNA(s2);
+  }
+
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(s1);
+  vrna_seq_toupper(s2);
+
+  if (record->tty)
+    vrna_message_info(stdout, "lengths = %d,%d\n", (int)strlen(s1), (int)strlen(s2));
+
+  /*
+   ########################################################
+   # begin actual computations
+   ########################################################
+   */
+  duplex = vrna_duplex_init(&(opt->md));
+
+  if (opt->delta >= 0) {
+    duplexT *sub;
+    subopt = vrna_duplex_subopt(duplex, s1, s2, opt->delta, 5);
+    for (sub = subopt; sub->i > 0; sub++) {
+      print_struc(record->output, sub);
+      free(sub->structure);
     }
+    free(subopt);
+  } else {
+    mfe = vrna_duplexfold(duplex, s1, s2);
+    print_struc(record->output, &mfe);
+    free(mfe.structure);
+  }
 
-    (void)fflush(stdout);
-    free(s1);
-    free(s2);
-    free(orig_s1);
-    free(orig_s2);
-    s1 = s2 = orig_s1 = orig_s2 = NULL;
-  } while (1);
-  return 0;
+  vrna_duplex_free(duplex);
+
+  /* print what we've collected in output charstream */
+  if (opt->output_queue)
+    vrna_ostream_provide(opt->output_queue, record->number, (void *)record->output);
+  else
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)record->output));
+
+  free(s1);
+  free(s2);
+  free(record);
 }
 
 
 PRIVATE void
-print_struc(duplexT const *dup)
+print_struc(vrna_cstr_t   output,
+            duplexT const *dup)
 {
-  int   l1;
+  int l1;
 
   l1 = strchr(dup->structure, '&') - dup->structure;
-  char  *msg = vrna_strdup_printf(" %3d,%-3d : %3d,%-3d (%5.2f)",
-                                  dup->i + 1 - l1,
-                                  dup->i,
-                                  dup->j,
-                                  dup->j + (int)strlen(dup->structure) - l1 - 2,
-                                  dup->energy);
-  print_structure(stdout, dup->structure, msg);
-  free(msg);
+  vrna_cstr_printf_structure(output,
+                             dup->structure,
+                             " %3d,%-3d : %3d,%-3d (%5.2f)",
+                             dup->i + 1 - l1,
+                             dup->i,
+                             dup->j,
+                             dup->j + (int)strlen(dup->structure) - l1 - 2,
+                             dup->energy);
 }
@@ -89,6 +89,7 @@ struct options {
   FILE            *output_stream;
   unsigned int    next_record_number;
   vrna_ostream_t  output_queue;
+  fc_pool         fold_compounds;
 };
 
 struct record_data {
@@ -391,6 +392,7 @@ init_default_options(struct options *opt)
   opt->output_stream      = NULL;
   opt->next_record_number = 0;
   opt->output_queue       = NULL;
+  opt->fold_compounds     = NULL;
 }
 
 
@@ -474,6 +476,10 @@ main(int  argc,
       opt.md.compute_bpp = do_backtrack = 1;
   }
 
+  /* adapt scaling factor of Boltzmann weights during the computations */
+  if (args_info.pfAdaptive_given)
+    opt.md.pf_adaptive = 1;
+
   /* MEA (maximum expected accuracy) settings */
   if (args_info.MEA_given) {
     opt.pf = opt.MEA = 1;
@@ -568,6 +574,9 @@ main(int  argc,
   if (opt.keep_order)
     opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
 
+  /* re-use fold compounds (and their DP matrices) for consecutive records */
+  opt.fold_compounds = fc_pool_init(FC_POOL_MAX_LENGTH);
+
   /*
    ################################################
    # process input files or handle input from stdin
@@ -618,6 +627,8 @@ main(int  argc,
 
   vrna_ostream_free(opt.output_queue);
 
+  fc_pool_free(opt.fold_compounds);
+
   free(input_files);
   free(opt.constraint_file);
   free(opt.ligandMotif);
@@ -825,7 +836,7 @@ process_record(struct record_data *record)
   /* convert sequence to uppercase letters only */
   vrna_seq_toupper(rec_sequence);
 
-  vc = vrna_fold_compound(rec_sequence, &(opt->md), VRNA_OPTION_DEFAULT);
+  vc = fc_pool_get(opt->fold_compounds, rec_sequence, &(opt->md), VRNA_OPTION_DEFAULT);
 
   length = vc->length;
 
@@ -1065,7 +1076,7 @@ process_record(struct record_data *record)
   }
 
   /* clean up */
-  vrna_fold_compound_free(vc);
+  fc_pool_release(opt->fold_compounds, vc);
   free(record->id);
   free(record->SEQ_ID);
   free(record->sequence);
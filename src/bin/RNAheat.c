@@ -22,8 +22,7 @@
 #include "ViennaRNA/utils/strings.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/params/basic.h"
-#include "ViennaRNA/fold.h"
-#include "ViennaRNA/part_func.h"
+#include "ViennaRNA/heat_capacity.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/io/file_formats.h"
 #include "ViennaRNA/datastructures/char_stream.h"
@@ -36,8 +35,6 @@
 #include "parallel_helpers.h"
 
 
-#define MAXWIDTH  201
-
 struct options {
   int             filename_full;
   int             noconv;
@@ -73,10 +70,10 @@ struct output_stream {
 };
 
 
-PRIVATE float
-ddiff(float f[],
-      float h,
-      int   m);
+PRIVATE void
+print_heat_capacity(float temperature,
+                    float heat_capacity,
+                    void  *data);
 
 
 static int
@@ -237,6 +234,10 @@ main(int  argc,
       opt.mpoints = 100;
   }
 
+  /* number of threads for the temperature points of each sequence */
+  if (args_info.numThreads_given)
+    opt.md.num_threads = MAX2(0, args_info.numThreads_arg);
+
   if (args_info.jobs_given) {
 #if VRNA_WITH_PTHREADS
     int thread_max = max_user_threads();
@@ -413,9 +414,7 @@ static void
 process_record(struct record_data *record)
 {
   char                  *rec_sequence;
-  int                   i, n, m;
-  float                 hc, F[MAXWIDTH], T_min, T_max, h;
-  double                min_en;
+  int                   n;
   vrna_fold_compound_t  *fc;
   vrna_md_t             md;
 
@@ -426,11 +425,6 @@ process_record(struct record_data *record)
   o_stream      = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
   rec_sequence  = strdup(record->sequence);
 
-  T_min = opt->T_min;
-  T_max = opt->T_max;
-  h     = opt->h;
-  m     = opt->mpoints;
-
   /* convert DNA alphabet to RNA if not explicitely switched off */
   if (!opt->noconv) {
     vrna_seq_toRNA(rec_sequence);
@@ -440,9 +434,15 @@ process_record(struct record_data *record)
   /* convert sequence to uppercase letters only */
   vrna_seq_toupper(rec_sequence);
 
+  md = opt->md;
+
+  /* required for vrna_exp_param_rescale() in subsequent calls */
+  md.sfact = 1.;
+
+  /* the DP matrices are allocated by the heat capacity engine */
   fc = vrna_fold_compound(rec_sequence,
-                          &(opt->md),
-                          VRNA_OPTION_DEFAULT);
+                          &md,
+                          VRNA_OPTION_EVAL_ONLY);
 
   n = (int)fc->length;
 
@@ -461,54 +461,14 @@ process_record(struct record_data *record)
    */
   vrna_cstr_print_fasta_header(o_stream->data, record->id);
 
-  md = fc->params->model_details;
-
-  /* required for vrna_exp_param_rescale() in subsequent calls */
-  md.sfact = 1.;
-
-  md.temperature = T_min - m * h;
-  vrna_params_reset(fc, &md);
-
-  /* initialize_fold(length); <- obsolete */
-  min_en  = (double)vrna_mfe(fc, NULL);
-  min_en  *= md.sfact;
-
-  vrna_exp_params_rescale(fc, &min_en);
-
-  for (i = 0; i < 2 * m + 1; i++) {
-    F[i] = vrna_pf(fc, NULL);
-    /* increase temperature */
-    md.temperature += h;
-    /* reset all energy parameters according to temperature changes */
-    vrna_params_reset(fc, &md);
-
-    min_en = F[i] + h * 0.00727 * n;
-
-    vrna_exp_params_rescale(fc, &min_en);
-  }
-
-  while (md.temperature <= (T_max + m * h + h)) {
-    hc = -ddiff(F, h, m) * (md.temperature + K0 - m * h - h);
-
-    vrna_cstr_printf_tbody(o_stream->data,
-                           "%g\t%g",
-                           (md.temperature - m * h - h),
-                           hc);
-
-    for (i = 0; i < 2 * m; i++)
-      F[i] = F[i + 1];
-
-    F[2 * m] = vrna_pf(fc, NULL);
-
-    /*       printf("%g\n", F[2*m]);*/
-    md.temperature += h;
-
-    vrna_params_reset(fc, &md);
-
-    min_en = F[i] + h * 0.00727 * n;
-
-    vrna_exp_params_rescale(fc, &min_en);
-  }
+  (void)vrna_heat_capacity_cb(fc,
+                              opt->T_min,
+                              opt->T_max,
+                              opt->h,
+                              (unsigned int)opt->mpoints,
+                              VRNA_HEAT_CAPACITY_FIT,
+                              &print_heat_capacity,
+                              (void *)o_stream->data);
 
   if (opt->output_queue)
     vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
@@ -528,21 +488,13 @@ process_record(struct record_data *record)
 
 /* ------------------------------------------------------------------------- */
 
-PRIVATE float
-ddiff(float f[],
-      float h,
-      int   m)
+PRIVATE void
+print_heat_capacity(float temperature,
+                    float heat_capacity,
+                    void  *data)
 {
-  int   i;
-  float fp, A, B;
-
-  A = (float)(m * (m + 1) * (2 * m + 1) / 3);                                     /* 2*sum(x^2) */
-  B = (float)(m * (m + 1) * (2 * m + 1)) * (float)(3 * m * m + 3 * m - 1) / 15.;  /* 2*sum(x^4) */
-
-  fp = 0.;
-  for (i = 0; i < 2 * m + 1; i++)
-    fp += f[i] * (A - (float)((2 * m + 1) * (i - m) * (i - m)));
-
-  fp /= ((A * A - B * ((float)(2 * m + 1))) * h * h / 2.);
-  return (float)fp;
+  vrna_cstr_printf_tbody((vrna_cstr_t)data,
+                         "%g\t%g",
+                         temperature,
+                         heat_capacity);
 }
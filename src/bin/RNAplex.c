@@ -33,7 +33,11 @@
 #include "ViennaRNA/plotting/alignments.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/io/utils.h"
+#include "ViennaRNA/io/file_formats_accessibility.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNAplex_cmdl.h"
+#include "parallel_helpers.h"
 
 
 clock_t
@@ -95,6 +99,15 @@ static int **read_plfold_i_bin(char       *fname,
                                int        fast);
 
 
+/* extract a region from a (memory mapped) binary accessibility profile */
+static int **read_plfold_i_mapped(vrna_accessibility_t  *acc,
+                                  const int             beg,
+                                  const int             end,
+                                  double                verhaeltnis,
+                                  const int             length,
+                                  int                   fast);
+
+
 /* Compute and pass opening energies in case of f=2*/
 static int get_sequence_length_from_alignment(char *sequence);
 
@@ -154,6 +167,89 @@ double probcompute_newparameters(char   *s1,
 static int convert_plfold_i(char *fname);/* convert test accessibility into bin accessibility. */
 
 
+/* settings shared by all target-query scans of the file input modes */
+struct options {
+  vrna_md_t       md;
+  int             delta;
+  int             extension_cost;
+  int             alignment_length;
+  int             deltaz;
+  int             fast;
+  int             il_a;
+  int             il_b;
+  int             b_a;
+  int             b_b;
+  unsigned int    seed_length;
+
+  int             jobs;
+  int             keep_order;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+/*
+ *  A target RNA together with its accessibility profile and, unless constraints
+ *  are used, its index. Targets are shared by all scans of the queries against
+ *  them and released by the last one.
+ */
+struct plex_target {
+  char                *id;
+  char                *seq;
+  int                 **access;
+  vrna_plex_target_t  *index;
+  int                 ref_count;
+};
+
+
+struct scan_data {
+  unsigned int        number;
+  struct plex_target  *target;
+  char                *id;
+  char                *seq;
+  int                 **access;
+  char                *structure;
+  vrna_cstr_t         output;
+  struct options      *options;
+};
+
+
+static void init_default_options(struct options *opt);
+
+
+static struct plex_target *create_target(char               *id,
+                                         char               *seq,
+                                         int                **access,
+                                         vrna_plex_target_t *index);
+
+
+static void release_target(struct plex_target *target);
+
+
+static void free_accessibility(int **access);
+
+
+static void submit_scan(struct options      *opt,
+                        struct plex_target  *target,
+                        char                *id,
+                        char                *seq,
+                        int                 **access,
+                        char                *structure);
+
+
+static void process_scan(struct scan_data *scan);
+
+
+static void submit_message(struct options *opt,
+                           const char     *format,
+                           const char     *file);
+
+
+static void flush_cstr_callback(void          *auxdata,
+                                unsigned int  i,
+                                void          *data);
+
+
 static char scale[] = "....,....1....,....2....,....3....,....4"
                       "....,....5....,....6....,....7....,....8";
 
@@ -211,6 +307,10 @@ main(int  argc,
   double                          k_concentration     = 0;
   double                          tris_concentration  = 0;
   int                             probe_mode          = 0;
+  struct options                  opt;
+
+  init_default_options(&opt);
+
   /*
    #############################################
    # check the command line parameters
@@ -235,6 +335,14 @@ main(int  argc,
   alignment_length = args_info.interaction_length_arg;
   /*extension_cost*/
   extension_cost = args_info.extension_cost_arg;
+  /*seed*/
+  if (args_info.seed_given) {
+    if ((args_info.seed_arg < 0) || (args_info.seed_arg > VRNA_PLEX_SEED_MAX))
+      vrna_message_error("Seed length must be in the range [0:%d]", VRNA_PLEX_SEED_MAX);
+
+    opt.seed_length = (unsigned int)args_info.seed_arg;
+  }
+
   /*duplex_distance*/
   deltaz = args_info.duplex_distance_arg;
   /*energy_threshold*/
@@ -267,6 +375,34 @@ main(int  argc,
   if (args_info.binary_given)
     binaries = 1;
 
+  /*jobs*/
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAplex has been built without parallel input processing capabilities");
+#endif
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
+
   /*convert_to_bin*/
   if (args_info.convert_to_bin_given)
     convert = 1;
@@ -547,6 +683,28 @@ main(int  argc,
     /*free allocated memory of commandline parser*/
     RNAplex_cmdline_parser_free(&args_info);
 
+    /* all target-query pairs are scanned with the same settings */
+    set_model_details(&opt.md);
+    opt.delta             = delta;
+    opt.extension_cost    = extension_cost;
+    opt.alignment_length  = alignment_length;
+    opt.deltaz            = deltaz;
+    opt.fast              = fast;
+    opt.il_a              = il_a;
+    opt.il_b              = il_b;
+    opt.b_a               = b_a;
+    opt.b_b               = b_b;
+
+    if ((fold_constrained) && (opt.seed_length > 0)) {
+      vrna_message_warning("Seed filter is not available with constraints, scanning entire targets");
+      opt.seed_length = 0;
+    }
+
+    if ((opt.jobs > 1) && (opt.keep_order))
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+
+    INIT_PARALLELIZATION(opt.jobs);
+
     if (!fold_constrained) {
       if (access) {
         char *id_s1 = NULL;
@@ -614,8 +772,10 @@ main(int  argc,
           }
 
           /*read accessibility*/
-          int   **access_s1;
-          char  *file_s1;
+          int                 **access_s1;
+          char                *file_s1;
+          struct plex_target  *target;
+          vrna_plex_target_t  *index;
           file_s1 = (char *)vrna_alloc(sizeof(char) * (strlen(id_s1) + strlen(access) + 20));
           strcpy(file_s1, access);
           strcat(file_s1, "/");
@@ -629,7 +789,7 @@ main(int  argc,
           }
 
           if (access_s1 == NULL) {
-            printf("Accessibility file %s not found or corrupt, look at next target RNA\n", file_s1);
+            submit_message(&opt, "Accessibility file %s not found or corrupt, look at next target RNA\n", file_s1);
             free(file_s1);
             free(s1);
             free(id_s1);
@@ -637,6 +797,11 @@ main(int  argc,
             continue;
           }
 
+          free(file_s1);
+          index   = vrna_plex_target_init(&(opt.md), s1, (const int **)access_s1, opt.seed_length);
+          target  = create_target(id_s1, s1, access_s1, index);
+          id_s1   = NULL;
+
           do {
             char *id_s2 = NULL;
             if ((line_q = vrna_read_line(sRNA)) == NULL)
@@ -703,7 +868,7 @@ main(int  argc,
             }
 
             if (access_s2 == NULL) {
-              printf("Accessibility file %s not found, look at next target RNA\n", file_s2);
+              submit_message(&opt, "Accessibility file %s not found, look at next target RNA\n", file_s2);
               free(file_s2);
               free(s2);
               free(id_s2);
@@ -711,32 +876,11 @@ main(int  argc,
               continue;
             }
 
-            printf(">%s\n>%s\n", id_s1, id_s2);
-            double  begin = BeginTimer();
-            Lduplexfold_XS(s1, s2, (const int **)access_s1, (const int **)access_s2, delta, alignment_length, deltaz, fast, il_a, il_b, b_a, b_b);
-            float   elapTicks;
-            float   elapMilli;
-            elapTicks = (EndTimer(begin) - begin);
-            elapMilli = elapTicks / 1000;
-            /*             printf("Millisecond %.2f\n",elapMilli); */
-            free(id_s2);
             free(file_s2);
-            free(s2);
-            id_s2 = NULL;
-            i     = access_s2[0][0];
-            while (--i > -1)
-              free(access_s2[i]);
-            free(access_s2);
+            submit_scan(&opt, target, id_s2, s2, access_s2, NULL);
           } while (1);
-          free(id_s1);
-          id_s1 = NULL;
-          free(file_s1);
-          free(s1);
+          release_target(target);
           rewind(sRNA);
-          i = access_s1[0][0];
-          while (--i > -1)
-            free(access_s1[i]);
-          free(access_s1);
         } while (1);
         fclose(mRNA);
         fclose(sRNA);
@@ -806,6 +950,11 @@ main(int  argc,
             if (!noconv && s1[l] == 'T')
               s1[l] = 'U';
           }
+
+          vrna_plex_target_t  *index  = vrna_plex_target_init(&(opt.md), s1, NULL, opt.seed_length);
+          struct plex_target  *target = create_target(id_s1, s1, NULL, index);
+          id_s1 = NULL;
+
           do {
             /*read sRNA files*/
             char *id_s2 = NULL;
@@ -856,22 +1005,9 @@ main(int  argc,
               if (!noconv && s2[l] == 'T')
                 s2[l] = 'U';
             }
-            printf(">%s\n>%s\n", id_s1, id_s2);
-            /*             double begin = BeginTimer(); */
-            Lduplexfold(s1, s2, delta, extension_cost, alignment_length, deltaz, fast, il_a, il_b, b_a, b_b);
-            /* float elapTicks; */
-            /* float elapMilli; */
-            /* elapTicks = (EndTimer(begin) - begin); */
-            /* elapMilli = elapTicks/1000; */
-            /* printf("Millisecond %.2f\n",elapMilli); */
-            /* printf("\n"); */
-            free(id_s2);
-            id_s2 = NULL;
-            free(s2);
+            submit_scan(&opt, target, id_s2, s2, NULL, NULL);
           } while (1);
-          free(id_s1);
-          id_s1 = NULL;
-          free(s1);
+          release_target(target);
           rewind(sRNA);
         } while (1);
         fclose(mRNA);
@@ -945,8 +1081,9 @@ main(int  argc,
           }
 
           /*read accessibility*/
-          int   **access_s1;
-          char  *file_s1;
+          int                 **access_s1;
+          char                *file_s1;
+          struct plex_target  *target;
           file_s1 = (char *)vrna_alloc(sizeof(char) * (strlen(id_s1) + strlen(access) + 20));
           strcpy(file_s1, access);
           strcat(file_s1, "/");
@@ -960,7 +1097,7 @@ main(int  argc,
           }
 
           if (access_s1 == NULL) {
-            printf("Accessibility file %s not found, look at next target RNA\n", file_s1);
+            submit_message(&opt, "Accessibility file %s not found, look at next target RNA\n", file_s1);
             free(file_s1);
             free(s1);
             free(id_s1);
@@ -968,6 +1105,10 @@ main(int  argc,
             continue;
           }
 
+          free(file_s1);
+          target  = create_target(id_s1, s1, access_s1, NULL);
+          id_s1   = NULL;
+
           do {
             char *id_s2 = NULL;
             /*read sRNA files*/
@@ -1053,33 +1194,19 @@ main(int  argc,
             }
 
             if (access_s2 == NULL) {
-              printf("Accessibility file %s not found, look at next target RNA\n", file_s2);
+              submit_message(&opt, "Accessibility file %s not found, look at next target RNA\n", file_s2);
               free(file_s2);
               free(s2);
               free(id_s2);
+              free(structure);
               continue;
             }
 
-            printf(">%s\n>%s\n", id_s1, id_s2);
-            Lduplexfold_CXS(s1, s2, (const int **)access_s1, (const int **)access_s2, delta, alignment_length, deltaz, fast, structure, il_a, il_b, b_a, b_b);/* , target_dead, query_dead); */
-            free(id_s2);
             free(file_s2);
-            free(s2);
-            i = access_s2[0][0];
-            while (--i > -1)
-              free(access_s2[i]);
-            free(access_s2);
-            free(structure);
+            submit_scan(&opt, target, id_s2, s2, access_s2, structure);
           } while (1);
-          free(id_s1);
-          id_s1 = NULL;
-          free(file_s1);
-          free(s1);
+          release_target(target);
           rewind(sRNA);
-          i = access_s1[0][0];
-          while (--i > -1)
-            free(access_s1[i]);
-          free(access_s1);
         } while (1);
         fclose(mRNA);
         fclose(sRNA);
@@ -1150,6 +1277,10 @@ main(int  argc,
             if (!noconv && s1[l] == 'T')
               s1[l] = 'U';
           }
+
+          struct plex_target *target = create_target(id_s1, s1, NULL, NULL);
+          id_s1 = NULL;
+
           do {
             char *id_s2 = NULL;
             /*read sRNA files*/
@@ -1220,27 +1351,19 @@ main(int  argc,
             if (alignment_length < b - a + 1)
               vrna_message_error("Maximal duplex length (-l option) is smaller than constraint on the structures\n. Please adjust the -l option accordingly\n");
 
-            printf(">%s\n>%s\n", id_s1, id_s2);
-            double  begin = BeginTimer();
-            Lduplexfold_C(s1, s2, delta, extension_cost, alignment_length, deltaz, fast, structure, il_a, il_b, b_a, b_b);
-            float   elapTicks;
-            float   elapMilli;
-            elapTicks = EndTimer(begin);
-            elapMilli = elapTicks / 1000;
-            /*             printf("Millisecond %.2f\n",elapMilli); */
-            free(id_s2);
-            free(s2);
-            free(structure);
+            submit_scan(&opt, target, id_s2, s2, NULL, structure);
           } while (1);
-          free(id_s1);
-          id_s1 = NULL;
-          free(s1);
+          release_target(target);
           rewind(sRNA);
         } while (1);
         fclose(mRNA);
         fclose(sRNA);
       }
     }
+
+    UNINIT_PARALLELIZATION
+
+    vrna_ostream_free(opt.output_queue);
   } else if (!qname && !tname && !(alignment_mode)) {
     istty = isatty(fileno(stdout)) && isatty(fileno(stdin));
 
@@ -1575,6 +1698,229 @@ main(int  argc,
 }
 
 
+static void
+init_default_options(struct options *opt)
+{
+  opt->delta            = -INF;
+  opt->extension_cost   = 0;
+  opt->alignment_length = 40;
+  opt->deltaz           = 0;
+  opt->fast             = 0;
+  opt->il_a             = 0;
+  opt->il_b             = 0;
+  opt->b_a              = 0;
+  opt->b_b              = 0;
+  opt->seed_length      = 0;
+
+  opt->jobs               = 1;
+  opt->keep_order         = 1;
+  opt->next_record_number = 0;
+  opt->output_queue       = NULL;
+}
+
+
+static void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  vrna_cstr_t s = (vrna_cstr_t)data;
+
+  /* flush and free data[k] */
+  vrna_cstr_free(s);
+}
+
+
+static struct plex_target *
+create_target(char                *id,
+              char                *seq,
+              int                 **access,
+              vrna_plex_target_t  *index)
+{
+  struct plex_target *target;
+
+  target            = (struct plex_target *)vrna_alloc(sizeof(struct plex_target));
+  target->id        = id;
+  target->seq       = seq;
+  target->access    = access;
+  target->index     = index;
+  target->ref_count = 1; /* held by the input loop until all queries are submitted */
+
+  return target;
+}
+
+
+static void
+release_target(struct plex_target *target)
+{
+  int remaining;
+
+#if VRNA_WITH_PTHREADS
+  remaining = __atomic_sub_fetch(&(target->ref_count), 1, __ATOMIC_ACQ_REL);
+#else
+  remaining = --target->ref_count;
+#endif
+
+  if (remaining == 0) {
+    vrna_plex_target_free(target->index);
+    free(target->id);
+    free(target->seq);
+    free_accessibility(target->access);
+    free(target);
+  }
+}
+
+
+static void
+free_accessibility(int **access)
+{
+  int i;
+
+  if (access) {
+    i = access[0][0];
+    while (--i > -1)
+      free(access[i]);
+    free(access);
+  }
+}
+
+
+/*
+ *  Scan a query against a target, either right away or in one of the
+ *  parallel computation slots. Ownership of the query data is passed on.
+ */
+static void
+submit_scan(struct options      *opt,
+            struct plex_target  *target,
+            char                *id,
+            char                *seq,
+            int                 **access,
+            char                *structure)
+{
+  struct scan_data *scan;
+
+  scan            = (struct scan_data *)vrna_alloc(sizeof(struct scan_data));
+  scan->number    = opt->next_record_number++;
+  scan->target    = target;
+  scan->id        = id;
+  scan->seq       = seq;
+  scan->access    = access;
+  scan->structure = structure;
+  scan->output    = vrna_cstr(0, stdout);
+  scan->options   = opt;
+
+#if VRNA_WITH_PTHREADS
+  __atomic_add_fetch(&(target->ref_count), 1, __ATOMIC_ACQ_REL);
+#else
+  target->ref_count++;
+#endif
+
+  if (opt->output_queue)
+    vrna_ostream_request(opt->output_queue, scan->number);
+
+  RUN_IN_PARALLEL(process_scan, scan);
+}
+
+
+static void
+process_scan(struct scan_data *scan)
+{
+  struct options      *opt;
+  struct plex_target  *target;
+  vrna_plex_t         *plex;
+
+  opt     = scan->options;
+  target  = scan->target;
+  plex    = vrna_plex_init(&(opt->md));
+
+  vrna_plex_set_output(plex, scan->output);
+  vrna_cstr_printf(scan->output, ">%s\n>%s\n", target->id, scan->id);
+
+  if (target->index) {
+    vrna_plex_scan_target(plex,
+                          target->index,
+                          scan->seq,
+                          (const int **)scan->access,
+                          opt->delta,
+                          opt->extension_cost,
+                          opt->alignment_length,
+                          opt->deltaz,
+                          opt->fast,
+                          opt->il_a,
+                          opt->il_b,
+                          opt->b_a,
+                          opt->b_b);
+  } else if (target->access) {
+    vrna_plex_scan_CXS(plex,
+                       target->seq,
+                       scan->seq,
+                       (const int **)target->access,
+                       (const int **)scan->access,
+                       opt->delta,
+                       opt->alignment_length,
+                       opt->deltaz,
+                       opt->fast,
+                       scan->structure,
+                       opt->il_a,
+                       opt->il_b,
+                       opt->b_a,
+                       opt->b_b);
+  } else {
+    vrna_plex_scan_C(plex,
+                     target->seq,
+                     scan->seq,
+                     opt->delta,
+                     opt->extension_cost,
+                     opt->alignment_length,
+                     opt->deltaz,
+                     opt->fast,
+                     scan->structure,
+                     opt->il_a,
+                     opt->il_b,
+                     opt->b_a,
+                     opt->b_b);
+  }
+
+  vrna_plex_free(plex);
+
+  /* print what we've collected in output charstream */
+  if (opt->output_queue)
+    vrna_ostream_provide(opt->output_queue, scan->number, (void *)scan->output);
+  else
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, scan->number, (void *)scan->output));
+
+  release_target(target);
+  free_accessibility(scan->access);
+  free(scan->id);
+  free(scan->seq);
+  free(scan->structure);
+  free(scan);
+}
+
+
+/* report a problem with the input in order with the results */
+static void
+submit_message(struct options *opt,
+               const char     *format,
+               const char     *file)
+{
+  unsigned int  number;
+  vrna_cstr_t   output;
+
+  number  = opt->next_record_number++;
+  output  = vrna_cstr(0, stdout);
+
+  vrna_cstr_printf(output, format, file);
+
+  if (opt->output_queue) {
+    vrna_ostream_request(opt->output_queue, number);
+    vrna_ostream_provide(opt->output_queue, number, (void *)output);
+  } else {
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, number, (void *)output));
+  }
+}
+
+
 #if 0
 static int
 print_struc(duplexT const *dup)
@@ -1756,10 +2102,19 @@ read_plfold_i_bin(char      *fname,
                   const int length,
                   int       fast)
 {
-  double  begin = BeginTimer();
-  FILE    *fp   = fopen(fname, "rb");
-  int     seqlength;
+  double                begin = BeginTimer();
+  FILE                  *fp;
+  int                   seqlength;
+  vrna_accessibility_t  *acc;
 
+  /* versioned profiles are memory mapped and only the requested region is read */
+  if ((acc = vrna_accessibility_read(fname))) {
+    int **access = read_plfold_i_mapped(acc, beg, end, verhaeltnis, length, fast);
+    vrna_accessibility_free(acc);
+    return access;
+  }
+
+  fp = fopen(fname, "rb");
   if (fp == NULL) {
     vrna_message_warning("File ' %s ' open error", fname);
     return NULL;
@@ -1817,6 +2172,47 @@ read_plfold_i_bin(char      *fname,
 }
 
 
+static int **
+read_plfold_i_mapped(vrna_accessibility_t *acc,
+                     const int            beg,
+                     const int            end,
+                     double               verhaeltnis,
+                     const int            length,
+                     int                  fast)
+{
+  int i, u, pos, lim_x, seqlength, **access;
+
+  lim_x     = (int)vrna_accessibility_ulength(acc);
+  seqlength = (int)vrna_accessibility_length(acc);
+
+  if (length > lim_x && fast == 0) {
+    printf("Interaction length %d is larger than the length of the largest region %d \nfor which the opening energy was computed (-u parameter of RNAplfold)\n", length, lim_x);
+    printf("Please recompute your profiles with a larger -u or set -l to a smaller interaction length\n");
+    return NULL;
+  }
+
+  access = (int **)vrna_alloc(sizeof(int *) * (lim_x + 1));
+  for (u = 0; u <= lim_x; u++) {
+    access[u] = (int *)vrna_alloc(sizeof(int) * (end - beg + 1));
+    for (i = 0; i <= end - beg; i++) {
+      /* same offset as in read_plfold_i(), positions outside the sequence are inaccessible */
+      pos = i + beg - 11;
+      if ((u == 0) || (pos < 1) || (pos > seqlength)) {
+        access[u][i] = INF;
+      } else {
+        access[u][i] = vrna_accessibility_energy(acc, (unsigned int)pos, (unsigned int)u);
+        if (access[u][i] < INF)
+          access[u][i] *= verhaeltnis;
+      }
+    }
+  }
+
+  access[0][0] = lim_x + 1;
+
+  return access;
+}
+
+
 static int
 get_max_u(const char  *s,
           char        delim)
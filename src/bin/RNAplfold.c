@@ -27,11 +27,13 @@
 #include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/constraints/SHAPE.h"
 #include "ViennaRNA/io/file_formats.h"
+#include "ViennaRNA/io/file_formats_accessibility.h"
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/commands.h"
 #include "RNAplfold_cmdl.h"
 #include "gengetopt_helper.h"
 #include "input_id_helpers.h"
+#include "parallel_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
@@ -72,21 +74,67 @@ isnan_ld(long double x)
 #endif /* ifndef isnan */
 
 typedef struct {
-  float     cutoff;
-  FILE      *pUfp;
-  FILE      *spup;
-  vrna_ep_t *plist;
-  int       plist_cnt;
-  int       plexoutput;
-  int       simply_putout;
-  int       openenergies;
-  double    **pup;
-  int       ulength;
-  int       n;
-  double    kT;
+  float                     cutoff;
+  FILE                      *pUfp;
+  FILE                      *spup;
+  vrna_ep_t                 *plist;
+  int                       plist_cnt;
+  int                       plexoutput;
+  int                       simply_putout;
+  int                       openenergies;
+  double                    **pup;
+  int                       ulength;
+  int                       n;
+  double                    kT;
+  vrna_accessibility_file_t *acc;
 } plfold_data;
 
-int unpaired;
+struct options {
+  int           filename_full;
+  char          *filename_delim;
+  int           noconv;
+  int           verbose;
+  vrna_md_t     md;
+  vrna_cmd_t    cmds;
+  dataset_id    id_control;
+
+  float         cutoff;
+  int           winsize;
+  int           pairdist;
+  int           unpaired;
+  int           plexoutput;
+  int           simply_putout;
+  int           openenergies;
+  int           binaries;
+  unsigned int  binary_type;
+  int           stream;
+
+  int           shape;
+  char          *shape_file;
+  char          *shape_method;
+  char          *shape_conversion;
+
+  int           jobs;
+  int           failed;
+};
+
+
+struct record_data {
+  char            *id;
+  char            *sequence;
+  char            *SEQ_ID;
+  struct options  *options;
+  int             tty;
+};
+
+
+typedef struct {
+  FILE          *input;
+  char          *prefetch;      /* nucleotides read ahead of the computations */
+  unsigned int  prefetch_size;
+  unsigned int  prefetch_pos;
+  int           noconv;
+} stream_source;
 
 PRIVATE void
 putoutphakim_u(vrna_fold_compound_t *fc,
@@ -132,46 +180,78 @@ print_pu_bin(vrna_fold_compound_t *fc,
              int                  ulength);
 
 
+static int
+process_input(FILE            *input_stream,
+              struct options  *opt);
+
+
+static int
+process_input_stream(FILE           *input_stream,
+                     struct options *opt);
+
+
+static void
+process_record(struct record_data *record);
+
+
+static int
+compute_record_stream(struct options  *opt,
+                      stream_source   *source,
+                      const char      *SEQ_ID);
+
+
+PRIVATE unsigned int
+read_stream_block(char          *buffer,
+                  unsigned int  size,
+                  void          *data);
+
+
+void
+init_default_options(struct options *opt)
+{
+  opt->filename_full  = 0;
+  opt->filename_delim = NULL;
+  opt->noconv         = 0;
+  opt->verbose        = 0;
+  opt->cmds           = NULL;
+
+  set_model_details(&(opt->md));
+
+  opt->cutoff         = 0.01;
+  opt->winsize        = 70;
+  opt->pairdist       = 0;
+  opt->unpaired       = 0;
+  opt->plexoutput     = 0;
+  opt->simply_putout  = 0;
+  opt->openenergies   = 0;
+  opt->binaries       = 0;
+  opt->binary_type    = 0;
+  opt->stream         = 0;
+
+  opt->shape            = 0;
+  opt->shape_file       = NULL;
+  opt->shape_method     = NULL;
+  opt->shape_conversion = NULL;
+
+  opt->jobs   = 1;
+  opt->failed = 0;
+}
+
+
 /*--------------------------------------------------------------------------*/
 int
 main(int  argc,
      char *argv[])
 {
-  FILE                        *pUfp;
   struct RNAplfold_args_info  args_info;
-  char                        *structure, *ParamFile, *ns_bases, *rec_sequence, *rec_id,
-                              **rec_rest, *orig_sequence, *filename_delim, *command_file,
-                              *shape_file, *shape_method, *shape_conversion;
-  unsigned int                rec_type, read_opt;
-  int                         length, istty, winsize, pairdist, tempwin, temppair, tempunpaired,
-                              noconv, i, plexoutput, simply_putout, openenergies, binaries,
-                              filename_full, with_shapes, verbose;
-  float                       cutoff;
-  vrna_exp_param_t            *pf_parameters;
-  vrna_md_t                   md;
-  vrna_cmd_t                  commands;
-  dataset_id                  id_control;
-
-  pUfp          = NULL;
+  char                        *ParamFile, *ns_bases, *command_file;
+  struct options              opt;
+
   dangles       = 2;
-  cutoff        = 0.01;
-  winsize       = 70;
-  pairdist      = 0;
-  unpaired      = 0;
-  simply_putout = plexoutput = openenergies = noconv = 0;
-  binaries      = 0;
-  tempwin       = temppair = tempunpaired = 0;
-  structure     = ParamFile = ns_bases = NULL;
-  rec_type      = read_opt = 0;
-  rec_id        = rec_sequence = orig_sequence = NULL;
-  rec_rest      = NULL;
-  pf_parameters = NULL;
-  filename_full = 0;
+  ParamFile     = ns_bases = NULL;
   command_file  = NULL;
-  commands      = NULL;
-  verbose       = 0;
 
-  set_model_details(&md);
+  init_default_options(&opt);
 
   /*
    #############################################
@@ -182,23 +262,23 @@ main(int  argc,
     exit(1);
 
   if (args_info.verbose_given)
-    verbose = 1;
+    opt.verbose = 1;
 
   /* SHAPE reactivity data */
-  ggo_get_SHAPE(args_info, with_shapes, shape_file, shape_method, shape_conversion);
+  ggo_get_SHAPE(args_info, opt.shape, opt.shape_file, opt.shape_method, opt.shape_conversion);
 
   /* parse options for ID manipulation */
-  ggo_get_id_control(args_info, id_control, "Sequence", "sequence", "_", 4, 1);
+  ggo_get_id_control(args_info, opt.id_control, "Sequence", "sequence", "_", 4, 1);
 
-  ggo_get_md_part(args_info, md);
+  ggo_get_md_part(args_info, opt.md);
 
   /* temperature */
   if (args_info.temp_given)
-    md.temperature = temperature = args_info.temp_arg;
+    opt.md.temperature = temperature = args_info.temp_arg;
 
   /* do not take special tetra loop energies into account */
   if (args_info.noTetra_given)
-    md.special_hp = tetra_loop = 0;
+    opt.md.special_hp = tetra_loop = 0;
 
   /* set dangle model */
   if (args_info.dangles_given) {
@@ -206,28 +286,28 @@ main(int  argc,
       vrna_message_warning(
         "required dangle model not implemented, falling back to default dangles=2");
     else
-      md.dangles = dangles = args_info.dangles_arg;
+      opt.md.dangles = dangles = args_info.dangles_arg;
   }
 
   /* do not allow weak pairs */
   if (args_info.noLP_given)
-    md.noLP = noLonelyPairs = 1;
+    opt.md.noLP = noLonelyPairs = 1;
 
   /* do not allow wobble pairs (GU) */
   if (args_info.noGU_given)
-    md.noGU = noGU = 1;
+    opt.md.noGU = noGU = 1;
 
   /* do not allow weak closing pairs (AU,GU) */
   if (args_info.noClosingGU_given)
-    md.noGUclosure = no_closingGU = 1;
+    opt.md.noGUclosure = no_closingGU = 1;
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* set energy model */
   if (args_info.energyModel_given)
-    md.energy_set = energy_set = args_info.energyModel_arg;
+    opt.md.energy_set = energy_set = args_info.energyModel_arg;
 
   /* take another energy parameter set */
   if (args_info.paramFile_given)
@@ -239,62 +319,100 @@ main(int  argc,
 
   /* set the maximum base pair span */
   if (args_info.span_given)
-    pairdist = args_info.span_arg;
+    opt.pairdist = args_info.span_arg;
 
   /* set the pair probability cutoff */
   if (args_info.cutoff_given)
-    cutoff = args_info.cutoff_arg;
+    opt.cutoff = args_info.cutoff_arg;
 
   /* set the windowsize */
   if (args_info.winsize_given)
-    winsize = args_info.winsize_arg;
+    opt.winsize = args_info.winsize_arg;
 
   /* set the length of unstructured region */
   if (args_info.ulength_given)
-    unpaired = args_info.ulength_arg;
+    opt.unpaired = args_info.ulength_arg;
 
   /* compute opening energies */
   if (args_info.opening_energies_given)
-    openenergies = 1;
+    opt.openenergies = 1;
 
   /* print output on the fly */
   if (args_info.print_onthefly_given)
-    simply_putout = 1;
+    opt.simply_putout = 1;
 
   /* turn on RNAplex output */
   if (args_info.plex_output_given)
-    plexoutput = 1;
+    opt.plexoutput = 1;
 
   /* turn on binary output*/
   if (args_info.binaries_given)
-    binaries = 1;
+    opt.binaries = 1;
+
+  /* binary accessibility profile value type, 0 denotes the legacy format */
+  if (args_info.binary_format_given) {
+    opt.binaries = 1;
+    if (!strcmp(args_info.binary_format_arg, "float32"))
+      opt.binary_type = VRNA_ACCESSIBILITY_FLOAT32;
+    else if (!strcmp(args_info.binary_format_arg, "uint16"))
+      opt.binary_type = VRNA_ACCESSIBILITY_UINT16;
+  }
+
+  /* read sequences block-wise */
+  if (args_info.stream_given)
+    opt.stream = 1;
 
   /* check for errorneous parameter options */
-  if ((pairdist < 0) || (cutoff < 0.) || (unpaired < 0) || (winsize < 0)) {
+  if ((opt.pairdist < 0) || (opt.cutoff < 0.) || (opt.unpaired < 0) || (opt.winsize < 0)) {
     RNAplfold_cmdline_parser_print_help();
     exit(EXIT_FAILURE);
   }
 
   /* filename sanitize delimiter */
   if (args_info.filename_delim_given)
-    filename_delim = strdup(args_info.filename_delim_arg);
-  else if (get_id_delim(id_control))
-    filename_delim = strdup(get_id_delim(id_control));
-  else
-    filename_delim = NULL;
+    opt.filename_delim = strdup(args_info.filename_delim_arg);
+  else if (get_id_delim(opt.id_control))
+    opt.filename_delim = strdup(get_id_delim(opt.id_control));
 
-  if ((filename_delim) && isspace(*filename_delim)) {
-    free(filename_delim);
-    filename_delim = NULL;
+  if ((opt.filename_delim) && isspace(*(opt.filename_delim))) {
+    free(opt.filename_delim);
+    opt.filename_delim = NULL;
   }
 
   /* full filename from FASTA header support */
   if (args_info.filename_full_given)
-    filename_full = 1;
+    opt.filename_full = 1;
 
   if (args_info.commands_given)
     command_file = strdup(args_info.commands_arg);
 
+  if (args_info.numThreads_given)
+    opt.md.num_threads = MAX2(0, args_info.numThreads_arg);
+
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAplfold has been built without parallel input processing capabilities");
+#endif
+  }
+
   /* free allocated memory of command line data structure */
   RNAplfold_cmdline_parser_free(&args_info);
 
@@ -311,46 +429,132 @@ main(int  argc,
   }
 
   if (ns_bases != NULL)
-    vrna_md_set_nonstandards(&md, ns_bases);
+    vrna_md_set_nonstandards(&(opt.md), ns_bases);
 
   if (command_file != NULL)
-    commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+    opt.cmds = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
   /* check parameter options again and reset to reasonable values if needed */
-  if (openenergies && !unpaired)
-    unpaired = 31;
+  if (opt.openenergies && !opt.unpaired)
+    opt.unpaired = 31;
 
-  if (pairdist == 0)
-    pairdist = winsize;
+  if (opt.pairdist == 0)
+    opt.pairdist = opt.winsize;
 
-  if (pairdist > winsize) {
+  if (opt.pairdist > opt.winsize) {
     vrna_message_warning("pairdist (-L %d) should be <= winsize (-W %d);"
                          "Setting pairdist=winsize",
-                         pairdist, winsize);
-    pairdist = winsize;
+                         opt.pairdist, opt.winsize);
+    opt.pairdist = opt.winsize;
   }
 
   if (dangles % 2) {
     vrna_message_warning("using default dangles = 2");
-    md.dangles = dangles = 2;
+    opt.md.dangles = dangles = 2;
   }
 
-  istty     = isatty(fileno(stdout)) && isatty(fileno(stdin));
-  read_opt  |= VRNA_INPUT_NO_REST;
-  if (istty) {
-    vrna_message_input_seq_simple();
-    read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
+  if ((opt.simply_putout) && (opt.plexoutput)) {
+    vrna_message_warning("plexoutput not available in simple output mode!\n"
+                         "Switching back to full mode instead!");
+    opt.simply_putout = 0;
   }
 
+  if ((opt.simply_putout) && (opt.binaries) && (!opt.binary_type)) {
+    vrna_message_warning("binary output not available in simple output mode!\n"
+                         "Switching back to full mode instead!");
+    opt.simply_putout = 0;
+  }
+
+  if (opt.stream) {
+    if ((opt.plexoutput) || ((opt.binaries) && (!opt.binary_type)) || (opt.shape) ||
+        (command_file))
+      vrna_message_error("Streamed input can not be combined with constraints, "
+                         "RNAplex, or int32 binary output");
+
+    if (opt.winsize == 0)
+      vrna_message_error("Streamed input requires a positive window size");
+
+    if (opt.jobs > 1) {
+      vrna_message_warning("Streamed input disables parallel input processing");
+      opt.jobs = 1;
+    }
+
+    /* streamed sequences are never kept in memory */
+    opt.simply_putout = 1;
+  }
+
+  /* we always compute base pair probabilities */
+  opt.md.compute_bpp = 1;
+
+  if ((opt.verbose) && (opt.jobs > 1))
+    vrna_message_info(stderr, "Preparing %d parallel computation slots", opt.jobs);
+
   /*
    #############################################
    # main loop: continue until end of file
    #############################################
    */
-  while (
-    !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, NULL, read_opt))
-      & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
-    char *SEQ_ID = NULL;
+  INIT_PARALLELIZATION(opt.jobs);
+
+  (void)process_input(stdin, &opt);
+
+  UNINIT_PARALLELIZATION
+
+  free(ParamFile);
+  free(ns_bases);
+  free(opt.filename_delim);
+  free(command_file);
+  free(opt.shape_file);
+  free(opt.shape_method);
+  free(opt.shape_conversion);
+  vrna_commands_free(opt.cmds);
+
+  free_id_data(opt.id_control);
+
+  return EXIT_SUCCESS;
+}
+
+
+/* main loop that processes an input stream */
+static int
+process_input(FILE            *input_stream,
+              struct options  *opt)
+{
+  int           ret     = 1;
+  int           failed  = 0;
+  int           istty   = isatty(fileno(stdout)) && isatty(fileno(stdin));
+
+  unsigned int  read_opt = VRNA_INPUT_NO_REST;
+
+  if (opt->stream)
+    return process_input_stream(input_stream, opt);
+
+  /* print user help if we get input from tty */
+  if (istty) {
+    vrna_message_input_seq_simple();
+    read_opt |= VRNA_INPUT_NOSKIP_BLANK_LINES;
+  }
+
+  /* main loop that processes each record obtained from input stream */
+  do {
+    char          *rec_sequence, *rec_id, **rec_rest;
+    unsigned int  rec_type;
+
+    rec_id    = NULL;
+    rec_rest  = NULL;
+
+    rec_type = vrna_file_fasta_read_record(&rec_id,
+                                           &rec_sequence,
+                                           &rec_rest,
+                                           input_stream,
+                                           read_opt);
+
+    if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
+      break;
+
+    /* we do not make use of the rest of the record */
+    free(rec_rest);
+
     /*
      ########################################################
      # init everything according to the data we've read
@@ -360,290 +564,527 @@ main(int  argc,
       rec_id = memmove(rec_id, rec_id + 1, strlen(rec_id));
 
     /* construct the sequence ID */
-    set_next_id(&rec_id, id_control);
-    SEQ_ID = fileprefix_from_id(rec_id, id_control, filename_full);
+    set_next_id(&rec_id, opt->id_control);
 
-    length    = (int)strlen(rec_sequence);
-    structure = (char *)vrna_alloc(sizeof(char) * (length + 1));
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv)
-      vrna_seq_toRNA(rec_sequence);
+    record->sequence  = rec_sequence;
+    record->SEQ_ID    = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
+    record->id        = rec_id;
+    record->options   = opt;
+    record->tty       = istty;
 
-    /* store case-unmodified sequence */
-    orig_sequence = strdup(rec_sequence);
-    /* convert sequence to uppercase letters only */
-    vrna_seq_toupper(rec_sequence);
+    RUN_IN_PARALLEL(process_record, record);
 
+    /* stop reading input if something went wrong in a previously processed record */
+    ATOMIC_BLOCK(failed = opt->failed);
+
+    if (opt->shape || failed) {
+      ret = 0;
+      break;
+    }
+
+    /* print user help for the next round if we get input from tty */
     if (istty)
-      vrna_message_info(stdout, "length = %d", length);
+      vrna_message_input_seq_simple();
+  } while (1);
 
-    /*
-     ########################################################
-     # done with 'stdin' handling
-     ########################################################
-     */
+  return ret;
+}
 
-    if (length > 1000000) {
-      if (!simply_putout && !unpaired) {
-        vrna_message_warning("Switched to simple output mode!!!");
-        simply_putout = 1;
+
+/* main loop that processes an input stream block-wise */
+static int
+process_input_stream(FILE           *input_stream,
+                     struct options *opt)
+{
+  char                *rec_id, *SEQ_ID;
+  int                 r;
+  unsigned int        rec_type, n;
+  stream_source       source;
+  struct record_data  *record;
+
+  do {
+    rec_id    = NULL;
+    rec_type  = vrna_file_fasta_read_header(&rec_id, input_stream);
+
+    if (rec_type & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))
+      break;
+
+    if (rec_id) /* remove '>' from FASTA header */
+      rec_id = memmove(rec_id, rec_id + 1, strlen(rec_id));
+
+    /* construct the sequence ID */
+    set_next_id(&rec_id, opt->id_control);
+
+    SEQ_ID = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
+
+    /* read ahead to detect sequences that are shorter than the window */
+    source.input          = input_stream;
+    source.prefetch       = (char *)vrna_alloc(sizeof(char) * (opt->winsize + 2));
+    source.prefetch_size  = 0;
+    source.prefetch_pos   = 0;
+    source.noconv         = opt->noconv;
+
+    while ((source.prefetch_size <= (unsigned int)opt->winsize) &&
+           ((n = vrna_file_fasta_read_block(source.prefetch + source.prefetch_size,
+                                            opt->winsize + 1 - source.prefetch_size,
+                                            (void *)input_stream)) > 0))
+      source.prefetch_size += n;
+
+    if (source.prefetch_size <= (unsigned int)opt->winsize) {
+      /* short sequences are processed as usual */
+      record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
+
+      record->sequence  = source.prefetch;
+      record->SEQ_ID    = SEQ_ID;
+      record->id        = rec_id;
+      record->options   = opt;
+      record->tty       = 0;
+
+      process_record(record);
+    } else {
+      r = compute_record_stream(opt, &source, (SEQ_ID) ? SEQ_ID : "plfold");
+
+      if (!r) {
+        vrna_message_warning("Something bad happened while processing the input! "
+                             "Aborting now...");
+        opt->failed = 1;
       }
-    }
 
-    if ((simply_putout) && (plexoutput)) {
-      vrna_message_warning("plexoutput not available in simple output mode!\n"
-                           "Switching back to full mode instead!");
-      simply_putout = 0;
-    }
+      (void)fflush(stdout);
 
-    if ((simply_putout) && (binaries)) {
-      vrna_message_warning("binary output not available in simple output mode!\n"
-                           "Switching back to full mode instead!");
-      simply_putout = 0;
+      free(source.prefetch);
+      free(rec_id);
+      free(SEQ_ID);
     }
+  } while (!opt->failed);
 
-    /* restore winsize if altered before */
-    if (tempwin != 0) {
-      winsize = tempwin;
-      tempwin = 0;
-    }
+  return (opt->failed) ? 0 : 1;
+}
 
-    /* restore pairdist if altered before */
-    if (temppair != 0) {
-      pairdist  = temppair;
-      temppair  = 0;
-    }
 
-    /* restore ulength if altered before */
-    if (tempunpaired != 0) {
-      unpaired      = tempunpaired;
-      tempunpaired  = 0;
+/*
+ *  Compute the base pair and unpaired probabilities of a single record
+ *  and write them to the respective files. All settings that are adjusted
+ *  for the current record are kept local, such that multiple records can
+ *  be processed at the same time.
+ */
+static int
+compute_record(struct options *opt,
+               char           *rec_sequence,
+               char           *orig_sequence,
+               const char     *SEQ_ID)
+{
+  FILE                  *pUfp;
+  char                  *fname1, *fname2, *fname3, *fname4, *ffname, *tmp_string;
+  int                   i, r, length, winsize, pairdist, unpaired, simply_putout;
+  unsigned int          plfold_opt;
+  vrna_md_t             md;
+  vrna_exp_param_t      *pf_parameters;
+  vrna_fold_compound_t  *fc;
+  plfold_data           data;
+
+  length        = (int)strlen(rec_sequence);
+  winsize       = opt->winsize;
+  pairdist      = opt->pairdist;
+  unpaired      = opt->unpaired;
+  simply_putout = opt->simply_putout;
+
+  if (length > 1000000) {
+    if (!simply_putout && !unpaired) {
+      vrna_message_warning("Switched to simple output mode!!!");
+      simply_putout = 1;
     }
+  }
 
-    /* adjust winsize, pairdist and ulength if necessary */
-    if (length < winsize) {
-      vrna_message_warning("window size %d larger than sequence length %d", winsize, length);
-      tempwin = winsize;
-      winsize = length;
-      if (pairdist > winsize) {
-        temppair  = pairdist;
-        pairdist  = winsize;
-      }
+  if ((simply_putout) && ((opt->plexoutput) || ((opt->binaries) && (!opt->binary_type))))
+    simply_putout = 0;
 
-      if (unpaired > winsize) {
-        tempunpaired  = unpaired;
-        unpaired      = winsize;
-      }
+  /* adjust winsize, pairdist and ulength if necessary */
+  if (length < winsize) {
+    vrna_message_warning("window size %d larger than sequence length %d", winsize, length);
+    winsize = length;
+    if (pairdist > winsize)
+      pairdist = winsize;
+
+    if (unpaired > winsize)
+      unpaired = winsize;
+  }
+
+  /* construct output file names */
+  fname1  = vrna_strdup_printf("%s%slunp", SEQ_ID, opt->filename_delim);
+  fname2  = vrna_strdup_printf("%s%sbasepairs", SEQ_ID, opt->filename_delim);
+  fname3  = vrna_strdup_printf("%s%suplex", SEQ_ID, opt->filename_delim);
+  fname4  = (opt->binaries) ?
+            vrna_strdup_printf("%s%sopenen%sbin",
+                               SEQ_ID,
+                               opt->filename_delim,
+                               opt->filename_delim) :
+            vrna_strdup_printf("%s%sopenen",
+                               SEQ_ID,
+                               opt->filename_delim);
+  ffname = vrna_strdup_printf("%s%sdp.ps", SEQ_ID, opt->filename_delim);
+
+  /* sanitize filenames */
+  tmp_string = vrna_filename_sanitize(fname1, opt->filename_delim);
+  free(fname1);
+  fname1      = tmp_string;
+  tmp_string  = vrna_filename_sanitize(fname2, opt->filename_delim);
+  free(fname2);
+  fname2      = tmp_string;
+  tmp_string  = vrna_filename_sanitize(fname3, opt->filename_delim);
+  free(fname3);
+  fname3      = tmp_string;
+  tmp_string  = vrna_filename_sanitize(fname4, opt->filename_delim);
+  free(fname4);
+  fname4      = tmp_string;
+  tmp_string  = vrna_filename_sanitize(ffname, opt->filename_delim);
+  free(ffname);
+  ffname = tmp_string;
+
+  md              = opt->md;
+  md.window_size  = winsize;
+  md.max_bp_span  = pairdist;
+
+  fc = vrna_fold_compound(rec_sequence, &md, VRNA_OPTION_WINDOW);
+
+  if (opt->shape) {
+    vrna_constraints_add_SHAPE(fc,
+                               opt->shape_file,
+                               opt->shape_method,
+                               opt->shape_conversion,
+                               opt->verbose,
+                               VRNA_OPTION_DEFAULT | VRNA_OPTION_WINDOW);
+  }
+
+  if (opt->cmds)
+    vrna_commands_apply(fc, opt->cmds, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
+
+  pf_parameters = vrna_exp_params(&md);
+
+  /* prepare data structure for callback */
+  data.cutoff         = opt->cutoff;
+  data.spup           = (simply_putout) ? fopen(fname2, "w") : NULL;
+  data.plexoutput     = opt->plexoutput;
+  data.simply_putout  = simply_putout;
+  data.openenergies   = opt->openenergies;
+  data.plist          = NULL;
+  data.plist_cnt      = 0;
+  data.ulength        = unpaired;
+  data.n              = length;
+  data.kT             = pf_parameters->kT;
+  data.acc            = NULL;
+
+  if ((unpaired > 0) && (opt->binary_type)) {
+    /* write binary accessibility profile on-the-fly */
+    data.acc  = vrna_file_accessibility_open(fname4, unpaired, data.kT / 1000., opt->binary_type);
+    data.pup  = NULL;
+    data.pUfp = NULL;
+    if (opt->plexoutput) {
+      data.pup        = (double **)vrna_alloc(MAX2(unpaired, length + 1) * sizeof(double *));
+      data.pup[0]     = (double *)vrna_alloc(sizeof(double));
+      data.pup[0][0]  = unpaired;
     }
+  } else if (unpaired > 0) {
+    if (simply_putout) {
+      data.pup  = NULL;
+      data.pUfp = fopen(opt->openenergies ? fname4 : fname1, "w");
+      prepare_up_file(&data);
+    } else {
+      /* if we don't print on-the-fly we store unpaired probabilities for later */
+      data.pup        = (double **)vrna_alloc(MAX2(unpaired, length + 1) * sizeof(double *));
+      data.pup[0]     = (double *)vrna_alloc(sizeof(double));   /*I only need entry 0*/
+      data.pup[0][0]  = unpaired;
+      data.pUfp       = NULL;
+    }
+  } else {
+    data.pup  = NULL;
+    data.pUfp = NULL;
+  }
 
-    /*
-     ########################################################
-     # begin actual computations
-     ########################################################
-     */
+  /* prepare option flags */
+  plfold_opt = 0;
+
+  /* always compute base pair probabilities */
+  plfold_opt |= VRNA_PROBS_WINDOW_BPP;
+
+  if (unpaired > 0)
+    plfold_opt |= VRNA_PROBS_WINDOW_UP;
 
-    if (length > 0) {
-      /* construct output file names */
-      char *fname1, *fname2, *fname3, *fname4, *ffname, *tmp_string;
-
-      if (!SEQ_ID)
-        SEQ_ID = strdup("plfold");
-
-      fname1  = vrna_strdup_printf("%s%slunp", SEQ_ID, filename_delim);
-      fname2  = vrna_strdup_printf("%s%sbasepairs", SEQ_ID, filename_delim);
-      fname3  = vrna_strdup_printf("%s%suplex", SEQ_ID, filename_delim);
-      fname4  = (binaries) ?
-                vrna_strdup_printf("%s%sopenen%sbin",
-                                   SEQ_ID,
-                                   filename_delim,
-                                   filename_delim) :
-                vrna_strdup_printf("%s%sopenen",
-                                   SEQ_ID,
-                                   filename_delim);
-      ffname = vrna_strdup_printf("%s%sdp.ps", SEQ_ID, filename_delim);
-
-      /* sanitize filenames */
-      tmp_string = vrna_filename_sanitize(fname1, filename_delim);
-      free(fname1);
-      fname1      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname2, filename_delim);
-      free(fname2);
-      fname2      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname3, filename_delim);
-      free(fname3);
-      fname3      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(fname4, filename_delim);
-      free(fname4);
-      fname4      = tmp_string;
-      tmp_string  = vrna_filename_sanitize(ffname, filename_delim);
-      free(ffname);
-      ffname = tmp_string;
-
-
-      md.compute_bpp  = 1;
-      md.window_size  = winsize;
-      md.max_bp_span  = pairdist;
-
-      vrna_fold_compound_t *fc = vrna_fold_compound(rec_sequence, &md, VRNA_OPTION_WINDOW);
-
-      if (with_shapes) {
-        vrna_constraints_add_SHAPE(fc,
-                                   shape_file,
-                                   shape_method,
-                                   shape_conversion,
-                                   verbose,
-                                   VRNA_OPTION_DEFAULT | VRNA_OPTION_WINDOW);
+  /* perform recursions, unless we failed to create the binary accessibility profile */
+  if ((unpaired > 0) && (opt->binary_type) && (!data.acc))
+    r = 0;
+  else
+    r = vrna_probs_window(fc, unpaired, plfold_opt, &plfold_callback, (void *)&data);
+
+  if ((r) && (!simply_putout)) {
+    /* create dot plot output */
+    PS_dot_plot_turn(orig_sequence, data.plist, ffname, pairdist);
+
+    /* print unpaired probabilities */
+    if (unpaired > 0) {
+      if (opt->plexoutput) {
+        pUfp = fopen(fname3, "w");
+        putoutphakim_u(fc, data.pup, length, unpaired, pUfp);
+        fclose(pUfp);
       }
 
-      if (commands)
-        vrna_commands_apply(fc, commands, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
-
-      pf_parameters = vrna_exp_params(&md);
-
-      /* prepare data structure for callback */
-      plfold_data data;
-
-      data.cutoff         = cutoff;
-      data.spup           = (simply_putout) ? fopen(fname2, "w") : NULL;
-      data.plexoutput     = plexoutput;
-      data.simply_putout  = simply_putout;
-      data.openenergies   = openenergies;
-      data.plist          = NULL;
-      data.plist_cnt      = 0;
-      data.ulength        = unpaired;
-      data.n              = length;
-      data.kT             = pf_parameters->kT;
-
-      if (unpaired > 0) {
-        if (simply_putout) {
-          data.pup  = NULL;
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          prepare_up_file(&data);
+      /* print unpaired probabilities to file, unless already written on-the-fly */
+      if (!data.acc) {
+        data.pUfp = fopen(opt->openenergies ? fname4 : fname1, "w");
+        if (opt->binaries) {
+          print_pu_bin(fc, &data, unpaired);
         } else {
-          /* if we don't print on-the-fly we store unpaired probabilities for later */
-          data.pup        = (double **)vrna_alloc(MAX2(unpaired, length + 1) * sizeof(double *));
-          data.pup[0]     = (double *)vrna_alloc(sizeof(double));   /*I only need entry 0*/
-          data.pup[0][0]  = unpaired;
-          data.pUfp       = NULL;
+          prepare_up_file(&data);
+          if (opt->openenergies) {
+            for (i = 1; i <= length; i++)
+              print_up_open(data.pUfp,
+                            i,
+                            data.pup[i],
+                            (i > unpaired) ? unpaired : i,
+                            unpaired,
+                            data.kT / 1000.);
+          } else {
+            for (i = 1; i <= length; i++)
+              print_up(data.pUfp, i, data.pup[i], (i > unpaired) ? unpaired : i, unpaired);
+          }
         }
-      } else {
-        data.pup  = NULL;
+
+        fclose(data.pUfp);
         data.pUfp = NULL;
       }
+    }
+  }
 
-      /* prepare option flags */
-      unsigned int plfold_opt = 0;
+  if (data.pup) {
+    for (i = 0; i <= length; i++)
+      free(data.pup[i]);
+    free(data.pup);
+  }
 
-      /* always compute base pair probabilities */
-      plfold_opt |= VRNA_PROBS_WINDOW_BPP;
+  vrna_fold_compound_free(fc);
 
-      if (unpaired > 0)
-        plfold_opt |= VRNA_PROBS_WINDOW_UP;
+  free(pf_parameters);
 
-      /* perform recursions */
-      int r = vrna_probs_window(fc, unpaired, plfold_opt, &plfold_callback, (void *)&data);
+  /* clean up data */
+  if ((data.acc) && (!vrna_file_accessibility_close(data.acc))) {
+    vrna_message_warning("Failed to write accessibility profile \"%s\"", fname4);
+    r = 0;
+  }
 
-      if (!r) {
-        vrna_message_warning("Something bad happened while processing the input! "
-                             "Aborting now...");
-        goto rnaplfold_exit;
-      }
+  if (data.pUfp)
+    fclose(data.pUfp);
 
-      if (!simply_putout) {
-        /* create dot plot output */
-        PS_dot_plot_turn(orig_sequence, data.plist, ffname, pairdist);
+  if (data.spup)
+    fclose(data.spup);
 
-        /* print unpaired probabilities */
-        if (unpaired > 0) {
-          if (plexoutput) {
-            pUfp = fopen(fname3, "w");
-            putoutphakim_u(fc, data.pup, length, unpaired, pUfp);
-            fclose(pUfp);
-          }
+  free(data.plist);
 
-          /* print unpaired probabilities to file */
+  free(fname1);
+  free(fname2);
+  free(fname3);
+  free(fname4);
+  free(ffname);
 
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          if (binaries) {
-            print_pu_bin(fc, &data, unpaired);
-          } else {
-            prepare_up_file(&data);
-            if (openenergies) {
-              for (i = 1; i <= length; i++)
-                print_up_open(data.pUfp,
-                              i,
-                              data.pup[i],
-                              (i > unpaired) ? unpaired : i,
-                              unpaired,
-                              data.kT / 1000.);
-            } else {
-              for (i = 1; i <= length; i++)
-                print_up(data.pUfp, i, data.pup[i], (i > unpaired) ? unpaired : i, unpaired);
-            }
-          }
+  return r;
+}
 
-          fclose(data.pUfp);
-          data.pUfp = NULL;
 
-          for (i = 0; i <= length; i++)
-            free(data.pup[i]);
-          free(data.pup);
-        }
-      }
+/*
+ *  Same as compute_record() in simple output mode, but the sequence is
+ *  read block-wise from the input stream
+ */
+static int
+compute_record_stream(struct options  *opt,
+                      stream_source   *source,
+                      const char      *SEQ_ID)
+{
+  char              *fname1, *fname2, *fname4, *tmp_string;
+  int               r, unpaired;
+  unsigned int      plfold_opt;
+  vrna_md_t         md;
+  vrna_exp_param_t  *pf_parameters;
+  plfold_data       data;
+
+  unpaired = opt->unpaired;
+
+  /* construct output file names */
+  fname1  = vrna_strdup_printf("%s%slunp", SEQ_ID, opt->filename_delim);
+  fname2  = vrna_strdup_printf("%s%sbasepairs", SEQ_ID, opt->filename_delim);
+  fname4  = (opt->binary_type) ?
+            vrna_strdup_printf("%s%sopenen%sbin",
+                               SEQ_ID,
+                               opt->filename_delim,
+                               opt->filename_delim) :
+            vrna_strdup_printf("%s%sopenen", SEQ_ID, opt->filename_delim);
+
+  /* sanitize filenames */
+  tmp_string = vrna_filename_sanitize(fname1, opt->filename_delim);
+  free(fname1);
+  fname1      = tmp_string;
+  tmp_string  = vrna_filename_sanitize(fname2, opt->filename_delim);
+  free(fname2);
+  fname2      = tmp_string;
+  tmp_string  = vrna_filename_sanitize(fname4, opt->filename_delim);
+  free(fname4);
+  fname4 = tmp_string;
+
+  md              = opt->md;
+  md.window_size  = opt->winsize;
+  md.max_bp_span  = opt->pairdist;
+
+  pf_parameters = vrna_exp_params(&md);
+
+  /* prepare data structure for callback */
+  data.cutoff         = opt->cutoff;
+  data.spup           = fopen(fname2, "w");
+  data.plexoutput     = 0;
+  data.simply_putout  = 1;
+  data.openenergies   = opt->openenergies;
+  data.plist          = NULL;
+  data.plist_cnt      = 0;
+  data.ulength        = unpaired;
+  data.n              = 0; /* unknown */
+  data.kT             = pf_parameters->kT;
+  data.pup            = NULL;
+  data.pUfp           = NULL;
+  data.acc            = NULL;
+
+  if (unpaired > 0) {
+    if (opt->binary_type) {
+      data.acc = vrna_file_accessibility_open(fname4, unpaired, data.kT / 1000., opt->binary_type);
+    } else {
+      data.pUfp = fopen(opt->openenergies ? fname4 : fname1, "w");
+      prepare_up_file(&data);
+    }
+  }
 
-      vrna_fold_compound_free(fc);
+  /* prepare option flags */
+  plfold_opt = VRNA_PROBS_WINDOW_BPP;
 
-      free(pf_parameters);
+  if (unpaired > 0)
+    plfold_opt |= VRNA_PROBS_WINDOW_UP;
 
-      /* clean up data */
-      if (data.pUfp)
-        fclose(data.pUfp);
+  /* perform recursions, unless we failed to create the binary accessibility profile */
+  if ((unpaired > 0) && (opt->binary_type) && (!data.acc))
+    r = 0;
+  else
+    r = vrna_probs_window_source(&md,
+                                 unpaired,
+                                 plfold_opt,
+                                 &read_stream_block,
+                                 (void *)source,
+                                 &plfold_callback,
+                                 (void *)&data);
+
+  free(pf_parameters);
+
+  /* clean up data */
+  if ((data.acc) && (!vrna_file_accessibility_close(data.acc))) {
+    vrna_message_warning("Failed to write accessibility profile \"%s\"", fname4);
+    r = 0;
+  }
 
-      if (data.spup)
-        fclose(data.spup);
+  if (data.pUfp)
+    fclose(data.pUfp);
 
-      free(data.plist);
+  if (data.spup)
+    fclose(data.spup);
 
+  free(fname1);
+  free(fname2);
+  free(fname4);
 
-      free(fname1);
-      free(fname2);
-      free(fname3);
-      free(fname4);
-      free(ffname);
-    }
+  return r;
+}
 
-    (void)fflush(stdout);
 
-    /* clean up */
-    free(rec_id);
-    free(rec_sequence);
-    free(orig_sequence);
-    free(structure);
-    free(SEQ_ID);
+static void
+process_record(struct record_data *record)
+{
+  char            *rec_sequence, *SEQ_ID;
+  int             length, r;
+  struct options  *opt;
 
-    if (with_shapes)
-      break;
+  opt     = record->options;
+  SEQ_ID  = record->SEQ_ID;
+  length  = (int)strlen(record->sequence);
+  r       = 1;
 
-    rec_id    = rec_sequence = orig_sequence = NULL;
-    rec_rest  = NULL;
+  /* convert DNA alphabet to RNA if not explicitely switched off */
+  if (!opt->noconv)
+    vrna_seq_toRNA(record->sequence);
 
-    /* print user help for the next round if we get input from tty */
-    if (istty)
-      vrna_message_input_seq_simple();
+  /* store case-unmodified sequence */
+  rec_sequence = strdup(record->sequence);
+  /* convert sequence to uppercase letters only */
+  vrna_seq_toupper(rec_sequence);
+
+  if (record->tty)
+    vrna_message_info(stdout, "length = %d", length);
+
+  /*
+   ########################################################
+   # begin actual computations
+   ########################################################
+   */
+
+  if (length > 0) {
+    if (SEQ_ID) {
+      r = compute_record(opt, rec_sequence, record->sequence, SEQ_ID);
+    } else {
+      /*
+       *  records without ID share the same output files, so we must not
+       *  process them at the same time
+       */
+      THREADSAFE_FILE_OUTPUT(r = compute_record(opt, rec_sequence, record->sequence, "plfold"));
+    }
   }
 
-rnaplfold_exit:
+  if (!r) {
+    vrna_message_warning("Something bad happened while processing the input! "
+                         "Aborting now...");
+    ATOMIC_BLOCK(opt->failed = 1);
+  }
 
-  free(filename_delim);
-  free(command_file);
-  free(shape_method);
-  free(shape_conversion);
-  vrna_commands_free(commands);
+  (void)fflush(stdout);
 
-  free_id_data(id_control);
+  /* clean up */
+  free(record->id);
+  free(record->sequence);
+  free(rec_sequence);
+  free(SEQ_ID);
+  free(record);
+}
 
-  return EXIT_SUCCESS;
+
+PRIVATE unsigned int
+read_stream_block(char          *buffer,
+                  unsigned int  size,
+                  void          *data)
+{
+  unsigned int  k, r;
+  stream_source *s = (stream_source *)data;
+
+  if (s->prefetch_pos < s->prefetch_size) {
+    /* pass the nucleotides we've read ahead first */
+    r = MIN2(size, s->prefetch_size - s->prefetch_pos);
+    memcpy(buffer, s->prefetch + s->prefetch_pos, sizeof(char) * r);
+    s->prefetch_pos += r;
+  } else {
+    r = vrna_file_fasta_read_block(buffer, size, (void *)s->input);
+  }
+
+  for (k = 0; k < r; k++) {
+    buffer[k] = toupper(buffer[k]);
+
+    /* convert DNA alphabet to RNA if not explicitely switched off */
+    if ((!s->noconv) && (buffer[k] == 'T'))
+      buffer[k] = 'U';
+  }
+
+  return r;
 }
 
 
@@ -763,7 +1204,11 @@ plfold_callback(FLT_OR_DBL    *pr,
 
   /* limit output to full unpaired probabilities */
   if ((type & VRNA_PROBS_WINDOW_UP) && ((type & VRNA_ANY_LOOP) == VRNA_ANY_LOOP)) {
-    if (!d->simply_putout) {
+    /* write binary accessibility profile on-the-fly */
+    if (d->acc)
+      vrna_file_accessibility_add(d->acc, i, pr, pr_size);
+
+    if (d->pup) {
       /* store unpaired probabilities in an array */
 
       /* first allocate some memory */
@@ -774,7 +1219,7 @@ plfold_callback(FLT_OR_DBL    *pr,
         d->pup[i][cnt] = pr[cnt];
       for (cnt = pr_size + 1; cnt <= max; cnt++)
         d->pup[i][cnt] = 0.;
-    } else {
+    } else if (!d->acc) {
       /* print unpaired probabilities to output file handle */
       if (d->openenergies)
         print_up_open(d->pUfp, i, pr, pr_size, max, d->kT / 1000.);
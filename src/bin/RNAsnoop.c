@@ -29,7 +29,108 @@
 #include "ViennaRNA/utils/strings.h"
 #include "ViennaRNA/utils/alignments.h"
 #include "ViennaRNA/io/utils.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNAsnoop_cmdl.h"
+#include "parallel_helpers.h"
+
+/* settings shared by all target scans of the single sequence mode */
+struct options {
+  int             noconv;
+  int             nice;
+  int             fast;
+  int             plfold_up_flag;
+  char            *access;
+  char            *suffix;
+  int             delta;
+  int             penalty;
+  int             threshloop;
+  int             threshLE;
+  int             threshRE;
+  int             threshDE;
+  int             threshTE;
+  int             threshSE;
+  int             threshD;
+  int             distance;
+  int             half_stem;
+  int             max_half_stem;
+  int             min_s2;
+  int             max_s2;
+  int             min_s1;
+  int             max_s1;
+  int             min_d1;
+  int             min_d2;
+  int             max_asymm;
+  int             alignment_length;
+  vrna_md_t       md;
+
+  int             jobs;
+  int             keep_order;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+/*
+ *  A snoRNA whose stem structures have been computed with snofold(). All
+ *  scans of the targets against it must finish before the next snoRNA is
+ *  folded, since snofold() keeps its DP arrays in global memory.
+ */
+struct snorna {
+  char  *name;
+  char  *seq;
+  int   stem_energy;
+};
+
+
+struct scan_data {
+  unsigned int    number;
+  struct snorna   *sno;
+  char            *name;
+  char            *seq;
+  int             **access;
+  vrna_cstr_t     output;
+  struct options  *options;
+};
+
+
+static void init_default_options(struct options *opt);
+
+
+static int process_input(struct options *opt,
+                         FILE           *sno,
+                         FILE           *mrna);
+
+
+static void submit_scan(struct options  *opt,
+                        struct snorna   *sno,
+                        char            *name,
+                        char            *seq,
+                        int             **access,
+                        vrna_cstr_t     output);
+
+
+static void process_scan(struct scan_data *scan);
+
+
+static void submit_output(struct options  *opt,
+                          vrna_cstr_t     output);
+
+
+static void free_accessibility(int **access);
+
+
+static void plot_interaction(char *seq,
+                             char *structure,
+                             char *file,
+                             int  cut);
+
+
+static void flush_cstr_callback(void          *auxdata,
+                                unsigned int  i,
+                                void          *data);
+
+
 static void  aliprint_struc(snoopT      *dup,
                             const char  **s1,
                             const char  **s2,
@@ -39,7 +140,8 @@ static void  aliprint_struc(snoopT      *dup,
                             int);
 
 
-static void  print_struc(snoopT     *dup,
+static void  print_struc(vrna_cstr_t output,
+                         snoopT     *dup,
                          const char *s1,
                          const char *s2,
                          char *,
@@ -87,15 +189,11 @@ main(int  argc,
      char *argv[])
 {
   struct        RNAsnoop_args_info  args_info;
-  char                              *string_s, *line_s, *name_s, *temp_s; /*string for snoRNA*/
-  char                              *string_t, *line_t, *temp_t;          /*string for target RNA*/
-  char                              *structure  = NULL, *cstruc = NULL;
   char                              *sname      = NULL, *tname = NULL /*name of the sno RNa file, mRNA file respectively*/;
-  char                              *name       = NULL;
   char                              *access;
   char                              *result_file;
   char                              *output_directory;
-  int                               fullStemEnergy;
+  struct options                    opt;
 
   output_directory  = NULL;
   result_file       = NULL;
@@ -108,7 +206,7 @@ main(int  argc,
   /* long int elapTicks; */
   /* clock_t Begin, End; */
   int                               plfold_up_flag = 0;
-  int                               nice, i, r, l, length_s,  /* , length_t,  */
+  int                               nice, i, status,
                                     penalty,                  /*extension penalty*/
                                     threshloop,               /*energy threshold on loop*/
                                     threshLE,                 /*energy threshold on the S2 part*/
@@ -133,8 +231,10 @@ main(int  argc,
                                     redraw /*if used (option I) allow to redraw command line output into ps files */;
 
   int noconv = 0;
-  string_s            = NULL;
-  string_t            = NULL;
+
+  init_default_options(&opt);
+
+  status              = 0;
   plfold_up_flag      = 0;
   alignment           = 0;
   redraw              = 0;
@@ -232,6 +332,33 @@ main(int  argc,
   /*threshold on minimal lower stem energy*/
   alignment_length = args_info.alignmentLength_arg;
 
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAsnoop has been built without parallel input processing capabilities");
+#endif
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
+
   threshloop = MIN2(threshloop, 0);
 
   /*   if(plfold_up_flag && !fast){ */
@@ -285,247 +412,52 @@ main(int  argc,
       return 0;
     }
 
-    do {
-      /* main loop: continue until end of file */
-      if ((line_s = vrna_read_line(sno)) == NULL) {
-        free(line_s);
-        break;
-      }
-
-      /* skip comment lines and get filenames */
-      while ((*line_s == '*') || (*line_s == '\0') || (*line_s == '>')) {
-        if (*line_s == '>')
-          name_s = (char *)vrna_alloc(strlen(line_s) + 1);
-
-        (void)sscanf(line_s, "%s", name_s);
-        free(line_s);
-        if ((line_s = vrna_read_line(sno)) == NULL) {
-          free(line_s);
-          break;
-        }
-      }
-      if (name_s == NULL) {
-        printf("Your snoRNA sequence: \n%s\nhas no header. Please update your fasta file\n", line_s);
-        exit(0);
-      }
-
-      /*   if ((line ==NULL) || (strcmp(line, "@") == 0)) break; */
-      temp_s = (char *)vrna_alloc(strlen(line_s) + 1);
-      (void)sscanf(line_s, "%s", temp_s);
-      free(line_s);
-      length_s = (int)strlen(temp_s);
-      for (l = 0; l < length_s; l++) {
-        temp_s[l] = toupper(temp_s[l]);
-        if (!noconv && temp_s[l] == 'T')
-          temp_s[l] = 'U';
-      }
-      string_s = (char *)vrna_alloc(length_s + 11);
-      strcpy(string_s, "NNNNN");
-      strcat(string_s + 5, temp_s);
-      strcat(string_s + 5 + length_s, "NNNNN\0");
-      free(temp_s);
-      /* We declare the structure variable here as it will also contains the final stem structure */
-      structure = (char *)vrna_alloc((unsigned)length_s + 11);
-      if (fold_constrained) {
-        cstruc = vrna_read_line(sno);
-        if (cstruc != NULL) {
-          int dn3 = strlen(cstruc) - (length_s - 10);
-          strcpy(structure, ".....");
-          strcat(structure, cstruc);
-          if (dn3 >= 0) {
-            strcat(structure, ".....\0");
-          } else {
-            while (dn3++)
-              strcat(structure, ".");
-            strcat(structure, "\0");
-          }
+    opt.noconv            = noconv;
+    opt.nice              = nice;
+    opt.fast              = fast;
+    opt.plfold_up_flag    = plfold_up_flag;
+    opt.access            = access;
+    opt.suffix            = suffix;
+    opt.delta             = delta;
+    opt.penalty           = penalty;
+    opt.threshloop        = threshloop;
+    opt.threshLE          = threshLE;
+    opt.threshRE          = threshRE;
+    opt.threshDE          = threshDE;
+    opt.threshTE          = threshTE;
+    opt.threshSE          = threshSE;
+    opt.threshD           = threshD;
+    opt.distance          = distance;
+    opt.half_stem         = half_stem;
+    opt.max_half_stem     = max_half_stem;
+    opt.min_s2            = min_s2;
+    opt.max_s2            = max_s2;
+    opt.min_s1            = min_s1;
+    opt.max_s1            = max_s1;
+    opt.min_d1            = min_d1;
+    opt.min_d2            = min_d2;
+    opt.max_asymm         = max_asymm;
+    opt.alignment_length  = alignment_length;
+
+    set_model_details(&(opt.md));
+
+    /* the interaction plots of the library functions use the global cut_point */
+    if ((opt.jobs > 1) && (nice)) {
+      vrna_message_warning("Direct output of structure plots (-N option) is not available for "
+                           "parallel processing, falling back to serial computation");
+      opt.jobs = 1;
+    }
 
-          /* Now we fold with constraints the  */
-        }
-      }
+    if ((opt.jobs > 1) && (opt.keep_order))
+      opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
 
-      fullStemEnergy = snofold(string_s, structure, max_asymm, threshloop, min_s2, max_s2, half_stem, max_half_stem);
-      do {
-        /* main loop for target continue until end of file */
-        snoopT  mfe;
-        if ((line_t = vrna_read_line(mrna)) == NULL)
-          /* free(line_t); */
-          break;
-
-        char    *name_t = NULL;
+    INIT_PARALLELIZATION(opt.jobs);
 
-        /* skip comment lines and get filenames */
-        while ((*line_t == '*') || (*line_t == '\0') || (*line_t == '>')) {
-          if (*line_t == '>') {
-            printf("%s\n", name_s);
-            name_t = (char *)vrna_alloc(strlen(line_t) + 1);
-            (void)sscanf(line_t, "%s", name_t);
+    status = process_input(&opt, sno, mrna);
 
-            printf("%s\n", name_t);
-            free(line_t);
-            /*             free(string_t); */
-          }
+    UNINIT_PARALLELIZATION
 
-          if ((line_t = vrna_read_line(mrna)) == NULL) {
-            free(line_t);
-            break;
-          }
-        }
-        if (name_t == NULL) {
-          printf("Your target sequence: \n%s\nhas no header. Please update your fasta file\n", line_t);
-          exit(0);
-        }
-
-        /*   if ((line ==NULL) || (strcmp(line, "@") == 0)) break; */
-        temp_t = (char *)vrna_alloc(strlen(line_t) + 1);
-        (void)sscanf(line_t, "%s", temp_t);
-        int length_t;
-        length_t = (int)strlen(temp_t);
-        for (l = 0; l < length_t; l++) {
-          temp_t[l] = toupper(temp_t[l]);
-          if (!noconv && temp_t[l] == 'T')
-            temp_t[l] = 'U';
-        }
-        string_t = (char *)vrna_alloc(length_t + 11);
-        strcpy(string_t, "NNNNN");
-        strcat(string_t + 5, temp_t);
-        strcat(string_t + 5 + length_t, "NNNNN");
-        free(temp_t);
-        char *name_output;
-        name_output = NULL;
-        if (nice) {
-          name_output = (char *)vrna_alloc(sizeof(char) * (length_t + length_s + 2));
-          strcpy(name_output, name_t + 1);
-          strcat(name_output, "_");
-          strcat(name_output, name_s + 1);
-          name_output[length_t + length_s + 1] = '\0';
-        }
-
-        if (delta >= 0) {
-          snoopT  *subopt;
-          snoopT  *sub;
-          if (!fast && !plfold_up_flag) {
-            subopt = snoop_subopt(string_t, string_s, delta, 5, penalty, threshloop,
-                                  threshLE, threshRE, threshDE, threshTE, threshSE, threshD, distance,
-                                  half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, fullStemEnergy);
-            if (subopt == NULL) {
-              printf("no target found under the given constraints\n");
-              free(subopt);
-              free(string_t);
-              free(line_t);
-              continue;
-            }
-
-            int count = 0;
-            for (sub = subopt; sub->structure != NULL; sub++) {
-              print_struc(sub, string_t, string_s, name_s, name_t, count++, nice);
-              free(sub->structure);
-            }
-            free(subopt);
-            free(string_t);
-            free(line_t);
-          } else if (!plfold_up_flag) {
-            Lsnoop_subopt_list(string_t, string_s, delta, 5, penalty, threshloop,
-                               threshLE, threshRE, threshDE, threshTE, threshSE, threshD, distance,
-                               half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, alignment_length, name_output, fullStemEnergy);
-            free(string_t);
-            free(line_t);
-          } else {
-            if (plfold_up_flag == 1) {
-              int   **access_s1;
-              char  *file_s1;
-              int   s1_len;/* k;*/ /*,j; */
-              s1_len  = strlen(string_t);
-              file_s1 = (char *)vrna_alloc(sizeof(char) * (strlen(name_t + 1) + strlen(access) + 9));
-              strcpy(file_s1, access);
-              strcat(file_s1, "/");
-              strcat(file_s1, name_t + 1);
-              strcat(file_s1, "_openen");
-              access_s1 = read_plfold_i(file_s1, 1, s1_len);
-              if (fast) {
-                Lsnoop_subopt_list_XS(string_t, string_s, (const int **)access_s1, delta, 5, penalty, threshloop,
-                                      threshLE, threshRE, threshDE, threshTE, threshSE, threshD, distance,
-                                      half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, alignment_length, name_output, fullStemEnergy);
-              } else {
-                snoop_subopt_XS(string_t, string_s, (const int **)access_s1, delta, 5, penalty, threshloop,
-                                threshLE, threshRE, threshDE, threshTE, threshSE, threshD, distance,
-                                half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, alignment_length, name_output, fullStemEnergy);
-              }
-
-              /*                for(j=0; j<s1_len; j++){  */
-              /*                  for(k=0; k<access_s1[0][0];k++){  */
-              /*                    printf("%d \t",access_s1[k][j]);  */
-              /*                  }  */
-              /*                  printf("\n");  */
-              /*                }  */
-              free(file_s1);
-              free(string_t);
-              free(line_t);
-              int i = access_s1[0][0];
-              while (--i > -1)
-                free(access_s1[i]);
-              free(access_s1);
-            } else if (plfold_up_flag == 2) {
-              int   **access_s1;
-              char  *file_s1;
-              int   s1_len, k;/* ,j; */
-              s1_len  = strlen(string_t);
-              file_s1 = (char *)vrna_alloc(sizeof(char) * (strlen(name_t + 1) + strlen(suffix) + strlen(access) + 3));
-              strcpy(file_s1, access);
-              strcat(file_s1, "/");
-              strcat(file_s1, name_t + 1);
-              strcat(file_s1, "_");
-              strcat(file_s1, suffix);
-              access_s1 = read_rnaup(file_s1, 1, s1_len);
-              if (fast) {
-                Lsnoop_subopt_list_XS(string_t, string_s, (const int **)access_s1, delta, 5, penalty, threshloop,
-                                      threshLE, threshRE, threshDE, threshTE, threshSE, threshD, distance,
-                                      half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, alignment_length, name_output, fullStemEnergy);
-              } else {
-                snoop_subopt_XS(string_t, string_s, (const int **)access_s1, delta, 5, penalty, threshloop,
-                                threshLE, threshRE, threshDE, threshTE, threshSE, threshD, distance,
-                                half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, alignment_length, name_output, fullStemEnergy);
-              }
-
-              /*                for(j=0; j<s1_len; j++){  */
-              /*                  for(k=0; k<access_s1[0][0];k++){  */
-              /*                    printf("%d \t",access_s1[k][j]);  */
-              /*                  }  */
-              /*                  printf("\n");  */
-              /*                }  */
-              free(file_s1);
-              free(string_t);
-              free(line_t);
-              k = access_s1[0][0];
-              while (--k > -1)
-                free(access_s1[k]);
-              free(access_s1);
-            }
-          }
-        } else {
-          mfe = snoopfold(string_t, string_s, penalty, threshloop, threshLE, threshRE, threshDE, threshD,
-                          half_stem, max_half_stem, min_s2, max_s2, min_s1, max_s1, min_d1, min_d2, fullStemEnergy);
-          if (mfe.energy < INF) {
-            print_struc(&mfe, string_t, string_s, name_s, name_t, 0, 1);
-            free(mfe.structure);
-          }
-
-          free(line_t);
-          length_t = (int)strlen(string_t);
-          free(string_t);
-        }
-
-        free(name_t);
-        if (nice)
-          free(name_output);
-      } while (1);
-      rewind(mrna);
-      snofree_arrays(strlen(string_s));  /* free's base_pair */
-      free(string_s);
-      string_s = NULL;
-      free(name_s);
-      name_s = NULL;
-    } while (1);
+    vrna_ostream_free(opt.output_queue);
   } else {
     if (tname == NULL || sname == NULL)
       RNAsnoop_cmdline_parser_print_help();
@@ -615,12 +547,409 @@ main(int  argc,
 
   fclose(sno);
   fclose(mrna);
-  return 0;
+  return status;
+}
+
+
+static void
+init_default_options(struct options *opt)
+{
+  opt->noconv         = 0;
+  opt->nice           = 0;
+  opt->fast           = 0;
+  opt->plfold_up_flag = 0;
+  opt->access         = NULL;
+  opt->suffix         = NULL;
+  opt->delta          = -1;
+
+  opt->jobs               = 1;
+  opt->keep_order         = 1;
+  opt->next_record_number = 0;
+  opt->output_queue       = NULL;
+}
+
+
+static void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  vrna_cstr_t s = (vrna_cstr_t)data;
+
+  /* flush and free data[k] */
+  vrna_cstr_free(s);
+}
+
+
+/*
+ *  Fold the snoRNAs of the query file one after another and scan the targets
+ *  of the target file against each of them. Returns the exit status
+ */
+static int
+process_input(struct options  *opt,
+              FILE            *sno,
+              FILE            *mrna)
+{
+  char          *line_s, *name_s, *temp_s, *string_s, *structure, *cstruc;
+  char          *line_t, *name_t, *temp_t, *string_t, *file_s1;
+  int           l, length_s, length_t, status, stop, **access_s1;
+  struct snorna snorna;
+  vrna_cstr_t   output;
+
+  name_s  = NULL;
+  status  = 0;
+  stop    = 0;
+
+  do {
+    /* main loop: continue until end of file */
+    if ((line_s = vrna_read_line(sno)) == NULL)
+      break;
+
+    /* skip comment lines and get filenames */
+    while ((*line_s == '*') || (*line_s == '\0') || (*line_s == '>')) {
+      if (*line_s == '>')
+        name_s = (char *)vrna_alloc(strlen(line_s) + 1);
+
+      (void)sscanf(line_s, "%s", name_s);
+      free(line_s);
+      if ((line_s = vrna_read_line(sno)) == NULL)
+        break;
+    }
+
+    if (line_s == NULL) {
+      free(name_s);
+      break;
+    }
+
+    if (name_s == NULL) {
+      output = vrna_cstr(0, stdout);
+      vrna_cstr_printf(output,
+                       "Your snoRNA sequence: \n%s\nhas no header. Please update your fasta file\n",
+                       line_s);
+      submit_output(opt, output);
+      free(line_s);
+      break;
+    }
+
+    /*   if ((line ==NULL) || (strcmp(line, "@") == 0)) break; */
+    temp_s = (char *)vrna_alloc(strlen(line_s) + 1);
+    (void)sscanf(line_s, "%s", temp_s);
+    free(line_s);
+    length_s = (int)strlen(temp_s);
+    for (l = 0; l < length_s; l++) {
+      temp_s[l] = toupper(temp_s[l]);
+      if (!opt->noconv && temp_s[l] == 'T')
+        temp_s[l] = 'U';
+    }
+    string_s = (char *)vrna_alloc(length_s + 11);
+    strcpy(string_s, "NNNNN");
+    strcat(string_s + 5, temp_s);
+    strcat(string_s + 5 + length_s, "NNNNN\0");
+    free(temp_s);
+    /* We declare the structure variable here as it will also contains the final stem structure */
+    structure = (char *)vrna_alloc((unsigned)length_s + 11);
+    if (fold_constrained) {
+      cstruc = vrna_read_line(sno);
+      if (cstruc != NULL) {
+        int dn3 = strlen(cstruc) - (length_s - 10);
+        strcpy(structure, ".....");
+        strcat(structure, cstruc);
+        if (dn3 >= 0) {
+          strcat(structure, ".....\0");
+        } else {
+          while (dn3++)
+            strcat(structure, ".");
+          strcat(structure, "\0");
+        }
+
+        /* Now we fold with constraints the  */
+      }
+    }
+
+    snorna.name         = name_s;
+    snorna.seq          = string_s;
+    snorna.stem_energy  = snofold(string_s,
+                                  structure,
+                                  opt->max_asymm,
+                                  opt->threshloop,
+                                  opt->min_s2,
+                                  opt->max_s2,
+                                  opt->half_stem,
+                                  opt->max_half_stem);
+
+    do {
+      /* main loop for target continue until end of file */
+      if ((line_t = vrna_read_line(mrna)) == NULL)
+        break;
+
+      name_t  = NULL;
+      output  = vrna_cstr(0, stdout);
+
+      /* skip comment lines and get filenames */
+      while ((*line_t == '*') || (*line_t == '\0') || (*line_t == '>')) {
+        if (*line_t == '>') {
+          vrna_cstr_printf(output, "%s\n", name_s);
+          free(name_t);
+          name_t = (char *)vrna_alloc(strlen(line_t) + 1);
+          (void)sscanf(line_t, "%s", name_t);
+
+          vrna_cstr_printf(output, "%s\n", name_t);
+        }
+
+        free(line_t);
+
+        if ((line_t = vrna_read_line(mrna)) == NULL)
+          break;
+      }
+
+      if (line_t == NULL) {
+        submit_output(opt, output);
+        free(name_t);
+        break;
+      }
+
+      if (name_t == NULL) {
+        vrna_cstr_printf(output,
+                         "Your target sequence: \n%s\nhas no header. Please update your fasta file\n",
+                         line_t);
+        submit_output(opt, output);
+        free(line_t);
+        stop = 1;
+        break;
+      }
+
+      /*   if ((line ==NULL) || (strcmp(line, "@") == 0)) break; */
+      temp_t = (char *)vrna_alloc(strlen(line_t) + 1);
+      (void)sscanf(line_t, "%s", temp_t);
+      free(line_t);
+      length_t = (int)strlen(temp_t);
+      for (l = 0; l < length_t; l++) {
+        temp_t[l] = toupper(temp_t[l]);
+        if (!opt->noconv && temp_t[l] == 'T')
+          temp_t[l] = 'U';
+      }
+      string_t = (char *)vrna_alloc(length_t + 11);
+      strcpy(string_t, "NNNNN");
+      strcat(string_t + 5, temp_t);
+      strcat(string_t + 5 + length_t, "NNNNN");
+      free(temp_t);
+
+      /* read the accessibility profile of the target */
+      access_s1 = NULL;
+      if ((opt->delta >= 0) && (opt->plfold_up_flag)) {
+        if (opt->plfold_up_flag == 1) {
+          file_s1 = (char *)vrna_alloc(sizeof(char) * (strlen(name_t + 1) + strlen(opt->access) + 9));
+          strcpy(file_s1, opt->access);
+          strcat(file_s1, "/");
+          strcat(file_s1, name_t + 1);
+          strcat(file_s1, "_openen");
+          access_s1 = read_plfold_i(file_s1, 1, strlen(string_t));
+        } else {
+          file_s1 =
+            (char *)vrna_alloc(sizeof(char) *
+                               (strlen(name_t + 1) + strlen(opt->suffix) + strlen(opt->access) + 3));
+          strcpy(file_s1, opt->access);
+          strcat(file_s1, "/");
+          strcat(file_s1, name_t + 1);
+          strcat(file_s1, "_");
+          strcat(file_s1, opt->suffix);
+          access_s1 = read_rnaup(file_s1, 1, strlen(string_t));
+        }
+
+        free(file_s1);
+
+        if (access_s1 == NULL) {
+          submit_output(opt, output);
+          free(name_t);
+          free(string_t);
+          status  = EXIT_FAILURE;
+          stop    = 1;
+          break;
+        }
+      }
+
+      submit_scan(opt, &snorna, name_t, string_t, access_s1, output);
+    } while (1);
+
+    /* all scans against this snoRNA must finish before its DP arrays are released */
+    WAIT_FOR_ALL_JOBS;
+
+    rewind(mrna);
+    snofree_arrays(strlen(string_s));  /* free's base_pair */
+    free(string_s);
+    string_s = NULL;
+    free(name_s);
+    name_s = NULL;
+  } while (!stop);
+
+  return status;
 }
 
 
+/*
+ *  Scan a target against the current snoRNA, either right away or in one of
+ *  the parallel computation slots. Ownership of the target data is passed on.
+ */
 static void
-print_struc(snoopT      *dup,
+submit_scan(struct options  *opt,
+            struct snorna   *sno,
+            char            *name,
+            char            *seq,
+            int             **access,
+            vrna_cstr_t     output)
+{
+  struct scan_data *scan;
+
+  scan          = (struct scan_data *)vrna_alloc(sizeof(struct scan_data));
+  scan->number  = opt->next_record_number++;
+  scan->sno     = sno;
+  scan->name    = name;
+  scan->seq     = seq;
+  scan->access  = access;
+  scan->output  = output;
+  scan->options = opt;
+
+  if (opt->output_queue)
+    vrna_ostream_request(opt->output_queue, scan->number);
+
+  RUN_IN_PARALLEL(process_scan, scan);
+}
+
+
+static void
+process_scan(struct scan_data *scan)
+{
+  char            *name_output, *string_s, *string_t, *name_s, *name_t;
+  int             length_s, length_t, count;
+  snoopT          mfe, *subopt, *sub;
+  struct options  *opt;
+  vrna_snoop_t    *snoop;
+
+  opt       = scan->options;
+  string_s  = scan->sno->seq;
+  name_s    = scan->sno->name;
+  string_t  = scan->seq;
+  name_t    = scan->name;
+  length_s  = (int)strlen(string_s) - 10;
+  length_t  = (int)strlen(string_t) - 10;
+  snoop     = vrna_snoop_init(&(opt->md));
+
+  vrna_snoop_set_output(snoop, scan->output);
+
+  name_output = NULL;
+  if (opt->nice) {
+    name_output = (char *)vrna_alloc(sizeof(char) * (length_t + length_s + 2));
+    strcpy(name_output, name_t + 1);
+    strcat(name_output, "_");
+    strcat(name_output, name_s + 1);
+    name_output[length_t + length_s + 1] = '\0';
+  }
+
+  if (opt->delta >= 0) {
+    if (!opt->fast && !opt->plfold_up_flag) {
+      subopt = vrna_snoop_subopt(snoop, string_t, string_s, opt->delta, 5, opt->penalty,
+                                 opt->threshloop, opt->threshLE, opt->threshRE, opt->threshDE,
+                                 opt->threshTE, opt->threshSE, opt->threshD, opt->distance,
+                                 opt->half_stem, opt->max_half_stem, opt->min_s2, opt->max_s2,
+                                 opt->min_s1, opt->max_s1, opt->min_d1, opt->min_d2,
+                                 scan->sno->stem_energy);
+      if (subopt == NULL) {
+        vrna_cstr_printf(scan->output, "no target found under the given constraints\n");
+      } else {
+        count = 0;
+        for (sub = subopt; sub->structure != NULL; sub++) {
+          print_struc(scan->output, sub, string_t, string_s, name_s, name_t, count++, opt->nice);
+          free(sub->structure);
+        }
+        free(subopt);
+      }
+    } else if (!opt->plfold_up_flag) {
+      vrna_Lsnoop_subopt_list(snoop, string_t, string_s, opt->delta, 5, opt->penalty,
+                              opt->threshloop, opt->threshLE, opt->threshRE, opt->threshDE,
+                              opt->threshTE, opt->threshSE, opt->threshD, opt->distance,
+                              opt->half_stem, opt->max_half_stem, opt->min_s2, opt->max_s2,
+                              opt->min_s1, opt->max_s1, opt->min_d1, opt->min_d2,
+                              opt->alignment_length, name_output, scan->sno->stem_energy);
+    } else if (opt->fast) {
+      vrna_Lsnoop_subopt_list_XS(snoop, string_t, string_s, (const int **)scan->access,
+                                 opt->delta, 5, opt->penalty,
+                                 opt->threshloop, opt->threshLE, opt->threshRE, opt->threshDE,
+                                 opt->threshTE, opt->threshSE, opt->threshD, opt->distance,
+                                 opt->half_stem, opt->max_half_stem, opt->min_s2, opt->max_s2,
+                                 opt->min_s1, opt->max_s1, opt->min_d1, opt->min_d2,
+                                 opt->alignment_length, name_output, scan->sno->stem_energy);
+    } else {
+      vrna_snoop_subopt_XS(snoop, string_t, string_s, (const int **)scan->access,
+                           opt->delta, 5, opt->penalty,
+                           opt->threshloop, opt->threshLE, opt->threshRE, opt->threshDE,
+                           opt->threshTE, opt->threshSE, opt->threshD, opt->distance,
+                           opt->half_stem, opt->max_half_stem, opt->min_s2, opt->max_s2,
+                           opt->min_s1, opt->max_s1, opt->min_d1, opt->min_d2,
+                           opt->alignment_length, name_output, scan->sno->stem_energy);
+    }
+  } else {
+    mfe = vrna_snoopfold(snoop, string_t, string_s, opt->penalty, opt->threshloop,
+                         opt->threshLE, opt->threshRE, opt->threshDE, opt->threshD,
+                         opt->half_stem, opt->max_half_stem, opt->min_s2, opt->max_s2,
+                         opt->min_s1, opt->max_s1, opt->min_d1, opt->min_d2,
+                         scan->sno->stem_energy);
+    if (mfe.energy < INF) {
+      print_struc(scan->output, &mfe, string_t, string_s, name_s, name_t, 0, 1);
+      free(mfe.structure);
+    }
+  }
+
+  vrna_snoop_free(snoop);
+
+  /* print what we've collected in output charstream */
+  if (opt->output_queue)
+    vrna_ostream_provide(opt->output_queue, scan->number, (void *)scan->output);
+  else
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, scan->number, (void *)scan->output));
+
+  free_accessibility(scan->access);
+  free(name_output);
+  free(scan->name);
+  free(scan->seq);
+  free(scan);
+}
+
+
+/* pass output that does not belong to a scan on in order with the results */
+static void
+submit_output(struct options  *opt,
+              vrna_cstr_t     output)
+{
+  unsigned int number;
+
+  number = opt->next_record_number++;
+
+  if (opt->output_queue) {
+    vrna_ostream_request(opt->output_queue, number);
+    vrna_ostream_provide(opt->output_queue, number, (void *)output);
+  } else {
+    ATOMIC_BLOCK(flush_cstr_callback(NULL, number, (void *)output));
+  }
+}
+
+
+static void
+free_accessibility(int **access)
+{
+  int i;
+
+  if (access) {
+    i = access[0][0];
+    while (--i > -1)
+      free(access[i]);
+    free(access);
+  }
+}
+
+
+static void
+print_struc(vrna_cstr_t output,
+            snoopT      *dup,
             const char  *s1,
             const char  *s2,
             char        *name_s,
@@ -656,11 +985,12 @@ print_struc(snoopT      *dup,
   s4  = (char *)vrna_alloc(sizeof(char) * (n2 - 9));
   strncpy(s4, s2 + 5, n2 - 10);
   s4[n2 - 10] = '\0';
-  printf("%s %3d,%-3d;%3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f + %5.2f + 4.1 ) (%5.2f) \n%s&%s\n",
-         target_struct, dup->i + 1 - l1,
-         dup->i, dup->u, dup->j + 1, dup->j + (int)(strrchr(dup->structure, '>') - strchr(dup->structure, '>')) + 1,
-         (dup->Loop_D + dup->Duplex_El + dup->Duplex_Er + dup->Loop_E) + 4.10,
-         dup->Duplex_El, dup->Duplex_Er, dup->Loop_E, dup->Loop_D, dup->fullStemEnergy, target, s4);
+  vrna_cstr_printf(output,
+                   "%s %3d,%-3d;%3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f + %5.2f + 4.1 ) (%5.2f) \n%s&%s\n",
+                   target_struct, dup->i + 1 - l1,
+                   dup->i, dup->u, dup->j + 1, dup->j + (int)(strrchr(dup->structure, '>') - strchr(dup->structure, '>')) + 1,
+                   (dup->Loop_D + dup->Duplex_El + dup->Duplex_Er + dup->Loop_E) + 4.10,
+                   dup->Duplex_El, dup->Duplex_Er, dup->Loop_E, dup->Loop_D, dup->fullStemEnergy, target, s4);
   if (nice) {
     char  *temp_seq;
     char  *temp_struc;
@@ -672,7 +1002,6 @@ print_struc(snoopT      *dup,
     strcat(temp_struc, target_struct + l1 + 1);
     temp_seq[n2 + l1 - 10]    = '\0';
     temp_struc[n2 + l1 - 10]  = '\0';
-    cut_point                 = l1 + 1;
 
     psoutput = vrna_strdup_printf("sno_%d_u_%d_%s_%s.ps",
                                   count,
@@ -680,8 +1009,7 @@ print_struc(snoopT      *dup,
                                   name_t + 1,
                                   name_s + 1);
 
-    PS_rna_plot_snoop_a(temp_seq, temp_struc, psoutput, NULL, NULL);
-    cut_point = -1;
+    THREADSAFE_FILE_OUTPUT(plot_interaction(temp_seq, temp_struc, psoutput, l1 + 1));
     free(temp_seq);
     free(temp_struc);
     free(psoutput);
@@ -693,6 +1021,19 @@ print_struc(snoopT      *dup,
 }
 
 
+/* the plot is drawn according to the global cut_point */
+static void
+plot_interaction(char *seq,
+                 char *structure,
+                 char *file,
+                 int  cut)
+{
+  cut_point = cut;
+  PS_rna_plot_snoop_a(seq, structure, file, NULL, NULL);
+  cut_point = -1;
+}
+
+
 static void
 aliprint_struc(snoopT     *dup,
                const char **s1,
@@ -851,7 +1192,7 @@ read_rnaup(char       *fname,
     printf("%s", fname);
     perror("RNAup File open error here, Computing next target");
 
-    exit(EXIT_FAILURE);
+    return NULL;
   }
 
   char tmp[2048] = {
@@ -933,7 +1274,7 @@ read_plfold_i(char      *fname,
 
   if (in == NULL) {
     perror(" open error");
-    exit(EXIT_FAILURE);
+    return NULL;
   }
 
   char tmp[2048] = {
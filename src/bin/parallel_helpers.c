@@ -7,6 +7,10 @@
  *
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -18,6 +22,126 @@
 #include <string.h>
 #include <errno.h>
 
+#if VRNA_WITH_PTHREADS
+#include <pthread.h>
+#endif
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/fold_compound.h"
+
+/*
+ *  parallel_helpers.h is not included here since it defines the global
+ *  mutexes and thread pool of the executable programs
+ */
+typedef struct fc_pool_s *fc_pool;
+
+
+struct fc_pool_s {
+  vrna_fold_compound_t  **fcs;
+  unsigned int          num;
+  unsigned int          size;
+  unsigned int          max_length;
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_t       mtx;
+#endif
+};
+
+
+static vrna_fold_compound_t *
+fc_pool_pop(fc_pool               pool,
+            vrna_fc_type_e        type,
+            unsigned int          length);
+
+
+static unsigned int
+fc_capacity(vrna_fold_compound_t *fc);
+
+
+#if VRNA_WITH_PTHREADS
+
+typedef struct job_scheduler_s *job_scheduler;
+
+
+struct job {
+  void  (*fun)(void *);
+  void  *data;
+};
+
+
+/* a simple counting semaphore */
+struct counter {
+  pthread_mutex_t mtx;
+  pthread_cond_t  cond;
+  unsigned int    value;
+};
+
+
+/* the job queue of a single worker, a ring buffer that can hold all jobs of the scheduler */
+struct job_queue {
+  pthread_mutex_t mtx;
+  struct job      *jobs;
+  unsigned int    first;
+  unsigned int    num;
+};
+
+
+struct worker {
+  job_scheduler scheduler;
+  unsigned int  id;
+  pthread_t     thread;
+};
+
+
+struct job_scheduler_s {
+  unsigned int      num_workers;
+  unsigned int      queue_size;
+  struct worker     *workers;
+  struct job_queue  *queues;
+  unsigned int      next_queue;   /* queue that receives the next job */
+  struct counter    free_slots;   /* number of jobs that may be added without blocking */
+  struct counter    pending;      /* number of jobs that have not been claimed by a worker */
+  struct counter    unfinished;   /* number of jobs that have not been finished */
+  int               shutdown;
+};
+
+
+static void
+counter_init(struct counter *c,
+             unsigned int   value);
+
+
+static void
+counter_destroy(struct counter *c);
+
+
+static void
+counter_increase(struct counter *c);
+
+
+static void
+counter_decrease(struct counter *c);
+
+
+static void
+counter_wait_nonzero(struct counter *c);
+
+
+static void
+counter_wait_zero(struct counter *c);
+
+
+static int
+queue_pop(struct job_queue  *q,
+          unsigned int      size,
+          struct job        *job);
+
+
+static void *
+worker_loop(void *arg);
+
+
+#endif
+
 
 int
 num_proc_cores(int  *num_cores,
@@ -134,3 +258,447 @@ max_user_threads(void)
 
   return threadm;
 }
+
+
+fc_pool
+fc_pool_init(unsigned int max_length)
+{
+  fc_pool pool;
+
+  pool              = (fc_pool)vrna_alloc(sizeof(struct fc_pool_s));
+  pool->fcs         = NULL;
+  pool->num         = 0;
+  pool->size        = 0;
+  pool->max_length  = max_length;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_init(&pool->mtx, NULL);
+#endif
+
+  return pool;
+}
+
+
+void
+fc_pool_free(fc_pool pool)
+{
+  unsigned int i;
+
+  if (pool) {
+    for (i = 0; i < pool->num; i++)
+      vrna_fold_compound_free(pool->fcs[i]);
+
+#if VRNA_WITH_PTHREADS
+    pthread_mutex_destroy(&pool->mtx);
+#endif
+
+    free(pool->fcs);
+    free(pool);
+  }
+}
+
+
+vrna_fold_compound_t *
+fc_pool_get(fc_pool       pool,
+            const char    *sequence,
+            vrna_md_t     *md,
+            unsigned int  options)
+{
+  vrna_fold_compound_t *fc;
+
+  fc = fc_pool_pop(pool, VRNA_FC_TYPE_SINGLE, strlen(sequence));
+
+  if ((fc) && (!vrna_fold_compound_reset_sequence(fc, sequence, md))) {
+    vrna_fold_compound_free(fc);
+    fc = NULL;
+  }
+
+  if (!fc)
+    fc = vrna_fold_compound(sequence, md, options);
+
+  return fc;
+}
+
+
+vrna_fold_compound_t *
+fc_pool_get_comparative(fc_pool       pool,
+                        const char    **alignment,
+                        vrna_md_t     *md,
+                        unsigned int  options)
+{
+  vrna_fold_compound_t *fc;
+
+  fc = fc_pool_pop(pool, VRNA_FC_TYPE_COMPARATIVE, strlen(alignment[0]));
+
+  if ((fc) && (!vrna_fold_compound_reset_alignment(fc, alignment, md))) {
+    vrna_fold_compound_free(fc);
+    fc = NULL;
+  }
+
+  if (!fc)
+    fc = vrna_fold_compound_comparative(alignment, md, options);
+
+  return fc;
+}
+
+
+void
+fc_pool_release(fc_pool               pool,
+                vrna_fold_compound_t  *fc)
+{
+  if (!fc)
+    return;
+
+  /* do not keep the (large) DP matrices of long sequences around */
+  if ((!pool) || (fc->length > pool->max_length)) {
+    vrna_fold_compound_free(fc);
+    return;
+  }
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&pool->mtx);
+#endif
+
+  if (pool->num == pool->size) {
+    pool->size  += 8;
+    pool->fcs   = (vrna_fold_compound_t **)vrna_realloc(pool->fcs,
+                                                        sizeof(vrna_fold_compound_t *) *
+                                                        pool->size);
+  }
+
+  pool->fcs[pool->num++] = fc;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&pool->mtx);
+#endif
+}
+
+
+static vrna_fold_compound_t *
+fc_pool_pop(fc_pool               pool,
+            vrna_fc_type_e        type,
+            unsigned int          length)
+{
+  unsigned int          i, c, best, best_capacity, fits;
+  vrna_fold_compound_t  *fc;
+
+  fc = NULL;
+
+  if ((!pool) || (length > pool->max_length))
+    return fc;
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_lock(&pool->mtx);
+#endif
+
+  /*
+   *  prefer the smallest DP matrices that fit the current length,
+   *  otherwise take the largest ones, they will grow on demand
+   */
+  best          = pool->num;
+  best_capacity = 0;
+  fits          = 0;
+
+  for (i = 0; i < pool->num; i++) {
+    if (pool->fcs[i]->type != type)
+      continue;
+
+    c = fc_capacity(pool->fcs[i]);
+
+    if (c >= length) {
+      if ((!fits) || (c < best_capacity)) {
+        best          = i;
+        best_capacity = c;
+        fits          = 1;
+      }
+    } else if ((!fits) && ((best == pool->num) || (c > best_capacity))) {
+      best          = i;
+      best_capacity = c;
+    }
+  }
+
+  if (best < pool->num) {
+    fc              = pool->fcs[best];
+    pool->fcs[best] = pool->fcs[--pool->num];
+  }
+
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_unlock(&pool->mtx);
+#endif
+
+  return fc;
+}
+
+
+static unsigned int
+fc_capacity(vrna_fold_compound_t *fc)
+{
+  unsigned int c = 0;
+
+  if ((fc->matrices) && (fc->matrices->length > c))
+    c = fc->matrices->length;
+
+  if ((fc->exp_matrices) && (fc->exp_matrices->length > c))
+    c = fc->exp_matrices->length;
+
+  return c;
+}
+
+
+#if VRNA_WITH_PTHREADS
+
+job_scheduler
+scheduler_init(unsigned int num_workers,
+               unsigned int queue_size)
+{
+  unsigned int  i;
+  job_scheduler scheduler;
+
+  if (num_workers < 1)
+    num_workers = 1;
+
+  if (queue_size < num_workers)
+    queue_size = num_workers;
+
+  scheduler               = (job_scheduler)vrna_alloc(sizeof(struct job_scheduler_s));
+  scheduler->num_workers  = num_workers;
+  scheduler->queue_size   = queue_size;
+  scheduler->next_queue   = 0;
+  scheduler->shutdown     = 0;
+  scheduler->queues       = (struct job_queue *)vrna_alloc(sizeof(struct job_queue) * num_workers);
+  scheduler->workers      = (struct worker *)vrna_alloc(sizeof(struct worker) * num_workers);
+
+  counter_init(&(scheduler->free_slots), queue_size);
+  counter_init(&(scheduler->pending), 0);
+  counter_init(&(scheduler->unfinished), 0);
+
+  for (i = 0; i < num_workers; i++) {
+    pthread_mutex_init(&(scheduler->queues[i].mtx), NULL);
+    scheduler->queues[i].jobs   = (struct job *)vrna_alloc(sizeof(struct job) * queue_size);
+    scheduler->queues[i].first  = 0;
+    scheduler->queues[i].num    = 0;
+  }
+
+  for (i = 0; i < num_workers; i++) {
+    scheduler->workers[i].scheduler = scheduler;
+    scheduler->workers[i].id        = i;
+    if (pthread_create(&(scheduler->workers[i].thread),
+                       NULL,
+                       &worker_loop,
+                       (void *)&(scheduler->workers[i])))
+      vrna_message_error("Failed to create worker thread %u", i);
+  }
+
+  return scheduler;
+}
+
+
+void
+scheduler_add_job(job_scheduler scheduler,
+                  void          (*fun)(void *),
+                  void          *data)
+{
+  unsigned int      i;
+  struct job_queue  *q;
+
+  /* back pressure: wait until the workers claimed enough of the pending jobs */
+  counter_decrease(&(scheduler->free_slots));
+  counter_increase(&(scheduler->unfinished));
+
+  /* only the input thread adds jobs, so no need to protect the round-robin index */
+  i                     = scheduler->next_queue;
+  scheduler->next_queue = (i + 1) % scheduler->num_workers;
+  q                     = &(scheduler->queues[i]);
+
+  pthread_mutex_lock(&(q->mtx));
+  q->jobs[(q->first + q->num) % scheduler->queue_size].fun  = fun;
+  q->jobs[(q->first + q->num) % scheduler->queue_size].data = data;
+  q->num++;
+  pthread_mutex_unlock(&(q->mtx));
+
+  counter_increase(&(scheduler->pending));
+}
+
+
+void
+scheduler_wait_free_slot(job_scheduler scheduler)
+{
+  counter_wait_nonzero(&(scheduler->free_slots));
+}
+
+
+void
+scheduler_wait(job_scheduler scheduler)
+{
+  counter_wait_zero(&(scheduler->unfinished));
+}
+
+
+void
+scheduler_destroy(job_scheduler scheduler)
+{
+  unsigned int i;
+
+  if (scheduler) {
+    scheduler_wait(scheduler);
+
+    /* wake up all workers, they will find no job and terminate */
+    scheduler->shutdown = 1;
+    for (i = 0; i < scheduler->num_workers; i++)
+      counter_increase(&(scheduler->pending));
+
+    for (i = 0; i < scheduler->num_workers; i++)
+      pthread_join(scheduler->workers[i].thread, NULL);
+
+    for (i = 0; i < scheduler->num_workers; i++) {
+      pthread_mutex_destroy(&(scheduler->queues[i].mtx));
+      free(scheduler->queues[i].jobs);
+    }
+
+    counter_destroy(&(scheduler->free_slots));
+    counter_destroy(&(scheduler->pending));
+    counter_destroy(&(scheduler->unfinished));
+
+    free(scheduler->queues);
+    free(scheduler->workers);
+    free(scheduler);
+  }
+}
+
+
+static void *
+worker_loop(void *arg)
+{
+  unsigned int  i, n;
+  struct worker *w;
+  job_scheduler scheduler;
+  struct job    job;
+
+  w         = (struct worker *)arg;
+  scheduler = w->scheduler;
+  n         = scheduler->num_workers;
+
+  while (1) {
+    /* claim one of the pending jobs */
+    counter_decrease(&(scheduler->pending));
+
+    /*
+     *  The claimed job must be in one of the queues. Try our own queue
+     *  first, then steal from the others. Jobs are always taken from the
+     *  front, such that records are processed in input order as far as
+     *  possible, which keeps the buffers of ordered output streams small.
+     */
+    for (i = 0; ; i = (i + 1) % n)
+      if (queue_pop(&(scheduler->queues[(w->id + i) % n]), scheduler->queue_size, &job))
+        break;
+      else if ((scheduler->shutdown) && (i == n - 1))
+        return NULL;
+
+    counter_increase(&(scheduler->free_slots));
+
+    job.fun(job.data);
+
+    counter_decrease(&(scheduler->unfinished));
+  }
+
+  return NULL;
+}
+
+
+static int
+queue_pop(struct job_queue  *q,
+          unsigned int      size,
+          struct job        *job)
+{
+  int ret = 0;
+
+  pthread_mutex_lock(&(q->mtx));
+
+  if (q->num > 0) {
+    *job      = q->jobs[q->first];
+    q->first  = (q->first + 1) % size;
+    q->num--;
+    ret       = 1;
+  }
+
+  pthread_mutex_unlock(&(q->mtx));
+
+  return ret;
+}
+
+
+static void
+counter_init(struct counter *c,
+             unsigned int   value)
+{
+  pthread_mutex_init(&(c->mtx), NULL);
+  pthread_cond_init(&(c->cond), NULL);
+  c->value = value;
+}
+
+
+static void
+counter_destroy(struct counter *c)
+{
+  pthread_mutex_destroy(&(c->mtx));
+  pthread_cond_destroy(&(c->cond));
+}
+
+
+static void
+counter_increase(struct counter *c)
+{
+  pthread_mutex_lock(&(c->mtx));
+  c->value++;
+  /*
+   *  a single waiting thread is sufficient here, since each counter is
+   *  either decreased by the workers, or waited for by the input thread
+   */
+  pthread_cond_signal(&(c->cond));
+  pthread_mutex_unlock(&(c->mtx));
+}
+
+
+static void
+counter_decrease(struct counter *c)
+{
+  pthread_mutex_lock(&(c->mtx));
+
+  while (c->value == 0)
+    pthread_cond_wait(&(c->cond), &(c->mtx));
+
+  c->value--;
+
+  /* wake up threads waiting for the counter to become zero */
+  if (c->value == 0)
+    pthread_cond_broadcast(&(c->cond));
+
+  pthread_mutex_unlock(&(c->mtx));
+}
+
+
+static void
+counter_wait_nonzero(struct counter *c)
+{
+  pthread_mutex_lock(&(c->mtx));
+
+  while (c->value == 0)
+    pthread_cond_wait(&(c->cond), &(c->mtx));
+
+  pthread_mutex_unlock(&(c->mtx));
+}
+
+
+static void
+counter_wait_zero(struct counter *c)
+{
+  pthread_mutex_lock(&(c->mtx));
+
+  while (c->value > 0)
+    pthread_cond_wait(&(c->cond), &(c->mtx));
+
+  pthread_mutex_unlock(&(c->mtx));
+}
+
+
+#endif
@@ -1,15 +1,52 @@
 #ifndef VRNA_PARALLELIZATION_HELPERS
 #define VRNA_PARALLELIZATION_HELPERS
 
+#include "ViennaRNA/fold_compound.h"
+
 #if VRNA_WITH_PTHREADS
 
 #include <pthread.h>
-#include "thpool.h"
+
+/*
+ *  A job scheduler with a bounded input queue. Each worker thread owns
+ *  a job queue, idle workers steal jobs from the queues of the other
+ *  workers, and adding a job blocks (without polling) while all queue
+ *  slots are occupied.
+ */
+typedef struct job_scheduler_s *job_scheduler;
+
+
+/* the number of pending jobs per worker thread before adding jobs blocks */
+#define JOBS_PER_WORKER 4
+
+
+job_scheduler
+scheduler_init(unsigned int num_workers,
+               unsigned int queue_size);
+
+
+void
+scheduler_add_job(job_scheduler scheduler,
+                  void          (*fun)(void *),
+                  void          *data);
+
+
+void
+scheduler_wait_free_slot(job_scheduler scheduler);
+
+
+void
+scheduler_wait(job_scheduler scheduler);
+
+
+void
+scheduler_destroy(job_scheduler scheduler);
+
 
 pthread_mutex_t output_mutex;
 pthread_mutex_t output_file_mutex;
 unsigned int    max_threads;
-threadpool      worker_pool;
+job_scheduler   worker_pool;
 
 #define ATOMIC_BLOCK(a) { \
     if (max_threads > 1) { \
@@ -47,29 +84,32 @@ threadpool      worker_pool;
     if (max_threads > 1) { \
       pthread_mutex_init(&output_mutex, NULL); \
       pthread_mutex_init(&output_file_mutex, NULL); \
-      worker_pool = thpool_init(max_threads); \
+      worker_pool = scheduler_init(max_threads, JOBS_PER_WORKER * max_threads); \
     } \
 }
 
 #define UNINIT_PARALLELIZATION  { \
     if (max_threads > 1) \
-      thpool_wait(worker_pool); \
+      scheduler_wait(worker_pool); \
     pthread_mutex_destroy(&output_mutex); \
     pthread_mutex_destroy(&output_file_mutex); \
     if (max_threads > 1) \
-      thpool_destroy(worker_pool); \
+      scheduler_destroy(worker_pool); \
 }
 
 #define RUN_IN_PARALLEL(fun, data)  { \
-    if (max_threads > 1) { thpool_add_work(worker_pool, (void *)&fun, (void *)data); } \
+    if (max_threads > 1) { scheduler_add_job(worker_pool, (void (*)(void *))&fun, (void *)data); } \
     else { fun(data); } \
 }
 
 #define WAIT_FOR_FREE_SLOT(a) { \
-    if (max_threads > 1) { \
-      while (thpool_num_threads_working(worker_pool) == (a)) \
-        sleep(1); \
-    } \
+    if (max_threads > 1) \
+      scheduler_wait_free_slot(worker_pool); \
+}
+
+#define WAIT_FOR_ALL_JOBS { \
+    if (max_threads > 1) \
+      scheduler_wait(worker_pool); \
 }
 
 #else
@@ -81,9 +121,51 @@ threadpool      worker_pool;
 #define UNINIT_PARALLELIZATION
 #define RUN_IN_PARALLEL(fun, data)  { fun(data); }
 #define WAIT_FOR_FREE_SLOT(a)
+#define WAIT_FOR_ALL_JOBS
 
 #endif
 
+/*
+ *  A pool of fold compounds that allows consecutive records to re-use
+ *  energy parameters and DP matrices of previously processed records.
+ *  Fold compounds are handed out according to the capacity of their
+ *  DP matrices, i.e. the smallest one that fits the current record is
+ *  preferred. All functions may be called concurrently by the workers.
+ */
+typedef struct fc_pool_s *fc_pool;
+
+
+/* fold compounds of longer sequences are not kept in the pool */
+#define FC_POOL_MAX_LENGTH  2000
+
+
+fc_pool
+fc_pool_init(unsigned int max_length);
+
+
+void
+fc_pool_free(fc_pool pool);
+
+
+vrna_fold_compound_t *
+fc_pool_get(fc_pool       pool,
+            const char    *sequence,
+            vrna_md_t     *md,
+            unsigned int  options);
+
+
+vrna_fold_compound_t *
+fc_pool_get_comparative(fc_pool       pool,
+                        const char    **alignment,
+                        vrna_md_t     *md,
+                        unsigned int  options);
+
+
+void
+fc_pool_release(fc_pool               pool,
+                vrna_fold_compound_t  *fc);
+
+
 int
 num_proc_cores(int  *num_cores,
                int  *num_cores_conf);
@@ -1,13 +1,299 @@
 #include <stdio.h>      /* printf, scanf, NULL */
 #include <stdlib.h>     /* malloc, free, rand */
+#include <string.h>
+#include <math.h>
 
 #include <ViennaRNA/fold_vars.h>
 #include <ViennaRNA/data_structures.h>
 #include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/utils/strings.h>
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/constraints/basic.h>
 #include <ViennaRNA/fold.h>
+#include <ViennaRNA/mfe.h>
+#include <ViennaRNA/fold_batch.h>
+#include <ViennaRNA/eval.h>
 #include <ViennaRNA/part_func.h>
+#include <ViennaRNA/equilibrium_probs.h>
+#include <ViennaRNA/centroid.h>
+#include <ViennaRNA/params/basic.h>
+#include <ViennaRNA/mutational_scan.h>
+#include <ViennaRNA/heat_capacity.h>
+#include <ViennaRNA/boltzmann_sampling.h>
+#include <ViennaRNA/subopt.h>
+#include <ViennaRNA/part_func_window.h>
+#include <ViennaRNA/mfe_window.h>
+#include <ViennaRNA/io/file_formats_accessibility.h>
+#include <ViennaRNA/duplex.h>
+#include <ViennaRNA/plex.h>
+#include <ViennaRNA/datastructures/char_stream.h>
+
+struct mutants {
+  unsigned int  num;
+  vrna_mutant_t *results;
+};
+
+
+static void
+store_mutant(const vrna_mutant_t  *mutant,
+             void                 *data)
+{
+  struct mutants *mutants = (struct mutants *)data;
+
+  mutants->results[mutants->num]            = *mutant;
+  mutants->results[mutants->num].structure  = NULL;
+  mutants->results[mutants->num].pairs      = NULL;
+  mutants->num++;
+}
+
+
+struct subopts {
+  unsigned int            num;
+  vrna_subopt_solution_t  *results;
+};
+
+
+static void
+store_subopt(const char *structure,
+             float      energy,
+             void       *data)
+{
+  struct subopts *subopts = (struct subopts *)data;
+
+  if (structure) {
+    subopts->results = (vrna_subopt_solution_t *)vrna_realloc(subopts->results,
+                                                              sizeof(vrna_subopt_solution_t) *
+                                                              (subopts->num + 1));
+    subopts->results[subopts->num].energy     = energy;
+    subopts->results[subopts->num].structure  = strdup(structure);
+    subopts->num++;
+  }
+}
+
+
+static void
+count_sample(const char *structure,
+             void       *data)
+{
+  (*((unsigned int *)data))++;
+}
+
+
+/* heat capacity for a single parabola over T - h, T, T + h from fresh fold compounds */
+static double
+heat_capacity_ref(const char  *seq,
+                  const char  *constraint,
+                  FLT_OR_DBL  *up,
+                  double      T,
+                  double      h)
+{
+  unsigned int          k;
+  double                mfe, G[3];
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  for (k = 0; k < 3; k++) {
+    vrna_md_set_default(&md);
+    md.temperature  = T + ((double)k - 1.) * h;
+    fc              = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+    if (constraint)
+      vrna_constraints_add(fc, constraint, VRNA_CONSTRAINT_DB_DEFAULT);
+
+    if (up)
+      vrna_sc_set_up(fc, (const FLT_OR_DBL *)up, VRNA_OPTION_DEFAULT);
+
+    mfe = (double)vrna_mfe(fc, NULL);
+    vrna_exp_params_rescale(fc, &mfe);
+    vrna_pf(fc, NULL);
+    G[k] = vrna_pf_ensemble_energy(fc);
+    vrna_fold_compound_free(fc);
+  }
+
+  return -(T + K0) * (G[0] - 2. * G[1] + G[2]) / (h * h);
+}
+
+
+struct window_sums {
+  double        bpp;
+  double        up;
+  unsigned int  num;
+  int           last_i;
+  int           ordered;
+};
+
+
+static void
+sum_window_probs(FLT_OR_DBL   *pr,
+                 int          pr_size,
+                 int          i,
+                 int          max,
+                 unsigned int type,
+                 void         *data)
+{
+  int                 k;
+  struct window_sums  *sums = (struct window_sums *)data;
+
+  if (type & VRNA_PROBS_WINDOW_BPP) {
+    if (i < sums->last_i)
+      sums->ordered = 0;
+
+    sums->last_i = i;
+    for (k = i + 1; k <= pr_size; k++)
+      sums->bpp += pr[k] * (double)(i + 2 * k);
+  } else if ((type & VRNA_PROBS_WINDOW_UP) && (type & VRNA_ANY_LOOP) == VRNA_ANY_LOOP) {
+    for (k = 1; k <= pr_size; k++)
+      sums->up += pr[k] * (double)(i + 2 * k);
+  }
+
+  sums->num++;
+}
+
+
+struct window_up {
+  unsigned int  ulength;
+  double        *up;
+};
+
+
+static void
+store_window_up(FLT_OR_DBL    *pr,
+                int           pr_size,
+                int           i,
+                int           max,
+                unsigned int  type,
+                void          *data)
+{
+  int               u;
+  struct window_up  *up = (struct window_up *)data;
+
+  if ((type & VRNA_PROBS_WINDOW_UP) && (type & VRNA_ANY_LOOP) == VRNA_ANY_LOOP)
+    for (u = 1; u <= pr_size; u++)
+      up->up[(i - 1) * up->ulength + u - 1] = pr[u];
+}
+
+
+struct sequence_blocks {
+  const char    *sequence;
+  unsigned int  length;
+  unsigned int  pos;
+  unsigned int  block_size;
+};
+
+
+static unsigned int
+read_sequence_block(char          *buffer,
+                    unsigned int  size,
+                    void          *data)
+{
+  unsigned int            r;
+  struct sequence_blocks  *blocks = (struct sequence_blocks *)data;
+
+  r = blocks->length - blocks->pos;
+  r = (r > size) ? size : r;
+  r = (r > blocks->block_size) ? blocks->block_size : r;
+
+  memcpy(buffer, blocks->sequence + blocks->pos, sizeof(char) * r);
+  blocks->pos += r;
+
+  return r;
+}
+
+
+struct window_hits {
+  unsigned int  num;
+  char          **hits;
+};
+
+
+static void
+store_window_hit(int        start,
+                 int        end,
+                 const char *structure,
+                 float      en,
+                 void       *data)
+{
+  struct window_hits *hits = (struct window_hits *)data;
+
+  hits->hits = (char **)vrna_realloc(hits->hits, sizeof(char *) * (hits->num + 1));
+  hits->hits[hits->num++] = vrna_strdup_printf("%d %d %s %6.2f", start, end, structure, en);
+}
+
+
+/* a generic hard constraint that allows every decomposition */
+static unsigned char
+allow_all(int           i,
+          int           j,
+          int           k,
+          int           l,
+          unsigned char d,
+          void          *data)
+{
+  return (unsigned char)1;
+}
+
+
+/*
+ *  Predict MFE, ensemble free energy, and base pair probabilities with
+ *  two fold compounds and return the number of deviating results. Fold
+ *  compounds with two strands are treated as dimers
+ */
+static unsigned int
+compare_predictions(vrna_fold_compound_t  *fc1,
+                    vrna_fold_compound_t  *fc2)
+{
+  char          *s1, *s2;
+  double        mfe1, mfe2, g1, g2;
+  unsigned int  differences;
+  int           i, j, n;
+  FLT_OR_DBL    *p1, *p2;
+
+  if (fc1->length != fc2->length)
+    return 1;
+
+  n           = (int)fc1->length;
+  differences = 0;
+  s1          = (char *)vrna_alloc(sizeof(char) * (n + 2));
+  s2          = (char *)vrna_alloc(sizeof(char) * (n + 2));
+
+  if (fc1->strands > 1) {
+    mfe1  = (double)vrna_mfe_dimer(fc1, s1);
+    mfe2  = (double)vrna_mfe_dimer(fc2, s2);
+  } else {
+    mfe1  = (double)vrna_mfe(fc1, s1);
+    mfe2  = (double)vrna_mfe(fc2, s2);
+  }
+
+  if ((mfe1 != mfe2) || (strcmp(s1, s2)))
+    differences++;
+
+  vrna_exp_params_rescale(fc1, &mfe1);
+  vrna_exp_params_rescale(fc2, &mfe2);
+  if (fc1->strands > 1) {
+    g1  = vrna_pf_dimer(fc1, NULL).FAB;
+    g2  = vrna_pf_dimer(fc2, NULL).FAB;
+  } else {
+    g1  = (double)vrna_pf(fc1, NULL);
+    g2  = (double)vrna_pf(fc2, NULL);
+  }
+
+  if (fabs(g1 - g2) > 1e-6)
+    differences++;
+
+  p1  = fc1->exp_matrices->probs;
+  p2  = fc2->exp_matrices->probs;
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++)
+      if (fabs(p1[fc1->iindx[i] - j] - p2[fc2->iindx[i] - j]) > 1e-8)
+        differences++;
+
+  free(s1);
+  free(s2);
+
+  return differences;
+}
+
 
 #suite  MFE_Prediction
 
@@ -24,8 +310,750 @@
   free(structure);
 }
 
+#tcase  Banded_Matrices
+
+#test test_banded_matrices
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc_band, *fc_full;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC"
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  *s_band, *s_full;
+  float                 e_band, e_full, g_band, g_full;
+
+  vrna_md_set_default(&md);
+  md.max_bp_span  = 40;
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  fc_band = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  fc_full = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+  /* soft constraints enforce the full triangular matrices */
+  vrna_sc_init(fc_full);
+
+  s_band  = (char *)vrna_alloc(sizeof(char) * (strlen(seq) + 1));
+  s_full  = (char *)vrna_alloc(sizeof(char) * (strlen(seq) + 1));
+  e_band  = vrna_mfe(fc_band, s_band);
+  e_full  = vrna_mfe(fc_full, s_full);
+
+  ck_assert_int_eq(fc_band->band, 40);
+  ck_assert_int_eq(fc_full->band, 0);
+  ck_assert(e_band == e_full);
+  ck_assert_str_eq(s_band, s_full);
+
+  g_band  = vrna_pf(fc_band, NULL);
+  g_full  = vrna_pf(fc_full, NULL);
+
+  ck_assert_int_eq(fc_band->band, 40);
+  ck_assert(fabs(g_band - g_full) < 1e-3);
+
+  free(s_band);
+  free(s_full);
+  vrna_fold_compound_free(fc_band);
+  vrna_fold_compound_free(fc_full);
+}
+
+#tcase  Parallel_Fill
+
+#test test_parallel_fill
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc_serial, *fc_parallel;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC"
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  int                   d;
+
+  /* MFE, ensemble free energy, and base pair probabilities must not depend on the number of threads */
+  for (d = 0; d <= 2; d++) {
+    vrna_md_set_default(&md);
+    md.dangles      = d;
+    md.num_threads  = 1;
+    fc_serial       = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+    md.num_threads  = 4;
+    fc_parallel     = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+    ck_assert_int_eq(compare_predictions(fc_parallel, fc_serial), 0);
+
+    vrna_fold_compound_free(fc_serial);
+    vrna_fold_compound_free(fc_parallel);
+  }
+}
+
+#tcase  Specialized_Kernels
+
+#test test_mfe_kernels
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_generic;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC";
+  char                  *s, *s_generic;
+  float                 e, e_generic;
+  int                   i, j, n, ij, d, noLP, circ, *c1, *c2, *fm1, *fm2;
+  unsigned int          differences;
+
+  n         = (int)strlen(seq);
+  s         = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s_generic = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  /* the specialized kernels must fill the same matrices as the generic recursions */
+  for (d = 0; d <= 2; d += 2)
+    for (noLP = 0; noLP <= 1; noLP++)
+      for (circ = 0; circ <= 1; circ++) {
+        vrna_md_set_default(&md);
+        md.dangles  = d;
+        md.noLP     = noLP;
+        md.circ     = circ;
+
+        fc          = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+        fc_generic  = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+        /* empty soft constraints enforce the generic recursions */
+        vrna_sc_init(fc_generic);
+
+        e         = vrna_mfe(fc, s);
+        e_generic = vrna_mfe(fc_generic, s_generic);
+
+        ck_assert_int_eq(fc->kernel, (d == 0) ? VRNA_KERNEL_DEFAULT_D0 : VRNA_KERNEL_DEFAULT_D2);
+        ck_assert_int_eq(fc_generic->kernel, VRNA_KERNEL_GENERIC);
+        ck_assert(e == e_generic);
+        ck_assert_str_eq(s, s_generic);
+
+        c1          = fc->matrices->c;
+        c2          = fc_generic->matrices->c;
+        fm1         = fc->matrices->fML;
+        fm2         = fc_generic->matrices->fML;
+        differences = 0;
+
+        for (j = 1; j <= n; j++)
+          for (i = 1; i < j; i++) {
+            ij = fc->jindx[j] + i;
+            if ((c1[ij] != c2[ij]) || (fm1[ij] != fm2[ij]))
+              differences++;
+          }
+
+        ck_assert_int_eq(differences, 0);
+
+        vrna_fold_compound_free(fc);
+        vrna_fold_compound_free(fc_generic);
+      }
+
+  free(s);
+  free(s_generic);
+}
+
+#tcase  Interior_Loops
+
+#test test_interior_loop_rows
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc_row, *fc_cell;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC";
+  char                  *s_row, *s_cell;
+  double                mfe, e_row, e_cell, g_row, g_cell;
+  int                   i, j, n, ij, d, noLP, soft, *c_row, *c_cell;
+  unsigned int          differences;
+  FLT_OR_DBL            *up, *qb_row, *qb_cell, *p_row, *p_cell;
+
+  n       = (int)strlen(seq);
+  s_row   = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s_cell  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  up      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+
+  for (i = 1; i <= n; i++)
+    up[i] = (i % 5) ? 0. : -0.3;
+
+  /*
+   *  a generic hard constraint callback disables the row-wise interior loop
+   *  kernels, so that every (k,l) is evaluated separately
+   */
+  for (d = 0; d <= 2; d += 2)
+    for (noLP = 0; noLP <= 1; noLP++)
+      for (soft = 0; soft <= 2; soft++) {
+        vrna_md_set_default(&md);
+        md.dangles  = d;
+        md.noLP     = noLP;
+
+        fc_row  = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+        fc_cell = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+        vrna_hc_add_f(fc_cell, &allow_all);
+
+        switch (soft) {
+          case 1:
+            /* pseudo energies for base pairs */
+            for (i = 1; i < n; i += 3)
+              for (j = i + 4; j <= n; j += 7) {
+                vrna_sc_add_bp(fc_row, i, j, -0.4, VRNA_OPTION_DEFAULT);
+                vrna_sc_add_bp(fc_cell, i, j, -0.4, VRNA_OPTION_DEFAULT);
+              }
+            break;
+
+          case 2:
+            /* pseudo energies for unpaired nucleotides */
+            vrna_sc_set_up(fc_row, (const FLT_OR_DBL *)up, VRNA_OPTION_DEFAULT);
+            vrna_sc_set_up(fc_cell, (const FLT_OR_DBL *)up, VRNA_OPTION_DEFAULT);
+            break;
+
+          default:
+            break;
+        }
+
+        e_row   = (double)vrna_mfe(fc_row, s_row);
+        e_cell  = (double)vrna_mfe(fc_cell, s_cell);
+
+        ck_assert(e_row == e_cell);
+        ck_assert_str_eq(s_row, s_cell);
+
+        c_row       = fc_row->matrices->c;
+        c_cell      = fc_cell->matrices->c;
+        differences = 0;
+
+        for (j = 1; j <= n; j++)
+          for (i = 1; i < j; i++) {
+            ij = fc_row->jindx[j] + i;
+            if (c_row[ij] != c_cell[ij])
+              differences++;
+          }
+
+        ck_assert_int_eq(differences, 0);
+
+        mfe = e_row;
+        vrna_exp_params_rescale(fc_row, &mfe);
+        vrna_exp_params_rescale(fc_cell, &mfe);
+
+        g_row   = (double)vrna_pf(fc_row, NULL);
+        g_cell  = (double)vrna_pf(fc_cell, NULL);
+
+        ck_assert(fabs(g_row - g_cell) < 1e-8);
+
+        qb_row      = fc_row->exp_matrices->qb;
+        qb_cell     = fc_cell->exp_matrices->qb;
+        p_row       = fc_row->exp_matrices->probs;
+        p_cell      = fc_cell->exp_matrices->probs;
+        differences = 0;
+
+        for (i = 1; i < n; i++)
+          for (j = i + 1; j <= n; j++) {
+            ij = fc_row->iindx[i] - j;
+            if ((fabs(qb_row[ij] - qb_cell[ij]) > 1e-10 * qb_cell[ij]) ||
+                (fabs(p_row[ij] - p_cell[ij]) > 1e-10))
+              differences++;
+          }
+
+        ck_assert_int_eq(differences, 0);
+
+        vrna_fold_compound_free(fc_row);
+        vrna_fold_compound_free(fc_cell);
+      }
+
+  free(s_row);
+  free(s_cell);
+  free(up);
+}
+
+#tcase  Checkpointed_MFE
+
+#test test_mfe_checkpoint
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_win;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC";
+  char                  *s_mfe, *s_cp;
+  float                 e_mfe, e_cp;
+  unsigned int          interval[] = {
+    0, 16, 1000
+  };
+  int                   d, k;
+
+  s_mfe = (char *)vrna_alloc(sizeof(char) * (strlen(seq) + 1));
+  s_cp  = (char *)vrna_alloc(sizeof(char) * (strlen(seq) + 1));
+
+  for (d = 0; d <= 2; d += 2) {
+    vrna_md_set_default(&md);
+    md.dangles = d;
+
+    fc    = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+    e_mfe = vrna_mfe(fc, s_mfe);
+
+    for (k = 0; k < 3; k++) {
+      e_cp = vrna_mfe_checkpoint(fc, s_cp, interval[k]);
+      ck_assert(e_cp == e_mfe);
+      ck_assert_int_eq(strlen(s_cp), strlen(seq));
+      ck_assert(vrna_eval_structure(fc, s_cp) == e_mfe);
+    }
+
+    /* a fold compound without quadratic hard constraints and pair types */
+    md.window_size  = 0;
+    fc_win          = vrna_fold_compound(seq, &md, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+    ck_assert(fc_win->hc->type == VRNA_HC_WINDOW);
+
+    e_cp = vrna_mfe_checkpoint(fc_win, s_cp, 0);
+    ck_assert(e_cp == e_mfe);
+    ck_assert(vrna_eval_structure(fc, s_cp) == e_mfe);
+
+    vrna_fold_compound_free(fc_win);
+    vrna_fold_compound_free(fc);
+  }
+
+  free(s_mfe);
+  free(s_cp);
+}
+
+#tcase  Recycling
+
+#test test_reset_sequence
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_fresh;
+  vrna_mx_mfe_t         *mx;
+  const char            *seqs[] = {
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU",
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAG",
+    "GGGAGGGAGGGAGGGAAAAAGGCUAGCGAUCGGGUUGGGUUGGGUUGGGCUAGC",
+    "CGCAGGGAUACCCGCG&GCGCUUCGCCGCGCGCAAAGCGCG",
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC",
+    "AAAAAAAAAA"
+  };
+  unsigned int          i, g, n, mx_length;
+
+  n = sizeof(seqs) / sizeof(seqs[0]);
+
+  /* without and with G-Quadruplexes, whose contributions must be re-computed for each sequence */
+  for (g = 0; g < 2; g++) {
+    vrna_md_set_default(&md);
+    md.gquad  = (int)g;
+    fc        = vrna_fold_compound(seqs[0], &md, VRNA_OPTION_DEFAULT);
+
+    for (i = 0; i < n; i++) {
+      /* G-Quadruplexes are not supported for multiple strands */
+      if ((g) && (strchr(seqs[i], '&')))
+        continue;
+
+      mx        = fc->matrices;
+      mx_length = (mx) ? mx->length : 0;
+      ck_assert_int_eq(vrna_fold_compound_reset_sequence(fc, seqs[i], &md), 1);
+
+      /* matrices that are large enough must be kept */
+      if (mx_length >= fc->length)
+        ck_assert(fc->matrices == mx);
+
+      fc_fresh = vrna_fold_compound(seqs[i], &md, VRNA_OPTION_DEFAULT);
+      ck_assert_int_eq(compare_predictions(fc, fc_fresh), 0);
+      vrna_fold_compound_free(fc_fresh);
+    }
+
+    vrna_fold_compound_free(fc);
+  }
+}
+
+#test test_reset_alignment
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_fresh;
+  const char            *aln1[] = {
+    "GGGAAAUCCCAGCUAGCUAGG-CUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGC",
+    "GGGAAAUCCCAGCU-GCUAGGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGC",
+    "GGGAAAUCCCAGCUAGCUAGGGCUAGCGAUCGAUCGGA-CCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGC",
+    NULL
+  };
+  const char            *aln2[] = {
+    "CGCAGGGAUACCCGCG-UUCG",
+    "CGCAGGGA-ACCCGCGCUUCG",
+    NULL
+  };
+  const char            *aln3[] = {
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGG",
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGA-CCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGG",
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACC-GACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGG",
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAG-AGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGG",
+    NULL
+  };
+  const char            **alns[] = {
+    aln1, aln2, aln3, aln1
+  };
+  unsigned int          i;
+
+  /* alignments of different lengths and with different numbers of sequences */
+  vrna_md_set_default(&md);
+  fc = vrna_fold_compound_comparative(alns[0], &md, VRNA_OPTION_DEFAULT);
+
+  for (i = 0; i < sizeof(alns) / sizeof(alns[0]); i++) {
+    ck_assert_int_eq(vrna_fold_compound_reset_alignment(fc, alns[i], &md), 1);
+    ck_assert_int_eq(fc->length, strlen(alns[i][0]));
+
+    fc_fresh = vrna_fold_compound_comparative(alns[i], &md, VRNA_OPTION_DEFAULT);
+    ck_assert_int_eq(fc->n_seq, fc_fresh->n_seq);
+    ck_assert_int_eq(compare_predictions(fc, fc_fresh), 0);
+    vrna_fold_compound_free(fc_fresh);
+  }
+
+  vrna_fold_compound_free(fc);
+}
+
+#tcase  Batch_Processing
+
+#test test_fold_batch
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  vrna_batch_result_t   *results;
+  const char            *seqs[] = {
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACG",
+    "GGGAAAUCCCAGCUAGCUAGG",
+    NULL,
+    "CGCAGGGAUACCCGCGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCG",
+    "AAAAAA",
+    "GCGCUUCGCCGCGCGCAAAGCGCGGCAGGGAUACCCGCGUGCA",
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACC"
+  };
+  char                  *structure;
+  double                mfe;
+  float                 en;
+  unsigned int          i, k, n, options[] = {
+    VRNA_OPTION_MFE, VRNA_OPTION_PF
+  };
+
+  n = sizeof(seqs) / sizeof(seqs[0]);
+
+  for (k = 0; k < 4; k++) {
+    vrna_md_set_default(&md);
+    md.num_threads  = 3;
+    md.dangles      = (k < 2) ? 2 : 0;
+    md.temperature  = (k < 2) ? 37. : 30.;
+
+    results = vrna_fold_batch(seqs, n, &md, options[k % 2]);
+    ck_assert(results != NULL);
+
+    /* every result must match an independent computation with a fresh fold compound */
+    for (i = 0; i < n; i++) {
+      if (!seqs[i]) {
+        ck_assert(results[i].structure == NULL);
+        continue;
+      }
+
+      md.num_threads  = 1;
+      fc              = vrna_fold_compound(seqs[i], &md, VRNA_OPTION_DEFAULT);
+      structure       = (char *)vrna_alloc(sizeof(char) * (strlen(seqs[i]) + 1));
+      mfe             = (double)vrna_mfe(fc, structure);
+
+      ck_assert(results[i].mfe == (float)mfe);
+      ck_assert_str_eq(results[i].structure, structure);
+
+      if (options[k % 2] & VRNA_OPTION_PF) {
+        vrna_exp_params_rescale(fc, &mfe);
+        en = vrna_pf(fc, NULL);
+        ck_assert(fabs(results[i].ens_en - en) < 1e-4);
+      }
+
+      free(structure);
+      vrna_fold_compound_free(fc);
+    }
+
+    vrna_fold_batch_results_free(results, n);
+  }
+}
+
+#tcase  Mutational_Scan
+
+#test test_mutational_scan
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_mut;
+  const char            *seq = "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACG";
+  char                  *mut;
+  double                mfe;
+  unsigned int          k, n;
+  struct mutants        mutants;
+
+  n = strlen(seq);
+  vrna_md_set_default(&md);
+  md.num_threads = 2;
+
+  mutants.num     = 0;
+  mutants.results = (vrna_mutant_t *)vrna_alloc(sizeof(vrna_mutant_t) * 3 * n);
+
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  ck_assert_int_eq(vrna_mutational_scan(fc, VRNA_MUTSCAN_PF, 0.01, &store_mutant, &mutants), 3 * n);
+  ck_assert_int_eq(mutants.num, 3 * n);
+
+  md.num_threads = 1;
+  mut = strdup(seq);
+
+  for (k = 0; k < mutants.num; k++) {
+    /* results are reported in order of their positions */
+    ck_assert_int_eq(mutants.results[k].position, k / 3 + 1);
+    ck_assert(mutants.results[k].nucleotide != seq[k / 3]);
+
+    mut[k / 3]  = mutants.results[k].nucleotide;
+    fc_mut      = vrna_fold_compound(mut, &md, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+    mfe         = (double)vrna_mfe(fc_mut, NULL);
+    ck_assert(mfe == mutants.results[k].mfe);
+
+    fc_mut->exp_params->pf_scale = fc->exp_params->pf_scale;
+    vrna_exp_params_rescale(fc_mut, NULL);
+    ck_assert(fabs(vrna_pf(fc_mut, NULL) - mutants.results[k].ens_en) < 1e-4);
+
+    vrna_fold_compound_free(fc_mut);
+    mut[k / 3] = seq[k / 3];
+  }
+
+  /* hard constraints of the variant are not implied by the reference matrices */
+  mut[12] = 'A';
+  for (k = 0; k < 2; k++) {
+    fc_mut = vrna_fold_compound(mut, &md, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+    vrna_hc_add_up(fc_mut, 3, VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS);
+
+    if (k == 0) {
+      mfe = (double)vrna_mfe(fc_mut, NULL);
+    } else {
+      ck_assert((double)vrna_mfe_reuse(fc_mut, fc, 13, 13, NULL) == mfe);
+
+      fc_mut->exp_params->pf_scale = fc->exp_params->pf_scale;
+      vrna_exp_params_rescale(fc_mut, NULL);
+      ck_assert(fabs(vrna_pf_reuse(fc_mut, fc, 13, 13, NULL) - vrna_pf(fc_mut, NULL)) < 1e-4);
+    }
+
+    vrna_fold_compound_free(fc_mut);
+  }
+
+  free(mut);
+  free(mutants.results);
+  vrna_fold_compound_free(fc);
+}
+
+#tcase  Suboptimal_Structures
+
+#test test_subopt_sorted
+{
+  vrna_md_t               md;
+  vrna_fold_compound_t    *fc;
+  const char              *seq = "GGGCUAUUAGCUCAGUUGGUUAGAGCGCACCCCUGAUAAGGGUGAGGUCGCUGAUUCGAAUUCAGCAUAGCCCA";
+  unsigned int            k, num;
+  vrna_subopt_solution_t  *sol;
+  struct subopts          sorted, limited;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML = 1;
+
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+  sol = vrna_subopt(fc, 300, VRNA_UNSORTED, NULL);
+  for (num = 0; sol[num].structure; num++)
+    free(sol[num].structure);
+  free(sol);
+
+  sorted.num      = 0;
+  sorted.results  = NULL;
+  ck_assert_int_eq(vrna_subopt_sorted_cb(fc, 300, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, 0, &store_subopt, &sorted), num);
+  ck_assert_int_eq(sorted.num, num);
+
+  for (k = 1; k < num; k++) {
+    ck_assert(sorted.results[k - 1].energy <= sorted.results[k].energy);
+    if (sorted.results[k - 1].energy == sorted.results[k].energy)
+      ck_assert(strcmp(sorted.results[k - 1].structure, sorted.results[k].structure) < 0);
+  }
+
+  /* a limited enumeration yields the head of the sorted list */
+  limited.num     = 0;
+  limited.results = NULL;
+  ck_assert_int_eq(vrna_subopt_sorted_cb(fc, 300, VRNA_SORT_BY_ENERGY_LEXICOGRAPHIC_ASC, 25, &store_subopt, &limited), 25);
+  ck_assert_int_eq(limited.num, 25);
+
+  for (k = 0; k < limited.num; k++) {
+    ck_assert(limited.results[k].energy == sorted.results[k].energy);
+    ck_assert_str_eq(limited.results[k].structure, sorted.results[k].structure);
+    free(limited.results[k].structure);
+  }
+
+  for (k = 0; k < sorted.num; k++)
+    free(sorted.results[k].structure);
+
+  free(sorted.results);
+  free(limited.results);
+  vrna_fold_compound_free(fc);
+
+  /* without lonely pairs, the MFE matrices do not bound the remaining intervals */
+  md.noLP = 1;
+  fc      = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+  sol = vrna_subopt(fc, 300, VRNA_SORT_BY_ENERGY_ASC, NULL);
+  for (num = 0; sol[num].structure; num++) {
+    if (num > 0)
+      ck_assert(sol[num - 1].energy <= sol[num].energy);
+  }
+
+  ck_assert(num > 25);
+
+  limited.num     = 0;
+  limited.results = NULL;
+  ck_assert_int_eq(vrna_subopt_sorted_cb(fc, 300, VRNA_SORT_BY_ENERGY_ASC, 25, &store_subopt, &limited), 25);
+
+  for (k = 0; k < limited.num; k++) {
+    ck_assert(limited.results[k].energy == sol[k].energy);
+    free(limited.results[k].structure);
+  }
+
+  for (k = 0; k < num; k++)
+    free(sol[k].structure);
+
+  free(sol);
+  free(limited.results);
+  vrna_fold_compound_free(fc);
+}
+
+#tcase  Sliding_Window
+
+#test test_mfe_window_stream
+{
+  vrna_md_t               md;
+  vrna_fold_compound_t    *fc;
+  char                    *seq;
+  unsigned int            i;
+  float                   mfe, mfe_stream;
+  struct window_hits      full, streamed;
+  struct sequence_blocks  blocks;
+  const char              *nt = "ACGU";
+
+  /* long enough to be processed in several segments of 16 windows */
+  seq = (char *)vrna_alloc(sizeof(char) * 5001);
+  srand(2);
+  for (i = 0; i < 5000; i++)
+    seq[i] = nt[rand() % 4];
+
+  vrna_md_set_default(&md);
+  md.window_size  = 60;
+  md.max_bp_span  = 60;
+
+  memset(&full, 0, sizeof(struct window_hits));
+  memset(&streamed, 0, sizeof(struct window_hits));
+
+  fc  = vrna_fold_compound(seq, &md, VRNA_OPTION_MFE | VRNA_OPTION_WINDOW);
+  mfe = vrna_mfe_window_cb(fc, &store_window_hit, (void *)&full);
+  vrna_fold_compound_free(fc);
+
+  blocks.sequence   = seq;
+  blocks.length     = 5000;
+  blocks.pos        = 0;
+  blocks.block_size = 777;
+
+  mfe_stream = vrna_mfe_window_source_cb(&md,
+                                         &read_sequence_block,
+                                         (void *)&blocks,
+                                         &store_window_hit,
+                                         (void *)&streamed);
+
+  /* the segmented scan must report the same hits in the same order */
+  ck_assert(mfe_stream == mfe);
+  ck_assert(full.num > 0);
+  ck_assert_int_eq(streamed.num, full.num);
+
+  for (i = 0; i < full.num; i++) {
+    ck_assert_str_eq(streamed.hits[i], full.hits[i]);
+    free(streamed.hits[i]);
+    free(full.hits[i]);
+  }
+
+  free(streamed.hits);
+  free(full.hits);
+  free(seq);
+}
+
 #suite  Partition_Function
 
+#tcase Parallel_Fill
+
+#test test_pf_parallel
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc_serial, *fc_parallel;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC";
+  char                  *constraint;
+  double                mfe, g_serial, g_parallel;
+  int                   i, ij, n, d, circ, constrained, size;
+  unsigned int          differences;
+  FLT_OR_DBL            *up;
+  vrna_mx_pf_t          *mx_s, *mx_p;
+
+  n           = (int)strlen(seq);
+  size        = ((n + 1) * (n + 2)) / 2;
+  constraint  = vrna_alloc(sizeof(char) * (n + 1));
+  up          = vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+
+  memset(constraint, '.', n);
+  for (i = 20; i < 30; i++)
+    constraint[i] = 'x';
+
+  for (i = 1; i <= n; i++)
+    up[i] = (i % 7) ? 0. : -0.5;
+
+  /*
+   *  the column-wise parallel fill and the parallel outside recursion must
+   *  reproduce all matrices and probabilities of the serial implementation
+   */
+  for (d = 0; d <= 2; d++)
+    for (circ = 0; circ <= 1; circ++)
+      for (constrained = 0; constrained <= 1; constrained++) {
+        vrna_md_set_default(&md);
+        md.dangles      = d;
+        md.circ         = circ;
+        md.num_threads  = 1;
+        fc_serial       = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+        md.num_threads  = 4;
+        fc_parallel     = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+
+        if (constrained) {
+          vrna_constraints_add(fc_serial, constraint, VRNA_CONSTRAINT_DB_DEFAULT);
+          vrna_constraints_add(fc_parallel, constraint, VRNA_CONSTRAINT_DB_DEFAULT);
+          vrna_sc_set_up(fc_serial, (const FLT_OR_DBL *)up, VRNA_OPTION_DEFAULT);
+          vrna_sc_set_up(fc_parallel, (const FLT_OR_DBL *)up, VRNA_OPTION_DEFAULT);
+        }
+
+        mfe = (double)vrna_mfe(fc_serial, NULL);
+        vrna_exp_params_rescale(fc_serial, &mfe);
+        vrna_exp_params_rescale(fc_parallel, &mfe);
+
+        g_serial    = (double)vrna_pf(fc_serial, NULL);
+        g_parallel  = (double)vrna_pf(fc_parallel, NULL);
+
+        ck_assert(g_serial == g_parallel);
+
+        mx_s        = fc_serial->exp_matrices;
+        mx_p        = fc_parallel->exp_matrices;
+        differences = 0;
+
+        for (ij = 1; ij < size; ij++)
+          if ((mx_s->q[ij] != mx_p->q[ij]) ||
+              (mx_s->qb[ij] != mx_p->qb[ij]) ||
+              (mx_s->qm[ij] != mx_p->qm[ij]) ||
+              (mx_s->probs[ij] != mx_p->probs[ij]))
+            differences++;
+
+        ck_assert_int_eq(differences, 0);
+
+        vrna_fold_compound_free(fc_serial);
+        vrna_fold_compound_free(fc_parallel);
+      }
+
+  free(constraint);
+  free(up);
+}
+
 #tcase Stochastic_Backtracking
 
 #test test_sample_structure
@@ -55,6 +1083,787 @@
   vrna_fold_compound_free(vc);
 }
 
+#test test_sample_parallel
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **serial, **parallel, **unordered;
+  unsigned int          i, j, num = 500;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  vrna_pf(vc, NULL);
+
+  /* the samples must not depend on the number of threads */
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  serial    = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_PARALLEL);
+
+  vc->exp_params->model_details.num_threads = 3;
+
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  parallel  = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_PARALLEL);
+
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  unordered = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_PARALLEL | VRNA_PBACKTRACK_UNORDERED);
+
+  ck_assert(serial != NULL);
+  ck_assert(parallel != NULL);
+  ck_assert(unordered != NULL);
+
+  for (i = 0; i < num; i++) {
+    ck_assert(serial[i] != NULL);
+    ck_assert(strcmp(serial[i], parallel[i]) == 0);
+
+    /* unordered delivery yields the same samples in any order */
+    for (j = 0; j < num; j++)
+      if ((unordered[j]) && (strcmp(serial[i], unordered[j]) == 0))
+        break;
+
+    ck_assert(j < num);
+    free(unordered[j]);
+    unordered[j] = NULL;
+  }
+
+  ck_assert(serial[num] == NULL);
+  ck_assert(parallel[num] == NULL);
+
+  for (i = 0; i < num; i++) {
+    free(serial[i]);
+    free(parallel[i]);
+  }
+
+  free(serial);
+  free(parallel);
+  free(unordered);
+  vrna_fold_compound_free(vc);
+}
+
+#test test_sample_parallel_failure
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **serial, **parallel, **unordered;
+  unsigned int          i, j, num_serial, num_parallel, num_unordered, num_cb, num = 200;
+  int                   n;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  vrna_pf(vc, NULL);
+
+  /*
+   *  an inflated partition function lets backtracing fail for about half of
+   *  the samples. As in serial mode, these samples are skipped but counted
+   */
+  n                                     = (int)vc->length;
+  vc->exp_matrices->q[vc->iindx[1] - n] *= 2.;
+
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  serial    = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_PARALLEL);
+
+  vc->exp_params->model_details.num_threads = 3;
+
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  parallel  = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_PARALLEL);
+
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  unordered = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_PARALLEL | VRNA_PBACKTRACK_UNORDERED);
+
+  /* the number of drawn samples includes the skipped ones */
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  num_cb    = 0;
+  ck_assert_int_eq(vrna_pbacktrack_cb(vc, num, &count_sample, (void *)&num_cb, VRNA_PBACKTRACK_PARALLEL), num);
+
+  ck_assert(serial != NULL);
+  ck_assert(parallel != NULL);
+  ck_assert(unordered != NULL);
+
+  for (num_serial = 0; serial[num_serial]; num_serial++);
+  for (num_parallel = 0; parallel[num_parallel]; num_parallel++);
+  for (num_unordered = 0; unordered[num_unordered]; num_unordered++);
+
+  ck_assert(num_serial > 0);
+  ck_assert(num_serial < num);
+  ck_assert_int_eq(num_parallel, num_serial);
+  ck_assert_int_eq(num_unordered, num_serial);
+  ck_assert_int_eq(num_cb, num_serial);
+
+  for (i = 0; i < num_serial; i++) {
+    ck_assert(strcmp(serial[i], parallel[i]) == 0);
+
+    for (j = 0; j < num_unordered; j++)
+      if ((unordered[j]) && (strcmp(serial[i], unordered[j]) == 0))
+        break;
+
+    ck_assert(j < num_unordered);
+    free(unordered[j]);
+    unordered[j] = NULL;
+  }
+
+  for (i = 0; i < num_serial; i++) {
+    free(serial[i]);
+    free(parallel[i]);
+  }
+
+  free(serial);
+  free(parallel);
+  free(unordered);
+  vrna_fold_compound_free(vc);
+}
+
+#test test_sample_cache
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *vc;
+  vrna_pbacktrack_mem_t mem;
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  char                  **plain, **cached, **resumed;
+  unsigned int          i, k, num = 500;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML      = 1;
+  md.compute_bpp  = 0;
+
+  vc = vrna_fold_compound(sequence, &md, VRNA_OPTION_PF);
+  vrna_pf(vc, NULL);
+
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  plain     = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_DEFAULT);
+
+  xsubi[0]  = 1;
+  xsubi[1]  = 2;
+  xsubi[2]  = 3;
+  cached    = vrna_pbacktrack_num(vc, num, VRNA_PBACKTRACK_CACHE);
+
+  ck_assert(plain != NULL);
+  ck_assert(cached != NULL);
+
+  /* cached cumulative weights yield the very same samples */
+  for (i = 0; i < num; i++) {
+    ck_assert(plain[i] != NULL);
+    ck_assert(strcmp(plain[i], cached[i]) == 0);
+  }
+
+  ck_assert(cached[num] == NULL);
+
+  /* re-use a cache that is already filled */
+  mem = NULL;
+  for (k = 0; k < 2; k++) {
+    xsubi[0]  = 1;
+    xsubi[1]  = 2;
+    xsubi[2]  = 3;
+    resumed   = vrna_pbacktrack_resume(vc, num, &mem, VRNA_PBACKTRACK_CACHE);
+
+    ck_assert(resumed != NULL);
+    ck_assert(mem != NULL);
+
+    for (i = 0; i < num; i++) {
+      ck_assert(strcmp(plain[i], resumed[i]) == 0);
+      free(resumed[i]);
+    }
+
+    free(resumed);
+  }
+
+  vrna_pbacktrack_mem_free(mem);
+
+  for (i = 0; i < num; i++) {
+    free(plain[i]);
+    free(cached[i]);
+  }
+
+  free(plain);
+  free(cached);
+  vrna_fold_compound_free(vc);
+}
+
+#tcase Adaptive_Scaling
+
+#test test_pf_adaptive
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc_ref, *fc;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC"
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  double                mfe, g_ref, g;
+  unsigned int          i, n;
+  FLT_OR_DBL            *p_ref, *p;
+
+  vrna_md_set_default(&md);
+  md.temperature = 0.;
+
+  fc_ref  = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  mfe     = (double)vrna_mfe(fc_ref, NULL);
+  vrna_exp_params_rescale(fc_ref, &mfe);
+  g_ref = (double)vrna_pf(fc_ref, NULL);
+
+  /* start with a scaling factor far too large and let the recursions adapt it */
+  md.pf_adaptive  = 1;
+  fc              = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  vrna_exp_params_rescale(fc, NULL);
+  fc->exp_params->pf_scale = 1e10;
+  vrna_exp_params_rescale(fc, NULL);
+  g = (double)vrna_pf(fc, NULL);
+
+  ck_assert(fabs(g - g_ref) < 1e-6);
+  ck_assert(fc->exp_params->pf_scale < 1e10);
+
+  n     = strlen(seq);
+  p_ref = fc_ref->exp_matrices->probs;
+  p     = fc->exp_matrices->probs;
+  for (i = 1; i <= (n * (n + 1)) / 2; i++)
+    ck_assert(fabs(p[i] - p_ref[i]) < 1e-8);
+
+  vrna_fold_compound_free(fc_ref);
+  vrna_fold_compound_free(fc);
+}
+
+#tcase Sparse_Probabilities
+
+#test test_pairing_probs_sparse
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_sparse;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU"
+    "GGGAAAUCCCAGCUAGCUAGGCUAGCGAUCGAUCGGAUCCGAUAGCUAGCUAGCUAGCGCGAUAUAGCGCGCUAUAUGCGCGAUCGAUGCUAGCUAGCGAUCGAUCGAUGCUAGCUAGC";
+  char                  *structure;
+  double                cutoff = 1e-3, dist;
+  unsigned int          num, num_sparse;
+  int                   i, j, n;
+  FLT_OR_DBL            *p;
+  vrna_ep_t             *pl, *pl_sparse, *ptr;
+
+  n = (int)strlen(seq);
+  vrna_md_set_default(&md);
+
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  vrna_pf(fc, NULL);
+
+  /* the dense probability matrix is not required for the sparse outside recursion */
+  md.compute_bpp  = 0;
+  fc_sparse       = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  vrna_pf(fc_sparse, NULL);
+  ck_assert(fc_sparse->exp_matrices->probs == NULL);
+
+  pl_sparse = vrna_pairing_probs_sparse(fc_sparse, cutoff, VRNA_PROBS_SPARSE_PRUNE_DEFAULT);
+  ck_assert(pl_sparse != NULL);
+
+  p           = fc->exp_matrices->probs;
+  num_sparse  = 0;
+  for (ptr = pl_sparse; ptr->i; ptr++, num_sparse++) {
+    ck_assert(ptr->i < ptr->j);
+    if (ptr != pl_sparse)
+      ck_assert((ptr->i > (ptr - 1)->i) ||
+                ((ptr->i == (ptr - 1)->i) && (ptr->j > (ptr - 1)->j)));
+
+    ck_assert(ptr->p >= cutoff);
+    ck_assert(fabs(ptr->p - p[fc->iindx[ptr->i] - ptr->j]) < 1e-5);
+  }
+
+  /* all pairs clearly above the cutoff must be present */
+  pl  = vrna_plist_from_probs(fc, cutoff);
+  num = 0;
+  for (ptr = pl; ptr->i; ptr++)
+    if (ptr->p > 2 * cutoff)
+      num++;
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++)
+      if (p[fc->iindx[i] - j] > 2 * cutoff)
+        num--;
+
+  ck_assert(num == 0);
+  ck_assert(num_sparse > 0);
+
+  structure = vrna_centroid_from_plist(n, &dist, pl_sparse);
+  ck_assert(fabs(vrna_ensemble_defect_from_plist(n, pl_sparse, structure) -
+                 vrna_ensemble_defect_from_plist(n, pl, structure)) < 1e-3);
+
+  free(structure);
+  free(pl_sparse);
+
+  /* a smaller pruning ratio reproduces the dense probabilities */
+  pl_sparse = vrna_pairing_probs_sparse(fc_sparse, cutoff, 1e-8);
+  ck_assert(pl_sparse != NULL);
+
+  num_sparse = 0;
+  for (ptr = pl_sparse; ptr->i; ptr++, num_sparse++)
+    ck_assert(fabs(ptr->p - p[fc->iindx[ptr->i] - ptr->j]) < 1e-7);
+
+  num = 0;
+  for (ptr = pl; ptr->i; ptr++)
+    if (ptr->p >= cutoff)
+      num++;
+
+  ck_assert_int_eq(num_sparse, num);
+
+  /* invalid pruning ratios */
+  ck_assert(vrna_pairing_probs_sparse(fc_sparse, cutoff, 0.) == NULL);
+  ck_assert(vrna_pairing_probs_sparse(fc_sparse, cutoff, 2.) == NULL);
+
+  free(pl);
+  free(pl_sparse);
+  vrna_fold_compound_free(fc);
+  vrna_fold_compound_free(fc_sparse);
+}
+
+#tcase Heat_Capacity
+
+#test test_heat_capacity
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc, *fc_T;
+  const char            *seq =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACG";
+  const char            *constraint =
+    "..xxxx.......................................................";
+  double                mfe, g, g_T, cp;
+  FLT_OR_DBL            up[64];
+  unsigned int          i, num;
+  vrna_heat_capacity_t  *hc_parallel, *hc_serial;
+
+  vrna_md_set_default(&md);
+
+  /* in-place re-computation of the parameters must match a fresh fold compound */
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+  ck_assert(vrna_params_set_temperature(fc, 55.));
+  ck_assert(fc->exp_params->temperature == 55.);
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+  vrna_pf(fc, NULL);
+  g = vrna_pf_ensemble_energy(fc);
+
+  md.temperature  = 55.;
+  fc_T            = vrna_fold_compound(seq, &md, VRNA_OPTION_MFE | VRNA_OPTION_PF);
+  mfe             = (double)vrna_mfe(fc_T, NULL);
+  vrna_exp_params_rescale(fc_T, &mfe);
+  vrna_pf(fc_T, NULL);
+  g_T = vrna_pf_ensemble_energy(fc_T);
+
+  ck_assert(fabs(g - g_T) < 1e-10);
+
+  vrna_fold_compound_free(fc);
+  vrna_fold_compound_free(fc_T);
+
+  /* the number of threads must not affect the results */
+  md.temperature  = 37.;
+  md.num_threads  = 2;
+  fc              = vrna_fold_compound(seq, &md, VRNA_OPTION_EVAL_ONLY);
+  hc_parallel     = vrna_heat_capacity(fc, 30., 40., 0.5, 2, VRNA_HEAT_CAPACITY_FIT);
+  vrna_fold_compound_free(fc);
+
+  md.num_threads  = 1;
+  fc              = vrna_fold_compound(seq, &md, VRNA_OPTION_EVAL_ONLY);
+  hc_serial       = vrna_heat_capacity(fc, 30., 40., 0.5, 2, VRNA_HEAT_CAPACITY_FIT);
+  vrna_fold_compound_free(fc);
+
+  ck_assert(hc_parallel != NULL);
+  ck_assert(hc_serial != NULL);
+
+  for (num = 0; hc_serial[num].temperature >= 30.; num++) {
+    ck_assert(fabs(hc_serial[num].temperature - (30. + 0.5 * num)) < 1e-4);
+    ck_assert(fabs(hc_serial[num].heat_capacity - hc_parallel[num].heat_capacity) < 1e-4);
+  }
+  ck_assert_int_eq(num, 21);
+
+  free(hc_parallel);
+  free(hc_serial);
+
+  /* hard constraints must be transferred to the worker fold compounds */
+  md.num_threads  = 2;
+  fc              = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  vrna_constraints_add(fc, constraint, VRNA_CONSTRAINT_DB_DEFAULT);
+  hc_serial = vrna_heat_capacity(fc, 35., 39., 2., 1, VRNA_HEAT_CAPACITY_FIT);
+  ck_assert(hc_serial != NULL);
+
+  for (i = 0; i < 3; i++) {
+    cp = heat_capacity_ref(seq, constraint, NULL, 35. + 2. * i, 2.);
+    ck_assert(fabs(hc_serial[i].heat_capacity - cp) < 1e-3 * MAX2(1., fabs(cp)));
+  }
+
+  free(hc_serial);
+
+  /* soft constraints are applied to the fold compound in place, which is restored afterwards */
+  up[0] = 0.;
+  for (i = 1; i <= strlen(seq); i++)
+    up[i] = (i % 7) ? 0. : -1.5;
+
+  vrna_sc_set_up(fc, (const FLT_OR_DBL *)up, VRNA_OPTION_DEFAULT);
+  hc_serial = vrna_heat_capacity(fc, 35., 39., 2., 1, VRNA_HEAT_CAPACITY_FIT);
+  ck_assert(hc_serial != NULL);
+
+  for (i = 0; i < 3; i++) {
+    cp = heat_capacity_ref(seq, constraint, up, 35. + 2. * i, 2.);
+    ck_assert(fabs(hc_serial[i].heat_capacity - cp) < 1e-3 * MAX2(1., fabs(cp)));
+  }
+
+  ck_assert(fc->params->model_details.temperature == 37.);
+  ck_assert(fc->exp_params->temperature == 37.);
+
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+  vrna_pf(fc, NULL);
+  g = vrna_pf_ensemble_energy(fc);
+
+  md.num_threads  = 1;
+  fc_T            = vrna_fold_compound(seq, &md, VRNA_OPTION_DEFAULT);
+  vrna_constraints_add(fc_T, constraint, VRNA_CONSTRAINT_DB_DEFAULT);
+  vrna_sc_set_up(fc_T, (const FLT_OR_DBL *)up, VRNA_OPTION_DEFAULT);
+  mfe = (double)vrna_mfe(fc_T, NULL);
+  vrna_exp_params_rescale(fc_T, &mfe);
+  vrna_pf(fc_T, NULL);
+  g_T = vrna_pf_ensemble_energy(fc_T);
+
+  ck_assert(fabs(g - g_T) < 1e-10);
+
+  free(hc_serial);
+  vrna_fold_compound_free(fc);
+  vrna_fold_compound_free(fc_T);
+}
+
+#tcase Sliding_Window
+
+#test test_probs_window_parallel
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+  char                  *seq;
+  unsigned int          i, options;
+  struct window_sums    serial, parallel;
+  const char            *nt = "ACGU";
+
+  /* long enough to be split into several chunks of 16 windows */
+  seq = (char *)vrna_alloc(sizeof(char) * 3001);
+  srand(1);
+  for (i = 0; i < 3000; i++)
+    seq[i] = nt[rand() % 4];
+
+  vrna_md_set_default(&md);
+  md.window_size  = 50;
+  md.max_bp_span  = 40;
+  options         = VRNA_PROBS_WINDOW_BPP | VRNA_PROBS_WINDOW_UP;
+
+  memset(&serial, 0, sizeof(struct window_sums));
+  memset(&parallel, 0, sizeof(struct window_sums));
+  serial.ordered = parallel.ordered = 1;
+
+  md.num_threads  = 1;
+  fc              = vrna_fold_compound(seq, &md, VRNA_OPTION_PF | VRNA_OPTION_WINDOW);
+  ck_assert(vrna_probs_window(fc, 10, options, &sum_window_probs, (void *)&serial));
+  vrna_fold_compound_free(fc);
+
+  md.num_threads  = 2;
+  fc              = vrna_fold_compound(seq, &md, VRNA_OPTION_PF | VRNA_OPTION_WINDOW);
+  ck_assert(vrna_probs_window(fc, 10, options, &sum_window_probs, (void *)&parallel));
+  vrna_fold_compound_free(fc);
+
+  /* the chunked scan must report the same data in the same order per kind */
+  ck_assert(parallel.ordered);
+  ck_assert_int_eq(parallel.num, serial.num);
+  ck_assert(serial.bpp > 0.);
+  ck_assert(serial.up > 0.);
+  ck_assert(parallel.bpp == serial.bpp);
+  ck_assert(parallel.up == serial.up);
+
+  free(seq);
+}
+
+#test test_probs_window_stream
+{
+  vrna_md_t               md;
+  vrna_fold_compound_t    *fc;
+  char                    *seq;
+  unsigned int            i, options;
+  struct window_sums      serial, streamed;
+  struct sequence_blocks  blocks;
+  const char              *nt = "ACGU";
+
+  seq = (char *)vrna_alloc(sizeof(char) * 3001);
+  srand(3);
+  for (i = 0; i < 3000; i++)
+    seq[i] = nt[rand() % 4];
+
+  vrna_md_set_default(&md);
+  md.window_size  = 50;
+  md.max_bp_span  = 40;
+  md.num_threads  = 1;
+  options         = VRNA_PROBS_WINDOW_BPP | VRNA_PROBS_WINDOW_UP;
+
+  memset(&serial, 0, sizeof(struct window_sums));
+  memset(&streamed, 0, sizeof(struct window_sums));
+  serial.ordered = streamed.ordered = 1;
+
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_PF | VRNA_OPTION_WINDOW);
+  ck_assert(vrna_probs_window(fc, 10, options, &sum_window_probs, (void *)&serial));
+  vrna_fold_compound_free(fc);
+
+  blocks.sequence   = seq;
+  blocks.length     = 3000;
+  blocks.pos        = 0;
+  blocks.block_size = 333;
+
+  /* read the sequence in small blocks and process two chunks at a time */
+  md.num_threads = 2;
+  ck_assert(vrna_probs_window_source(&md,
+                                     10,
+                                     options,
+                                     &read_sequence_block,
+                                     (void *)&blocks,
+                                     &sum_window_probs,
+                                     (void *)&streamed));
+
+  ck_assert(streamed.ordered);
+  ck_assert_int_eq(streamed.num, serial.num);
+  ck_assert(serial.bpp > 0.);
+  ck_assert(serial.up > 0.);
+  ck_assert(streamed.bpp == serial.bpp);
+  ck_assert(streamed.up == serial.up);
+
+  free(seq);
+}
+
+#test test_probs_window_accessibility
+{
+  vrna_md_t                 md;
+  vrna_fold_compound_t      *fc;
+  vrna_exp_param_t          *params;
+  vrna_accessibility_file_t *file;
+  vrna_accessibility_t      *acc;
+  char                      *seq;
+  unsigned int              i, u, t, options;
+  int                       e;
+  double                    kT, p;
+  struct window_up          up;
+  const char                *nt     = "ACGU";
+  const char                *fname  = "test_accessibility.bin";
+  const unsigned int        types[] = {
+    VRNA_ACCESSIBILITY_FLOAT32, VRNA_ACCESSIBILITY_UINT16
+  };
+
+  seq = (char *)vrna_alloc(sizeof(char) * 501);
+  srand(7);
+  for (i = 0; i < 500; i++)
+    seq[i] = nt[rand() % 4];
+
+  vrna_md_set_default(&md);
+  md.window_size  = 80;
+  md.max_bp_span  = 60;
+  options         = VRNA_PROBS_WINDOW_UP;
+  params          = vrna_exp_params(&md);
+  kT              = params->kT / 1000.;
+  free(params);
+
+  up.ulength  = 15;
+  up.up       = (double *)vrna_alloc(sizeof(double) * 500 * up.ulength);
+  for (i = 0; i < 500 * up.ulength; i++)
+    up.up[i] = NAN;
+
+  fc = vrna_fold_compound(seq, &md, VRNA_OPTION_PF | VRNA_OPTION_WINDOW);
+  ck_assert(vrna_probs_window(fc, up.ulength, options, &store_window_up, (void *)&up));
+
+  for (t = 0; t < 2; t++) {
+    file = vrna_file_accessibility_open(fname, up.ulength, kT, types[t]);
+    ck_assert(file != NULL);
+    ck_assert(vrna_probs_window(fc, up.ulength, options, &vrna_file_accessibility_callback, (void *)file));
+    ck_assert(vrna_file_accessibility_close(file));
+
+    acc = vrna_accessibility_read(fname);
+    ck_assert(acc != NULL);
+    ck_assert_int_eq(vrna_accessibility_length(acc), 500);
+    ck_assert_int_eq(vrna_accessibility_ulength(acc), up.ulength);
+
+    for (i = 1; i <= 500; i++)
+      for (u = 1; u <= up.ulength; u++) {
+        p = up.up[(i - 1) * up.ulength + u - 1];
+        e = vrna_accessibility_energy(acc, i, u);
+        if (isnan(p) || (p <= 0.)) {
+          ck_assert_int_eq(e, INF);
+          ck_assert(isnan(vrna_accessibility_probability(acc, i, u)));
+        } else {
+          ck_assert(abs(e - (int)rint(100 * (-log(p) * kT))) <= 1);
+          if (types[t] == VRNA_ACCESSIBILITY_FLOAT32)
+            ck_assert(fabs(vrna_accessibility_probability(acc, i, u) - p) <= 1e-6 * p);
+        }
+      }
+
+    /* out of range requests */
+    ck_assert_int_eq(vrna_accessibility_energy(acc, 501, 1), INF);
+    ck_assert_int_eq(vrna_accessibility_energy(acc, 10, up.ulength + 1), INF);
+
+    vrna_accessibility_free(acc);
+  }
+
+  remove(fname);
+
+  free(up.up);
+  free(seq);
+  vrna_fold_compound_free(fc);
+}
+
+#tcase Interactions
+
+#test test_interaction_engines
+{
+  vrna_md_t     md37, md50;
+  vrna_duplex_t *duplex37, *duplex50;
+  vrna_plex_t   *plex37, *plex50, *plex;
+  duplexT       legacy, mfe37, mfe50;
+  vrna_cstr_t   first, second, other, fresh;
+  FILE          *sink;
+  const char    query[] = "UGAGGUAGUAGGUUGUAUAGUU";
+  const char    target[] =
+    "NNNNNNNNNNAUGGCUACAACCUACUACCUCAGCGAUUCGGCAAUCCGGAGGAUAAGCUUCAACUAUACAACCUGCUACCUCAAUGCGNNNNNNNNNN";
+  const char    padded[] = "NNNNNNNNNNUGAGGUAGUAGGUUGUAUAGUUNNNNNNNNNN";
+
+  vrna_md_set_default(&md37);
+  vrna_md_set_default(&md50);
+  md50.temperature = 50.;
+
+  /* duplex engines with different settings do not interfere */
+  duplex37  = vrna_duplex_init(&md37);
+  duplex50  = vrna_duplex_init(&md50);
+  mfe50     = vrna_duplexfold(duplex50, query, target + 10);
+  mfe37     = vrna_duplexfold(duplex37, query, target + 10);
+  legacy    = duplexfold(query, target + 10);
+
+  ck_assert_int_eq((int)rint(100 * mfe37.energy), (int)rint(100 * legacy.energy));
+  ck_assert_str_eq(mfe37.structure, legacy.structure);
+  ck_assert(mfe50.energy > mfe37.energy);
+
+  free(legacy.structure);
+  free(mfe37.structure);
+  free(mfe50.structure);
+  vrna_duplex_free(duplex37);
+  vrna_duplex_free(duplex50);
+
+  /* interleaved interaction searches report to their own output streams */
+  sink    = fopen("/dev/null", "w");
+  first   = vrna_cstr(0, sink);
+  second  = vrna_cstr(0, sink);
+  other   = vrna_cstr(0, sink);
+  fresh   = vrna_cstr(0, sink);
+  plex37  = vrna_plex_init(&md37);
+  plex50  = vrna_plex_init(&md50);
+
+  vrna_plex_set_output(plex37, first);
+  vrna_plex_scan(plex37, target, padded, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+  vrna_plex_set_output(plex50, other);
+  vrna_plex_scan(plex50, target, padded, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+  vrna_plex_set_output(plex37, second);
+  vrna_plex_scan(plex37, target, padded, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+
+  plex = vrna_plex_init(&md37);
+  vrna_plex_set_output(plex, fresh);
+  vrna_plex_scan(plex, target, padded, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+
+  ck_assert(strlen(vrna_cstr_string(first)) > 0);
+  ck_assert_str_eq(vrna_cstr_string(first), vrna_cstr_string(second));
+  ck_assert_str_eq(vrna_cstr_string(first), vrna_cstr_string(fresh));
+  ck_assert_str_ne(vrna_cstr_string(first), vrna_cstr_string(other));
+
+  vrna_plex_free(plex);
+  vrna_plex_free(plex37);
+  vrna_plex_free(plex50);
+  vrna_cstr_free(first);
+  vrna_cstr_free(second);
+  vrna_cstr_free(other);
+  vrna_cstr_free(fresh);
+  fclose(sink);
+}
+
+#test test_interaction_target_index
+{
+  vrna_md_t           md;
+  vrna_plex_t         *plex;
+  vrna_plex_target_t  *index, *seeded;
+  vrna_cstr_t         full, indexed, filtered, none;
+  FILE                *sink;
+  const char          *last_full, *last_filtered;
+  const char          target[] =
+    "NNNNNNNNNNAUGGCUACAACCUACUACCUCAGCGAUUCGGCAAUCCGGAGGAUAAGCUUCAACUAUACAACCUGCUACCUCAAUGCGNNNNNNNNNN";
+  const char          query[]   = "NNNNNNNNNNUGAGGUAGUAGGUUGUAUAGUUNNNNNNNNNN";
+  const char          unseeded[] = "NNNNNNNNNNAAAAAAAAAAAAAAAAAAAAAANNNNNNNNNN";
+
+  vrna_md_set_default(&md);
+
+  sink      = fopen("/dev/null", "w");
+  full      = vrna_cstr(0, sink);
+  indexed   = vrna_cstr(0, sink);
+  filtered  = vrna_cstr(0, sink);
+  none      = vrna_cstr(0, sink);
+  plex      = vrna_plex_init(&md);
+
+  ck_assert(vrna_plex_target_init(&md, target, NULL, VRNA_PLEX_SEED_MAX + 1) == NULL);
+
+  index   = vrna_plex_target_init(&md, target, NULL, 0);
+  seeded  = vrna_plex_target_init(&md, target, NULL, 7);
+  ck_assert(index != NULL);
+  ck_assert(seeded != NULL);
+
+  vrna_plex_set_output(plex, full);
+  vrna_plex_scan(plex, target, query, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+
+  /* without seed filter, the index does not change the interactions */
+  vrna_plex_set_output(plex, indexed);
+  vrna_plex_scan_target(plex, index, query, NULL, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+  ck_assert_str_eq(vrna_cstr_string(indexed), vrna_cstr_string(full));
+
+  /* the best interaction contains a seed, so the filter must find it as well */
+  vrna_plex_set_output(plex, filtered);
+  vrna_plex_scan_target(plex, seeded, query, NULL, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+  last_full     = strrchr(vrna_cstr_string(full), '\n');
+  last_filtered = strrchr(vrna_cstr_string(filtered), '\n');
+  ck_assert(last_filtered != NULL);
+  while ((last_full > vrna_cstr_string(full)) && (*(last_full - 1) != '\n'))
+    last_full--;
+  while ((last_filtered > vrna_cstr_string(filtered)) && (*(last_filtered - 1) != '\n'))
+    last_filtered--;
+  ck_assert_str_eq(last_filtered, last_full);
+
+  /* queries without seed are not scanned at all */
+  vrna_plex_set_output(plex, none);
+  vrna_plex_scan_target(plex, seeded, unseeded, NULL, -500, 0, 40, 0, 0, 10, 200, 100, 300);
+  ck_assert_int_eq(strlen(vrna_cstr_string(none)), 0);
+
+  vrna_plex_target_free(index);
+  vrna_plex_target_free(seeded);
+  vrna_plex_free(plex);
+  vrna_cstr_free(full);
+  vrna_cstr_free(indexed);
+  vrna_cstr_free(filtered);
+  vrna_cstr_free(none);
+  fclose(sink);
+}
+
 #suite  Constraints_Implementation
 
 #tcase  Soft_Constraints
@@ -0,0 +1,179 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <ViennaRNA/utils/basic.h>
+
+#include "parallel_helpers.h"
+
+#if VRNA_WITH_PTHREADS
+
+#define NUM_WORKERS 3
+#define NUM_JOBS    1000
+
+
+struct job_data {
+  unsigned int    *runs;      /* number of executions of the job */
+  pthread_mutex_t *mtx;       /* the gate that blocks the job until opened */
+  pthread_cond_t  *cond;
+  int             *open;
+};
+
+
+struct input_data {
+  job_scheduler   scheduler;
+  struct job_data *jobs;
+  unsigned int    num;
+  unsigned int    added;      /* number of jobs added so far */
+};
+
+
+static void
+count_job(void *arg)
+{
+  struct job_data *job = (struct job_data *)arg;
+
+  if (job->mtx) {
+    pthread_mutex_lock(job->mtx);
+    while (!*(job->open))
+      pthread_cond_wait(job->cond, job->mtx);
+    pthread_mutex_unlock(job->mtx);
+  }
+
+  __atomic_add_fetch(job->runs, 1, __ATOMIC_SEQ_CST);
+}
+
+
+static void *
+add_jobs(void *arg)
+{
+  unsigned int      i;
+  struct input_data *input = (struct input_data *)arg;
+
+  for (i = 0; i < input->num; i++) {
+    scheduler_add_job(input->scheduler, &count_job, (void *)&(input->jobs[i]));
+    __atomic_store_n(&(input->added), i + 1, __ATOMIC_SEQ_CST);
+  }
+
+  return NULL;
+}
+
+
+#endif
+
+#suite Job_Scheduler
+
+#tcase Scheduler
+
+#test test_scheduler_jobs
+{
+#if VRNA_WITH_PTHREADS
+  unsigned int    i, round, runs[NUM_JOBS];
+  job_scheduler   scheduler;
+  struct job_data jobs[NUM_JOBS];
+
+  for (i = 0; i < NUM_JOBS; i++) {
+    runs[i]       = 0;
+    jobs[i].runs  = &(runs[i]);
+    jobs[i].mtx   = NULL;
+  }
+
+  scheduler = scheduler_init(NUM_WORKERS, JOBS_PER_WORKER * NUM_WORKERS);
+  ck_assert(scheduler != NULL);
+
+  /* every job must be executed exactly once, and waiting must cover all of them */
+  for (round = 1; round <= 2; round++) {
+    for (i = 0; i < NUM_JOBS; i++)
+      scheduler_add_job(scheduler, &count_job, (void *)&(jobs[i]));
+
+    scheduler_wait(scheduler);
+
+    for (i = 0; i < NUM_JOBS; i++)
+      ck_assert_int_eq(__atomic_load_n(&(runs[i]), __ATOMIC_SEQ_CST), round);
+  }
+
+  /* destroying the scheduler finishes all pending jobs */
+  for (i = 0; i < NUM_JOBS; i++)
+    scheduler_add_job(scheduler, &count_job, (void *)&(jobs[i]));
+
+  scheduler_destroy(scheduler);
+
+  for (i = 0; i < NUM_JOBS; i++)
+    ck_assert_int_eq(runs[i], 3);
+
+#endif
+}
+
+#test test_scheduler_back_pressure
+{
+#if VRNA_WITH_PTHREADS
+  unsigned int      i, added, queue_size, runs;
+  int               open;
+  pthread_t         input_thread;
+  pthread_mutex_t   mtx;
+  pthread_cond_t    cond;
+  job_scheduler     scheduler;
+  struct job_data   jobs[NUM_JOBS];
+  struct input_data input;
+
+  runs        = 0;
+  open        = 0;
+  queue_size  = JOBS_PER_WORKER * NUM_WORKERS;
+
+  pthread_mutex_init(&mtx, NULL);
+  pthread_cond_init(&cond, NULL);
+
+  for (i = 0; i < NUM_JOBS; i++) {
+    jobs[i].runs  = &runs;
+    jobs[i].mtx   = &mtx;
+    jobs[i].cond  = &cond;
+    jobs[i].open  = &open;
+  }
+
+  scheduler = scheduler_init(NUM_WORKERS, queue_size);
+  ck_assert(scheduler != NULL);
+
+  input.scheduler = scheduler;
+  input.jobs      = jobs;
+  input.num       = NUM_JOBS;
+  input.added     = 0;
+
+  ck_assert_int_eq(pthread_create(&input_thread, NULL, &add_jobs, (void *)&input), 0);
+
+  /*
+   *  The blocked workers hold one job each, all other jobs must occupy the
+   *  queue. Adding more jobs must block until the jobs are released
+   */
+  for (i = 0; i < 100; i++) {
+    if (__atomic_load_n(&(input.added), __ATOMIC_SEQ_CST) >= queue_size + NUM_WORKERS)
+      break;
+
+    usleep(100000);
+  }
+
+  usleep(100000);
+  added = __atomic_load_n(&(input.added), __ATOMIC_SEQ_CST);
+
+  ck_assert_int_eq(added, queue_size + NUM_WORKERS);
+  ck_assert_int_eq(__atomic_load_n(&runs, __ATOMIC_SEQ_CST), 0);
+
+  /* release the jobs */
+  pthread_mutex_lock(&mtx);
+  open = 1;
+  pthread_cond_broadcast(&cond);
+  pthread_mutex_unlock(&mtx);
+
+  pthread_join(input_thread, NULL);
+  scheduler_wait(scheduler);
+
+  ck_assert_int_eq(__atomic_load_n(&runs, __ATOMIC_SEQ_CST), NUM_JOBS);
+
+  scheduler_destroy(scheduler);
+  pthread_mutex_destroy(&mtx);
+  pthread_cond_destroy(&cond);
+#endif
+}
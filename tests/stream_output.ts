@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/datastructures/stream_output.h>
+
+#define NUM_PROVIDERS   4
+#define WINDOW_RECORDS  5000000
+
+struct stream_check {
+  unsigned int  processed;  /* number of callback executions */
+  unsigned int  misplaced;  /* number of indices passed out of order */
+  unsigned int  corrupted;  /* number of indices with unexpected data */
+};
+
+
+struct thread_check {
+  pthread_t     thread;     /* the thread that is expected to execute the callback */
+  unsigned int  processed;
+  unsigned int  foreign;    /* number of callback executions by another thread */
+};
+
+
+struct provider_data {
+  vrna_ostream_t  stream;
+  unsigned int    first;
+  unsigned int    step;
+  unsigned int    num;
+  unsigned int    *requested;
+  int             stalled;
+};
+
+
+static void
+check_callback(void         *auxdata,
+               unsigned int i,
+               void         *data)
+{
+  struct stream_check *check = (struct stream_check *)auxdata;
+
+  if (i != check->processed)
+    check->misplaced++;
+
+  if ((uintptr_t)data != (uintptr_t)i + 1)
+    check->corrupted++;
+
+  check->processed++;
+}
+
+
+static void
+thread_callback(void          *auxdata,
+                unsigned int  i,
+                void          *data)
+{
+  struct thread_check *check = (struct thread_check *)auxdata;
+
+  if (!pthread_equal(pthread_self(), check->thread))
+    check->foreign++;
+
+  check->processed++;
+}
+
+
+/* provide every step-th index, starting with the last one */
+static void *
+provide_interleaved(void *arg)
+{
+  struct provider_data  *p = (struct provider_data *)arg;
+  unsigned int          i, k;
+
+  for (k = (p->num - 1 - p->first) / p->step + 1; k > 0; k--) {
+    i = p->first + (k - 1) * p->step;
+    vrna_ostream_provide(p->stream, i, (void *)((uintptr_t)i + 1));
+  }
+
+  return NULL;
+}
+
+
+/*
+ *  wait until the requesting thread stalls, then provide all
+ *  indices in order as soon as they have been requested
+ */
+static void *
+provide_after_stall(void *arg)
+{
+  struct provider_data  *p = (struct provider_data *)arg;
+  unsigned int          i, last, current;
+
+  last = __atomic_load_n(p->requested, __ATOMIC_SEQ_CST);
+  while (1) {
+    usleep(100000);
+    current = __atomic_load_n(p->requested, __ATOMIC_SEQ_CST);
+    if ((current == last) || (current == p->num))
+      break;
+
+    last = current;
+  }
+
+  p->stalled = (current < p->num);
+
+  for (i = 0; i < p->num; i++) {
+    while (__atomic_load_n(p->requested, __ATOMIC_SEQ_CST) <= i)
+      sched_yield();
+
+    vrna_ostream_provide(p->stream, i, (void *)((uintptr_t)i + 1));
+  }
+
+  return NULL;
+}
+
+
+#suite Stream_Output
+
+#tcase Ordered_Stream
+
+#test test_vrna_ostream_order
+{
+  unsigned int          i, n, t, num_threads;
+  vrna_ostream_t        stream;
+  pthread_t             threads[NUM_PROVIDERS];
+  struct provider_data  providers[NUM_PROVIDERS];
+  struct stream_check   check = {
+    0, 0, 0
+  };
+
+  n           = 10000;
+  num_threads = (vrna_ostream_threadsafe()) ? NUM_PROVIDERS : 1;
+  stream      = vrna_ostream_init(&check_callback, (void *)&check);
+  ck_assert(stream != NULL);
+
+  for (i = 0; i < n; i++)
+    vrna_ostream_request(stream, i);
+
+  /* each provider inserts every num_threads-th index in descending order */
+  for (t = 0; t < num_threads; t++) {
+    providers[t].stream = stream;
+    providers[t].first  = t;
+    providers[t].step   = num_threads;
+    providers[t].num    = n;
+  }
+
+  if (num_threads > 1) {
+    for (t = 0; t < num_threads; t++)
+      ck_assert_int_eq(pthread_create(&threads[t], NULL, &provide_interleaved, &providers[t]), 0);
+
+    for (t = 0; t < num_threads; t++)
+      pthread_join(threads[t], NULL);
+  } else {
+    provide_interleaved(&providers[0]);
+  }
+
+  vrna_ostream_free(stream);
+
+  ck_assert_int_eq(check.processed, n);
+  ck_assert_int_eq(check.misplaced, 0);
+  ck_assert_int_eq(check.corrupted, 0);
+}
+
+#test test_vrna_ostream_single_provider
+{
+  unsigned int        i, n;
+  vrna_ostream_t      stream;
+  struct thread_check check;
+
+  n               = 100;
+  check.thread    = pthread_self();
+  check.processed = 0;
+  check.foreign   = 0;
+
+  stream = vrna_ostream_init(&thread_callback, (void *)&check);
+  ck_assert(stream != NULL);
+
+  for (i = 0; i < n; i++)
+    vrna_ostream_request(stream, i);
+
+  /* a single provider processes the output directly, as soon as the head is available */
+  for (i = n - 1; i > 0; i--)
+    vrna_ostream_provide(stream, i, (void *)((uintptr_t)i + 1));
+
+  ck_assert_int_eq(check.processed, 0);
+
+  vrna_ostream_provide(stream, 0, (void *)1);
+
+  ck_assert_int_eq(check.processed, n);
+  ck_assert_int_eq(check.foreign, 0);
+
+  vrna_ostream_free(stream);
+}
+
+#test test_vrna_ostream_full_window
+{
+  unsigned int          i, requested;
+  vrna_ostream_t        stream;
+  pthread_t             thread;
+  struct provider_data  provider;
+  struct stream_check   check = {
+    0, 0, 0
+  };
+
+  /* the window is only limited in thread-safe mode */
+  if (!vrna_ostream_threadsafe())
+    return;
+
+  requested = 0;
+  stream    = vrna_ostream_init(&check_callback, (void *)&check);
+  ck_assert(stream != NULL);
+
+  provider.stream     = stream;
+  provider.num        = WINDOW_RECORDS;
+  provider.requested  = &requested;
+  provider.stalled    = 0;
+
+  ck_assert_int_eq(pthread_create(&thread, NULL, &provide_after_stall, &provider), 0);
+
+  /* requesting more indices than the window holds must block until data is processed */
+  for (i = 0; i < WINDOW_RECORDS; i++) {
+    vrna_ostream_request(stream, i);
+    __atomic_store_n(&requested, i + 1, __ATOMIC_SEQ_CST);
+  }
+
+  pthread_join(thread, NULL);
+  vrna_ostream_free(stream);
+
+  ck_assert_int_eq(provider.stalled, 1);
+  ck_assert_int_eq(check.processed, WINDOW_RECORDS);
+  ck_assert_int_eq(check.misplaced, 0);
+  ck_assert_int_eq(check.corrupted, 0);
+}
+
+#test test_vrna_ostream_shutdown
+{
+  unsigned int        i;
+  vrna_ostream_t      stream;
+  struct stream_check check = {
+    0, 0, 0
+  };
+
+  /* freeing an empty stream must not invoke the callback */
+  stream = vrna_ostream_init(&check_callback, (void *)&check);
+  ck_assert(stream != NULL);
+  vrna_ostream_free(stream);
+  ck_assert_int_eq(check.processed, 0);
+
+  vrna_ostream_free(NULL);
+
+  /* only data consecutively available from the head is processed upon shutdown */
+  stream = vrna_ostream_init(&check_callback, (void *)&check);
+  ck_assert(stream != NULL);
+
+  vrna_ostream_request(stream, 9);
+
+  for (i = 9; i > 5; i--)
+    vrna_ostream_provide(stream, i, (void *)((uintptr_t)i + 1));
+
+  for (i = 0; i < 5; i++)
+    vrna_ostream_provide(stream, i, (void *)((uintptr_t)i + 1));
+
+  vrna_ostream_free(stream);
+
+  ck_assert_int_eq(check.processed, 5);
+  ck_assert_int_eq(check.misplaced, 0);
+  ck_assert_int_eq(check.corrupted, 0);
+}
@@ -6,6 +6,7 @@
 #include <ViennaRNA/utils/strings.h>
 #include <ViennaRNA/alphabet.h>
 #include <ViennaRNA/mfe.h>
+#include <ViennaRNA/utils/higher_order_functions.h>
 
 static int
 compare_str(const void  *a,
@@ -302,3 +303,60 @@ compare_str(const void  *a,
 //@TODO: extend alphabeth
 //@TODO: details.noLP = 1
 //@TODO: idx_type = 1
+
+#tcase Higher_Order_Functions
+
+#test test_fun_zip_simd_vs_default
+{
+  int           i, n, pos, pos_ref, e, e_ref, *a, *b;
+  unsigned char *mask;
+  FLT_OR_DBL    *x, *y, s, s_ref;
+
+  vrna_init_rand();
+
+  for (n = 0; n < 67; n++) {
+    a     = (int *)vrna_alloc(sizeof(int) * (n + 1));
+    b     = (int *)vrna_alloc(sizeof(int) * (n + 1));
+    mask  = (unsigned char *)vrna_alloc(sizeof(unsigned char) * (n + 1));
+    x     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+    y     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n + 1));
+
+    for (i = 0; i < n; i++) {
+      a[i]    = (vrna_urn() < 0.1) ? INF : (int)(vrna_urn() * 200) - 100;
+      b[i]    = (vrna_urn() < 0.1) ? INF : (int)(vrna_urn() * 200) - 100;
+      mask[i] = (vrna_urn() < 0.3) ? 0 : 1;
+      x[i]    = (FLT_OR_DBL)vrna_urn();
+      y[i]    = (FLT_OR_DBL)vrna_urn();
+    }
+
+    /* reference values from the plain C implementations */
+    vrna_fun_dispatch_disable();
+    e_ref   = vrna_fun_zip_add_min_masked(a, b, mask, n);
+    pos_ref = vrna_fun_zip_add_argmin(a, b, n, NULL);
+    s_ref   = vrna_fun_zip_rev_mult_sum(x, y + n - 1, n);
+    ck_assert_int_eq(vrna_fun_zip_add_min(a, b, n),
+                     (pos_ref < 0) ? INF : a[pos_ref] + b[pos_ref]);
+
+    vrna_fun_dispatch_enable();
+    ck_assert_int_eq(vrna_fun_zip_add_min_masked(a, b, mask, n), e_ref);
+
+    pos = vrna_fun_zip_add_argmin(a, b, n, &e);
+    ck_assert_int_eq(pos, pos_ref);
+    ck_assert_int_eq(e, vrna_fun_zip_add_min(a, b, n));
+
+    s = vrna_fun_zip_rev_mult_sum(x, y + n - 1, n);
+    ck_assert(s == s_ref);
+
+    vrna_fun_dispatch_disable();
+    s_ref = vrna_fun_zip_mult_sum(x, y, n);
+    vrna_fun_dispatch_enable();
+    s = vrna_fun_zip_mult_sum(x, y, n);
+    ck_assert(s == s_ref);
+
+    free(a);
+    free(b);
+    free(mask);
+    free(x);
+    free(y);
+  }
+}